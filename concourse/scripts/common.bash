@@ -102,7 +102,11 @@ function make_cluster() {
       # also have to enlarge gp_interconnect_tcp_listener_backlog
       gpconfig -c gp_interconnect_tcp_listener_backlog -v 1024
 
-      gpstop -u
+      # spread the peer connections over more than one I/O thread, this
+      # needs a restart
+      gpconfig -c gp_interconnect_proxy_io_threads -v 2
+
+      gpstop -ar
 EOF
     fi
 
@@ -202,6 +202,59 @@ AOCSMoveTuple(TupleTableSlot *slot,
 		   AOTupleIdGet_segmentFileNum(&newAoTupleId), AOTupleIdGet_rowNum(&newAoTupleId));
 }
 
+/*
+ * Returns the size of a segment file, i.e. the sum of the sizes of its
+ * column files.
+ */
+static int64
+AOCSFileSegInfoTotalEof(AOCSFileSegInfo *fsinfo)
+{
+	int64		eof = 0;
+
+	for (int i = 0; i < fsinfo->vpinfo.nEntry; i++)
+		eof += fsinfo->vpinfo.entry[i].eof;
+
+	return eof;
+}
+
+/*
+ * Finishes the compaction of a segment file, once all its visible tuples
+ * have been moved: marks it as awaiting drop, and deletes its entries in
+ * the visibility map and the block directory.
+ */
+static void
+AOCSSegmentFileFinishCompaction(Relation aorel,
+								AOCSInsertDesc insertDesc,
+								AppendOnlyVisimap *visiMap,
+								AOCSFileSegInfo *fsinfo,
+								int64 movedTupleCount,
+								Snapshot snapshot)
+{
+	int			compact_segno = fsinfo->segno;
+
+	MarkAOCSFileSegInfoAwaitingDrop(aorel, compact_segno);
+
+	AppendOnlyVisimap_DeleteSegmentFile(visiMap,
+										compact_segno);
+
+	/* Delete all mini pages of the segment files if block directory exists */
+	if (OidIsValid(insertDesc->blkdirrelid))
+	{
+		AppendOnlyBlockDirectory_DeleteSegmentFile(aorel,
+												   snapshot,
+												   compact_segno,
+												   0);
+	}
+
+	AppendOnlyCompaction_ReportProgress(0, AOCSFileSegInfoTotalEof(fsinfo),
+										Max(fsinfo->total_tupcount - movedTupleCount, 0));
+
+	elogif(Debug_appendonly_print_compaction, LOG,
+		   "Finished compaction: "
+		   "AO segfile %d, relation %s, moved tuple count " INT64_FORMAT,
+		   compact_segno, RelationGetRelationName(aorel), movedTupleCount);
+}
+
 /*
  * Subroutine of AOCSCompact().
  */
@@ -224,6 +277,10 @@ AOCSSegmentFileFullCompaction(Relation aorel,
 	AOTupleId  *aoTupleId;
 	int64		tupleCount = 0;
 	int64		tuplePerPage = INT_MAX;
+	int64		eof = AOCSFileSegInfoTotalEof(fsinfo);
+	double		bytesPerTuple = 0;
+	int64		reportedScannedBytes = 0;
+	int64		reportedMovedTupleCount = 0;
 
 	Assert(Gp_role == GP_ROLE_EXECUTE || Gp_role == GP_ROLE_UTILITY);
 	Assert(RelationIsAoCols(aorel));
@@ -234,6 +291,8 @@ AOCSSegmentFileFullCompaction(Relation aorel,
 	{
 		tuplePerPage = fsinfo->total_tupcount / fsinfo->varblockcount;
 	}
+	if (fsinfo->total_tupcount > 0)
+		bytesPerTuple = (double) eof / fsinfo->total_tupcount;
 	relname = RelationGetRelationName(aorel);
 
 	AppendOnlyVisimap_Init(&visiMap,
@@ -256,19 +315,8 @@ AOCSSegmentFileFullCompaction(Relation aorel,
 
 	mt_bind = create_memtuple_binding(tupDesc);
 
-	/*
-	 * We need a ResultRelInfo and an EState so we can use the regular
-	 * executor's index-entry-making machinery.
-	 */
-	estate = CreateExecutorState();
-	resultRelInfo = makeNode(ResultRelInfo);
-	resultRelInfo->ri_RangeTableIndex = 1;	/* dummy */
-	resultRelInfo->ri_RelationDesc = aorel;
-	resultRelInfo->ri_TrigDesc = NULL;	/* we don't fire triggers */
-	ExecOpenIndices(resultRelInfo, false);
-	estate->es_result_relations = resultRelInfo;
-	estate->es_num_result_relations = 1;
-	estate->es_result_relation_info = resultRelInfo;
+	estate = AppendOnlyCompaction_BeginMove(aorel);
+	resultRelInfo = estate->es_result_relation_info;
 
 	while (aocs_getnext(scanDesc, ForwardScanDirection, slot))
 	{
@@ -290,53 +338,150 @@ AOCSSegmentFileFullCompaction(Relation aorel,
 		}
 
 		/*
-		 * Check for vacuum delay point after approximatly a var block
+		 * Report progress and check for vacuum delay point after
+		 * approximatly a var block
 		 */
 		tupleCount++;
-		if (VacuumCostActive && tupleCount % tuplePerPage == 0)
+		if (tupleCount % tuplePerPage == 0)
 		{
-			vacuum_delay_point();
+			int64		scannedBytes = Min((int64) (tupleCount * bytesPerTuple), eof);
+
+			AppendOnlyCompaction_ReportProgress(scannedBytes - reportedScannedBytes,
+												0, 0);
+			AppendOnlyCompaction_DelayPoint(scannedBytes - reportedScannedBytes,
+											(int64) ((movedTupleCount - reportedMovedTupleCount) * bytesPerTuple));
+			reportedScannedBytes = scannedBytes;
+			reportedMovedTupleCount = movedTupleCount;
 		}
 	}
+	AppendOnlyCompaction_ReportProgress(eof - reportedScannedBytes, 0, 0);
 
-	MarkAOCSFileSegInfoAwaitingDrop(aorel, compact_segno);
+	AOCSSegmentFileFinishCompaction(aorel,
+									insertDesc,
+									&visiMap,
+									fsinfo,
+									movedTupleCount,
+									snapshot);
 
-	AppendOnlyVisimap_DeleteSegmentFile(&visiMap,
-										compact_segno);
+	AppendOnlyVisimap_Finish(&visiMap, NoLock);
 
-	/* Delete all mini pages of the segment files if block directory exists */
-	if (OidIsValid(insertDesc->blkdirrelid))
+	AppendOnlyCompaction_EndMove(estate);
+
+	ExecDropSingleTupleTableSlot(slot);
+	destroy_memtuple_binding(mt_bind);
+
+	aocs_endscan(scanDesc);
+
+	return true;
+}
+
+/*
+ * Compacts several segment files at once, with a background worker scanning
+ * each of them, see appendonly_compaction_worker.c.
+ *
+ * Returns the segment files that the workers could not scan. They must be
+ * compacted serially.
+ */
+static List *
+AOCSSegmentFilesParallelCompaction(Relation aorel,
+								   AOCSInsertDesc insertDesc,
+								   AOCSFileSegInfo **fsinfos,
+								   int nsegs,
+								   Snapshot snapshot)
+{
+	AppendOnlyCompactionWorkers *workers;
+	AppendOnlyVisimap visiMap;
+	TupleTableSlot *slot;
+	ResultRelInfo *resultRelInfo;
+	EState	   *estate;
+	int		   *segnos;
+	int64	   *eofs;
+	int64	   *tupcounts;
+	int64	   *movedTupleCounts;
+	int			segindex;
+	List	   *leftoverSegnos;
+
+	Assert(Gp_role == GP_ROLE_EXECUTE || Gp_role == GP_ROLE_UTILITY);
+	Assert(RelationIsAoCols(aorel));
+	Assert(insertDesc);
+
+	segnos = palloc(nsegs * sizeof(int));
+	eofs = palloc(nsegs * sizeof(int64));
+	tupcounts = palloc(nsegs * sizeof(int64));
+	movedTupleCounts = palloc0(nsegs * sizeof(int64));
+	for (int i = 0; i < nsegs; i++)
 	{
-		AppendOnlyBlockDirectory_DeleteSegmentFile(aorel,
-												   snapshot,
-												   compact_segno,
-												   0);
+		segnos[i] = fsinfos[i]->segno;
+		eofs[i] = AOCSFileSegInfoTotalEof(fsinfos[i]);
+		tupcounts[i] = fsinfos[i]->total_tupcount;
 	}
 
+	AppendOnlyVisimap_Init(&visiMap,
+						   insertDesc->visimaprelid,
+						   insertDesc->visimapidxid,
+						   ShareLock,
+						   snapshot);
+
+	/* The workers send heap tuples */
+	slot = MakeSingleTupleTableSlot(RelationGetDescr(aorel), &TTSOpsHeapTuple);
+	slot->tts_tableOid = RelationGetRelid(aorel);
+
+	estate = AppendOnlyCompaction_BeginMove(aorel);
+	resultRelInfo = estate->es_result_relation_info;
+
 	elogif(Debug_appendonly_print_compaction, LOG,
-		   "Finished compaction: "
-		   "AO segfile %d, relation %s, moved tuple count " INT64_FORMAT,
-		   compact_segno, relname, movedTupleCount);
+		   "Compact %d AO segfiles in parallel, relation %s",
+		   nsegs, RelationGetRelationName(aorel));
+
+	workers = AppendOnlyCompactionWorkers_Launch(aorel, nsegs, segnos,
+												 eofs, tupcounts, snapshot);
+	while (AppendOnlyCompactionWorkers_GetNext(workers, slot, &segindex))
+	{
+		AOCSMoveTuple(slot,
+					  insertDesc,
+					  resultRelInfo,
+					  estate);
+		movedTupleCounts[segindex]++;
+	}
+	leftoverSegnos = AppendOnlyCompactionWorkers_End(workers);
+
+	for (int i = 0; i < nsegs; i++)
+	{
+		if (list_member_int(leftoverSegnos, segnos[i]))
+			continue;
+
+		AOCSSegmentFileFinishCompaction(aorel,
+										insertDesc,
+										&visiMap,
+										fsinfos[i],
+										movedTupleCounts[i],
+										snapshot);
+	}
 
 	AppendOnlyVisimap_Finish(&visiMap, NoLock);
 
-	ExecCloseIndices(resultRelInfo);
-	FreeExecutorState(estate);
+	AppendOnlyCompaction_EndMove(estate);
 
 	ExecDropSingleTupleTableSlot(slot);
-	destroy_memtuple_binding(mt_bind);
 
-	aocs_endscan(scanDesc);
+	pfree(segnos);
+	pfree(eofs);
+	pfree(tupcounts);
+	pfree(movedTupleCounts);
 
-	return true;
+	return leftoverSegnos;
 }
 
 /*
  * Performs a compaction of an append-only relation in column-orientation.
  *
- * The compaction segment file should be locked for this transaction in
+ * The compaction segment files should be locked for this transaction in
  * the appendonlywriter.c code.
  *
+ * If gp_appendonly_compaction_workers is set, the segment files in
+ * 'compaction_segnos' are compacted at once with background workers,
+ * otherwise one after another.
+ *
  * On exit, *insert_segno will be set to the the segment that was used as the
  * insertion target. The segfiles listed in 'avoid_segnos' will not be used
  * for insertion.
@@ -346,14 +491,16 @@ AOCSSegmentFileFullCompaction(Relation aorel,
  */
 void
 AOCSCompact(Relation aorel,
-			int compaction_segno,
+			List *compaction_segnos,
 			int *insert_segno,
 			bool isFull,
 			List *avoid_segnos)
 {
 	const char *relname;
 	AOCSInsertDesc insertDesc = NULL;
-	AOCSFileSegInfo *fsinfo;
+	AOCSFileSegInfo **fsinfos;
+	int			nsegs = 0;
+	ListCell   *lc;
 	Snapshot	appendOnlyMetaDataSnapshot = RegisterSnapshot(GetCatalogSnapshot(InvalidOid));
 
 	Assert(RelationIsAoCols(aorel));
@@ -363,12 +510,28 @@ AOCSCompact(Relation aorel,
 	elogif(Debug_appendonly_print_compaction, LOG,
 		   "Compact AO relation %s", relname);
 
-	/* Fetch under the write lock to get latest committed eof. */
-	fsinfo = GetAOCSFileSegInfo(aorel, appendOnlyMetaDataSnapshot, compaction_segno, true);
+	fsinfos = palloc(list_length(compaction_segnos) * sizeof(AOCSFileSegInfo *));
+	foreach(lc, compaction_segnos)
+	{
+		int			compaction_segno = lfirst_int(lc);
+		AOCSFileSegInfo *fsinfo;
+
+		/* Fetch under the write lock to get latest committed eof. */
+		fsinfo = GetAOCSFileSegInfo(aorel, appendOnlyMetaDataSnapshot, compaction_segno, true);
 
-	if (AppendOnlyCompaction_ShouldCompact(aorel,
-										   compaction_segno, fsinfo->total_tupcount, isFull,
-										   appendOnlyMetaDataSnapshot))
+		if (AppendOnlyCompaction_ShouldCompact(aorel,
+											   compaction_segno, fsinfo->total_tupcount, isFull,
+											   appendOnlyMetaDataSnapshot))
+			fsinfos[nsegs++] = fsinfo;
+		else
+		{
+			/* Nothing to do, but it counts as scanned */
+			AppendOnlyCompaction_ReportProgress(AOCSFileSegInfoTotalEof(fsinfo), 0, 0);
+			pfree(fsinfo);
+		}
+	}
+
+	if (nsegs > 0)
 	{
 		if (*insert_segno == -1)
 		{
@@ -378,12 +541,28 @@ AOCSCompact(Relation aorel,
 
 		if (*insert_segno != -1)
 		{
+			List	   *leftoverSegnos = NIL;
+			bool		parallel = (gp_appendonly_compaction_workers > 0);
+
 			insertDesc = aocs_insert_init(aorel, *insert_segno);
 
-			AOCSSegmentFileFullCompaction(aorel,
-										  insertDesc,
-										  fsinfo,
-										  appendOnlyMetaDataSnapshot);
+			if (parallel)
+				leftoverSegnos = AOCSSegmentFilesParallelCompaction(aorel,
+																	insertDesc,
+																	fsinfos,
+																	nsegs,
+																	appendOnlyMetaDataSnapshot);
+
+			for (int i = 0; i < nsegs; i++)
+			{
+				if (parallel && !list_member_int(leftoverSegnos, fsinfos[i]->segno))
+					continue;
+
+				AOCSSegmentFileFullCompaction(aorel,
+											  insertDesc,
+											  fsinfos[i],
+											  appendOnlyMetaDataSnapshot);
+			}
 
 			insertDesc->skipModCountIncrement = true;
 			aocs_insert_finish(insertDesc);
@@ -394,7 +573,9 @@ AOCSCompact(Relation aorel,
 		}
 	}
 
-	pfree(fsinfo);
+	for (int i = 0; i < nsegs; i++)
+		pfree(fsinfos[i]);
+	pfree(fsinfos);
 
 	UnregisterSnapshot(appendOnlyMetaDataSnapshot);
 }
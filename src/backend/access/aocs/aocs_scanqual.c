@@ -0,0 +1,1029 @@
+/*------------------------------------------------------------------------------
+ *
+ * aocs_scanqual.c
+ *   evaluate simple quals of a scan of an append-only column oriented
+ *   relation on batches of column values.
+ *
+ * Sequential scans of AOCS relations read the values of their columns in
+ * batches, see aocs_getnextbatch. Quals comparing an int4, int8, date or
+ * float8 column with constants, with a btree comparison operator, <> or an
+ * IN list, are evaluated here on the whole vector of values of the column at
+ * once, to a selection bitmap of the rows of the batch. Only the selected
+ * rows are then returned to the executor. The quals are still part of the
+ * plan, and are evaluated again on the returned rows.
+ *
+ * The comparisons use AVX2 or SSE4.2 instructions if the CPU supports them,
+ * which is checked on the first call, and plain C otherwise.
+ *
+ * Copyright (c) 2022-Present VMware, Inc. or its affiliates.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/backend/access/aocs/aocs_scanqual.c
+ *
+ *------------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#if defined(__x86_64__) && defined(HAVE__GET_CPUID) && \
+	(defined(__GNUC__) || defined(__clang__))
+#define USE_SCANQUAL_SIMD 1
+#define scanqual_target(isa) __attribute__((target(isa)))
+#endif
+
+#ifdef USE_SCANQUAL_SIMD
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+#include "access/aocs_scanqual.h"
+#include "access/nbtree.h"
+#include "catalog/pg_type.h"
+#include "nodes/primnodes.h"
+#include "port/pg_bitutils.h"
+#include "utils/array.h"
+#include "utils/date.h"
+#include "utils/float.h"
+#include "utils/lsyscache.h"
+#include "utils/rel.h"
+#include "utils/typcache.h"
+
+typedef void (*scanqual_kernel) (const AOCSScanQual *qual,
+								 const Datum *values, int nrows,
+								 uint64 *selection);
+
+static inline bool scanqual_match(const AOCSScanQual *qual, Datum value);
+static void scanqual_clear_range(uint64 *selection, int first, int last);
+static void scanqual_eval_scalar(const AOCSScanQual *qual,
+								 const Datum *values, int nrows,
+								 uint64 *selection);
+
+#ifdef USE_SCANQUAL_SIMD
+static void scanqual_eval_choose(const AOCSScanQual *qual,
+								 const Datum *values, int nrows,
+								 uint64 *selection);
+static void scanqual_eval_sse42(const AOCSScanQual *qual,
+								const Datum *values, int nrows,
+								uint64 *selection);
+static void scanqual_eval_avx2(const AOCSScanQual *qual,
+							   const Datum *values, int nrows,
+							   uint64 *selection);
+
+static scanqual_kernel scanqual_eval = scanqual_eval_choose;
+#else
+static scanqual_kernel scanqual_eval = scanqual_eval_scalar;
+#endif
+
+/*
+ * Can the expression be the column of a qual?
+ */
+static bool
+scanqual_var_usable(Relation rel, Expr *expr, AOCSScanQualType *type)
+{
+	Var		   *var;
+	Form_pg_attribute attr;
+
+	if (!IsA(expr, Var))
+		return false;
+
+	var = (Var *) expr;
+	if (var->varlevelsup != 0 ||
+		var->varattno <= 0 ||
+		var->varattno > RelationGetNumberOfAttributes(rel))
+		return false;
+
+	attr = TupleDescAttr(RelationGetDescr(rel), var->varattno - 1);
+	if (attr->attisdropped || !attr->attbyval || attr->atttypid != var->vartype)
+		return false;
+
+	switch (var->vartype)
+	{
+		case INT4OID:
+		case DATEOID:
+			*type = AOCSSCANQUAL_INT32;
+			return true;
+		case INT8OID:
+			*type = AOCSSCANQUAL_INT64;
+			return true;
+		case FLOAT8OID:
+			*type = AOCSSCANQUAL_FLOAT8;
+			return true;
+		default:
+			return false;
+	}
+}
+
+/*
+ * Convert a constant to an argument of a qual on a column of the given type.
+ * Integer constants of other widths are accepted if the column type can
+ * represent them.
+ */
+static bool
+scanqual_arg(AOCSScanQual *qual, Oid vartype, Oid argtype, Datum value, int i)
+{
+	int64		intValue;
+
+	if (qual->type == AOCSSCANQUAL_FLOAT8)
+	{
+		if (argtype != FLOAT8OID)
+			return false;
+		qual->floatArgs[i] = DatumGetFloat8(value);
+		if (isnan(qual->floatArgs[i]))
+			qual->argsHaveNaN = true;
+		return true;
+	}
+
+	if (vartype == DATEOID)
+	{
+		if (argtype != DATEOID)
+			return false;
+		intValue = DatumGetDateADT(value);
+	}
+	else if (argtype == INT2OID)
+		intValue = DatumGetInt16(value);
+	else if (argtype == INT4OID)
+		intValue = DatumGetInt32(value);
+	else if (argtype == INT8OID)
+		intValue = DatumGetInt64(value);
+	else
+		return false;
+
+	if (qual->type == AOCSSCANQUAL_INT32 &&
+		(intValue < PG_INT32_MIN || intValue > PG_INT32_MAX))
+		return false;
+
+	qual->intArgs[i] = intValue;
+	return true;
+}
+
+static void
+scanqual_alloc_args(AOCSScanQual *qual, int nargs)
+{
+	qual->nargs = nargs;
+	if (qual->type == AOCSSCANQUAL_FLOAT8)
+		qual->floatArgs = palloc(nargs * sizeof(float8));
+	else
+		qual->intArgs = palloc(nargs * sizeof(int64));
+}
+
+/*
+ * Free the arguments of a qual whose clause turned out to be unusable after
+ * they were allocated.
+ */
+static void
+scanqual_free_args(AOCSScanQual *qual)
+{
+	if (qual->floatArgs)
+		pfree(qual->floatArgs);
+	if (qual->intArgs)
+		pfree(qual->intArgs);
+	qual->floatArgs = NULL;
+	qual->intArgs = NULL;
+	qual->nargs = 0;
+}
+
+/*
+ * Map a btree strategy of the default opfamily of the column type to the
+ * operation of a qual.
+ */
+static AOCSScanQualOp
+scanqual_op_from_strategy(int strategy)
+{
+	switch (strategy)
+	{
+		case BTLessStrategyNumber:
+			return AOCSSCANQUAL_LT;
+		case BTLessEqualStrategyNumber:
+			return AOCSSCANQUAL_LE;
+		case BTEqualStrategyNumber:
+			return AOCSSCANQUAL_EQ;
+		case BTGreaterEqualStrategyNumber:
+			return AOCSSCANQUAL_GE;
+		case BTGreaterStrategyNumber:
+			return AOCSSCANQUAL_GT;
+		default:
+			elog(ERROR, "unexpected btree strategy %d", strategy);
+	}
+}
+
+/*
+ * Turn "column op constant", "constant op column" or "column = ANY(array)"
+ * into a qual, if the operator is a comparison of the default btree
+ * opfamily of the column type, or the negator of its equality.
+ */
+static bool
+scanqual_from_clause(Relation rel, Expr *clause, AOCSScanQual *qual)
+{
+	if (IsA(clause, OpExpr))
+	{
+		OpExpr	   *opexpr = (OpExpr *) clause;
+		Expr	   *leftop;
+		Expr	   *rightop;
+		Var		   *var;
+		Const	   *cnst;
+		bool		varonleft;
+		TypeCacheEntry *typentry;
+		Oid			opno;
+		int			strategy;
+		bool		negated = false;
+		Oid			lefttype;
+		Oid			righttype;
+
+		if (list_length(opexpr->args) != 2)
+			return false;
+
+		leftop = (Expr *) linitial(opexpr->args);
+		rightop = (Expr *) lsecond(opexpr->args);
+
+		if (IsA(rightop, Const) && scanqual_var_usable(rel, leftop, &qual->type))
+		{
+			var = (Var *) leftop;
+			cnst = (Const *) rightop;
+			varonleft = true;
+		}
+		else if (IsA(leftop, Const) && scanqual_var_usable(rel, rightop, &qual->type))
+		{
+			var = (Var *) rightop;
+			cnst = (Const *) leftop;
+			varonleft = false;
+		}
+		else
+			return false;
+
+		if (cnst->constisnull)
+			return false;
+
+		typentry = lookup_type_cache(var->vartype, TYPECACHE_BTREE_OPFAMILY);
+		if (!OidIsValid(typentry->btree_opf))
+			return false;
+
+		opno = opexpr->opno;
+		strategy = get_op_opfamily_strategy(opno, typentry->btree_opf);
+		if (strategy == InvalidStrategy)
+		{
+			/* Maybe it is <>, the negator of = */
+			opno = get_negator(opexpr->opno);
+			if (!OidIsValid(opno) ||
+				get_op_opfamily_strategy(opno, typentry->btree_opf) != BTEqualStrategyNumber)
+				return false;
+			strategy = BTEqualStrategyNumber;
+			negated = true;
+		}
+
+		op_input_types(opno, &lefttype, &righttype);
+		if (!varonleft)
+		{
+			Oid			tmp = lefttype;
+
+			lefttype = righttype;
+			righttype = tmp;
+			strategy = BTCommuteStrategyNumber(strategy);
+		}
+
+		if (lefttype != var->vartype || righttype != cnst->consttype)
+			return false;
+
+		qual->attno = AttrNumberGetAttrOffset(var->varattno);
+		qual->op = negated ? AOCSSCANQUAL_NE : scanqual_op_from_strategy(strategy);
+		scanqual_alloc_args(qual, 1);
+
+		return scanqual_arg(qual, var->vartype, cnst->consttype,
+							cnst->constvalue, 0);
+	}
+	else if (IsA(clause, ScalarArrayOpExpr))
+	{
+		ScalarArrayOpExpr *saop = (ScalarArrayOpExpr *) clause;
+		Expr	   *leftop;
+		Expr	   *rightop;
+		Var		   *var;
+		Const	   *cnst;
+		TypeCacheEntry *typentry;
+		Oid			lefttype;
+		Oid			righttype;
+		ArrayType  *array;
+		int16		elmlen;
+		bool		elmbyval;
+		char		elmalign;
+		Datum	   *elems;
+		bool	   *nulls;
+		int			nelems;
+		int			nargs;
+		bool		usable = true;
+
+		if (!saop->useOr || list_length(saop->args) != 2)
+			return false;
+
+		leftop = (Expr *) linitial(saop->args);
+		rightop = (Expr *) lsecond(saop->args);
+		if (!IsA(rightop, Const) || !scanqual_var_usable(rel, leftop, &qual->type))
+			return false;
+
+		var = (Var *) leftop;
+		cnst = (Const *) rightop;
+		if (cnst->constisnull)
+			return false;
+
+		typentry = lookup_type_cache(var->vartype, TYPECACHE_BTREE_OPFAMILY);
+		if (!OidIsValid(typentry->btree_opf) ||
+			get_op_opfamily_strategy(saop->opno, typentry->btree_opf) != BTEqualStrategyNumber)
+			return false;
+
+		op_input_types(saop->opno, &lefttype, &righttype);
+		if (lefttype != var->vartype)
+			return false;
+
+		array = DatumGetArrayTypeP(cnst->constvalue);
+		if (ARR_ELEMTYPE(array) != righttype)
+			return false;
+
+		get_typlenbyvalalign(righttype, &elmlen, &elmbyval, &elmalign);
+		deconstruct_array(array, righttype, elmlen, elmbyval, elmalign,
+						  &elems, &nulls, &nelems);
+
+		qual->attno = AttrNumberGetAttrOffset(var->varattno);
+		qual->op = AOCSSCANQUAL_IN;
+		scanqual_alloc_args(qual, Max(nelems, 1));
+
+		/* A NULL element never makes the IN list true, so it is left out. */
+		nargs = 0;
+		for (int i = 0; i < nelems; i++)
+		{
+			if (nulls[i])
+				continue;
+			if (!scanqual_arg(qual, var->vartype, righttype, elems[i], nargs))
+			{
+				usable = false;
+				break;
+			}
+			nargs++;
+		}
+		qual->nargs = nargs;
+
+		pfree(elems);
+		pfree(nulls);
+		if ((Pointer) array != DatumGetPointer(cnst->constvalue))
+			pfree(array);
+
+		return usable;
+	}
+
+	return false;
+}
+
+/*
+ * Append the clauses of an implicit-AND list to result, flattening nested
+ * ANDs.
+ */
+static List *
+scanqual_flatten_and(List *result, List *clauses)
+{
+	ListCell   *lc;
+
+	foreach(lc, clauses)
+	{
+		Expr	   *clause = (Expr *) lfirst(lc);
+
+		if (IsA(clause, BoolExpr) && ((BoolExpr *) clause)->boolop == AND_EXPR)
+			result = scanqual_flatten_and(result, ((BoolExpr *) clause)->args);
+		else
+			result = lappend(result, clause);
+	}
+
+	return result;
+}
+
+/*
+ * AOCSScanQual_Build
+ *
+ * Collect the quals of a scan, in implicit-AND form, that can be evaluated
+ * on batches of values. Returns NULL if there are none.
+ */
+AOCSScanQual *
+AOCSScanQual_Build(Relation rel, List *qual, int *numScanQuals)
+{
+	AOCSScanQual *scanQuals = NULL;
+	int			maxScanQuals = 0;
+	List	   *clauses = NIL;
+	ListCell   *lc;
+
+	*numScanQuals = 0;
+
+	clauses = scanqual_flatten_and(clauses, qual);
+
+	foreach(lc, clauses)
+	{
+		AOCSScanQual *scanQual;
+
+		if (*numScanQuals == maxScanQuals)
+		{
+			maxScanQuals = Max(4, maxScanQuals * 2);
+			if (scanQuals == NULL)
+				scanQuals = palloc(maxScanQuals * sizeof(AOCSScanQual));
+			else
+				scanQuals = repalloc(scanQuals, maxScanQuals * sizeof(AOCSScanQual));
+		}
+
+		scanQual = &scanQuals[*numScanQuals];
+		memset(scanQual, 0, sizeof(AOCSScanQual));
+		if (scanqual_from_clause(rel, (Expr *) lfirst(lc), scanQual))
+			(*numScanQuals)++;
+		else
+			scanqual_free_args(scanQual);
+	}
+
+	list_free(clauses);
+
+	if (*numScanQuals == 0 && scanQuals != NULL)
+	{
+		pfree(scanQuals);
+		scanQuals = NULL;
+	}
+
+	return scanQuals;
+}
+
+/*
+ * AOCSScanQual_InitSelection
+ *
+ * Select all the nrows rows of a selection bitmap.
+ */
+void
+AOCSScanQual_InitSelection(uint64 *selection, int nrows)
+{
+	int			nwords = AOCSScanQual_SelectionWords(nrows);
+
+	memset(selection, 0xFF, nwords * sizeof(uint64));
+	if (nrows % 64 != 0)
+		selection[nwords - 1] = (UINT64CONST(1) << (nrows % 64)) - 1;
+}
+
+/*
+ * AOCSScanQual_EvalColumn
+ *
+ * Deselect the rows whose value of column attno, in the vectors values and
+ * isnull, does not satisfy the quals on the column.
+ */
+void
+AOCSScanQual_EvalColumn(AOCSScanQual *scanQuals, int numScanQuals,
+						AttrNumber attno, Datum *values, bool *isnull,
+						int nrows, uint64 *selection)
+{
+	bool		evaluated = false;
+
+	for (int i = 0; i < numScanQuals; i++)
+	{
+		if (scanQuals[i].attno != attno)
+			continue;
+
+		scanqual_eval(&scanQuals[i], values, nrows, selection);
+		evaluated = true;
+	}
+
+	/* A comparison with NULL is never true. */
+	if (evaluated && memchr(isnull, true, nrows) != NULL)
+	{
+		for (int row = 0; row < nrows; row++)
+		{
+			if (isnull[row])
+				selection[row / 64] &= ~(UINT64CONST(1) << (row % 64));
+		}
+	}
+}
+
+/*
+ * AOCSScanQual_EvalRuns
+ *
+ * Like AOCSScanQual_EvalColumn, for a column read as runs of equal values
+ * (see datumstreamread_get_runs): the quals are evaluated once per run, and
+ * the rows of the runs that do not satisfy them are deselected together.
+ */
+void
+AOCSScanQual_EvalRuns(AOCSScanQual *scanQuals, int numScanQuals,
+					  AttrNumber attno, Datum *values, bool *isnull,
+					  int32 *runLengths, int nruns, uint64 *selection)
+{
+	int			row = 0;
+
+	for (int run = 0; run < nruns; run++)
+	{
+		bool		match = !isnull[run];
+
+		for (int i = 0; match && i < numScanQuals; i++)
+		{
+			if (scanQuals[i].attno == attno)
+				match = scanqual_match(&scanQuals[i], values[run]);
+		}
+
+		if (!match)
+			scanqual_clear_range(selection, row, row + runLengths[run]);
+		row += runLengths[run];
+	}
+}
+
+/*
+ * AOCSScanQual_HasColumn
+ *
+ * Is there a qual on column attno?
+ */
+bool
+AOCSScanQual_HasColumn(AOCSScanQual *scanQuals, int numScanQuals,
+					   AttrNumber attno)
+{
+	for (int i = 0; i < numScanQuals; i++)
+	{
+		if (scanQuals[i].attno == attno)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * AOCSScanQual_CountSelected
+ *
+ * Number of selected rows of a selection bitmap of nrows rows.
+ */
+int
+AOCSScanQual_CountSelected(uint64 *selection, int nrows)
+{
+	int			nwords = AOCSScanQual_SelectionWords(nrows);
+	int			nselected = 0;
+
+	for (int w = 0; w < nwords; w++)
+		nselected += pg_popcount64(selection[w]);
+
+	return nselected;
+}
+
+/*
+ * AOCSScanQual_Eval
+ *
+ * Set selection, a bitmap of nrows bits, to the rows whose values satisfy
+ * all the quals. values and isnull are the column vectors of the rows,
+ * indexed by zero based attribute number. Returns the number of selected
+ * rows.
+ */
+int
+AOCSScanQual_Eval(AOCSScanQual *scanQuals, int numScanQuals,
+				  Datum **values, bool **isnull, int nrows,
+				  uint64 *selection)
+{
+	AOCSScanQual_InitSelection(selection, nrows);
+
+	for (int i = 0; i < numScanQuals; i++)
+	{
+		AttrNumber	attno = scanQuals[i].attno;
+
+		/* All the quals on a column are evaluated with its first one. */
+		if (AOCSScanQual_HasColumn(scanQuals, i, attno))
+			continue;
+
+		AOCSScanQual_EvalColumn(scanQuals, numScanQuals, attno,
+								values[attno], isnull[attno], nrows,
+								selection);
+	}
+
+	return AOCSScanQual_CountSelected(selection, nrows);
+}
+
+/*
+ * Clear the bits of rows first up to, but not including, last.
+ */
+static void
+scanqual_clear_range(uint64 *selection, int first, int last)
+{
+	while (first < last)
+	{
+		int			bit = first % 64;
+		int			nbits = Min(64 - bit, last - first);
+		uint64		mask;
+
+		mask = (nbits == 64) ? ~UINT64CONST(0) :
+			((UINT64CONST(1) << nbits) - 1) << bit;
+		selection[first / 64] &= ~mask;
+		first += nbits;
+	}
+}
+
+/*
+ * Scalar evaluation.
+ */
+static inline bool
+scanqual_match_int(const AOCSScanQual *qual, int64 value)
+{
+	const int64 *args = qual->intArgs;
+
+	switch (qual->op)
+	{
+		case AOCSSCANQUAL_LT:
+			return value < args[0];
+		case AOCSSCANQUAL_LE:
+			return value <= args[0];
+		case AOCSSCANQUAL_EQ:
+			return value == args[0];
+		case AOCSSCANQUAL_GE:
+			return value >= args[0];
+		case AOCSSCANQUAL_GT:
+			return value > args[0];
+		case AOCSSCANQUAL_NE:
+			return value != args[0];
+		case AOCSSCANQUAL_IN:
+			for (int i = 0; i < qual->nargs; i++)
+			{
+				if (value == args[i])
+					return true;
+			}
+			return false;
+	}
+	return false;
+}
+
+/* Same semantics as the float8 comparison operators, NaN included */
+static inline bool
+scanqual_match_float8(const AOCSScanQual *qual, float8 value)
+{
+	const float8 *args = qual->floatArgs;
+
+	switch (qual->op)
+	{
+		case AOCSSCANQUAL_LT:
+			return float8_lt(value, args[0]);
+		case AOCSSCANQUAL_LE:
+			return float8_le(value, args[0]);
+		case AOCSSCANQUAL_EQ:
+			return float8_eq(value, args[0]);
+		case AOCSSCANQUAL_GE:
+			return float8_ge(value, args[0]);
+		case AOCSSCANQUAL_GT:
+			return float8_gt(value, args[0]);
+		case AOCSSCANQUAL_NE:
+			return float8_ne(value, args[0]);
+		case AOCSSCANQUAL_IN:
+			for (int i = 0; i < qual->nargs; i++)
+			{
+				if (float8_eq(value, args[i]))
+					return true;
+			}
+			return false;
+	}
+	return false;
+}
+
+static inline bool
+scanqual_match(const AOCSScanQual *qual, Datum value)
+{
+	switch (qual->type)
+	{
+		case AOCSSCANQUAL_INT32:
+			return scanqual_match_int(qual, DatumGetInt32(value));
+		case AOCSSCANQUAL_INT64:
+			return scanqual_match_int(qual, DatumGetInt64(value));
+		case AOCSSCANQUAL_FLOAT8:
+			return scanqual_match_float8(qual, DatumGetFloat8(value));
+	}
+	return false;
+}
+
+/*
+ * Clear the bits of the rows from first up to nrows that do not match.
+ */
+static void
+scanqual_eval_scalar_range(const AOCSScanQual *qual, const Datum *values,
+						   int first, int nrows, uint64 *selection)
+{
+	for (int row = first; row < nrows; row++)
+	{
+		if (!scanqual_match(qual, values[row]))
+			selection[row / 64] &= ~(UINT64CONST(1) << (row % 64));
+	}
+}
+
+static void
+scanqual_eval_scalar(const AOCSScanQual *qual, const Datum *values, int nrows,
+					 uint64 *selection)
+{
+	scanqual_eval_scalar_range(qual, values, 0, nrows, selection);
+}
+
+#ifdef USE_SCANQUAL_SIMD
+
+/*
+ * Integer values are compared as signed 64-bit lanes. A 32-bit value is in
+ * the low half of its Datum, so it is shifted to the high half, which keeps
+ * its order, together with the arguments.
+ */
+static inline int64
+scanqual_int_lane_arg(const AOCSScanQual *qual, int i)
+{
+	if (qual->type == AOCSSCANQUAL_INT32)
+		return (int64) ((uint64) qual->intArgs[i] << 32);
+	return qual->intArgs[i];
+}
+
+/*
+ * SSE4.2 kernel, two values at a time.
+ */
+scanqual_target("sse4.2")
+static inline int
+scanqual_mask_sse42_int(const AOCSScanQual *qual, __m128i v)
+{
+	__m128i		c;
+	__m128i		m;
+
+	if (qual->type == AOCSSCANQUAL_INT32)
+		v = _mm_slli_epi64(v, 32);
+
+	c = _mm_set1_epi64x(scanqual_int_lane_arg(qual, 0));
+	switch (qual->op)
+	{
+		case AOCSSCANQUAL_LT:
+			m = _mm_cmpgt_epi64(c, v);
+			break;
+		case AOCSSCANQUAL_LE:
+			m = _mm_xor_si128(_mm_cmpgt_epi64(v, c), _mm_set1_epi64x(-1));
+			break;
+		case AOCSSCANQUAL_EQ:
+			m = _mm_cmpeq_epi64(v, c);
+			break;
+		case AOCSSCANQUAL_GE:
+			m = _mm_xor_si128(_mm_cmpgt_epi64(c, v), _mm_set1_epi64x(-1));
+			break;
+		case AOCSSCANQUAL_GT:
+			m = _mm_cmpgt_epi64(v, c);
+			break;
+		case AOCSSCANQUAL_NE:
+			m = _mm_xor_si128(_mm_cmpeq_epi64(v, c), _mm_set1_epi64x(-1));
+			break;
+		case AOCSSCANQUAL_IN:
+		default:
+			m = _mm_setzero_si128();
+			for (int i = 0; i < qual->nargs; i++)
+			{
+				c = _mm_set1_epi64x(scanqual_int_lane_arg(qual, i));
+				m = _mm_or_si128(m, _mm_cmpeq_epi64(v, c));
+			}
+			break;
+	}
+
+	return _mm_movemask_pd(_mm_castsi128_pd(m));
+}
+
+scanqual_target("sse4.2")
+static inline int
+scanqual_mask_sse42_float8(const AOCSScanQual *qual, __m128d v)
+{
+	__m128d		c = _mm_set1_pd(qual->floatArgs[0]);
+	__m128d		m;
+
+	switch (qual->op)
+	{
+		case AOCSSCANQUAL_LT:
+			m = _mm_cmplt_pd(v, c);
+			break;
+		case AOCSSCANQUAL_LE:
+			m = _mm_cmple_pd(v, c);
+			break;
+		case AOCSSCANQUAL_EQ:
+			m = _mm_cmpeq_pd(v, c);
+			break;
+		case AOCSSCANQUAL_GE:
+			m = _mm_cmpge_pd(v, c);
+			break;
+		case AOCSSCANQUAL_GT:
+			m = _mm_cmpgt_pd(v, c);
+			break;
+		case AOCSSCANQUAL_NE:
+			m = _mm_cmpneq_pd(v, c);
+			break;
+		case AOCSSCANQUAL_IN:
+		default:
+			m = _mm_setzero_pd();
+			for (int i = 0; i < qual->nargs; i++)
+				m = _mm_or_pd(m, _mm_cmpeq_pd(v, _mm_set1_pd(qual->floatArgs[i])));
+			break;
+	}
+
+	return _mm_movemask_pd(m);
+}
+
+scanqual_target("sse4.2")
+static void
+scanqual_eval_sse42(const AOCSScanQual *qual, const Datum *values, int nrows,
+					uint64 *selection)
+{
+	int			row;
+
+	/* The instructions do not order NaNs like the float8 operators do. */
+	if (qual->type == AOCSSCANQUAL_FLOAT8 && qual->argsHaveNaN)
+	{
+		scanqual_eval_scalar(qual, values, nrows, selection);
+		return;
+	}
+
+	for (row = 0; row + 2 <= nrows; row += 2)
+	{
+		uint64		bits;
+
+		if (qual->type == AOCSSCANQUAL_FLOAT8)
+		{
+			__m128d		v = _mm_loadu_pd((const double *) &values[row]);
+
+			if (_mm_movemask_pd(_mm_cmpunord_pd(v, v)) != 0)
+			{
+				scanqual_eval_scalar_range(qual, values, row, row + 2, selection);
+				continue;
+			}
+			bits = scanqual_mask_sse42_float8(qual, v);
+		}
+		else
+			bits = scanqual_mask_sse42_int(qual,
+										   _mm_loadu_si128((const __m128i *) &values[row]));
+
+		selection[row / 64] &= ~((~bits & 0x3) << (row % 64));
+	}
+
+	scanqual_eval_scalar_range(qual, values, row, nrows, selection);
+}
+
+/*
+ * AVX2 kernel, four values at a time.
+ */
+scanqual_target("avx2")
+static inline int
+scanqual_mask_avx2_int(const AOCSScanQual *qual, __m256i v)
+{
+	__m256i		c;
+	__m256i		m;
+
+	if (qual->type == AOCSSCANQUAL_INT32)
+		v = _mm256_slli_epi64(v, 32);
+
+	c = _mm256_set1_epi64x(scanqual_int_lane_arg(qual, 0));
+	switch (qual->op)
+	{
+		case AOCSSCANQUAL_LT:
+			m = _mm256_cmpgt_epi64(c, v);
+			break;
+		case AOCSSCANQUAL_LE:
+			m = _mm256_xor_si256(_mm256_cmpgt_epi64(v, c), _mm256_set1_epi64x(-1));
+			break;
+		case AOCSSCANQUAL_EQ:
+			m = _mm256_cmpeq_epi64(v, c);
+			break;
+		case AOCSSCANQUAL_GE:
+			m = _mm256_xor_si256(_mm256_cmpgt_epi64(c, v), _mm256_set1_epi64x(-1));
+			break;
+		case AOCSSCANQUAL_GT:
+			m = _mm256_cmpgt_epi64(v, c);
+			break;
+		case AOCSSCANQUAL_NE:
+			m = _mm256_xor_si256(_mm256_cmpeq_epi64(v, c), _mm256_set1_epi64x(-1));
+			break;
+		case AOCSSCANQUAL_IN:
+		default:
+			m = _mm256_setzero_si256();
+			for (int i = 0; i < qual->nargs; i++)
+			{
+				c = _mm256_set1_epi64x(scanqual_int_lane_arg(qual, i));
+				m = _mm256_or_si256(m, _mm256_cmpeq_epi64(v, c));
+			}
+			break;
+	}
+
+	return _mm256_movemask_pd(_mm256_castsi256_pd(m));
+}
+
+scanqual_target("avx2")
+static inline int
+scanqual_mask_avx2_float8(const AOCSScanQual *qual, __m256d v)
+{
+	__m256d		c = _mm256_set1_pd(qual->floatArgs[0]);
+	__m256d		m;
+
+	switch (qual->op)
+	{
+		case AOCSSCANQUAL_LT:
+			m = _mm256_cmp_pd(v, c, _CMP_LT_OQ);
+			break;
+		case AOCSSCANQUAL_LE:
+			m = _mm256_cmp_pd(v, c, _CMP_LE_OQ);
+			break;
+		case AOCSSCANQUAL_EQ:
+			m = _mm256_cmp_pd(v, c, _CMP_EQ_OQ);
+			break;
+		case AOCSSCANQUAL_GE:
+			m = _mm256_cmp_pd(v, c, _CMP_GE_OQ);
+			break;
+		case AOCSSCANQUAL_GT:
+			m = _mm256_cmp_pd(v, c, _CMP_GT_OQ);
+			break;
+		case AOCSSCANQUAL_NE:
+			m = _mm256_cmp_pd(v, c, _CMP_NEQ_OQ);
+			break;
+		case AOCSSCANQUAL_IN:
+		default:
+			m = _mm256_setzero_pd();
+			for (int i = 0; i < qual->nargs; i++)
+				m = _mm256_or_pd(m, _mm256_cmp_pd(v, _mm256_set1_pd(qual->floatArgs[i]),
+												  _CMP_EQ_OQ));
+			break;
+	}
+
+	return _mm256_movemask_pd(m);
+}
+
+scanqual_target("avx2")
+static void
+scanqual_eval_avx2(const AOCSScanQual *qual, const Datum *values, int nrows,
+				   uint64 *selection)
+{
+	int			row;
+
+	/* The instructions do not order NaNs like the float8 operators do. */
+	if (qual->type == AOCSSCANQUAL_FLOAT8 && qual->argsHaveNaN)
+	{
+		scanqual_eval_scalar(qual, values, nrows, selection);
+		return;
+	}
+
+	for (row = 0; row + 4 <= nrows; row += 4)
+	{
+		uint64		bits;
+
+		if (qual->type == AOCSSCANQUAL_FLOAT8)
+		{
+			__m256d		v = _mm256_loadu_pd((const double *) &values[row]);
+
+			if (_mm256_movemask_pd(_mm256_cmp_pd(v, v, _CMP_UNORD_Q)) != 0)
+			{
+				scanqual_eval_scalar_range(qual, values, row, row + 4, selection);
+				continue;
+			}
+			bits = scanqual_mask_avx2_float8(qual, v);
+		}
+		else
+			bits = scanqual_mask_avx2_int(qual,
+										  _mm256_loadu_si256((const __m256i *) &values[row]));
+
+		selection[row / 64] &= ~((~bits & 0xF) << (row % 64));
+	}
+
+	scanqual_eval_scalar_range(qual, values, row, nrows, selection);
+}
+
+/*
+ * Does the CPU, and the OS, support AVX2?
+ */
+static bool
+scanqual_avx2_available(void)
+{
+	unsigned int exx[4] = {0, 0, 0, 0};
+	uint32		xcr0_lo;
+	uint32		xcr0_hi;
+
+	if (__get_cpuid_max(0, NULL) < 7)
+		return false;
+
+	__get_cpuid(1, &exx[0], &exx[1], &exx[2], &exx[3]);
+	if ((exx[2] & (1 << 27)) == 0 ||	/* OSXSAVE */
+		(exx[2] & (1 << 28)) == 0)		/* AVX */
+		return false;
+
+	/* The OS must save the YMM registers. */
+	__asm__ __volatile__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+	if ((xcr0_lo & 0x6) != 0x6)
+		return false;
+
+	__cpuid_count(7, 0, exx[0], exx[1], exx[2], exx[3]);
+
+	return (exx[1] & (1 << 5)) != 0;	/* AVX2 */
+}
+
+static bool
+scanqual_sse42_available(void)
+{
+	unsigned int exx[4] = {0, 0, 0, 0};
+
+	__get_cpuid(1, &exx[0], &exx[1], &exx[2], &exx[3]);
+
+	return (exx[2] & (1 << 20)) != 0;	/* SSE 4.2 */
+}
+
+/*
+ * This gets called on the first call. It replaces the function pointer
+ * so that subsequent calls are routed directly to the chosen implementation.
+ */
+static void
+scanqual_eval_choose(const AOCSScanQual *qual, const Datum *values, int nrows,
+					 uint64 *selection)
+{
+	if (scanqual_avx2_available())
+		scanqual_eval = scanqual_eval_avx2;
+	else if (scanqual_sse42_available())
+		scanqual_eval = scanqual_eval_sse42;
+	else
+		scanqual_eval = scanqual_eval_scalar;
+
+	scanqual_eval(qual, values, nrows, selection);
+}
+
+#endif							/* USE_SCANQUAL_SIMD */
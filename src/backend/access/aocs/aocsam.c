@@ -16,6 +16,7 @@
 #include "postgres.h"
 
 #include "common/relpath.h"
+#include "access/aocs_scanqual.h"
 #include "access/aocssegfiles.h"
 #include "access/aomd.h"
 #include "access/appendonlytid.h"
@@ -56,6 +57,10 @@ static AOCSScanDesc aocs_beginscan_internal(Relation relation,
 						Snapshot appendOnlyMetaDataSnapshot,
 						bool *proj,
 						uint32 flags);
+static void upgrade_datum_scan(AOCSScanDesc scan, int attno, Datum values[],
+							   bool isnull[], int formatversion);
+static void upgrade_datum_impl(DatumStreamRead *ds, int attno, Datum values[],
+							   bool isnull[], int formatversion);
 
 /*
  * Open the segment file for a specified column associated with the datum
@@ -328,6 +333,174 @@ aocs_initscan(AOCSScanDesc scan)
 	pgstat_count_heap_scan(scan->rs_base.rs_rd);
 }
 
+/*
+ * Read the next block of a column of the scan, skipping the blocks that the
+ * zone maps show to have no row satisfying the scan quals. Returns -1 at the
+ * end of the segment file.
+ */
+static int
+read_next_scan_block(AOCSScanDesc scan, AttrNumber attno)
+{
+	DatumStreamRead *ds = scan->columnScanInfo.ds[attno];
+
+	if (scan->zonemap == NULL)
+		return datumstreamread_block(ds, scan->blockDirectory, attno);
+
+	Assert(scan->blockDirectory == NULL);
+
+	for (;;)
+	{
+		if (!datumstreamread_block_header(ds))
+			return -1;
+
+		/* Blocks that do not store their first row number are never skipped. */
+		if (ds->getBlockInfo.firstRow < 0 ||
+			!AppendOnlyZoneMap_SkipRows(scan->zonemap, ds->blockFirstRowNum,
+										ds->blockRowCount))
+			break;
+
+		datumstreamread_skip_block(ds);
+		scan->zonemapSkipped = true;
+	}
+
+	datumstreamread_block_content(ds);
+
+	return 0;
+}
+
+/*
+ * After a block of some column was skipped, the columns of the scan can be
+ * positioned on different rows. Advance the columns that lag behind to the
+ * row of the column that is furthest ahead, until all of them are on the
+ * same row, and fetch their datums again. All the rows passed over were
+ * refuted by the zone maps of the column that skipped them.
+ *
+ * Returns false if a column reached the end of the segment file.
+ */
+static bool
+align_scan_columns(AOCSScanDesc scan, Datum *d, bool *null,
+				   int formatversion, int64 *rowNum)
+{
+	AttrNumber *proj_atts = scan->columnScanInfo.proj_atts;
+	AttrNumber	num_proj_atts = scan->columnScanInfo.num_proj_atts;
+	int64		targetRowNum;
+	bool		aligned;
+
+	do
+	{
+		targetRowNum = INT64CONST(-1);
+		for (AttrNumber i = 0; i < num_proj_atts; i++)
+		{
+			DatumStreamRead *ds = scan->columnScanInfo.ds[proj_atts[i]];
+
+			targetRowNum = Max(targetRowNum,
+							   ds->blockFirstRowNum + datumstreamread_nth(ds));
+		}
+
+		aligned = true;
+		for (AttrNumber i = 0; i < num_proj_atts; i++)
+		{
+			AttrNumber	attno = proj_atts[i];
+			DatumStreamRead *ds = scan->columnScanInfo.ds[attno];
+			bool		moved = false;
+
+			while (ds->blockFirstRowNum + datumstreamread_nth(ds) < targetRowNum)
+			{
+				if (datumstreamread_advance(ds) == 0)
+				{
+					if (read_next_scan_block(scan, attno) < 0)
+						return false;
+					datumstreamread_advance(ds);
+				}
+				moved = true;
+			}
+
+			if (!moved)
+				continue;
+
+			datumstreamread_get(ds, &d[attno], &null[attno]);
+			if (formatversion < AORelationVersion_GetLatest())
+				upgrade_datum_scan(scan, attno, d, null, formatversion);
+
+			/* A skipped block can take the column past the target. */
+			if (ds->blockFirstRowNum + datumstreamread_nth(ds) != targetRowNum)
+				aligned = false;
+		}
+	} while (!aligned);
+
+	*rowNum = targetRowNum;
+
+	return true;
+}
+
+/*
+ * Row number of the next row of a column, the one after its current position.
+ */
+static inline int64
+scan_next_rownum(DatumStreamRead *ds)
+{
+	return ds->blockFirstRowNum + ds->blockRowCount - datumstreamread_remaining(ds);
+}
+
+/*
+ * Position all the projected columns of the scan before the same row, with
+ * rows left in their current blocks, reading the next blocks as needed. Like
+ * align_scan_columns, the rows passed over to align the columns are those
+ * refuted by the zone maps.
+ *
+ * Returns false if a column reached the end of the segment file.
+ */
+static bool
+position_scan_batch(AOCSScanDesc scan)
+{
+	AttrNumber *proj_atts = scan->columnScanInfo.proj_atts;
+	AttrNumber	num_proj_atts = scan->columnScanInfo.num_proj_atts;
+	bool		aligned;
+
+	do
+	{
+		int64		targetRowNum = INT64CONST(-1);
+
+		for (AttrNumber i = 0; i < num_proj_atts; i++)
+		{
+			AttrNumber	attno = proj_atts[i];
+			DatumStreamRead *ds = scan->columnScanInfo.ds[attno];
+
+			if (datumstreamread_remaining(ds) == 0 &&
+				read_next_scan_block(scan, attno) < 0)
+				return false;
+
+			targetRowNum = Max(targetRowNum, scan_next_rownum(ds));
+		}
+
+		/* Unless a block was skipped, the columns advance in lockstep. */
+		if (!scan->zonemapSkipped)
+			return true;
+
+		aligned = true;
+		for (AttrNumber i = 0; i < num_proj_atts; i++)
+		{
+			AttrNumber	attno = proj_atts[i];
+			DatumStreamRead *ds = scan->columnScanInfo.ds[attno];
+
+			while (scan_next_rownum(ds) < targetRowNum)
+			{
+				if (datumstreamread_remaining(ds) > 0)
+					datumstreamread_advance(ds);
+				else if (read_next_scan_block(scan, attno) < 0)
+					return false;
+			}
+
+			/* A skipped block can take the column past the target. */
+			if (scan_next_rownum(ds) != targetRowNum ||
+				datumstreamread_remaining(ds) == 0)
+				aligned = false;
+		}
+	} while (!aligned);
+
+	return true;
+}
+
 static int
 open_next_scan_seg(AOCSScanDesc scan)
 {
@@ -411,6 +584,11 @@ open_next_scan_seg(AOCSScanDesc scan)
 											firstSequence);
 				}
 
+				if (scan->zonemap)
+					AppendOnlyZoneMap_LoadSegmentFile(scan->zonemap,
+													  curSegInfo->segno);
+				scan->zonemapSkipped = false;
+
 				open_all_datumstreamread_segfiles(scan->rs_base.rs_rd,
 												  curSegInfo,
 												  scan->columnScanInfo.ds,
@@ -598,6 +776,10 @@ aocs_rescan(AOCSScanDesc scan)
 	if (scan->columnScanInfo.ds)
 		close_ds_read(scan->columnScanInfo.ds, scan->columnScanInfo.relationTupleDesc->natts);
 	aocs_initscan(scan);
+
+	if (scan->batch)
+		scan->batch->nrows = 0;
+	scan->batchNextRow = 0;
 }
 
 void
@@ -639,6 +821,30 @@ aocs_endscan(AOCSScanDesc scan)
 	if (scan->total_seg != 0)
 		AppendOnlyVisimap_Finish(&scan->visibilityMap, AccessShareLock);
 
+	if (scan->zonemap)
+		AppendOnlyZoneMap_End(scan->zonemap);
+
+	if (scan->batch)
+	{
+		for (AttrNumber attno = 0; attno < scan->batch->natts; attno++)
+		{
+			if (scan->batch->values[attno])
+			{
+				pfree(scan->batch->values[attno]);
+				pfree(scan->batch->isnull[attno]);
+			}
+		}
+		pfree(scan->batch->values);
+		pfree(scan->batch->isnull);
+		pfree(scan->batch->tids);
+		pfree(scan->batch->selection);
+		pfree(scan->batch->runValues);
+		pfree(scan->batch->runIsnull);
+		pfree(scan->batch->runLengths);
+		pfree(scan->batch->visible);
+		pfree(scan->batch);
+	}
+
 	RelationDecrementReferenceCount(scan->rs_base.rs_rd);
 
 	pfree(scan);
@@ -743,6 +949,41 @@ aocs_getnext(AOCSScanDesc scan, ScanDirection direction, TupleTableSlot *slot)
 	natts = slot->tts_tupleDescriptor->natts;
 	Assert(natts <= scan->columnScanInfo.relationTupleDesc->natts);
 
+	/*
+	 * If the scan reads batches, return the next row of the current batch;
+	 * the values are only copied, not read from the datum streams.
+	 */
+	if (scan->batch != NULL)
+	{
+		AOCSBatch  *batch = scan->batch;
+		int			row;
+
+		if (scan->batchNextRow >= batch->nrows)
+		{
+			if (!aocs_getnextbatch(scan, batch))
+			{
+				ExecClearTuple(slot);
+				return false;
+			}
+			scan->batchNextRow = 0;
+		}
+
+		row = scan->batchNextRow++;
+		for (AttrNumber i = 0; i < scan->columnScanInfo.num_proj_atts; i++)
+		{
+			AttrNumber	attno = scan->columnScanInfo.proj_atts[i];
+
+			d[attno] = batch->values[attno][row];
+			null[attno] = batch->isnull[attno][row];
+		}
+
+		scan->cdb_fake_ctid = *((ItemPointer) &batch->tids[row]);
+
+		slot->tts_nvalid = natts;
+		slot->tts_tid = scan->cdb_fake_ctid;
+		return true;
+	}
+
 	while (1)
 	{
 		AOCSFileSegInfo *curseginfo;
@@ -774,7 +1015,7 @@ ReadNext:
 			Assert(err >= 0);
 			if (err == 0)
 			{
-				err = datumstreamread_block(scan->columnScanInfo.ds[attno], scan->blockDirectory, attno);
+				err = read_next_scan_block(scan, attno);
 				if (err < 0)
 				{
 					/*
@@ -812,6 +1053,16 @@ ReadNext:
 			}
 		}
 
+		if (scan->zonemapSkipped &&
+			!align_scan_columns(scan, d, null, curseginfo->formatversion,
+								&rowNum))
+		{
+			close_cur_scan_seg(scan);
+			err = -1;
+			rowNum = INT64CONST(-1);
+			goto ReadNext;
+		}
+
 		scan->cur_seg_row++;
 		if (rowNum == INT64CONST(-1))
 		{
@@ -845,6 +1096,268 @@ ReadNext:
 	return false;
 }
 
+/*
+ * Create a batch of up to maxRows rows for aocs_getnextbatch. The batch is
+ * allocated in the memory context of the scan.
+ */
+AOCSBatch *
+aocs_create_batch(AOCSScanDesc scan, int maxRows)
+{
+	MemoryContext oldCtx;
+	AOCSBatch  *batch;
+
+	Assert(maxRows > 0);
+
+	oldCtx = MemoryContextSwitchTo(scan->columnScanInfo.scanCtx);
+
+	batch = (AOCSBatch *) palloc0(sizeof(AOCSBatch));
+	batch->maxRows = maxRows;
+	batch->nrows = 0;
+	batch->natts = RelationGetNumberOfAttributes(scan->rs_base.rs_rd);
+	batch->values = (Datum **) palloc0(batch->natts * sizeof(Datum *));
+	batch->isnull = (bool **) palloc0(batch->natts * sizeof(bool *));
+	batch->tids = (AOTupleId *) palloc(maxRows * sizeof(AOTupleId));
+	batch->selection = (uint64 *)
+		palloc(AOCSScanQual_SelectionWords(maxRows) * sizeof(uint64));
+	batch->runValues = (Datum *) palloc(maxRows * sizeof(Datum));
+	batch->runIsnull = (bool *) palloc(maxRows * sizeof(bool));
+	batch->runLengths = (int32 *) palloc(maxRows * sizeof(int32));
+	batch->visible = (bool *) palloc(maxRows * sizeof(bool));
+
+	MemoryContextSwitchTo(oldCtx);
+
+	return batch;
+}
+
+/*
+ * Read the next batch of visible rows of the scan.
+ *
+ * Each projected column is read from its current block with one call into
+ * the datum stream, instead of one call per row. A batch ends at the first
+ * block boundary of any of the columns, so it can hold fewer than maxRows
+ * rows even before the invisible ones are removed. If the scan has quals
+ * that can be evaluated on the vectors, the rows that do not satisfy them
+ * are removed too.
+ *
+ * Returns false at the end of the scan.
+ */
+bool
+aocs_getnextbatch(AOCSScanDesc scan, AOCSBatch *batch)
+{
+	bool		isSnapshotAny = (scan->rs_base.rs_snapshot == SnapshotAny);
+	AttrNumber *proj_atts;
+	AttrNumber	num_proj_atts;
+
+	if (scan->columnScanInfo.relationTupleDesc == NULL)
+	{
+		scan->columnScanInfo.relationTupleDesc = RelationGetDescr(scan->rs_base.rs_rd);
+		/* Pin it! ... and of course release it upon destruction / rescan */
+		PinTupleDesc(scan->columnScanInfo.relationTupleDesc);
+		aocs_initscan(scan);
+	}
+
+	proj_atts = scan->columnScanInfo.proj_atts;
+	num_proj_atts = scan->columnScanInfo.num_proj_atts;
+	Assert(num_proj_atts > 0);
+
+	for (AttrNumber i = 0; i < num_proj_atts; i++)
+	{
+		AttrNumber	attno = proj_atts[i];
+
+		Assert(attno < batch->natts);
+		if (batch->values[attno] == NULL)
+		{
+			batch->values[attno] = (Datum *)
+				MemoryContextAlloc(scan->columnScanInfo.scanCtx,
+								   batch->maxRows * sizeof(Datum));
+			batch->isnull[attno] = (bool *)
+				MemoryContextAlloc(scan->columnScanInfo.scanCtx,
+								   batch->maxRows * sizeof(bool));
+		}
+	}
+
+	batch->nrows = 0;
+
+	for (;;)
+	{
+		AOCSFileSegInfo *curseginfo;
+		DatumStreamRead *firstds;
+		int64		firstRowNum = INT64CONST(-1);
+		int			nrows;
+		int			nvisible;
+		bool		allVisible;
+
+		/* If necessary, open next seg */
+		if (scan->cur_seg < 0 || !position_scan_batch(scan))
+		{
+			close_cur_scan_seg(scan);
+			if (open_next_scan_seg(scan) < 0)
+			{
+				/* No more seg, we are at the end */
+				scan->cur_seg = -1;
+				return false;
+			}
+			scan->cur_seg_row = 0;
+			continue;
+		}
+
+		curseginfo = scan->seginfo[scan->cur_seg];
+
+		nrows = batch->maxRows;
+		for (AttrNumber i = 0; i < num_proj_atts; i++)
+			nrows = Min(nrows, datumstreamread_remaining(scan->columnScanInfo.ds[proj_atts[i]]));
+
+		/* The upgraded values share one buffer per column. */
+		if (PG82NumericConversionNeeded(curseginfo->formatversion))
+			nrows = 1;
+
+		Assert(nrows > 0);
+
+		firstds = scan->columnScanInfo.ds[proj_atts[0]];
+		if (firstds->blockFirstRowNum != INT64CONST(-1))
+			firstRowNum = scan_next_rownum(firstds);
+
+		if (scan->numScanQuals > 0)
+			AOCSScanQual_InitSelection(batch->selection, nrows);
+
+		for (AttrNumber i = 0; i < num_proj_atts; i++)
+		{
+			AttrNumber	attno = proj_atts[i];
+			DatumStreamRead *ds = scan->columnScanInfo.ds[attno];
+			bool		hasQuals;
+			int			n PG_USED_FOR_ASSERTS_ONLY;
+
+			hasQuals = scan->numScanQuals > 0 &&
+				AOCSScanQual_HasColumn(scan->scanQuals, scan->numScanQuals, attno);
+
+			if (hasQuals && datumstreamread_has_runs(ds))
+			{
+				/*
+				 * Evaluate the quals once per run of an RLE_TYPE compressed
+				 * block, and only then expand the runs.
+				 */
+				int			nruns;
+				int			row = 0;
+
+				nruns = datumstreamread_get_runs(ds, nrows,
+												 batch->runValues,
+												 batch->runIsnull,
+												 batch->runLengths,
+												 &n);
+				Assert(n == nrows);
+
+				AOCSScanQual_EvalRuns(scan->scanQuals, scan->numScanQuals,
+									  attno,
+									  batch->runValues, batch->runIsnull,
+									  batch->runLengths, nruns,
+									  batch->selection);
+
+				for (int run = 0; run < nruns; run++)
+				{
+					for (int j = 0; j < batch->runLengths[run]; j++, row++)
+					{
+						batch->values[attno][row] = batch->runValues[run];
+						batch->isnull[attno][row] = batch->runIsnull[run];
+					}
+				}
+			}
+			else
+			{
+				n = datumstreamread_get_batch(ds, nrows,
+											  batch->values[attno],
+											  batch->isnull[attno]);
+				Assert(n == nrows);
+
+				if (hasQuals)
+					AOCSScanQual_EvalColumn(scan->scanQuals,
+											scan->numScanQuals, attno,
+											batch->values[attno],
+											batch->isnull[attno],
+											nrows, batch->selection);
+			}
+
+			/*
+			 * Perform any required upgrades on the Datums we just fetched.
+			 */
+			if (curseginfo->formatversion < AORelationVersion_GetLatest())
+			{
+				for (int row = 0; row < nrows; row++)
+					upgrade_datum_impl(ds, row,
+									   batch->values[attno],
+									   batch->isnull[attno],
+									   curseginfo->formatversion);
+			}
+		}
+
+		if (scan->numScanQuals > 0 &&
+			AOCSScanQual_CountSelected(batch->selection, nrows) == 0)
+		{
+			scan->cur_seg_row += nrows;
+			continue;
+		}
+
+		/*
+		 * The rows of the batch are consecutive, so look up the visibility
+		 * of all of them at once.
+		 */
+		if (firstRowNum == INT64CONST(-1))
+			firstRowNum = scan->cur_seg_row + 1;
+		allVisible = true;
+		if (!isSnapshotAny)
+		{
+			int			nvisibleRows;
+
+			nvisibleRows = AppendOnlyVisimap_GetVisibility(&scan->visibilityMap,
+														   curseginfo->segno,
+														   firstRowNum, nrows,
+														   batch->visible);
+			if (nvisibleRows == 0)
+			{
+				scan->cur_seg_row += nrows;
+				continue;
+			}
+			allVisible = (nvisibleRows == nrows);
+		}
+
+		/*
+		 * Assign the TIDs, and squeeze out the rows that are invisible or
+		 * do not satisfy the quals.
+		 */
+		nvisible = 0;
+		for (int row = 0; row < nrows; row++)
+		{
+			if (scan->numScanQuals > 0 &&
+				(batch->selection[row / 64] & (UINT64CONST(1) << (row % 64))) == 0)
+				continue;
+
+			if (!allVisible && !batch->visible[row])
+				continue;
+
+			AOTupleIdInit(&batch->tids[nvisible], curseginfo->segno,
+						  firstRowNum + row);
+
+			if (nvisible != row)
+			{
+				for (AttrNumber i = 0; i < num_proj_atts; i++)
+				{
+					AttrNumber	attno = proj_atts[i];
+
+					batch->values[attno][nvisible] = batch->values[attno][row];
+					batch->isnull[attno][nvisible] = batch->isnull[attno][row];
+				}
+			}
+			nvisible++;
+		}
+		scan->cur_seg_row += nrows;
+
+		if (nvisible > 0)
+		{
+			batch->nrows = nvisible;
+			return true;
+		}
+	}
+}
+
 
 /* Open next file segment for write.  See SetCurrentFileSegForWrite */
 /* XXX Right now, we put each column to different files */
@@ -1063,6 +1576,10 @@ aocs_insert_values(AOCSInsertDesc idesc, Datum *d, bool *null, AOTupleId *aoTupl
 			}
 		}
 
+		/* Only now that the previous block, if full, has its entry. */
+		AppendOnlyBlockDirectory_AddZoneMapValues(&idesc->blockDirectory, i,
+												  &d[i], &null[i]);
+
 		if (toFree1 != NULL)
 			pfree(toFree1);
 	}
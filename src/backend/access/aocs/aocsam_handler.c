@@ -14,6 +14,7 @@
  */
 #include "postgres.h"
 
+#include "access/aocs_scanqual.h"
 #include "access/aomd.h"
 #include "access/appendonlywriter.h"
 #include "access/heapam.h"
@@ -38,6 +39,7 @@
 #include "storage/smgr.h"
 #include "utils/builtins.h"
 #include "utils/faultinjector.h"
+#include "utils/guc.h"
 #include "utils/lsyscache.h"
 #include "utils/pg_rusage.h"
 
@@ -446,6 +448,20 @@ aoco_beginscan_extractcolumns(Relation rel, Snapshot snapshot,
 							cols,
 							flags);
 
+	aoscan->zonemap = AppendOnlyZoneMap_Begin(rel,
+											  aoscan->appendOnlyMetaDataSnapshot,
+											  qual,
+											  true /* isAOCol */);
+
+	/* Read the columns in batches rather than a row at a time */
+	if (gp_appendonly_scan_batch_size > 0 && natts > 0)
+	{
+		aoscan->batch = aocs_create_batch(aoscan, gp_appendonly_scan_batch_size);
+
+		/* and filter the batches with the simple quals, vector at a time */
+		aoscan->scanQuals = AOCSScanQual_Build(rel, qual, &aoscan->numScanQuals);
+	}
+
 	pfree(cols);
 
 	return (TableScanDesc)aoscan;
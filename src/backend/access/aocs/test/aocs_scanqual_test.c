@@ -0,0 +1,227 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include "cmockery.h"
+
+#include "postgres.h"
+#include "utils/memutils.h"
+
+#include "../aocs_scanqual.c"
+
+#define NROWS	203				/* not a multiple of the vector widths */
+
+static const AOCSScanQualOp all_ops[] = {
+	AOCSSCANQUAL_LT, AOCSSCANQUAL_LE, AOCSSCANQUAL_EQ, AOCSSCANQUAL_GE,
+	AOCSSCANQUAL_GT, AOCSSCANQUAL_NE, AOCSSCANQUAL_IN
+};
+
+static void
+init_qual(AOCSScanQual *qual, AOCSScanQualType type, AOCSScanQualOp op,
+		  int64 *intArgs, float8 *floatArgs, int nargs)
+{
+	memset(qual, 0, sizeof(AOCSScanQual));
+	qual->attno = 0;
+	qual->type = type;
+	qual->op = op;
+	qual->nargs = (op == AOCSSCANQUAL_IN) ? nargs : 1;
+	qual->intArgs = intArgs;
+	qual->floatArgs = floatArgs;
+	for (int i = 0; floatArgs && i < qual->nargs; i++)
+	{
+		if (isnan(floatArgs[i]))
+			qual->argsHaveNaN = true;
+	}
+}
+
+/*
+ * Check a kernel against scanqual_match, row by row.
+ */
+static void
+check_kernel(scanqual_kernel kernel, AOCSScanQual *qual, Datum *values)
+{
+	uint64		selection[AOCSScanQual_SelectionWords(NROWS)];
+
+	memset(selection, 0xFF, sizeof(selection));
+	kernel(qual, values, NROWS, selection);
+
+	for (int row = 0; row < NROWS; row++)
+	{
+		bool		selected = (selection[row / 64] >> (row % 64)) & 1;
+
+		assert_int_equal(selected, scanqual_match(qual, values[row]));
+	}
+}
+
+static void
+check_all_kernels(AOCSScanQual *qual, Datum *values)
+{
+	check_kernel(scanqual_eval_scalar, qual, values);
+#ifdef USE_SCANQUAL_SIMD
+	if (scanqual_sse42_available())
+		check_kernel(scanqual_eval_sse42, qual, values);
+	if (scanqual_avx2_available())
+		check_kernel(scanqual_eval_avx2, qual, values);
+#endif
+}
+
+static void
+test__AOCSScanQual_Eval__int32(void **state)
+{
+	Datum		values[NROWS];
+	int64		args[] = {-3, 0, 7, PG_INT32_MIN};
+	AOCSScanQual qual;
+
+	for (int row = 0; row < NROWS; row++)
+		values[row] = Int32GetDatum((row % 2 ? -1 : 1) * (row % 11));
+	values[5] = Int32GetDatum(PG_INT32_MIN);
+	values[6] = Int32GetDatum(PG_INT32_MAX);
+
+	for (int i = 0; i < lengthof(all_ops); i++)
+	{
+		init_qual(&qual, AOCSSCANQUAL_INT32, all_ops[i], args, NULL,
+				  lengthof(args));
+		check_all_kernels(&qual, values);
+	}
+}
+
+static void
+test__AOCSScanQual_Eval__int64(void **state)
+{
+	Datum		values[NROWS];
+	int64		args[] = {INT64CONST(-5000000000), 0, 9, PG_INT64_MAX};
+	AOCSScanQual qual;
+
+	for (int row = 0; row < NROWS; row++)
+		values[row] = Int64GetDatum((row % 3 - 1) * INT64CONST(5000000000) + row % 10);
+	values[7] = Int64GetDatum(PG_INT64_MIN);
+	values[8] = Int64GetDatum(PG_INT64_MAX);
+
+	for (int i = 0; i < lengthof(all_ops); i++)
+	{
+		init_qual(&qual, AOCSSCANQUAL_INT64, all_ops[i], args, NULL,
+				  lengthof(args));
+		check_all_kernels(&qual, values);
+	}
+}
+
+static void
+test__AOCSScanQual_Eval__float8(void **state)
+{
+	Datum		values[NROWS];
+	float8		args[] = {0.5, -2.0, get_float8_infinity()};
+	float8		nanArgs[] = {get_float8_nan(), 1.0};
+	AOCSScanQual qual;
+
+	for (int row = 0; row < NROWS; row++)
+		values[row] = Float8GetDatum((row % 9) * 0.25 - 1.0);
+	values[10] = Float8GetDatum(get_float8_nan());
+	values[101] = Float8GetDatum(get_float8_infinity());
+	values[202] = Float8GetDatum(-get_float8_infinity());
+
+	for (int i = 0; i < lengthof(all_ops); i++)
+	{
+		init_qual(&qual, AOCSSCANQUAL_FLOAT8, all_ops[i], NULL, args,
+				  lengthof(args));
+		check_all_kernels(&qual, values);
+
+		/* NaN is equal to NaN and greater than any other value */
+		init_qual(&qual, AOCSSCANQUAL_FLOAT8, all_ops[i], NULL, nanArgs,
+				  lengthof(nanArgs));
+		check_all_kernels(&qual, values);
+	}
+}
+
+static void
+test__AOCSScanQual_Eval__nulls(void **state)
+{
+	Datum		col0[NROWS];
+	Datum		col1[NROWS];
+	bool		nulls0[NROWS];
+	bool		nulls1[NROWS];
+	Datum	   *values[] = {col0, col1};
+	bool	   *isnull[] = {nulls0, nulls1};
+	int64		args0[] = {100};
+	int64		args1[] = {0};
+	AOCSScanQual quals[2];
+	uint64		selection[AOCSScanQual_SelectionWords(NROWS)];
+	int			nselected;
+	int			expected = 0;
+
+	for (int row = 0; row < NROWS; row++)
+	{
+		col0[row] = Int32GetDatum(row);
+		nulls0[row] = (row % 5 == 0);
+		col1[row] = Int64GetDatum(row % 2);
+		nulls1[row] = false;
+	}
+
+	/* col0 < 100 AND col1 <> 0 */
+	init_qual(&quals[0], AOCSSCANQUAL_INT32, AOCSSCANQUAL_LT, args0, NULL, 1);
+	init_qual(&quals[1], AOCSSCANQUAL_INT64, AOCSSCANQUAL_NE, args1, NULL, 1);
+	quals[1].attno = 1;
+
+	nselected = AOCSScanQual_Eval(quals, 2, values, isnull, NROWS, selection);
+
+	for (int row = 0; row < NROWS; row++)
+	{
+		bool		selected = (selection[row / 64] >> (row % 64)) & 1;
+		bool		match = (row < 100 && row % 2 == 1 && row % 5 != 0);
+
+		assert_int_equal(selected, match);
+		if (match)
+			expected++;
+	}
+	assert_int_equal(nselected, expected);
+
+	/* No bits are set past the last row. */
+	assert_true((selection[NROWS / 64] >> (NROWS % 64)) == 0);
+}
+
+static void
+test__AOCSScanQual_EvalRuns(void **state)
+{
+	Datum		runValues[] = {Int32GetDatum(1), Int32GetDatum(5), 0,
+							   Int32GetDatum(2), Int32GetDatum(7)};
+	bool		runIsnull[] = {false, false, true, false, false};
+	int32		runLengths[] = {3, 70, 1, 60, 69};
+	int64		args[] = {2, 6};
+	AOCSScanQual quals[2];
+	uint64		selection[AOCSScanQual_SelectionWords(NROWS)];
+	int			row = 0;
+
+	/* col0 >= 2 AND col0 <> 6 */
+	init_qual(&quals[0], AOCSSCANQUAL_INT32, AOCSSCANQUAL_GE, &args[0], NULL, 1);
+	init_qual(&quals[1], AOCSSCANQUAL_INT32, AOCSSCANQUAL_NE, &args[1], NULL, 1);
+
+	AOCSScanQual_InitSelection(selection, NROWS);
+	AOCSScanQual_EvalRuns(quals, 2, 0, runValues, runIsnull, runLengths,
+						  lengthof(runLengths), selection);
+
+	for (int run = 0; run < lengthof(runLengths); run++)
+	{
+		bool		match = (run == 1 || run == 3 || run == 4);
+
+		for (int j = 0; j < runLengths[run]; j++, row++)
+			assert_int_equal((selection[row / 64] >> (row % 64)) & 1, match);
+	}
+	assert_int_equal(row, NROWS);
+	assert_int_equal(AOCSScanQual_CountSelected(selection, NROWS), 70 + 60 + 69);
+}
+
+int
+main(int argc, char *argv[])
+{
+	cmockery_parse_arguments(argc, argv);
+
+	const		UnitTest tests[] = {
+		unit_test(test__AOCSScanQual_Eval__int32),
+		unit_test(test__AOCSScanQual_Eval__int64),
+		unit_test(test__AOCSScanQual_Eval__float8),
+		unit_test(test__AOCSScanQual_Eval__nulls),
+		unit_test(test__AOCSScanQual_EvalRuns)
+	};
+
+	MemoryContextInit();
+
+	return run_tests(tests);
+}
@@ -39,9 +39,11 @@
 #include "catalog/pg_appendonly.h"
 #include "cdb/cdbappendonlyam.h"
 #include "cdb/cdbvars.h"
+#include "commands/progress.h"
 #include "commands/vacuum.h"
 #include "executor/executor.h"
 #include "nodes/execnodes.h"
+#include "pgstat.h"
 #include "storage/procarray.h"
 #include "storage/lmgr.h"
 #include "utils/lsyscache.h"
@@ -51,6 +53,21 @@
 #include "utils/snapmgr.h"
 #include "miscadmin.h"
 
+/*
+ * Progress of the compaction phase of VACUUM, as reported in
+ * pg_stat_progress_vacuum. Append-only segment files have no blocks, so the
+ * sizes are kept in bytes, and reported in units of BLCKSZ.
+ */
+#define AOCompactionBytesToBlocks(bytes)	(((bytes) + BLCKSZ - 1) / BLCKSZ)
+
+static int64 compactionTotalBytes = 0;
+static int64 compactionScannedBytes = 0;
+static int64 compactionCompactedBytes = 0;
+static int64 compactionDeadTuples = 0;
+
+/* I/O not yet charged to the vacuum cost balance, see DelayPoint() */
+static int64 compactionPendingReadBytes = 0;
+static int64 compactionPendingWriteBytes = 0;
 
 /*
  * Drops a segment file.
@@ -96,6 +113,97 @@ AppendOnlyCompaction_DropSegmentFile(Relation aorel, int segno)
 	}
 }
 
+/*
+ * Starts reporting the progress of the compaction of 'aorel', whose segment
+ * files are 'totalBytes' in size altogether.
+ */
+void
+AppendOnlyCompaction_BeginProgress(Relation aorel, int64 totalBytes)
+{
+	const int	index[] = {
+		PROGRESS_VACUUM_PHASE,
+		PROGRESS_VACUUM_TOTAL_HEAP_BLKS
+	};
+	int64		val[2];
+
+	compactionTotalBytes = totalBytes;
+	compactionScannedBytes = 0;
+	compactionCompactedBytes = 0;
+	compactionDeadTuples = 0;
+	compactionPendingReadBytes = 0;
+	compactionPendingWriteBytes = 0;
+
+	pgstat_progress_start_command(PROGRESS_COMMAND_VACUUM,
+								  RelationGetRelid(aorel));
+
+	val[0] = PROGRESS_VACUUM_PHASE_AO_COMPACT;
+	val[1] = AOCompactionBytesToBlocks(totalBytes);
+	pgstat_progress_update_multi_param(2, index, val);
+}
+
+/*
+ * Reports that 'scannedBytes' more bytes of segment files have been scanned,
+ * 'compactedBytes' more bytes of segment files are awaiting drop, and
+ * 'deadTuples' more dead tuples have been thrown away.
+ */
+void
+AppendOnlyCompaction_ReportProgress(int64 scannedBytes, int64 compactedBytes,
+									int64 deadTuples)
+{
+	const int	index[] = {
+		PROGRESS_VACUUM_HEAP_BLKS_SCANNED,
+		PROGRESS_VACUUM_HEAP_BLKS_VACUUMED,
+		PROGRESS_VACUUM_NUM_DEAD_TUPLES
+	};
+	int64		val[3];
+
+	/*
+	 * The total was computed at the beginning, concurrent inserts into
+	 * other segment files may have made them bigger since.
+	 */
+	compactionScannedBytes = Min(compactionScannedBytes + scannedBytes,
+								 compactionTotalBytes);
+	compactionCompactedBytes = Min(compactionCompactedBytes + compactedBytes,
+								   compactionTotalBytes);
+	compactionDeadTuples += deadTuples;
+
+	val[0] = AOCompactionBytesToBlocks(compactionScannedBytes);
+	val[1] = AOCompactionBytesToBlocks(compactionCompactedBytes);
+	val[2] = compactionDeadTuples;
+	pgstat_progress_update_multi_param(3, index, val);
+}
+
+void
+AppendOnlyCompaction_EndProgress(void)
+{
+	pgstat_progress_end_command();
+}
+
+/*
+ * Vacuum delay point of the compaction.
+ *
+ * Append-only segment files are read and written without going through the
+ * buffer manager, so the cost-based vacuum delay doesn't see that I/O. To
+ * throttle the compaction like a heap vacuum, charge each block read as a
+ * buffer miss and each block written as a dirtied buffer.
+ */
+void
+AppendOnlyCompaction_DelayPoint(int64 bytesRead, int64 bytesWritten)
+{
+	if (!VacuumCostActive)
+		return;
+
+	compactionPendingReadBytes += bytesRead;
+	compactionPendingWriteBytes += bytesWritten;
+
+	VacuumCostBalance += (compactionPendingReadBytes / BLCKSZ) * VacuumCostPageMiss;
+	VacuumCostBalance += (compactionPendingWriteBytes / BLCKSZ) * VacuumCostPageDirty;
+	compactionPendingReadBytes %= BLCKSZ;
+	compactionPendingWriteBytes %= BLCKSZ;
+
+	vacuum_delay_point();
+}
+
 /*
  * Calculates the ratio of hidden tuples as a double between 0 and 100
  */
@@ -270,6 +378,65 @@ AppendOnlySegmentFileTruncateToEOF(Relation aorel, int segno, int64 segeof)
 	}
 }
 
+/*
+ * Sets up an EState with the relation as its only result relation, and its
+ * indexes open, so that we can use the regular executor's index-entry-making
+ * machinery when moving tuples. The ResultRelInfo is in
+ * es_result_relation_info.
+ */
+EState *
+AppendOnlyCompaction_BeginMove(Relation aorel)
+{
+	EState	   *estate;
+	ResultRelInfo *resultRelInfo;
+
+	estate = CreateExecutorState();
+	resultRelInfo = makeNode(ResultRelInfo);
+	resultRelInfo->ri_RangeTableIndex = 1;	/* dummy */
+	resultRelInfo->ri_RelationDesc = aorel;
+	resultRelInfo->ri_TrigDesc = NULL;	/* we don't fire triggers */
+	ExecOpenIndices(resultRelInfo, false);
+	estate->es_result_relations = resultRelInfo;
+	estate->es_num_result_relations = 1;
+	estate->es_result_relation_info = resultRelInfo;
+
+	return estate;
+}
+
+void
+AppendOnlyCompaction_EndMove(EState *estate)
+{
+	ExecCloseIndices(estate->es_result_relation_info);
+	FreeExecutorState(estate);
+}
+
+/*
+ * Opens the visibility map of an append-only row oriented relation for
+ * compaction. Returns the OID of its block directory relation, or InvalidOid
+ * if it has none.
+ */
+static Oid
+AppendOnlyCompaction_InitVisimap(Relation aorel,
+								 AppendOnlyVisimap *visiMap,
+								 Snapshot appendOnlyMetaDataSnapshot)
+{
+	Oid			visimaprelid;
+	Oid			visimapidxid;
+	Oid			blkdirrelid;
+
+	GetAppendOnlyEntryAuxOids(aorel->rd_id, appendOnlyMetaDataSnapshot,
+							  NULL, &blkdirrelid, NULL,
+							  &visimaprelid, &visimapidxid);
+
+	AppendOnlyVisimap_Init(visiMap,
+						   visimaprelid,
+						   visimapidxid,
+						   ShareUpdateExclusiveLock,
+						   appendOnlyMetaDataSnapshot);
+
+	return blkdirrelid;
+}
+
 static void
 AppendOnlyMoveTuple(TupleTableSlot *slot,
 					MemTupleBinding *mt_bind,
@@ -346,6 +513,42 @@ AppendOnlyThrowAwayTuple(Relation rel, TupleTableSlot *slot)
 						AOTupleIdGet_rowNum(oldAoTupleId))));
 }
 
+/*
+ * Finishes the compaction of a segment file, once all its visible tuples
+ * have been moved: marks it as awaiting drop, and deletes its entries in
+ * the visibility map and the block directory.
+ */
+static void
+AppendOnlySegmentFileFinishCompaction(Relation aorel,
+									  AppendOnlyVisimap *visiMap,
+									  Oid blkdirrelid,
+									  FileSegInfo *fsinfo,
+									  int64 movedTupleCount,
+									  Snapshot appendOnlyMetaDataSnapshot)
+{
+	int			compact_segno = fsinfo->segno;
+
+	MarkFileSegInfoAwaitingDrop(aorel, compact_segno);
+
+	AppendOnlyVisimap_DeleteSegmentFile(visiMap, compact_segno);
+
+	/* Delete all mini pages of the segment files if block directory exists */
+	if (OidIsValid(blkdirrelid))
+	{
+		AppendOnlyBlockDirectory_DeleteSegmentFile(aorel,
+												   appendOnlyMetaDataSnapshot,
+												   compact_segno,
+												   0);
+	}
+
+	AppendOnlyCompaction_ReportProgress(0, fsinfo->eof,
+										Max(fsinfo->total_tupcount - movedTupleCount, 0));
+
+	if (Debug_appendonly_print_compaction)
+		elog(LOG, "Finished compaction: AO segfile %d, relation %s, moved tuple count " INT64_FORMAT,
+			 compact_segno, RelationGetRelationName(aorel), movedTupleCount);
+}
+
 /*
  * Assumes that the segment file lock is already held.
  * Assumes that the segment file should be compacted.
@@ -370,9 +573,10 @@ AppendOnlySegmentFileFullCompaction(Relation aorel,
 	AOTupleId  *aoTupleId;
 	int64		tupleCount = 0;
 	int64		tuplePerPage = INT_MAX;
-    Oid         visimaprelid;
-    Oid         visimapidxid;
-    Oid         blkdirrelid;
+	double		bytesPerTuple = 0;
+	int64		reportedScannedBytes = 0;
+	int64		reportedMovedTupleCount = 0;
+	Oid			blkdirrelid;
 
 	Assert(Gp_role == GP_ROLE_EXECUTE || Gp_role == GP_ROLE_UTILITY);
 	Assert(RelationIsAoRows(aorel));
@@ -383,17 +587,12 @@ AppendOnlySegmentFileFullCompaction(Relation aorel,
 	{
 		tuplePerPage = fsinfo->total_tupcount / fsinfo->varblockcount;
 	}
+	if (fsinfo->total_tupcount > 0)
+		bytesPerTuple = (double) fsinfo->eof / fsinfo->total_tupcount;
 	relname = RelationGetRelationName(aorel);
 
-	GetAppendOnlyEntryAuxOids(aorel->rd_id, appendOnlyMetaDataSnapshot,
-							  NULL, &blkdirrelid, NULL,
-							  &visimaprelid, &visimapidxid);
-
-	AppendOnlyVisimap_Init(&visiMap,
-						   visimaprelid,
-						   visimapidxid,
-						   ShareUpdateExclusiveLock,
-						   appendOnlyMetaDataSnapshot);
+	blkdirrelid = AppendOnlyCompaction_InitVisimap(aorel, &visiMap,
+												   appendOnlyMetaDataSnapshot);
 
 	if (Debug_appendonly_print_compaction)
 		elog(LOG, "Compact AO segno %d, relation %s, insert segno %d",
@@ -414,19 +613,8 @@ AppendOnlySegmentFileFullCompaction(Relation aorel,
 	slot->tts_tableOid = RelationGetRelid(aorel);
 	mt_bind = create_memtuple_binding(tupDesc);
 
-	/*
-	 * We need a ResultRelInfo and an EState so we can use the regular
-	 * executor's index-entry-making machinery.
-	 */
-	estate = CreateExecutorState();
-	resultRelInfo = makeNode(ResultRelInfo);
-	resultRelInfo->ri_RangeTableIndex = 1;	/* dummy */
-	resultRelInfo->ri_RelationDesc = aorel;
-	resultRelInfo->ri_TrigDesc = NULL;	/* we don't fire triggers */
-	ExecOpenIndices(resultRelInfo, false);
-	estate->es_result_relations = resultRelInfo;
-	estate->es_num_result_relations = 1;
-	estate->es_result_relation_info = resultRelInfo;
+	estate = AppendOnlyCompaction_BeginMove(aorel);
+	resultRelInfo = estate->es_result_relation_info;
 
 	/*
 	 * Go through all visible tuples and move them to a new segfile.
@@ -453,41 +641,145 @@ AppendOnlySegmentFileFullCompaction(Relation aorel,
 		}
 
 		/*
-		 * Check for vacuum delay point after approximately a var block
+		 * Report progress and check for vacuum delay point after
+		 * approximately a var block
 		 */
 		tupleCount++;
-		if (VacuumCostActive && tupleCount % tuplePerPage == 0)
+		if (tupleCount % tuplePerPage == 0)
 		{
-			vacuum_delay_point();
+			int64		scannedBytes = Min((int64) (tupleCount * bytesPerTuple),
+										   fsinfo->eof);
+
+			AppendOnlyCompaction_ReportProgress(scannedBytes - reportedScannedBytes,
+												0, 0);
+			AppendOnlyCompaction_DelayPoint(scannedBytes - reportedScannedBytes,
+											(int64) ((movedTupleCount - reportedMovedTupleCount) * bytesPerTuple));
+			reportedScannedBytes = scannedBytes;
+			reportedMovedTupleCount = movedTupleCount;
 		}
 	}
+	AppendOnlyCompaction_ReportProgress(fsinfo->eof - reportedScannedBytes, 0, 0);
 
-	MarkFileSegInfoAwaitingDrop(aorel, compact_segno);
+	AppendOnlySegmentFileFinishCompaction(aorel,
+										  &visiMap,
+										  blkdirrelid,
+										  fsinfo,
+										  movedTupleCount,
+										  appendOnlyMetaDataSnapshot);
 
-	AppendOnlyVisimap_DeleteSegmentFile(&visiMap, compact_segno);
+	AppendOnlyVisimap_Finish(&visiMap, NoLock);
 
-	/* Delete all mini pages of the segment files if block directory exists */
-	if (OidIsValid(blkdirrelid))
+	AppendOnlyCompaction_EndMove(estate);
+
+	ExecDropSingleTupleTableSlot(slot);
+	destroy_memtuple_binding(mt_bind);
+
+	appendonly_endscan(&scanDesc->rs_base);
+}
+
+/*
+ * Compacts several segment files at once, with a background worker scanning
+ * each of them, see appendonly_compaction_worker.c. We move the visible
+ * tuples that the workers send us, so all the writes happen in this
+ * transaction, like in AppendOnlySegmentFileFullCompaction().
+ *
+ * Returns the segment files that the workers could not scan. They must be
+ * compacted serially.
+ */
+static List *
+AppendOnlySegmentFilesParallelCompaction(Relation aorel,
+										 AppendOnlyInsertDesc insertDesc,
+										 FileSegInfo **fsinfos,
+										 int nsegs,
+										 Snapshot appendOnlyMetaDataSnapshot)
+{
+	AppendOnlyCompactionWorkers *workers;
+	AppendOnlyVisimap visiMap;
+	TupleDesc	tupDesc;
+	TupleTableSlot *slot;
+	MemTupleBinding *mt_bind;
+	ResultRelInfo *resultRelInfo;
+	EState	   *estate;
+	int		   *segnos;
+	int64	   *eofs;
+	int64	   *tupcounts;
+	int64	   *movedTupleCounts;
+	int			segindex;
+	List	   *leftoverSegnos;
+	Oid			blkdirrelid;
+
+	Assert(Gp_role == GP_ROLE_EXECUTE || Gp_role == GP_ROLE_UTILITY);
+	Assert(RelationIsAoRows(aorel));
+	Assert(insertDesc);
+
+	segnos = palloc(nsegs * sizeof(int));
+	eofs = palloc(nsegs * sizeof(int64));
+	tupcounts = palloc(nsegs * sizeof(int64));
+	movedTupleCounts = palloc0(nsegs * sizeof(int64));
+	for (int i = 0; i < nsegs; i++)
 	{
-		AppendOnlyBlockDirectory_DeleteSegmentFile(aorel,
-												   appendOnlyMetaDataSnapshot,
-												   compact_segno,
-												   0);
+		segnos[i] = fsinfos[i]->segno;
+		eofs[i] = fsinfos[i]->eof;
+		tupcounts[i] = fsinfos[i]->total_tupcount;
 	}
 
+	blkdirrelid = AppendOnlyCompaction_InitVisimap(aorel, &visiMap,
+												   appendOnlyMetaDataSnapshot);
+
+	/* The workers send heap tuples */
+	tupDesc = RelationGetDescr(aorel);
+	slot = MakeSingleTupleTableSlot(tupDesc, &TTSOpsHeapTuple);
+	slot->tts_tableOid = RelationGetRelid(aorel);
+	mt_bind = create_memtuple_binding(tupDesc);
+
+	estate = AppendOnlyCompaction_BeginMove(aorel);
+	resultRelInfo = estate->es_result_relation_info;
+
 	if (Debug_appendonly_print_compaction)
-		elog(LOG, "Finished compaction: AO segfile %d, relation %s, moved tuple count " INT64_FORMAT,
-			 compact_segno, relname, movedTupleCount);
+		elog(LOG, "Compact %d AO segfiles in parallel, relation %s, insert segno %d",
+			 nsegs, RelationGetRelationName(aorel),
+			 insertDesc->storageWrite.segmentFileNum);
+
+	workers = AppendOnlyCompactionWorkers_Launch(aorel, nsegs, segnos,
+												 eofs, tupcounts,
+												 appendOnlyMetaDataSnapshot);
+	while (AppendOnlyCompactionWorkers_GetNext(workers, slot, &segindex))
+	{
+		AppendOnlyMoveTuple(slot,
+							mt_bind,
+							insertDesc,
+							resultRelInfo,
+							estate);
+		movedTupleCounts[segindex]++;
+	}
+	leftoverSegnos = AppendOnlyCompactionWorkers_End(workers);
+
+	for (int i = 0; i < nsegs; i++)
+	{
+		if (list_member_int(leftoverSegnos, segnos[i]))
+			continue;
+
+		AppendOnlySegmentFileFinishCompaction(aorel,
+											  &visiMap,
+											  blkdirrelid,
+											  fsinfos[i],
+											  movedTupleCounts[i],
+											  appendOnlyMetaDataSnapshot);
+	}
 
 	AppendOnlyVisimap_Finish(&visiMap, NoLock);
 
-	ExecCloseIndices(resultRelInfo);
-	FreeExecutorState(estate);
+	AppendOnlyCompaction_EndMove(estate);
 
 	ExecDropSingleTupleTableSlot(slot);
 	destroy_memtuple_binding(mt_bind);
 
-	appendonly_endscan(&scanDesc->rs_base);
+	pfree(segnos);
+	pfree(eofs);
+	pfree(tupcounts);
+	pfree(movedTupleCounts);
+
+	return leftoverSegnos;
 }
 
 /*
@@ -719,9 +1011,13 @@ AppendOnlyTruncateToEOF(Relation aorel)
 /*
  * Performs a compaction of an append-only relation.
  *
- * The compaction segment file should be marked as in-use/in-compaction in
+ * The compaction segment files should be marked as in-use/in-compaction in
  * the appendonlywriter.c code.
  *
+ * If gp_appendonly_compaction_workers is set, the segment files in
+ * 'compaction_segnos' are compacted at once with background workers,
+ * otherwise one after another.
+ *
  * On exit, *insert_segno will be set to the the segment that was used as the
  * insertion target. The segfiles listed in 'avoid_segnos' will not be used
  * for insertion.
@@ -731,27 +1027,41 @@ AppendOnlyTruncateToEOF(Relation aorel)
  */
 void
 AppendOnlyCompact(Relation aorel,
-				  int compaction_segno,
+				  List *compaction_segnos,
 				  int *insert_segno,
 				  bool isFull,
 				  List *avoid_segnos)
 {
-	const char *relname;
 	AppendOnlyInsertDesc insertDesc = NULL;
-	FileSegInfo *fsinfo;
+	FileSegInfo **fsinfos;
+	int			nsegs = 0;
+	ListCell   *lc;
 	Snapshot	appendOnlyMetaDataSnapshot = RegisterSnapshot(GetCatalogSnapshot(InvalidOid));
 
 	Assert(RelationIsAoRows(aorel));
 	Assert(Gp_role == GP_ROLE_EXECUTE || Gp_role == GP_ROLE_UTILITY);
 
-	relname = RelationGetRelationName(aorel);
+	fsinfos = palloc(list_length(compaction_segnos) * sizeof(FileSegInfo *));
+	foreach(lc, compaction_segnos)
+	{
+		FileSegInfo *fsinfo;
 
-	/* Fetch under the write lock to get latest committed eof. */
-	fsinfo = GetFileSegInfo(aorel, appendOnlyMetaDataSnapshot, compaction_segno, true);
+		/* Fetch under the write lock to get latest committed eof. */
+		fsinfo = GetFileSegInfo(aorel, appendOnlyMetaDataSnapshot, lfirst_int(lc), true);
 
-	if (AppendOnlyCompaction_ShouldCompact(aorel,
-										   fsinfo->segno, fsinfo->total_tupcount, isFull,
-										   appendOnlyMetaDataSnapshot))
+		if (AppendOnlyCompaction_ShouldCompact(aorel,
+											   fsinfo->segno, fsinfo->total_tupcount, isFull,
+											   appendOnlyMetaDataSnapshot))
+			fsinfos[nsegs++] = fsinfo;
+		else
+		{
+			/* Nothing to do, but it counts as scanned */
+			AppendOnlyCompaction_ReportProgress(fsinfo->eof, 0, 0);
+			pfree(fsinfo);
+		}
+	}
+
+	if (nsegs > 0)
 	{
 		if (*insert_segno == -1)
 		{
@@ -760,11 +1070,28 @@ AppendOnlyCompact(Relation aorel,
 		}
 		if (*insert_segno != -1)
 		{
+			List	   *leftoverSegnos = NIL;
+			bool		parallel = (gp_appendonly_compaction_workers > 0);
+
 			insertDesc = appendonly_insert_init(aorel, *insert_segno);
-			AppendOnlySegmentFileFullCompaction(aorel,
-												insertDesc,
-												fsinfo,
-												appendOnlyMetaDataSnapshot);
+
+			if (parallel)
+				leftoverSegnos = AppendOnlySegmentFilesParallelCompaction(aorel,
+																		  insertDesc,
+																		  fsinfos,
+																		  nsegs,
+																		  appendOnlyMetaDataSnapshot);
+
+			for (int i = 0; i < nsegs; i++)
+			{
+				if (parallel && !list_member_int(leftoverSegnos, fsinfos[i]->segno))
+					continue;
+
+				AppendOnlySegmentFileFullCompaction(aorel,
+													insertDesc,
+													fsinfos[i],
+													appendOnlyMetaDataSnapshot);
+			}
 
 			insertDesc->skipModCountIncrement = true;
 			appendonly_insert_finish(insertDesc);
@@ -772,13 +1099,16 @@ AppendOnlyCompact(Relation aorel,
 		else
 		{
 			/* Could not find a target segment. Give up */
-			ereport(WARNING,
-					(errmsg("could not find a free segment file to use for compacting segfile %d of relation %s",
-							compaction_segno, RelationGetRelationName(aorel))));
+			for (int i = 0; i < nsegs; i++)
+				ereport(WARNING,
+						(errmsg("could not find a free segment file to use for compacting segfile %d of relation %s",
+								fsinfos[i]->segno, RelationGetRelationName(aorel))));
 		}
 	}
 
-	pfree(fsinfo);
+	for (int i = 0; i < nsegs; i++)
+		pfree(fsinfos[i]);
+	pfree(fsinfos);
 
 	UnregisterSnapshot(appendOnlyMetaDataSnapshot);
 }
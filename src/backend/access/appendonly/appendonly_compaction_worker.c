@@ -0,0 +1,740 @@
+/*------------------------------------------------------------------------------
+ *
+ * appendonly_compaction_worker.c
+ *	  Background workers that scan append-only segment files for VACUUM.
+ *
+ * When gp_appendonly_compaction_workers is set, the compaction phase of
+ * VACUUM compacts several segment files at once. For each of them, a
+ * dynamic background worker scans the segment file, filters out the tuples
+ * that are not visible according to the visibility map, and sends the
+ * visible ones to the vacuuming backend (the leader) through a tuple queue.
+ *
+ * The workers only read, with the leader's snapshot, which it passes along
+ * in the DSM segment. The leader inserts the tuples into the insertion
+ * segment file and the indexes, and updates pg_aoseg, the visibility map
+ * and the block directory, all in its own transaction, exactly like the
+ * serial compaction does. That's important, because those updates must be
+ * part of the distributed transaction of the VACUUM (see vacuum_ao.c), and
+ * a background worker cannot participate in it. It also means that a crash
+ * at any point leaves the table in the same state as a crash during a
+ * serial compaction.
+ *
+ * Each worker also has an error queue, to which its errors and notices are
+ * sent, like those of parallel workers. The leader re-throws them, so that
+ * VACUUM fails with the error of the worker.
+ *
+ * A worker that cannot start, or that cannot lock the relation right away
+ * (e.g. because VACUUM FULL holds an AccessExclusiveLock on it), gives up
+ * before sending anything, and the leader compacts its segment file
+ * serially instead. A worker never waits for a lock, so that it cannot get
+ * into a deadlock with the leader that the deadlock detector would not see.
+ *
+ * The workers are not throttled themselves. The leader charges the I/O of
+ * both the scans and the inserts to the vacuum cost balance, and when it
+ * sleeps, the tuple queues fill up and the workers block.
+ *
+ * Copyright (c) 2022-Present VMware, Inc. or its affiliates.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/backend/access/appendonly/appendonly_compaction_worker.c
+ *
+ *------------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/appendonly_compaction.h"
+#include "access/table.h"
+#include "access/xact.h"
+#include "cdb/cdbaocsam.h"
+#include "cdb/cdbappendonlyam.h"
+#include "cdb/cdbvars.h"
+#include "executor/tqueue.h"
+#include "libpq/pqformat.h"
+#include "libpq/pqmq.h"
+#include "miscadmin.h"
+#include "pgstat.h"
+#include "port/atomics.h"
+#include "postmaster/bgworker.h"
+#include "storage/dsm.h"
+#include "storage/ipc.h"
+#include "storage/lmgr.h"
+#include "storage/proc.h"
+#include "storage/shm_mq.h"
+#include "storage/shm_toc.h"
+#include "storage/spin.h"
+#include "tcop/tcopprot.h"
+#include "utils/faultinjector.h"
+#include "utils/snapmgr.h"
+
+#define AOCOMPACTION_MAGIC				0x414f4357
+#define AOCOMPACTION_KEY_SHARED			0
+#define AOCOMPACTION_KEY_SNAPSHOT		1
+#define AOCOMPACTION_KEY_QUEUE(workerno)	(2 + 2 * (workerno))
+#define AOCOMPACTION_KEY_ERROR_QUEUE(workerno)	(3 + 2 * (workerno))
+
+#define AOCOMPACTION_TUPLE_QUEUE_SIZE	65536
+#define AOCOMPACTION_ERROR_QUEUE_SIZE	16384
+
+/* Report progress and check the vacuum cost balance every so many tuples */
+#define AOCOMPACTION_REPORT_INTERVAL	1000
+
+typedef enum AppendOnlyCompactionWorkerStatus
+{
+	AOCOMPACTION_WORKER_STARTING,
+	AOCOMPACTION_WORKER_SCANNING,
+	AOCOMPACTION_WORKER_DONE,
+	AOCOMPACTION_WORKER_GAVE_UP		/* left the segment file to the leader */
+} AppendOnlyCompactionWorkerStatus;
+
+typedef struct AppendOnlyCompactionWorkerState
+{
+	int			segno;
+
+	/* protected by the mutex of AppendOnlyCompactionShared */
+	AppendOnlyCompactionWorkerStatus status;
+
+	/* only written by the worker */
+	pg_atomic_uint64 scannedTupleCount;
+	pg_atomic_uint64 sentTupleCount;
+} AppendOnlyCompactionWorkerState;
+
+typedef struct AppendOnlyCompactionShared
+{
+	Oid			dbid;
+	Oid			userid;
+	Oid			relid;
+
+	slock_t		mutex;
+
+	int			nworkers;
+	AppendOnlyCompactionWorkerState workers[FLEXIBLE_ARRAY_MEMBER];
+} AppendOnlyCompactionShared;
+
+/*
+ * Leader's state of a set of compaction workers.
+ */
+struct AppendOnlyCompactionWorkers
+{
+	dsm_segment *seg;
+	AppendOnlyCompactionShared *shared;
+	int			nworkers;
+
+	BackgroundWorkerHandle **handles;	/* NULL if not registered */
+	shm_mq_handle **queues;
+	shm_mq_handle **errorQueues;	/* NULL once detached */
+	TupleQueueReader **readers; /* NULL once the worker is done */
+	int			nactive;		/* number of non-NULL readers */
+	int			next;			/* reader to read from next */
+
+	int64	   *eofs;
+	double	   *bytesPerTuple;
+	int64	   *receivedTupleCount;
+	uint64	   *reportedScannedTupleCount;
+	int64	   *reportedScannedBytes;
+	int64		unreportedWrittenBytes;
+	int			tuplesSinceReport;
+
+	List	   *leftoverSegnos;
+};
+
+static void AppendOnlyCompactionWorkers_ReportProgress(AppendOnlyCompactionWorkers *workers);
+static void AppendOnlyCompactionWorkers_HandleMessages(AppendOnlyCompactionWorkers *workers);
+static void AppendOnlyCompactionWorkers_HandleMessage(StringInfo msg);
+static void AppendOnlyCompactionWorkers_Finished(AppendOnlyCompactionWorkers *workers,
+												 int workerno);
+static void AppendOnlyCompactionWorker_SetStatus(AppendOnlyCompactionShared *shared,
+												 AppendOnlyCompactionWorkerState *state,
+												 AppendOnlyCompactionWorkerStatus status);
+
+/*
+ * Launches a background worker to scan each of the given segment files.
+ *
+ * 'eofs' and 'tupcounts' are the sizes of the segment files, as recorded in
+ * pg_aoseg; they are only used for progress reporting and throttling.
+ * The workers scan the segment files with 'snapshot', which the caller must
+ * keep registered until AppendOnlyCompactionWorkers_End().
+ */
+AppendOnlyCompactionWorkers *
+AppendOnlyCompactionWorkers_Launch(Relation aorel, int nsegs, const int *segnos,
+								   const int64 *eofs, const int64 *tupcounts,
+								   Snapshot snapshot)
+{
+	AppendOnlyCompactionWorkers *workers;
+	AppendOnlyCompactionShared *shared;
+	shm_toc_estimator estimator;
+	shm_toc    *toc;
+	Size		sharedSize;
+	Size		snapshotSize;
+	char	   *snapshotSpace;
+
+	Assert(nsegs > 0);
+
+	workers = palloc0(sizeof(AppendOnlyCompactionWorkers));
+	workers->nworkers = nsegs;
+	workers->handles = palloc0(nsegs * sizeof(BackgroundWorkerHandle *));
+	workers->queues = palloc0(nsegs * sizeof(shm_mq_handle *));
+	workers->errorQueues = palloc0(nsegs * sizeof(shm_mq_handle *));
+	workers->readers = palloc0(nsegs * sizeof(TupleQueueReader *));
+	workers->eofs = palloc(nsegs * sizeof(int64));
+	workers->bytesPerTuple = palloc(nsegs * sizeof(double));
+	workers->receivedTupleCount = palloc0(nsegs * sizeof(int64));
+	workers->reportedScannedTupleCount = palloc0(nsegs * sizeof(uint64));
+	workers->reportedScannedBytes = palloc0(nsegs * sizeof(int64));
+
+	/*
+	 * Create the DSM segment, with the shared state, the snapshot and a tuple
+	 * queue and an error queue per worker.
+	 */
+	sharedSize = add_size(offsetof(AppendOnlyCompactionShared, workers),
+						  mul_size(nsegs, sizeof(AppendOnlyCompactionWorkerState)));
+	snapshotSize = EstimateSnapshotSpace(snapshot);
+	shm_toc_initialize_estimator(&estimator);
+	shm_toc_estimate_chunk(&estimator, sharedSize);
+	shm_toc_estimate_chunk(&estimator, snapshotSize);
+	shm_toc_estimate_chunk(&estimator,
+						   mul_size(nsegs, AOCOMPACTION_TUPLE_QUEUE_SIZE));
+	shm_toc_estimate_chunk(&estimator,
+						   mul_size(nsegs, AOCOMPACTION_ERROR_QUEUE_SIZE));
+	shm_toc_estimate_keys(&estimator, 2 + 2 * nsegs);
+
+	workers->seg = dsm_create(shm_toc_estimate(&estimator), 0);
+	toc = shm_toc_create(AOCOMPACTION_MAGIC, dsm_segment_address(workers->seg),
+						 shm_toc_estimate(&estimator));
+
+	shared = shm_toc_allocate(toc, sharedSize);
+	shared->dbid = MyDatabaseId;
+	shared->userid = GetAuthenticatedUserId();
+	shared->relid = RelationGetRelid(aorel);
+	SpinLockInit(&shared->mutex);
+	shared->nworkers = nsegs;
+	shm_toc_insert(toc, AOCOMPACTION_KEY_SHARED, shared);
+	workers->shared = shared;
+
+	snapshotSpace = shm_toc_allocate(toc, snapshotSize);
+	SerializeSnapshot(snapshot, snapshotSpace);
+	shm_toc_insert(toc, AOCOMPACTION_KEY_SNAPSHOT, snapshotSpace);
+
+	for (int i = 0; i < nsegs; i++)
+	{
+		AppendOnlyCompactionWorkerState *state = &shared->workers[i];
+		BackgroundWorker worker;
+		shm_mq	   *mq;
+		shm_mq	   *errmq;
+
+		state->segno = segnos[i];
+		state->status = AOCOMPACTION_WORKER_STARTING;
+		pg_atomic_init_u64(&state->scannedTupleCount, 0);
+		pg_atomic_init_u64(&state->sentTupleCount, 0);
+
+		workers->eofs[i] = eofs[i];
+		workers->bytesPerTuple[i] = (tupcounts[i] > 0) ?
+			(double) eofs[i] / tupcounts[i] : 0;
+
+		mq = shm_mq_create(shm_toc_allocate(toc, AOCOMPACTION_TUPLE_QUEUE_SIZE),
+						   AOCOMPACTION_TUPLE_QUEUE_SIZE);
+		shm_toc_insert(toc, AOCOMPACTION_KEY_QUEUE(i), mq);
+		shm_mq_set_receiver(mq, MyProc);
+
+		errmq = shm_mq_create(shm_toc_allocate(toc, AOCOMPACTION_ERROR_QUEUE_SIZE),
+							  AOCOMPACTION_ERROR_QUEUE_SIZE);
+		shm_toc_insert(toc, AOCOMPACTION_KEY_ERROR_QUEUE(i), errmq);
+		shm_mq_set_receiver(errmq, MyProc);
+
+		memset(&worker, 0, sizeof(worker));
+		worker.bgw_flags = BGWORKER_SHMEM_ACCESS |
+			BGWORKER_BACKEND_DATABASE_CONNECTION;
+		worker.bgw_start_time = BgWorkerStart_ConsistentState;
+		worker.bgw_restart_time = BGW_NEVER_RESTART;
+		snprintf(worker.bgw_library_name, BGW_MAXLEN, "postgres");
+		snprintf(worker.bgw_function_name, BGW_MAXLEN,
+				 "AppendOnlyCompactionWorkerMain");
+		snprintf(worker.bgw_name, BGW_MAXLEN,
+				 "append-optimized compaction worker for PID %d", MyProcPid);
+		snprintf(worker.bgw_type, BGW_MAXLEN,
+				 "append-optimized compaction worker");
+		worker.bgw_main_arg = UInt32GetDatum(dsm_segment_handle(workers->seg));
+		memcpy(worker.bgw_extra, &i, sizeof(int));
+		worker.bgw_notify_pid = MyProcPid;
+
+		if (
+#ifdef FAULT_INJECTOR
+			SIMPLE_FAULT_INJECTOR("appendonly_compaction_worker_register") == FaultInjectorTypeSkip ||
+#endif
+			!RegisterDynamicBackgroundWorker(&worker, &workers->handles[i]))
+		{
+			/* No free slot. Compact this segment file serially. */
+			elogif(Debug_appendonly_print_compaction, LOG,
+				   "could not register a compaction worker for segno %d of relation %s",
+				   segnos[i], RelationGetRelationName(aorel));
+			state->status = AOCOMPACTION_WORKER_GAVE_UP;
+			workers->leftoverSegnos = lappend_int(workers->leftoverSegnos,
+												  segnos[i]);
+			continue;
+		}
+
+		workers->queues[i] = shm_mq_attach(mq, workers->seg, workers->handles[i]);
+		workers->errorQueues[i] = shm_mq_attach(errmq, workers->seg,
+												workers->handles[i]);
+		workers->readers[i] = CreateTupleQueueReader(workers->queues[i]);
+		workers->nactive++;
+	}
+
+	return workers;
+}
+
+/*
+ * Fetches the next visible tuple from any of the workers into 'slot', which
+ * must be a heap tuple slot.
+ *
+ * On return, *segindex is the position of the segment file of the tuple in
+ * the 'segnos' array passed to AppendOnlyCompactionWorkers_Launch(). Returns
+ * false once all the workers are done.
+ */
+bool
+AppendOnlyCompactionWorkers_GetNext(AppendOnlyCompactionWorkers *workers,
+									TupleTableSlot *slot, int *segindex)
+{
+	SIMPLE_FAULT_INJECTOR("appendonly_compaction_workers_get_next");
+
+	for (;;)
+	{
+		CHECK_FOR_INTERRUPTS();
+
+		AppendOnlyCompactionWorkers_HandleMessages(workers);
+
+		/*
+		 * Visit each worker in turn. Keep reading from the same worker as
+		 * long as it has tuples ready, to avoid switching back and forth.
+		 */
+		for (int nvisited = 0; nvisited < workers->nworkers; nvisited++)
+		{
+			int			i = workers->next;
+			TupleQueueReader *reader = workers->readers[i];
+
+			if (reader != NULL)
+			{
+				HeapTuple	tuple;
+				bool		done;
+
+				tuple = TupleQueueReaderNext(reader, true, &done);
+				if (tuple != NULL)
+				{
+					ExecStoreHeapTuple(tuple, slot, true);
+					workers->receivedTupleCount[i]++;
+					workers->unreportedWrittenBytes += (int64) workers->bytesPerTuple[i];
+					if (++workers->tuplesSinceReport >= AOCOMPACTION_REPORT_INTERVAL)
+						AppendOnlyCompactionWorkers_ReportProgress(workers);
+					*segindex = i;
+					return true;
+				}
+				if (done)
+					AppendOnlyCompactionWorkers_Finished(workers, i);
+			}
+
+			workers->next = (i + 1) % workers->nworkers;
+		}
+
+		if (workers->nactive == 0)
+		{
+			AppendOnlyCompactionWorkers_ReportProgress(workers);
+			ExecClearTuple(slot);
+			return false;
+		}
+
+		/* No worker has a tuple ready. Wait for one. */
+		(void) WaitLatch(MyLatch, WL_LATCH_SET | WL_EXIT_ON_PM_DEATH, 0,
+						 WAIT_EVENT_AO_COMPACTION_WORKER);
+		ResetLatch(MyLatch);
+	}
+}
+
+/*
+ * Waits for the workers to exit, and releases the resources.
+ *
+ * Returns the segment files that the workers did not scan. They still need
+ * to be compacted.
+ */
+List *
+AppendOnlyCompactionWorkers_End(AppendOnlyCompactionWorkers *workers)
+{
+	List	   *leftoverSegnos = workers->leftoverSegnos;
+
+	Assert(workers->nactive == 0);
+
+	for (int i = 0; i < workers->nworkers; i++)
+	{
+		if (workers->handles[i] != NULL)
+		{
+			(void) WaitForBackgroundWorkerShutdown(workers->handles[i]);
+			pfree(workers->handles[i]);
+		}
+	}
+
+	/* A worker may have failed after sending all its tuples */
+	AppendOnlyCompactionWorkers_HandleMessages(workers);
+
+	dsm_detach(workers->seg);
+
+	pfree(workers->handles);
+	pfree(workers->queues);
+	pfree(workers->errorQueues);
+	pfree(workers->readers);
+	pfree(workers->eofs);
+	pfree(workers->bytesPerTuple);
+	pfree(workers->receivedTupleCount);
+	pfree(workers->reportedScannedTupleCount);
+	pfree(workers->reportedScannedBytes);
+	pfree(workers);
+
+	return leftoverSegnos;
+}
+
+/*
+ * Reports the tuples scanned by the workers, and the tuples we've inserted
+ * since the last call, to pg_stat_progress_vacuum and the vacuum cost
+ * balance.
+ */
+static void
+AppendOnlyCompactionWorkers_ReportProgress(AppendOnlyCompactionWorkers *workers)
+{
+	int64		readBytes = 0;
+
+	for (int i = 0; i < workers->nworkers; i++)
+	{
+		uint64		scanned;
+		int64		scannedBytes;
+
+		scanned = pg_atomic_read_u64(&workers->shared->workers[i].scannedTupleCount);
+		if (scanned == workers->reportedScannedTupleCount[i])
+			continue;
+
+		scannedBytes = Min((int64) (scanned * workers->bytesPerTuple[i]),
+						   workers->eofs[i]);
+		readBytes += scannedBytes - workers->reportedScannedBytes[i];
+		workers->reportedScannedBytes[i] = scannedBytes;
+		workers->reportedScannedTupleCount[i] = scanned;
+	}
+
+	AppendOnlyCompaction_ReportProgress(readBytes, 0, 0);
+	AppendOnlyCompaction_DelayPoint(readBytes, workers->unreportedWrittenBytes);
+
+	workers->unreportedWrittenBytes = 0;
+	workers->tuplesSinceReport = 0;
+}
+
+/*
+ * Re-throws the errors, and re-emits the notices, that the workers have sent
+ * through their error queues so far.
+ */
+static void
+AppendOnlyCompactionWorkers_HandleMessages(AppendOnlyCompactionWorkers *workers)
+{
+	for (int i = 0; i < workers->nworkers; i++)
+	{
+		while (workers->errorQueues[i] != NULL)
+		{
+			shm_mq_result res;
+			Size		nbytes;
+			void	   *data;
+			StringInfoData msg;
+
+			res = shm_mq_receive(workers->errorQueues[i], &nbytes, &data, true);
+			if (res == SHM_MQ_WOULD_BLOCK)
+				break;
+			if (res == SHM_MQ_DETACHED)
+			{
+				/* The worker has exited, and we've read all it sent */
+				shm_mq_detach(workers->errorQueues[i]);
+				workers->errorQueues[i] = NULL;
+				break;
+			}
+
+			initStringInfo(&msg);
+			appendBinaryStringInfo(&msg, data, nbytes);
+			AppendOnlyCompactionWorkers_HandleMessage(&msg);
+			pfree(msg.data);
+		}
+	}
+}
+
+/*
+ * Re-throws an error, or re-emits a notice, received from a worker, like
+ * HandleParallelMessage() does for parallel workers.
+ */
+static void
+AppendOnlyCompactionWorkers_HandleMessage(StringInfo msg)
+{
+	char		msgtype;
+	ErrorData	edata;
+
+	msgtype = pq_getmsgbyte(msg);
+
+	/* Workers send nothing else we'd have to act on */
+	if (msgtype != 'E' && msgtype != 'N')
+		return;
+
+	pq_parse_errornotice(msg, &edata);
+
+	/* Death of a worker isn't enough justification for suicide */
+	edata.elevel = Min(edata.elevel, ERROR);
+
+	if (edata.context)
+		edata.context = psprintf("%s\n%s", edata.context,
+								 _("append-optimized compaction worker"));
+	else
+		edata.context = pstrdup(_("append-optimized compaction worker"));
+
+	ThrowErrorData(&edata);
+}
+
+/*
+ * Called when the queue of a worker has been detached, and all the tuples in
+ * it have been received.
+ */
+static void
+AppendOnlyCompactionWorkers_Finished(AppendOnlyCompactionWorkers *workers,
+									 int workerno)
+{
+	AppendOnlyCompactionShared *shared = workers->shared;
+	AppendOnlyCompactionWorkerState *state = &shared->workers[workerno];
+	AppendOnlyCompactionWorkerStatus status;
+
+	DestroyTupleQueueReader(workers->readers[workerno]);
+	workers->readers[workerno] = NULL;
+	shm_mq_detach(workers->queues[workerno]);
+	workers->queues[workerno] = NULL;
+	workers->nactive--;
+
+	SpinLockAcquire(&shared->mutex);
+	status = state->status;
+	SpinLockRelease(&shared->mutex);
+
+	switch (status)
+	{
+		case AOCOMPACTION_WORKER_DONE:
+			if (pg_atomic_read_u64(&state->sentTupleCount) !=
+				(uint64) workers->receivedTupleCount[workerno])
+				elog(ERROR, "append-optimized compaction worker for segno %d sent " UINT64_FORMAT " tuples, but " INT64_FORMAT " were received",
+					 state->segno, pg_atomic_read_u64(&state->sentTupleCount),
+					 workers->receivedTupleCount[workerno]);
+
+			/* Account for the part of the segment file we haven't reported yet */
+			AppendOnlyCompaction_ReportProgress(workers->eofs[workerno] -
+												workers->reportedScannedBytes[workerno],
+												0, 0);
+			workers->reportedScannedBytes[workerno] = workers->eofs[workerno];
+			break;
+
+		case AOCOMPACTION_WORKER_STARTING:
+		case AOCOMPACTION_WORKER_GAVE_UP:
+			/* It didn't send anything, so compact the segment file serially */
+			Assert(workers->receivedTupleCount[workerno] == 0);
+			workers->leftoverSegnos = lappend_int(workers->leftoverSegnos,
+												  state->segno);
+			break;
+
+		case AOCOMPACTION_WORKER_SCANNING:
+			/*
+			 * The worker failed. Its error, if it got to send one, is in
+			 * its error queue by now; re-throw that rather than ours.
+			 */
+			AppendOnlyCompactionWorkers_HandleMessages(workers);
+			ereport(ERROR,
+					(errcode(ERRCODE_INTERNAL_ERROR),
+					 errmsg("append-optimized compaction worker for segment file %d exited unexpectedly",
+							state->segno)));
+			break;
+	}
+}
+
+static void
+AppendOnlyCompactionWorker_SetStatus(AppendOnlyCompactionShared *shared,
+									 AppendOnlyCompactionWorkerState *state,
+									 AppendOnlyCompactionWorkerStatus status)
+{
+	SpinLockAcquire(&shared->mutex);
+	state->status = status;
+	SpinLockRelease(&shared->mutex);
+}
+
+/*
+ * Sends the tuple in 'slot' to the leader if it's visible. Returns false if
+ * the leader has gone away.
+ */
+static bool
+AppendOnlyCompactionWorker_SendTuple(AppendOnlyCompactionWorkerState *state,
+									 DestReceiver *dest,
+									 TupleTableSlot *slot,
+									 AppendOnlyVisimap *visiMap,
+									 uint64 *scannedTupleCount,
+									 uint64 *sentTupleCount)
+{
+	CHECK_FOR_INTERRUPTS();
+
+	pg_atomic_write_u64(&state->scannedTupleCount, ++(*scannedTupleCount));
+
+	if (!AppendOnlyVisimap_IsVisible(visiMap, (AOTupleId *) &slot->tts_tid))
+		return true;
+
+	if (!dest->receiveSlot(slot, dest))
+		return false;
+
+	pg_atomic_write_u64(&state->sentTupleCount, ++(*sentTupleCount));
+
+	return true;
+}
+
+/*
+ * Main entry point of a compaction worker.
+ */
+void
+AppendOnlyCompactionWorkerMain(Datum main_arg)
+{
+	dsm_segment *seg;
+	shm_toc    *toc;
+	AppendOnlyCompactionShared *shared;
+	AppendOnlyCompactionWorkerState *state;
+	shm_mq	   *mq;
+	shm_mq	   *errmq;
+	shm_mq_handle *mqh;
+	DestReceiver *dest;
+	Relation	aorel;
+	Snapshot	snapshot;
+	TupleTableSlot *slot;
+	int			workerno;
+	int			segno;
+	uint64		scannedTupleCount = 0;
+	uint64		sentTupleCount = 0;
+	bool		completed = true;
+
+	/*
+	 * Direct connections to segments are only allowed in utility mode, like
+	 * for autovacuum workers.
+	 */
+	Gp_role = GP_ROLE_UTILITY;
+
+	pqsignal(SIGTERM, die);
+	BackgroundWorkerUnblockSignals();
+
+	memcpy(&workerno, MyBgworkerEntry->bgw_extra, sizeof(int));
+
+	/*
+	 * Attach to the DSM segment. We have no ResourceOwner yet, so the mapping
+	 * survives until we detach it explicitly.
+	 */
+	seg = dsm_attach(DatumGetUInt32(main_arg));
+	if (seg == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("could not map dynamic shared memory segment")));
+	toc = shm_toc_attach(AOCOMPACTION_MAGIC, dsm_segment_address(seg));
+	if (toc == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("invalid magic number in dynamic shared memory segment")));
+
+	shared = shm_toc_lookup(toc, AOCOMPACTION_KEY_SHARED, false);
+	Assert(workerno >= 0 && workerno < shared->nworkers);
+	state = &shared->workers[workerno];
+	segno = state->segno;
+
+	/* From now on, send our errors and notices to the leader */
+	errmq = shm_toc_lookup(toc, AOCOMPACTION_KEY_ERROR_QUEUE(workerno), false);
+	shm_mq_set_sender(errmq, MyProc);
+	pq_redirect_to_shm_mq(seg, shm_mq_attach(errmq, seg, NULL));
+
+	mq = shm_toc_lookup(toc, AOCOMPACTION_KEY_QUEUE(workerno), false);
+	shm_mq_set_sender(mq, MyProc);
+	mqh = shm_mq_attach(mq, seg, NULL);
+
+	BackgroundWorkerInitializeConnectionByOid(shared->dbid, shared->userid, 0);
+
+	StartTransactionCommand();
+
+	if (!ConditionalLockRelationOid(shared->relid, AccessShareLock))
+	{
+		AppendOnlyCompactionWorker_SetStatus(shared, state,
+											 AOCOMPACTION_WORKER_GAVE_UP);
+		shm_mq_detach(mqh);
+		CommitTransactionCommand();
+		dsm_detach(seg);
+		proc_exit(0);
+	}
+
+	aorel = table_open(shared->relid, NoLock);
+	Assert(RelationIsAoRows(aorel) || RelationIsAoCols(aorel));
+
+	pgstat_report_activity(STATE_RUNNING, "compacting append-optimized segment file");
+
+	/*
+	 * Scan with the leader's snapshot, so that we see the same segment files
+	 * and visibility map entries as it does. The leader holds it registered,
+	 * and thus keeps its xmin, until we're done.
+	 */
+	snapshot = RegisterSnapshot(RestoreSnapshot(shm_toc_lookup(toc,
+															   AOCOMPACTION_KEY_SNAPSHOT,
+															   false)));
+	slot = MakeSingleTupleTableSlot(RelationGetDescr(aorel), &TTSOpsVirtual);
+	slot->tts_tableOid = RelationGetRelid(aorel);
+	dest = CreateTupleQueueDestReceiver(mqh);
+
+	AppendOnlyCompactionWorker_SetStatus(shared, state,
+										 AOCOMPACTION_WORKER_SCANNING);
+
+	SIMPLE_FAULT_INJECTOR("appendonly_compaction_worker_scan");
+
+	/* Scan the segment file like the serial compaction does */
+	if (RelationIsAoRows(aorel))
+	{
+		AppendOnlyScanDesc scanDesc;
+
+		scanDesc = appendonly_beginrangescan(aorel,
+											 SnapshotAny, snapshot,
+											 &segno, 1, 0, NULL);
+		while (appendonly_getnextslot(&scanDesc->rs_base, ForwardScanDirection, slot))
+		{
+			if (!AppendOnlyCompactionWorker_SendTuple(state, dest, slot,
+													  &scanDesc->visibilityMap,
+													  &scannedTupleCount,
+													  &sentTupleCount))
+			{
+				completed = false;
+				break;
+			}
+		}
+		appendonly_endscan(&scanDesc->rs_base);
+	}
+	else
+	{
+		AOCSScanDesc scanDesc;
+
+		scanDesc = aocs_beginrangescan(aorel, snapshot, snapshot, &segno, 1);
+		while (aocs_getnext(scanDesc, ForwardScanDirection, slot))
+		{
+			if (!AppendOnlyCompactionWorker_SendTuple(state, dest, slot,
+													  &scanDesc->visibilityMap,
+													  &scannedTupleCount,
+													  &sentTupleCount))
+			{
+				completed = false;
+				break;
+			}
+		}
+		aocs_endscan(scanDesc);
+	}
+
+	/* The status must be set before the queue is detached */
+	if (completed)
+		AppendOnlyCompactionWorker_SetStatus(shared, state,
+											 AOCOMPACTION_WORKER_DONE);
+	dest->rDestroy(dest);
+
+	ExecDropSingleTupleTableSlot(slot);
+	UnregisterSnapshot(snapshot);
+	table_close(aorel, NoLock);
+
+	CommitTransactionCommand();
+
+	dsm_detach(seg);
+}
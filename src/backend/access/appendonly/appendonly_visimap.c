@@ -72,6 +72,21 @@ typedef struct AppendOnlyVisiMapDeleteData
 
 
 
+/*
+ * Entry of the visimap entry cache, see AppendOnlyVisimap.
+ */
+typedef struct AppendOnlyVisimapCacheData
+{
+	/* Same key as the visimap deletion hash table */
+	AppendOnlyVisiMapDeleteKey key;
+
+	/* Tuple id of the visimap entry, invalid if it does not exist */
+	ItemPointerData tupleTid;
+
+	/* The hidden rows; NULL if all are visible */
+	Bitmapset  *bitmap;
+} AppendOnlyVisimapCacheData;
+
 static void AppendOnlyVisimap_Store(
 						AppendOnlyVisimap *visiMap);
 
@@ -79,6 +94,17 @@ static void AppendOnlyVisimap_Find(
 					   AppendOnlyVisimap *visiMap,
 					   AOTupleId *tupleId);
 
+static bool AppendOnlyVisimap_CacheLookup(
+							  AppendOnlyVisimap *visiMap,
+							  AOTupleId *aoTupleId);
+
+static void AppendOnlyVisimap_CacheAdd(
+						   AppendOnlyVisimap *visiMap);
+
+static void AppendOnlyVisimap_CacheReset(
+							 AppendOnlyVisimap *visiMap,
+							 bool disable);
+
 /*
  * Finishes the visimap operations.
  * No other function should be called with the given
@@ -134,6 +160,10 @@ AppendOnlyVisimap_Init(
 	AppendOnlyVisimapEntry_Init(&visiMap->visimapEntry,
 								visiMap->memoryContext);
 
+	visiMap->entryCache = NULL;
+	visiMap->entryCacheSize = 0;
+	visiMap->entryCacheDisabled = false;
+
 	AppendOnlyVisimapStore_Init(&visiMap->visimapStore,
 								visimapRelid,
 								visimapIdxid,
@@ -144,6 +174,120 @@ AppendOnlyVisimap_Init(
 	MemoryContextSwitchTo(oldContext);
 }
 
+/*
+ * Positions the visibility map entry on a cached copy of the entry that
+ * covers the given tuple id. Returns false if there is none.
+ */
+static bool
+AppendOnlyVisimap_CacheLookup(AppendOnlyVisimap *visiMap,
+							  AOTupleId *aoTupleId)
+{
+	AppendOnlyVisimapEntry *visiMapEntry = &visiMap->visimapEntry;
+	AppendOnlyVisiMapDeleteKey key;
+	AppendOnlyVisimapCacheData *cached;
+	MemoryContext oldContext;
+
+	if (visiMap->entryCache == NULL)
+		return false;
+
+	Assert(!AppendOnlyVisimapEntry_HasChanged(visiMapEntry));
+
+	key.segno = AOTupleIdGet_segmentFileNum(aoTupleId);
+	key.firstRowNum = AppendOnlyVisimapEntry_GetFirstRowNum(visiMapEntry,
+															aoTupleId);
+	cached = hash_search(visiMap->entryCache, &key, HASH_FIND, NULL);
+	if (cached == NULL)
+		return false;
+
+	oldContext = MemoryContextSwitchTo(visiMap->memoryContext);
+
+	bms_free(visiMapEntry->bitmap);
+	visiMapEntry->bitmap = bms_copy(cached->bitmap);
+	visiMapEntry->segmentFileNum = key.segno;
+	visiMapEntry->firstRowNum = key.firstRowNum;
+	visiMapEntry->tupleTid = cached->tupleTid;
+
+	MemoryContextSwitchTo(oldContext);
+
+	return true;
+}
+
+/*
+ * Adds a copy of the current visibility map entry to the entry cache,
+ * unless the cache is full.
+ */
+static void
+AppendOnlyVisimap_CacheAdd(AppendOnlyVisimap *visiMap)
+{
+	AppendOnlyVisimapEntry *visiMapEntry = &visiMap->visimapEntry;
+	AppendOnlyVisiMapDeleteKey key;
+	AppendOnlyVisimapCacheData *cached;
+	MemoryContext oldContext;
+	Size		size;
+	bool		found;
+
+	if (visiMap->entryCacheDisabled)
+		return;
+
+	size = sizeof(AppendOnlyVisimapCacheData);
+	if (visiMapEntry->bitmap)
+		size += offsetof(Bitmapset, words) +
+			visiMapEntry->bitmap->nwords * sizeof(bitmapword);
+	if (visiMap->entryCacheSize + size > APPENDONLY_VISIMAP_CACHE_MAX_SIZE)
+		return;
+
+	if (visiMap->entryCache == NULL)
+	{
+		HASHCTL		hashCtl;
+
+		MemSet(&hashCtl, 0, sizeof(hashCtl));
+		hashCtl.keysize = sizeof(AppendOnlyVisiMapDeleteKey);
+		hashCtl.entrysize = sizeof(AppendOnlyVisimapCacheData);
+		hashCtl.hcxt = visiMap->memoryContext;
+		visiMap->entryCache = hash_create("VisimapReadCache",
+										  64,
+										  &hashCtl,
+										  HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+	}
+
+	key.segno = visiMapEntry->segmentFileNum;
+	key.firstRowNum = visiMapEntry->firstRowNum;
+	cached = hash_search(visiMap->entryCache, &key, HASH_ENTER, &found);
+	if (found)
+		return;
+
+	oldContext = MemoryContextSwitchTo(visiMap->memoryContext);
+	cached->tupleTid = visiMapEntry->tupleTid;
+	cached->bitmap = bms_copy(visiMapEntry->bitmap);
+	MemoryContextSwitchTo(oldContext);
+
+	visiMap->entryCacheSize += size;
+}
+
+/*
+ * Forgets all cached visibility map entries; if disable, stops caching them.
+ */
+static void
+AppendOnlyVisimap_CacheReset(AppendOnlyVisimap *visiMap, bool disable)
+{
+	if (visiMap->entryCache)
+	{
+		HASH_SEQ_STATUS status;
+		AppendOnlyVisimapCacheData *cached;
+
+		hash_seq_init(&status, visiMap->entryCache);
+		while ((cached = hash_seq_search(&status)) != NULL)
+			bms_free(cached->bitmap);
+
+		hash_destroy(visiMap->entryCache);
+		visiMap->entryCache = NULL;
+		visiMap->entryCacheSize = 0;
+	}
+
+	if (disable)
+		visiMap->entryCacheDisabled = true;
+}
+
 /*
  * Moves the visibility map entry so that the given
  * AO tuple id is covered by it.
@@ -167,6 +311,9 @@ AppendOnlyVisimap_Find(
 		   "(tupleId) = %s",
 		   AOTupleIdToString(aoTupleId));
 
+	if (AppendOnlyVisimap_CacheLookup(visiMap, aoTupleId))
+		return;
+
 	if (!AppendOnlyVisimapStore_Find(&visiMap->visimapStore,
 									 AOTupleIdGet_segmentFileNum(aoTupleId),
 									 AppendOnlyVisimapEntry_GetFirstRowNum(
@@ -178,6 +325,29 @@ AppendOnlyVisimap_Find(
 		 */
 		AppendOnlyVisimapEntry_New(&visiMap->visimapEntry, aoTupleId);
 	}
+
+	AppendOnlyVisimap_CacheAdd(visiMap);
+}
+
+/*
+ * Positions the visibility map entry to cover the given tuple id, persisting
+ * the current entry first if it has changed.
+ */
+static inline void
+AppendOnlyVisimap_Position(AppendOnlyVisimap *visiMap,
+						   AOTupleId *aoTupleId)
+{
+	if (!AppendOnlyVisimapEntry_CoversTuple(&visiMap->visimapEntry,
+											aoTupleId))
+	{
+		/* if necessary persist the current entry before moving. */
+		if (AppendOnlyVisimapEntry_HasChanged(&visiMap->visimapEntry))
+		{
+			AppendOnlyVisimap_Store(visiMap);
+		}
+
+		AppendOnlyVisimap_Find(visiMap, aoTupleId);
+	}
 }
 
 /*
@@ -199,23 +369,59 @@ AppendOnlyVisimap_IsVisible(
 		   "(tupleId) = %s",
 		   AOTupleIdToString(aoTupleId));
 
-	if (!AppendOnlyVisimapEntry_CoversTuple(&visiMap->visimapEntry,
-											aoTupleId))
-	{
-		/* if necessary persist the current entry before moving. */
-		if (AppendOnlyVisimapEntry_HasChanged(&visiMap->visimapEntry))
-		{
-			AppendOnlyVisimap_Store(visiMap);
-		}
-
-		AppendOnlyVisimap_Find(visiMap, aoTupleId);
-	}
+	AppendOnlyVisimap_Position(visiMap, aoTupleId);
 
 	/* visimap entry is now positioned to cover the aoTupleId */
 	return AppendOnlyVisimapEntry_IsVisible(&visiMap->visimapEntry,
 											aoTupleId);
 }
 
+/*
+ * Checks the visibility of the nrows consecutive rows of segment file segno
+ * from firstRowNum on, e.g. the rows of a block, at once. Sets visible[i]
+ * iff row firstRowNum + i is visible according to the visibility map, and
+ * returns the number of visible rows.
+ *
+ * The same as calling AppendOnlyVisimap_IsVisible for each row, but the
+ * visibility map entries are looked up once per entry rather than once per
+ * row.
+ */
+int
+AppendOnlyVisimap_GetVisibility(
+								AppendOnlyVisimap *visiMap,
+								int segno,
+								int64 firstRowNum,
+								int nrows,
+								bool *visible)
+{
+	int			nvisible = 0;
+	int			done = 0;
+
+	Assert(visiMap);
+
+	while (done < nrows)
+	{
+		AOTupleId	aoTupleId;
+		int64		rowNum = firstRowNum + done;
+		int64		entryAfterRowNum;
+		int			n;
+
+		AOTupleIdInit(&aoTupleId, segno, rowNum);
+		AppendOnlyVisimap_Position(visiMap, &aoTupleId);
+
+		entryAfterRowNum = visiMap->visimapEntry.firstRowNum +
+			APPENDONLY_VISIMAP_MAX_RANGE;
+		n = (int) Min((int64) (nrows - done), entryAfterRowNum - rowNum);
+
+		nvisible += AppendOnlyVisimapEntry_GetVisibility(&visiMap->visimapEntry,
+														 rowNum, n,
+														 visible + done);
+		done += n;
+	}
+
+	return nvisible;
+}
+
 /*
  * Stores the current visibility map entry information
  * in the relation either as update or delete.
@@ -253,6 +459,9 @@ AppendOnlyVisimap_DeleteSegmentFile(
 
 	AppendOnlyVisimapStore_DeleteSegmentFile(&visiMap->visimapStore,
 											 segno);
+
+	/* The cached entries of the segment file are gone now */
+	AppendOnlyVisimap_CacheReset(visiMap, false);
 }
 
 /*
@@ -422,6 +631,9 @@ AppendOnlyVisimapDelete_Init(
 
 	visiMapDelete->visiMap = visiMap;
 
+	/* The entries change from here on, so do not cache them */
+	AppendOnlyVisimap_CacheReset(visiMap, true);
+
 	MemSet(&hash_ctl, 0, sizeof(hash_ctl));
 	hash_ctl.keysize = sizeof(AppendOnlyVisiMapDeleteKey);
 	hash_ctl.entrysize = sizeof(AppendOnlyVisiMapDeleteData);
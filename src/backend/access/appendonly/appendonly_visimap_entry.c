@@ -126,6 +126,204 @@ AppendOnlyVisimap_GetAttrNotNull(HeapTuple t, TupleDesc td, int attr)
 	return d;
 }
 
+static inline void
+AppendOnlyVisimap_PutUInt16(unsigned char *p, uint16 value)
+{
+	p[0] = (unsigned char) (value & 0xFF);
+	p[1] = (unsigned char) (value >> 8);
+}
+
+static inline uint16
+AppendOnlyVisimap_GetUInt16(const unsigned char *p)
+{
+	return (uint16) (p[0] | (p[1] << 8));
+}
+
+/*
+ * Returns the size of the bitmap as a roaring container, and the type of
+ * the smaller container in *containerType.
+ */
+static int
+AppendOnlyVisimapEntry_RoaringSize(Bitmapset *bitmap, int *containerType)
+{
+	int			count = 0;
+	int			runCount = 0;
+	int			previous = -2;
+	int			offset = -1;
+	int			arraySize;
+	int			runSize;
+
+	while ((offset = bms_next_member(bitmap, offset)) >= 0)
+	{
+		count++;
+		if (offset != previous + 1)
+			runCount++;
+		previous = offset;
+	}
+
+	arraySize = APPENDONLY_VISIMAP_ROARING_HEADER_SIZE + count * sizeof(uint16);
+	runSize = APPENDONLY_VISIMAP_ROARING_HEADER_SIZE + runCount * 2 * sizeof(uint16);
+
+	if (runSize < arraySize)
+	{
+		*containerType = APPENDONLY_VISIMAP_ROARING_RUN;
+		return runSize;
+	}
+	*containerType = APPENDONLY_VISIMAP_ROARING_ARRAY;
+	return arraySize;
+}
+
+/*
+ * Writes the bitmap into buffer as a roaring container of the given type.
+ * Returns the number of bytes written.
+ */
+static int
+AppendOnlyVisimapEntry_RoaringCompress(Bitmapset *bitmap, int containerType,
+									   unsigned char *buffer)
+{
+	unsigned char *p = buffer + APPENDONLY_VISIMAP_ROARING_HEADER_SIZE;
+	int			count = 0;
+	int			offset = -1;
+
+	if (containerType == APPENDONLY_VISIMAP_ROARING_ARRAY)
+	{
+		while ((offset = bms_next_member(bitmap, offset)) >= 0)
+		{
+			Assert(offset < APPENDONLY_VISIMAP_MAX_RANGE);
+			AppendOnlyVisimap_PutUInt16(p, (uint16) offset);
+			p += sizeof(uint16);
+			count++;
+		}
+	}
+	else
+	{
+		int			runStart = -1;
+		int			runLast = -2;
+
+		Assert(containerType == APPENDONLY_VISIMAP_ROARING_RUN);
+		while (true)
+		{
+			offset = bms_next_member(bitmap, runLast < 0 ? -1 : runLast);
+			if (offset >= 0 && offset == runLast + 1)
+			{
+				runLast = offset;
+				continue;
+			}
+
+			/* The current run, if any, ends at runLast */
+			if (runStart >= 0)
+			{
+				Assert(runLast < APPENDONLY_VISIMAP_MAX_RANGE);
+				AppendOnlyVisimap_PutUInt16(p, (uint16) runStart);
+				AppendOnlyVisimap_PutUInt16(p + sizeof(uint16),
+											(uint16) (runLast - runStart));
+				p += 2 * sizeof(uint16);
+				count++;
+			}
+			if (offset < 0)
+				break;
+			runStart = runLast = offset;
+		}
+	}
+
+	AppendOnlyVisimap_PutUInt16(buffer, (uint16) containerType);
+	AppendOnlyVisimap_PutUInt16(buffer + sizeof(uint16), (uint16) count);
+
+	return p - buffer;
+}
+
+/*
+ * Sets the bits from offset first to offset last, inclusive.
+ */
+static void
+AppendOnlyVisimapEntry_SetRange(Bitmapset *bitmap, int first, int last)
+{
+	while (first <= last)
+	{
+		int			wordnum = first / BITS_PER_BITMAPWORD;
+		int			bitnum = first % BITS_PER_BITMAPWORD;
+		int			nbits = Min(BITS_PER_BITMAPWORD - bitnum, last - first + 1);
+		bitmapword	mask;
+
+		mask = (nbits == BITS_PER_BITMAPWORD) ? ~((bitmapword) 0) :
+			(((bitmapword) 1 << nbits) - 1) << bitnum;
+		bitmap->words[wordnum] |= mask;
+		first += nbits;
+	}
+}
+
+/*
+ * Reads the bitmap from a roaring container in the entry data.
+ */
+static void
+AppendOnlyVisimapEntry_RoaringDecompress(AppendOnlyVisimapEntry *visiMapEntry,
+										 size_t dataSize)
+{
+	const unsigned char *data = visiMapEntry->data->data;
+	int			containerType;
+	int			count;
+	int			elementSize;
+	int			maxOffset;
+	int			nwords;
+
+	if (dataSize < APPENDONLY_VISIMAP_ROARING_HEADER_SIZE)
+		elog(ERROR, "visimap roaring container too short: %zu bytes", dataSize);
+
+	containerType = AppendOnlyVisimap_GetUInt16(data);
+	count = AppendOnlyVisimap_GetUInt16(data + sizeof(uint16));
+	data += APPENDONLY_VISIMAP_ROARING_HEADER_SIZE;
+
+	if (containerType == APPENDONLY_VISIMAP_ROARING_ARRAY)
+		elementSize = sizeof(uint16);
+	else if (containerType == APPENDONLY_VISIMAP_ROARING_RUN)
+		elementSize = 2 * sizeof(uint16);
+	else
+		elog(ERROR, "unrecognized visimap roaring container type %d",
+			 containerType);
+
+	if (APPENDONLY_VISIMAP_ROARING_HEADER_SIZE + count * elementSize > dataSize)
+		elog(ERROR, "visimap roaring container of %d elements is longer than %zu bytes",
+			 count, dataSize);
+
+	bms_free(visiMapEntry->bitmap);
+	visiMapEntry->bitmap = NULL;
+	if (count == 0)
+		return;
+
+	/* The elements are sorted, so the last one has the largest offset */
+	maxOffset = AppendOnlyVisimap_GetUInt16(data + (count - 1) * elementSize);
+	if (containerType == APPENDONLY_VISIMAP_ROARING_RUN)
+		maxOffset += AppendOnlyVisimap_GetUInt16(data + (count - 1) * elementSize +
+												 sizeof(uint16));
+	if (maxOffset >= APPENDONLY_VISIMAP_MAX_RANGE)
+		elog(ERROR, "illegal visimap offset %d", maxOffset);
+
+	nwords = maxOffset / BITS_PER_BITMAPWORD + 1;
+	visiMapEntry->bitmap = palloc0(offsetof(Bitmapset, words) +
+								   nwords * sizeof(bitmapword));
+	visiMapEntry->bitmap->nwords = nwords;
+
+	for (int i = 0; i < count; i++)
+	{
+		int			first = AppendOnlyVisimap_GetUInt16(data);
+
+		if (containerType == APPENDONLY_VISIMAP_ROARING_ARRAY)
+		{
+			visiMapEntry->bitmap->words[first / BITS_PER_BITMAPWORD] |=
+				(bitmapword) 1 << (first % BITS_PER_BITMAPWORD);
+		}
+		else
+		{
+			int			last = first + AppendOnlyVisimap_GetUInt16(data + sizeof(uint16));
+
+			if (last > maxOffset)
+				elog(ERROR, "illegal visimap offset %d", last);
+			AppendOnlyVisimapEntry_SetRange(visiMapEntry->bitmap, first, last);
+		}
+		data += elementSize;
+	}
+}
+
 void
 AppendOnlyVisiMapEnty_ReadData(AppendOnlyVisimapEntry *visiMapEntry, size_t dataSize)
 {
@@ -134,6 +332,17 @@ AppendOnlyVisiMapEnty_ReadData(AppendOnlyVisimapEntry *visiMapEntry, size_t data
 	Assert(visiMapEntry);
 	Assert(CurrentMemoryContext == visiMapEntry->memoryContext);
 
+	if (visiMapEntry->data->version == APPENDONLY_VISIMAP_VERSION_ROARING)
+	{
+		AppendOnlyVisimapEntry_RoaringDecompress(visiMapEntry, dataSize);
+		return;
+	}
+	else if (visiMapEntry->data->version != APPENDONLY_VISIMAP_VERSION_BITMAP)
+	{
+		elog(ERROR, "unrecognized visimap format version %d",
+			 visiMapEntry->data->version);
+	}
+
 	BitmapDecompressState decompressState;
 
 	BitmapDecompress_Init(&decompressState,
@@ -260,7 +469,9 @@ void
 AppendOnlyVisimapEntry_WriteData(AppendOnlyVisimapEntry *visiMapEntry)
 {
 	int			bitmapSize,
-				compressedBitmapSize;
+				compressedBitmapSize,
+				roaringSize,
+				containerType;
 
 	Assert(visiMapEntry);
 	Assert(CurrentMemoryContext == visiMapEntry->memoryContext);
@@ -271,7 +482,7 @@ AppendOnlyVisimapEntry_WriteData(AppendOnlyVisimapEntry *visiMapEntry)
 
 	Assert(visiMapEntry->data);
 	Assert(APPENDONLY_VISIMAP_DATA_BUFFER_SIZE >= bitmapSize);
-	visiMapEntry->data->version = 1;
+	visiMapEntry->data->version = APPENDONLY_VISIMAP_VERSION_BITMAP;
 
 	compressedBitmapSize = Bitmap_Compress(BITMAP_COMPRESSION_TYPE_DEFAULT,
 										   (visiMapEntry->bitmap ? visiMapEntry->bitmap->words : NULL),
@@ -279,6 +490,20 @@ AppendOnlyVisimapEntry_WriteData(AppendOnlyVisimapEntry *visiMapEntry)
 										   visiMapEntry->data->data,
 										   bitmapSize);
 	Assert(compressedBitmapSize >= BITMAP_COMPRESSION_HEADER_SIZE);
+
+	/* Use a roaring container instead if it is smaller */
+	roaringSize = AppendOnlyVisimapEntry_RoaringSize(visiMapEntry->bitmap,
+													 &containerType);
+	if (roaringSize < compressedBitmapSize)
+	{
+		visiMapEntry->data->version = APPENDONLY_VISIMAP_VERSION_ROARING;
+		compressedBitmapSize =
+			AppendOnlyVisimapEntry_RoaringCompress(visiMapEntry->bitmap,
+												   containerType,
+												   visiMapEntry->data->data);
+		Assert(compressedBitmapSize == roaringSize);
+	}
+
 	SET_VARSIZE(visiMapEntry->data,
 				offsetof(AppendOnlyVisimapData, data) + compressedBitmapSize);
 
@@ -473,6 +698,52 @@ AppendOnlyVisimapEntry_IsVisible(
 	return visibilityBit;
 }
 
+/*
+ * Checks the visibility of the nrows rows from rowNum on, which the entry
+ * must all cover, at once. Sets visible[i] iff row rowNum + i is visible
+ * according to the bitmap, and returns the number of visible rows.
+ *
+ * The same as calling AppendOnlyVisimapEntry_IsVisible for each row.
+ */
+int
+AppendOnlyVisimapEntry_GetVisibility(
+									 AppendOnlyVisimapEntry *visiMapEntry,
+									 int64 rowNum,
+									 int nrows,
+									 bool *visible)
+{
+	Bitmapset  *bitmap = visiMapEntry->bitmap;
+	int64		rowNumOffset;
+	int			nvisible = 0;
+
+	Assert(visiMapEntry);
+	Assert(AppendOnlyVisimapEntry_IsValid(visiMapEntry));
+	Assert(nrows > 0);
+
+	AppendOnlyVisimapEntry_GetRownumOffset(visiMapEntry,
+										   rowNum, &rowNumOffset);
+	Assert(rowNumOffset + nrows <= APPENDONLY_VISIMAP_MAX_RANGE);
+
+	if (AppendOnlyVisimapEntry_AreAllVisible(visiMapEntry))
+	{
+		memset(visible, true, nrows * sizeof(bool));
+		return nrows;
+	}
+
+	for (int i = 0; i < nrows; i++)
+	{
+		int			offset = (int) rowNumOffset + i;
+		int			wordnum = offset / BITS_PER_BITMAPWORD;
+
+		visible[i] = (wordnum >= bitmap->nwords ||
+					  (bitmap->words[wordnum] &
+					   ((bitmapword) 1 << (offset % BITS_PER_BITMAPWORD))) == 0);
+		nvisible += visible[i];
+	}
+
+	return nvisible;
+}
+
 /*
  * The minimal size (in uint32's elements) the entry array needs to have to
  * cover the given offset
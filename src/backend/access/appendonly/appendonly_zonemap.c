@@ -0,0 +1,688 @@
+/*------------------------------------------------------------------------------
+ *
+ * appendonly_zonemap.c
+ *   per-block min/max summaries of the columns of append-only relations.
+ *
+ * The summaries are written by the block directory, one per column and
+ * block directory entry, see cdbappendonlyblockdirectory.h. This file
+ * contains the functions that maintain a summary, and the functions that
+ * sequential scans use to decide from the summaries of a segment file
+ * whether a range of rows can contain any row satisfying the scan quals.
+ *
+ * Only simple quals are considered: a btree comparison operator between a
+ * column and a constant, and IS [NOT] NULL on a column. All other quals are
+ * ignored, which is safe because the scan still evaluates all of them on
+ * the rows it returns.
+ *
+ * Copyright (c) 2022-Present VMware, Inc. or its affiliates.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/backend/access/appendonly/appendonly_zonemap.c
+ *
+ *------------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/appendonly_zonemap.h"
+#include "access/genam.h"
+#include "access/nbtree.h"
+#include "access/table.h"
+#include "catalog/aoblkdir.h"
+#include "catalog/pg_appendonly.h"
+#include "cdb/cdbappendonlyblockdirectory.h"
+#include "utils/datum.h"
+#include "utils/fmgroids.h"
+#include "utils/guc.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+#include "utils/typcache.h"
+
+static bool zonemap_var_usable(Relation aoRel, Expr *expr);
+static bool zonemap_key_from_clause(Relation aoRel, Expr *clause,
+									AOZoneMapKey *key);
+static void zonemap_load_column_group(AppendOnlyZoneMap *zonemap, int segno,
+									  int columnGroupNo);
+static void zonemap_add_entry(AOZoneMapSegmentColumn *column,
+							  MinipageEntry *entry,
+							  AOZoneMapSummary *summary);
+static bool zonemap_summary_refutes(AOZoneMapKey *key,
+									AOZoneMapSummary *summary);
+static bool zonemap_key_refutes_rows(AOZoneMapKey *key,
+									 int64 firstRowNum, int64 lastRowNum);
+
+/*
+ * AppendOnlyZoneMap_InitColumns
+ *
+ * Decide which columns of a relation with the given tuple descriptor are
+ * summarized, and look up their comparison functions. Returns true if any
+ * column is.
+ *
+ * The min and max of a summary are stored as plain Datums, so only columns
+ * of fixed-length pass-by-value types are summarized.
+ */
+bool
+AppendOnlyZoneMap_InitColumns(TupleDesc tupdesc, AOZoneMapColumn *columns)
+{
+	bool		anyTracked = false;
+	int			i;
+
+	for (i = 0; i < tupdesc->natts; i++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, i);
+		TypeCacheEntry *typentry;
+
+		columns[i].tracked = false;
+
+		if (attr->attisdropped || !attr->attbyval || attr->attlen <= 0)
+			continue;
+
+		typentry = lookup_type_cache(attr->atttypid, TYPECACHE_CMP_PROC);
+		if (!OidIsValid(typentry->cmp_proc))
+			continue;
+
+		fmgr_info(typentry->cmp_proc, &columns[i].cmpproc);
+		columns[i].collation = attr->attcollation;
+		columns[i].tracked = true;
+		anyTracked = true;
+	}
+
+	return anyTracked;
+}
+
+/*
+ * AppendOnlyZoneMap_AddValue
+ *
+ * Record a value of a column in a summary.
+ */
+void
+AppendOnlyZoneMap_AddValue(AOZoneMapColumn *column,
+						   AOZoneMapSummary *summary,
+						   Datum value, bool isnull)
+{
+	Assert(column->tracked);
+
+	summary->flags |= AOZONEMAP_VALID;
+
+	if (isnull)
+	{
+		summary->nnulls++;
+		return;
+	}
+
+	if ((summary->flags & AOZONEMAP_HAS_MINMAX) == 0)
+	{
+		summary->min = value;
+		summary->max = value;
+		summary->flags |= AOZONEMAP_HAS_MINMAX;
+		return;
+	}
+
+	if (DatumGetInt32(FunctionCall2Coll(&column->cmpproc, column->collation,
+										value, summary->min)) < 0)
+		summary->min = value;
+	else if (DatumGetInt32(FunctionCall2Coll(&column->cmpproc, column->collation,
+											 value, summary->max)) > 0)
+		summary->max = value;
+}
+
+/*
+ * AppendOnlyZoneMap_Merge
+ *
+ * Widen a summary to also cover the values of another one. The result only
+ * tells something about the values if both summaries do.
+ */
+void
+AppendOnlyZoneMap_Merge(AOZoneMapColumn *column,
+						AOZoneMapSummary *summary,
+						AOZoneMapSummary *other)
+{
+	if ((summary->flags & AOZONEMAP_VALID) == 0 ||
+		(other->flags & AOZONEMAP_VALID) == 0)
+	{
+		MemSet(summary, 0, sizeof(AOZoneMapSummary));
+		return;
+	}
+
+	summary->nnulls += other->nnulls;
+
+	if ((other->flags & AOZONEMAP_HAS_MINMAX) == 0)
+		return;
+
+	if ((summary->flags & AOZONEMAP_HAS_MINMAX) == 0)
+	{
+		summary->min = other->min;
+		summary->max = other->max;
+		summary->flags |= AOZONEMAP_HAS_MINMAX;
+		return;
+	}
+
+	if (DatumGetInt32(FunctionCall2Coll(&column->cmpproc, column->collation,
+										other->min, summary->min)) < 0)
+		summary->min = other->min;
+	if (DatumGetInt32(FunctionCall2Coll(&column->cmpproc, column->collation,
+										other->max, summary->max)) > 0)
+		summary->max = other->max;
+}
+
+/*
+ * Is the expression a column of the scanned relation that may have
+ * summaries?
+ */
+static bool
+zonemap_var_usable(Relation aoRel, Expr *expr)
+{
+	Var		   *var;
+	Form_pg_attribute attr;
+
+	if (!IsA(expr, Var))
+		return false;
+
+	var = (Var *) expr;
+	if (var->varlevelsup != 0 ||
+		var->varattno <= 0 ||
+		var->varattno > RelationGetNumberOfAttributes(aoRel))
+		return false;
+
+	attr = TupleDescAttr(RelationGetDescr(aoRel), var->varattno - 1);
+
+	return !attr->attisdropped && attr->attbyval && attr->attlen > 0 &&
+		attr->atttypid == var->vartype;
+}
+
+/*
+ * Turn a qual of the scan into a zone map key, if it has a form that the
+ * summaries can refute.
+ */
+static bool
+zonemap_key_from_clause(Relation aoRel, Expr *clause, AOZoneMapKey *key)
+{
+	if (IsA(clause, OpExpr))
+	{
+		OpExpr	   *opexpr = (OpExpr *) clause;
+		Expr	   *leftop;
+		Expr	   *rightop;
+		Var		   *var;
+		Const	   *cnst;
+		bool		varonleft;
+		TypeCacheEntry *typentry;
+		int			strategy;
+		Oid			lefttype;
+		Oid			righttype;
+		Oid			cmpproc;
+
+		if (list_length(opexpr->args) != 2)
+			return false;
+
+		leftop = (Expr *) linitial(opexpr->args);
+		rightop = (Expr *) lsecond(opexpr->args);
+
+		if (IsA(rightop, Const) && zonemap_var_usable(aoRel, leftop))
+		{
+			var = (Var *) leftop;
+			cnst = (Const *) rightop;
+			varonleft = true;
+		}
+		else if (IsA(leftop, Const) && zonemap_var_usable(aoRel, rightop))
+		{
+			var = (Var *) rightop;
+			cnst = (Const *) leftop;
+			varonleft = false;
+		}
+		else
+			return false;
+
+		if (cnst->constisnull)
+			return false;
+
+		typentry = lookup_type_cache(var->vartype, TYPECACHE_BTREE_OPFAMILY);
+		if (!OidIsValid(typentry->btree_opf))
+			return false;
+
+		/*
+		 * The summaries were computed with the default btree opclass of the
+		 * column type, so the operator must belong to the same family.
+		 */
+		strategy = get_op_opfamily_strategy(opexpr->opno, typentry->btree_opf);
+		if (strategy == InvalidStrategy)
+			return false;
+
+		op_input_types(opexpr->opno, &lefttype, &righttype);
+		if (!varonleft)
+		{
+			Oid			tmp = lefttype;
+
+			lefttype = righttype;
+			righttype = tmp;
+			strategy = BTCommuteStrategyNumber(strategy);
+		}
+
+		if (lefttype != var->vartype || righttype != cnst->consttype)
+			return false;
+
+		cmpproc = get_opfamily_proc(typentry->btree_opf, lefttype, righttype,
+									BTORDER_PROC);
+		if (!RegProcedureIsValid(cmpproc))
+			return false;
+
+		key->attno = var->varattno;
+		key->strategy = strategy;
+		fmgr_info(cmpproc, &key->cmpproc);
+		key->collation = opexpr->inputcollid;
+		key->argument = datumCopy(cnst->constvalue, cnst->constbyval,
+								  cnst->constlen);
+		return true;
+	}
+	else if (IsA(clause, NullTest))
+	{
+		NullTest   *ntest = (NullTest *) clause;
+
+		if (ntest->argisrow || !zonemap_var_usable(aoRel, ntest->arg))
+			return false;
+
+		key->attno = ((Var *) ntest->arg)->varattno;
+		key->strategy = InvalidStrategy;
+		key->nulltesttype = ntest->nulltesttype;
+		return true;
+	}
+
+	return false;
+}
+
+/*
+ * AppendOnlyZoneMap_Begin
+ *
+ * Set up the zone maps for a scan of an append-only relation with the given
+ * quals, in implicit-AND form.
+ *
+ * Returns NULL if zone maps are disabled, if the relation has no block
+ * directory to keep them in, or if none of the quals can be checked against
+ * them.
+ */
+AppendOnlyZoneMap *
+AppendOnlyZoneMap_Begin(Relation aoRel,
+						Snapshot appendOnlyMetaDataSnapshot,
+						List *qual,
+						bool isAOCol)
+{
+	AppendOnlyZoneMap *zonemap;
+	MemoryContext oldcxt;
+	MemoryContext zonemapcxt;
+	Oid			blkdirrelid;
+	Oid			blkdiridxid;
+	ListCell   *lc;
+	int			i;
+	int			j;
+
+	if (!gp_appendonly_enable_zonemaps || qual == NIL)
+		return NULL;
+
+	GetAppendOnlyEntryAuxOids(aoRel->rd_id, NULL, NULL,
+							  &blkdirrelid, &blkdiridxid, NULL, NULL);
+	if (!OidIsValid(blkdirrelid))
+		return NULL;
+
+	zonemapcxt = AllocSetContextCreate(CurrentMemoryContext,
+									   "AppendOnlyZoneMapContext",
+									   ALLOCSET_SMALL_SIZES);
+	oldcxt = MemoryContextSwitchTo(zonemapcxt);
+
+	zonemap = palloc0(sizeof(AppendOnlyZoneMap));
+	zonemap->memoryContext = zonemapcxt;
+	zonemap->aoRel = aoRel;
+	zonemap->appendOnlyMetaDataSnapshot = appendOnlyMetaDataSnapshot;
+	zonemap->isAOCol = isAOCol;
+
+	zonemap->keys = palloc0(sizeof(AOZoneMapKey) * list_length(qual));
+	foreach(lc, qual)
+	{
+		if (zonemap_key_from_clause(aoRel, (Expr *) lfirst(lc),
+									&zonemap->keys[zonemap->numKeys]))
+			zonemap->numKeys++;
+	}
+
+	if (zonemap->numKeys == 0)
+	{
+		MemoryContextSwitchTo(oldcxt);
+		MemoryContextDelete(zonemapcxt);
+		return NULL;
+	}
+
+	/* Summaries are loaded once per column, however many keys it has. */
+	zonemap->columns = palloc0(sizeof(AOZoneMapSegmentColumn) * zonemap->numKeys);
+	for (i = 0; i < zonemap->numKeys; i++)
+	{
+		AOZoneMapKey *key = &zonemap->keys[i];
+
+		for (j = 0; j < zonemap->numColumns; j++)
+		{
+			if (zonemap->columns[j].attno == key->attno)
+				break;
+		}
+		if (j == zonemap->numColumns)
+		{
+			zonemap->columns[j].attno = key->attno;
+			zonemap->numColumns++;
+		}
+	}
+
+	/*
+	 * Point the keys at their columns only now that the array of columns is
+	 * complete.
+	 */
+	for (i = 0; i < zonemap->numKeys; i++)
+	{
+		for (j = 0; j < zonemap->numColumns; j++)
+		{
+			if (zonemap->columns[j].attno == zonemap->keys[i].attno)
+				zonemap->keys[i].column = &zonemap->columns[j];
+		}
+	}
+
+	zonemap->blkdirRel = table_open(blkdirrelid, AccessShareLock);
+	zonemap->blkdirIdx = index_open(blkdiridxid, AccessShareLock);
+
+	MemoryContextSwitchTo(oldcxt);
+
+	return zonemap;
+}
+
+/*
+ * Append a block directory entry and its summary to the entries of a column.
+ */
+static void
+zonemap_add_entry(AOZoneMapSegmentColumn *column,
+				  MinipageEntry *entry,
+				  AOZoneMapSummary *summary)
+{
+	if (column->numEntries == column->maxEntries)
+	{
+		int			newMax = Max(column->maxEntries * 2, NUM_MINIPAGE_ENTRIES);
+
+		if (column->maxEntries == 0)
+		{
+			column->firstRowNums = palloc(sizeof(int64) * newMax);
+			column->rowCounts = palloc(sizeof(int64) * newMax);
+			column->summaries = palloc(sizeof(AOZoneMapSummary) * newMax);
+		}
+		else
+		{
+			column->firstRowNums = repalloc(column->firstRowNums,
+											sizeof(int64) * newMax);
+			column->rowCounts = repalloc(column->rowCounts,
+										 sizeof(int64) * newMax);
+			column->summaries = repalloc(column->summaries,
+										 sizeof(AOZoneMapSummary) * newMax);
+		}
+		column->maxEntries = newMax;
+	}
+
+	column->firstRowNums[column->numEntries] = entry->firstRowNum;
+	column->rowCounts[column->numEntries] = entry->rowCount;
+	column->summaries[column->numEntries] = *summary;
+	column->numEntries++;
+}
+
+/*
+ * Load the summaries of the columns in a column group of a segment file.
+ *
+ * The block directory of a row-oriented relation has a single column group,
+ * with the summaries of all columns; that of a column-oriented relation has
+ * one column group per column.
+ */
+static void
+zonemap_load_column_group(AppendOnlyZoneMap *zonemap, int segno,
+						  int columnGroupNo)
+{
+	ScanKeyData scanKeys[2];
+	SysScanDesc idxScanDesc;
+	HeapTuple	tuple;
+	TupleDesc	tupdesc = RelationGetDescr(zonemap->blkdirRel);
+
+	ScanKeyInit(&scanKeys[0],
+				1,				/* segno */
+				BTEqualStrategyNumber,
+				F_INT4EQ,
+				Int32GetDatum(segno));
+	ScanKeyInit(&scanKeys[1],
+				2,				/* columngroup_no */
+				BTEqualStrategyNumber,
+				F_INT4EQ,
+				Int32GetDatum(columnGroupNo));
+
+	idxScanDesc = systable_beginscan_ordered(zonemap->blkdirRel,
+											 zonemap->blkdirIdx,
+											 zonemap->appendOnlyMetaDataSnapshot,
+											 2, scanKeys);
+
+	while ((tuple = systable_getnext_ordered(idxScanDesc,
+											 ForwardScanDirection)) != NULL)
+	{
+		struct varlena *value;
+		struct varlena *detoast_value;
+		Minipage   *minipage;
+		bool		isnull;
+		int			nColumns;
+		int			c;
+
+		value = (struct varlena *)
+			DatumGetPointer(heap_getattr(tuple, Anum_pg_aoblkdir_minipage,
+										 tupdesc, &isnull));
+		Assert(!isnull);
+		detoast_value = pg_detoast_datum(value);
+		minipage = (Minipage *) detoast_value;
+
+		nColumns = AppendOnlyBlockDirectory_MinipageZoneMapColumns(minipage);
+
+		for (c = 0; c < zonemap->numColumns; c++)
+		{
+			AOZoneMapSegmentColumn *column = &zonemap->columns[c];
+			int			columnNo;
+			uint32		entryNo;
+
+			if (zonemap->isAOCol)
+			{
+				if (column->attno - 1 != columnGroupNo)
+					continue;
+				columnNo = 0;
+			}
+			else
+				columnNo = column->attno - 1;
+
+			for (entryNo = 0; entryNo < minipage->nEntry; entryNo++)
+			{
+				AOZoneMapSummary summary;
+
+				if (columnNo < nColumns)
+					AppendOnlyBlockDirectory_MinipageZoneMapSummary(minipage,
+																	entryNo,
+																	columnNo,
+																	&summary);
+				else
+					MemSet(&summary, 0, sizeof(AOZoneMapSummary));
+
+				zonemap_add_entry(column, &minipage->entry[entryNo], &summary);
+			}
+		}
+
+		if (detoast_value != value)
+			pfree(detoast_value);
+	}
+
+	systable_endscan_ordered(idxScanDesc);
+}
+
+/*
+ * AppendOnlyZoneMap_LoadSegmentFile
+ *
+ * Load the summaries of the scanned columns in a segment file, replacing
+ * those of the previous segment file.
+ */
+void
+AppendOnlyZoneMap_LoadSegmentFile(AppendOnlyZoneMap *zonemap, int segno)
+{
+	MemoryContext oldcxt;
+	int			c;
+
+	oldcxt = MemoryContextSwitchTo(zonemap->memoryContext);
+
+	for (c = 0; c < zonemap->numColumns; c++)
+		zonemap->columns[c].numEntries = 0;
+
+	if (!zonemap->isAOCol)
+		zonemap_load_column_group(zonemap, segno, 0);
+	else
+	{
+		for (c = 0; c < zonemap->numColumns; c++)
+			zonemap_load_column_group(zonemap, segno,
+									  zonemap->columns[c].attno - 1);
+	}
+
+	MemoryContextSwitchTo(oldcxt);
+}
+
+/*
+ * Can no value in a summary satisfy the key?
+ */
+static bool
+zonemap_summary_refutes(AOZoneMapKey *key, AOZoneMapSummary *summary)
+{
+	int32		cmp;
+
+	if ((summary->flags & AOZONEMAP_VALID) == 0)
+		return false;
+
+	if (key->strategy == InvalidStrategy)
+	{
+		if (key->nulltesttype == IS_NULL)
+			return summary->nnulls == 0;
+		else
+			return (summary->flags & AOZONEMAP_HAS_MINMAX) == 0;
+	}
+
+	/* Operators are strict, so all-NULL values never satisfy them. */
+	if ((summary->flags & AOZONEMAP_HAS_MINMAX) == 0)
+		return true;
+
+	switch (key->strategy)
+	{
+		case BTLessStrategyNumber:
+		case BTLessEqualStrategyNumber:
+			cmp = DatumGetInt32(FunctionCall2Coll(&key->cmpproc, key->collation,
+												  summary->min, key->argument));
+			return key->strategy == BTLessStrategyNumber ? cmp >= 0 : cmp > 0;
+
+		case BTEqualStrategyNumber:
+			cmp = DatumGetInt32(FunctionCall2Coll(&key->cmpproc, key->collation,
+												  summary->min, key->argument));
+			if (cmp > 0)
+				return true;
+			cmp = DatumGetInt32(FunctionCall2Coll(&key->cmpproc, key->collation,
+												  summary->max, key->argument));
+			return cmp < 0;
+
+		case BTGreaterEqualStrategyNumber:
+		case BTGreaterStrategyNumber:
+			cmp = DatumGetInt32(FunctionCall2Coll(&key->cmpproc, key->collation,
+												  summary->max, key->argument));
+			return key->strategy == BTGreaterStrategyNumber ? cmp <= 0 : cmp < 0;
+
+		default:
+			return false;
+	}
+}
+
+/*
+ * Do the summaries of the key's column prove that no row in the given range
+ * satisfies the key? The range must be covered by entries, without gaps,
+ * each of which refutes the key.
+ */
+static bool
+zonemap_key_refutes_rows(AOZoneMapKey *key, int64 firstRowNum, int64 lastRowNum)
+{
+	AOZoneMapSegmentColumn *column = key->column;
+	int			low = 0;
+	int			high = column->numEntries - 1;
+	int			entryNo = -1;
+	int64		rowNum = firstRowNum;
+
+	/* Find the last entry that starts at or before the first row. */
+	while (low <= high)
+	{
+		int			mid = low + (high - low) / 2;
+
+		if (column->firstRowNums[mid] <= firstRowNum)
+		{
+			entryNo = mid;
+			low = mid + 1;
+		}
+		else
+			high = mid - 1;
+	}
+
+	if (entryNo < 0)
+		return false;
+
+	for (; entryNo < column->numEntries; entryNo++)
+	{
+		int64		entryLastRowNum = column->firstRowNums[entryNo] +
+		column->rowCounts[entryNo] - 1;
+
+		if (column->firstRowNums[entryNo] > rowNum || entryLastRowNum < rowNum)
+			return false;
+
+		if (!zonemap_summary_refutes(key, &column->summaries[entryNo]))
+			return false;
+
+		if (entryLastRowNum >= lastRowNum)
+			return true;
+
+		rowNum = entryLastRowNum + 1;
+	}
+
+	return false;
+}
+
+/*
+ * AppendOnlyZoneMap_SkipRows
+ *
+ * Can the rows with the given row numbers of the current segment file,
+ * typically those of a block, be skipped because none of them can satisfy
+ * the quals of the scan?
+ */
+bool
+AppendOnlyZoneMap_SkipRows(AppendOnlyZoneMap *zonemap,
+						   int64 firstRowNum, int64 rowCount)
+{
+	int			i;
+
+	zonemap->blocksSeen++;
+
+	if (firstRowNum < 0 || rowCount <= 0)
+		return false;
+
+	for (i = 0; i < zonemap->numKeys; i++)
+	{
+		if (zonemap_key_refutes_rows(&zonemap->keys[i], firstRowNum,
+									 firstRowNum + rowCount - 1))
+		{
+			zonemap->blocksSkipped++;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * AppendOnlyZoneMap_End
+ */
+void
+AppendOnlyZoneMap_End(AppendOnlyZoneMap *zonemap)
+{
+	index_close(zonemap->blkdirIdx, AccessShareLock);
+	table_close(zonemap->blkdirRel, AccessShareLock);
+
+	MemoryContextDelete(zonemap->memoryContext);
+}
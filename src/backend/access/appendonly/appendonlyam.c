@@ -341,6 +341,9 @@ SetNextFileSegForRead(AppendOnlyScanDesc scan)
 												 &scan->executorReadBlock,
 												  /* blockFirstRowNum */ 1);
 
+	if (scan->zonemap)
+		AppendOnlyZoneMap_LoadSegmentFile(scan->zonemap, segno);
+
 	/* ready to go! */
 	scan->aos_need_new_segfile = false;
 
@@ -1237,6 +1240,40 @@ AppendOnlyExecutorReadBlock_FetchTuple(AppendOnlyExecutorReadBlock *executorRead
 
 /* ------------------------------------------------------------------------------ */
 
+/*
+ * Look up the visibility of the rows of the current block. Returns false if
+ * none of them is visible.
+ */
+static bool
+getBlockVisibility(AppendOnlyScanDesc scan)
+{
+	AppendOnlyExecutorReadBlock *executorReadBlock = &scan->executorReadBlock;
+	int			rowCount = executorReadBlock->rowCount;
+	int			nvisible;
+
+	scan->blockAllVisible = true;
+	if (scan->snapshot == SnapshotAny || rowCount <= 0)
+		return true;
+
+	if (scan->blockVisibleSize < rowCount)
+	{
+		if (scan->blockVisible)
+			pfree(scan->blockVisible);
+		scan->blockVisible = (bool *)
+			MemoryContextAlloc(scan->aoScanInitContext, rowCount * sizeof(bool));
+		scan->blockVisibleSize = rowCount;
+	}
+
+	nvisible = AppendOnlyVisimap_GetVisibility(&scan->visibilityMap,
+											   executorReadBlock->segmentFileNum,
+											   executorReadBlock->blockFirstRowNum,
+											   rowCount,
+											   scan->blockVisible);
+	scan->blockAllVisible = (nvisible == rowCount);
+
+	return nvisible > 0;
+}
+
 /*
  * You can think of this scan routine as get next "executor" AO block.
  */
@@ -1267,6 +1304,39 @@ getNextBlock(AppendOnlyScanDesc scan)
 		return false;
 	}
 
+	/*
+	 * Skip the block without reading its contents if the zone maps show that
+	 * none of its rows can satisfy the scan quals. The caller then simply
+	 * asks for the next block.
+	 */
+	if (scan->zonemap &&
+		AppendOnlyZoneMap_SkipRows(scan->zonemap,
+								   scan->executorReadBlock.blockFirstRowNum,
+								   scan->executorReadBlock.rowCount))
+	{
+		Assert(scan->blockDirectory == NULL);
+
+		AppendOnlyStorageRead_SkipCurrentBlock(&scan->storageRead);
+		AppendOnlyExecutionReadBlock_FinishedScanBlock(&scan->executorReadBlock);
+
+		return false;
+	}
+
+	/*
+	 * Look up the visibility of all the rows of the block at once. Skip the
+	 * block altogether if none of them is visible, unless it has to be
+	 * recorded in the block directory, or ANALYZE wants to count the rows.
+	 */
+	if (!getBlockVisibility(scan) &&
+		scan->blockDirectory == NULL &&
+		(scan->rs_base.rs_flags & SO_TYPE_ANALYZE) == 0)
+	{
+		AppendOnlyStorageRead_SkipCurrentBlock(&scan->storageRead);
+		AppendOnlyExecutionReadBlock_FinishedScanBlock(&scan->executorReadBlock);
+
+		return false;
+	}
+
 	if (scan->blockDirectory)
 	{
 		AppendOnlyBlockDirectory_InsertEntry(
@@ -1340,7 +1410,9 @@ appendonlygettup(AppendOnlyScanDesc scan,
 			 */
 			AOTupleId  *aoTupleId = (AOTupleId *) &slot->tts_tid;
 
-			if (!isSnapshotAny && !AppendOnlyVisimap_IsVisible(&scan->visibilityMap, aoTupleId))
+			if (!isSnapshotAny && !scan->blockAllVisible &&
+				!scan->blockVisible[AOTupleIdGet_rowNum(aoTupleId) -
+									scan->executorReadBlock.blockFirstRowNum])
 			{
 				/*
 				 * The tuple is invisible.
@@ -1691,6 +1763,32 @@ appendonly_beginscan(Relation relation,
 	return (TableScanDesc) aoscan;
 }
 
+/* ----------------
+ *		appendonly_beginscan_extractcolumns - begin relation scan, with the
+ *		quals of the scan for the zone maps
+ * ----------------
+ */
+TableScanDesc
+appendonly_beginscan_extractcolumns(Relation rel,
+									Snapshot snapshot,
+									List *targetlist,
+									List *qual,
+									uint32 flags)
+{
+	AppendOnlyScanDesc aoscan;
+
+	aoscan = (AppendOnlyScanDesc) appendonly_beginscan(rel, snapshot,
+													   0, NULL,
+													   NULL, flags);
+
+	aoscan->zonemap = AppendOnlyZoneMap_Begin(rel,
+											  aoscan->appendOnlyMetaDataSnapshot,
+											  qual,
+											  false /* isAOCol */);
+
+	return (TableScanDesc) aoscan;
+}
+
 /* ----------------
  *		appendonly_rescan		- restart a relation scan
  *
@@ -1767,6 +1865,12 @@ appendonly_endscan(TableScanDesc scan)
 		aoscan->aofetch = NULL;
 	}
 
+	if (aoscan->zonemap)
+		AppendOnlyZoneMap_End(aoscan->zonemap);
+
+	if (aoscan->blockVisible)
+		pfree(aoscan->blockVisible);
+
 	pfree(aoscan->aos_filenamepath);
 
 	pfree(aoscan->title);
@@ -2774,6 +2878,14 @@ aoInsertDesc->appendOnlyMetaDataSnapshot, //CONCERN:Safe to assume all block dir
 											aoInsertDesc->fsInfo, aoInsertDesc->lastSequence,
 											rel, segno, 1, false);
 
+	if (aoInsertDesc->blockDirectory.zonemapColumns != NULL)
+	{
+		aoInsertDesc->zonemapValues =
+			(Datum *) palloc(sizeof(Datum) * RelationGetNumberOfAttributes(rel));
+		aoInsertDesc->zonemapIsnull =
+			(bool *) palloc(sizeof(bool) * RelationGetNumberOfAttributes(rel));
+	}
+
 	return aoInsertDesc;
 }
 
@@ -2973,6 +3085,22 @@ appendonly_insert(AppendOnlyInsertDesc aoInsertDesc,
 		setupNextWriteBlock(aoInsertDesc);
 	}
 
+	/*
+	 * Summarize the row in the zone maps. The entry of the block the row went
+	 * into, which is inserted when the block is finished, covers it; a large
+	 * row has no entry of its own, and is covered by the entry of the next
+	 * block instead, which starts at its row number.
+	 */
+	if (aoInsertDesc->zonemapValues != NULL)
+	{
+		memtuple_deform(instup, aoInsertDesc->mt_bind,
+						aoInsertDesc->zonemapValues,
+						aoInsertDesc->zonemapIsnull);
+		AppendOnlyBlockDirectory_AddZoneMapValues(&aoInsertDesc->blockDirectory, 0,
+												  aoInsertDesc->zonemapValues,
+												  aoInsertDesc->zonemapIsnull);
+	}
+
 	aoInsertDesc->insertCount++;
 	aoInsertDesc->lastSequence++;
 	if (aoInsertDesc->numSequences > 0)
@@ -3041,6 +3169,12 @@ appendonly_insert_finish(AppendOnlyInsertDesc aoInsertDesc)
 
 	destroy_memtuple_binding(aoInsertDesc->mt_bind);
 
+	if (aoInsertDesc->zonemapValues != NULL)
+	{
+		pfree(aoInsertDesc->zonemapValues);
+		pfree(aoInsertDesc->zonemapIsnull);
+	}
+
 	pfree(aoInsertDesc->title);
 	pfree(aoInsertDesc);
 }
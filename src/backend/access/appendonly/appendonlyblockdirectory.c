@@ -36,6 +36,28 @@ minipage_size(uint32 nEntry)
 		sizeof(MinipageEntry) * nEntry;
 }
 
+/*
+ * Size of a minipage with zone map summaries of nColumns columns.
+ */
+static inline uint32
+zonemap_minipage_size(uint32 nEntry, int nColumns)
+{
+	return minipage_size(nEntry) + sizeof(int32) +
+		sizeof(AOZoneMapSummary) * nColumns * nEntry;
+}
+
+/*
+ * Maximum number of entries in the in-memory minipage of a column group.
+ */
+static inline uint32
+minipage_max_entries(MinipagePerColumnGroup *minipageInfo)
+{
+	if (minipageInfo->numZoneMapColumns > 0)
+		return minipageInfo->maxZoneMapEntries;
+
+	return gp_blockdirectory_minipage_size;
+}
+
 static void load_last_minipage(
 				   AppendOnlyBlockDirectory *blockDirectory,
 				   int64 lastSequence,
@@ -62,6 +84,12 @@ static bool insert_new_entry(AppendOnlyBlockDirectory *blockDirectory,
 				 int64 fileOffset,
 				 int64 rowCount,
 				 bool addColAction);
+static void init_zonemap(AppendOnlyBlockDirectory *blockDirectory,
+			 int columnGroupNo,
+			 MinipagePerColumnGroup *minipageInfo);
+static void fold_pending_summaries(AppendOnlyBlockDirectory *blockDirectory,
+					   int columnGroupNo,
+					   MinipagePerColumnGroup *minipageInfo);
 
 void
 AppendOnlyBlockDirectoryEntry_GetBeginRange(
@@ -95,10 +123,11 @@ AppendOnlyBlockDirectoryEntry_RangeHasRow(
 /*
  * init_internal
  *
- * Initialize the block directory structure.
+ * Initialize the block directory structure. If zonemaps is true, the values
+ * inserted are summarized in zone maps.
  */
 static void
-init_internal(AppendOnlyBlockDirectory *blockDirectory)
+init_internal(AppendOnlyBlockDirectory *blockDirectory, bool zonemaps)
 {
 	MemoryContext oldcxt;
 	int			numScanKeys;
@@ -136,6 +165,20 @@ init_internal(AppendOnlyBlockDirectory *blockDirectory)
 				  blockDirectory->scanKeys,
 				  blockDirectory->strategyNumbers);
 
+	if (zonemaps)
+	{
+		TupleDesc	tupdesc = RelationGetDescr(blockDirectory->aoRel);
+
+		blockDirectory->zonemapColumns =
+			palloc0(sizeof(AOZoneMapColumn) * tupdesc->natts);
+		if (!AppendOnlyZoneMap_InitColumns(tupdesc,
+										   blockDirectory->zonemapColumns))
+		{
+			pfree(blockDirectory->zonemapColumns);
+			blockDirectory->zonemapColumns = NULL;
+		}
+	}
+
 	/* Initialize the last minipage */
 	blockDirectory->minipages =
 		palloc0(sizeof(MinipagePerColumnGroup) * blockDirectory->numColumnGroups);
@@ -149,14 +192,76 @@ init_internal(AppendOnlyBlockDirectory *blockDirectory)
 		MinipagePerColumnGroup *minipageInfo =
 		&blockDirectory->minipages[groupNo];
 
+		init_zonemap(blockDirectory, groupNo, minipageInfo);
+
+		/* Leave room to write out the zone map after the entries. */
 		minipageInfo->minipage =
-			palloc0(minipage_size(NUM_MINIPAGE_ENTRIES));
+			palloc0(Max(minipage_size(NUM_MINIPAGE_ENTRIES),
+						zonemap_minipage_size(minipageInfo->maxZoneMapEntries,
+											  minipageInfo->numZoneMapColumns)));
 		minipageInfo->numMinipageEntries = 0;
 	}
 
 	MemoryContextSwitchTo(oldcxt);
 }
 
+/*
+ * init_zonemap
+ *
+ * Set up the zone map summaries of a column group, if the block directory
+ * maintains zone maps and any column of the group is summarized. Column
+ * groups too wide for a minipage with even one entry to fit are not
+ * summarized.
+ */
+static void
+init_zonemap(AppendOnlyBlockDirectory *blockDirectory,
+			 int columnGroupNo,
+			 MinipagePerColumnGroup *minipageInfo)
+{
+	int			nColumns;
+	int			firstColumn;
+	bool		tracked = false;
+	uint32		maxEntries;
+	int			i;
+
+	minipageInfo->numZoneMapColumns = 0;
+	minipageInfo->maxZoneMapEntries = 0;
+	minipageInfo->summaries = NULL;
+	minipageInfo->pendingSummaries = NULL;
+
+	if (blockDirectory->zonemapColumns == NULL)
+		return;
+
+	if (blockDirectory->isAOCol)
+	{
+		firstColumn = columnGroupNo;
+		nColumns = 1;
+	}
+	else
+	{
+		firstColumn = 0;
+		nColumns = RelationGetNumberOfAttributes(blockDirectory->aoRel);
+	}
+
+	for (i = 0; i < nColumns; i++)
+		tracked |= blockDirectory->zonemapColumns[firstColumn + i].tracked;
+	if (!tracked)
+		return;
+
+	maxEntries = (MAX_ZONEMAP_MINIPAGE_SIZE - zonemap_minipage_size(0, nColumns)) /
+		(sizeof(MinipageEntry) + sizeof(AOZoneMapSummary) * nColumns);
+	maxEntries = Min(maxEntries, (uint32) gp_blockdirectory_minipage_size);
+	if (maxEntries == 0)
+		return;
+
+	minipageInfo->numZoneMapColumns = nColumns;
+	minipageInfo->maxZoneMapEntries = maxEntries;
+	minipageInfo->summaries =
+		palloc0(sizeof(AOZoneMapSummary) * nColumns * maxEntries);
+	minipageInfo->pendingSummaries =
+		palloc0(sizeof(AOZoneMapSummary) * nColumns);
+}
+
 /*
  * AppendOnlyBlockDirectory_Init_forSearch
  *
@@ -181,6 +286,7 @@ AppendOnlyBlockDirectory_Init_forSearch(
 	Oid blkdiridxid;
 
 	blockDirectory->aoRel = aoRel;
+	blockDirectory->zonemapColumns = NULL;
 	GetAppendOnlyEntryAuxOids(aoRel->rd_id, NULL, NULL, &blkdirrelid, &blkdiridxid, NULL, NULL);
 
 	if (!OidIsValid(blkdirrelid))
@@ -217,7 +323,7 @@ AppendOnlyBlockDirectory_Init_forSearch(
 	blockDirectory->blkdirIdx =
 		index_open(blkdiridxid, AccessShareLock);
 
-	init_internal(blockDirectory);
+	init_internal(blockDirectory, false);
 }
 
 /*
@@ -246,6 +352,7 @@ AppendOnlyBlockDirectory_Init_forInsert(
 
 	blockDirectory->aoRel = aoRel;
 	blockDirectory->appendOnlyMetaDataSnapshot = appendOnlyMetaDataSnapshot;
+	blockDirectory->zonemapColumns = NULL;
 
 	GetAppendOnlyEntryAuxOids(aoRel->rd_id, NULL, NULL, &blkdirrelid, &blkdiridxid, NULL, NULL);
 
@@ -279,7 +386,7 @@ AppendOnlyBlockDirectory_Init_forInsert(
 
 	blockDirectory->indinfo = CatalogOpenIndexes(blockDirectory->blkdirRel);
 
-	init_internal(blockDirectory);
+	init_internal(blockDirectory, gp_appendonly_enable_zonemaps);
 
 	ereportif(Debug_appendonly_print_blockdirectory, LOG,
 			  (errmsg("Append-only block directory init for insert: "
@@ -315,6 +422,7 @@ AppendOnlyBlockDirectory_Init_addCol(
 
 	blockDirectory->aoRel = aoRel;
 	blockDirectory->appendOnlyMetaDataSnapshot = appendOnlyMetaDataSnapshot;
+	blockDirectory->zonemapColumns = NULL;
 
 	GetAppendOnlyEntryAuxOids(aoRel->rd_id, NULL, NULL, &blkdirrelid, &blkdiridxid, NULL, NULL);
 
@@ -355,7 +463,7 @@ AppendOnlyBlockDirectory_Init_addCol(
 
 	blockDirectory->indinfo = CatalogOpenIndexes(blockDirectory->blkdirRel);
 
-	init_internal(blockDirectory);
+	init_internal(blockDirectory, false);
 }
 
 static bool
@@ -749,7 +857,11 @@ insert_new_entry(
 
 		if (gp_blockdirectory_entry_min_range > 0 &&
 			fileOffset - entry->fileOffset < gp_blockdirectory_entry_min_range)
+		{
+			/* The latest entry now covers the new rows as well. */
+			fold_pending_summaries(blockDirectory, columnGroupNo, minipageInfo);
 			return true;
+		}
 
 		/* Update the rowCount in the latest entry */
 		Assert(entry->rowCount <= firstRowNum - entry->firstRowNum);
@@ -768,7 +880,7 @@ insert_new_entry(
 		entry->rowCount = firstRowNum - entry->firstRowNum;
 	}
 
-	if (minipageInfo->numMinipageEntries >= (uint32) gp_blockdirectory_minipage_size)
+	if (minipageInfo->numMinipageEntries >= minipage_max_entries(minipageInfo))
 	{
 		write_minipage(blockDirectory, columnGroupNo, minipageInfo);
 
@@ -780,16 +892,35 @@ insert_new_entry(
 		 */
 		MemSet(minipageInfo->minipage->entry, 0,
 			   minipageInfo->numMinipageEntries * sizeof(MinipageEntry));
+		if (minipageInfo->numZoneMapColumns > 0)
+			MemSet(minipageInfo->summaries, 0,
+				   sizeof(AOZoneMapSummary) * minipageInfo->numZoneMapColumns *
+				   minipageInfo->maxZoneMapEntries);
 		minipageInfo->numMinipageEntries = 0;
 	}
 
-	Assert(minipageInfo->numMinipageEntries < (uint32) gp_blockdirectory_minipage_size);
+	Assert(minipageInfo->numMinipageEntries < minipage_max_entries(minipageInfo));
 
 	entry = &(minipageInfo->minipage->entry[minipageInfo->numMinipageEntries]);
 	entry->firstRowNum = firstRowNum;
 	entry->fileOffset = fileOffset;
 	entry->rowCount = rowCount;
 
+	/*
+	 * The values added since the latest entry was inserted are the values of
+	 * the rows of the new entry.
+	 */
+	if (minipageInfo->numZoneMapColumns > 0)
+	{
+		int			nColumns = minipageInfo->numZoneMapColumns;
+
+		memcpy(&minipageInfo->summaries[minipageInfo->numMinipageEntries * nColumns],
+			   minipageInfo->pendingSummaries,
+			   sizeof(AOZoneMapSummary) * nColumns);
+		MemSet(minipageInfo->pendingSummaries, 0,
+			   sizeof(AOZoneMapSummary) * nColumns);
+	}
+
 	minipageInfo->numMinipageEntries++;
 
 	ereportif(Debug_appendonly_print_blockdirectory, LOG,
@@ -802,6 +933,134 @@ insert_new_entry(
 	return true;
 }
 
+/*
+ * AppendOnlyBlockDirectory_AddZoneMapValues
+ *
+ * Summarize the values of a row in the zone map of the given column group.
+ * The values are attributed to the block directory entry inserted next;
+ * values is an array of the values of the columns of the column group.
+ *
+ * If the block directory does not maintain zone maps for the column group,
+ * this function simply returns.
+ */
+void
+AppendOnlyBlockDirectory_AddZoneMapValues(
+										  AppendOnlyBlockDirectory *blockDirectory,
+										  int columnGroupNo,
+										  Datum *values,
+										  bool *isnull)
+{
+	MinipagePerColumnGroup *minipageInfo;
+	AOZoneMapColumn *columns;
+	int			i;
+
+	if (blockDirectory->blkdirRel == NULL ||
+		blockDirectory->zonemapColumns == NULL)
+		return;
+
+	minipageInfo = &blockDirectory->minipages[columnGroupNo];
+	if (minipageInfo->numZoneMapColumns == 0)
+		return;
+
+	columns = blockDirectory->zonemapColumns;
+	if (blockDirectory->isAOCol)
+		columns += columnGroupNo;
+
+	for (i = 0; i < minipageInfo->numZoneMapColumns; i++)
+	{
+		if (columns[i].tracked)
+			AppendOnlyZoneMap_AddValue(&columns[i],
+									   &minipageInfo->pendingSummaries[i],
+									   values[i], isnull[i]);
+	}
+}
+
+/*
+ * Merge the pending zone map summaries of a column group into the summaries
+ * of its latest entry, and reset them.
+ *
+ * If there is no latest entry in memory, the rows of the pending values are
+ * not covered by any entry, and the values are simply forgotten.
+ */
+static void
+fold_pending_summaries(AppendOnlyBlockDirectory *blockDirectory,
+					   int columnGroupNo,
+					   MinipagePerColumnGroup *minipageInfo)
+{
+	int			nColumns = minipageInfo->numZoneMapColumns;
+	uint32		lastEntryNo;
+	AOZoneMapColumn *columns;
+	int			i;
+
+	if (nColumns == 0)
+		return;
+
+	lastEntryNo = minipageInfo->numMinipageEntries - 1;
+	if (minipageInfo->numMinipageEntries > 0 &&
+		lastEntryNo < minipageInfo->maxZoneMapEntries)
+	{
+		columns = blockDirectory->zonemapColumns;
+		if (blockDirectory->isAOCol)
+			columns += columnGroupNo;
+
+		for (i = 0; i < nColumns; i++)
+			AppendOnlyZoneMap_Merge(&columns[i],
+									&minipageInfo->summaries[lastEntryNo * nColumns + i],
+									&minipageInfo->pendingSummaries[i]);
+	}
+
+	MemSet(minipageInfo->pendingSummaries, 0,
+		   sizeof(AOZoneMapSummary) * nColumns);
+}
+
+/*
+ * AppendOnlyBlockDirectory_MinipageZoneMapColumns
+ *
+ * Number of columns the given minipage carries zone map summaries for, or 0
+ * if it carries none.
+ */
+int
+AppendOnlyBlockDirectory_MinipageZoneMapColumns(Minipage *minipage)
+{
+	int32		nColumns;
+
+	if (minipage->version != MINIPAGE_VERSION_ZONEMAP ||
+		VARSIZE(minipage) < zonemap_minipage_size(minipage->nEntry, 0))
+		return 0;
+
+	memcpy(&nColumns, ((char *) minipage) + minipage_size(minipage->nEntry),
+		   sizeof(int32));
+	Assert(VARSIZE(minipage) == zonemap_minipage_size(minipage->nEntry,
+													  nColumns));
+
+	return nColumns;
+}
+
+/*
+ * AppendOnlyBlockDirectory_MinipageZoneMapSummary
+ *
+ * Copy out the zone map summary of a column of an entry of the given
+ * minipage, which must carry zone map summaries. The summaries may not be
+ * aligned in a minipage read from the block directory relation.
+ */
+void
+AppendOnlyBlockDirectory_MinipageZoneMapSummary(Minipage *minipage,
+												int entryNo,
+												int columnNo,
+												AOZoneMapSummary *summary)
+{
+	int			nColumns = AppendOnlyBlockDirectory_MinipageZoneMapColumns(minipage);
+	char	   *summaries;
+
+	Assert(entryNo >= 0 && (uint32) entryNo < minipage->nEntry);
+	Assert(columnNo >= 0 && columnNo < nColumns);
+
+	summaries = ((char *) minipage) + zonemap_minipage_size(minipage->nEntry, 0);
+	memcpy(summary,
+		   summaries + sizeof(AOZoneMapSummary) * (entryNo * nColumns + columnNo),
+		   sizeof(AOZoneMapSummary));
+}
+
 /*
  * AppendOnlyBlockDirectory_DeleteSegmentFile
  *
@@ -930,20 +1189,54 @@ copy_out_minipage(MinipagePerColumnGroup *minipageInfo,
 {
 	struct varlena *value;
 	struct varlena *detoast_value;
+	Minipage   *minipage;
 
 	Assert(!minipage_isnull);
 
 	value = (struct varlena *)
 		DatumGetPointer(minipage_value);
 	detoast_value = pg_detoast_datum(value);
-	Assert(VARSIZE(detoast_value) <= minipage_size(NUM_MINIPAGE_ENTRIES));
+	minipage = (Minipage *) detoast_value;
+
+	Assert(minipage->nEntry <= NUM_MINIPAGE_ENTRIES);
+	Assert(VARSIZE(detoast_value) >= minipage_size(minipage->nEntry));
+
+	/* The zone map summaries, if any, are kept apart from the entries. */
+	memcpy(minipageInfo->minipage, detoast_value,
+		   minipage_size(minipage->nEntry));
+	SET_VARSIZE(minipageInfo->minipage, minipage_size(minipage->nEntry));
+
+	if (minipageInfo->numZoneMapColumns > 0)
+	{
+		int			nColumns = minipageInfo->numZoneMapColumns;
+		uint32		entryNo;
+		int			i;
+
+		MemSet(minipageInfo->summaries, 0,
+			   sizeof(AOZoneMapSummary) * nColumns *
+			   minipageInfo->maxZoneMapEntries);
+
+		/*
+		 * Summaries of columns added since the minipage was written are not
+		 * known; leave all of them invalid then.
+		 */
+		if (AppendOnlyBlockDirectory_MinipageZoneMapColumns(minipage) == nColumns)
+		{
+			for (entryNo = 0;
+				 entryNo < Min(minipage->nEntry, minipageInfo->maxZoneMapEntries);
+				 entryNo++)
+			{
+				for (i = 0; i < nColumns; i++)
+					AppendOnlyBlockDirectory_MinipageZoneMapSummary(minipage,
+																	entryNo, i,
+																	&minipageInfo->summaries[entryNo * nColumns + i]);
+			}
+		}
+	}
 
-	memcpy(minipageInfo->minipage, detoast_value, VARSIZE(detoast_value));
 	if (detoast_value != value)
 		pfree(detoast_value);
 
-	Assert(minipageInfo->minipage->nEntry <= NUM_MINIPAGE_ENTRIES);
-
 	minipageInfo->numMinipageEntries = minipageInfo->minipage->nEntry;
 }
 
@@ -1180,9 +1473,32 @@ write_minipage(AppendOnlyBlockDirectory *blockDirectory,
 		Int64GetDatum(minipageInfo->minipage->entry[0].firstRowNum);
 	nulls[Anum_pg_aoblkdir_firstrownum - 1] = false;
 
-	SET_VARSIZE(minipageInfo->minipage,
-				minipage_size(minipageInfo->numMinipageEntries));
 	minipageInfo->minipage->nEntry = minipageInfo->numMinipageEntries;
+	if (minipageInfo->numZoneMapColumns > 0 &&
+		minipageInfo->numMinipageEntries <= minipageInfo->maxZoneMapEntries)
+	{
+		int32		nColumns = minipageInfo->numZoneMapColumns;
+		char	   *zonemap;
+
+		/* Write out the zone map summaries after the entries. */
+		zonemap = ((char *) minipageInfo->minipage) +
+			minipage_size(minipageInfo->numMinipageEntries);
+		memcpy(zonemap, &nColumns, sizeof(int32));
+		memcpy(zonemap + sizeof(int32), minipageInfo->summaries,
+			   sizeof(AOZoneMapSummary) * nColumns *
+			   minipageInfo->numMinipageEntries);
+
+		minipageInfo->minipage->version = MINIPAGE_VERSION_ZONEMAP;
+		SET_VARSIZE(minipageInfo->minipage,
+					zonemap_minipage_size(minipageInfo->numMinipageEntries,
+										  nColumns));
+	}
+	else
+	{
+		minipageInfo->minipage->version = MINIPAGE_VERSION_ORIGINAL;
+		SET_VARSIZE(minipageInfo->minipage,
+					minipage_size(minipageInfo->numMinipageEntries));
+	}
 	values[Anum_pg_aoblkdir_minipage - 1] =
 		PointerGetDatum(minipageInfo->minipage);
 	nulls[Anum_pg_aoblkdir_minipage - 1] = false;
@@ -70,6 +70,91 @@ test__AppendOnlyVisimapEntry_CoversTuple(void **state)
 	assert_true(result);
 }
 
+static AppendOnlyVisimapEntry *
+make_visimap_entry(void)
+{
+	AppendOnlyVisimapEntry *visiMapEntry = palloc0(sizeof(AppendOnlyVisimapEntry));
+
+	visiMapEntry->memoryContext = CurrentMemoryContext;
+	visiMapEntry->data = palloc0(APPENDONLY_VISIMAP_DATA_BUFFER_SIZE);
+	visiMapEntry->segmentFileNum = 1;
+	visiMapEntry->firstRowNum = 0;
+
+	return visiMapEntry;
+}
+
+/*
+ * Write the bitmap as a roaring container and read it back.
+ */
+static void
+check_roaring_round_trip(Bitmapset *bitmap, int expectedContainerType)
+{
+	AppendOnlyVisimapEntry *visiMapEntry = make_visimap_entry();
+	int			containerType;
+	int			size;
+
+	size = AppendOnlyVisimapEntry_RoaringSize(bitmap, &containerType);
+	assert_int_equal(containerType, expectedContainerType);
+	assert_int_equal(AppendOnlyVisimapEntry_RoaringCompress(bitmap, containerType,
+															visiMapEntry->data->data),
+					 size);
+
+	AppendOnlyVisimapEntry_RoaringDecompress(visiMapEntry, size);
+	assert_true(bms_equal(visiMapEntry->bitmap, bitmap));
+}
+
+static void
+test__AppendOnlyVisimapEntry_Roaring(void **state)
+{
+	Bitmapset  *bitmap = NULL;
+
+	/* A few scattered hidden rows are stored as an array */
+	bitmap = bms_add_member(bitmap, 0);
+	bitmap = bms_add_member(bitmap, 63);
+	bitmap = bms_add_member(bitmap, 64);
+	bitmap = bms_add_member(bitmap, 1000);
+	bitmap = bms_add_member(bitmap, APPENDONLY_VISIMAP_MAX_RANGE - 1);
+	check_roaring_round_trip(bitmap, APPENDONLY_VISIMAP_ROARING_ARRAY);
+
+	/* Long runs of hidden rows are stored as runs */
+	for (int i = 100; i < 5000; i++)
+		bitmap = bms_add_member(bitmap, i);
+	for (int i = 7000; i < 7130; i++)
+		bitmap = bms_add_member(bitmap, i);
+	check_roaring_round_trip(bitmap, APPENDONLY_VISIMAP_ROARING_RUN);
+
+	/* An empty bitmap reads back as NULL */
+	check_roaring_round_trip(NULL, APPENDONLY_VISIMAP_ROARING_ARRAY);
+}
+
+static void
+test__AppendOnlyVisimapEntry_GetVisibility(void **state)
+{
+	AppendOnlyVisimapEntry *visiMapEntry = make_visimap_entry();
+	bool		visible[200];
+
+	/* All rows are visible */
+	assert_int_equal(AppendOnlyVisimapEntry_GetVisibility(visiMapEntry, 10, 200,
+														  visible), 200);
+	for (int i = 0; i < 200; i++)
+		assert_true(visible[i]);
+
+	/* Rows 64 to 69 and 150 are hidden */
+	for (int i = 64; i < 70; i++)
+		visiMapEntry->bitmap = bms_add_member(visiMapEntry->bitmap, i);
+	visiMapEntry->bitmap = bms_add_member(visiMapEntry->bitmap, 150);
+
+	assert_int_equal(AppendOnlyVisimapEntry_GetVisibility(visiMapEntry, 10, 200,
+														  visible), 193);
+	for (int i = 0; i < 200; i++)
+	{
+		AOTupleId	tupleId;
+
+		AOTupleIdInit(&tupleId, 1, 10 + i);
+		assert_int_equal(visible[i],
+						 AppendOnlyVisimapEntry_IsVisible(visiMapEntry, &tupleId));
+	}
+}
 
 int
 main(int argc, char *argv[])
@@ -78,7 +163,9 @@ main(int argc, char *argv[])
 
 	const		UnitTest tests[] = {
 		unit_test(test__AppendOnlyVisimapEntry_GetFirstRowNum),
-		unit_test(test__AppendOnlyVisimapEntry_CoversTuple)
+		unit_test(test__AppendOnlyVisimapEntry_CoversTuple),
+		unit_test(test__AppendOnlyVisimapEntry_Roaring),
+		unit_test(test__AppendOnlyVisimapEntry_GetVisibility)
 	};
 
 	MemoryContextInit();
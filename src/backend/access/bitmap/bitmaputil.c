@@ -25,10 +25,14 @@
 #include "access/reloptions.h"
 #include "access/relscan.h"
 #include "miscadmin.h"
+#include "port/pg_bitutils.h"
 #include "storage/bufmgr.h"
 
 static void _bitmap_findnextword(BMBatchWords* words, uint64 nextReadNo);
+static uint64 _bitmap_literal_run(BMBatchWords *words, uint64 limit);
+#ifdef NOT_USED
 static void _bitmap_resetWord(BMBatchWords *words, uint32 prevStartNo);
+#endif
 static uint8 _bitmap_find_bitset(BM_HRL_WORD word, uint8 lastPos);
 
 /*
@@ -582,110 +586,114 @@ _bitmap_intersect(BMBatchWords **batches, uint32 numBatches,
 #endif /* NOT_USED */
 
 /*
- * Fast forward to the next read position by skipping the common compressed
- * zeros that appear in all batches. These skipped zeros are also copied into
- * the result words.
+ * _bitmap_literal_run() -- count the literal words at the read position
+ *	of 'words', up to 'limit'.
+ *
+ * A literal word has its header bit unset, so the header words are
+ * scanned BM_HRL_WORD_SIZE words at a time.
  */
 static uint64
-fast_forward(uint32 nbatches, BMBatchWords **batches, BMBatchWords *result)
+_bitmap_literal_run(BMBatchWords *words, uint64 limit)
 {
-	int i;
-	uint64 min_fill_len = MAX_FILL_LENGTH;
-	uint64 fast_forward_words = 0;
+	uint64		wordNo = words->startNo;
+	uint64		run = 0;
 
-	Assert(result != NULL);
-	Assert(nbatches == 0 || batches != NULL);
+	limit = Min(limit, words->nwords);
 
-	for (i = 0; i < nbatches; i++)
+	while (run < limit)
 	{
-		BM_HRL_WORD word;
-
-		/*
-		 * Fast forward the read batch from a rearrage bitmap index page.
-		 * Since words->nwordsread may get set to a new value in read_words().
-		 * See bitmapsearch.c read_words for more details.
-		 */
-		_bitmap_findnextword(batches[i], batches[i]->nextread);
+		uint32		bitNo = wordNo % BM_HRL_WORD_SIZE;
+		BM_HRL_WORD	header = words->hwords[wordNo / BM_HRL_WORD_SIZE] << bitNo;
 
-		word = batches[i]->cwords[batches[i]->startNo];
-
-		/* if we find a matching tid in one of the batches, nothing to do */
-		if (CUR_WORD_IS_FILL(batches[i]) && GET_FILL_BIT(word) == 1)
-			return batches[0]->nextread;
-		else if (!CUR_WORD_IS_FILL(batches[i]))
-			return batches[0]->nextread;
-		else if (CUR_WORD_IS_FILL(batches[i]) && GET_FILL_BIT(word) == 0)
+		if (header != 0)
 		{
-			uint64 fill_len = FILL_LENGTH(word);
-
-			/* adjust down */
-			if (fill_len < min_fill_len)
-			{
-				min_fill_len = fill_len;
-				fast_forward_words = fill_len;
-			}
+			run += BM_HRL_WORD_LEFTMOST - pg_leftmost_one_pos64(header);
+			break;
 		}
+		run += BM_HRL_WORD_SIZE - bitNo;
+		wordNo += BM_HRL_WORD_SIZE - bitNo;
 	}
-	if (fast_forward_words)
+
+	return Min(run, limit);
+}
+
+/*
+ * _bitmap_append_fill() -- append a fill word to the result of a union.
+ *
+ * If the last word appended since 'firstNo' is a fill word of the same
+ * kind, extend it instead.
+ */
+static void
+_bitmap_append_fill(BMBatchWords *result, uint32 firstNo,
+					BM_HRL_WORD fillBit, uint64 length)
+{
+	if (result->nwords > firstNo &&
+		IS_FILL_WORD(result->hwords, result->nwords - 1))
 	{
-		uint32 offset;
-		
-		for (i = 0; i < nbatches; i++)
-			batches[i]->nextread = batches[i]->nwordsread + 
-				fast_forward_words + 1;
+		BM_HRL_WORD	last = result->cwords[result->nwords - 1];
 
-		/*
-		 * Copy these fast-forwarded words to
-		 * the result.
-		 */
-		offset = result->nwords/BM_HRL_WORD_SIZE;
-		result->hwords[offset] |= WORDNO_GET_HEADER_BIT(result->nwords);
-		result->cwords[result->nwords] = fast_forward_words;
-		result->nwords++;
+		if (GET_FILL_BIT(last) == fillBit &&
+			FILL_LENGTH(last) + length <= MAX_FILL_LENGTH)
+		{
+			result->cwords[result->nwords - 1] += length;
+			return;
+		}
 	}
 
-	return batches[0]->nextread;
+	result->hwords[result->nwords / BM_HRL_WORD_SIZE] |=
+		WORDNO_GET_HEADER_BIT(result->nwords);
+	result->cwords[result->nwords] = BM_MAKE_FILL_WORD(fillBit, length);
+	result->nwords++;
 }
 
 /*
  * _bitmap_union() -- union 'numBatches' bitmaps
  *
  * All bitmap words are HRL compressed. The result bitmap words are also
- * HRL compressed, except that fill unset words may be lossily compressed.
+ * HRL compressed.
+ *
+ * The batches are merged one run at a time rather than one word at a time.
+ * A run is the longest span of uncompressed words over which every batch
+ * is either inside a single fill word or inside a sequence of literal
+ * words. A run covered by a fill-one word in any batch becomes a single
+ * fill-one word, and a run that is fill-zero in all batches a single
+ * fill-zero word, without looking at the other batches' words. Otherwise
+ * the literal words of the batches are ORed together a whole run at a
+ * time, in a loop the compiler can vectorize.
  */
 void
 _bitmap_union(BMBatchWords **batches, uint32 numBatches, BMBatchWords *result)
 {
-	bool 		done = false;
-	uint32 	   *prevstarts;
+	uint32		firstNo = result->nwords;
 	uint64		nextReadNo;
-	uint64		batchNo;
+	uint32		batchNo;
 
 	Assert ((int)numBatches >= 0);
 
 	if (numBatches == 0)
 		return;
 
-	/* save batch->startNo for each input bitmap vector */
-	prevstarts = (uint32 *)palloc0(numBatches * sizeof(uint32));
-
-	/* 
-	 * Compute the next read offset. We fast forward compressed
-	 * zero words when possible.
-	 */
-	nextReadNo = fast_forward(numBatches, batches, result);
+	nextReadNo = batches[0]->nextread;
 
-	while (!done &&	result->nwords < result->maxNumOfWords)
+	while (result->nwords < result->maxNumOfWords)
 	{
-		BM_HRL_WORD orWord = LITERAL_ALL_ZERO;
-		BM_HRL_WORD	word;
-		bool		orWordIsLiteral = true;
+		uint64		runLength = MAX_FILL_LENGTH;
+		uint64		fillOneLength = 0;
+		bool		allFillZero = true;
+		bool		done = false;
+		BM_HRL_WORD *orWords;
+		bool		first;
 
+		/*
+		 * Move every batch to 'nextReadNo', and find the length of the run
+		 * that starts there. We stop when some batch runs out of words, so
+		 * that the caller can read more words for it.
+		 */
 		for (batchNo = 0; batchNo < numBatches; batchNo++)
 		{
 			BMBatchWords *bch = batches[batchNo];
+			BM_HRL_WORD	word;
 
-			/* skip nextReadNo - nwordsread - 1 words */
 			_bitmap_findnextword(bch, nextReadNo);
 
 			if (bch->nwords == 0)
@@ -696,83 +704,79 @@ _bitmap_union(BMBatchWords **batches, uint32 numBatches, BMBatchWords *result)
 
 			Assert(bch->nwordsread == nextReadNo - 1);
 
-			/* Here, startNo should point to the word to be read. */
 			word = bch->cwords[bch->startNo];
 
-			if (CUR_WORD_IS_FILL(bch) && GET_FILL_BIT(word) == 1)
+			if (!CUR_WORD_IS_FILL(bch))
 			{
-				/* Fill word represents matches */
-				bch->nwordsread += FILL_LENGTH(word);
-				orWord = BM_MAKE_FILL_WORD(1, bch->nwordsread - nextReadNo + 1);
-				orWordIsLiteral = false;
-
-				nextReadNo = bch->nwordsread + 1;
-				bch->startNo++;
-				bch->nwords--;
-				break;
-			}
-			else if (CUR_WORD_IS_FILL(bch) && GET_FILL_BIT(word) == 0)
-			{
-				/* Fill word represents no matches */
-
-				bch->nwordsread++;
-				prevstarts[batchNo] = bch->startNo;
-				if (FILL_LENGTH(word) == 1)
-				{
-					bch->startNo++;
-					bch->nwords--;
-				}
-				else
-					bch->cwords[bch->startNo]--;
-				orWordIsLiteral = true;
-			}
-			else if (!CUR_WORD_IS_FILL(bch))
-			{
-				/* word is literal */
-				prevstarts[batchNo] = bch->startNo;
-				orWord |= word;
-				bch->nwordsread++;
-				bch->startNo++;
-				bch->nwords--;
-				orWordIsLiteral = true;
+				allFillZero = false;
+				runLength = _bitmap_literal_run(bch, runLength);
 			}
+			else if (GET_FILL_BIT(word) == 1)
+				fillOneLength = Max(fillOneLength, FILL_LENGTH(word));
+			else
+				runLength = Min(runLength, FILL_LENGTH(word));
 		}
 
 		if (done)
+			break;
+
+		if (fillOneLength > 0)
 		{
-			uint32 i;
+			/* Fill word represents matches, whatever the other batches say */
+			_bitmap_append_fill(result, firstNo, 1, fillOneLength);
+			nextReadNo += fillOneLength;
+			continue;
+		}
 
-			/* reset the attributes before batchNo */
-			for (i = 0; i < batchNo; i++)
-				_bitmap_resetWord(batches[i], prevstarts[i]);
-			break;
+		if (allFillZero)
+		{
+			/* No matches in any batch */
+			_bitmap_append_fill(result, firstNo, 0, runLength);
+			nextReadNo += runLength;
+			continue;
 		}
-		else
+
+		/*
+		 * OR the literal words of the run together. The batches that are in
+		 * a fill-zero word contribute nothing. The header bits of the result
+		 * words are already unset.
+		 */
+		runLength = Min(runLength, result->maxNumOfWords - result->nwords);
+		orWords = result->cwords + result->nwords;
+		first = true;
+
+		for (batchNo = 0; batchNo < numBatches; batchNo++)
 		{
-			if (!orWordIsLiteral)
+			BMBatchWords *bch = batches[batchNo];
+			BM_HRL_WORD *words = bch->cwords + bch->startNo;
+			uint64		i;
+
+			if (CUR_WORD_IS_FILL(bch))
+				continue;
+
+			if (first)
+				memcpy(orWords, words, runLength * sizeof(BM_HRL_WORD));
+			else
 			{
-				 /* Word is not literal, update the result header */
-				uint32 	offs = result->nwords/BM_HRL_WORD_SIZE;
-				uint32	n = result->nwords;
-				result->hwords[offs] |= WORDNO_GET_HEADER_BIT(n);
+				for (i = 0; i < runLength; i++)
+					orWords[i] |= words[i];
 			}
-			result->cwords[result->nwords] = orWord;
-			result->nwords++;
+			first = false;
 		}
 
-		if (orWordIsLiteral)
-			nextReadNo++;
-
-		/* we just processed the last batch and it was empty */
-		if (batchNo == numBatches - 1 && batches[batchNo]->nwords == 0)
-			done = true;
+		result->nwords += runLength;
+		nextReadNo += runLength;
 	}
 
-	/* set the next word to read for all input vectors */
+	/*
+	 * Set the next word to read for all input vectors, and skip the words
+	 * before it so that the caller sees which vectors have run out of words.
+	 */
 	for (batchNo = 0; batchNo < numBatches; batchNo++)
+	{
+		_bitmap_findnextword(batches[batchNo], nextReadNo);
 		batches[batchNo]->nextread = nextReadNo;
-
-	pfree(prevstarts);
+	}
 }
 
 /*
@@ -810,13 +814,18 @@ _bitmap_findnextword(BMBatchWords *words, uint64 nextReadNo)
 		}
 		else
 		{
-			words->nwordsread++;
-			words->startNo++;
-			words->nwords--;
+			/* skip the whole sequence of literal words at once */
+			uint64		run;
+
+			run = _bitmap_literal_run(words, nextReadNo - words->nwordsread - 1);
+			words->nwordsread += run;
+			words->startNo += run;
+			words->nwords -= run;
 		}
 	}
 }
 
+#ifdef NOT_USED
 /*
  * _bitmap_resetWord() -- Reset the read position in an BMBatchWords
  *       	              to its previous value.
@@ -842,6 +851,7 @@ _bitmap_resetWord(BMBatchWords *words, uint32 prevStartNo)
 	}
 	words->nwordsread--;
 }
+#endif /* NOT_USED */
 
 
 /*
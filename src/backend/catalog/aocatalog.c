@@ -31,6 +31,7 @@
 #include "miscadmin.h"
 #include "storage/lmgr.h"
 #include "utils/builtins.h"
+#include "utils/guc.h"
 #include "catalog/gp_fastsequence.h"
 
 /*
@@ -251,6 +252,11 @@ NewRelationCreateAOAuxTables(Oid relOid, bool createBlkDir)
 	AlterTableCreateAoSegTable(relOid);
 	AlterTableCreateAoVisimapTable(relOid);
 
-	if (createBlkDir)
+	/*
+	 * The zone maps are kept in the block directory, so create it even if
+	 * the table has no indexes. A binary upgrade recreates the auxiliary
+	 * tables exactly as they were in the old cluster.
+	 */
+	if (createBlkDir || (gp_appendonly_enable_zonemaps && !IsBinaryUpgrade))
 		AlterTableCreateAoBlkdirTable(relOid);
 }
@@ -23,6 +23,9 @@
 
 static void BufferedReadIo(
 			   BufferedRead *bufferedRead);
+static void BufferedReadPrefetch(
+					 BufferedRead *bufferedRead,
+					 int64 inEffectFileLen);
 static uint8 *BufferedReadUseBeforeBuffer(
 							BufferedRead *bufferedRead,
 							int32 maxReadAheadLen,
@@ -109,6 +112,16 @@ BufferedReadInit(
 	 */
 	bufferedRead->haveTemporaryLimitInEffect = false;
 	bufferedRead->temporaryLimitFileLen = 0;
+
+	/*
+	 * Read-ahead support for sequential reading.
+	 */
+#ifdef USE_PREFETCH
+	bufferedRead->prefetchDepth = gp_appendonly_prefetch_depth;
+#else
+	bufferedRead->prefetchDepth = 0;
+#endif
+	bufferedRead->prefetchPosition = 0;
 }
 
 /*
@@ -142,6 +155,7 @@ BufferedReadSetFile(
 	bufferedRead->haveTemporaryLimitInEffect = false;
 	bufferedRead->temporaryLimitFileLen = 0;
 	bufferedRead->fileOff =0;
+	bufferedRead->prefetchPosition = 0;
 
 	if (fileLen > 0)
 	{
@@ -153,6 +167,7 @@ BufferedReadSetFile(
 		else
 			bufferedRead->largeReadLen = (int32) fileLen;
 		BufferedReadIo(bufferedRead);
+		BufferedReadPrefetch(bufferedRead, fileLen);
 	}
 }
 
@@ -171,6 +186,11 @@ BufferedReadIo(
 	Assert(bufferedRead->largeReadLen > 0);
 	largeReadMemory = bufferedRead->largeReadMemory;
 
+	bufferedRead->largeReadCount++;
+	if (bufferedRead->largeReadPosition + largeReadLen <=
+		bufferedRead->prefetchPosition)
+		bufferedRead->prefetchedReadCount++;
+
 	offset = 0;
 	while (largeReadLen > 0)
 	{
@@ -224,6 +244,52 @@ BufferedReadIo(
 		VacuumCostBalance += VacuumCostPageMiss;
 }
 
+/*
+ * Request the large reads that follow the current one in advance.
+ *
+ * The kernel reads them asynchronously, so the i/o of the next large reads
+ * overlaps with the processing, e.g. decompression, of the blocks in the
+ * current one.  Only the part of the read-ahead window not yet requested is
+ * requested, so a sequential scan advises every part of the file once.
+ *
+ * This is only a hint; it does nothing where posix_fadvise() is not
+ * available, and errors are ignored.
+ */
+static void
+BufferedReadPrefetch(
+					 BufferedRead *bufferedRead,
+					 int64 inEffectFileLen)
+{
+	int64		beginPosition;
+	int64		afterPosition;
+
+	if (bufferedRead->prefetchDepth <= 0)
+		return;
+
+	/* Random reads through the block directory are not read ahead */
+	if (bufferedRead->haveTemporaryLimitInEffect)
+		return;
+
+	beginPosition = bufferedRead->largeReadPosition + bufferedRead->largeReadLen;
+	if (beginPosition < bufferedRead->prefetchPosition)
+		beginPosition = bufferedRead->prefetchPosition;
+
+	afterPosition = bufferedRead->largeReadPosition + bufferedRead->largeReadLen +
+		(int64) bufferedRead->prefetchDepth * bufferedRead->maxLargeReadLen;
+	if (afterPosition > inEffectFileLen)
+		afterPosition = inEffectFileLen;
+
+	if (afterPosition <= beginPosition)
+		return;
+
+	(void) FilePrefetch(bufferedRead->file,
+						beginPosition,
+						(int) (afterPosition - beginPosition),
+						WAIT_EVENT_DATA_FILE_PREFETCH);
+
+	bufferedRead->prefetchPosition = afterPosition;
+}
+
 static uint8 *
 BufferedReadUseBeforeBuffer(
 							BufferedRead *bufferedRead,
@@ -304,6 +370,7 @@ BufferedReadUseBeforeBuffer(
 	}
 
 	BufferedReadIo(bufferedRead);
+	BufferedReadPrefetch(bufferedRead, inEffectFileLen);
 
 	extraLen = maxReadAheadLen - beforeLen;
 	Assert(extraLen > 0);
@@ -407,6 +474,12 @@ BufferedReadSetTemporaryRange(
 		bufferedRead->fileOff = beginFileOffset;
 		bufferedRead->bufferOffset = 0;
 
+		/*
+		 * Random reads are not read ahead; forget what was requested for
+		 * the sequential reads before.
+		 */
+		bufferedRead->prefetchPosition = 0;
+
 		remainingFileLen = afterFileOffset - beginFileOffset;
 		if (remainingFileLen > bufferedRead->maxLargeReadLen)
 			bufferedRead->largeReadLen = bufferedRead->maxLargeReadLen;
@@ -520,6 +593,7 @@ BufferedReadGetNextBuffer(
 		}
 
 		BufferedReadIo(bufferedRead);
+		BufferedReadPrefetch(bufferedRead, inEffectFileLen);
 
 		if (maxReadAheadLen > bufferedRead->largeReadLen)
 			bufferedRead->bufferLen = bufferedRead->largeReadLen;
@@ -53,6 +53,9 @@ bool gp_use_legacy_hashops = false;
 /* local function declarations */
 static int	ispowof2(int numsegs);
 static inline int32 jump_consistent_hash(uint64 key, int32 num_segments);
+static CdbHashKernel cdbhash_kernel_for_func(Oid funcid);
+static void cdbhash_generic_batch(CdbHash *h, int attno, uint32 *hashes,
+								  Datum *datums, bool *isnulls, int n);
 
 /*================================================================
  *
@@ -94,6 +97,7 @@ makeCdbHash(int numsegs, int natts, Oid *hashfuncs)
 
 	/* Load hash function info */
 	h->hashfuncs = (FmgrInfo *) palloc(natts * sizeof(FmgrInfo));
+	h->kernels = (CdbHashKernel *) palloc(natts * sizeof(CdbHashKernel));
 	for (i = 0; i < natts; i++)
 	{
 		Oid			funcid = hashfuncs[i];
@@ -102,6 +106,7 @@ makeCdbHash(int numsegs, int natts, Oid *hashfuncs)
 			is_legacy_hash = true;
 
 		fmgr_info(funcid, &h->hashfuncs[i]);
+		h->kernels[i] = cdbhash_kernel_for_func(funcid);
 	}
 	h->natts = natts;
 	h->is_legacy_hash = is_legacy_hash;
@@ -270,6 +275,150 @@ cdbhashreduce(CdbHash *h)
 	return result;
 }
 
+/*
+ * Initialize the hash values of a batch of n tuples.
+ */
+void
+cdbhashinitbatch(CdbHash *h, uint32 *hashes, int n)
+{
+	uint32		init = h->is_legacy_hash ? FNV1_32_INIT : 0;
+
+	for (int i = 0; i < n; i++)
+		hashes[i] = init;
+}
+
+/*
+ * Add an attribute of a batch of n tuples to their hash values.
+ *
+ * This is the same as calling cdbhash() for each tuple, but the hash
+ * functions of common types are inlined, instead of being called through
+ * the function manager for each value.
+ */
+void
+cdbhashbatch(CdbHash *h, int attno, uint32 *hashes,
+			 Datum *datums, bool *isnulls, int n)
+{
+	int			i;
+
+	/*
+	 * The legacy hash functions depend on magic_hash_stash, so they are
+	 * always called one value at a time.
+	 */
+	if (h->is_legacy_hash)
+	{
+		for (i = 0; i < n; i++)
+		{
+			h->hash = hashes[i];
+			cdbhash(h, attno, datums[i], isnulls[i]);
+			hashes[i] = h->hash;
+		}
+		return;
+	}
+
+	/* rotate the hash values left 1 bit at each step, like cdbhash() */
+	for (i = 0; i < n; i++)
+		hashes[i] = (hashes[i] << 1) | ((hashes[i] & 0x80000000) ? 1 : 0);
+
+	/* and combine them with the hash of each non-NULL value */
+	switch (h->kernels[attno - 1])
+	{
+		case CDBHASH_KERNEL_INT2:
+			for (i = 0; i < n; i++)
+			{
+				if (!isnulls[i])
+					hashes[i] ^= DatumGetUInt32(hash_uint32((int32) DatumGetInt16(datums[i])));
+			}
+			break;
+
+		case CDBHASH_KERNEL_INT4:
+			for (i = 0; i < n; i++)
+			{
+				if (!isnulls[i])
+					hashes[i] ^= DatumGetUInt32(hash_uint32(DatumGetInt32(datums[i])));
+			}
+			break;
+
+		case CDBHASH_KERNEL_INT8:
+			/* same as hashint8() */
+			for (i = 0; i < n; i++)
+			{
+				int64		val;
+				uint32		lohalf;
+				uint32		hihalf;
+
+				if (isnulls[i])
+					continue;
+				val = DatumGetInt64(datums[i]);
+				lohalf = (uint32) val;
+				hihalf = (uint32) (val >> 32);
+				lohalf ^= (val >= 0) ? hihalf : ~hihalf;
+				hashes[i] ^= DatumGetUInt32(hash_uint32(lohalf));
+			}
+			break;
+
+		case CDBHASH_KERNEL_OID:
+			for (i = 0; i < n; i++)
+			{
+				if (!isnulls[i])
+					hashes[i] ^= DatumGetUInt32(hash_uint32((uint32) DatumGetObjectId(datums[i])));
+			}
+			break;
+
+		case CDBHASH_KERNEL_TEXT:
+
+			/*
+			 * Same as hashtext() with the default collation, which is
+			 * always deterministic.
+			 */
+			for (i = 0; i < n; i++)
+			{
+				text	   *key;
+
+				if (isnulls[i])
+					continue;
+				key = DatumGetTextPP(datums[i]);
+				hashes[i] ^= DatumGetUInt32(hash_any((unsigned char *) VARDATA_ANY(key),
+													 VARSIZE_ANY_EXHDR(key)));
+				if ((Pointer) key != DatumGetPointer(datums[i]))
+					pfree(key);
+			}
+			break;
+
+		case CDBHASH_KERNEL_GENERIC:
+			cdbhash_generic_batch(h, attno, hashes, datums, isnulls, n);
+			break;
+	}
+}
+
+/*
+ * Reduce the hash values of a batch of n tuples to segment numbers.
+ */
+void
+cdbhashreducebatch(CdbHash *h, uint32 *hashes, unsigned int *segs, int n)
+{
+	int			i;
+
+	Assert(h->natts > 0);
+
+	switch (h->reducealg)
+	{
+		case REDUCE_BITMASK:
+			for (i = 0; i < n; i++)
+				segs[i] = FASTMOD(hashes[i], (uint32) h->numsegs);
+			break;
+
+		case REDUCE_LAZYMOD:
+			for (i = 0; i < n; i++)
+				segs[i] = hashes[i] % h->numsegs;
+			break;
+
+		case REDUCE_JUMP_HASH:
+			for (i = 0; i < n; i++)
+				segs[i] = jump_consistent_hash(hashes[i], h->numsegs);
+			break;
+	}
+}
+
 /*
  * Return a random segment number, for randomly distributed policy.
  */
@@ -497,6 +646,65 @@ cdb_eqop_in_hash_opfamily(Oid opfamily, Oid typeoid)
  *================================================================
  */
 
+/*
+ * Return the kernel that computes the same hash values as the given hash
+ * function, for cdbhashbatch().
+ */
+static CdbHashKernel
+cdbhash_kernel_for_func(Oid funcid)
+{
+	switch (funcid)
+	{
+		case F_HASHINT2:
+			return CDBHASH_KERNEL_INT2;
+		case F_HASHINT4:
+			/* also used for date */
+			return CDBHASH_KERNEL_INT4;
+		case F_HASHINT8:
+			return CDBHASH_KERNEL_INT8;
+		case F_HASHOID:
+			return CDBHASH_KERNEL_OID;
+		case F_HASHTEXT:
+			/* also used for varchar */
+			return CDBHASH_KERNEL_TEXT;
+		default:
+			return CDBHASH_KERNEL_GENERIC;
+	}
+}
+
+/*
+ * Call the hash function of an attribute for each non-NULL value of a
+ * batch, and combine the results with the (rotated) hash values.  The call
+ * info is only set up once for the whole batch.
+ */
+static void
+cdbhash_generic_batch(CdbHash *h, int attno, uint32 *hashes,
+					  Datum *datums, bool *isnulls, int n)
+{
+	LOCAL_FCINFO(fcinfo, 1);
+
+	/* GPDB_12_MERGE_FIXME: always use default collation. Is that OK? */
+	InitFunctionCallInfoData(*fcinfo, &h->hashfuncs[attno - 1], 1,
+							 DEFAULT_COLLATION_OID,
+							 NULL, NULL);
+
+	for (int i = 0; i < n; i++)
+	{
+		if (isnulls[i])
+			continue;
+
+		fcinfo->args[0].value = datums[i];
+		fcinfo->args[0].isnull = false;
+		fcinfo->isnull = false;
+
+		hashes[i] ^= DatumGetUInt32(FunctionCallInvoke(fcinfo));
+
+		/* Check for null result, since caller is clearly not expecting one */
+		if (fcinfo->isnull)
+			elog(ERROR, "function %u returned NULL", fcinfo->flinfo->fn_oid);
+	}
+}
+
 /*
  * returns 1 is the input int is a power of 2 and 0 otherwise.
  */
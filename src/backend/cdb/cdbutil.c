@@ -70,6 +70,10 @@
 	Assert((cdbinfo)->arg >= 0); \
 	Assert((cdbinfo)->cdbs->arg >= 0); \
 
+/* count of idle QEs to keep when there are r more rounds to shrink */
+#define SHRINK_KEEP(n, r) \
+	(((n) * (r) + (r)) / ((r) + 1))
+
 #define GPSEGCONFIGDUMPFILE "gpsegconfig_dump"
 #define GPSEGCONFIGDUMPFILETMP "gpsegconfig_dump_tmp"
 #define GPSEGCONFIGNUMATTR 9 
@@ -81,7 +85,8 @@ static CdbComponentDatabases *cdb_component_dbs = NULL;
  * Helper Functions
  */
 static CdbComponentDatabases *getCdbComponentInfo(void);
-static void cleanupComponentIdleQEs(CdbComponentDatabaseInfo *cdi, bool includeWriter);
+static void cleanupComponentIdleQEs(CdbComponentDatabaseInfo *cdi, bool includeWriter,
+									int keep);
 
 static int	CdbComponentDatabaseInfoCompare(const void *p1, const void *p2);
 
@@ -558,15 +563,21 @@ getCdbComponentInfo(void)
 /*
  * Helper function to clean up the idle segdbs list of
  * a segment component.
+ *
+ * At most "keep" idle segdbs are kept, in the freelist order, so the writer
+ * is the last one to be destroyed and the readers are kept in the order they
+ * would be reused.
  */
 static void
-cleanupComponentIdleQEs(CdbComponentDatabaseInfo *cdi, bool includeWriter)
+cleanupComponentIdleQEs(CdbComponentDatabaseInfo *cdi, bool includeWriter,
+						int keep)
 {
 	SegmentDatabaseDescriptor	*segdbDesc;
 	MemoryContext				oldContext;
 	ListCell 					*curItem = NULL;
 	ListCell					*nextItem = NULL;
 	ListCell 					*prevItem = NULL;
+	int							kept = 0;
 
 	Assert(CdbComponentsContext);
 	oldContext = MemoryContextSwitchTo(CdbComponentsContext);
@@ -578,8 +589,9 @@ cleanupComponentIdleQEs(CdbComponentDatabaseInfo *cdi, bool includeWriter)
 		nextItem = lnext(curItem);
 		Assert(segdbDesc);
 
-		if (segdbDesc->isWriter && !includeWriter)
+		if ((segdbDesc->isWriter && !includeWriter) || kept < keep)
 		{
+			kept++;
 			prevItem = curItem;
 			curItem = nextItem;
 			continue;
@@ -599,6 +611,20 @@ cleanupComponentIdleQEs(CdbComponentDatabaseInfo *cdi, bool includeWriter)
 
 void
 cdbcomponent_cleanupIdleQEs(bool includeWriter)
+{
+	cdbcomponent_shrinkIdleQEs(includeWriter, 0);
+}
+
+/*
+ * Release a share of the idle QEs of every component.
+ *
+ * The share is chosen so that all the idle QEs are released after
+ * remainingRounds more calls, each call keeps ceil(n * r / (r + 1)) of the n
+ * idle QEs of a component.  When remainingRounds is 0 all of them are
+ * released, the same as cdbcomponent_cleanupIdleQEs().
+ */
+void
+cdbcomponent_shrinkIdleQEs(bool includeWriter, int remainingRounds)
 {
 	CdbComponentDatabases	*cdbs;
 	int						i;
@@ -614,7 +640,8 @@ cdbcomponent_cleanupIdleQEs(bool includeWriter)
 		for (i = 0; i < cdbs->total_segment_dbs; i++)
 		{
 			CdbComponentDatabaseInfo *cdi = &cdbs->segment_db_info[i];
-			cleanupComponentIdleQEs(cdi, includeWriter);
+			cleanupComponentIdleQEs(cdi, includeWriter,
+									SHRINK_KEEP(cdi->numIdleQEs, remainingRounds));
 		}
 	}
 
@@ -623,7 +650,8 @@ cdbcomponent_cleanupIdleQEs(bool includeWriter)
 		for (i = 0; i < cdbs->total_entry_dbs; i++)
 		{
 			CdbComponentDatabaseInfo *cdi = &cdbs->entry_db_info[i];
-			cleanupComponentIdleQEs(cdi, includeWriter);
+			cleanupComponentIdleQEs(cdi, includeWriter,
+									SHRINK_KEEP(cdi->numIdleQEs, remainingRounds));
 		}
 	}
 
@@ -220,6 +220,12 @@ bool		gp_interconnect_cache_future_packets = true;
  */
 char	   *gp_interconnect_proxy_addresses = NULL;
 
+/*
+ * Count of the ic-proxy I/O threads, the peer connections are spread over
+ * them; 0 means the peers are handled in the ic-proxy mainloop.
+ */
+int			gp_interconnect_proxy_io_threads = 0;
+
 int			Gp_udp_bufsize_k;	/* UPD recv buf size, in KB */
 
 #ifdef USE_ASSERT_CHECKING
@@ -263,6 +269,9 @@ int			gp_hashagg_groups_per_bucket = 5;
 /* Analyzing aid */
 int			gp_motion_slice_noop = 0;
 
+/* Max tuples per columnar Motion batch, 0 to send tuples one at a time */
+int			gp_motion_batch_size = 0;
+
 /* Greenplum Database Experimental Feature GUCs */
 bool		gp_enable_explain_allstat = false;
 bool		gp_enable_motion_deadlock_sanity = false;	/* planning time sanity
@@ -21,6 +21,8 @@
 #include "libpq-int.h"
 #include "cdb/cdbconn.h"
 #include "cdb/cdbgang.h"
+#include "cdb/cdbllize.h"
+#include "cdb/cdbplan.h"
 #include "cdb/cdbutil.h"
 #include "cdb/cdbvars.h"
 #include "cdb/cdbmutate.h"
@@ -59,6 +61,13 @@ typedef struct ParamWalkerContext
 	List	   *params;
 } ParamWalkerContext;
 
+typedef struct SlicePlanContext
+{
+	plan_tree_base_prefix base; /* Required prefix for
+								 * plan_tree_walker/mutator */
+	int			sliceIndex;
+} SlicePlanContext;
+
 /*
  * We need an array describing the relationship between a slice and
  * the number of "child" slices which depend on it.
@@ -106,7 +115,13 @@ static int fillSliceVector(SliceTable *sliceTable,
 static char *buildGpQueryString(DispatchCommandQueryParms *pQueryParms,
 				   int *finalLen);
 
-static DispatchCommandQueryParms *cdbdisp_buildPlanQueryParms(struct QueryDesc *queryDesc, bool planRequiresTxn);
+static DispatchCommandQueryParms *cdbdisp_buildPlanQueryParms(struct QueryDesc *queryDesc,
+															  bool planRequiresTxn,
+															  bool prunePlan);
+static void serializePlanForDispatch(DispatchCommandQueryParms *pQueryParms,
+									 PlannedStmt *stmt, int sliceIndex);
+static PlannedStmt *pruneSlicePlan(PlannedStmt *stmt, ExecSlice *slice);
+static Node *pruneSlicePlan_mutator(Node *node, SlicePlanContext *context);
 static DispatchCommandQueryParms *cdbdisp_buildUtilityQueryParms(struct Node *stmt, int flags, List *oid_assignments);
 static DispatchCommandQueryParms *cdbdisp_buildCommandQueryParms(const char *strCommand, int flags);
 
@@ -613,19 +628,19 @@ cdbdisp_buildUtilityQueryParms(struct Node *stmt,
 	return pQueryParms;
 }
 
+/*
+ * Build the parameters to dispatch a plan.
+ *
+ * If prunePlan is true, the plan is left out, and serializePlanForDispatch()
+ * fills it in for each slice before it is dispatched.
+ */
 static DispatchCommandQueryParms *
 cdbdisp_buildPlanQueryParms(struct QueryDesc *queryDesc,
-							bool planRequiresTxn)
+							bool planRequiresTxn,
+							bool prunePlan)
 {
-	char	   *splan,
-			   *sddesc;
-
-	int			splan_len,
-				splan_len_uncompressed,
-				sddesc_len,
-				rootIdx;
-
-	rootIdx = RootSliceIndex(queryDesc->estate);
+	char	   *sddesc;
+	int			sddesc_len;
 
 	DispatchCommandQueryParms *pQueryParms = (DispatchCommandQueryParms *) palloc0(sizeof(*pQueryParms));
 
@@ -634,12 +649,54 @@ cdbdisp_buildPlanQueryParms(struct QueryDesc *queryDesc,
 	 * (corresponding to an initPlan or the main plan), so the parameters are
 	 * fixed and we can include them in the prefix.
 	 */
-	splan = serializeNode((Node *) queryDesc->plannedstmt, &splan_len, &splan_len_uncompressed);
+	if (!prunePlan)
+		serializePlanForDispatch(pQueryParms, queryDesc->plannedstmt, -1);
+
+	sddesc = serializeNode((Node *) queryDesc->ddesc, &sddesc_len, NULL /* uncompressed_size */ );
+
+	pQueryParms->strCommand = queryDesc->sourceText;
+	pQueryParms->serializedQueryDispatchDesc = sddesc;
+	pQueryParms->serializedQueryDispatchDesclen = sddesc_len;
+
+	/*
+	 * Serialize a version of our snapshot, and generate our transction
+	 * isolations. We generally want Plan based dispatch to be in a global
+	 * transaction. The executor gets to decide if the special circumstances
+	 * exist which allow us to dispatch without starting a global xact.
+	 */
+	pQueryParms->serializedDtxContextInfo =
+		qdSerializeDtxContextInfo(&pQueryParms->serializedDtxContextInfolen,
+								  true /* wantSnapshot */ ,
+								  queryDesc->extended_query,
+								  mppTxnOptions(planRequiresTxn),
+								  "cdbdisp_buildPlanQueryParms");
+
+	return pQueryParms;
+}
+
+/*
+ * Serialize the plan to dispatch, or only the part of it that the given
+ * slice runs. sliceIndex -1 means the whole plan.
+ */
+static void
+serializePlanForDispatch(DispatchCommandQueryParms *pQueryParms,
+						 PlannedStmt *stmt, int sliceIndex)
+{
+	char	   *splan;
+	int			splan_len,
+				splan_len_uncompressed;
+
+	splan = serializeNode((Node *) stmt, &splan_len, &splan_len_uncompressed);
 
 	uint64		plan_size_in_kb = ((uint64) splan_len_uncompressed) / (uint64) 1024;
 
-	elog(((gp_log_gang >= GPVARS_VERBOSITY_TERSE) ? LOG : DEBUG1),
-		 "Query plan size to dispatch: " UINT64_FORMAT "KB", plan_size_in_kb);
+	if (sliceIndex < 0)
+		elog(((gp_log_gang >= GPVARS_VERBOSITY_TERSE) ? LOG : DEBUG1),
+			 "Query plan size to dispatch: " UINT64_FORMAT "KB", plan_size_in_kb);
+	else
+		elog(((gp_log_gang >= GPVARS_VERBOSITY_TERSE) ? LOG : DEBUG1),
+			 "Query plan size to dispatch (slice %d): " UINT64_FORMAT "KB",
+			 sliceIndex, plan_size_in_kb);
 
 	if (0 < gp_max_plan_size && plan_size_in_kb > gp_max_plan_size)
 	{
@@ -653,28 +710,101 @@ cdbdisp_buildPlanQueryParms(struct QueryDesc *queryDesc,
 
 	Assert(splan != NULL && splan_len > 0 && splan_len_uncompressed > 0);
 
-	sddesc = serializeNode((Node *) queryDesc->ddesc, &sddesc_len, NULL /* uncompressed_size */ );
-
-	pQueryParms->strCommand = queryDesc->sourceText;
 	pQueryParms->serializedPlantree = splan;
 	pQueryParms->serializedPlantreelen = splan_len;
-	pQueryParms->serializedQueryDispatchDesc = sddesc;
-	pQueryParms->serializedQueryDispatchDesclen = sddesc_len;
+}
+
+/*
+ * Make a copy of the plan that contains only what the QEs of a slice need.
+ *
+ * A QE that eliminates aliens initializes only the subtree under the
+ * sending Motion of its own slice, and the subplans that can be reached from
+ * it (see InitPlan()). So the subtree of the slice becomes the top of the
+ * plan, the Motions that receive from other slices are kept without their
+ * subtrees, and the subplans that are not needed are replaced with NULLs,
+ * like ExecSerializePlan() does for parallel workers. The copy is marked
+ * slicePruned, so that the QE eliminates aliens even if execute_pruned_plan
+ * is off.
+ *
+ * Returns NULL if the slice's part of the plan can't be found.
+ */
+static PlannedStmt *
+pruneSlicePlan(PlannedStmt *stmt, ExecSlice *slice)
+{
+	SlicePlanContext context;
+	PlannedStmt *newstmt;
+	Plan	   *root;
+	Bitmapset  *subplans;
+	ListCell   *lc;
+	int			subplan_id;
+
+	root = (Plan *) findSenderMotion(stmt, slice->sliceIndex);
+	if (root == NULL)
+	{
+		/* The root slice has no sending Motion, it starts at the top */
+		if (slice->sliceIndex != slice->rootIndex)
+			return NULL;
+		root = stmt->planTree;
+	}
+
+	exec_init_plan_tree_base(&context.base, stmt);
+	context.sliceIndex = slice->sliceIndex;
 
 	/*
-	 * Serialize a version of our snapshot, and generate our transction
-	 * isolations. We generally want Plan based dispatch to be in a global
-	 * transaction. The executor gets to decide if the special circumstances
-	 * exist which allow us to dispatch without starting a global xact.
+	 * Need to be careful not to modify the original plan, only the nodes
+	 * above the cut-off subtrees are copied.
 	 */
-	pQueryParms->serializedDtxContextInfo =
-		qdSerializeDtxContextInfo(&pQueryParms->serializedDtxContextInfolen,
-								  true /* wantSnapshot */ ,
-								  queryDesc->extended_query,
-								  mppTxnOptions(planRequiresTxn),
-								  "cdbdisp_buildPlanQueryParms");
+	newstmt = palloc(sizeof(PlannedStmt));
+	memcpy(newstmt, stmt, sizeof(PlannedStmt));
+	newstmt->planTree = (Plan *) pruneSlicePlan_mutator((Node *) root, &context);
+	newstmt->slicePruned = true;
+
+	subplans = getLocallyExecutableSubplans(stmt, root);
+	newstmt->subplans = NIL;
+	subplan_id = 1;
+	foreach(lc, stmt->subplans)
+	{
+		Plan	   *subplan = (Plan *) lfirst(lc);
 
-	return pQueryParms;
+		if (bms_is_member(subplan_id, subplans))
+			subplan = (Plan *) pruneSlicePlan_mutator((Node *) subplan, &context);
+		else
+			subplan = NULL;
+		newstmt->subplans = lappend(newstmt->subplans, subplan);
+
+		subplan_id++;
+	}
+
+	return newstmt;
+}
+
+static Node *
+pruneSlicePlan_mutator(Node *node, SlicePlanContext *context)
+{
+	if (node == NULL)
+		return NULL;
+
+	/* A Motion receiving from another slice: keep it, but not its subtree */
+	if (IsA(node, Motion) &&
+		((Motion *) node)->motionID != context->sliceIndex)
+	{
+		Motion	   *newmotion = makeNode(Motion);
+
+		memcpy(newmotion, node, sizeof(Motion));
+		newmotion->plan.lefttree = NULL;
+		newmotion->plan.righttree = NULL;
+
+		return (Node *) newmotion;
+	}
+
+	/*
+	 * Expressions refer to subplans by ID, they don't contain plan nodes, so
+	 * there is no need to copy them.
+	 */
+	if (!is_plan_node(node) && !IsA(node, List))
+		return node;
+
+	return plan_tree_mutator(node, pruneSlicePlan_mutator, context, false);
 }
 
 /*
@@ -1042,6 +1172,9 @@ cdbdisp_dispatchX(QueryDesc* queryDesc,
 	int			rootIdx;
 	char	   *queryText = NULL;
 	int			queryTextLength = 0;
+	char	   *wholePlanText = NULL;
+	int			wholePlanTextLength = 0;
+	bool		prunePlan;
 	struct SliceTable *sliceTbl;
 	struct EState *estate;
 	CdbDispatcherState *ds;
@@ -1080,8 +1213,15 @@ cdbdisp_dispatchX(QueryDesc* queryDesc,
 	/* Each slice table has a unique-id. */
 	sliceTbl->ic_instance_id = ++gp_interconnect_id;
 
-	pQueryParms = cdbdisp_buildPlanQueryParms(queryDesc, planRequiresTxn);
-	queryText = buildGpQueryString(pQueryParms, &queryTextLength);
+	/*
+	 * Send each slice only its own part of the plan. The QEs then prune the
+	 * plan whether or not execute_pruned_plan is set, see slicePruned.
+	 */
+	prunePlan = sliceTbl->hasMotions;
+
+	pQueryParms = cdbdisp_buildPlanQueryParms(queryDesc, planRequiresTxn, prunePlan);
+	if (!prunePlan)
+		queryText = buildGpQueryString(pQueryParms, &queryTextLength);
 
 	/*
 	 * Allocate result array with enough slots for QEs of primary gangs.
@@ -1157,6 +1297,38 @@ cdbdisp_dispatchX(QueryDesc* queryDesc,
 		}
 		SIMPLE_FAULT_INJECTOR("before_one_slice_dispatched");
 
+		if (prunePlan)
+		{
+			PlannedStmt *slicePlan = NULL;
+
+			/*
+			 * The entry db QEs don't prune the plan, as they run on the
+			 * master; they get the whole plan, serialized only once.
+			 */
+			if (primaryGang->type != GANGTYPE_ENTRYDB_READER)
+				slicePlan = pruneSlicePlan(queryDesc->plannedstmt, slice);
+
+			if (slicePlan != NULL)
+			{
+				serializePlanForDispatch(pQueryParms, slicePlan, si);
+				queryText = buildGpQueryString(pQueryParms, &queryTextLength);
+				pfree(pQueryParms->serializedPlantree);
+			}
+			else
+			{
+				if (wholePlanText == NULL)
+				{
+					serializePlanForDispatch(pQueryParms, queryDesc->plannedstmt, -1);
+					wholePlanText = buildGpQueryString(pQueryParms, &wholePlanTextLength);
+					pfree(pQueryParms->serializedPlantree);
+				}
+				queryText = wholePlanText;
+				queryTextLength = wholePlanTextLength;
+			}
+
+			cdbdisp_setDispatchQueryText(ds, queryText, queryTextLength);
+		}
+
 		cdbdisp_dispatchToGang(ds, primaryGang, si);
 		if (planRequiresTxn || isDtxExplicitBegin())
 			addToGxactDtxSegments(primaryGang);
@@ -673,6 +673,20 @@ DisconnectAndDestroyAllGangs(bool resetSession)
  * call only from an idle session.
  */
 void DisconnectAndDestroyUnusedQEs(void)
+{
+	ShrinkUnusedQEs(0);
+}
+
+/*
+ * Destroy a share of the idle QEs, so that all of them are destroyed after
+ * remainingRounds more calls, see cdbcomponent_shrinkIdleQEs().  The QEs are
+ * destroyed in the reverse order of reusing, so the QEs kept are the ones the
+ * next query would use, and the writer QEs are the last ones to go.
+ *
+ * call only from an idle session.
+ */
+void
+ShrinkUnusedQEs(int remainingRounds)
 {
 	if (IsTransactionOrTransactionBlock() || TempNamespaceOidIsValid())
 	{
@@ -685,7 +699,7 @@ void DisconnectAndDestroyUnusedQEs(void)
 		 *
 		 * Since we are idle, any reader gangs will be available but not allocated.
 		 */
-		cdbcomponent_cleanupIdleQEs(false);
+		cdbcomponent_shrinkIdleQEs(false, remainingRounds);
 	}
 	else
 	{
@@ -699,7 +713,7 @@ void DisconnectAndDestroyUnusedQEs(void)
 		 * in the log.
 		 *
 		 */
-		cdbcomponent_cleanupIdleQEs(true);
+		cdbcomponent_shrinkIdleQEs(true, remainingRounds);
 	}
 }
 
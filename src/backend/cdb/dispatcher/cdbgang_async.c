@@ -119,11 +119,16 @@ create_gang_retry:
 
 	PG_TRY();
 	{
+		/*
+		 * The GUC options are the same for all the QEs of the gang, build
+		 * them only once, and only if a new QE is needed.
+		 */
+		char	   *options = NULL;
+
 		for (i = 0; i < size; i++)
 		{
 			bool		ret;
 			char		gpqeid[100];
-			char	   *options;
 
 			/*
 			 * Create the connection requests.	If we find a segment without a
@@ -156,7 +161,8 @@ create_gang_retry:
 						(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
 						 errmsg("failed to construct connectionstring")));
 
-			options = makeOptions();
+			if (options == NULL)
+				options = makeOptions();
 
 			/* start connection in asynchronous way */
 			cdbconn_doConnectStart(segdbDesc, gpqeid, options);
@@ -73,11 +73,22 @@ static inline void reconstructTuple(MotionNodeEntry *pMNEntry, ChunkSorterEntry
 /* Stats-function declarations. */
 static void statSendTuple(MotionLayerState *mlStates, MotionNodeEntry *pMNEntry, TupleChunkList tcList);
 static void statSendEOS(MotionLayerState *mlStates, MotionNodeEntry *pMNEntry);
+static void statSendBatch(MotionLayerState *mlStates, MotionNodeEntry *pMNEntry, TupleChunkList tcList);
 static void statChunksProcessed(MotionLayerState *mlStates, MotionNodeEntry *pMNEntry, int chunksProcessed, int chunkBytes, int tupleBytes);
-static void statNewTupleArrived(MotionNodeEntry *pMNEntry, ChunkSorterEntry *pCSEntry);
+static void statNewTupleArrived(MotionNodeEntry *pMNEntry, ChunkSorterEntry *pCSEntry, int ntuples);
+static void statNewBatchArrived(MotionNodeEntry *pMNEntry, ChunkSorterEntry *pCSEntry, TupleBatchReader *batch);
 static void statRecvTuple(MotionNodeEntry *pMNEntry, ChunkSorterEntry *pCSEntry);
 static bool ShouldSendRecordCache(MotionConn *conn, SerTupInfo *pSerInfo);
 static void UpdateSentRecordCache(MotionConn *conn);
+static SendReturnCode addTupleToBatch(MotionLayerState *mlStates,
+									  ChunkTransportState *transportStates,
+									  MotionNodeEntry *pMNEntry,
+									  TupleTableSlot *slot,
+									  int16 targetRoute);
+static SendReturnCode sendTupleBatch(MotionLayerState *mlStates,
+									 ChunkTransportState *transportStates,
+									 MotionNodeEntry *pMNEntry,
+									 int builderIdx);
 
 
 
@@ -90,16 +101,31 @@ static inline void
 reconstructTuple(MotionNodeEntry *pMNEntry, ChunkSorterEntry *pCSEntry, TupleRemapper *remapper)
 {
 	MinimalTuple tup;
+	TupleBatchReader *batch;
 	SerTupInfo *pSerInfo = &pMNEntry->ser_tup_info;
 
 	/*
 	 * Convert the list of chunks into a tuple, then stow it away.
 	 */
-	tup = CvtChunksToTup(&pCSEntry->chunk_list, pSerInfo, remapper);
+	tup = CvtChunksToTup(&pCSEntry->chunk_list, pSerInfo, remapper, &batch);
 
 	/* We're done with the chunks now. */
 	clearTCList(NULL, &pCSEntry->chunk_list);
 
+	/*
+	 * A batch is stowed away as is; its tuples are formed as they are
+	 * received.  Batches are never sent for tuples with record types, so
+	 * there is nothing to remap.
+	 */
+	if (batch)
+	{
+		htfifo_addbatch(pCSEntry->ready_tuples, batch);
+
+		/* Stats */
+		statNewBatchArrived(pMNEntry, pCSEntry, batch);
+		return;
+	}
+
 	if (!tup)
 		return;
 
@@ -108,7 +134,7 @@ reconstructTuple(MotionNodeEntry *pMNEntry, ChunkSorterEntry *pCSEntry, TupleRem
 	htfifo_addtuple(pCSEntry->ready_tuples, tup);
 
 	/* Stats */
-	statNewTupleArrived(pMNEntry, pCSEntry);
+	statNewTupleArrived(pMNEntry, pCSEntry, 1);
 }
 
 /*
@@ -244,10 +270,15 @@ createMotionLayerState(int maxMotNodeID)
  * Initialize a single motion node.  This is called by the executor when a
  * motion node in the plan tree is being initialized.
  *
+ * If batchSize is > 0, the tuples sent by this motion node are collected
+ * into columnar batches of up to that many tuples per route.  The receiver
+ * handles batches whether or not it is set.
+ *
  * This function is called from:  ExecInitMotion()
  */
 void
-UpdateMotionLayerNode(MotionLayerState *mlStates, int16 motNodeID, bool preserveOrder, TupleDesc tupDesc)
+UpdateMotionLayerNode(MotionLayerState *mlStates, int16 motNodeID, bool preserveOrder, TupleDesc tupDesc,
+					  int batchSize)
 {
 	MemoryContext oldCtxt;
 	MotionNodeEntry *pEntry;
@@ -282,6 +313,14 @@ UpdateMotionLayerNode(MotionLayerState *mlStates, int16 motNodeID, bool preserve
 	else
 		pEntry->ready_tuples = NULL;
 
+	/*
+	 * The batch builders are created as tuples are sent.  Tuples with record
+	 * types are sent one at a time, since their typmods may need to be
+	 * remapped by the receiver.
+	 */
+	pEntry->batch_size = pEntry->ser_tup_info.has_record_types ? 0 : batchSize;
+	pEntry->num_batch_builders = 0;
+	pEntry->batch_builders = NULL;
 
 	pEntry->num_stream_ends_recvd = 0;
 
@@ -296,6 +335,9 @@ UpdateMotionLayerNode(MotionLayerState *mlStates, int16 motNodeID, bool preserve
 	pEntry->stat_total_chunks_recvd = 0;
 	pEntry->stat_total_bytes_recvd = 0;
 	pEntry->stat_tuple_bytes_recvd = 0;
+	pEntry->stat_batches_recvd = 0;
+	pEntry->stat_batch_bytes_recvd = 0;
+	pEntry->stat_batch_raw_bytes_recvd = 0;
 
 	pEntry->cleanedUp = false;
 	pEntry->stopped = false;
@@ -460,6 +502,9 @@ SendTuple(MotionLayerState *mlStates,
 	 */
 	pMNEntry = getMotionNodeEntry(mlStates, motNodeID);
 
+	if (pMNEntry->batch_size > 0)
+		return addTupleToBatch(mlStates, transportStates, pMNEntry, slot, targetRoute);
+
 #ifdef AMS_VERBOSE_LOGGING
 	elog(DEBUG5, "Serializing HeapTuple for sending.");
 #endif
@@ -521,6 +566,107 @@ SendTuple(MotionLayerState *mlStates,
 	return rc;
 }
 
+/*
+ * Add a tuple to the batch of its route, and send the batch if it is full.
+ */
+static SendReturnCode
+addTupleToBatch(MotionLayerState *mlStates,
+				ChunkTransportState *transportStates,
+				MotionNodeEntry *pMNEntry,
+				TupleTableSlot *slot,
+				int16 targetRoute)
+{
+	TupleBatchBuilder *builder;
+	MemoryContext oldCtxt;
+	int			builderIdx;
+
+	oldCtxt = MemoryContextSwitchTo(mlStates->motion_layer_mctx);
+
+	if (pMNEntry->batch_builders == NULL)
+	{
+		ChunkTransportStateEntry *pEntry = NULL;
+
+		getChunkTransportState(transportStates, pMNEntry->motion_node_id, &pEntry);
+
+		/* One builder per connection, and one for broadcast. */
+		pMNEntry->num_batch_builders = pEntry->numConns + 1;
+		pMNEntry->batch_builders =
+			palloc0(pMNEntry->num_batch_builders * sizeof(TupleBatchBuilder *));
+	}
+
+	if (targetRoute == BROADCAST_SEGIDX)
+		builderIdx = pMNEntry->num_batch_builders - 1;
+	else
+		builderIdx = targetRoute;
+	Assert(builderIdx >= 0 && builderIdx < pMNEntry->num_batch_builders);
+
+	builder = pMNEntry->batch_builders[builderIdx];
+	if (builder == NULL)
+	{
+		builder = TupleBatchCreateBuilder(&pMNEntry->ser_tup_info);
+		pMNEntry->batch_builders[builderIdx] = builder;
+	}
+
+	TupleBatchAddTuple(builder, slot);
+
+	MemoryContextSwitchTo(oldCtxt);
+
+	pMNEntry->stat_total_sends++;
+
+	if (TupleBatchNumTuples(builder) >= pMNEntry->batch_size ||
+		TupleBatchDataSize(builder) >= TUPLE_BATCH_MAX_BYTES)
+		return sendTupleBatch(mlStates, transportStates, pMNEntry, builderIdx);
+
+	return SEND_COMPLETE;
+}
+
+/*
+ * Send the tuples collected in a batch builder.
+ */
+static SendReturnCode
+sendTupleBatch(MotionLayerState *mlStates,
+			   ChunkTransportState *transportStates,
+			   MotionNodeEntry *pMNEntry,
+			   int builderIdx)
+{
+	TupleBatchBuilder *builder = pMNEntry->batch_builders[builderIdx];
+	TupleChunkListData tcList;
+	MemoryContext oldCtxt;
+	SendReturnCode rc;
+	int16		targetRoute;
+
+	if (builderIdx == pMNEntry->num_batch_builders - 1)
+		targetRoute = BROADCAST_SEGIDX;
+	else
+		targetRoute = builderIdx;
+
+	oldCtxt = MemoryContextSwitchTo(mlStates->motion_layer_mctx);
+
+	SerializeTupleBatch(builder, &pMNEntry->ser_tup_info, &tcList);
+
+	MemoryContextSwitchTo(oldCtxt);
+
+	/* do the send. */
+	if (!SendTupleChunkToAMS(mlStates, transportStates, pMNEntry->motion_node_id,
+							 targetRoute, tcList.p_first))
+	{
+		pMNEntry->stopped = true;
+		rc = STOP_SENDING;
+	}
+	else
+	{
+		/* update stats */
+		statSendBatch(mlStates, pMNEntry, &tcList);
+
+		rc = SEND_COMPLETE;
+	}
+
+	/* cleanup */
+	clearTCList(&pMNEntry->ser_tup_info.chunkCache, &tcList);
+
+	return rc;
+}
+
 TupleChunkListItem
 get_eos_tuplechunklist(void)
 {
@@ -545,6 +691,15 @@ SendEndOfStream(MotionLayerState *mlStates,
 	 */
 	pMNEntry = getMotionNodeEntry(mlStates, motNodeID);
 
+	/* Send the partial batches first. */
+	for (int i = 0; i < pMNEntry->num_batch_builders && !pMNEntry->stopped; i++)
+	{
+		TupleBatchBuilder *builder = pMNEntry->batch_builders[i];
+
+		if (builder && TupleBatchNumTuples(builder) > 0)
+			sendTupleBatch(mlStates, transportStates, pMNEntry, i);
+	}
+
 	transportStates->SendEos(transportStates, motNodeID, s_eos_chunk_data);
 
 	/*
@@ -851,6 +1006,26 @@ EndMotionLayerNode(MotionLayerState *mlStates, int16 motNodeID, bool flushCommLa
 	pMNEntry->valid = false;
 }
 
+void
+GetMotionBatchStats(MotionLayerState *mlStates, int16 motNodeID,
+					uint64 *batches, uint64 *bytes, uint64 *rawBytes)
+{
+	MotionNodeEntry *pMNEntry;
+
+	*batches = *bytes = *rawBytes = 0;
+
+	/* The motion node may have been cleaned up already. */
+	if (mlStates == NULL ||
+		motNodeID < 1 || motNodeID > mlStates->mneCount ||
+		!mlStates->mnEntries[motNodeID - 1].valid)
+		return;
+	pMNEntry = &mlStates->mnEntries[motNodeID - 1];
+
+	*batches = pMNEntry->stat_batches_recvd;
+	*bytes = pMNEntry->stat_batch_bytes_recvd;
+	*rawBytes = pMNEntry->stat_batch_raw_bytes_recvd;
+}
+
 /*
  * Helper function to get the motion node entry for a given ID.  NULL
  * is returned if the ID is unrecognized.
@@ -1174,6 +1349,33 @@ statSendTuple(MotionLayerState *mlStates, MotionNodeEntry *pMNEntry, TupleChunkL
 
 }
 
+/*
+ * Like statSendTuple(), but the tuples of the batch were already counted
+ * as they were added to it.
+ */
+static void
+statSendBatch(MotionLayerState *mlStates, MotionNodeEntry *pMNEntry, TupleChunkList tcList)
+{
+	int			headerOverhead;
+
+	AssertArg(pMNEntry != NULL);
+
+	headerOverhead = TUPLE_CHUNK_HEADER_SIZE * tcList->num_chunks;
+
+	/* per motion-node stats. */
+	pMNEntry->stat_total_chunks_sent += tcList->num_chunks;
+	pMNEntry->stat_total_bytes_sent += tcList->serialized_data_length + headerOverhead;
+	pMNEntry->stat_tuple_bytes_sent += tcList->serialized_data_length;
+
+	/* Update global motion-layer statistics. */
+	mlStates->stat_total_chunks_sent += tcList->num_chunks;
+
+	mlStates->stat_total_bytes_sent +=
+		tcList->serialized_data_length + headerOverhead;
+
+	mlStates->stat_tuple_bytes_sent += tcList->serialized_data_length;
+}
+
 static void
 statSendEOS(MotionLayerState *mlStates, MotionNodeEntry *pMNEntry)
 {
@@ -1208,7 +1410,7 @@ statChunksProcessed(MotionLayerState *mlStates, MotionNodeEntry *pMNEntry, int c
 }
 
 static void
-statNewTupleArrived(MotionNodeEntry *pMNEntry, ChunkSorterEntry *pCSEntry)
+statNewTupleArrived(MotionNodeEntry *pMNEntry, ChunkSorterEntry *pCSEntry, int ntuples)
 {
 	uint32		tupsAvail;
 
@@ -1222,7 +1424,7 @@ statNewTupleArrived(MotionNodeEntry *pMNEntry, ChunkSorterEntry *pCSEntry)
 	 * Also, if the motion node is order-preserving, we track a per-sender
 	 * high-watermark as well.
 	 */
-	tupsAvail = ++(pMNEntry->stat_tuples_available);
+	tupsAvail = (pMNEntry->stat_tuples_available += ntuples);
 	if (pMNEntry->stat_tuples_available_hwm < tupsAvail)
 	{
 		/* New high-watermark! */
@@ -1230,6 +1432,21 @@ statNewTupleArrived(MotionNodeEntry *pMNEntry, ChunkSorterEntry *pCSEntry)
 	}
 }
 
+static void
+statNewBatchArrived(MotionNodeEntry *pMNEntry, ChunkSorterEntry *pCSEntry, TupleBatchReader *batch)
+{
+	int			bytes;
+	int			rawBytes;
+
+	bytes = TupleBatchReaderDataSize(batch, &rawBytes);
+
+	pMNEntry->stat_batches_recvd++;
+	pMNEntry->stat_batch_bytes_recvd += bytes;
+	pMNEntry->stat_batch_raw_bytes_recvd += rawBytes;
+
+	statNewTupleArrived(pMNEntry, pCSEntry, TupleBatchReaderNumTuples(batch));
+}
+
 static void
 statRecvTuple(MotionNodeEntry *pMNEntry, ChunkSorterEntry *pCSEntry)
 {
@@ -20,6 +20,7 @@
 #include "cdb/htupfifo.h"
 
 static void htfifo_cleanup(htup_fifo htf);
+static void htfifo_addentry(htup_fifo htf, MinimalTuple tup, TupleBatchReader *batch);
 
 /*
  * Create and initialize a HeapTuple FIFO. The FIFO state is allocated
@@ -46,13 +47,20 @@ htfifo_create(void)
 static void
 htfifo_cleanup(htup_fifo htf)
 {
-	MinimalTuple tup;
-
 	AssertArg(htf != NULL);
 
-	/* TODO:  This can be faster if we didn't reuse code, but this will work. */
-	while ((tup = htfifo_gettuple(htf)) != NULL)
-		pfree(tup);
+	while (htf->p_first)
+	{
+		htf_entry	trash = htf->p_first;
+
+		htf->p_first = trash->p_next;
+
+		if (trash->batch)
+			TupleBatchFreeReader(trash->batch);
+		else
+			pfree(trash->tup);
+		pfree(trash);
+	}
 
 	while (htf->freelist)
 	{
@@ -97,14 +105,34 @@ htfifo_destroy(htup_fifo htf)
 void
 htfifo_addtuple(htup_fifo htf, MinimalTuple tup)
 {
-	htf_entry	p_ent;
-
-	AssertArg(htf != NULL);
 	AssertArg(tup != NULL);
 
 	/* Serialized tuple should never have external attribute */
 	Assert(!(tup->t_infomask & HEAP_HASEXTERNAL));
 
+	htfifo_addentry(htf, tup, NULL);
+}
+
+/*
+ * Append a batch of tuples to the end of a HeapTuple FIFO.  The FIFO takes
+ * ownership of the batch, and frees it once all of its tuples have been
+ * retrieved.
+ */
+void
+htfifo_addbatch(htup_fifo htf, TupleBatchReader *batch)
+{
+	AssertArg(batch != NULL);
+
+	htfifo_addentry(htf, NULL, batch);
+}
+
+static void
+htfifo_addentry(htup_fifo htf, MinimalTuple tup, TupleBatchReader *batch)
+{
+	htf_entry	p_ent;
+
+	AssertArg(htf != NULL);
+
 	/* Populate the new entry. */
 	if (htf->freelist != NULL)
 	{
@@ -116,6 +144,7 @@ htfifo_addtuple(htup_fifo htf, MinimalTuple tup)
 		p_ent = (htf_entry) palloc(sizeof(htf_entry_data));
 	}
 	p_ent->tup = tup;
+	p_ent->batch = batch;
 	p_ent->p_next = NULL;
 
 	/* Put the new entry at the end of the FIFO. */
@@ -142,34 +171,43 @@ MinimalTuple
 htfifo_gettuple(htup_fifo htf)
 {
 	htf_entry	p_ent;
-	MinimalTuple tup;
+	MinimalTuple tup = NULL;
 
 	AssertArg(htf != NULL);
 
 	/* Pull the first entry from the FIFO. */
 
-	p_ent = htf->p_first;
-	if (p_ent != NULL)
-	{
-		/* Got something.  Unhook the first entry from the list. */
-
-		htf->p_first = p_ent->p_next;
-		if (htf->p_first == NULL)
-			htf->p_last = NULL;
-
-		p_ent->p_next = NULL;	/* Just for the sake of completeness... */
-
-		tup = p_ent->tup;
-		AssertState(tup != NULL);
-
-		/* Free the FIFO entry. */
-		p_ent->p_next = htf->freelist;
-		htf->freelist = p_ent;
-	}
-	else
+	while ((p_ent = htf->p_first) != NULL)
 	{
-		/* No entries in FIFO. */
-		tup = NULL;
+		/* A batch stays at the front of the FIFO until it is exhausted. */
+		if (p_ent->batch)
+			tup = TupleBatchNext(p_ent->batch);
+		else
+		{
+			tup = p_ent->tup;
+			AssertState(tup != NULL);
+		}
+
+		/* Unhook a tuple, or an exhausted batch, from the list. */
+		if (!p_ent->batch || tup == NULL)
+		{
+			htf->p_first = p_ent->p_next;
+			if (htf->p_first == NULL)
+				htf->p_last = NULL;
+
+			if (p_ent->batch)
+			{
+				TupleBatchFreeReader(p_ent->batch);
+				p_ent->batch = NULL;
+			}
+
+			/* Free the FIFO entry. */
+			p_ent->p_next = htf->freelist;
+			htf->freelist = p_ent;
+		}
+
+		if (tup)
+			break;
 	}
 
 	return tup;
@@ -0,0 +1,898 @@
+/*-------------------------------------------------------------------------
+ *
+ * ic_proxy_iothread.c
+ *
+ *    Interconnect Proxy I/O Threads
+ *
+ * A proxy bgworker multiplexes all the logical connections of all the
+ * backends onto one tcp connection per peer, when there are many segments on
+ * a host the single libuv mainloop can saturate a cpu core during heavy
+ * shuffles.  To scale out, the socket I/O of the peers can be moved to several
+ * I/O threads, the count is controlled by gp_interconnect_proxy_io_threads.
+ *
+ * Each I/O thread runs its own libuv loop, and owns a subset of the peer
+ * connections, a peer is assigned to the thread by its dbid.  The hand
+ * shaking, the routing, and all the clients, are still handled in the
+ * mainloop, a peer is only attached to its I/O thread after the hand shaking,
+ * and is detached when shutting down.  While attached, the I/O thread reads
+ * from the socket, splits the bytes into packets, and writes the outgoing
+ * packets to the socket.
+ *
+ * The mainloop and the I/O threads communicate via lock-free queues, one for
+ * each direction of each thread, and wake up each other with libuv async
+ * handles.  The memory context and the logging facility are not thread safe,
+ * so an I/O thread never palloc() or elog(), the buffers are allocated by the
+ * mainloop, the only exception is the incoming packets, they are malloc()-ed
+ * by the I/O thread, and free()-ed by the mainloop after routing.
+ *
+ *
+ * Copyright (c) 2020-Present VMware, Inc. or its affiliates.
+ *
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "port/atomics.h"
+
+#include "ic_proxy_server.h"
+#include "ic_proxy_iothread.h"
+#include "ic_proxy_pkt_cache.h"
+
+#include <uv.h>
+
+#include <unistd.h>
+
+
+typedef struct ICProxyIONode ICProxyIONode;
+typedef struct ICProxyIOQueue ICProxyIOQueue;
+typedef struct ICProxyIOMsg ICProxyIOMsg;
+typedef struct ICProxyIOThread ICProxyIOThread;
+
+
+#define IC_PROXY_IONODE(ptr) ((ICProxyIONode *) (uintptr_t) (ptr))
+
+/*
+ * A node of the lock-free queue, it must be the first member of the queued
+ * struct.
+ */
+struct ICProxyIONode
+{
+	pg_atomic_uint64 next;				/* the next node, or NULL */
+};
+
+/*
+ * A lock-free intrusive queue.
+ *
+ * This is the classic Vyukov's MPSC queue, the producer pushes to the head
+ * with an atomic exchange, the consumer pops from the tail without any atomic
+ * read-modify-write.  In our case there is only one producer and one consumer
+ * for each queue.
+ */
+struct ICProxyIOQueue
+{
+	pg_atomic_uint64 head;				/* the last pushed node, producer side */
+	ICProxyIONode *tail;				/* the next node to pop, consumer side */
+	ICProxyIONode stub;					/* the stub node */
+};
+
+typedef enum
+{
+	/* from the mainloop to the I/O thread */
+	IC_PROXY_IO_ATTACH,
+	IC_PROXY_IO_DETACH,
+	IC_PROXY_IO_WRITE,
+	IC_PROXY_IO_QUIT,
+
+	/* from the I/O thread to the mainloop */
+	IC_PROXY_IO_DATA,
+	IC_PROXY_IO_SENT,
+	IC_PROXY_IO_ERROR,
+	IC_PROXY_IO_DETACHED,
+} ICProxyIOMsgType;
+
+/*
+ * A message between the mainloop and an I/O thread.
+ *
+ * A WRITE message is sent back as a SENT one once the packet is written, a
+ * DETACH message is sent back as a DETACHED one once the socket is closed.
+ * A DATA message is allocated by the I/O thread with the packet appended.
+ */
+struct ICProxyIOMsg
+{
+	ICProxyIONode node;					/* must be the first member */
+
+	ICProxyIOMsgType type;				/* the message type */
+	ICProxyIOConn *conn;				/* the connection */
+	int			status;					/* the libuv status code */
+
+	uv_write_t	req;					/* the libuv write request */
+	ICProxyPkt *pkt;					/* the packet */
+	ic_proxy_sent_cb callback;			/* the sent callback */
+	void	   *opaque;					/* the sent callback data */
+};
+
+/*
+ * A peer connection attached to an I/O thread.
+ *
+ * The I/O thread reads and writes a dup() of the peer socket, so the mainloop
+ * can still close its own handle in the normal way after the detaching.
+ */
+struct ICProxyIOConn
+{
+	uv_tcp_t	tcp;					/* the libuv handle in the I/O thread */
+	uv_shutdown_t shutdown;				/* the libuv shutdown request */
+
+	ICProxyIOThread *thread;			/* the owner thread */
+	ICProxyPeer *peer;					/* the peer, only used by mainloop */
+	uv_os_sock_t fd;					/* the dup()-ed peer socket */
+
+	ICProxyIBuf	ibuf;					/* ibuf detects the packet boundaries */
+	char	   *rbuf;					/* the read buffer */
+	size_t		rbufsize;				/* the read buffer size */
+
+	bool		failed;					/* an error is reported */
+	bool		detaching;				/* the detaching is in progress */
+
+	/* these messages are used only once, so they are embedded */
+	ICProxyIOMsg attach_msg;
+	ICProxyIOMsg detach_msg;
+	ICProxyIOMsg error_msg;
+};
+
+/*
+ * An I/O thread.
+ */
+struct ICProxyIOThread
+{
+	int			id;						/* the thread index, for logging */
+	uv_thread_t	tid;					/* the thread handle */
+	uv_loop_t	loop;					/* the libuv loop of the thread */
+
+	uv_async_t	cmd_async;				/* wakes up the thread */
+	ICProxyIOQueue cmds;				/* mainloop -> thread */
+
+	uv_async_t	event_async;			/* wakes up the mainloop */
+	ICProxyIOQueue events;				/* thread -> mainloop */
+
+	ICProxyIOMsg quit_msg;				/* the QUIT message */
+
+	int			nconns;					/* count of attached peers */
+
+	/* throughput statistics, only written by the thread */
+	pg_atomic_uint64 recv_pkts;
+	pg_atomic_uint64 recv_bytes;
+	pg_atomic_uint64 sent_pkts;
+	pg_atomic_uint64 sent_bytes;
+
+	/* the statistics at the last report, only used by mainloop */
+	uint64		last_recv_pkts;
+	uint64		last_recv_bytes;
+	uint64		last_sent_pkts;
+	uint64		last_sent_bytes;
+};
+
+
+static ICProxyIOThread *ic_proxy_iothreads;
+static int	ic_proxy_n_iothreads;
+static uv_loop_t *ic_proxy_iothread_mainloop;
+static uint64 ic_proxy_iothread_last_report;
+
+
+/*
+ * Initialize a queue.
+ */
+static void
+ic_proxy_ioqueue_init(ICProxyIOQueue *q)
+{
+	pg_atomic_init_u64(&q->stub.next, 0);
+	pg_atomic_init_u64(&q->head, (uint64) (uintptr_t) &q->stub);
+	q->tail = &q->stub;
+}
+
+/*
+ * Push a node to the queue, called by the producer.
+ */
+static void
+ic_proxy_ioqueue_push(ICProxyIOQueue *q, ICProxyIONode *node)
+{
+	ICProxyIONode *prev;
+
+	pg_atomic_write_u64(&node->next, 0);
+
+	/* the exchange is a full barrier, the node content is visible after it */
+	prev = IC_PROXY_IONODE(pg_atomic_exchange_u64(&q->head,
+												  (uint64) (uintptr_t) node));
+
+	/*
+	 * The consumer can not see the node until the link is set, it will retry
+	 * on the next wakeup.
+	 */
+	pg_atomic_write_u64(&prev->next, (uint64) (uintptr_t) node);
+}
+
+/*
+ * Pop a node from the queue, called by the consumer.
+ *
+ * Return NULL if the queue is empty, or the producer is in the middle of a
+ * push, in the latter case the consumer will be waken up again after the
+ * push.
+ */
+static ICProxyIONode *
+ic_proxy_ioqueue_pop(ICProxyIOQueue *q)
+{
+	ICProxyIONode *tail = q->tail;
+	ICProxyIONode *next = IC_PROXY_IONODE(pg_atomic_read_u64(&tail->next));
+
+	if (tail == &q->stub)
+	{
+		if (next == NULL)
+			return NULL;
+
+		q->tail = next;
+		tail = next;
+		next = IC_PROXY_IONODE(pg_atomic_read_u64(&next->next));
+	}
+
+	if (next)
+	{
+		q->tail = next;
+		pg_read_barrier();
+		return tail;
+	}
+
+	if (tail != IC_PROXY_IONODE(pg_atomic_read_u64(&q->head)))
+		return NULL;
+
+	/* tail is the last node, push the stub so it can be detached */
+	ic_proxy_ioqueue_push(q, &q->stub);
+
+	next = IC_PROXY_IONODE(pg_atomic_read_u64(&tail->next));
+	if (next)
+	{
+		q->tail = next;
+		pg_read_barrier();
+		return tail;
+	}
+
+	return NULL;
+}
+
+/*
+ * Send a message to the mainloop, called by the I/O thread.
+ *
+ * The caller should wake up the mainloop with uv_async_send() after pushing
+ * one or more messages.
+ */
+static void
+ic_proxy_iothread_push_event(ICProxyIOThread *thread, ICProxyIOMsg *msg)
+{
+	ic_proxy_ioqueue_push(&thread->events, &msg->node);
+}
+
+/*
+ * Send a message to the I/O thread, called by the mainloop.
+ */
+static void
+ic_proxy_iothread_push_cmd(ICProxyIOThread *thread, ICProxyIOMsg *msg)
+{
+	ic_proxy_ioqueue_push(&thread->cmds, &msg->node);
+	uv_async_send(&thread->cmd_async);
+}
+
+/*
+ * Report an I/O error to the mainloop, only the first error is reported.
+ *
+ * Run in the I/O thread.
+ */
+static void
+ic_proxy_iothread_report_error(ICProxyIOConn *conn, int status)
+{
+	if (conn->failed)
+		return;
+
+	conn->failed = true;
+
+	uv_read_stop((uv_stream_t *) &conn->tcp);
+
+	conn->error_msg.type = IC_PROXY_IO_ERROR;
+	conn->error_msg.conn = conn;
+	conn->error_msg.status = status;
+
+	ic_proxy_iothread_push_event(conn->thread, &conn->error_msg);
+	uv_async_send(&conn->thread->event_async);
+}
+
+/*
+ * Provide the read buffer, run in the I/O thread.
+ *
+ * Libuv processes the bytes in the read callback before reading again, so the
+ * same buffer is reused for every read.
+ */
+static void
+ic_proxy_iothread_alloc_buffer(uv_handle_t *handle, size_t size, uv_buf_t *buf)
+{
+	ICProxyIOConn *conn = CONTAINER_OF((void *) handle, ICProxyIOConn, tcp);
+
+	buf->base = conn->rbuf;
+	buf->len = conn->rbufsize;
+}
+
+/*
+ * Received a complete packet, run in the I/O thread.
+ */
+static void
+ic_proxy_iothread_on_pkt(void *opaque, const void *data, uint16 size)
+{
+	ICProxyIOConn *conn = opaque;
+	ICProxyIOThread *thread = conn->thread;
+	ICProxyIOMsg *msg;
+
+	if (conn->failed)
+		return;
+
+	/* the memory context is not thread safe, so use malloc() instead */
+	msg = malloc(MAXALIGN(sizeof(*msg)) + size);
+	if (msg == NULL)
+	{
+		ic_proxy_iothread_report_error(conn, UV_ENOMEM);
+		return;
+	}
+
+	msg->type = IC_PROXY_IO_DATA;
+	msg->conn = conn;
+	msg->status = 0;
+	msg->pkt = (ICProxyPkt *) (((char *) msg) + MAXALIGN(sizeof(*msg)));
+	memcpy(msg->pkt, data, size);
+
+	ic_proxy_iothread_push_event(thread, msg);
+
+	pg_atomic_fetch_add_u64(&thread->recv_pkts, 1);
+	pg_atomic_fetch_add_u64(&thread->recv_bytes, size);
+}
+
+/*
+ * Received bytes from the peer, run in the I/O thread.
+ */
+static void
+ic_proxy_iothread_on_data(uv_stream_t *stream, ssize_t nread, const uv_buf_t *buf)
+{
+	ICProxyIOConn *conn = CONTAINER_OF((void *) stream, ICProxyIOConn, tcp);
+
+	if (unlikely(nread < 0))
+	{
+		ic_proxy_iothread_report_error(conn, nread);
+		return;
+	}
+	else if (unlikely(nread == 0))
+	{
+		/* EAGAIN or EWOULDBLOCK, retry */
+		return;
+	}
+
+	ic_proxy_ibuf_push(&conn->ibuf, buf->base, nread,
+					   ic_proxy_iothread_on_pkt, conn);
+
+	/* wake up the mainloop once for all the packets */
+	uv_async_send(&conn->thread->event_async);
+}
+
+/*
+ * A packet is written, run in the I/O thread.
+ */
+static void
+ic_proxy_iothread_on_write(uv_write_t *req, int status)
+{
+	ICProxyIOMsg *msg = CONTAINER_OF((void *) req, ICProxyIOMsg, req);
+	ICProxyIOThread *thread = msg->conn->thread;
+
+	if (status == 0)
+	{
+		pg_atomic_fetch_add_u64(&thread->sent_pkts, 1);
+		pg_atomic_fetch_add_u64(&thread->sent_bytes, msg->pkt->len);
+	}
+
+	msg->type = IC_PROXY_IO_SENT;
+	msg->status = status;
+
+	ic_proxy_iothread_push_event(thread, msg);
+	uv_async_send(&thread->event_async);
+}
+
+/*
+ * The dup()-ed socket is closed, run in the I/O thread.
+ */
+static void
+ic_proxy_iothread_on_close(uv_handle_t *handle)
+{
+	ICProxyIOConn *conn = CONTAINER_OF((void *) handle, ICProxyIOConn, tcp);
+
+	conn->detach_msg.type = IC_PROXY_IO_DETACHED;
+
+	ic_proxy_iothread_push_event(conn->thread, &conn->detach_msg);
+	uv_async_send(&conn->thread->event_async);
+}
+
+/*
+ * The socket is shutted down, run in the I/O thread.
+ */
+static void
+ic_proxy_iothread_on_shutdown(uv_shutdown_t *req, int status)
+{
+	ICProxyIOConn *conn = CONTAINER_OF((void *) req, ICProxyIOConn, shutdown);
+
+	conn->detach_msg.status = status;
+
+	uv_close((uv_handle_t *) &conn->tcp, ic_proxy_iothread_on_close);
+}
+
+/*
+ * Close a handle on quiting, run in the I/O thread.
+ */
+static void
+ic_proxy_iothread_close_handle(uv_handle_t *handle, void *arg)
+{
+	if (!uv_is_closing(handle))
+		uv_close(handle, NULL);
+}
+
+/*
+ * Handle the messages from the mainloop, run in the I/O thread.
+ */
+static void
+ic_proxy_iothread_on_cmd(uv_async_t *handle)
+{
+	ICProxyIOThread *thread = handle->data;
+	ICProxyIONode *node;
+
+	while ((node = ic_proxy_ioqueue_pop(&thread->cmds)) != NULL)
+	{
+		ICProxyIOMsg *msg = (ICProxyIOMsg *) node;
+		ICProxyIOConn *conn = msg->conn;
+		uv_buf_t	wbuf;
+		int			ret;
+
+		switch (msg->type)
+		{
+			case IC_PROXY_IO_ATTACH:
+				uv_tcp_init(&thread->loop, &conn->tcp);
+
+				ret = uv_tcp_open(&conn->tcp, conn->fd);
+				if (ret == 0)
+					ret = uv_read_start((uv_stream_t *) &conn->tcp,
+										ic_proxy_iothread_alloc_buffer,
+										ic_proxy_iothread_on_data);
+				if (ret < 0)
+					ic_proxy_iothread_report_error(conn, ret);
+				break;
+
+			case IC_PROXY_IO_DETACH:
+				/*
+				 * Flush the pending writes before closing the socket, this is
+				 * what the mainloop does on a peer without I/O thread.
+				 */
+				conn->detaching = true;
+				uv_read_stop((uv_stream_t *) &conn->tcp);
+
+				ret = uv_shutdown(&conn->shutdown, (uv_stream_t *) &conn->tcp,
+								  ic_proxy_iothread_on_shutdown);
+				if (ret < 0)
+				{
+					conn->detach_msg.status = ret;
+					uv_close((uv_handle_t *) &conn->tcp,
+							 ic_proxy_iothread_on_close);
+				}
+				break;
+
+			case IC_PROXY_IO_WRITE:
+				if (conn->detaching)
+				{
+					msg->type = IC_PROXY_IO_SENT;
+					msg->status = UV_ECANCELED;
+					ic_proxy_iothread_push_event(thread, msg);
+					uv_async_send(&thread->event_async);
+					break;
+				}
+
+				wbuf.base = (char *) msg->pkt;
+				wbuf.len = msg->pkt->len;
+
+				ret = uv_write(&msg->req, (uv_stream_t *) &conn->tcp,
+							   &wbuf, 1, ic_proxy_iothread_on_write);
+				if (ret < 0)
+				{
+					msg->type = IC_PROXY_IO_SENT;
+					msg->status = ret;
+					ic_proxy_iothread_push_event(thread, msg);
+					uv_async_send(&thread->event_async);
+				}
+				break;
+
+			case IC_PROXY_IO_QUIT:
+				/* the loop exits once all the handles are closed */
+				uv_walk(&thread->loop, ic_proxy_iothread_close_handle, NULL);
+				break;
+
+			default:
+				/* not a command, ignore it */
+				break;
+		}
+	}
+}
+
+/*
+ * The I/O thread main function.
+ */
+static void
+ic_proxy_iothread_main(void *arg)
+{
+	ICProxyIOThread *thread = arg;
+
+	uv_run(&thread->loop, UV_RUN_DEFAULT);
+	uv_loop_close(&thread->loop);
+}
+
+/*
+ * Handle the messages from an I/O thread, run in the mainloop.
+ */
+static void
+ic_proxy_iothread_on_event(uv_async_t *handle)
+{
+	ICProxyIOThread *thread = handle->data;
+	ICProxyIONode *node;
+
+	while ((node = ic_proxy_ioqueue_pop(&thread->events)) != NULL)
+	{
+		ICProxyIOMsg *msg = (ICProxyIOMsg *) node;
+		ICProxyIOConn *conn = msg->conn;
+		ICProxyPeer *peer = conn->peer;
+
+		switch (msg->type)
+		{
+			case IC_PROXY_IO_DATA:
+				ic_proxy_log(LOG, "%s: received %s",
+							 peer->name, ic_proxy_pkt_to_str(msg->pkt));
+
+				ic_proxy_router_route(handle->loop,
+									  ic_proxy_pkt_dup(msg->pkt), NULL, NULL);
+				free(msg);
+				break;
+
+			case IC_PROXY_IO_SENT:
+				if (msg->status < 0)
+					ic_proxy_log(LOG, "%s: fail to send %s: %s",
+								 peer->name, ic_proxy_pkt_to_str(msg->pkt),
+								 uv_strerror(msg->status));
+				else
+					ic_proxy_log(LOG, "%s: sent %s",
+								 peer->name, ic_proxy_pkt_to_str(msg->pkt));
+
+				if (msg->callback)
+					msg->callback(msg->opaque, msg->pkt, msg->status);
+
+				ic_proxy_pkt_cache_free(msg->pkt);
+				ic_proxy_free(msg);
+				break;
+
+			case IC_PROXY_IO_ERROR:
+				ic_proxy_peer_on_io_error(peer, msg->status);
+				break;
+
+			case IC_PROXY_IO_DETACHED:
+				ic_proxy_log(LOG, "%s: detached from io thread %d",
+							 peer->name, thread->id);
+
+				if (msg->status < 0)
+					ic_proxy_log(WARNING, "%s: fail to shutdown: %s",
+								 peer->name, uv_strerror(msg->status));
+
+				ic_proxy_ibuf_uninit(&conn->ibuf);
+				ic_proxy_pkt_cache_free(conn->rbuf);
+				ic_proxy_free(conn);
+
+				if (--thread->nconns == 0)
+					uv_unref((uv_handle_t *) &thread->event_async);
+
+				ic_proxy_peer_on_io_detached(peer);
+				break;
+
+			default:
+				/* not an event, ignore it */
+				break;
+		}
+	}
+}
+
+/*
+ * Start the I/O threads.
+ *
+ * It must be called before unblocking the signals, so the signals are
+ * always delivered to the mainloop.
+ */
+void
+ic_proxy_iothreads_init(uv_loop_t *loop)
+{
+	int			i;
+
+	ic_proxy_iothread_mainloop = loop;
+	ic_proxy_iothread_last_report = uv_now(loop);
+	ic_proxy_n_iothreads = 0;
+
+	if (gp_interconnect_proxy_io_threads <= 0)
+		return;
+
+	ic_proxy_iothreads = ic_proxy_alloc(sizeof(ICProxyIOThread) *
+										gp_interconnect_proxy_io_threads);
+
+	for (i = 0; i < gp_interconnect_proxy_io_threads; i++)
+	{
+		ICProxyIOThread *thread = &ic_proxy_iothreads[i];
+		int			ret;
+
+		memset(thread, 0, sizeof(*thread));
+		thread->id = i;
+
+		ic_proxy_ioqueue_init(&thread->cmds);
+		ic_proxy_ioqueue_init(&thread->events);
+
+		pg_atomic_init_u64(&thread->recv_pkts, 0);
+		pg_atomic_init_u64(&thread->recv_bytes, 0);
+		pg_atomic_init_u64(&thread->sent_pkts, 0);
+		pg_atomic_init_u64(&thread->sent_bytes, 0);
+
+		uv_loop_init(&thread->loop);
+
+		uv_async_init(&thread->loop, &thread->cmd_async,
+					  ic_proxy_iothread_on_cmd);
+		thread->cmd_async.data = thread;
+
+		/*
+		 * The mainloop should not be kept alive by the I/O threads, unless
+		 * there are attached peers.
+		 */
+		uv_async_init(loop, &thread->event_async, ic_proxy_iothread_on_event);
+		thread->event_async.data = thread;
+		uv_unref((uv_handle_t *) &thread->event_async);
+
+		ret = uv_thread_create(&thread->tid, ic_proxy_iothread_main, thread);
+		if (ret < 0)
+		{
+			ic_proxy_log(WARNING,
+						 "ic-proxy-server: fail to start io thread %d: %s",
+						 i, uv_strerror(ret));
+
+			uv_close((uv_handle_t *) &thread->event_async, NULL);
+			uv_close((uv_handle_t *) &thread->cmd_async, NULL);
+			uv_run(&thread->loop, UV_RUN_DEFAULT);
+			uv_loop_close(&thread->loop);
+			break;
+		}
+
+		ic_proxy_n_iothreads++;
+	}
+
+	ic_proxy_log(LOG, "ic-proxy-server: started %d io threads",
+				 ic_proxy_n_iothreads);
+}
+
+/*
+ * Stop the I/O threads.
+ *
+ * The mainloop is already stopped, so the pending callbacks are dropped
+ * silently, the same as ic_proxy_router_uninit().
+ */
+void
+ic_proxy_iothreads_uninit(void)
+{
+	int			i;
+
+	for (i = 0; i < ic_proxy_n_iothreads; i++)
+	{
+		ICProxyIOThread *thread = &ic_proxy_iothreads[i];
+		ICProxyIONode *node;
+
+		thread->quit_msg.type = IC_PROXY_IO_QUIT;
+		thread->quit_msg.conn = NULL;
+		ic_proxy_iothread_push_cmd(thread, &thread->quit_msg);
+
+		uv_thread_join(&thread->tid);
+
+		while ((node = ic_proxy_ioqueue_pop(&thread->events)) != NULL)
+		{
+			ICProxyIOMsg *msg = (ICProxyIOMsg *) node;
+
+			if (msg->type == IC_PROXY_IO_DATA)
+				free(msg);
+			else if (msg->type == IC_PROXY_IO_SENT)
+			{
+				ic_proxy_pkt_cache_free(msg->pkt);
+				ic_proxy_free(msg);
+			}
+		}
+	}
+
+	ic_proxy_iothreads_report_stats(true);
+
+	ic_proxy_n_iothreads = 0;
+}
+
+/*
+ * Return true if the peers should be attached to the I/O threads.
+ */
+bool
+ic_proxy_iothreads_enabled(void)
+{
+	return ic_proxy_n_iothreads > 0;
+}
+
+/*
+ * Report the per-thread throughput, run in the mainloop.
+ *
+ * The report is done at most once per IC_PROXY_IOTHREAD_STATS_INTERVAL, and
+ * only for the threads that have traffic since the last report, unless force
+ * is true.
+ */
+void
+ic_proxy_iothreads_report_stats(bool force)
+{
+	uint64		now;
+	double		secs;
+	int			i;
+
+	if (ic_proxy_n_iothreads == 0)
+		return;
+
+	now = uv_now(ic_proxy_iothread_mainloop);
+	if (!force &&
+		now - ic_proxy_iothread_last_report < IC_PROXY_IOTHREAD_STATS_INTERVAL)
+		return;
+
+	secs = Max(now - ic_proxy_iothread_last_report, 1) / 1000.0;
+	ic_proxy_iothread_last_report = now;
+
+	for (i = 0; i < ic_proxy_n_iothreads; i++)
+	{
+		ICProxyIOThread *thread = &ic_proxy_iothreads[i];
+		uint64		recv_pkts = pg_atomic_read_u64(&thread->recv_pkts);
+		uint64		recv_bytes = pg_atomic_read_u64(&thread->recv_bytes);
+		uint64		sent_pkts = pg_atomic_read_u64(&thread->sent_pkts);
+		uint64		sent_bytes = pg_atomic_read_u64(&thread->sent_bytes);
+
+		if (!force &&
+			recv_pkts == thread->last_recv_pkts &&
+			sent_pkts == thread->last_sent_pkts)
+			continue;
+
+		/* this is a regular report, so do not use ic_proxy_log() */
+		elog(LOG, "ic-proxy-server: io thread %d: %d peers, "
+			 "received " UINT64_FORMAT " packets " UINT64_FORMAT " bytes (%.1f KB/s), "
+			 "sent " UINT64_FORMAT " packets " UINT64_FORMAT " bytes (%.1f KB/s)",
+			 thread->id, thread->nconns,
+			 recv_pkts, recv_bytes,
+			 (recv_bytes - thread->last_recv_bytes) / 1024.0 / secs,
+			 sent_pkts, sent_bytes,
+			 (sent_bytes - thread->last_sent_bytes) / 1024.0 / secs);
+
+		thread->last_recv_pkts = recv_pkts;
+		thread->last_recv_bytes = recv_bytes;
+		thread->last_sent_pkts = sent_pkts;
+		thread->last_sent_bytes = sent_bytes;
+	}
+}
+
+/*
+ * Attach a peer to its I/O thread, run in the mainloop.
+ *
+ * The peer must have finished the hand shaking, and must not be reading or
+ * writing in the mainloop.  The unconsumed bytes in the peer's ibuf are
+ * transferred to the I/O thread.
+ *
+ * Return NULL if the peer can not be attached, the caller should handle the
+ * peer in the mainloop in such a case.
+ */
+ICProxyIOConn *
+ic_proxy_iothread_attach(ICProxyPeer *peer)
+{
+	ICProxyIOThread *thread;
+	ICProxyIOConn *conn;
+	uv_os_fd_t	fd;
+	int			newfd;
+	int			ret;
+
+	Assert(ic_proxy_n_iothreads > 0);
+
+	ret = uv_fileno((uv_handle_t *) &peer->tcp, &fd);
+	if (ret < 0)
+	{
+		ic_proxy_log(WARNING, "%s: fail to get the socket: %s",
+					 peer->name, uv_strerror(ret));
+		return NULL;
+	}
+
+	newfd = dup(fd);
+	if (newfd < 0)
+	{
+		ic_proxy_log(WARNING, "%s: fail to dup the socket: %m", peer->name);
+		return NULL;
+	}
+
+	thread = &ic_proxy_iothreads[peer->dbid % ic_proxy_n_iothreads];
+
+	conn = ic_proxy_new(ICProxyIOConn);
+	memset(conn, 0, sizeof(*conn));
+	conn->thread = thread;
+	conn->peer = peer;
+	conn->fd = newfd;
+	conn->failed = false;
+	conn->detaching = false;
+
+	/*
+	 * The I/O thread can not allocate from the packet cache, so make sure the
+	 * ibuf owns a buffer before the handover.
+	 */
+	conn->ibuf = peer->ibuf;
+	ic_proxy_ibuf_init_p2p(&peer->ibuf);
+	if (conn->ibuf.buf == NULL)
+		conn->ibuf.buf = ic_proxy_pkt_cache_alloc(NULL);
+
+	conn->rbuf = ic_proxy_pkt_cache_alloc(&conn->rbufsize);
+	/* ic_proxy_ibuf_push() accepts at most PG_UINT16_MAX bytes at a time */
+	conn->rbufsize = Min(conn->rbufsize, PG_UINT16_MAX);
+
+	if (thread->nconns++ == 0)
+		uv_ref((uv_handle_t *) &thread->event_async);
+
+	ic_proxy_log(LOG, "%s: attaching to io thread %d", peer->name, thread->id);
+
+	conn->attach_msg.type = IC_PROXY_IO_ATTACH;
+	conn->attach_msg.conn = conn;
+	ic_proxy_iothread_push_cmd(thread, &conn->attach_msg);
+
+	return conn;
+}
+
+/*
+ * Detach a peer from its I/O thread, run in the mainloop.
+ *
+ * The pending writes are flushed and the socket is shutted down by the I/O
+ * thread, then ic_proxy_peer_on_io_detached() is called in the mainloop.  The
+ * conn must not be used by the caller after this call.
+ */
+void
+ic_proxy_iothread_detach(ICProxyIOConn *conn)
+{
+	ic_proxy_log(LOG, "%s: detaching from io thread %d",
+				 conn->peer->name, conn->thread->id);
+
+	conn->detach_msg.type = IC_PROXY_IO_DETACH;
+	conn->detach_msg.conn = conn;
+	conn->detach_msg.status = 0;
+	ic_proxy_iothread_push_cmd(conn->thread, &conn->detach_msg);
+}
+
+/*
+ * Write a packet to an attached peer, run in the mainloop.
+ *
+ * This is the counterpart of ic_proxy_router_write(), the packet ownership is
+ * taken, and the callback is called in the mainloop once the packet is sent.
+ */
+void
+ic_proxy_iothread_write(ICProxyIOConn *conn, ICProxyPkt *pkt,
+						ic_proxy_sent_cb callback, void *opaque)
+{
+	ICProxyIOMsg *msg;
+
+	ic_proxy_log(LOG, "%s: sending %s via io thread %d",
+				 conn->peer->name, ic_proxy_pkt_to_str(pkt), conn->thread->id);
+
+	msg = ic_proxy_new(ICProxyIOMsg);
+	msg->type = IC_PROXY_IO_WRITE;
+	msg->conn = conn;
+	msg->status = 0;
+	msg->pkt = pkt;
+	msg->callback = callback;
+	msg->opaque = opaque;
+
+	ic_proxy_iothread_push_cmd(conn->thread, msg);
+}
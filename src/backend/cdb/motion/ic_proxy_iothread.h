@@ -0,0 +1,45 @@
+/*-------------------------------------------------------------------------
+ *
+ * ic_proxy_iothread.h
+ *
+ *
+ * Copyright (c) 2020-Present VMware, Inc. or its affiliates.
+ *
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef IC_PROXY_IOTHREAD_H
+#define IC_PROXY_IOTHREAD_H
+
+
+#include "postgres.h"
+
+#include <uv.h>
+
+#include "ic_proxy_packet.h"
+#include "ic_proxy_router.h"
+
+
+/* report the io thread statistics at this interval, in milliseconds */
+#define IC_PROXY_IOTHREAD_STATS_INTERVAL (60 * 1000)
+
+
+typedef struct ICProxyIOConn ICProxyIOConn;
+
+/* defined in ic_proxy_server.h */
+struct ICProxyPeer;
+
+
+extern void ic_proxy_iothreads_init(uv_loop_t *loop);
+extern void ic_proxy_iothreads_uninit(void);
+extern bool ic_proxy_iothreads_enabled(void);
+extern void ic_proxy_iothreads_report_stats(bool force);
+
+extern ICProxyIOConn *ic_proxy_iothread_attach(struct ICProxyPeer *peer);
+extern void ic_proxy_iothread_detach(ICProxyIOConn *conn);
+extern void ic_proxy_iothread_write(ICProxyIOConn *conn, ICProxyPkt *pkt,
+									ic_proxy_sent_cb callback, void *opaque);
+
+
+#endif   /* IC_PROXY_IOTHREAD_H */
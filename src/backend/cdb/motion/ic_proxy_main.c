@@ -21,6 +21,7 @@
 
 #include "ic_proxy_server.h"
 #include "ic_proxy_addr.h"
+#include "ic_proxy_iothread.h"
 #include "ic_proxy_pkt_cache.h"
 
 #include <uv.h>
@@ -365,6 +366,7 @@ ic_proxy_server_on_timer(uv_timer_t *timer)
 	ic_proxy_server_peer_listener_init(timer->loop);
 	ic_proxy_server_ensure_peers(timer->loop);
 	ic_proxy_server_client_listener_init(timer->loop);
+	ic_proxy_iothreads_report_stats(false);
 }
 
 /*
@@ -433,6 +435,9 @@ ic_proxy_server_main(void)
 	ic_proxy_peer_table_init();
 	ic_proxy_client_table_init();
 
+	/* the I/O threads must be started before unblocking the signals */
+	ic_proxy_iothreads_init(&ic_proxy_server_loop);
+
 	ic_proxy_peer_listening = false;
 	ic_proxy_client_listening = false;
 
@@ -475,6 +480,7 @@ ic_proxy_server_main(void)
 
 	ic_proxy_log(LOG, "ic-proxy-server: closing");
 
+	ic_proxy_iothreads_uninit();
 	ic_proxy_client_table_uninit();
 	ic_proxy_peer_table_uninit();
 	ic_proxy_router_uninit();
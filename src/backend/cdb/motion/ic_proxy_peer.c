@@ -60,6 +60,7 @@ static ICProxyPeer *ic_proxy_peers[65536];
 
 static void ic_proxy_peer_shutdown(ICProxyPeer *peer);
 static void ic_proxy_peer_handle_out_cache(ICProxyPeer *peer);
+static void ic_proxy_peer_start_data(ICProxyPeer *peer);
 static void ic_proxy_peer_on_data_pkt(void *opaque,
 									  const void *data, uint16 size);
 static void ic_proxy_peer_send_message(ICProxyPeer *peer,
@@ -346,6 +347,7 @@ ic_proxy_peer_new(uv_loop_t *loop, int16 content, uint16 dbid)
 	peer->dbid = dbid;
 	peer->state = 0;
 	peer->reqs = NIL;
+	peer->ioconn = NULL;
 
 	ic_proxy_ibuf_init_p2p(&peer->ibuf);
 
@@ -470,11 +472,103 @@ ic_proxy_peer_shutdown(ICProxyPeer *peer)
 	/* disconnect all the clients */
 	ic_proxy_client_table_shutdown_by_dbid(peer->dbid);
 
+	if (peer->ioconn)
+	{
+		/*
+		 * The socket is owned by an I/O thread, it flushes the pending writes
+		 * and shuts down the socket, then ic_proxy_peer_on_io_detached() is
+		 * called.
+		 */
+		ICProxyIOConn *conn = peer->ioconn;
+
+		peer->ioconn = NULL;
+		ic_proxy_iothread_detach(conn);
+		return;
+	}
+
 	req = ic_proxy_new(uv_shutdown_t);
 
 	uv_shutdown(req, (uv_stream_t *) &peer->tcp, ic_proxy_peer_on_shutdown);
 }
 
+/*
+ * The I/O thread failed to receive from the peer.
+ */
+void
+ic_proxy_peer_on_io_error(ICProxyPeer *peer, int status)
+{
+	if (status != UV_EOF)
+		ic_proxy_log(WARNING, "%s: fail to receive DATA: %s",
+					 peer->name, uv_strerror(status));
+	else
+		ic_proxy_log(LOG, "%s: received EOF while waiting for DATA",
+					 peer->name);
+
+	ic_proxy_peer_shutdown(peer);
+}
+
+/*
+ * The peer is detached from its I/O thread, and the socket is shutted down.
+ */
+void
+ic_proxy_peer_on_io_detached(ICProxyPeer *peer)
+{
+	ic_proxy_log(LOG, "%s: shutted down", peer->name);
+
+	peer->state |= IC_PROXY_PEER_STATE_SHUTTED;
+
+	ic_proxy_peer_close(peer);
+}
+
+/*
+ * Start receiving DATA after the hand shaking.
+ *
+ * With I/O threads the socket is attached to one of them, otherwise, or if
+ * the attaching fails, it is read in the mainloop.
+ */
+static void
+ic_proxy_peer_start_data(ICProxyPeer *peer)
+{
+	peer->state |= IC_PROXY_PEER_STATE_RECEIVING_DATA;
+
+	if (ic_proxy_iothreads_enabled())
+		peer->ioconn = ic_proxy_iothread_attach(peer);
+
+	/*
+	 * If there are early coming packets, make sure to route them before
+	 * receiving new data, we must ensure that packets are routed in the same
+	 * order as they arrive.
+	 */
+	ic_proxy_peer_handle_out_cache(peer);
+
+	ic_proxy_log(LOG, "%s: start receiving DATA", peer->name);
+
+	/* now it's time to receive the normal data */
+	if (peer->ioconn == NULL)
+		uv_read_start((uv_stream_t *) &peer->tcp,
+					  ic_proxy_pkt_cache_alloc_buffer, ic_proxy_peer_on_data);
+}
+
+/*
+ * Return true if the peer is ready to send DATA.
+ *
+ * With I/O threads a peer can only send after it is attached, or after the
+ * attaching failed, otherwise the writes from the mainloop and the I/O thread
+ * could interleave.
+ */
+static bool
+ic_proxy_peer_ready_for_data(ICProxyPeer *peer)
+{
+	if (!(peer->state & IC_PROXY_PEER_STATE_READY_FOR_DATA))
+		return false;
+
+	if (!ic_proxy_iothreads_enabled() || peer->ioconn)
+		return true;
+
+	return ((peer->state & IC_PROXY_PEER_STATE_RECEIVING_DATA) &&
+			!(peer->state & IC_PROXY_PEER_STATE_SHUTTING));
+}
+
 /*
  * Sent the HELLO ACK message.
  */
@@ -491,21 +585,10 @@ ic_proxy_peer_on_sent_hello_ack(void *opaque, const ICProxyPkt *pkt, int status)
 
 	peer->state |= IC_PROXY_PEER_STATE_SENT_HELLO_ACK;
 
-	ic_proxy_log(LOG, "%s: start receiving DATA", peer->name);
-
 	/* it's unlikely that the ibuf is non-empty, but clear it for sure */
 	ic_proxy_ibuf_clear(&peer->ibuf);
 
-	/*
-	 * If there are early coming packets, make sure to route them before
-	 * receiving new data, we must ensure that packets are routed in the same
-	 * order as they arrive.
-	 */
-	ic_proxy_peer_handle_out_cache(peer);
-
-	/* now it's time to receive the normal data */
-	uv_read_start((uv_stream_t *) &peer->tcp,
-				  ic_proxy_pkt_cache_alloc_buffer, ic_proxy_peer_on_data);
+	ic_proxy_peer_start_data(peer);
 }
 
 /*
@@ -657,17 +740,12 @@ ic_proxy_peer_on_hello_ack_pkt(void *opaque, const void *data, uint16 size)
 	/* do not clear the ibuf, it could already contain incoming DATA */
 
 	/*
-	 * If there are early coming packets, make sure to route them before
-	 * receiving new data, we must ensure that packets are routed in the same
-	 * order as they arrive.
+	 * The ibuf is still being consumed, so it can not be handed over to an
+	 * I/O thread now, the peer is attached after the ibuf push, in
+	 * ic_proxy_peer_on_hello_ack_data().
 	 */
-	ic_proxy_peer_handle_out_cache(peer);
-
-	ic_proxy_log(LOG, "%s: start receiving DATA", peer->name);
-
-	/* now it's time to receive the normal data */
-	uv_read_start((uv_stream_t *) &peer->tcp,
-				  ic_proxy_pkt_cache_alloc_buffer, ic_proxy_peer_on_data);
+	if (!ic_proxy_iothreads_enabled())
+		ic_proxy_peer_start_data(peer);
 }
 
 /*
@@ -706,6 +784,12 @@ ic_proxy_peer_on_hello_ack_data(uv_stream_t *stream,
 	ic_proxy_ibuf_push(&peer->ibuf, buf->base, nread,
 					   ic_proxy_peer_on_hello_ack_pkt, peer);
 	ic_proxy_pkt_cache_free(buf->base);
+
+	/* with I/O threads the DATA is started after the ibuf push */
+	if ((peer->state & IC_PROXY_PEER_STATE_RECEIVED_HELLO_ACK) &&
+		!(peer->state & (IC_PROXY_PEER_STATE_RECEIVING_DATA |
+						 IC_PROXY_PEER_STATE_SHUTTING)))
+		ic_proxy_peer_start_data(peer);
 }
 
 /*
@@ -820,7 +904,7 @@ void
 ic_proxy_peer_route_data(ICProxyPeer *peer, ICProxyPkt *pkt,
 						 ic_proxy_sent_cb callback, void *opaque)
 {
-	if (!(peer->state & IC_PROXY_PEER_STATE_READY_FOR_DATA))
+	if (!ic_proxy_peer_ready_for_data(peer))
 	{
 		ICProxyDelay *delay;
 
@@ -833,7 +917,11 @@ ic_proxy_peer_route_data(ICProxyPeer *peer, ICProxyPkt *pkt,
 		return;
 	}
 
-	ic_proxy_router_write((uv_stream_t *) &peer->tcp, pkt, 0, callback, opaque);
+	if (peer->ioconn)
+		ic_proxy_iothread_write(peer->ioconn, pkt, callback, opaque);
+	else
+		ic_proxy_router_write((uv_stream_t *) &peer->tcp, pkt, 0,
+							  callback, opaque);
 }
 
 /*
@@ -869,7 +957,7 @@ ic_proxy_peer_handle_out_cache(ICProxyPeer *peer)
 	List	   *reqs;
 	ListCell   *cell;
 
-	if (!(peer->state & IC_PROXY_PEER_STATE_READY_FOR_DATA))
+	if (!ic_proxy_peer_ready_for_data(peer))
 		return;
 
 	if (peer->reqs == NIL)
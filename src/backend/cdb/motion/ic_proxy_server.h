@@ -20,6 +20,7 @@
 #include "ic_proxy_iobuf.h"
 #include "ic_proxy_packet.h"
 #include "ic_proxy_router.h"
+#include "ic_proxy_iothread.h"
 
 typedef struct ICProxyPeer ICProxyPeer;
 typedef struct ICProxyClient ICProxyClient;
@@ -54,6 +55,7 @@ struct ICProxyPeer
 #define IC_PROXY_PEER_STATE_SHUTTED                     0x00002000
 #define IC_PROXY_PEER_STATE_CLOSING                     0x00004000
 #define IC_PROXY_PEER_STATE_CLOSED                      0x00008000
+#define IC_PROXY_PEER_STATE_RECEIVING_DATA              0x00010000
 
 #define IC_PROXY_PEER_STATE_READY_FOR_MESSAGE \
 	(IC_PROXY_PEER_STATE_CONNECTED | \
@@ -68,6 +70,9 @@ struct ICProxyPeer
 
 	ICProxyIBuf	ibuf;			/* ibuf detects the packet boundaries */
 
+	ICProxyIOConn *ioconn;		/* the I/O thread connection, or NULL if the
+								 * socket is handled by the mainloop */
+
 	char		name[128];		/* name of the client, only for logging */
 };
 
@@ -132,6 +137,8 @@ extern void ic_proxy_peer_route_data(ICProxyPeer *peer, ICProxyPkt *pkt,
 extern ICProxyPeer *ic_proxy_peer_lookup(int16 content, uint16 dbid);
 extern ICProxyPeer *ic_proxy_peer_blessed_lookup(uv_loop_t *loop,
 												 int16 content, uint16 dbid);
+extern void ic_proxy_peer_on_io_error(ICProxyPeer *peer, int status);
+extern void ic_proxy_peer_on_io_detached(ICProxyPeer *peer);
 extern ICProxyDelay *ic_proxy_peer_build_delay(ICProxyPeer *peer,
 											   ICProxyPkt *pkt,
 											   ic_proxy_sent_cb callback,
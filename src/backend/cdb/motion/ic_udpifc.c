@@ -138,6 +138,24 @@ int
 /* 1/4 sec in msec */
 #define RX_THREAD_POLL_TIMEOUT (250)
 
+/*
+ * Max number of packets the rx thread receives with one recvmmsg() call, and
+ * the sender transmits to one connection with one sendmmsg() call.
+ */
+#ifdef HAVE_RECVMMSG
+#define RX_BATCH_SIZE (16)
+#else
+#define RX_BATCH_SIZE (1)
+#endif
+#define SND_BATCH_SIZE (16)
+
+/* Batched system calls bypass the fault injection wrappers */
+#ifdef USE_ASSERT_CHECKING
+#define UDP_TESTMODE() (udp_testmode)
+#else
+#define UDP_TESTMODE() (false)
+#endif
+
 /*
  * Flags definitions for flag-field of UDP-messages
  *
@@ -323,10 +341,10 @@ struct RxBufferPool
 /*
  * The buffer pool used for keeping data packets.
  *
- * maxCount is set to 1 to make sure there is always a buffer
- * for picking packets from OS buffer.
+ * maxCount is set to RX_BATCH_SIZE to make sure there are always
+ * buffers for picking a batch of packets from OS buffer.
  */
-static RxBufferPool rx_buffer_pool = {1, 0, NULL};
+static RxBufferPool rx_buffer_pool = {RX_BATCH_SIZE, 0, NULL};
 
 /*
  * SendBufferPool
@@ -617,6 +635,8 @@ typedef struct AckSendParam
  * duplicatedPktNum          - duplicate packet number.
  * recvAckNum                - the number of Acks received.
  * statusQueryMsgNum         - the number of status query messages sent.
+ * sndSyscallNum             - the number of system calls used to send packets.
+ * recvSyscallNum            - the number of system calls used to receive packets.
  *
  */
 typedef struct ICStatistics
@@ -638,6 +658,8 @@ typedef struct ICStatistics
 	int32		duplicatedPktNum;
 	int32		recvAckNum;
 	int32		statusQueryMsgNum;
+	int32		sndSyscallNum;
+	int32		recvSyscallNum;
 } ICStatistics;
 
 /* Statistics for UDP interconnect. */
@@ -737,6 +759,7 @@ static void checkQDConnectionAlive(void);
 
 
 static void *rxThreadFunc(void *arg);
+static bool handleRxPacket(icpkthdr *pkt, int read_count, struct sockaddr_storage *peer, socklen_t peerlen);
 
 static bool handleMismatch(icpkthdr *pkt, struct sockaddr_storage *peer, int peer_len);
 static void handleAckedPacket(MotionConn *ackConn, ICBuffer *buf, uint64 now);
@@ -752,6 +775,7 @@ static inline void addCRC(icpkthdr *pkt);
 static inline bool checkCRC(icpkthdr *pkt);
 static void sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn);
 static void sendOnce(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, ICBuffer *buf, MotionConn *conn);
+static void sendBatch(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn, ICBuffer **bufs, int nbufs);
 static inline uint64 computeExpirationPeriod(MotionConn *conn, uint32 retry);
 
 static ICBuffer *getSndBuffer(MotionConn *conn);
@@ -1458,7 +1482,7 @@ InitMotionUDPIFC(int *listenerSocketFd, uint16 *listenerPort)
 
 	/* Initialize receive buffer pool */
 	rx_buffer_pool.count = 0;
-	rx_buffer_pool.maxCount = 1;
+	rx_buffer_pool.maxCount = RX_BATCH_SIZE;
 	rx_buffer_pool.freeList = NULL;
 
 	/* Initialize send control data */
@@ -3636,7 +3660,8 @@ TeardownUDPIFCInterconnect_Internal(ChunkTransportState *transportStates,
 		 " freebuf_avg %f "
 		 "mismatch_pkt_num %d disordered_pkt_num %d duplicated_pkt_num %d"
 		 " rtt/dev [" UINT64_FORMAT "/" UINT64_FORMAT ", %f/%f, " UINT64_FORMAT "/" UINT64_FORMAT "] "
-		 " cwnd %f status_query_msg_num %d",
+		 " cwnd %f status_query_msg_num %d"
+		 " snd_syscall_num %d recv_syscall_num %d",
 		 ic_control_info.isSender, isReceiver,
 		 Gp_interconnect_snd_queue_depth, Gp_interconnect_queue_depth, Gp_max_packet_size,
 		 UNACK_QUEUE_RING_SLOTS_NUM, TIMER_SPAN, DEFAULT_RTT,
@@ -3649,7 +3674,8 @@ TeardownUDPIFCInterconnect_Internal(ChunkTransportState *transportStates,
 		 (double) ((double) ic_statistics.totalBuffers) / ((double) ic_statistics.bufferCountingTime),
 		 ic_statistics.mismatchNum, ic_statistics.disorderedPktNum, ic_statistics.duplicatedPktNum,
 		 (minRtt == ~((uint64) 0) ? 0 : minRtt), (minDev == ~((uint64) 0) ? 0 : minDev), avgRtt, avgDev, maxRtt, maxDev,
-		 snd_control_info.cwnd, ic_statistics.statusQueryMsgNum);
+		 snd_control_info.cwnd, ic_statistics.statusQueryMsgNum,
+		 ic_statistics.sndSyscallNum, ic_statistics.recvSyscallNum);
 
 	ic_control_info.isSender = false;
 	memset(&ic_statistics, 0, sizeof(ICStatistics));
@@ -4568,6 +4594,7 @@ sendOnce(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry,
 xmit_retry:
 	n = sendto(pEntry->txfd, buf->pkt, buf->pkt->len, 0,
 			   (struct sockaddr *) &conn->peer, conn->peer_len);
+	ic_statistics.sndSyscallNum++;
 	if (n < 0)
 	{
 		int			save_errno = errno;
@@ -4618,6 +4645,90 @@ xmit_retry:
 }
 
 
+/*
+ * sendBatch
+ * 		Send a batch of packets to a connection.
+ *
+ * The packets go out with as few sendmmsg() calls as the socket buffer
+ * allows. Packets sendmmsg() refuses are handed to sendOnce(), which does
+ * the retry and error handling. Without sendmmsg(), and in fault injection
+ * test mode, each packet is sent with sendOnce().
+ *
+ * The sent sequence number of the connection is advanced past the batch.
+ */
+static void
+sendBatch(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry,
+		  MotionConn *conn, ICBuffer **bufs, int nbufs)
+{
+	int			i = 0;
+
+#ifdef HAVE_SENDMMSG
+	if (nbufs > 1 && !UDP_TESTMODE())
+	{
+		struct mmsghdr msgs[SND_BATCH_SIZE];
+		struct iovec iovecs[SND_BATCH_SIZE];
+
+		Assert(nbufs <= SND_BATCH_SIZE);
+
+		for (i = 0; i < nbufs; i++)
+		{
+			iovecs[i].iov_base = bufs[i]->pkt;
+			iovecs[i].iov_len = bufs[i]->pkt->len;
+			memset(&msgs[i], 0, sizeof(struct mmsghdr));
+			msgs[i].msg_hdr.msg_name = &conn->peer;
+			msgs[i].msg_hdr.msg_namelen = conn->peer_len;
+			msgs[i].msg_hdr.msg_iov = &iovecs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		i = 0;
+		while (i < nbufs)
+		{
+			int			n;
+			int			j;
+
+			n = sendmmsg(pEntry->txfd, &msgs[i], nbufs - i, 0);
+			ic_statistics.sndSyscallNum++;
+
+			if (n <= 0)
+			{
+				/* let sendOnce() retry or report the first packet */
+				sendOnce(transportStates, pEntry, bufs[i], conn);
+				i++;
+				continue;
+			}
+
+			for (j = i; j < i + n; j++)
+			{
+				if (msgs[j].msg_len != bufs[j]->pkt->len &&
+					DEBUG1 >= log_min_messages)
+					write_log("Interconnect error writing an outgoing packet [seq %d]: short transmit (given %d sent %d) during sendmmsg() call."
+							  "For Remote Connection: contentId=%d at %s", bufs[j]->pkt->seq, bufs[j]->pkt->len, msgs[j].msg_len,
+							  conn->remoteContentId,
+							  conn->remoteHostAndPort);
+			}
+			i += n;
+		}
+	}
+	else
+#endif
+	{
+		for (i = 0; i < nbufs; i++)
+			sendOnce(transportStates, pEntry, bufs[i], conn);
+	}
+
+	for (i = 0; i < nbufs; i++)
+	{
+		ic_statistics.sndPktNum++;
+
+#ifdef AMS_VERBOSE_LOGGING
+		logPkt("SEND PKT DETAIL", bufs[i]->pkt);
+#endif
+
+		conn->sentSeq = bufs[i]->pkt->seq;
+	}
+}
+
 /*
  * handleStopMsgs
  *		handle stop messages.
@@ -4726,6 +4837,9 @@ handleStopMsgs(ChunkTransportState *transportStates, ChunkTransportStateEntry *p
 static void
 sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn)
 {
+	ICBuffer   *batch[SND_BATCH_SIZE];
+	int			nbatch = 0;
+
 	while (conn->capacity > 0 && icBufferListLength(&conn->sndQueue) > 0)
 	{
 		ICBuffer   *buf = NULL;
@@ -4764,9 +4878,9 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 		}
 
 		/*
-		 * Note the place of sendOnce here. If we send before appending it to
+		 * Note the place of sendBatch here. If we send before appending it to
 		 * the unack queue and putting it into unack queue ring, and there is
-		 * a network error occurred in the sendOnce function, error message
+		 * a network error occurred in the sendBatch function, error message
 		 * will be output. In the time of error message output, interrupts is
 		 * potentially checked, if there is a pending query cancel, it will
 		 * lead to a dangled buffer (memory leak).
@@ -4775,15 +4889,16 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 		updateStats(TPE_DATA_PKT_SEND, conn, buf->pkt);
 #endif
 
-		sendOnce(transportStates, pEntry, buf, conn);
-		ic_statistics.sndPktNum++;
-
-#ifdef AMS_VERBOSE_LOGGING
-		logPkt("SEND PKT DETAIL", buf->pkt);
-#endif
-
-		buf->conn->sentSeq = buf->pkt->seq;
+		batch[nbatch++] = buf;
+		if (nbatch == SND_BATCH_SIZE)
+		{
+			sendBatch(transportStates, pEntry, conn, batch, nbatch);
+			nbatch = 0;
+		}
 	}
+
+	if (nbatch > 0)
+		sendBatch(transportStates, pEntry, conn, batch, nbatch);
 }
 
 /*
@@ -6118,10 +6233,135 @@ handleDataPacket(MotionConn *conn, icpkthdr *pkt, struct sockaddr_storage *peer,
 	return true;
 }
 
+/*
+ * handleRxPacket
+ * 		Handle a packet the rx thread has received.
+ *
+ * Returns true if the packet buffer has been handed over, false if the rx
+ * thread can reuse it.
+ *
+ * NOTE: This function MUST NOT contain elog or ereport statements.
+ * elog is NOT thread-safe.
+ */
+static bool
+handleRxPacket(icpkthdr *pkt, int read_count, struct sockaddr_storage *peer,
+			   socklen_t peerlen)
+{
+	MotionConn *conn = NULL;
+
+	if (DEBUG5 >= log_min_messages)
+		write_log("received inbound len %d", read_count);
+
+	if (read_count < sizeof(icpkthdr))
+	{
+		if (DEBUG1 >= log_min_messages)
+			write_log("Interconnect error: short conn receive (%d)", read_count);
+		return false;
+	}
+
+	/* length must be >= 0 */
+	if (pkt->len < 0)
+	{
+		if (DEBUG3 >= log_min_messages)
+			write_log("received inbound with negative length");
+		return false;
+	}
+
+	if (pkt->len != read_count)
+	{
+		if (DEBUG3 >= log_min_messages)
+			write_log("received inbound packet [%d], short: read %d bytes, pkt->len %d", pkt->seq, read_count, pkt->len);
+		return false;
+	}
+
+	/*
+	 * check the CRC of the payload.
+	 */
+	if (gp_interconnect_full_crc)
+	{
+		if (!checkCRC(pkt))
+		{
+			pg_atomic_add_fetch_u32((pg_atomic_uint32 *) &ic_statistics.crcErrors, 1);
+			if (DEBUG2 >= log_min_messages)
+				write_log("received network data error, dropping bad packet, user data unaffected.");
+			return false;
+		}
+	}
+
+#ifdef AMS_VERBOSE_LOGGING
+	logPkt("GOT MESSAGE", pkt);
+#endif
+
+	bool		wakeup_mainthread = false;
+	bool		consumed = false;
+	AckSendParam param;
+
+	memset(&param, 0, sizeof(AckSendParam));
+
+	/*
+	 * Get the connection for the pkt.
+	 *
+	 * The connection hash table should be locked until finishing the
+	 * processing of the packet to avoid the connection
+	 * addition/removal from the hash table during the mean time.
+	 */
+
+	pthread_mutex_lock(&ic_control_info.lock);
+	conn = findConnByHeader(&ic_control_info.connHtab, pkt);
+
+	if (conn != NULL)
+	{
+		/* Handling a regular packet */
+		consumed = handleDataPacket(conn, pkt, peer, &peerlen, &param,
+									&wakeup_mainthread);
+		ic_statistics.recvPktNum++;
+	}
+	else
+	{
+		/*
+		 * There may have two kinds of Mismatched packets: a) Past
+		 * packets from previous command after I was torn down b)
+		 * Future packets from current command before my connections
+		 * are built.
+		 *
+		 * The handling logic is to "Ack the past and Nak the future".
+		 */
+		if ((pkt->flags & UDPIC_FLAGS_RECEIVER_TO_SENDER) == 0)
+		{
+			if (DEBUG1 >= log_min_messages)
+				write_log("mismatched packet received, seq %d, srcpid %d, dstpid %d, icid %d, sid %d", pkt->seq, pkt->srcPid, pkt->dstPid, pkt->icId, pkt->sessionId);
+
+#ifdef AMS_VERBOSE_LOGGING
+			logPkt("Got a Mismatched Packet", pkt);
+#endif
+
+			consumed = handleMismatch(pkt, peer, peerlen);
+			ic_statistics.mismatchNum++;
+		}
+	}
+	pthread_mutex_unlock(&ic_control_info.lock);
+
+	if (wakeup_mainthread)
+		SetLatch(&ic_control_info.latch);
+
+	/*
+	 * real ack sending is after lock release to decrease the lock
+	 * holding time.
+	 */
+	if (param.msg.len != 0)
+		sendAckWithParam(&param);
+
+	return consumed;
+}
+
 /*
  * rxThreadFunc
  * 		Main function of the receive background thread.
  *
+ * The thread holds up to RX_BATCH_SIZE receive buffers, and drains as many
+ * packets as it has buffers for with a single recvmmsg() call, where the
+ * platform has it.
+ *
  * NOTE: This function MUST NOT contain elog or ereport statements.
  * elog is NOT thread-safe.  Developers should instead use something like:
  *
@@ -6133,8 +6373,17 @@ handleDataPacket(MotionConn *conn, icpkthdr *pkt, struct sockaddr_storage *peer,
 static void *
 rxThreadFunc(void *arg)
 {
-	icpkthdr   *pkt = NULL;
+	icpkthdr   *pkts[RX_BATCH_SIZE];
+	struct sockaddr_storage peers[RX_BATCH_SIZE];
+	socklen_t	peerlens[RX_BATCH_SIZE];
+	int			lens[RX_BATCH_SIZE];
+#ifdef HAVE_RECVMMSG
+	struct mmsghdr msgs[RX_BATCH_SIZE];
+	struct iovec iovecs[RX_BATCH_SIZE];
+#endif
+	int			npkts = 0;
 	bool		skip_poll = false;
+	int			i;
 
 	for (;;)
 	{
@@ -6151,14 +6400,21 @@ rxThreadFunc(void *arg)
 			break;
 		}
 
-		/* Try to get a buffer */
-		if (pkt == NULL)
+		/* Try to fill up our batch of buffers, we need at least one */
+		if (npkts < RX_BATCH_SIZE)
 		{
 			pthread_mutex_lock(&ic_control_info.lock);
-			pkt = getRxBuffer(&rx_buffer_pool);
+			while (npkts < RX_BATCH_SIZE)
+			{
+				icpkthdr   *pkt = getRxBuffer(&rx_buffer_pool);
+
+				if (pkt == NULL)
+					break;
+				pkts[npkts++] = pkt;
+			}
 			pthread_mutex_unlock(&ic_control_info.lock);
 
-			if (pkt == NULL)
+			if (npkts == 0)
 			{
 				setRxThreadError(ENOMEM);
 				continue;
@@ -6208,15 +6464,43 @@ rxThreadFunc(void *arg)
 			/* we've got something interesting to read */
 			/* handle incoming */
 			/* ready to read on our socket */
-			MotionConn *conn = NULL;
-			int			read_count = 0;
+			int			nrecv;
+			int			nkept;
 
-			struct sockaddr_storage peer;
-			socklen_t	peerlen;
+#ifdef HAVE_RECVMMSG
+			/*
+			 * The fault injection code only wraps recvfrom(), so stay with it
+			 * in test mode.
+			 */
+			if (npkts > 1 && !UDP_TESTMODE())
+			{
+				for (i = 0; i < npkts; i++)
+				{
+					iovecs[i].iov_base = pkts[i];
+					iovecs[i].iov_len = Gp_max_packet_size;
+					memset(&msgs[i], 0, sizeof(struct mmsghdr));
+					msgs[i].msg_hdr.msg_name = &peers[i];
+					msgs[i].msg_hdr.msg_namelen = sizeof(peers[i]);
+					msgs[i].msg_hdr.msg_iov = &iovecs[i];
+					msgs[i].msg_hdr.msg_iovlen = 1;
+				}
 
-			peerlen = sizeof(peer);
-			read_count = recvfrom(UDP_listenerFd, (char *) pkt, Gp_max_packet_size, 0,
-								  (struct sockaddr *) &peer, &peerlen);
+				/* the socket is non-blocking, so this takes what is queued */
+				nrecv = recvmmsg(UDP_listenerFd, msgs, npkts, 0, NULL);
+				for (i = 0; i < nrecv; i++)
+				{
+					lens[i] = msgs[i].msg_len;
+					peerlens[i] = msgs[i].msg_hdr.msg_namelen;
+				}
+			}
+			else
+#endif
+			{
+				peerlens[0] = sizeof(peers[0]);
+				lens[0] = recvfrom(UDP_listenerFd, (char *) pkts[0], Gp_max_packet_size, 0,
+								   (struct sockaddr *) &peers[0], &peerlens[0]);
+				nrecv = (lens[0] < 0) ? -1 : 1;
+			}
 
 			if (pg_atomic_read_u32(&ic_control_info.shutdown) == 1)
 			{
@@ -6227,10 +6511,7 @@ rxThreadFunc(void *arg)
 				break;
 			}
 
-			if (DEBUG5 >= log_min_messages)
-				write_log("received inbound len %d", read_count);
-
-			if (read_count < 0)
+			if (nrecv < 0)
 			{
 				skip_poll = false;
 
@@ -6251,12 +6532,7 @@ rxThreadFunc(void *arg)
 				continue;
 			}
 
-			if (read_count < sizeof(icpkthdr))
-			{
-				if (DEBUG1 >= log_min_messages)
-					write_log("Interconnect error: short conn receive (%d)", read_count);
-				continue;
-			}
+			pg_atomic_add_fetch_u32((pg_atomic_uint32 *) &ic_statistics.recvSyscallNum, 1);
 
 			/*
 			 * when we get a "good" recvfrom() result, we can skip poll()
@@ -6264,108 +6540,32 @@ rxThreadFunc(void *arg)
 			 */
 			skip_poll = true;
 
-			/* length must be >= 0 */
-			if (pkt->len < 0)
+			for (i = 0; i < nrecv; i++)
 			{
-				if (DEBUG3 >= log_min_messages)
-					write_log("received inbound with negative length");
-				continue;
-			}
-
-			if (pkt->len != read_count)
-			{
-				if (DEBUG3 >= log_min_messages)
-					write_log("received inbound packet [%d], short: read %d bytes, pkt->len %d", pkt->seq, read_count, pkt->len);
-				continue;
+				if (handleRxPacket(pkts[i], lens[i], &peers[i], peerlens[i]))
+					pkts[i] = NULL;
 			}
 
-			/*
-			 * check the CRC of the payload.
-			 */
-			if (gp_interconnect_full_crc)
+			/* keep the buffers that were not handed over for the next round */
+			nkept = 0;
+			for (i = 0; i < npkts; i++)
 			{
-				if (!checkCRC(pkt))
-				{
-					pg_atomic_add_fetch_u32((pg_atomic_uint32 *) &ic_statistics.crcErrors, 1);
-					if (DEBUG2 >= log_min_messages)
-						write_log("received network data error, dropping bad packet, user data unaffected.");
-					continue;
-				}
+				if (pkts[i] != NULL)
+					pkts[nkept++] = pkts[i];
 			}
-
-#ifdef AMS_VERBOSE_LOGGING
-			logPkt("GOT MESSAGE", pkt);
-#endif
-
-			bool		wakeup_mainthread = false;
-			AckSendParam param;
-
-			memset(&param, 0, sizeof(AckSendParam));
-
-			/*
-			 * Get the connection for the pkt.
-			 *
-			 * The connection hash table should be locked until finishing the
-			 * processing of the packet to avoid the connection
-			 * addition/removal from the hash table during the mean time.
-			 */
-
-			pthread_mutex_lock(&ic_control_info.lock);
-			conn = findConnByHeader(&ic_control_info.connHtab, pkt);
-
-			if (conn != NULL)
-			{
-				/* Handling a regular packet */
-				if (handleDataPacket(conn, pkt, &peer, &peerlen, &param, &wakeup_mainthread))
-					pkt = NULL;
-				ic_statistics.recvPktNum++;
-			}
-			else
-			{
-				/*
-				 * There may have two kinds of Mismatched packets: a) Past
-				 * packets from previous command after I was torn down b)
-				 * Future packets from current command before my connections
-				 * are built.
-				 *
-				 * The handling logic is to "Ack the past and Nak the future".
-				 */
-				if ((pkt->flags & UDPIC_FLAGS_RECEIVER_TO_SENDER) == 0)
-				{
-					if (DEBUG1 >= log_min_messages)
-						write_log("mismatched packet received, seq %d, srcpid %d, dstpid %d, icid %d, sid %d", pkt->seq, pkt->srcPid, pkt->dstPid, pkt->icId, pkt->sessionId);
-
-#ifdef AMS_VERBOSE_LOGGING
-					logPkt("Got a Mismatched Packet", pkt);
-#endif
-
-					if (handleMismatch(pkt, &peer, peerlen))
-						pkt = NULL;
-					ic_statistics.mismatchNum++;
-				}
-			}
-			pthread_mutex_unlock(&ic_control_info.lock);
-
-			if (wakeup_mainthread)
-				SetLatch(&ic_control_info.latch);
-
-			/*
-			 * real ack sending is after lock release to decrease the lock
-			 * holding time.
-			 */
-			if (param.msg.len != 0)
-				sendAckWithParam(&param);
+			npkts = nkept;
 		}
 
 		/* pthread_yield(); */
 	}
 
-	/* Before return, we release the packet. */
-	if (pkt)
+	/* Before return, we release the packets. */
+	if (npkts > 0)
 	{
 		pthread_mutex_lock(&ic_control_info.lock);
-		freeRxBuffer(&rx_buffer_pool, pkt);
-		pkt = NULL;
+		for (i = 0; i < npkts; i++)
+			freeRxBuffer(&rx_buffer_pool, pkts[i]);
+		npkts = 0;
 		pthread_mutex_unlock(&ic_control_info.lock);
 	}
 
@@ -0,0 +1,829 @@
+/*-------------------------------------------------------------------------
+ * tupbatch.c
+ *	   Columnar batches of tuples for Motion.
+ *
+ * The sender collects the values of each column of the tuples of a batch
+ * one after another.  When the batch is full, every column is encoded with
+ * the smallest of three encodings:
+ *
+ *	PLAIN	the values one after another.
+ *	RLE		runs of equal values: the length of each run, and its value once.
+ *	DICT	up to 256 distinct values, and a one byte code for each value.
+ *
+ * NULLs are kept in a bitmap per column, and are not part of the values.
+ * The encoded columns are then compressed as a whole with zstd, if the
+ * server is built with it and that makes the batch smaller.
+ *
+ * Values are stored in the same format as in a heap tuple, so that the
+ * receiver can form tuples from pointers into the batch.  Varlenas are
+ * converted to short headers where possible, and the ones with a 4-byte
+ * header are int-aligned by zero padding, like att_align_pointer()
+ * expects.  The padding is relative to the start of the buffer, so all
+ * buffers holding values are palloc'd, and copies keep their offsets.
+ *
+ * Portions Copyright (c) 2012-Present VMware, Inc. or its affiliates.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/backend/cdb/motion/tupbatch.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/tupmacs.h"
+#include "access/tuptoaster.h"
+#include "cdb/tupbatch.h"
+#include "cdb/tupser.h"
+#include "utils/hashutils.h"
+#include "utils/memutils.h"
+
+#ifdef USE_ZSTD
+#include <zstd.h>
+
+/* zstd compression level to use; batches are compressed for speed. */
+#define TUPLE_BATCH_COMPRESS_LEVEL	1
+#endif
+
+/* Batches smaller than this are not worth compressing. */
+#define TUPLE_BATCH_MIN_COMPRESS	1024
+
+/* How the values of a column are encoded. */
+typedef enum TupleBatchEncoding
+{
+	TB_PLAIN,
+	TB_RLE,
+	TB_DICT
+} TupleBatchEncoding;
+
+/* Max number of distinct values of a DICT encoded column. */
+#define TB_DICT_MAX_ENTRIES		256
+/* Size of the hash table used to find the distinct values; a power of 2. */
+#define TB_DICT_HASH_SIZE		(2 * TB_DICT_MAX_ENTRIES)
+
+/*
+ * Header of an encoded column.  It is followed by the null bitmap, if the
+ * column has NULLs, then the run lengths (RLE) or the codes (DICT), and then,
+ * MAXALIGNed, the values.
+ */
+typedef struct TupleBatchColumnHeader
+{
+	uint8		encoding;		/* a TupleBatchEncoding */
+	bool		hasnulls;
+	uint16		unused;
+	int32		nvalues;		/* number of non-NULL values */
+	int32		nentries;		/* number of runs (RLE) or entries (DICT) */
+	int32		len;			/* length of the column, header included */
+} TupleBatchColumnHeader;
+
+/* Values of one column collected by the sender. */
+typedef struct TupleBatchColumn
+{
+	StringInfoData values;		/* the non-NULL values */
+	int			nvalues;
+	bits8	   *nulls;			/* a bit is set for each NULL */
+	int			nullsSize;		/* allocated size of nulls */
+} TupleBatchColumn;
+
+struct TupleBatchBuilder
+{
+	SerTupInfo *serInfo;
+	MemoryContext mcxt;
+	int			ntuples;
+	Size		datasize;		/* bytes of collected values */
+	TupleBatchColumn *columns;
+
+	StringInfoData raw;			/* the encoded batch, before compression */
+
+	/* Scratch space to encode a column, for up to scratchSize values */
+	int			scratchSize;
+	int32	   *runLengths;
+	const char **runValues;
+	uint8	   *codes;
+	uint16		dictHash[TB_DICT_HASH_SIZE];
+	const char *dictValues[TB_DICT_MAX_ENTRIES];
+	int			dictLens[TB_DICT_MAX_ENTRIES];
+};
+
+/* State to decode one column of a batch. */
+typedef struct TupleBatchColumnReader
+{
+	uint8		encoding;
+	const bits8 *nulls;			/* NULL if the column has no NULLs */
+	const int32 *runLengths;	/* RLE */
+	const uint8 *codes;			/* DICT */
+	const char *next;			/* next value (PLAIN) or run value (RLE) */
+	int			run;			/* current run (RLE) */
+	int			runLeft;		/* values left in the current run (RLE) */
+	Datum		runValue;		/* value of the current run (RLE) */
+	Datum	   *dict;			/* decoded dictionary (DICT) */
+	int			value;			/* index of the next non-NULL value */
+} TupleBatchColumnReader;
+
+struct TupleBatchReader
+{
+	SerTupInfo *serInfo;
+	MemoryContext mcxt;
+	int			ntuples;
+	int			nextTuple;
+
+	char	   *data;			/* received data, maybe compressed */
+	int			len;
+	int			rawlen;			/* length of the decompressed data */
+
+	/* Set up on the first fetch */
+	char	   *raw;
+	TupleBatchColumnReader *columns;
+};
+
+static void batch_encode_column(TupleBatchBuilder *builder, int attno);
+static void batch_init_reader(TupleBatchReader *reader);
+
+/*
+ * Skip the padding in front of a value, see the file header comment.  A
+ * short varlena header is never zero, so a zero byte at an unaligned offset
+ * must be padding.
+ */
+static inline const char *
+batch_value_align(SerAttrInfo *attr, const char *p)
+{
+	if (attr->typlen == -1 && *(const uint8 *) p == 0)
+		p = (const char *) INTALIGN((uintptr_t) p);
+	return p;
+}
+
+static inline int
+batch_value_size(SerAttrInfo *attr, const char *p)
+{
+	if (attr->typlen > 0)
+		return attr->typlen;
+	else if (attr->typlen == -1)
+		return VARSIZE_ANY(p);
+	else
+		return strlen(p) + 1;
+}
+
+/* Append the image of a value, padding it as needed. */
+static inline void
+batch_append_value(StringInfo buf, SerAttrInfo *attr, const char *p, int len)
+{
+	if (attr->typlen == -1 && !VARATT_IS_SHORT(p))
+	{
+		while (buf->len != INTALIGN(buf->len))
+			appendStringInfoCharMacro(buf, '\0');
+	}
+	appendBinaryStringInfo(buf, p, len);
+}
+
+/* Append a value of a tuple, in the format it has in a heap tuple. */
+static void
+batch_append_datum(StringInfo buf, SerAttrInfo *attr, Datum value)
+{
+	if (attr->typbyval)
+	{
+		Datum		image;
+
+		store_att_byval(&image, value, attr->typlen);
+		appendBinaryStringInfo(buf, (char *) &image, attr->typlen);
+	}
+	else if (attr->typlen > 0)
+		appendBinaryStringInfo(buf, DatumGetPointer(value), attr->typlen);
+	else if (attr->typlen == -1)
+	{
+		struct varlena *val = (struct varlena *) DatumGetPointer(value);
+		struct varlena *fetched = NULL;
+
+		if (VARATT_IS_EXTERNAL(val))
+			val = fetched = heap_tuple_fetch_attr(val);
+
+		if (VARATT_CAN_MAKE_SHORT(val))
+		{
+			uint8		hdr;
+
+			SET_VARSIZE_SHORT(&hdr, VARATT_CONVERTED_SHORT_SIZE(val));
+			appendStringInfoCharMacro(buf, (char) hdr);
+			appendBinaryStringInfo(buf, VARDATA(val), VARSIZE(val) - VARHDRSZ);
+		}
+		else
+			batch_append_value(buf, attr, (char *) val, VARSIZE_ANY(val));
+
+		if (fetched)
+			pfree(fetched);
+	}
+	else
+	{
+		char	   *str = DatumGetCString(value);
+
+		appendBinaryStringInfo(buf, str, strlen(str) + 1);
+	}
+}
+
+/* Decode the value at *pp, and advance *pp past it. */
+static inline Datum
+batch_fetch_value(SerAttrInfo *attr, const char **pp)
+{
+	const char *p = batch_value_align(attr, *pp);
+	Datum		value;
+
+	if (attr->typbyval)
+	{
+		switch (attr->typlen)
+		{
+			case sizeof(char):
+				value = CharGetDatum(*p);
+				break;
+			case sizeof(int16):
+				{
+					int16		v;
+
+					memcpy(&v, p, sizeof(int16));
+					value = Int16GetDatum(v);
+				}
+				break;
+			case sizeof(int32):
+				{
+					int32		v;
+
+					memcpy(&v, p, sizeof(int32));
+					value = Int32GetDatum(v);
+				}
+				break;
+#if SIZEOF_DATUM == 8
+			case sizeof(Datum):
+				memcpy(&value, p, sizeof(Datum));
+				break;
+#endif
+			default:
+				elog(ERROR, "unsupported byval length: %d", (int) attr->typlen);
+		}
+	}
+	else
+		value = PointerGetDatum(p);
+
+	*pp = p + batch_value_size(attr, p);
+	return value;
+}
+
+/*
+ * Create a builder for batches of tuples described by pSerInfo, in the
+ * current memory context.
+ */
+TupleBatchBuilder *
+TupleBatchCreateBuilder(SerTupInfo *pSerInfo)
+{
+	TupleBatchBuilder *builder;
+	int			natts = pSerInfo->tupdesc->natts;
+
+	builder = palloc0(sizeof(TupleBatchBuilder));
+	builder->serInfo = pSerInfo;
+	builder->mcxt = CurrentMemoryContext;
+	builder->columns = palloc0(natts * sizeof(TupleBatchColumn));
+	for (int i = 0; i < natts; i++)
+		initStringInfo(&builder->columns[i].values);
+	initStringInfo(&builder->raw);
+
+	return builder;
+}
+
+/* Add the tuple in a slot to the batch. */
+void
+TupleBatchAddTuple(TupleBatchBuilder *builder, TupleTableSlot *slot)
+{
+	int			natts = builder->serInfo->tupdesc->natts;
+	int			row = builder->ntuples;
+
+	slot_getallattrs(slot);
+
+	for (int i = 0; i < natts; i++)
+	{
+		TupleBatchColumn *col = &builder->columns[i];
+
+		if (slot->tts_isnull[i])
+		{
+			if (col->nullsSize <= row / 8)
+			{
+				int			newSize = Max(64, Max(col->nullsSize * 2, row / 8 + 1));
+
+				if (col->nulls == NULL)
+					col->nulls = MemoryContextAllocZero(builder->mcxt, newSize);
+				else
+				{
+					col->nulls = repalloc(col->nulls, newSize);
+					memset(col->nulls + col->nullsSize, 0,
+						   newSize - col->nullsSize);
+				}
+				col->nullsSize = newSize;
+			}
+			col->nulls[row / 8] |= (1 << (row % 8));
+		}
+		else
+		{
+			int			oldlen = col->values.len;
+
+			batch_append_datum(&col->values, &builder->serInfo->myinfo[i],
+							   slot->tts_values[i]);
+			builder->datasize += col->values.len - oldlen;
+			col->nvalues++;
+		}
+	}
+
+	builder->ntuples++;
+}
+
+int
+TupleBatchNumTuples(TupleBatchBuilder *builder)
+{
+	return builder->ntuples;
+}
+
+Size
+TupleBatchDataSize(TupleBatchBuilder *builder)
+{
+	return builder->datasize;
+}
+
+/*
+ * Encode the collected tuples, append the result to buf, and empty the
+ * builder for the next batch.
+ *
+ * *rawlen is set to the length of the encoded batch before compression.
+ * If it equals the number of bytes appended, the batch is not compressed.
+ */
+void
+TupleBatchEncode(TupleBatchBuilder *builder, StringInfo buf, int *rawlen)
+{
+	int			natts = builder->serInfo->tupdesc->natts;
+
+	if (builder->scratchSize < builder->ntuples)
+	{
+		if (builder->runLengths)
+		{
+			pfree(builder->runLengths);
+			pfree(builder->runValues);
+			pfree(builder->codes);
+		}
+		builder->scratchSize = Max(builder->ntuples, 1024);
+		builder->runLengths = MemoryContextAlloc(builder->mcxt,
+												 builder->scratchSize * sizeof(int32));
+		builder->runValues = MemoryContextAlloc(builder->mcxt,
+												builder->scratchSize * sizeof(char *));
+		builder->codes = MemoryContextAlloc(builder->mcxt, builder->scratchSize);
+	}
+
+	resetStringInfo(&builder->raw);
+	for (int i = 0; i < natts; i++)
+		batch_encode_column(builder, i);
+
+	*rawlen = builder->raw.len;
+
+#ifdef USE_ZSTD
+	if (builder->raw.len >= TUPLE_BATCH_MIN_COMPRESS)
+	{
+		static ZSTD_CCtx *cxt = NULL;	/* ZSTD compression context */
+		size_t		bound = ZSTD_compressBound(builder->raw.len);
+		size_t		compressed;
+
+		if (!cxt)
+		{
+			cxt = ZSTD_createCCtx();
+			if (!cxt)
+				elog(ERROR, "out of memory");
+		}
+
+		enlargeStringInfo(buf, bound);
+		compressed = ZSTD_compressCCtx(cxt,
+									   buf->data + buf->len, bound,
+									   builder->raw.data, builder->raw.len,
+									   TUPLE_BATCH_COMPRESS_LEVEL);
+		if (ZSTD_isError(compressed))
+			elog(ERROR, "Compression failed: %s uncompressed len %d",
+				 ZSTD_getErrorName(compressed), builder->raw.len);
+
+		if (compressed < builder->raw.len)
+		{
+			buf->len += compressed;
+			buf->data[buf->len] = '\0';
+			goto done;
+		}
+	}
+#endif
+
+	appendBinaryStringInfo(buf, builder->raw.data, builder->raw.len);
+
+#ifdef USE_ZSTD
+done:
+#endif
+	/* Empty the builder. */
+	for (int i = 0; i < natts; i++)
+	{
+		TupleBatchColumn *col = &builder->columns[i];
+
+		resetStringInfo(&col->values);
+		col->nvalues = 0;
+		if (col->nulls)
+			memset(col->nulls, 0, col->nullsSize);
+	}
+	builder->ntuples = 0;
+	builder->datasize = 0;
+}
+
+/*
+ * Encode one column at the end of builder->raw.
+ */
+static void
+batch_encode_column(TupleBatchBuilder *builder, int attno)
+{
+	TupleBatchColumn *col = &builder->columns[attno];
+	SerAttrInfo *attr = &builder->serInfo->myinfo[attno];
+	TupleBatchColumnHeader hdr;
+	StringInfo	raw = &builder->raw;
+	const char *p = col->values.data;
+	const char *end = col->values.data + col->values.len;
+	const char *prev = NULL;
+	int			prevlen = 0;
+	int			nruns = 0;
+	int			ndict = 0;
+	bool		dictok = true;
+	Size		rlesize = 0;
+	Size		dictsize = 0;
+	Size		plainsize = col->values.len;
+	int			start;
+	int			i = 0;
+
+	memset(builder->dictHash, 0, sizeof(builder->dictHash));
+
+	/* Find the runs and the distinct values. */
+	while (p < end)
+	{
+		int			len;
+
+		p = batch_value_align(attr, p);
+		len = batch_value_size(attr, p);
+
+		if (prev && len == prevlen && memcmp(prev, p, len) == 0)
+			builder->runLengths[nruns - 1]++;
+		else
+		{
+			builder->runLengths[nruns] = 1;
+			builder->runValues[nruns] = p;
+			nruns++;
+			rlesize += sizeof(int32) + len;
+			prev = p;
+			prevlen = len;
+		}
+
+		if (dictok)
+		{
+			uint32		h = DatumGetUInt32(hash_any((const unsigned char *) p, len)) &
+				(TB_DICT_HASH_SIZE - 1);
+
+			for (;;)
+			{
+				int			entry = builder->dictHash[h];
+
+				if (entry == 0)
+				{
+					if (ndict == TB_DICT_MAX_ENTRIES)
+					{
+						dictok = false;
+						break;
+					}
+					builder->dictValues[ndict] = p;
+					builder->dictLens[ndict] = len;
+					builder->dictHash[h] = ++ndict;
+					builder->codes[i] = ndict - 1;
+					dictsize += len;
+					break;
+				}
+				if (builder->dictLens[entry - 1] == len &&
+					memcmp(builder->dictValues[entry - 1], p, len) == 0)
+				{
+					builder->codes[i] = entry - 1;
+					break;
+				}
+				h = (h + 1) & (TB_DICT_HASH_SIZE - 1);
+			}
+		}
+
+		p += len;
+		i++;
+	}
+	Assert(i == col->nvalues);
+	dictsize += col->nvalues;
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.hasnulls = (col->nvalues < builder->ntuples);
+	hdr.nvalues = col->nvalues;
+	if (nruns > 0 && rlesize < plainsize && (!dictok || rlesize <= dictsize))
+	{
+		hdr.encoding = TB_RLE;
+		hdr.nentries = nruns;
+	}
+	else if (ndict > 0 && dictok && dictsize < plainsize)
+	{
+		hdr.encoding = TB_DICT;
+		hdr.nentries = ndict;
+	}
+	else
+		hdr.encoding = TB_PLAIN;
+
+	/* Every column starts MAXALIGNed. */
+	while (raw->len != MAXALIGN(raw->len))
+		appendStringInfoCharMacro(raw, '\0');
+	start = raw->len;
+	appendBinaryStringInfo(raw, (char *) &hdr, sizeof(hdr));
+
+	if (hdr.hasnulls)
+	{
+		int			nullsLen = BITMAPLEN(builder->ntuples);
+		int			copyLen = Min(nullsLen, col->nullsSize);
+
+		appendBinaryStringInfo(raw, (char *) col->nulls, copyLen);
+		for (; copyLen < nullsLen; copyLen++)
+			appendStringInfoCharMacro(raw, '\0');
+	}
+
+	while (raw->len != INTALIGN(raw->len))
+		appendStringInfoCharMacro(raw, '\0');
+
+	if (hdr.encoding == TB_RLE)
+		appendBinaryStringInfo(raw, (char *) builder->runLengths,
+							   nruns * sizeof(int32));
+	else if (hdr.encoding == TB_DICT)
+		appendBinaryStringInfo(raw, (char *) builder->codes, col->nvalues);
+
+	/*
+	 * The values start MAXALIGNed, so that the padding of the collected
+	 * values still holds when they are copied as a whole.
+	 */
+	while (raw->len != MAXALIGN(raw->len))
+		appendStringInfoCharMacro(raw, '\0');
+
+	switch (hdr.encoding)
+	{
+		case TB_PLAIN:
+			appendBinaryStringInfo(raw, col->values.data, col->values.len);
+			break;
+		case TB_RLE:
+			for (int r = 0; r < nruns; r++)
+				batch_append_value(raw, attr, builder->runValues[r],
+								   batch_value_size(attr, builder->runValues[r]));
+			break;
+		case TB_DICT:
+			for (int d = 0; d < ndict; d++)
+				batch_append_value(raw, attr, builder->dictValues[d],
+								   builder->dictLens[d]);
+			break;
+	}
+
+	hdr.len = raw->len - start;
+	memcpy(raw->data + start, &hdr, sizeof(hdr));
+}
+
+/*
+ * Create a reader for a received batch of ntuples tuples.  The data is
+ * copied, and only decompressed once the first tuple is fetched.
+ */
+TupleBatchReader *
+TupleBatchCreateReader(SerTupInfo *pSerInfo, const char *data, int len,
+					   int ntuples, int rawlen)
+{
+	TupleBatchReader *reader;
+
+	if (ntuples <= 0 || len <= 0 || rawlen < len)
+		ereport(ERROR,
+				(errcode(ERRCODE_PROTOCOL_VIOLATION),
+				 errmsg("invalid tuple batch: %d tuples, %d bytes, %d bytes decompressed",
+						ntuples, len, rawlen)));
+
+	reader = palloc0(sizeof(TupleBatchReader));
+	reader->serInfo = pSerInfo;
+	reader->mcxt = CurrentMemoryContext;
+	reader->ntuples = ntuples;
+	reader->len = len;
+	reader->rawlen = rawlen;
+	reader->data = palloc(len);
+	memcpy(reader->data, data, len);
+
+	return reader;
+}
+
+int
+TupleBatchReaderNumTuples(TupleBatchReader *reader)
+{
+	return reader->ntuples;
+}
+
+/*
+ * Return the length of the batch as received, and set *rawlen to its length
+ * once decompressed.
+ */
+int
+TupleBatchReaderDataSize(TupleBatchReader *reader, int *rawlen)
+{
+	*rawlen = reader->rawlen;
+	return reader->len;
+}
+
+/*
+ * Decompress the batch, and set up the column readers.
+ */
+static void
+batch_init_reader(TupleBatchReader *reader)
+{
+	int			natts = reader->serInfo->tupdesc->natts;
+	MemoryContext oldcxt = MemoryContextSwitchTo(reader->mcxt);
+	const char *p;
+	const char *end;
+
+	if (reader->len == reader->rawlen)
+	{
+		reader->raw = reader->data;
+		reader->data = NULL;
+	}
+	else
+	{
+#ifdef USE_ZSTD
+		static ZSTD_DCtx *cxt = NULL;	/* ZSTD decompression context */
+		size_t		decompressed;
+
+		if (!cxt)
+		{
+			cxt = ZSTD_createDCtx();
+			if (!cxt)
+				elog(ERROR, "out of memory");
+		}
+
+		reader->raw = palloc(reader->rawlen);
+		decompressed = ZSTD_decompressDCtx(cxt,
+										   reader->raw, reader->rawlen,
+										   reader->data, reader->len);
+		if (ZSTD_isError(decompressed))
+			elog(ERROR, "%s", ZSTD_getErrorName(decompressed));
+		if (decompressed != reader->rawlen)
+			ereport(ERROR,
+					(errcode(ERRCODE_PROTOCOL_VIOLATION),
+					 errmsg("tuple batch decompressed to %d bytes, expected %d",
+							(int) decompressed, reader->rawlen)));
+
+		pfree(reader->data);
+		reader->data = NULL;
+#else
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("received a compressed tuple batch, but this server was built without zstd support")));
+#endif
+	}
+
+	reader->columns = palloc0(natts * sizeof(TupleBatchColumnReader));
+
+	p = reader->raw;
+	end = reader->raw + reader->rawlen;
+	for (int i = 0; i < natts; i++)
+	{
+		TupleBatchColumnReader *col = &reader->columns[i];
+		SerAttrInfo *attr = &reader->serInfo->myinfo[i];
+		TupleBatchColumnHeader hdr;
+		const char *colstart;
+		const char *q;
+
+		p = (const char *) reader->raw + MAXALIGN(p - reader->raw);
+		if (p + sizeof(hdr) > end)
+			ereport(ERROR,
+					(errcode(ERRCODE_PROTOCOL_VIOLATION),
+					 errmsg("tuple batch is too short for column %d", i + 1)));
+		memcpy(&hdr, p, sizeof(hdr));
+		if (hdr.len < (int) sizeof(hdr) || p + hdr.len > end)
+			ereport(ERROR,
+					(errcode(ERRCODE_PROTOCOL_VIOLATION),
+					 errmsg("invalid length %d of column %d in tuple batch", hdr.len, i + 1)));
+
+		colstart = p;
+		q = p + sizeof(hdr);
+		col->encoding = hdr.encoding;
+		if (hdr.hasnulls)
+		{
+			col->nulls = (const bits8 *) q;
+			q += BITMAPLEN(reader->ntuples);
+		}
+		q = (const char *) reader->raw + INTALIGN(q - reader->raw);
+
+		switch (hdr.encoding)
+		{
+			case TB_PLAIN:
+				break;
+			case TB_RLE:
+				col->runLengths = (const int32 *) q;
+				q += hdr.nentries * sizeof(int32);
+				break;
+			case TB_DICT:
+				col->codes = (const uint8 *) q;
+				q += hdr.nvalues;
+				break;
+			default:
+				ereport(ERROR,
+						(errcode(ERRCODE_PROTOCOL_VIOLATION),
+						 errmsg("invalid encoding %d of column %d in tuple batch",
+								hdr.encoding, i + 1)));
+		}
+		q = (const char *) reader->raw + MAXALIGN(q - reader->raw);
+		col->next = q;
+
+		if (hdr.encoding == TB_DICT)
+		{
+			col->dict = palloc(hdr.nentries * sizeof(Datum));
+			for (int d = 0; d < hdr.nentries; d++)
+				col->dict[d] = batch_fetch_value(attr, &col->next);
+		}
+
+		p = colstart + hdr.len;
+	}
+
+	MemoryContextSwitchTo(oldcxt);
+}
+
+/*
+ * Form the next tuple of the batch, in the memory context the reader was
+ * created in.
+ *
+ * Returns NULL once all tuples have been fetched.
+ */
+MinimalTuple
+TupleBatchNext(TupleBatchReader *reader)
+{
+	SerTupInfo *serInfo = reader->serInfo;
+	int			natts = serInfo->tupdesc->natts;
+	MemoryContext oldcxt;
+	MinimalTuple tup;
+	int			row;
+
+	if (reader->nextTuple >= reader->ntuples)
+		return NULL;
+
+	if (reader->columns == NULL)
+		batch_init_reader(reader);
+
+	row = reader->nextTuple++;
+	for (int i = 0; i < natts; i++)
+	{
+		TupleBatchColumnReader *col = &reader->columns[i];
+		SerAttrInfo *attr = &serInfo->myinfo[i];
+
+		if (col->nulls && (col->nulls[row / 8] & (1 << (row % 8))))
+		{
+			serInfo->values[i] = (Datum) 0;
+			serInfo->nulls[i] = true;
+			continue;
+		}
+
+		serInfo->nulls[i] = false;
+		switch (col->encoding)
+		{
+			case TB_PLAIN:
+				serInfo->values[i] = batch_fetch_value(attr, &col->next);
+				break;
+			case TB_RLE:
+				if (col->runLeft == 0)
+				{
+					col->runValue = batch_fetch_value(attr, &col->next);
+					col->runLeft = col->runLengths[col->run++];
+				}
+				col->runLeft--;
+				serInfo->values[i] = col->runValue;
+				break;
+			case TB_DICT:
+				serInfo->values[i] = col->dict[col->codes[col->value]];
+				break;
+		}
+		col->value++;
+	}
+
+	oldcxt = MemoryContextSwitchTo(reader->mcxt);
+	tup = heap_form_minimal_tuple(serInfo->tupdesc, serInfo->values,
+								  serInfo->nulls);
+	MemoryContextSwitchTo(oldcxt);
+
+	return tup;
+}
+
+/* Free a batch reader, and the batch data. */
+void
+TupleBatchFreeReader(TupleBatchReader *reader)
+{
+	if (reader->columns)
+	{
+		int			natts = reader->serInfo->tupdesc->natts;
+
+		for (int i = 0; i < natts; i++)
+		{
+			if (reader->columns[i].dict)
+				pfree(reader->columns[i].dict);
+		}
+		pfree(reader->columns);
+	}
+	if (reader->raw)
+		pfree(reader->raw);
+	if (reader->data)
+		pfree(reader->data);
+	pfree(reader);
+}
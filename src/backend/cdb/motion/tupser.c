@@ -21,6 +21,7 @@
 #include "catalog/pg_type.h"
 #include "cdb/cdbmotion.h"
 #include "cdb/cdbsrlz.h"
+#include "cdb/tupbatch.h"
 #include "cdb/tupser.h"
 #include "cdb/cdbvars.h"
 #include "libpq/pqformat.h"
@@ -39,6 +40,13 @@
  */
 #define RECORD_CACHE_MAGIC_TUPLEN	-1
 
+/*
+ * Likewise, a columnar batch of tuples (see tupbatch.c) is sent with its own
+ * "tuple length", followed by the number of tuples in the batch, the length
+ * of the encoded batch before compression, and the length of the data.
+ */
+#define TUPLE_BATCH_MAGIC_TUPLEN	-2
+
 /* A MemoryContext used within the tuple serialize code, so that freeing of
  * space is SUPAFAST.  It is initialized in the first call to InitSerTupInfo()
  * since that must be called before any tuple serialization or deserialization
@@ -349,6 +357,75 @@ SerializeRecordCacheIntoChunks(SerTupInfo *pSerInfo,
 	return;
 }
 
+/*
+ * Encode the tuples collected in a TupleBatchBuilder, and store the batch
+ * into a chunklist for transmission.  The builder is emptied.
+ */
+void
+SerializeTupleBatch(TupleBatchBuilder *builder, SerTupInfo *pSerInfo,
+					TupleChunkList tcList)
+{
+	TupleChunkListItem tcItem;
+	StringInfoData buf;
+	int			header[4];
+
+	AssertArg(tcList != NULL);
+	AssertArg(pSerInfo != NULL);
+	AssertArg(TupleBatchNumTuples(builder) > 0);
+
+	/* get ready to go */
+	tcList->p_first = NULL;
+	tcList->p_last = NULL;
+	tcList->num_chunks = 0;
+	tcList->serialized_data_length = 0;
+	tcList->max_chunk_length = Gp_max_tuple_chunk_size;
+
+	tcItem = getChunkFromCache(&pSerInfo->chunkCache);
+
+	/* assume that we'll take a single chunk */
+	SetChunkType(tcItem->chunk_data, TC_WHOLE);
+	tcItem->chunk_length = TUPLE_CHUNK_HEADER_SIZE;
+	appendChunkToTCList(tcList, tcItem);
+
+	/* Leave room for the header, and fill it in once the batch is encoded. */
+	initStringInfo(&buf);
+	appendBinaryStringInfo(&buf, (char *) header, sizeof(header));
+
+	header[0] = TUPLE_BATCH_MAGIC_TUPLEN;
+	header[1] = TupleBatchNumTuples(builder);
+	TupleBatchEncode(builder, &buf, &header[2]);
+	header[3] = buf.len - sizeof(header);
+	memcpy(buf.data, header, sizeof(header));
+
+	addByteStringToChunkList(tcList, buf.data, buf.len, &pSerInfo->chunkCache);
+	pfree(buf.data);
+
+	/*
+	 * if we have more than 1 chunk we have to set the chunk types on our
+	 * first chunk and last chunk
+	 */
+	if (tcList->num_chunks > 1)
+	{
+		TupleChunkListItem first,
+					last;
+
+		first = tcList->p_first;
+		last = tcList->p_last;
+
+		Assert(first != NULL);
+		Assert(first != last);
+		Assert(last != NULL);
+
+		SetChunkType(first->chunk_data, TC_PARTIAL_START);
+		SetChunkType(last->chunk_data, TC_PARTIAL_END);
+
+		/*
+		 * any intervening chunks are already set to TC_PARTIAL_MID when
+		 * allocated
+		 */
+	}
+}
+
 static bool
 CandidateForSerializeDirect(int16 targetRoute, struct directTransportBuffer *b)
 {
@@ -540,9 +617,14 @@ SerializeTuple(TupleTableSlot *slot, SerTupInfo *pSerInfo, struct directTranspor
 
 /*
  * Reassemble and deserialize a list of tuple chunks, into a tuple.
+ *
+ * If the chunks carry a batch of tuples, NULL is returned, and *batch is set
+ * to a reader for the batch.  The tuples are only decoded when they are
+ * fetched from the reader.
  */
 MinimalTuple
-CvtChunksToTup(TupleChunkList tcList, SerTupInfo *pSerInfo, TupleRemapper *remapper)
+CvtChunksToTup(TupleChunkList tcList, SerTupInfo *pSerInfo, TupleRemapper *remapper,
+			   TupleBatchReader **batch)
 {
 	StringInfoData serData;
 	bool		serDataMustFree;
@@ -555,6 +637,8 @@ CvtChunksToTup(TupleChunkList tcList, SerTupInfo *pSerInfo, TupleRemapper *remap
 	AssertArg(tcList->p_first != NULL);
 	AssertArg(pSerInfo != NULL);
 
+	*batch = NULL;
+
 	/*
 	 * Parse the first chunk, and reassemble the chunks if needed.
 	 */
@@ -694,6 +778,34 @@ CvtChunksToTup(TupleChunkList tcList, SerTupInfo *pSerInfo, TupleRemapper *remap
 
 			return NULL;
 		}
+		else if (tupbodylen == TUPLE_BATCH_MAGIC_TUPLEN)
+		{
+			/* a batch of tuples */
+			int			header[3];
+
+			if (serData.len < sizeof(tupbodylen) + sizeof(header))
+				ereport(ERROR,
+						(errcode(ERRCODE_PROTOCOL_VIOLATION),
+						 errmsg("tuple batch is too short")));
+
+			memcpy(header, pos, sizeof(header));
+			pos += sizeof(header);
+
+			if (header[2] != serData.len - (pos - serData.data))
+				ereport(ERROR,
+						(errcode(ERRCODE_PROTOCOL_VIOLATION),
+						 errmsg("tuple batch length %d does not match received length %d",
+								header[2], (int) (serData.len - (pos - serData.data)))));
+
+			*batch = TupleBatchCreateReader(pSerInfo, pos, header[2],
+											header[0], header[1]);
+
+			/* Free up memory we used. */
+			if (serDataMustFree)
+				pfree(serData.data);
+
+			return NULL;
+		}
 		else
 		{
 			/* A normal MinimalTuple */
@@ -0,0 +1,158 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+
+#include "cmockery.h"
+
+#include "../cdbutil.c"
+
+#define NUM_IDLE_QES 4
+
+static CdbComponentDatabases *s_cdbs;
+
+/*
+ * Make a component database set with one segment, that has NUM_IDLE_QES idle
+ * QEs, the writer first, as in the freelist of a session that ran queries.
+ */
+static void
+setup(void **state)
+{
+	CdbComponentDatabaseInfo *cdi;
+
+	CdbComponentsContext = CurrentMemoryContext;
+
+	s_cdbs = palloc0(sizeof(CdbComponentDatabases));
+	s_cdbs->total_segment_dbs = 1;
+	s_cdbs->segment_db_info = palloc0(sizeof(CdbComponentDatabaseInfo));
+
+	cdi = &s_cdbs->segment_db_info[0];
+	cdi->cdbs = s_cdbs;
+	for (int i = 0; i < NUM_IDLE_QES; i++)
+	{
+		SegmentDatabaseDescriptor *segdbDesc = palloc0(sizeof(SegmentDatabaseDescriptor));
+
+		segdbDesc->segment_database_info = cdi;
+		segdbDesc->isWriter = (i == 0);
+		cdi->freelist = lappend(cdi->freelist, segdbDesc);
+		INCR_COUNT(cdi, numIdleQEs);
+	}
+
+	cdb_component_dbs = s_cdbs;
+}
+
+static void
+teardown(void **state)
+{
+	cdb_component_dbs = NULL;
+	CdbComponentsContext = NULL;
+}
+
+#define test_with_setup_and_teardown(test_func) \
+	unit_test_setup_teardown(test_func, setup, teardown)
+
+/* expect the idle QEs from the given position of the freelist on to go */
+static void
+expect_release_from(int first)
+{
+	CdbComponentDatabaseInfo *cdi = &s_cdbs->segment_db_info[0];
+
+	for (int i = first; i < list_length(cdi->freelist); i++)
+	{
+		expect_value(cdbconn_termSegmentDescriptor, segdbDesc,
+					 list_nth(cdi->freelist, i));
+		will_be_called(cdbconn_termSegmentDescriptor);
+	}
+}
+
+static void
+assert_idle_qes(int numIdleQEs)
+{
+	CdbComponentDatabaseInfo *cdi = &s_cdbs->segment_db_info[0];
+
+	assert_int_equal(cdi->numIdleQEs, numIdleQEs);
+	assert_int_equal(s_cdbs->numIdleQEs, numIdleQEs);
+	assert_int_equal(list_length(cdi->freelist), numIdleQEs);
+}
+
+static void
+test__cdbcomponent_cleanupIdleQEs_ReleasesAllQEs(void **state)
+{
+	expect_release_from(0);
+
+	cdbcomponent_cleanupIdleQEs(true);
+
+	assert_idle_qes(0);
+}
+
+static void
+test__cdbcomponent_cleanupIdleQEs_KeepsTheWriter(void **state)
+{
+	expect_release_from(1);
+
+	cdbcomponent_cleanupIdleQEs(false);
+
+	assert_idle_qes(1);
+	assert_true(((SegmentDatabaseDescriptor *)
+				 linitial(s_cdbs->segment_db_info[0].freelist))->isWriter);
+}
+
+static void
+test__cdbcomponent_shrinkIdleQEs_ReleasesAShareEachRound(void **state)
+{
+	/*
+	 * With three rounds to go, each round keeps ceil(n * r / (r + 1)) of the
+	 * n idle QEs, so one QE goes per round, the ones reused last first.
+	 */
+	expect_release_from(3);
+	cdbcomponent_shrinkIdleQEs(true, 3);
+	assert_idle_qes(3);
+
+	expect_release_from(2);
+	cdbcomponent_shrinkIdleQEs(true, 2);
+	assert_idle_qes(2);
+
+	expect_release_from(1);
+	cdbcomponent_shrinkIdleQEs(true, 1);
+	assert_idle_qes(1);
+	assert_true(((SegmentDatabaseDescriptor *)
+				 linitial(s_cdbs->segment_db_info[0].freelist))->isWriter);
+
+	expect_release_from(0);
+	cdbcomponent_shrinkIdleQEs(true, 0);
+	assert_idle_qes(0);
+}
+
+static void
+test__cdbcomponent_shrinkIdleQEs_KeepsAllQEsWithManyRoundsToGo(void **state)
+{
+	/* ceil(4 * 10 / 11) = 4, nothing is released yet */
+	cdbcomponent_shrinkIdleQEs(true, 10);
+
+	assert_idle_qes(NUM_IDLE_QES);
+}
+
+static void
+test__cdbcomponent_shrinkIdleQEs_NoComponents(void **state)
+{
+	cdb_component_dbs = NULL;
+
+	cdbcomponent_shrinkIdleQEs(true, 0);
+}
+
+int
+main(int argc, char *argv[])
+{
+	cmockery_parse_arguments(argc, argv);
+
+	const		UnitTest tests[] = {
+		test_with_setup_and_teardown(test__cdbcomponent_cleanupIdleQEs_ReleasesAllQEs),
+		test_with_setup_and_teardown(test__cdbcomponent_cleanupIdleQEs_KeepsTheWriter),
+		test_with_setup_and_teardown(test__cdbcomponent_shrinkIdleQEs_ReleasesAShareEachRound),
+		test_with_setup_and_teardown(test__cdbcomponent_shrinkIdleQEs_KeepsAllQEsWithManyRoundsToGo),
+		test_with_setup_and_teardown(test__cdbcomponent_shrinkIdleQEs_NoComponents),
+	};
+
+	MemoryContextInit();
+
+	return run_tests(tests);
+}
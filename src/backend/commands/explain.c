@@ -51,6 +51,7 @@
 
 #ifdef USE_ORCA
 extern char *SerializeDXLPlan(Query *parse);
+extern void GPOPTPlanCacheStats(uint64 *hits, uint64 *misses);
 #endif
 
 
@@ -702,7 +703,22 @@ ExplainOnePlan(PlannedStmt *plannedstmt, IntoClause *into, ExplainState *es,
 		ExplainPropertyStringInfo("Optimizer", es, "Postgres query optimizer");
 #ifdef USE_ORCA
 	else
+	{
 		ExplainPropertyStringInfo("Optimizer", es, "Pivotal Optimizer (GPORCA)");
+
+		/* Plan cache counters are cumulative for this backend */
+		if (optimizer_plan_cache_size > 0)
+		{
+			uint64		hits;
+			uint64		misses;
+
+			GPOPTPlanCacheStats(&hits, &misses);
+			ExplainPropertyInteger("Optimizer Plan Cache Hits", NULL,
+								   hits, es);
+			ExplainPropertyInteger("Optimizer Plan Cache Misses", NULL,
+								   misses, es);
+		}
+	}
 #endif
 
 	/* We only list the non-default GUCs in verbose mode */
@@ -2131,6 +2147,11 @@ ExplainNode(PlanState *planstate, List *ancestors,
 			if (plan->qual)
 				show_instrumentation_count("Rows Removed by Filter", 1,
 										   planstate, es);
+			/* CDB: rows discarded by the runtime filter of a hash join */
+			if (IsA(plan, SeqScan) && planstate->instrument &&
+				planstate->instrument->nfiltered2 > 0)
+				show_instrumentation_count("Rows Removed by Runtime Filter", 2,
+										   planstate, es);
 			break;
 		case T_Gather:
 			{
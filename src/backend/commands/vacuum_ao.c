@@ -115,6 +115,7 @@
 #include "postgres.h"
 
 #include "access/aocs_compaction.h"
+#include "access/aocssegfiles.h"
 #include "access/appendonlywriter.h"
 #include "access/appendonly_compaction.h"
 #include "access/genam.h"
@@ -282,6 +283,8 @@ ao_vacuum_rel_compact(Relation onerel, int options, VacuumParams *params,
 	List	   *compacted_segments = NIL;
 	List	   *compacted_and_inserted_segments = NIL;
 	Snapshot	appendOnlyMetaDataSnapshot = RegisterSnapshot(GetCatalogSnapshot(InvalidOid));
+	FileSegTotals *totals;
+	int			nsegs_per_batch;
 	char	   *relname;
 	int			elevel;
 
@@ -319,24 +322,47 @@ ao_vacuum_rel_compact(Relation onerel, int options, VacuumParams *params,
 	 * pg_aoseg needs to happen in a distributed transaction (Problem 3), so
 	 * we would need to coordinate the transactions from the QD.
 	 */
+	if (RelationIsAoRows(onerel))
+		totals = GetSegFilesTotals(onerel, appendOnlyMetaDataSnapshot);
+	else
+		totals = GetAOCSSSegFilesTotals(onerel, appendOnlyMetaDataSnapshot);
+	AppendOnlyCompaction_BeginProgress(onerel, totals->totalbytes);
+	pfree(totals);
+
+	/*
+	 * With gp_appendonly_compaction_workers set, choose that many segfiles
+	 * at a time, and compact them at once.
+	 */
+	nsegs_per_batch = Max(gp_appendonly_compaction_workers, 1);
+
 	insert_segno = -1;
-	while ((compaction_segno = ChooseSegnoForCompaction(onerel, compacted_and_inserted_segments)) != -1)
+	for (;;)
 	{
-		/*
-		 * Compact this segment. (If the segment doesn't need compaction,
-		 * AppendOnlyCompact() will fall through quickly).
-		 */
-		compacted_segments = lappend_int(compacted_segments, compaction_segno);
-		compacted_and_inserted_segments = lappend_int(compacted_and_inserted_segments,
-													  compaction_segno);
+		List	   *compaction_segnos = NIL;
+
+		while (list_length(compaction_segnos) < nsegs_per_batch &&
+			   (compaction_segno = ChooseSegnoForCompaction(onerel, compacted_and_inserted_segments)) != -1)
+		{
+			compaction_segnos = lappend_int(compaction_segnos, compaction_segno);
+			compacted_segments = lappend_int(compacted_segments, compaction_segno);
+			compacted_and_inserted_segments = lappend_int(compacted_and_inserted_segments,
+														  compaction_segno);
+
+			/* XXX: maybe print this deeper, only if there's work to be done? */
+			if (Debug_appendonly_print_compaction)
+				elog(LOG, "compacting segno %d of %s", compaction_segno, relname);
+		}
 
-		/* XXX: maybe print this deeper, only if there's work to be done? */
-		if (Debug_appendonly_print_compaction)
-			elog(LOG, "compacting segno %d of %s", compaction_segno, relname);
+		if (compaction_segnos == NIL)
+			break;
 
+		/*
+		 * Compact these segments. (If a segment doesn't need compaction,
+		 * AppendOnlyCompact() will skip it quickly).
+		 */
 		if (RelationIsAoRows(onerel))
 			AppendOnlyCompact(onerel,
-							  compaction_segno,
+							  compaction_segnos,
 							  &insert_segno,
 							  (options & VACOPT_FULL) != 0,
 							  compacted_segments);
@@ -344,7 +370,7 @@ ao_vacuum_rel_compact(Relation onerel, int options, VacuumParams *params,
 		{
 			Assert(RelationIsAoCols(onerel));
 			AOCSCompact(onerel,
-						compaction_segno,
+						compaction_segnos,
 						&insert_segno,
 						(options & VACOPT_FULL) != 0,
 						compacted_segments);
@@ -359,8 +385,12 @@ ao_vacuum_rel_compact(Relation onerel, int options, VacuumParams *params,
 		 * that we can update the insertion target pg_aoseg row again.
 		 */
 		CommandCounterIncrement();
+
+		list_free(compaction_segnos);
 	}
 
+	AppendOnlyCompaction_EndProgress();
+
 	UnregisterSnapshot(appendOnlyMetaDataSnapshot);
 }
 
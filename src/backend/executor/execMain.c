@@ -487,11 +487,13 @@ standard_ExecutorStart(QueryDesc *queryDesc, int eflags)
 
 	/*
 	 * We don't eliminate aliens if we don't have an MPP plan
-	 * or we are executing on master.
+	 * or we are executing on master. If the dispatcher already cut the plan
+	 * down to our slice, the aliens are gone and must not be initialized.
 	 *
 	 * TODO: eliminate aliens even on master, if not EXPLAIN ANALYZE
 	 */
-	estate->eliminateAliens = execute_pruned_plan && estate->es_sliceTable && estate->es_sliceTable->hasMotions && !IS_QUERY_DISPATCHER();
+	estate->eliminateAliens = (execute_pruned_plan || queryDesc->plannedstmt->slicePruned) &&
+		estate->es_sliceTable && estate->es_sliceTable->hasMotions && !IS_QUERY_DISPATCHER();
 
 	/*
 	 * Set up an AFTER-trigger statement context, unless told not to, or
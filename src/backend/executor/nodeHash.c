@@ -37,6 +37,7 @@
 #include "executor/hashjoin.h"
 #include "executor/nodeHash.h"
 #include "executor/nodeHashjoin.h"
+#include "lib/bloomfilter.h"
 #include "miscadmin.h"
 #include "pgstat.h"
 #include "port/atomics.h"
@@ -50,6 +51,21 @@
 #include "cdb/cdbutil.h"
 #include "cdb/cdbvars.h"
 
+/*
+ * CDB: A runtime filter with more of its bits set than this, because the
+ * inner side turned out much larger than estimated, passes too many rows to
+ * be worth checking.
+ */
+#define RUNTIME_FILTER_MAX_BITS_SET		0.75
+
+/*
+ * CDB: The Bloom filter of a runtime filter is charged to the memory of the
+ * hash join, and may take up to this share of it.  bloom_create() allocates
+ * at least RUNTIME_FILTER_MIN_BLOOM_KB, however small the inner side.
+ */
+#define RUNTIME_FILTER_MEM_PERCENT		25
+#define RUNTIME_FILTER_MIN_BLOOM_KB		1024
+
 static void ExecHashIncreaseNumBatches(HashJoinTable hashtable);
 static void ExecHashIncreaseNumBuckets(HashJoinTable hashtable);
 static void ExecParallelHashIncreaseNumBatches(HashJoinTable hashtable);
@@ -206,6 +222,11 @@ MultiExecPrivateHash(HashState *node)
 				ExecHashTableInsert(node, hashtable, slot, hashvalue);
 			}
 			hashtable->totalTuples += 1;
+
+			if (hashtable->bloom)
+				bloom_add_element(hashtable->bloom,
+								  (unsigned char *) &hashvalue,
+								  sizeof(hashvalue));
 		}
 
 		if (hashkeys_null)
@@ -232,6 +253,14 @@ MultiExecPrivateHash(HashState *node)
 		hashtable->spacePeak = hashtable->spaceUsed;
 
 	hashtable->partialTuples = hashtable->totalTuples;
+
+	/*
+	 * CDB: Now that the filter holds the hash values of all inner tuples,
+	 * the scan on the outer side can start using it.
+	 */
+	if (hashtable->bloom &&
+		bloom_prop_bits_set(hashtable->bloom) <= RUNTIME_FILTER_MAX_BITS_SET)
+		hashtable->hjstate->hj_RuntimeFilter->bloom = hashtable->bloom;
 }
 
 /* ----------------------------------------------------------------
@@ -471,6 +500,7 @@ ExecHashTableCreate(HashState *state, HashJoinState *hjstate,
 	int			nbuckets;
 	int			nbatch;
 	double		rows;
+	uint64		bloomMemKB;
 	int			num_skew_mcvs;
 	int			log2_nbuckets;
 	int			nkeys;
@@ -494,6 +524,27 @@ ExecHashTableCreate(HashState *state, HashJoinState *hjstate,
 	 */
 	rows = node->plan.parallel_aware ? node->rows_total : outerNode->plan_rows;
 
+	/*
+	 * CDB: If the hash join passes a runtime filter to its outer side, the
+	 * Bloom filter built along with the hash table (see below) is taken out
+	 * of the memory of the join before sizing the hash table.  bloom_create()
+	 * aims for two bytes per element, so that is the most it will allocate.
+	 * Don't build a filter for an inner side estimated to have fewer rows than
+	 * gp_runtime_filter_min_inner_rows, nor when the smallest filter doesn't
+	 * fit in its share of the join's memory.
+	 */
+	bloomMemKB = 0;
+	if (hjstate->hj_RuntimeFilter && state->parallel_state == NULL &&
+		rows >= gp_runtime_filter_min_inner_rows &&
+		operatorMemKB * RUNTIME_FILTER_MEM_PERCENT / 100 >=
+		RUNTIME_FILTER_MIN_BLOOM_KB)
+	{
+		bloomMemKB = Min(operatorMemKB * RUNTIME_FILTER_MEM_PERCENT / 100,
+						 (uint64) ceil(rows * 2 / 1024));
+		bloomMemKB = Max(bloomMemKB, RUNTIME_FILTER_MIN_BLOOM_KB);
+		operatorMemKB -= bloomMemKB;
+	}
+
 	ExecChooseHashTableSize(rows, outerNode->plan_width,
 							OidIsValid(node->skewTable),
 							operatorMemKB,
@@ -609,6 +660,23 @@ ExecHashTableCreate(HashState *state, HashJoinState *hjstate,
 		i++;
 	}
 
+	/*
+	 * CDB: If memory was set aside for a runtime filter above, build a Bloom
+	 * filter of the hash values of the inner tuples along with the hash
+	 * table.  The scan hashes its rows with the outer hash functions.
+	 */
+	hashtable->bloom = NULL;
+	if (bloomMemKB > 0)
+	{
+		RuntimeFilter *rf = hjstate->hj_RuntimeFilter;
+
+		hashtable->bloom = bloom_create((int64) Max(rows, 1.0),
+										(int) Min(bloomMemKB, INT_MAX),
+										0);
+		rf->hashfunctions = hashtable->outer_hashfunctions;
+		rf->collations = hashtable->collations;
+	}
+
 	if (nbatch > 1 && hashtable->parallel_state == NULL)
 	{
 		/*
@@ -1007,6 +1075,13 @@ ExecHashTableDestroy(HashState *hashState, HashJoinTable hashtable)
 		hashtable->work_set = NULL;
 	}
 
+	/* CDB: the runtime filter lives in hashCxt, stop the outer scan using it */
+	if (hashtable->bloom)
+	{
+		hashtable->hjstate->hj_RuntimeFilter->bloom = NULL;
+		hashtable->bloom = NULL;
+	}
+
 	/* Release working memory (batchCxt is a child, so it goes away too) */
 	MemoryContextDelete(hashtable->hashCxt);
 }
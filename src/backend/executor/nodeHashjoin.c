@@ -116,6 +116,7 @@
 #include "executor/nodeHash.h"
 #include "executor/nodeHashjoin.h"
 #include "miscadmin.h"
+#include "parser/parsetree.h"
 #include "pgstat.h"
 #include "utils/memutils.h"
 #include "utils/sharedtuplestore.h"
@@ -161,6 +162,8 @@ static void ReleaseHashTable(HashJoinState *node);
 static void SpillCurrentBatch(HashJoinState *node);
 static bool ExecHashJoinReloadHashTable(HashJoinState *hjstate);
 static void ExecEagerFreeHashJoin(HashJoinState *node);
+static void ExecHashJoinInitRuntimeFilter(HashJoinState *hjstate,
+										  HashJoin *node);
 
 /* ----------------------------------------------------------------
  *		ExecHashJoinImpl
@@ -962,6 +965,9 @@ ExecInitHashJoin(HashJoin *node, EState *estate, int eflags)
 	/* child Hash node needs to evaluate inner hash keys, too */
 	((HashState *) innerPlanState(hjstate))->hashkeys = rhclauses;
 
+	if (node->runtimeFilter && !hashNode->plan.parallel_aware)
+		ExecHashJoinInitRuntimeFilter(hjstate, node);
+
 	hjstate->hj_JoinState = HJ_BUILD_HASHTABLE;
 	hjstate->hj_MatchedOuter = false;
 	hjstate->hj_OuterNotEmpty = false;
@@ -969,6 +975,79 @@ ExecInitHashJoin(HashJoin *node, EState *estate, int eflags)
 	return hjstate;
 }
 
+/*
+ * ExecHashJoinInitRuntimeFilter
+ *
+ *		CDB: Pass a runtime filter to the outer side of the hash join, if it
+ *		is a sequential scan whose targetlist returns each outer hash key as
+ *		a plain column of the scanned relation.  The scan can then compute
+ *		the hash value of its rows before projecting them.  The Bloom filter
+ *		itself is built along with the hash table, see ExecHashTableCreate().
+ */
+static void
+ExecHashJoinInitRuntimeFilter(HashJoinState *hjstate, HashJoin *node)
+{
+	PlanState  *outerState = outerPlanState(hjstate);
+	Scan	   *scan;
+	RuntimeFilter *rf;
+	AttrNumber *attnos;
+	int			nkeys;
+	int			i;
+	ListCell   *l;
+
+	if (!IsA(outerState, SeqScanState))
+		return;
+	scan = (Scan *) outerState->plan;
+
+	nkeys = list_length(node->hashclauses);
+	attnos = (AttrNumber *) palloc(nkeys * sizeof(AttrNumber));
+	i = 0;
+	foreach(l, node->hashclauses)
+	{
+		OpExpr	   *hclause = lfirst_node(OpExpr, l);
+		Expr	   *outerkey = linitial(hclause->args);
+		TargetEntry *tle;
+		Expr	   *expr;
+		Var		   *var;
+
+		/* binary-compatible casts don't change the hash value */
+		while (IsA(outerkey, RelabelType))
+			outerkey = ((RelabelType *) outerkey)->arg;
+		if (!IsA(outerkey, Var) || ((Var *) outerkey)->varno != OUTER_VAR)
+			break;
+
+		tle = get_tle_by_resno(scan->plan.targetlist,
+							   ((Var *) outerkey)->varattno);
+		if (tle == NULL)
+			break;
+		expr = tle->expr;
+		while (IsA(expr, RelabelType))
+			expr = ((RelabelType *) expr)->arg;
+		if (!IsA(expr, Var))
+			break;
+
+		var = (Var *) expr;
+		if (var->varno != scan->scanrelid || var->varattno <= 0 ||
+			var->varlevelsup != 0)
+			break;
+
+		attnos[i++] = var->varattno;
+	}
+
+	if (i < nkeys)
+	{
+		pfree(attnos);
+		return;
+	}
+
+	rf = (RuntimeFilter *) palloc0(sizeof(RuntimeFilter));
+	rf->nkeys = nkeys;
+	rf->attnos = attnos;
+
+	hjstate->hj_RuntimeFilter = rf;
+	((SeqScanState *) outerState)->runtime_filter = rf;
+}
+
 /* ----------------------------------------------------------------
  *		ExecEndHashJoin
  *
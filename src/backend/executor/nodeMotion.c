@@ -31,6 +31,12 @@
 #include "utils/memutils.h"
 
 
+/*
+ * Number of tuples a Redistribute Motion collects from its child before it
+ * computes their target segments.
+ */
+#define MOTION_HASH_BATCH_SIZE	128
+
 /* #define MEASURE_MOTION_TIME */
 
 #ifdef MEASURE_MOTION_TIME
@@ -54,9 +60,14 @@ static TupleTableSlot *execMotionSortedReceiver(MotionState *node);
 
 static int	CdbMergeComparator(Datum lhs, Datum rhs, void *context);
 static uint32 evalHashKey(ExprContext *econtext, List *hashkeys, CdbHash *h);
+static void evalHashKeyBatch(MotionState *node);
 
 static void doSendEndOfStream(Motion *motion, MotionState *node);
 static void doSendTuple(Motion *motion, MotionState *node, TupleTableSlot *outerTupleSlot);
+static void doSendHashBatch(Motion *motion, MotionState *node);
+static void doSendTupleToRoute(Motion *motion, MotionState *node,
+							   TupleTableSlot *outerTupleSlot, int16 targetRoute);
+static void ExecMotionExplainEnd(PlanState *planstate, struct StringInfoData *buf);
 
 
 /*=========================================================================
@@ -239,6 +250,10 @@ execMotionSender(MotionState *node)
 
 		if (done || TupIsNull(outerTupleSlot))
 		{
+			/* Send the tuples still waiting in the hash batch first. */
+			if (node->numHashBatch > 0)
+				doSendHashBatch(motion, node);
+
 			doSendEndOfStream(motion, node);
 			done = true;
 		}
@@ -251,6 +266,41 @@ execMotionSender(MotionState *node)
 			 * throw away the resulting tuples.
 			 */
 		}
+		else if (node->hashBatchSlots)
+		{
+			/*
+			 * Redistribute: collect the tuple into the batch, and send the
+			 * batch once it is full.
+			 */
+			int			n = node->numHashBatch++;
+
+			node->numTuplesFromChild++;
+
+			/*
+			 * The child's slot stays valid until it is called again, so the
+			 * tuple that completes the batch can be used as is. The others
+			 * have to be copied.
+			 */
+			if (node->numHashBatch == MOTION_HASH_BATCH_SIZE)
+			{
+				node->hashBatchSlots[n] = outerTupleSlot;
+				doSendHashBatch(motion, node);
+			}
+			else
+			{
+				node->hashBatchSlots[n] = node->hashBatchCopies[n];
+				ExecCopySlot(node->hashBatchSlots[n], outerTupleSlot);
+			}
+			/* doSendHashBatch() may have set node->stopRequested as a side-effect */
+
+			if (node->stopRequested)
+			{
+				elog(gp_workfile_caching_loglevel, "Motion calling Squelch on child node");
+				/* propagate stop notification to our children */
+				ExecSquelchNode(outerNode);
+				done = true;
+			}
+		}
 		else
 		{
 			doSendTuple(motion, node, outerTupleSlot);
@@ -611,6 +661,7 @@ ExecInitMotion(Motion *node, EState *estate, int eflags)
 	SliceTable *sliceTable = estate->es_sliceTable;
 	PlanState  *outerPlan;
 	int			parentIndex;
+	int			batchSize = 0;
 
 	/*
 	 * If GDD is enabled, the lock of table may downgrade to RowExclusiveLock,
@@ -642,6 +693,9 @@ ExecInitMotion(Motion *node, EState *estate, int eflags)
 	motionstate->stopRequested = false;
 	motionstate->hashExprs = NIL;
 	motionstate->cdbhash = NULL;
+	motionstate->numHashBatch = 0;
+	motionstate->hashBatchSlots = NULL;
+	motionstate->hashBatchCopies = NULL;
 
 	/* Look up the sending and receiving gang's slice table entries. */
 	sendSlice = &sliceTable->slices[node->motionID];
@@ -751,6 +805,15 @@ ExecInitMotion(Motion *node, EState *estate, int eflags)
 		Assert(node->numHashSegments <= recvSlice->planNumSegments);
 		nkeys = list_length(node->hashExprs);
 
+		/*
+		 * The hash expressions are evaluated both on the child's result slot
+		 * and on the minimal tuple slots the batched tuples are copied to, so
+		 * they must not assume a fixed type of slot for the outer tuple.
+		 */
+		motionstate->ps.outeropsset = true;
+		motionstate->ps.outeropsfixed = false;
+		motionstate->ps.outerops = NULL;
+
 		if (nkeys > 0)
 			motionstate->hashExprs = ExecInitExprList(node->hashExprs,
 													  (PlanState *) motionstate);
@@ -761,6 +824,34 @@ ExecInitMotion(Motion *node, EState *estate, int eflags)
 		motionstate->cdbhash = makeCdbHash(motionstate->numHashSegments,
 										   nkeys,
 										   node->hashFuncs);
+
+		/*
+		 * Compute the target segments of a batch of tuples at a time, unless
+		 * the tuples are sent to random segments.
+		 */
+		if (nkeys > 0)
+		{
+			TupleDesc	childDesc = ExecGetResultType(outerPlanState(motionstate));
+
+			motionstate->hashBatchSlots =
+				palloc0(MOTION_HASH_BATCH_SIZE * sizeof(TupleTableSlot *));
+			motionstate->hashBatchCopies =
+				palloc(MOTION_HASH_BATCH_SIZE * sizeof(TupleTableSlot *));
+			/* the last tuple of a full batch is never copied */
+			for (int i = 0; i < MOTION_HASH_BATCH_SIZE - 1; i++)
+				motionstate->hashBatchCopies[i] =
+					ExecAllocTableSlot(&estate->es_tupleTable, childDesc,
+									   &TTSOpsMinimalTuple);
+			motionstate->hashBatchCopies[MOTION_HASH_BATCH_SIZE - 1] = NULL;
+			motionstate->hashBatchValues =
+				palloc(MOTION_HASH_BATCH_SIZE * sizeof(Datum));
+			motionstate->hashBatchIsnull =
+				palloc(MOTION_HASH_BATCH_SIZE * sizeof(bool));
+			motionstate->hashBatchHashes =
+				palloc(MOTION_HASH_BATCH_SIZE * sizeof(uint32));
+			motionstate->hashBatchSegs =
+				palloc(MOTION_HASH_BATCH_SIZE * sizeof(unsigned int));
+		}
 	}
 
 	/*
@@ -805,13 +896,35 @@ ExecInitMotion(Motion *node, EState *estate, int eflags)
 								motionstate);
 	}
 
+	/*
+	 * Send columnar batches of tuples, if requested.  A Gather sends its
+	 * tuples one at a time, so that e.g. a LIMIT on top of it doesn't have
+	 * to wait for full batches.
+	 */
+	if (motionstate->mstype == MOTIONSTATE_SEND &&
+		gp_motion_batch_size > 0 &&
+		tupDesc->natts > 0 &&
+		(node->motionType == MOTIONTYPE_HASH ||
+		 node->motionType == MOTIONTYPE_BROADCAST ||
+		 node->motionType == MOTIONTYPE_EXPLICIT))
+		batchSize = gp_motion_batch_size;
+
 	/*
 	 * Perform per-node initialization in the motion layer.
 	 */
 	UpdateMotionLayerNode(motionstate->ps.state->motionlayer_context,
 						  node->motionID,
 						  node->sendSorted,
-						  tupDesc);
+						  tupDesc,
+						  batchSize);
+
+	/*
+	 * CDB: Offer extra info for EXPLAIN ANALYZE: how much data the batches
+	 * received took on the wire.
+	 */
+	if ((estate->es_instrument & INSTRUMENT_CDB) &&
+		motionstate->mstype == MOTIONSTATE_RECV)
+		motionstate->ps.cdbexplainfun = ExecMotionExplainEnd;
 
 
 #ifdef CDB_MOTION_DEBUG
@@ -831,6 +944,33 @@ ExecInitMotion(Motion *node, EState *estate, int eflags)
 	return motionstate;
 }
 
+/*
+ * ExecMotionExplainEnd
+ *		Called before ExecutorEnd to finish EXPLAIN ANALYZE reporting.
+ *
+ * Reports how many columnar batches of tuples were received, and their size
+ * on the wire and once decompressed.
+ */
+static void
+ExecMotionExplainEnd(PlanState *planstate, struct StringInfoData *buf)
+{
+	Motion	   *motion = (Motion *) planstate->plan;
+	uint64		batches;
+	uint64		bytes;
+	uint64		rawBytes;
+
+	GetMotionBatchStats(planstate->state->motionlayer_context,
+						motion->motionID,
+						&batches, &bytes, &rawBytes);
+
+	if (batches > 0)
+		appendStringInfo(buf,
+						 "Columnar batches " UINT64_FORMAT ", "
+						 UINT64_FORMAT " bytes on wire, "
+						 UINT64_FORMAT " bytes decompressed",
+						 batches, bytes, rawBytes);
+}
+
 /* ----------------------------------------------------------------
  *		ExecEndMotion(node)
  * ----------------------------------------------------------------
@@ -1046,6 +1186,51 @@ evalHashKey(ExprContext *econtext, List *hashkeys, CdbHash * h)
 	return target_seg;
 }
 
+/*
+ * Compute the target segments of the tuples in the hash batch, into
+ * node->hashBatchSegs.
+ *
+ * The hash keys are evaluated, and hashed, one key at a time for all the
+ * tuples of the batch.
+ */
+static void
+evalHashKeyBatch(MotionState *node)
+{
+	ExprContext *econtext = node->ps.ps_ExprContext;
+	CdbHash    *h = node->cdbhash;
+	int			n = node->numHashBatch;
+	MemoryContext oldContext;
+	ListCell   *hk;
+	int			attno;
+
+	ResetExprContext(econtext);
+
+	oldContext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+	cdbhashinitbatch(h, node->hashBatchHashes, n);
+
+	attno = 1;
+	foreach(hk, node->hashExprs)
+	{
+		ExprState  *keyexpr = (ExprState *) lfirst(hk);
+
+		for (int i = 0; i < n; i++)
+		{
+			econtext->ecxt_outertuple = node->hashBatchSlots[i];
+			node->hashBatchValues[i] = ExecEvalExpr(keyexpr, econtext,
+													&node->hashBatchIsnull[i]);
+		}
+
+		cdbhashbatch(h, attno, node->hashBatchHashes,
+					 node->hashBatchValues, node->hashBatchIsnull, n);
+		attno++;
+	}
+
+	cdbhashreducebatch(h, node->hashBatchHashes, node->hashBatchSegs, n);
+
+	MemoryContextSwitchTo(oldContext);
+}
+
 
 void
 doSendEndOfStream(Motion *motion, MotionState *node)
@@ -1089,7 +1274,6 @@ void
 doSendTuple(Motion *motion, MotionState *node, TupleTableSlot *outerTupleSlot)
 {
 	int16		targetRoute;
-	SendReturnCode sendRC;
 	ExprContext *econtext = node->ps.ps_ExprContext;
 
 	/* We got a tuple from the child-plan. */
@@ -1155,6 +1339,47 @@ doSendTuple(Motion *motion, MotionState *node, TupleTableSlot *outerTupleSlot)
 	else
 		elog(ERROR, "unknown motion type %d", motion->motionType);
 
+	doSendTupleToRoute(motion, node, outerTupleSlot, targetRoute);
+}
+
+/*
+ * Send the tuples collected in the hash batch of a Redistribute Motion.
+ */
+static void
+doSendHashBatch(Motion *motion, MotionState *node)
+{
+	Assert(motion->motionType == MOTIONTYPE_HASH);
+
+	evalHashKeyBatch(node);
+
+	for (int i = 0; i < node->numHashBatch && !node->stopRequested; i++)
+	{
+		/* See doSendTuple() */
+		Assert(node->hashBatchSegs[i] < node->numHashSegments &&
+			   "redistribute destination outside segment array");
+
+		doSendTupleToRoute(motion, node, node->hashBatchSlots[i],
+						   (int16) node->hashBatchSegs[i]);
+	}
+
+	/* release the copies; the child's own slot is left alone */
+	for (int i = 0; i < node->numHashBatch; i++)
+	{
+		if (node->hashBatchSlots[i] == node->hashBatchCopies[i])
+			ExecClearTuple(node->hashBatchSlots[i]);
+	}
+	node->numHashBatch = 0;
+}
+
+/*
+ * Send a tuple to the given route.
+ */
+static void
+doSendTupleToRoute(Motion *motion, MotionState *node,
+				   TupleTableSlot *outerTupleSlot, int16 targetRoute)
+{
+	SendReturnCode sendRC;
+
 	CheckAndSendRecordCache(node->ps.state->motionlayer_context,
 							node->ps.state->interconnect_context,
 							motion->motionID,
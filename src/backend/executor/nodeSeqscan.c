@@ -29,18 +29,71 @@
 
 #include "access/relscan.h"
 #include "access/tableam.h"
+#include "cdb/cdbaocsam.h"
+#include "cdb/cdbappendonlyam.h"
 #include "executor/execdebug.h"
 #include "executor/nodeSeqscan.h"
+#include "lib/bloomfilter.h"
 #include "utils/rel.h"
 #include "nodes/nodeFuncs.h"
 
 static TupleTableSlot *SeqNext(SeqScanState *node);
+static bool RuntimeFilterLacks(RuntimeFilter *rf, TupleTableSlot *slot,
+							   ExprContext *econtext);
+static void ExecSeqScanExplainEnd(PlanState *planstate, struct StringInfoData *buf);
 
 /* ----------------------------------------------------------------
  *						Scan Support
  * ----------------------------------------------------------------
  */
 
+/*
+ * RuntimeFilterLacks
+ *
+ *		CDB: Does the runtime filter of the hash join above us show that the
+ *		row in the slot cannot find a match?  The hash value is computed the
+ *		same way as ExecHashGetHashValue() does for outer tuples; rows with a
+ *		NULL join key are never discarded.
+ *
+ *		The hash functions are called in the per-tuple memory of econtext,
+ *		which the caller must reset.
+ */
+static bool
+RuntimeFilterLacks(RuntimeFilter *rf, TupleTableSlot *slot,
+				   ExprContext *econtext)
+{
+	MemoryContext oldContext;
+	uint32		hashkey = 0;
+	int			i;
+
+	oldContext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+	for (i = 0; i < rf->nkeys; i++)
+	{
+		Datum		keyval;
+		bool		isNull;
+
+		/* rotate hashkey left 1 bit at each step */
+		hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
+
+		keyval = slot_getattr(slot, rf->attnos[i], &isNull);
+		if (isNull)
+		{
+			MemoryContextSwitchTo(oldContext);
+			return false;
+		}
+
+		hashkey ^= DatumGetUInt32(FunctionCall1Coll(&rf->hashfunctions[i],
+													rf->collations[i],
+													keyval));
+	}
+
+	MemoryContextSwitchTo(oldContext);
+
+	return bloom_lacks_element(rf->bloom, (unsigned char *) &hashkey,
+							   sizeof(hashkey));
+}
+
 /* ----------------------------------------------------------------
  *		SeqNext
  *
@@ -84,8 +137,29 @@ SeqNext(SeqScanState *node)
 	/*
 	 * get the next tuple from the table
 	 */
-	if (table_scan_getnextslot(scandesc, direction, slot))
+	while (table_scan_getnextslot(scandesc, direction, slot))
+	{
+		RuntimeFilter *rf = node->runtime_filter;
+
+		/*
+		 * CDB: discard rows that the hash join above us would not find a
+		 * match for, before the quals and projection are evaluated.
+		 */
+		if (rf && rf->bloom &&
+			RuntimeFilterLacks(rf, slot, node->ss.ps.ps_ExprContext))
+		{
+			/*
+			 * ExecScan() resets the per-tuple memory only once per returned
+			 * row, so reset it here for the discarded ones.
+			 */
+			ResetExprContext(node->ss.ps.ps_ExprContext);
+			InstrCountFiltered2(node, 1);
+			CHECK_FOR_INTERRUPTS();
+			continue;
+		}
+
 		return slot;
+	}
 	return NULL;
 }
 
@@ -189,9 +263,89 @@ ExecInitSeqScanForPartition(SeqScan *node, EState *estate,
 	scanstate->ss.ps.qual =
 		ExecInitQual(node->plan.qual, (PlanState *) scanstate);
 
+	/*
+	 * CDB: Offer extra info for EXPLAIN ANALYZE: how many blocks of an
+	 * append-only relation the zone maps allowed to skip.
+	 */
+	if ((estate->es_instrument & INSTRUMENT_CDB) &&
+		RelationIsAppendOptimized(currentRelation))
+		scanstate->ss.ps.cdbexplainfun = ExecSeqScanExplainEnd;
+
 	return scanstate;
 }
 
+/*
+ * ExecSeqScanExplainEnd
+ *		Called before ExecutorEnd to finish EXPLAIN ANALYZE reporting.
+ *
+ * Reports how many blocks of an append-only relation the zone maps allowed
+ * to skip, and, when read-ahead is on, how many of the large reads were
+ * requested in advance.
+ */
+static void
+ExecSeqScanExplainEnd(PlanState *planstate, struct StringInfoData *buf)
+{
+	TableScanDesc scan = ((SeqScanState *) planstate)->ss.ss_currentScanDesc;
+	AppendOnlyZoneMap *zonemap = NULL;
+	int32		prefetchDepth = 0;
+	int64		largeReadCount = 0;
+	int64		prefetchedReadCount = 0;
+	bool		zonemapReported = false;
+
+	if (scan == NULL)
+		return;
+
+	if (RelationIsAoRows(scan->rs_rd))
+	{
+		AppendOnlyScanDesc aoscan = (AppendOnlyScanDesc) scan;
+		BufferedRead *bufferedRead = &aoscan->storageRead.bufferedRead;
+
+		zonemap = aoscan->zonemap;
+		prefetchDepth = bufferedRead->prefetchDepth;
+		largeReadCount = bufferedRead->largeReadCount;
+		prefetchedReadCount = bufferedRead->prefetchedReadCount;
+	}
+	else if (RelationIsAoCols(scan->rs_rd))
+	{
+		AOCSScanDesc aocsscan = (AOCSScanDesc) scan;
+
+		zonemap = aocsscan->zonemap;
+		if (aocsscan->columnScanInfo.ds != NULL &&
+			aocsscan->columnScanInfo.relationTupleDesc != NULL)
+		{
+			int			natts = aocsscan->columnScanInfo.relationTupleDesc->natts;
+
+			for (int i = 0; i < natts; i++)
+			{
+				DatumStreamRead *ds = aocsscan->columnScanInfo.ds[i];
+
+				if (ds == NULL)
+					continue;
+				prefetchDepth = ds->ao_read.bufferedRead.prefetchDepth;
+				largeReadCount += ds->ao_read.bufferedRead.largeReadCount;
+				prefetchedReadCount += ds->ao_read.bufferedRead.prefetchedReadCount;
+			}
+		}
+	}
+
+	if (zonemap != NULL && zonemap->blocksSeen > 0)
+	{
+		appendStringInfo(buf,
+						 "Zone maps skipped " INT64_FORMAT " of " INT64_FORMAT " blocks.",
+						 zonemap->blocksSkipped, zonemap->blocksSeen);
+		zonemapReported = true;
+	}
+
+	if (prefetchDepth > 0 && largeReadCount > 0)
+	{
+		if (zonemapReported)
+			appendStringInfoChar(buf, '\n');
+		appendStringInfo(buf,
+						 "Read-ahead depth %d: " INT64_FORMAT " of " INT64_FORMAT " large reads prefetched.",
+						 prefetchDepth, prefetchedReadCount, largeReadCount);
+	}
+}
+
 /* ----------------------------------------------------------------
  *		ExecEndSeqScan
  *
@@ -18,6 +18,7 @@
 #include "gpopt/utils/CMemoryPoolPalloc.h"
 #include "gpopt/utils/CMemoryPoolPallocManager.h"
 #include "gpopt/utils/COptTasks.h"
+#include "gpopt/utils/CPlanCache.h"
 
 // the following headers are needed to reference optimizer library initializers
 #include "gpos/_api.h"
@@ -176,6 +177,22 @@ CGPOptimizer::SerializeDXLPlan(Query *query)
 	return nullptr;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CGPOptimizer::GetPlanCacheStats
+//
+//	@doc:
+//		Number of plan cache lookups in this backend that found,
+//		and did not find, a plan
+//
+//---------------------------------------------------------------------------
+void
+CGPOptimizer::GetPlanCacheStats(uint64 *hits, uint64 *misses)
+{
+	*hits = gpdxl::CPlanCache::Hits();
+	*misses = gpdxl::CPlanCache::Misses();
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		InitGPOPT()
@@ -247,6 +264,22 @@ SerializeDXLPlan(Query *query)
 }
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		GPOPTPlanCacheStats
+//
+//	@doc:
+//		Expose plan cache counters to C files
+//
+//---------------------------------------------------------------------------
+extern "C" {
+void
+GPOPTPlanCacheStats(uint64 *hits, uint64 *misses)
+{
+	CGPOptimizer::GetPlanCacheStats(hits, misses);
+}
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		InitGPOPT()
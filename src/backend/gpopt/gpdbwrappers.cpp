@@ -43,6 +43,7 @@ extern "C" {
 #include "utils/fmgroids.h"
 #include "utils/memutils.h"
 #include "utils/partcache.h"
+#include "utils/shared_mdcache.h"
 }
 #define GP_WRAP_START                                            \
 	sigjmp_buf local_sigjmp_buf;                                 \
@@ -2647,6 +2648,55 @@ gpdb::MDCacheNeedsReset(void)
 	return true;
 }
 
+// Can the current transaction use the metadata cache shared by all backends?
+bool
+gpdb::IsSharedMDCacheEnabled(void)
+{
+	// No GP_WRAP_START/END needed here, it cannot throw an ereport().
+	return SharedMDCacheEnabled();
+}
+
+// Get the generation of the shared metadata cache, after processing pending
+// invalidation messages
+uint64
+gpdb::GetSharedMDCacheGeneration(void)
+{
+	GP_WRAP_START;
+	{
+		return SharedMDCacheGetGeneration();
+	}
+	GP_WRAP_END;
+
+	return 0;
+}
+
+// Look up a serialized metadata object in the shared metadata cache
+char *
+gpdb::LookupSharedMDCache(const char *key, Size *len)
+{
+	GP_WRAP_START;
+	{
+		return SharedMDCacheLookup(key, len);
+	}
+	GP_WRAP_END;
+
+	return nullptr;
+}
+
+// Add a serialized metadata object to the shared metadata cache
+void
+gpdb::InsertSharedMDCache(const char *key, uint64 generation, const char *data,
+						  Size len, SharedMDCacheObjType objtype, Oid relid,
+						  Oid objid)
+{
+	GP_WRAP_START;
+	{
+		SharedMDCacheInsert(key, generation, data, len, objtype, relid, objid);
+		return;
+	}
+	GP_WRAP_END;
+}
+
 // returns true if a query cancel is requested in GPDB
 bool
 gpdb::IsAbortRequested(void)
@@ -17,11 +17,19 @@
 extern "C" {
 #include "postgres.h"
 }
+#include "gpos/common/CAutoRg.h"
+
+#include "gpopt/gpdbwrappers.h"
 #include "gpopt/mdcache/CMDAccessor.h"
 #include "gpopt/relcache/CMDProviderRelcache.h"
 #include "gpopt/translate/CTranslatorRelcacheToDXL.h"
 #include "naucrates/dxl/CDXLUtils.h"
 #include "naucrates/exception.h"
+#include "naucrates/md/CMDIdColStats.h"
+#include "naucrates/md/CMDIdGPDB.h"
+#include "naucrates/md/CMDIdRelStats.h"
+#include "naucrates/md/IMDCheckConstraint.h"
+#include "naucrates/md/IMDTrigger.h"
 
 using namespace gpos;
 using namespace gpdxl;
@@ -66,15 +74,131 @@ CMDProviderRelcache::GetMDObjDXLStr(CMemoryPool *mp, CMDAccessor *md_accessor,
 	return str;
 }
 
-// return the requested metadata object
+// return the catalog object a metadata object is translated from, so that
+// its entry in the metadata cache shared by all backends is evicted by the
+// invalidation messages about that object
+static SharedMDCacheObjType
+GetSharedMDCacheObject(const IMDCacheObject *md_obj, OID *relid, OID *objid)
+{
+	*relid = InvalidOid;
+	*objid = InvalidOid;
+
+	switch (md_obj->MDType())
+	{
+		case IMDCacheObject::EmdtRel:
+		case IMDCacheObject::EmdtInd:
+			*relid = CMDIdGPDB::CastMdid(md_obj->MDId())->Oid();
+			return SHARED_MDCACHE_RELATION;
+
+		case IMDCacheObject::EmdtTrigger:
+		{
+			const IMDTrigger *md_trigger =
+				dynamic_cast<const IMDTrigger *>(md_obj);
+			*relid = CMDIdGPDB::CastMdid(md_trigger->GetRelMdId())->Oid();
+			return SHARED_MDCACHE_RELATION;
+		}
+
+		case IMDCacheObject::EmdtCheckConstraint:
+		{
+			const IMDCheckConstraint *md_check_constraint =
+				dynamic_cast<const IMDCheckConstraint *>(md_obj);
+			*relid =
+				CMDIdGPDB::CastMdid(md_check_constraint->GetRelMdId())->Oid();
+			return SHARED_MDCACHE_RELATION;
+		}
+
+		case IMDCacheObject::EmdtRelStats:
+		{
+			IMDId *rel_mdid =
+				CMDIdRelStats::CastMdid(md_obj->MDId())->GetRelMdId();
+			*relid = CMDIdGPDB::CastMdid(rel_mdid)->Oid();
+			return SHARED_MDCACHE_RELATION;
+		}
+
+		case IMDCacheObject::EmdtColStats:
+		{
+			IMDId *rel_mdid =
+				CMDIdColStats::CastMdid(md_obj->MDId())->GetRelMdId();
+			*relid = CMDIdGPDB::CastMdid(rel_mdid)->Oid();
+			return SHARED_MDCACHE_RELATION;
+		}
+
+		case IMDCacheObject::EmdtType:
+			*objid = CMDIdGPDB::CastMdid(md_obj->MDId())->Oid();
+			return SHARED_MDCACHE_TYPE;
+
+		case IMDCacheObject::EmdtFunc:
+			*objid = CMDIdGPDB::CastMdid(md_obj->MDId())->Oid();
+			return SHARED_MDCACHE_FUNCTION;
+
+		case IMDCacheObject::EmdtAgg:
+			*objid = CMDIdGPDB::CastMdid(md_obj->MDId())->Oid();
+			return SHARED_MDCACHE_AGGREGATE;
+
+		case IMDCacheObject::EmdtOp:
+			*objid = CMDIdGPDB::CastMdid(md_obj->MDId())->Oid();
+			return SHARED_MDCACHE_OPERATOR;
+
+		case IMDCacheObject::EmdtCastFunc:
+			return SHARED_MDCACHE_CAST;
+
+		case IMDCacheObject::EmdtScCmp:
+			return SHARED_MDCACHE_COMPARISON;
+	}
+
+	GPOS_ASSERT(!"Unexpected metadata object type");
+	return SHARED_MDCACHE_COMPARISON;
+}
+
+// return the requested metadata object; when the metadata cache shared by
+// all backends is enabled, the object is looked up there first, and added
+// to it after translating it from the catalogs
 IMDCacheObject *
 CMDProviderRelcache::GetMDObj(CMemoryPool *mp, CMDAccessor *md_accessor,
 							  IMDId *mdid) const
 {
+	// the metadata of a table being created only exists in this backend
+	if (IMDId::EmdidGPDBCtas == mdid->MdidType() ||
+		!gpdb::IsSharedMDCacheEnabled())
+	{
+		IMDCacheObject *md_obj =
+			CTranslatorRelcacheToDXL::RetrieveObject(mp, md_accessor, mdid);
+		GPOS_ASSERT(nullptr != md_obj);
+
+		return md_obj;
+	}
+
+	CAutoRg<CHAR> key(
+		CDXLUtils::CreateMultiByteCharStringFromWCString(mp, mdid->GetBuffer()));
+	uint64 generation = gpdb::GetSharedMDCacheGeneration();
+
+	Size len = 0;
+	CHAR *cached_dxl = gpdb::LookupSharedMDCache(key.Rgt(), &len);
+	if (nullptr != cached_dxl)
+	{
+		IMDCacheObject *md_obj = CDXLUtils::ParseDXLToIMDIdCacheObj(
+			mp, cached_dxl, nullptr /*xsd_file_path*/);
+		gpdb::GPDBFree(cached_dxl);
+		GPOS_ASSERT(nullptr != md_obj);
+
+		return md_obj;
+	}
+
 	IMDCacheObject *md_obj =
 		CTranslatorRelcacheToDXL::RetrieveObject(mp, md_accessor, mdid);
 	GPOS_ASSERT(nullptr != md_obj);
 
+	// cached objects are stored as binary DXL, which is faster to parse
+	ULONG dxl_len = 0;
+	CAutoRg<BYTE> dxl(
+		CDXLUtils::SerializeMDObjToBinary(mp, md_obj, &dxl_len));
+	OID relid;
+	OID objid;
+	SharedMDCacheObjType objtype =
+		GetSharedMDCacheObject(md_obj, &relid, &objid);
+	gpdb::InsertSharedMDCache(key.Rgt(), generation, (const CHAR *) dxl.Rgt(),
+							  dxl_len, objtype, relid, objid);
+
 	return md_obj;
 }
 
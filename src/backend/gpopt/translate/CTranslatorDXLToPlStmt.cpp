@@ -1267,6 +1267,13 @@ CTranslatorDXLToPlStmt::TranslateDXLHashJoin(
 		GetGPDBJoinTypeFromDXLJoinType(hashjoin_dxlop->GetJoinType());
 	join->prefetch_inner = true;
 
+	// unless unmatched outer rows are needed in the result, let the executor
+	// discard outer rows with a Bloom filter built from the inner side
+	hashjoin->runtimeFilter =
+		gp_enable_runtime_filter &&
+		(JOIN_INNER == join->jointype || JOIN_SEMI == join->jointype ||
+		 JOIN_RIGHT == join->jointype);
+
 	// translate operator costs
 	TranslatePlanCosts(hj_dxlnode, plan);
 
@@ -31,54 +31,23 @@ CMemoryPoolPalloc::CMemoryPoolPalloc()
 }
 
 void *
-CMemoryPoolPalloc::NewImpl(const ULONG bytes, const CHAR *, const ULONG,
-						   CMemoryPool::EAllocationType eat)
+CMemoryPoolPalloc::AllocSlab(ULONG bytes)
 {
-	// if it's a singleton allocation, allocate requested memory
-	if (CMemoryPool::EatSingleton == eat)
-	{
-		return gpdb::GPDBMemoryContextAlloc(m_cxt, bytes);
-	}
-	// if it's an array allocation, allocate header + requested memory
-	else
-	{
-		ULONG alloc_size = GPOS_MEM_ALIGNED_STRUCT_SIZE(SArrayAllocHeader) +
-						   GPOS_MEM_ALIGNED_SIZE(bytes);
-
-		void *ptr = gpdb::GPDBMemoryContextAlloc(m_cxt, alloc_size);
-
-		if (nullptr == ptr)
-		{
-			return nullptr;
-		}
-
-		SArrayAllocHeader *header = static_cast<SArrayAllocHeader *>(ptr);
-
-		header->m_user_size = bytes;
-		return static_cast<BYTE *>(ptr) +
-			   GPOS_MEM_ALIGNED_STRUCT_SIZE(SArrayAllocHeader);
-	}
+	return gpdb::GPDBMemoryContextAlloc(m_cxt, bytes);
 }
 
 void
-CMemoryPoolPalloc::DeleteImpl(void *ptr, CMemoryPool::EAllocationType eat)
+CMemoryPoolPalloc::FreeSlab(void *slab)
 {
-	if (CMemoryPool::EatSingleton == eat)
-	{
-		gpdb::GPDBFree(ptr);
-	}
-	else
-	{
-		void *header = static_cast<BYTE *>(ptr) -
-					   GPOS_MEM_ALIGNED_STRUCT_SIZE(SArrayAllocHeader);
-		gpdb::GPDBFree(header);
-	}
+	gpdb::GPDBFree(slab);
 }
 
-// Prepare the memory pool to be deleted
+// Prepare the memory pool to be deleted; deleting the memory context
+// releases all slabs, so the arena only needs to forget about them
 void
 CMemoryPoolPalloc::TearDown()
 {
+	ResetSlabs();
 	gpdb::GPDBMemoryContextDelete(m_cxt);
 }
 
@@ -89,17 +58,5 @@ CMemoryPoolPalloc::TotalAllocatedSize() const
 	return MemoryContextGetCurrentSpace(m_cxt);
 }
 
-// get user requested size of array allocation. Note: this is ONLY called for arrays
-ULONG
-CMemoryPoolPalloc::UserSizeOfAlloc(const void *ptr)
-{
-	GPOS_ASSERT(ptr != nullptr);
-	void *void_header = static_cast<BYTE *>(const_cast<void *>(ptr)) -
-						GPOS_MEM_ALIGNED_STRUCT_SIZE(SArrayAllocHeader);
-	const SArrayAllocHeader *header =
-		static_cast<SArrayAllocHeader *>(void_header);
-	return header->m_user_size;
-}
-
 
 // EOF
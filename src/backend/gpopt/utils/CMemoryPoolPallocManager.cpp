@@ -40,14 +40,14 @@ void
 CMemoryPoolPallocManager::DeleteImpl(void *ptr,
 									 CMemoryPool::EAllocationType eat)
 {
-	CMemoryPoolPalloc::DeleteImpl(ptr, eat);
+	CMemoryPoolArena::DeleteImpl(ptr, eat);
 }
 
 // get user requested size of allocation
 ULONG
 CMemoryPoolPallocManager::UserSizeOfAlloc(const void *ptr)
 {
-	return CMemoryPoolPalloc::UserSizeOfAlloc(ptr);
+	return CMemoryPoolArena::UserSizeOfAlloc(ptr);
 }
 
 GPOS_RESULT
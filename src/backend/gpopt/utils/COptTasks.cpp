@@ -28,6 +28,7 @@ extern "C" {
 #include "gpos/io/COstreamString.h"
 #include "gpos/memory/CAutoMemoryPool.h"
 #include "gpos/task/CAutoTraceFlag.h"
+#include "gpos/task/CTask.h"
 
 #include "gpdbcost/CCostModelGPDB.h"
 #include "gpopt/base/CAutoOptCtxt.h"
@@ -53,13 +54,17 @@ extern "C" {
 #include "gpopt/translate/CTranslatorRelcacheToDXL.h"
 #include "gpopt/translate/CTranslatorUtils.h"
 #include "gpopt/utils/CConstExprEvaluatorProxy.h"
+#include "gpopt/utils/CPlanCache.h"
 #include "gpopt/utils/gpdbdefs.h"
 #include "gpopt/xforms/CXformFactory.h"
 #include "naucrates/base/CQueryToDXLResult.h"
 #include "naucrates/dxl/CDXLUtils.h"
 #include "naucrates/dxl/CIdGenerator.h"
+#include "naucrates/dxl/operators/CDXLLogicalGet.h"
 #include "naucrates/dxl/operators/CDXLNode.h"
+#include "naucrates/dxl/operators/CDXLScalarConstValue.h"
 #include "naucrates/dxl/parser/CParseHandlerDXL.h"
+#include "naucrates/dxl/xml/CXMLSerializer.h"
 #include "naucrates/exception.h"
 #include "naucrates/init.h"
 #include "naucrates/md/CMDIdCast.h"
@@ -68,6 +73,8 @@ extern "C" {
 #include "naucrates/md/CSystemId.h"
 #include "naucrates/md/IMDId.h"
 #include "naucrates/md/IMDRelStats.h"
+#include "naucrates/md/IMDRelation.h"
+#include "naucrates/md/IMDType.h"
 #include "naucrates/traceflags/traceflags.h"
 
 using namespace gpos;
@@ -450,6 +457,142 @@ COptTasks::GetCostModel(CMemoryPool *mp, ULONG num_segments)
 	return cost_model;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::HasPartitionedTables
+//
+//	@doc:
+//		Check if a query DXL tree reads any partitioned table
+//
+//---------------------------------------------------------------------------
+BOOL
+COptTasks::HasPartitionedTables(CMDAccessor *mda, const CDXLNode *dxlnode)
+{
+	if (EdxlopLogicalGet == dxlnode->GetOperator()->GetDXLOperator())
+	{
+		CDXLLogicalGet *dxl_get =
+			CDXLLogicalGet::Cast(dxlnode->GetOperator());
+		if (mda->RetrieveRel(dxl_get->GetDXLTableDescr()->MDId())
+				->IsPartitioned())
+		{
+			return true;
+		}
+	}
+
+	const ULONG arity = dxlnode->Arity();
+	for (ULONG ul = 0; ul < arity; ul++)
+	{
+		if (HasPartitionedTables(mda, (*dxlnode)[ul]))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::CreatePlanCacheKey
+//
+//	@doc:
+//		Serialize everything the optimized plan depends on, other than
+//		metadata and the values of the query constants: the optimizer
+//		configuration, including cost model and trace flags, the number of
+//		segments and the query itself, with its constants masked by NULLs of
+//		the same types. The constants are returned in query_consts, to be
+//		bound into the cached plan.
+//
+//		Return NULL if the plan of the query is not to be cached, because
+//		the query reads partitioned tables: static partition elimination
+//		makes the shape of the plan depend on the values of its constants.
+//
+//---------------------------------------------------------------------------
+CWStringDynamic *
+COptTasks::CreatePlanCacheKey(CMemoryPool *mp, CMDAccessor *mda,
+							  COptimizerConfig *optimizer_config,
+							  ULONG num_segments, CDXLNode *query_dxl,
+							  const CDXLNodeArray *query_output_dxlnode_array,
+							  CDXLNodeArray *cte_dxlnode_array,
+							  CDXLNodeArray *query_consts)
+{
+	const ULONG num_ctes = cte_dxlnode_array->Size();
+	BOOL has_partitioned_tables = HasPartitionedTables(mda, query_dxl);
+	for (ULONG ul = 0; !has_partitioned_tables && ul < num_ctes; ul++)
+	{
+		has_partitioned_tables =
+			HasPartitionedTables(mda, (*cte_dxlnode_array)[ul]);
+	}
+	if (has_partitioned_tables)
+	{
+		return nullptr;
+	}
+
+	CDXLNodeArray *parents = GPOS_NEW(mp) CDXLNodeArray(mp);
+	ULongPtrArray *positions = GPOS_NEW(mp) ULongPtrArray(mp);
+	CPlanCache::CollectConsts(mp, query_dxl, parents, positions);
+	for (ULONG ul = 0; ul < num_ctes; ul++)
+	{
+		CPlanCache::CollectConsts(mp, (*cte_dxlnode_array)[ul], parents,
+								  positions);
+	}
+
+	// mask the constants, keeping a reference to restore them afterwards
+	const ULONG num_consts = parents->Size();
+	for (ULONG ul = 0; ul < num_consts; ul++)
+	{
+		CDXLNode *parent_dxlnode = (*parents)[ul];
+		const ULONG pos = *(*positions)[ul];
+		CDXLNode *const_dxlnode = (*parent_dxlnode)[pos];
+		const_dxlnode->AddRef();
+		query_consts->Append(const_dxlnode);
+
+		const CDXLDatum *dxl_datum =
+			CDXLScalarConstValue::Cast(const_dxlnode->GetOperator())
+				->GetDatumVal();
+		CDXLDatum *null_dxl_datum =
+			mda->RetrieveType(dxl_datum->MDId())->GetDXLDatumNull(mp);
+		parent_dxlnode->ReplaceChild(
+			pos, GPOS_NEW(mp) CDXLNode(
+					 mp, GPOS_NEW(mp) CDXLScalarConstValue(mp, null_dxl_datum)));
+	}
+
+	CWStringDynamic *key = GPOS_NEW(mp) CWStringDynamic(mp);
+	COstreamString oss(key);
+
+	CXMLSerializer xml_serializer(mp, oss, false /*indentation*/);
+	CBitSet *trace_flags = CTask::Self()->GetTaskCtxt()->copy_trace_flags(mp);
+	optimizer_config->Serialize(mp, &xml_serializer, trace_flags);
+	trace_flags->Release();
+
+	oss << num_segments;
+
+	CDXLUtils::SerializeQuery(mp, oss, query_dxl, query_output_dxlnode_array,
+							  cte_dxlnode_array,
+							  false /*serialize_document_header_footer*/,
+							  false /*indentation*/);
+
+	// restore the constants; whether they are NULL, and their type
+	// modifiers, which the masks may not carry, are part of the key
+	for (ULONG ul = 0; ul < num_consts; ul++)
+	{
+		CDXLNode *const_dxlnode = (*query_consts)[ul];
+		const_dxlnode->AddRef();
+		(*parents)[ul]->ReplaceChild(*(*positions)[ul], const_dxlnode);
+
+		const CDXLDatum *dxl_datum =
+			CDXLScalarConstValue::Cast(const_dxlnode->GetOperator())
+				->GetDatumVal();
+		oss << (dxl_datum->IsNull() ? "N" : "V")
+			<< dxl_datum->TypeModifier();
+	}
+
+	parents->Release();
+	positions->Release();
+
+	return key;
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		COptTasks::OptimizeTask
@@ -496,6 +639,31 @@ COptTasks::OptimizeTask(void *ptr)
 		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
 	}
 
+	// cached plans depend on the metadata they were optimized with, so the
+	// plan cache is purged whenever the metadata cache is
+	if (0 == optimizer_plan_cache_size)
+	{
+		if (CPlanCache::FInitialized())
+		{
+			CPlanCache::Shutdown();
+		}
+	}
+	else if (!CPlanCache::FInitialized())
+	{
+		CPlanCache::Init(optimizer_plan_cache_size * 1024L);
+	}
+	else if (reset_mdcache)
+	{
+		CPlanCache::Reset();
+	}
+
+	if (CPlanCache::FInitialized() &&
+		CPlanCache::GetCacheQuota() !=
+			(ULLONG) optimizer_plan_cache_size * 1024L)
+	{
+		CPlanCache::SetCacheQuota(optimizer_plan_cache_size * 1024L);
+	}
+
 
 	// load search strategy
 	CSearchStageArray *search_strategy_arr =
@@ -505,6 +673,8 @@ COptTasks::OptimizeTask(void *ptr)
 	CBitSet *enabled_trace_flags = nullptr;
 	CBitSet *disabled_trace_flags = nullptr;
 	CDXLNode *plan_dxl = nullptr;
+	CWStringDynamic *plan_cache_key = nullptr;
+	CDXLNodeArray *query_consts = nullptr;
 
 	IMdIdArray *col_stats = nullptr;
 	MdidHashSet *rel_stats = nullptr;
@@ -564,10 +734,42 @@ COptTasks::OptimizeTask(void *ptr)
 			CAutoTraceFlag atf2(EopttraceUseLegacyOpfamilies,
 								use_legacy_opfamilies);
 
-			plan_dxl = COptimizer::PdxlnOptimize(
-				mp, &mda, query_dxl, query_output_dxlnode_array,
-				cte_dxlnode_array, expr_evaluator, num_segments, gp_session_id,
-				gp_command_count, search_strategy_arr, optimizer_config);
+			// only plain SELECTs are cached; the plans of DML and utility
+			// statements refer to objects created for this execution
+			if (CPlanCache::FInitialized() &&
+				CMD_SELECT == opt_ctxt->m_query->commandType &&
+				PARENTSTMTTYPE_NONE == opt_ctxt->m_query->parentStmtType)
+			{
+				query_consts = GPOS_NEW(mp) CDXLNodeArray(mp);
+				plan_cache_key = CreatePlanCacheKey(
+					mp, &mda, optimizer_config, num_segments, query_dxl,
+					query_output_dxlnode_array, cte_dxlnode_array,
+					query_consts);
+			}
+
+			if (nullptr != plan_cache_key)
+			{
+				plan_dxl =
+					CPlanCache::Lookup(mp, plan_cache_key, query_consts);
+			}
+
+			if (nullptr == plan_dxl)
+			{
+				plan_dxl = COptimizer::PdxlnOptimize(
+					mp, &mda, query_dxl, query_output_dxlnode_array,
+					cte_dxlnode_array, expr_evaluator, num_segments,
+					gp_session_id, gp_command_count, search_strategy_arr,
+					optimizer_config);
+
+				if (nullptr != plan_cache_key)
+				{
+					CPlanCache::Insert(
+						mp, plan_cache_key, plan_dxl, query_consts,
+						optimizer_config->GetEnumeratorCfg()->GetPlanId(),
+						optimizer_config->GetEnumeratorCfg()
+							->GetPlanSpaceSize());
+				}
+			}
 
 			if (opt_ctxt->m_should_serialize_plan_dxl)
 			{
@@ -613,6 +815,8 @@ COptTasks::OptimizeTask(void *ptr)
 	}
 	GPOS_CATCH_EX(ex)
 	{
+		GPOS_DELETE(plan_cache_key);
+		CRefCount::SafeRelease(query_consts);
 		ResetTraceflags(enabled_trace_flags, disabled_trace_flags);
 		CRefCount::SafeRelease(rel_stats);
 		CRefCount::SafeRelease(col_stats);
@@ -634,6 +838,8 @@ COptTasks::OptimizeTask(void *ptr)
 	GPOS_CATCH_END;
 
 	// cleanup
+	GPOS_DELETE(plan_cache_key);
+	CRefCount::SafeRelease(query_consts);
 	ResetTraceflags(enabled_trace_flags, disabled_trace_flags);
 	CRefCount::SafeRelease(enabled_trace_flags);
 	CRefCount::SafeRelease(disabled_trace_flags);
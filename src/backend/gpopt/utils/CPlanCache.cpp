@@ -0,0 +1,384 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2022 VMware, Inc. or its affiliates.
+//
+//	@filename:
+//		CPlanCache.cpp
+//
+//	@doc:
+//		Implementation of the cache of optimized plans
+//
+//---------------------------------------------------------------------------
+
+#include "gpopt/utils/CPlanCache.h"
+
+#include "gpos/io/COstreamString.h"
+#include "gpos/memory/CCacheFactory.h"
+#include "gpos/string/CWStringDynamic.h"
+
+#include "naucrates/dxl/CDXLUtils.h"
+#include "naucrates/dxl/operators/CDXLDirectDispatchInfo.h"
+#include "naucrates/dxl/operators/CDXLScalarConstValue.h"
+
+using namespace gpos;
+using namespace gpdxl;
+
+// global instance of plan cache
+CPlanCache::PlanCache *CPlanCache::m_cache = nullptr;
+
+// maximum size of the cache
+ULLONG CPlanCache::m_cache_quota = UNLIMITED_CACHE_QUOTA;
+
+// lookup counters
+ULLONG CPlanCache::m_hits = 0;
+ULLONG CPlanCache::m_misses = 0;
+
+// hash function for cache lookups
+ULONG
+CPlanCache::SPlanCacheKey::HashValue(SPlanCacheKey *const &key)
+{
+	return key->m_hash;
+}
+
+// equality function for cache lookups
+BOOL
+CPlanCache::SPlanCacheKey::Equals(SPlanCacheKey *const &left,
+								  SPlanCacheKey *const &right)
+{
+	return left->m_hash == right->m_hash &&
+		   left->m_length == right->m_length &&
+		   0 == clib::Memcmp(left->m_key, right->m_key,
+							 left->m_length * GPOS_SIZEOF(WCHAR));
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CPlanCache::Init
+//
+//	@doc:
+//		Initializes global instance
+//
+//---------------------------------------------------------------------------
+void
+CPlanCache::Init(ULLONG cache_quota)
+{
+	GPOS_ASSERT(nullptr == m_cache && "Plan cache was already created");
+
+	m_cache_quota = cache_quota;
+	m_cache = CCacheFactory::CreateCache<CPlanCacheVal *, SPlanCacheKey *>(
+		true /*fUnique*/, m_cache_quota, SPlanCacheKey::HashValue,
+		SPlanCacheKey::Equals);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CPlanCache::Shutdown
+//
+//	@doc:
+//		Cleans up the underlying cache
+//
+//---------------------------------------------------------------------------
+void
+CPlanCache::Shutdown()
+{
+	GPOS_DELETE(m_cache);
+	m_cache = nullptr;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CPlanCache::Reset
+//
+//	@doc:
+//		Drop all cached plans
+//
+//---------------------------------------------------------------------------
+void
+CPlanCache::Reset()
+{
+	Shutdown();
+	Init(m_cache_quota);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CPlanCache::SetCacheQuota
+//
+//	@doc:
+//		Set the maximum size of the cache
+//
+//---------------------------------------------------------------------------
+void
+CPlanCache::SetCacheQuota(ULLONG cache_quota)
+{
+	GPOS_ASSERT(nullptr != m_cache && "Plan cache was not created");
+
+	m_cache_quota = cache_quota;
+	m_cache->SetCacheQuota(cache_quota);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CPlanCache::CollectConsts
+//
+//	@doc:
+//		Collect the scalar constants of a DXL tree, depth first, as the
+//		nodes they are children of, each with a reference added, and their
+//		positions among the children of those nodes
+//
+//---------------------------------------------------------------------------
+void
+CPlanCache::CollectConsts(CMemoryPool *mp, CDXLNode *dxlnode,
+						  CDXLNodeArray *parents, ULongPtrArray *positions)
+{
+	const ULONG arity = dxlnode->Arity();
+	for (ULONG ul = 0; ul < arity; ul++)
+	{
+		CDXLNode *child_dxlnode = (*dxlnode)[ul];
+		if (EdxlopScalarConstValue ==
+			child_dxlnode->GetOperator()->GetDXLOperator())
+		{
+			dxlnode->AddRef();
+			parents->Append(dxlnode);
+			positions->Append(GPOS_NEW(mp) ULONG(ul));
+		}
+		else
+		{
+			CollectConsts(mp, child_dxlnode, parents, positions);
+		}
+	}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CPlanCache::CreateConstBindings
+//
+//	@doc:
+//		Find, for each constant of the plan, the query constant it was
+//		derived from, by comparing their types and values. The plan can be
+//		reused for other values of the query constants only if these are
+//		pairwise distinct and each of them appears in the plan exactly once;
+//		otherwise a constant of the plan may have been derived from, or
+//		coincide with, a constant of the query that it does not stand for.
+//		Constants of the plan that match no query constant were introduced
+//		by the optimizer, and are kept as they are.
+//
+//---------------------------------------------------------------------------
+ULongPtrArray *
+CPlanCache::CreateConstBindings(CMemoryPool *mp, CDXLNode *plan_dxl,
+								const CDXLNodeArray *query_consts)
+{
+	// direct dispatch depends on the values of the distribution keys
+	CDXLDirectDispatchInfo *dxl_direct_dispatch_info =
+		plan_dxl->GetDXLDirectDispatchInfo();
+	if (nullptr != dxl_direct_dispatch_info &&
+		0 < dxl_direct_dispatch_info->GetDispatchIdentifierDatumArray()
+				->Size())
+	{
+		return nullptr;
+	}
+
+	const ULONG num_query_consts = query_consts->Size();
+	CWStringDynamic **query_const_strs =
+		GPOS_NEW_ARRAY(mp, CWStringDynamic *, num_query_consts);
+	ULONG *query_const_uses = GPOS_NEW_ARRAY(mp, ULONG, num_query_consts);
+	BOOL is_reusable = true;
+	for (ULONG ul = 0; ul < num_query_consts; ul++)
+	{
+		query_const_strs[ul] = CDXLUtils::SerializeScalarExpr(
+			mp, (*query_consts)[ul], false /*serialize_document_header_footer*/,
+			false /*indentation*/);
+		query_const_uses[ul] = 0;
+		for (ULONG prev = 0; prev < ul; prev++)
+		{
+			if (query_const_strs[ul]->Equals(query_const_strs[prev]))
+			{
+				is_reusable = false;
+			}
+		}
+	}
+
+	CDXLNodeArray *parents = GPOS_NEW(mp) CDXLNodeArray(mp);
+	ULongPtrArray *positions = GPOS_NEW(mp) ULongPtrArray(mp);
+	CollectConsts(mp, plan_dxl, parents, positions);
+
+	ULongPtrArray *const_bindings = GPOS_NEW(mp) ULongPtrArray(mp);
+	const ULONG num_plan_consts = parents->Size();
+	for (ULONG ul = 0; is_reusable && ul < num_plan_consts; ul++)
+	{
+		CDXLNode *const_dxlnode = (*(*parents)[ul])[*(*positions)[ul]];
+		CWStringDynamic *const_str = CDXLUtils::SerializeScalarExpr(
+			mp, const_dxlnode, false /*serialize_document_header_footer*/,
+			false /*indentation*/);
+
+		ULONG binding = gpos::ulong_max;
+		for (ULONG query_pos = 0; query_pos < num_query_consts; query_pos++)
+		{
+			if (const_str->Equals(query_const_strs[query_pos]))
+			{
+				binding = query_pos;
+				query_const_uses[query_pos]++;
+				break;
+			}
+		}
+		GPOS_DELETE(const_str);
+
+		const_bindings->Append(GPOS_NEW(mp) ULONG(binding));
+	}
+
+	for (ULONG ul = 0; ul < num_query_consts; ul++)
+	{
+		if (1 != query_const_uses[ul])
+		{
+			is_reusable = false;
+		}
+		GPOS_DELETE(query_const_strs[ul]);
+	}
+	GPOS_DELETE_ARRAY(query_const_strs);
+	GPOS_DELETE_ARRAY(query_const_uses);
+	parents->Release();
+	positions->Release();
+
+	if (!is_reusable)
+	{
+		const_bindings->Release();
+		return nullptr;
+	}
+
+	return const_bindings;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CPlanCache::Lookup
+//
+//	@doc:
+//		Find the plan cached for the given key and parse it into a DXL tree
+//		allocated in the given memory pool, with the values of the given
+//		query constants bound into it; return NULL if there is none
+//
+//---------------------------------------------------------------------------
+CDXLNode *
+CPlanCache::Lookup(CMemoryPool *mp, const CWStringBase *key,
+				   const CDXLNodeArray *query_consts)
+{
+	GPOS_ASSERT(nullptr != m_cache && "Plan cache was not created");
+
+	SPlanCacheKey lookup_key;
+	lookup_key.m_key = const_cast<WCHAR *>(key->GetBuffer());
+	lookup_key.m_length = key->Length();
+	lookup_key.m_hash =
+		gpos::HashByteArray((const BYTE *) lookup_key.m_key,
+							lookup_key.m_length * GPOS_SIZEOF(WCHAR));
+
+	PlanCacheAccessor accessor(m_cache);
+	accessor.Lookup(&lookup_key);
+
+	CPlanCacheVal *val = accessor.Val();
+	if (nullptr == val)
+	{
+		m_misses++;
+		return nullptr;
+	}
+
+	m_hits++;
+
+	ULLONG plan_id = 0;
+	ULLONG plan_space_size = 0;
+	CDXLNode *plan_dxl = CDXLUtils::GetPlanDXLNode(
+		mp, val->m_plan_dxl, nullptr /*xsd_file_path*/, &plan_id,
+		&plan_space_size);
+
+	CDXLNodeArray *parents = GPOS_NEW(mp) CDXLNodeArray(mp);
+	ULongPtrArray *positions = GPOS_NEW(mp) ULongPtrArray(mp);
+	CollectConsts(mp, plan_dxl, parents, positions);
+	GPOS_ASSERT(val->m_num_consts == parents->Size());
+
+	for (ULONG ul = 0; ul < val->m_num_consts; ul++)
+	{
+		const ULONG binding = val->m_const_bindings[ul];
+		if (gpos::ulong_max == binding)
+		{
+			continue;
+		}
+
+		GPOS_ASSERT(binding < query_consts->Size());
+		CDXLDatum *dxl_datum = const_cast<CDXLDatum *>(
+			CDXLScalarConstValue::Cast((*query_consts)[binding]->GetOperator())
+				->GetDatumVal());
+		dxl_datum->AddRef();
+		(*parents)[ul]->ReplaceChild(
+			*(*positions)[ul],
+			GPOS_NEW(mp) CDXLNode(
+				mp, GPOS_NEW(mp) CDXLScalarConstValue(mp, dxl_datum)));
+	}
+
+	parents->Release();
+	positions->Release();
+
+	return plan_dxl;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CPlanCache::Insert
+//
+//	@doc:
+//		Cache plan for the given key, together with the bindings of its
+//		constants to the given query constants, unless it cannot be reused
+//		for other values of them. Key, plan and bindings are copied into a
+//		memory pool owned by the cache entry, so that they outlive the query.
+//
+//---------------------------------------------------------------------------
+void
+CPlanCache::Insert(CMemoryPool *mp, const CWStringBase *key,
+				   CDXLNode *plan_dxl, const CDXLNodeArray *query_consts,
+				   ULLONG plan_id, ULLONG plan_space_size)
+{
+	GPOS_ASSERT(nullptr != m_cache && "Plan cache was not created");
+
+	ULongPtrArray *const_bindings =
+		CreateConstBindings(mp, plan_dxl, query_consts);
+	if (nullptr == const_bindings)
+	{
+		return;
+	}
+
+	CWStringDynamic plan_str(mp);
+	COstreamString oss(&plan_str);
+	CDXLUtils::SerializePlan(mp, oss, plan_dxl, plan_id, plan_space_size,
+							 true /*serialize_header_footer*/,
+							 false /*indentation*/);
+
+	PlanCacheAccessor accessor(m_cache);
+	CMemoryPool *entry_mp = accessor.Pmp();
+
+	const ULONG length = key->Length();
+	SPlanCacheKey *cache_key = GPOS_NEW(entry_mp) SPlanCacheKey;
+	cache_key->m_key = GPOS_NEW_ARRAY(entry_mp, WCHAR, length + 1);
+	clib::Memcpy(cache_key->m_key, key->GetBuffer(),
+				 (length + 1) * GPOS_SIZEOF(WCHAR));
+	cache_key->m_length = length;
+	cache_key->m_hash = gpos::HashByteArray(
+		(const BYTE *) cache_key->m_key, length * GPOS_SIZEOF(WCHAR));
+
+	CHAR *plan_dxl_str = CDXLUtils::CreateMultiByteCharStringFromWCString(
+		entry_mp, plan_str.GetBuffer());
+
+	const ULONG num_consts = const_bindings->Size();
+	ULONG *bindings = GPOS_NEW_ARRAY(entry_mp, ULONG, num_consts);
+	for (ULONG ul = 0; ul < num_consts; ul++)
+	{
+		bindings[ul] = *(*const_bindings)[ul];
+	}
+	const_bindings->Release();
+
+	CPlanCacheVal *cache_val = GPOS_NEW(entry_mp)
+		CPlanCacheVal(plan_dxl_str, bindings, num_consts);
+
+	// if the insertion fails, e.g. because of an error or because the key
+	// is already cached, the entry memory pool is destroyed by the accessor
+	(void) accessor.Insert(cache_key, cache_val);
+}
+
+// EOF
@@ -14,6 +14,7 @@
 #include "gpos/base.h"
 #include "gpos/common/CDynamicPtrArray.h"
 #include "gpos/common/CHashMap.h"
+#include "gpos/common/COpenHashMap.h"
 #include "gpos/common/CList.h"
 #include "gpos/common/DbgPrintMixin.h"
 
@@ -33,13 +34,14 @@ typedef CDynamicPtrArray<CColRef, CleanupNULL> CColRefArray;
 typedef CDynamicPtrArray<CColRefArray, CleanupRelease> CColRef2dArray;
 
 // hash map mapping ULONG -> CColRef
-typedef CHashMap<ULONG, CColRef, gpos::HashValue<ULONG>, gpos::Equals<ULONG>,
-				 CleanupDelete<ULONG>, CleanupNULL<CColRef> >
-	UlongToColRefMap;
-// iterator
-typedef CHashMapIter<ULONG, CColRef, gpos::HashValue<ULONG>,
+typedef COpenHashMap<ULONG, CColRef, gpos::HashValue<ULONG>,
 					 gpos::Equals<ULONG>, CleanupDelete<ULONG>,
 					 CleanupNULL<CColRef> >
+	UlongToColRefMap;
+// iterator
+typedef COpenHashMapIter<ULONG, CColRef, gpos::HashValue<ULONG>,
+						 gpos::Equals<ULONG>, CleanupDelete<ULONG>,
+						 CleanupNULL<CColRef> >
 	UlongToColRefMapIter;
 
 //---------------------------------------------------------------------------
@@ -238,8 +240,8 @@ operator<<(IOstream &os, CColRef &cr)
 }
 
 // hash map: CColRef -> ULONG
-typedef CHashMap<CColRef, ULONG, CColRef::HashValue, gpos::Equals<CColRef>,
-				 CleanupNULL<CColRef>, CleanupDelete<ULONG> >
+typedef COpenHashMap<CColRef, ULONG, CColRef::HashValue, gpos::Equals<CColRef>,
+					 CleanupNULL<CColRef>, CleanupDelete<ULONG> >
 	ColRefToUlongMap;
 
 typedef CDynamicPtrArray<ColRefToUlongMap, CleanupRelease>
@@ -0,0 +1,87 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2022 VMware, Inc. or its affiliates.
+//
+//	@filename:
+//		COptimizationStats.h
+//
+//	@doc:
+//		Search statistics of an optimization
+//---------------------------------------------------------------------------
+
+#ifndef GPOPT_COptimizationStats_H
+#define GPOPT_COptimizationStats_H
+
+#include "gpos/base.h"
+
+namespace gpopt
+{
+using namespace gpos;
+
+//---------------------------------------------------------------------------
+//	@class:
+//		COptimizationStats
+//
+//	@doc:
+//		Size of the search space explored by the last optimization run with
+//		an optimizer configuration, recorded by the engine once the search
+//		has terminated. Used to track the cost of optimizing a query across
+//		versions of the optimizer.
+//
+//---------------------------------------------------------------------------
+class COptimizationStats
+{
+private:
+	// number of memo groups
+	ULONG_PTR m_ulpGroups;
+
+	// number of group expressions in the memo
+	ULONG m_ulGroupExprs;
+
+	// number of optimization jobs executed by the scheduler
+	ULONG_PTR m_ulpJobs;
+
+public:
+	COptimizationStats(const COptimizationStats &) = delete;
+
+	// ctor
+	COptimizationStats() : m_ulpGroups(0), m_ulGroupExprs(0), m_ulpJobs(0)
+	{
+	}
+
+	// record statistics of an optimization
+	void
+	Record(ULONG_PTR ulpGroups, ULONG ulGroupExprs, ULONG_PTR ulpJobs)
+	{
+		m_ulpGroups = ulpGroups;
+		m_ulGroupExprs = ulGroupExprs;
+		m_ulpJobs = ulpJobs;
+	}
+
+	// number of memo groups
+	ULONG_PTR
+	UlpGroups() const
+	{
+		return m_ulpGroups;
+	}
+
+	// number of group expressions in the memo
+	ULONG
+	UlGroupExprs() const
+	{
+		return m_ulGroupExprs;
+	}
+
+	// number of optimization jobs executed
+	ULONG_PTR
+	UlpJobs() const
+	{
+		return m_ulpJobs;
+	}
+
+};	// class COptimizationStats
+}  // namespace gpopt
+
+#endif	// !GPOPT_COptimizationStats_H
+
+// EOF
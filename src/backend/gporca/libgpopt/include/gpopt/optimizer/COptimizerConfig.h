@@ -21,6 +21,7 @@
 #include "gpopt/engine/CEnumeratorConfig.h"
 #include "gpopt/engine/CHint.h"
 #include "gpopt/engine/CStatisticsConfig.h"
+#include "gpopt/optimizer/COptimizationStats.h"
 
 namespace gpopt
 {
@@ -65,6 +66,10 @@ private:
 	// default window oids
 	CWindowOids *m_window_oids;
 
+	// statistics of the last optimization with this configuration; not
+	// part of the configuration proper and not serialized
+	COptimizationStats m_optimization_stats;
+
 public:
 	// ctor
 	COptimizerConfig(CEnumeratorConfig *pec, CStatisticsConfig *stats_config,
@@ -117,6 +122,13 @@ public:
 		return m_hint;
 	}
 
+	// statistics of the last optimization with this configuration
+	COptimizationStats *
+	GetOptimizationStats()
+	{
+		return &m_optimization_stats;
+	}
+
 	// generate default optimizer configurations
 	static COptimizerConfig *PoconfDefault(CMemoryPool *mp);
 
@@ -32,7 +32,7 @@ class CSchedulerContext;
 //		CScheduler
 //
 //	@doc:
-//		MT-scheduler for optimization jobs
+//		Scheduler for optimization jobs
 //
 //		Maintaining job dependencies and controlling the order of job execution
 //		are the main responsibilities of job scheduler.
@@ -51,6 +51,14 @@ class CSchedulerContext;
 //		complete. At this point, a queued job can be terminated if it does not
 //		have any further dependencies.
 //
+//		All jobs run on the single worker owned by CWorkerPoolManager. Jobs
+//		allocate from the optimizer's memory pool, which is backed by palloc
+//		in the server, and report errors through the GPDB error handling
+//		wrappers; neither may be entered from more than one thread, so the
+//		scheduler does not hand out jobs to additional workers. The CSync*
+//		containers used here and in the memo are single-threaded and remain
+//		only for API compatibility.
+//
 //---------------------------------------------------------------------------
 class CScheduler
 {
@@ -188,6 +196,13 @@ public:
 	// print statistics
 	void PrintStats() const;
 
+	// number of completed jobs
+	ULONG_PTR
+	UlpCompletedJobs() const
+	{
+		return m_ulpStatsCompleted;
+	}
+
 #ifdef GPOS_DEBUG
 	// get flag for tracking jobs
 	BOOL
@@ -1720,6 +1720,11 @@ CEngine::Optimize()
 		FinalizeSearchStage();
 	}
 
+	// record the size of the explored search space
+	COptimizerConfig *optimizer_config =
+		COptCtxt::PoctxtFromTLS()->GetOptimizerConfig();
+	optimizer_config->GetOptimizationStats()->Record(
+		m_pmemo->UlpGroups(), m_pmemo->UlGrpExprs(), sched.UlpCompletedJobs());
 
 	if (GPOS_FTRACE(EopttracePrintOptimizationStatistics))
 	{
@@ -14,6 +14,7 @@
 #include "gpopt/translate/CTranslatorDXLToExpr.h"
 
 #include "gpos/common/CAutoTimer.h"
+#include "gpos/common/COpenHashMapIter.h"
 
 #include "gpopt/base/CAutoOptCtxt.h"
 #include "gpopt/base/CColRef.h"
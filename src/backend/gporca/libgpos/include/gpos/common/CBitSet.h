@@ -6,7 +6,8 @@
 //		CBitSet.h
 //
 //	@doc:
-//		Implementation of bitset as linked list of bitvectors
+//		Implementation of bitset as linked list of bitvectors; the first
+//		bitvector is kept inline in the set
 //---------------------------------------------------------------------------
 #ifndef GPOS_CBitSet_H
 #define GPOS_CBitSet_H
@@ -17,6 +18,10 @@
 #include "gpos/common/CList.h"
 #include "gpos/common/DbgPrintMixin.h"
 
+// maximum number of bits kept inline in a bit set
+#define GPOS_BITSET_INLINE_BITS (1024)
+#define GPOS_BITSET_INLINE_WORDS (GPOS_BITSET_INLINE_BITS / 64)
+
 
 namespace gpos
 {
@@ -27,6 +32,13 @@ namespace gpos
 //	@doc:
 //		Linked list of CBitSetLink's
 //
+//		Most sets only contain small ids, e.g. column ids of a query, so
+//		the bits in [0, vector size) are stored in a fixed-width inline
+//		array whenever the vector size does not exceed
+//		GPOS_BITSET_INLINE_BITS. Set operations on this range are plain
+//		word-parallel loops that the compiler can vectorize, and need no
+//		allocation; links are only created for larger, sparse ids.
+//
 //---------------------------------------------------------------------------
 class CBitSet : public CRefCount, public DbgPrintMixin<CBitSet>
 {
@@ -93,6 +105,12 @@ protected:
 	// number of elements
 	ULONG m_size;
 
+	// number of bits stored inline; either m_vector_size or zero
+	ULONG m_inline_bits;
+
+	// bits in [0, m_inline_bits)
+	ULLONG m_inline[GPOS_BITSET_INLINE_WORDS];
+
 	// private copy ctor
 	CBitSet(const CBitSet &);
 
@@ -108,6 +126,23 @@ protected:
 	// re-compute size of set
 	void RecomputeSize();
 
+	// number of inline words in use
+	ULONG
+	InlineWords() const
+	{
+		return (m_inline_bits + 63) / 64;
+	}
+
+	// is given bit stored inline
+	BOOL
+	IsInline(ULONG pos) const
+	{
+		return pos < m_inline_bits;
+	}
+
+	// find next inline bit from given position
+	BOOL GetNextInlineBit(ULONG start_pos, ULONG &next_pos) const;
+
 public:
 	// ctor
 	CBitSet(CMemoryPool *mp, ULONG vector_size = 256);
@@ -37,6 +37,9 @@ private:
 	// current cursor link
 	CBitSet::CBitSetLink *m_bsl;
 
+	// is cursor in the inline bits of the set
+	BOOL m_in_inline;
+
 	// is iterator active or exhausted
 	BOOL m_active;
 
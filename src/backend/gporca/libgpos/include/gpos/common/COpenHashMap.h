@@ -0,0 +1,384 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2022 VMware, Inc. or its affiliates.
+//
+//	@filename:
+//		COpenHashMap.h
+//
+//	@doc:
+//		Hash map using open addressing; drop-in replacement for CHashMap
+//		* stores deep objects, i.e., pointers
+//		* equality == on key uses template function argument
+//		* does not allow insertion of duplicates (no equality on value class req'd)
+//		* destroys objects based on client-side provided destroy functions
+//---------------------------------------------------------------------------
+#ifndef GPOS_COpenHashMap_H
+#define GPOS_COpenHashMap_H
+
+#include "gpos/base.h"
+#include "gpos/common/CDynamicPtrArray.h"
+#include "gpos/common/CRefCount.h"
+
+// smallest number of slots allocated for a map
+#define GPOS_OPEN_HASHMAP_MIN_SLOTS (8)
+
+namespace gpos
+{
+// fwd declaration
+template <class K, class T, ULONG (*HashFn)(const K *),
+		  BOOL (*EqFn)(const K *, const K *), void (*DestroyKFn)(K *),
+		  void (*DestroyTFn)(T *)>
+class COpenHashMapIter;
+
+//---------------------------------------------------------------------------
+//	@class:
+//		COpenHashMap
+//
+//	@doc:
+//		Hash map with the same interface as CHashMap.
+//
+//		Entries are kept in a dense array in insertion order, which is also
+//		the order of iteration. They are indexed by a power-of-two table of
+//		slots using linear probing with Robin Hood displacement. Each slot
+//		holds the full hash value of its entry, so that a lookup only
+//		dereferences an entry, and calls the equality function, when the
+//		hash values match. Probing stops as soon as it reaches a slot whose
+//		entry is closer to its home slot than the key being looked up.
+//
+//---------------------------------------------------------------------------
+template <class K, class T, ULONG (*HashFn)(const K *),
+		  BOOL (*EqFn)(const K *, const K *), void (*DestroyKFn)(K *),
+		  void (*DestroyTFn)(T *)>
+class COpenHashMap : public CRefCount
+{
+	// fwd declaration
+	friend class COpenHashMapIter<K, T, HashFn, EqFn, DestroyKFn, DestroyTFn>;
+
+private:
+	// key/value pair; key is NULL for deleted entries
+	struct SEntry
+	{
+		K *m_key;
+		T *m_value;
+	};
+
+	// slot of the open addressing table
+	struct SSlot
+	{
+		// hash value of the entry's key
+		ULONG m_hash;
+
+		// index of the entry plus one; zero for empty slots
+		ULONG m_entry;
+	};
+
+	// memory pool
+	CMemoryPool *const m_mp;
+
+	// number of live entries
+	ULONG m_size;
+
+	// entries in insertion order, including deleted ones
+	SEntry *m_entries;
+
+	// number of used and allocated entries
+	ULONG m_num_entries;
+	ULONG m_entries_capacity;
+
+	// table of slots, allocated on first insert
+	SSlot *m_slots;
+
+	// number of slots; always a power of two
+	ULONG m_num_slots;
+
+	// log2 of the number of slots
+	ULONG m_slots_log2;
+
+	// map hash value to its home slot; multiplicative hashing spreads
+	// hash functions that leave the low-order bits unused, e.g. on pointers
+	ULONG
+	HomeSlot(ULONG hash) const
+	{
+		return (ULONG)(hash * 2654435769U) >> (32 - m_slots_log2);
+	}
+
+	// distance of the entry in given slot from its home slot
+	ULONG
+	ProbeDistance(ULONG pos) const
+	{
+		return (pos - HomeSlot(m_slots[pos].m_hash)) & (m_num_slots - 1);
+	}
+
+	// find slot holding given key; return m_num_slots if not found
+	ULONG
+	LookupSlot(const K *key, ULONG hash) const
+	{
+		if (0 == m_size)
+		{
+			return m_num_slots;
+		}
+
+		const ULONG mask = m_num_slots - 1;
+		ULONG pos = HomeSlot(hash);
+		for (ULONG dist = 0; 0 != m_slots[pos].m_entry; dist++)
+		{
+			if (ProbeDistance(pos) < dist)
+			{
+				// key would have displaced this entry
+				break;
+			}
+
+			if (m_slots[pos].m_hash == hash &&
+				EqFn(m_entries[m_slots[pos].m_entry - 1].m_key, key))
+			{
+				return pos;
+			}
+
+			pos = (pos + 1) & mask;
+		}
+
+		return m_num_slots;
+	}
+
+	// place slot into the table, displacing entries closer to home
+	void
+	InsertSlot(SSlot slot)
+	{
+		const ULONG mask = m_num_slots - 1;
+		ULONG pos = HomeSlot(slot.m_hash);
+		ULONG dist = 0;
+		while (0 != m_slots[pos].m_entry)
+		{
+			ULONG existing_dist = ProbeDistance(pos);
+			if (existing_dist < dist)
+			{
+				SSlot displaced = m_slots[pos];
+				m_slots[pos] = slot;
+				slot = displaced;
+				dist = existing_dist;
+			}
+
+			pos = (pos + 1) & mask;
+			dist++;
+		}
+
+		m_slots[pos] = slot;
+	}
+
+	// grow slot table and compact entries when the load factor is exceeded
+	void
+	Grow()
+	{
+		ULONG num_slots = m_num_slots;
+		ULONG slots_log2 = m_slots_log2;
+		while (4 * (m_size + 1) > 3 * num_slots)
+		{
+			num_slots *= 2;
+			slots_log2++;
+		}
+
+		if (nullptr != m_slots && num_slots == m_num_slots &&
+			m_num_entries < m_entries_capacity)
+		{
+			return;
+		}
+
+		// compact entries, dropping the deleted ones
+		ULONG live = 0;
+		for (ULONG ul = 0; ul < m_num_entries; ul++)
+		{
+			if (nullptr != m_entries[ul].m_key)
+			{
+				m_entries[live++] = m_entries[ul];
+			}
+		}
+		m_num_entries = live;
+
+		if (m_num_entries == m_entries_capacity)
+		{
+			ULONG capacity = GPOS_OPEN_HASHMAP_MIN_SLOTS;
+			if (capacity < 2 * m_entries_capacity)
+			{
+				capacity = 2 * m_entries_capacity;
+			}
+			SEntry *entries = GPOS_NEW_ARRAY(m_mp, SEntry, capacity);
+			if (0 < m_num_entries)
+			{
+				clib::Memcpy(entries, m_entries,
+							 m_num_entries * sizeof(SEntry));
+			}
+			GPOS_DELETE_ARRAY(m_entries);
+			m_entries = entries;
+			m_entries_capacity = capacity;
+		}
+
+		if (nullptr == m_slots || num_slots != m_num_slots)
+		{
+			GPOS_DELETE_ARRAY(m_slots);
+			m_slots = GPOS_NEW_ARRAY(m_mp, SSlot, num_slots);
+			m_num_slots = num_slots;
+			m_slots_log2 = slots_log2;
+		}
+
+		// re-index all entries
+		(void) clib::Memset(m_slots, 0, m_num_slots * sizeof(SSlot));
+		for (ULONG ul = 0; ul < m_num_entries; ul++)
+		{
+			SSlot slot = {HashFn(m_entries[ul].m_key), ul + 1};
+			InsertSlot(slot);
+		}
+	}
+
+	// remove slot at given position, shifting back the following entries
+	void
+	RemoveSlot(ULONG pos)
+	{
+		const ULONG mask = m_num_slots - 1;
+		ULONG next = (pos + 1) & mask;
+		while (0 != m_slots[next].m_entry && 0 < ProbeDistance(next))
+		{
+			m_slots[pos] = m_slots[next];
+			pos = next;
+			next = (next + 1) & mask;
+		}
+
+		m_slots[pos].m_entry = 0;
+	}
+
+public:
+	COpenHashMap(const COpenHashMap<K, T, HashFn, EqFn, DestroyKFn,
+									DestroyTFn> &) = delete;
+
+	// ctor; the size hint determines the initial number of slots
+	COpenHashMap<K, T, HashFn, EqFn, DestroyKFn, DestroyTFn>(
+		CMemoryPool *mp, ULONG size_hint = 127)
+		: m_mp(mp),
+		  m_size(0),
+		  m_entries(nullptr),
+		  m_num_entries(0),
+		  m_entries_capacity(0),
+		  m_slots(nullptr),
+		  m_num_slots(GPOS_OPEN_HASHMAP_MIN_SLOTS),
+		  m_slots_log2(3)
+	{
+		GPOS_ASSERT(size_hint > 0);
+		while (m_num_slots < size_hint && m_slots_log2 < 31)
+		{
+			m_num_slots *= 2;
+			m_slots_log2++;
+		}
+	}
+
+	// dtor
+	~COpenHashMap<K, T, HashFn, EqFn, DestroyKFn, DestroyTFn>() override
+	{
+		for (ULONG ul = 0; ul < m_num_entries; ul++)
+		{
+			if (nullptr != m_entries[ul].m_key)
+			{
+				DestroyKFn(m_entries[ul].m_key);
+				DestroyTFn(m_entries[ul].m_value);
+			}
+		}
+
+		GPOS_DELETE_ARRAY(m_entries);
+		GPOS_DELETE_ARRAY(m_slots);
+	}
+
+	// insert an element if key is not yet present
+	BOOL
+	Insert(K *key, T *value)
+	{
+		GPOS_ASSERT(nullptr != key);
+
+		const ULONG hash = HashFn(key);
+		if (m_num_slots != LookupSlot(key, hash))
+		{
+			return false;
+		}
+
+		if (nullptr == m_slots || 4 * (m_size + 1) > 3 * m_num_slots ||
+			m_num_entries == m_entries_capacity)
+		{
+			Grow();
+		}
+
+		m_entries[m_num_entries].m_key = key;
+		m_entries[m_num_entries].m_value = value;
+		m_num_entries++;
+
+		SSlot slot = {hash, m_num_entries};
+		InsertSlot(slot);
+		m_size++;
+
+		return true;
+	}
+
+	// lookup a value by its key
+	T *
+	Find(const K *key) const
+	{
+		ULONG pos = LookupSlot(key, HashFn(key));
+		if (m_num_slots != pos)
+		{
+			return m_entries[m_slots[pos].m_entry - 1].m_value;
+		}
+
+		return nullptr;
+	}
+
+	// replace the value in a map entry with a new given value
+	BOOL
+	Replace(const K *key, T *ptNew)
+	{
+		GPOS_ASSERT(nullptr != key);
+
+		ULONG pos = LookupSlot(key, HashFn(key));
+		if (m_num_slots != pos)
+		{
+			SEntry &entry = m_entries[m_slots[pos].m_entry - 1];
+			DestroyTFn(entry.m_value);
+			entry.m_value = ptNew;
+
+			return true;
+		}
+
+		return false;
+	}
+
+	// remove entry with given key
+	BOOL
+	Delete(const K *key)
+	{
+		ULONG pos = LookupSlot(key, HashFn(key));
+		if (m_num_slots == pos)
+		{
+			return false;
+		}
+
+		SEntry &entry = m_entries[m_slots[pos].m_entry - 1];
+		DestroyKFn(entry.m_key);
+		DestroyTFn(entry.m_value);
+		entry.m_key = nullptr;
+		entry.m_value = nullptr;
+
+		RemoveSlot(pos);
+		m_size--;
+
+		return true;
+	}
+
+	// return number of map entries
+	ULONG
+	Size() const
+	{
+		return m_size;
+	}
+
+};	// class COpenHashMap
+
+}  // namespace gpos
+
+#endif	// !GPOS_COpenHashMap_H
+
+// EOF
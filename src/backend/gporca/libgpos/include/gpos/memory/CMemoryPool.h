@@ -152,6 +152,14 @@ public:
 		return 0;
 	}
 
+	// return highest total allocated size since the pool was created
+	virtual ULLONG
+	PeakAllocatedSize() const
+	{
+		GPOS_ASSERT(!"not supported");
+		return 0;
+	}
+
 	// requested size of allocation
 	static ULONG UserSizeOfAlloc(const void *ptr);
 
@@ -0,0 +1,183 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2022 VMware, Inc. or its affiliates.
+//
+//	@filename:
+//		CMemoryPoolArena.h
+//
+//	@doc:
+//		Memory pool that carves allocations out of large slabs;
+//		freed chunks are kept on per-size-class free lists and all
+//		slabs are released at once when the pool is torn down
+//
+//---------------------------------------------------------------------------
+#ifndef GPOS_CMemoryPoolArena_H
+#define GPOS_CMemoryPoolArena_H
+
+#include "gpos/assert.h"
+#include "gpos/memory/CMemoryPool.h"
+#include "gpos/types.h"
+
+// number of power-of-two size classes, smallest class holds 8 bytes
+#define GPOS_MEM_ARENA_NUM_CLASSES (11)
+
+// largest request served from a size class; bigger requests get their own slab
+#define GPOS_MEM_ARENA_CHUNK_LIMIT \
+	(GPOS_MEM_ARCH << (GPOS_MEM_ARENA_NUM_CLASSES - 1))
+
+// size of the first slab, doubled for every new slab up to the max size
+#define GPOS_MEM_ARENA_INIT_SLAB_SIZE (8 * 1024)
+#define GPOS_MEM_ARENA_MAX_SLAB_SIZE (1024 * 1024)
+
+namespace gpos
+{
+// Region-style memory pool.
+//
+// Unlike CMemoryPoolTracker, which mallocs every object separately, this pool
+// requests memory from the underlying allocator in slabs and bump-allocates
+// objects out of the current slab. Individual frees push the chunk onto a free
+// list for its size class, from where it is reused by later allocations of the
+// same class. Requests larger than GPOS_MEM_ARENA_CHUNK_LIMIT are given a
+// dedicated slab which is returned as soon as the object is freed.
+//
+// Slabs are obtained through AllocSlab()/FreeSlab(); derived pools override
+// them to place slabs in a different allocator (e.g., a Postgres memory
+// context), so that the cost of that allocator is paid per slab rather than
+// per object.
+class CMemoryPoolArena : public CMemoryPool
+{
+private:
+	// header preceding every chunk handed out by the pool
+	struct SArenaAllocHeader
+	{
+		// owning pool
+		CMemoryPoolArena *m_mp;
+
+		// user requested size
+		ULONG m_user_size;
+
+		// size class, or GPOS_MEM_ARENA_NUM_CLASSES for dedicated slabs
+		ULONG m_size_class;
+	};
+
+	// header of every slab obtained from the underlying allocator
+	struct SArenaSlab
+	{
+		// next and previous slab in the owning list
+		SArenaSlab *m_next;
+		SArenaSlab *m_prev;
+
+		// total size of the slab, including this header
+		ULONG m_size;
+	};
+
+	// overlay on the user area of a freed chunk
+	struct SFreeChunk
+	{
+		SFreeChunk *m_next;
+	};
+
+	// slabs used for size-class allocations
+	SArenaSlab *m_slabs{nullptr};
+
+	// dedicated slabs for large allocations
+	SArenaSlab *m_large_slabs{nullptr};
+
+	// bump pointer and end of free space in the current slab
+	BYTE *m_cur{nullptr};
+	BYTE *m_end{nullptr};
+
+	// size of next slab to allocate
+	ULONG m_next_slab_size{GPOS_MEM_ARENA_INIT_SLAB_SIZE};
+
+	// free lists per size class
+	SFreeChunk *m_free_lists[GPOS_MEM_ARENA_NUM_CLASSES];
+
+	// total bytes obtained from the underlying allocator
+	ULLONG m_total_allocated_size{0};
+
+	// highest total of bytes obtained from the underlying allocator
+	ULLONG m_peak_allocated_size{0};
+
+	// map requested size to size class
+	static ULONG SizeClass(ULONG bytes);
+
+	// size of the chunk for a given size class, including header
+	static ULONG ChunkSize(ULONG size_class);
+
+	// add slab to the head of given list
+	static void LinkSlab(SArenaSlab **list, SArenaSlab *slab);
+
+	// remove slab from given list
+	static void UnlinkSlab(SArenaSlab **list, SArenaSlab *slab);
+
+	// obtain a new slab and make it current
+	void NewSlab(ULONG min_bytes);
+
+	// allocate a chunk of the given size class
+	SArenaAllocHeader *AllocChunk(ULONG size_class);
+
+	// allocate a dedicated slab for a large request
+	SArenaAllocHeader *AllocLarge(ULONG bytes);
+
+	// return chunk to the pool
+	void FreeChunk(SArenaAllocHeader *header);
+
+	// release all slabs in the given list
+	void FreeSlabList(SArenaSlab *list);
+
+protected:
+	// obtain memory for a slab from the underlying allocator
+	virtual void *AllocSlab(ULONG bytes);
+
+	// return slab memory to the underlying allocator
+	virtual void FreeSlab(void *slab);
+
+	// release all slabs at once; derived pools whose underlying allocator
+	// frees everything in bulk skip the per-slab release
+	void ReleaseSlabs();
+
+	// forget all slabs without releasing them
+	void ResetSlabs();
+
+public:
+	CMemoryPoolArena(CMemoryPoolArena &) = delete;
+
+	// ctor
+	CMemoryPoolArena();
+
+	// dtor
+	~CMemoryPoolArena() override;
+
+	// prepare the memory pool to be deleted
+	void TearDown() override;
+
+	// allocate memory
+	void *NewImpl(const ULONG bytes, const CHAR *file, const ULONG line,
+				  CMemoryPool::EAllocationType eat) override;
+
+	// free memory allocation
+	static void DeleteImpl(void *ptr, CMemoryPool::EAllocationType eat);
+
+	// get user requested size of allocation
+	static ULONG UserSizeOfAlloc(const void *ptr);
+
+	// return total allocated size, including free chunks and slab overheads
+	ULLONG
+	TotalAllocatedSize() const override
+	{
+		return m_total_allocated_size;
+	}
+
+	// return highest total allocated size since the pool was created
+	ULLONG
+	PeakAllocatedSize() const override
+	{
+		return m_peak_allocated_size;
+	}
+};
+}  // namespace gpos
+
+#endif	// !GPOS_CMemoryPoolArena_H
+
+// EOF
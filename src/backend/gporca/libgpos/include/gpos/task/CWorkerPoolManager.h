@@ -62,7 +62,9 @@ private:
 	// active flag
 	BOOL m_active;
 
-	// we only support a single worker now
+	// we only support a single worker now; the optimizer runs inside a
+	// server backend whose memory contexts and error handling are not
+	// thread-safe, so tasks are never dispatched to additional threads
 	CWorker *m_single_worker;
 
 	// task storage
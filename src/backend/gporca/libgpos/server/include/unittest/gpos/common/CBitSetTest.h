@@ -32,6 +32,8 @@ public:
 	static GPOS_RESULT EresUnittest_Removal();
 	static GPOS_RESULT EresUnittest_SetOps();
 	static GPOS_RESULT EresUnittest_Performance();
+	static GPOS_RESULT EresUnittest_InlineAndLinks();
+	static GPOS_RESULT EresUnittest_SetOpsBenchmark();
 
 };	// class CBitSetTest
 }  // namespace gpos
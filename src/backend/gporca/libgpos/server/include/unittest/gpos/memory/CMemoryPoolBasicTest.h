@@ -45,6 +45,7 @@ public:
 	static GPOS_RESULT EresUnittest_Print();
 #endif	// GPOS_DEBUG
 	static GPOS_RESULT EresUnittest_TestTracker();
+	static GPOS_RESULT EresUnittest_TestArena();
 	static GPOS_RESULT EresUnittest_TestSlab();
 
 };	// class CMemoryPoolBasicTest
@@ -31,6 +31,7 @@
 #include "unittest/gpos/common/CHashSetIterTest.h"
 #include "unittest/gpos/common/CHashSetTest.h"
 #include "unittest/gpos/common/CListTest.h"
+#include "unittest/gpos/common/COpenHashMapTest.h"
 #include "unittest/gpos/common/CRefCountTest.h"
 #include "unittest/gpos/common/CStackTest.h"
 #include "unittest/gpos/common/CSyncHashtableTest.h"
@@ -69,6 +70,7 @@ static gpos::CUnittest rgut[] = {
 	GPOS_UNITTEST_STD(CDoubleTest),
 	GPOS_UNITTEST_STD(CHashMapTest),
 	GPOS_UNITTEST_STD(CHashMapIterTest),
+	GPOS_UNITTEST_STD(COpenHashMapTest),
 	GPOS_UNITTEST_STD(CHashSetTest),
 	GPOS_UNITTEST_STD(CHashSetIterTest),
 	GPOS_UNITTEST_STD(CRefCountTest),
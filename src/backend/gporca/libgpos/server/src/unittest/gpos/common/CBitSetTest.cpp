@@ -12,7 +12,9 @@
 #include "unittest/gpos/common/CBitSetTest.h"
 
 #include "gpos/base.h"
+#include "gpos/common/CAutoTimer.h"
 #include "gpos/common/CBitSet.h"
+#include "gpos/common/CBitSetIter.h"
 #include "gpos/io/COstreamString.h"
 #include "gpos/memory/CAutoMemoryPool.h"
 #include "gpos/string/CWStringDynamic.h"
@@ -35,7 +37,9 @@ CBitSetTest::EresUnittest()
 		GPOS_UNITTEST_FUNC(CBitSetTest::EresUnittest_Basics),
 		GPOS_UNITTEST_FUNC(CBitSetTest::EresUnittest_Removal),
 		GPOS_UNITTEST_FUNC(CBitSetTest::EresUnittest_SetOps),
-		GPOS_UNITTEST_FUNC(CBitSetTest::EresUnittest_Performance)};
+		GPOS_UNITTEST_FUNC(CBitSetTest::EresUnittest_Performance),
+		GPOS_UNITTEST_FUNC(CBitSetTest::EresUnittest_InlineAndLinks),
+		GPOS_UNITTEST_FUNC(CBitSetTest::EresUnittest_SetOpsBenchmark)};
 
 	return CUnittest::EresExecute(rgut, GPOS_ARRAY_SIZE(rgut));
 }
@@ -249,4 +253,127 @@ CBitSetTest::EresUnittest_Performance()
 	return GPOS_OK;
 }
 
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBitSetTest::EresUnittest_InlineAndLinks
+//
+//	@doc:
+//		Set operations on sets holding both inline bits and links
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+CBitSetTest::EresUnittest_InlineAndLinks()
+{
+	// create memory pool
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	ULONG vector_size = 256;
+	ULONG cInserts = 20;
+
+	// even elements, half of them beyond the inline range
+	CBitSet *pbs1 = GPOS_NEW(mp) CBitSet(mp, vector_size);
+	for (ULONG i = 0; i < cInserts; i += 2)
+	{
+		pbs1->ExchangeSet(i * vector_size / 8);
+	}
+
+	// odd elements
+	CBitSet *pbs2 = GPOS_NEW(mp) CBitSet(mp, vector_size);
+	for (ULONG i = 1; i < cInserts; i += 2)
+	{
+		pbs2->ExchangeSet(i * vector_size / 8);
+	}
+
+	CBitSet *pbs = GPOS_NEW(mp) CBitSet(mp, *pbs1);
+	pbs->Union(pbs2);
+	GPOS_RTL_ASSERT(cInserts == pbs->Size());
+	GPOS_RTL_ASSERT(pbs->ContainsAll(pbs1) && pbs->ContainsAll(pbs2));
+	GPOS_RTL_ASSERT(pbs1->IsDisjoint(pbs2) && !pbs->IsDisjoint(pbs2));
+
+	// iteration must visit inline bits and links in ascending order
+	CBitSetIter bsi(*pbs);
+	for (ULONG i = 0; i < cInserts; i++)
+	{
+		GPOS_RTL_ASSERT(bsi.Advance());
+		GPOS_RTL_ASSERT(i * vector_size / 8 == bsi.Bit());
+	}
+	GPOS_RTL_ASSERT(!bsi.Advance());
+
+	pbs->Difference(pbs2);
+	GPOS_RTL_ASSERT(pbs->Equals(pbs1));
+	GPOS_RTL_ASSERT(pbs->HashValue() == pbs1->HashValue());
+
+	pbs->Union(pbs2);
+	pbs->Intersection(pbs2);
+	GPOS_RTL_ASSERT(pbs->Equals(pbs2));
+	GPOS_RTL_ASSERT(!pbs->Get(0) && pbs->Get(vector_size / 8));
+
+	pbs->Release();
+	pbs2->Release();
+	pbs1->Release();
+
+	return GPOS_OK;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBitSetTest::EresUnittest_SetOpsBenchmark
+//
+//	@doc:
+//		Micro-benchmark of the set operations used in property derivation,
+//		once for sets of small ids held inline and once for sets of large,
+//		sparse ids held in links
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+CBitSetTest::EresUnittest_SetOpsBenchmark()
+{
+	// create memory pool
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	const ULONG vector_size = 1024;
+	const ULONG ulIters = 100000;
+	const ULONG rgulBase[] = {0, 64 * vector_size};
+
+	for (ULONG ulRun = 0; ulRun < GPOS_ARRAY_SIZE(rgulBase); ulRun++)
+	{
+		const ULONG ulBase = rgulBase[ulRun];
+
+		CBitSet *pbsOuter = GPOS_NEW(mp) CBitSet(mp, vector_size);
+		CBitSet *pbsInner = GPOS_NEW(mp) CBitSet(mp, vector_size);
+		for (ULONG i = 0; i < 200; i++)
+		{
+			(void) pbsOuter->ExchangeSet(ulBase + i * 3);
+			(void) pbsInner->ExchangeSet(ulBase + i * 3 + (i % 2));
+		}
+
+		ULONG ulHits = 0;
+		{
+			CAutoTimer at(0 == ulBase ? "Inline set ops" : "Linked set ops",
+						  true /*fPrint*/);
+			for (ULONG j = 0; j < ulIters; j++)
+			{
+				CBitSet *pbs = GPOS_NEW(mp) CBitSet(mp, *pbsOuter);
+				pbs->Union(pbsInner);
+				pbs->Intersection(pbsOuter);
+				if (pbs->ContainsAll(pbsInner) || pbs->Equals(pbsOuter))
+				{
+					ulHits++;
+				}
+				pbs->Release();
+			}
+		}
+		GPOS_RTL_ASSERT(ulIters == ulHits);
+
+		pbsInner->Release();
+		pbsOuter->Release();
+	}
+
+	return GPOS_OK;
+}
+
 // EOF
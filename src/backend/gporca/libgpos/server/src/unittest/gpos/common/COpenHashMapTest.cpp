@@ -0,0 +1,339 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2022 VMware, Inc. or its affiliates.
+//
+//	@filename:
+//		COpenHashMapTest.cpp
+//
+//	@doc:
+//		Test for COpenHashMap
+//---------------------------------------------------------------------------
+
+#include "unittest/gpos/common/COpenHashMapTest.h"
+
+#include "gpos/base.h"
+#include "gpos/common/CAutoTimer.h"
+#include "gpos/common/CHashMap.h"
+#include "gpos/common/COpenHashMap.h"
+#include "gpos/common/COpenHashMapIter.h"
+#include "gpos/memory/CAutoMemoryPool.h"
+#include "gpos/test/CUnittest.h"
+
+using namespace gpos;
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COpenHashMapTest::EresUnittest
+//
+//	@doc:
+//		Unittest for open addressing hash map
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+COpenHashMapTest::EresUnittest()
+{
+	CUnittest rgut[] = {
+		GPOS_UNITTEST_FUNC(COpenHashMapTest::EresUnittest_Basic),
+		GPOS_UNITTEST_FUNC(COpenHashMapTest::EresUnittest_Ownership),
+		GPOS_UNITTEST_FUNC(COpenHashMapTest::EresUnittest_Delete),
+		GPOS_UNITTEST_FUNC(COpenHashMapTest::EresUnittest_Benchmark),
+	};
+
+	return CUnittest::EresExecute(rgut, GPOS_ARRAY_SIZE(rgut));
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COpenHashMapTest::EresUnittest_Basic
+//
+//	@doc:
+//		Basic insertion/lookup/replace
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+COpenHashMapTest::EresUnittest_Basic()
+{
+	// create memory pool
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	ULONG_PTR rgul[] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+	CHAR rgsz[][5] = {"abc",  "def", "ghi", "qwe", "wer",
+					  "wert", "dfg", "xcv", "zxc"};
+
+	GPOS_ASSERT(GPOS_ARRAY_SIZE(rgul) == GPOS_ARRAY_SIZE(rgsz));
+	const ULONG ulCnt = GPOS_ARRAY_SIZE(rgul);
+
+	typedef COpenHashMap<ULONG_PTR, CHAR, HashPtr<ULONG_PTR>,
+						 gpos::Equals<ULONG_PTR>, CleanupNULL<ULONG_PTR>,
+						 CleanupNULL<CHAR> >
+		UlongPtrToCharMap;
+
+	// small size hint forces the map to grow
+	UlongPtrToCharMap *phm = GPOS_NEW(mp) UlongPtrToCharMap(mp, 1);
+	for (ULONG i = 0; i < ulCnt; ++i)
+	{
+		BOOL fSuccess GPOS_ASSERTS_ONLY =
+			phm->Insert(&rgul[i], (CHAR *) rgsz[i]);
+		GPOS_RTL_ASSERT(fSuccess);
+
+		for (ULONG j = 0; j <= i; ++j)
+		{
+			GPOS_RTL_ASSERT(rgsz[j] == phm->Find(&rgul[j]));
+		}
+	}
+	GPOS_RTL_ASSERT(ulCnt == phm->Size());
+
+	// test replacing entry values of existing keys
+	CHAR rgszNew[][10] = {"abc_",  "def_", "ghi_", "qwe_", "wer_",
+						  "wert_", "dfg_", "xcv_", "zxc_"};
+	for (ULONG i = 0; i < ulCnt; ++i)
+	{
+		GPOS_RTL_ASSERT(phm->Replace(&rgul[i], rgszNew[i]));
+		GPOS_RTL_ASSERT(rgszNew[i] == phm->Find(&rgul[i]));
+	}
+	GPOS_RTL_ASSERT(ulCnt == phm->Size());
+
+	// test replacing entry value of a non-existing key
+	ULONG_PTR ulp = 0;
+	GPOS_RTL_ASSERT(!phm->Replace(&ulp, rgsz[0]));
+	GPOS_RTL_ASSERT(nullptr == phm->Find(&ulp));
+
+	// iteration follows insertion order
+	typedef COpenHashMapIter<ULONG_PTR, CHAR, HashPtr<ULONG_PTR>,
+							 gpos::Equals<ULONG_PTR>, CleanupNULL<ULONG_PTR>,
+							 CleanupNULL<CHAR> >
+		UlongPtrToCharMapIter;
+
+	ULONG ulIdx = 0;
+	UlongPtrToCharMapIter hmi(phm);
+	while (hmi.Advance())
+	{
+		GPOS_RTL_ASSERT(&rgul[ulIdx] == hmi.Key());
+		GPOS_RTL_ASSERT(rgszNew[ulIdx] == hmi.Value());
+		ulIdx++;
+	}
+	GPOS_RTL_ASSERT(ulCnt == ulIdx);
+
+	phm->Release();
+
+	return GPOS_OK;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COpenHashMapTest::EresUnittest_Ownership
+//
+//	@doc:
+//		Hash map test with ownership; leaks are caught by the memory pool
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+COpenHashMapTest::EresUnittest_Ownership()
+{
+	// create memory pool
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	ULONG ulCnt = 256;
+
+	typedef COpenHashMap<ULONG, ULONG, HashValue<ULONG>, gpos::Equals<ULONG>,
+						 CleanupDelete<ULONG>, CleanupDelete<ULONG> >
+		UlongToUlongMap;
+
+	UlongToUlongMap *phm = GPOS_NEW(mp) UlongToUlongMap(mp, 32);
+	for (ULONG i = 0; i < ulCnt; ++i)
+	{
+		ULONG *pulKey = GPOS_NEW(mp) ULONG(i);
+		ULONG *pulVal = GPOS_NEW(mp) ULONG(i + 1);
+
+		GPOS_RTL_ASSERT(phm->Insert(pulKey, pulVal));
+		GPOS_RTL_ASSERT(pulVal == phm->Find(pulKey));
+
+		// can't insert existing keys
+		ULONG ulKey = i;
+		GPOS_RTL_ASSERT(!phm->Insert(&ulKey, pulVal));
+	}
+
+	// replacing a value releases the old one
+	ULONG ulKey = 7;
+	GPOS_RTL_ASSERT(phm->Replace(&ulKey, GPOS_NEW(mp) ULONG(100)));
+	GPOS_RTL_ASSERT(100 == *phm->Find(&ulKey));
+
+	phm->Release();
+
+	return GPOS_OK;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COpenHashMapTest::EresUnittest_Delete
+//
+//	@doc:
+//		Deleting entries keeps the remaining ones reachable, and deleted
+//		entries show up as NULL during iteration
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+COpenHashMapTest::EresUnittest_Delete()
+{
+	// create memory pool
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	const ULONG ulCnt = 1000;
+
+	typedef COpenHashMap<ULONG, ULONG, HashValue<ULONG>, gpos::Equals<ULONG>,
+						 CleanupDelete<ULONG>, CleanupDelete<ULONG> >
+		UlongToUlongMap;
+	typedef COpenHashMapIter<ULONG, ULONG, HashValue<ULONG>,
+							 gpos::Equals<ULONG>, CleanupDelete<ULONG>,
+							 CleanupDelete<ULONG> >
+		UlongToUlongMapIter;
+
+	UlongToUlongMap *phm = GPOS_NEW(mp) UlongToUlongMap(mp, 16);
+	for (ULONG i = 0; i < ulCnt; ++i)
+	{
+		GPOS_RTL_ASSERT(
+			phm->Insert(GPOS_NEW(mp) ULONG(i), GPOS_NEW(mp) ULONG(i)));
+	}
+
+	// delete every third key
+	for (ULONG i = 0; i < ulCnt; i += 3)
+	{
+		GPOS_RTL_ASSERT(phm->Delete(&i));
+		GPOS_RTL_ASSERT(!phm->Delete(&i));
+	}
+
+	ULONG ulDeleted = 0;
+	for (ULONG i = 0; i < ulCnt; ++i)
+	{
+		const ULONG *pul = phm->Find(&i);
+		if (0 == i % 3)
+		{
+			GPOS_RTL_ASSERT(nullptr == pul);
+			ulDeleted++;
+		}
+		else
+		{
+			GPOS_RTL_ASSERT(nullptr != pul && i == *pul);
+		}
+	}
+	GPOS_RTL_ASSERT(ulCnt - ulDeleted == phm->Size());
+
+	{
+		ULONG ulIdx = 0;
+		UlongToUlongMapIter hmi(phm);
+		while (hmi.Advance())
+		{
+			if (0 == ulIdx % 3)
+			{
+				GPOS_RTL_ASSERT(nullptr == hmi.Key());
+				GPOS_RTL_ASSERT(nullptr == hmi.Value());
+			}
+			else
+			{
+				GPOS_RTL_ASSERT(ulIdx == *hmi.Key());
+			}
+			ulIdx++;
+		}
+		GPOS_RTL_ASSERT(ulCnt == ulIdx);
+	}
+
+	// re-insert deleted keys; growing the map drops the deleted entries
+	for (ULONG i = 0; i < ulCnt; i += 3)
+	{
+		GPOS_RTL_ASSERT(
+			phm->Insert(GPOS_NEW(mp) ULONG(i), GPOS_NEW(mp) ULONG(i)));
+	}
+	GPOS_RTL_ASSERT(ulCnt == phm->Size());
+
+	for (ULONG i = 0; i < ulCnt; ++i)
+	{
+		GPOS_RTL_ASSERT(i == *phm->Find(&i));
+	}
+
+	phm->Release();
+
+	return GPOS_OK;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COpenHashMapTest::EresUnittest_Benchmark
+//
+//	@doc:
+//		Compare lookup and insertion times with chained CHashMap
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+COpenHashMapTest::EresUnittest_Benchmark()
+{
+	// create memory pool
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	const ULONG ulCnt = 2000;
+	const ULONG ulIters = 200;
+
+	typedef CHashMap<ULONG, ULONG, HashValue<ULONG>, gpos::Equals<ULONG>,
+					 CleanupDelete<ULONG>, CleanupDelete<ULONG> >
+		UlongToUlongChainedMap;
+	typedef COpenHashMap<ULONG, ULONG, HashValue<ULONG>, gpos::Equals<ULONG>,
+						 CleanupDelete<ULONG>, CleanupDelete<ULONG> >
+		UlongToUlongOpenMap;
+
+	ULONG ulChainedHits = 0;
+	{
+		CAutoTimer at("Chained hash map", true /*fPrint*/);
+		for (ULONG j = 0; j < ulIters; j++)
+		{
+			UlongToUlongChainedMap *phm =
+				GPOS_NEW(mp) UlongToUlongChainedMap(mp);
+			for (ULONG i = 0; i < ulCnt; i++)
+			{
+				phm->Insert(GPOS_NEW(mp) ULONG(i), GPOS_NEW(mp) ULONG(i));
+			}
+			for (ULONG i = 0; i < 2 * ulCnt; i++)
+			{
+				if (nullptr != phm->Find(&i))
+				{
+					ulChainedHits++;
+				}
+			}
+			phm->Release();
+		}
+	}
+
+	ULONG ulOpenHits = 0;
+	{
+		CAutoTimer at("Open addressing hash map", true /*fPrint*/);
+		for (ULONG j = 0; j < ulIters; j++)
+		{
+			UlongToUlongOpenMap *phm = GPOS_NEW(mp) UlongToUlongOpenMap(mp);
+			for (ULONG i = 0; i < ulCnt; i++)
+			{
+				phm->Insert(GPOS_NEW(mp) ULONG(i), GPOS_NEW(mp) ULONG(i));
+			}
+			for (ULONG i = 0; i < 2 * ulCnt; i++)
+			{
+				if (nullptr != phm->Find(&i))
+				{
+					ulOpenHits++;
+				}
+			}
+			phm->Release();
+		}
+	}
+
+	GPOS_RTL_ASSERT(ulIters * ulCnt == ulChainedHits);
+	GPOS_RTL_ASSERT(ulChainedHits == ulOpenHits);
+
+	return GPOS_OK;
+}
+
+// EOF
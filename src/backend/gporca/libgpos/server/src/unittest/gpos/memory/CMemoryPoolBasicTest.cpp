@@ -18,6 +18,7 @@
 #include "gpos/error/CException.h"
 #include "gpos/io/COstreamString.h"
 #include "gpos/memory/CAutoMemoryPool.h"
+#include "gpos/memory/CMemoryPoolArena.h"
 #include "gpos/memory/CMemoryVisitorPrint.h"
 #include "gpos/string/CWStringDynamic.h"
 #include "gpos/task/CAutoTaskProxy.h"
@@ -45,7 +46,8 @@ CMemoryPoolBasicTest::EresUnittest()
 #ifdef GPOS_DEBUG
 		GPOS_UNITTEST_FUNC(CMemoryPoolBasicTest::EresUnittest_Print),
 #endif	// GPOS_DEBUG
-		GPOS_UNITTEST_FUNC(CMemoryPoolBasicTest::EresUnittest_TestTracker)};
+		GPOS_UNITTEST_FUNC(CMemoryPoolBasicTest::EresUnittest_TestTracker),
+		GPOS_UNITTEST_FUNC(CMemoryPoolBasicTest::EresUnittest_TestArena)};
 
 	CAutoTraceFlag atf(EtraceTestMemoryPools, true /*value*/);
 
@@ -97,6 +99,70 @@ CMemoryPoolBasicTest::EresUnittest_TestTracker()
 }
 
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CMemoryPoolBasicTest::EresUnittest_TestArena
+//
+//	@doc:
+//		Allocate from slab-based pool; freed chunks must be reused by
+//		allocations of the same size class, large allocations get their
+//		own slab, the peak size survives releases, and tear down releases
+//		everything
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+CMemoryPoolBasicTest::EresUnittest_TestArena()
+{
+	const ULONG ulAllocs = 1000;
+	CMemoryPoolArena mp;
+	void *rgpv[ulAllocs];
+
+	for (ULONG ul = 0; ul < ulAllocs; ul++)
+	{
+		rgpv[ul] = mp.NewImpl(Size(ul), __FILE__, __LINE__,
+							  CMemoryPool::EatSingleton);
+		GPOS_RTL_ASSERT(Size(ul) ==
+						CMemoryPoolArena::UserSizeOfAlloc(rgpv[ul]));
+		clib::Memset(rgpv[ul], 0, Size(ul));
+	}
+
+	const ULLONG ullSize = mp.TotalAllocatedSize();
+	GPOS_RTL_ASSERT(0 < ullSize);
+
+	// free and re-allocate small objects; freed chunks must be reused
+	for (ULONG ul = 0; ul < ulAllocs; ul += 2)
+	{
+		CMemoryPoolArena::DeleteImpl(rgpv[ul], CMemoryPool::EatSingleton);
+	}
+	for (ULONG ul = 0; ul < ulAllocs; ul += 2)
+	{
+		rgpv[ul] = mp.NewImpl(Size(ul), __FILE__, __LINE__,
+							  CMemoryPool::EatArray);
+	}
+	GPOS_RTL_ASSERT(ullSize == mp.TotalAllocatedSize());
+
+	// allocations above the size class limit get a dedicated slab
+	void *pvLarge = mp.NewImpl(GPOS_MEM_ARENA_CHUNK_LIMIT + 1, __FILE__,
+							   __LINE__, CMemoryPool::EatArray);
+	GPOS_RTL_ASSERT(GPOS_MEM_ARENA_CHUNK_LIMIT + 1 ==
+					CMemoryPoolArena::UserSizeOfAlloc(pvLarge));
+	GPOS_RTL_ASSERT(ullSize + GPOS_MEM_ARENA_CHUNK_LIMIT <
+					mp.TotalAllocatedSize());
+	const ULLONG ullPeak = mp.TotalAllocatedSize();
+	CMemoryPoolArena::DeleteImpl(pvLarge, CMemoryPool::EatArray);
+	GPOS_RTL_ASSERT(ullSize == mp.TotalAllocatedSize());
+
+	// the peak size is kept after memory is released
+	GPOS_RTL_ASSERT(ullPeak == mp.PeakAllocatedSize());
+
+	// remaining objects are released with the pool
+	mp.TearDown();
+	GPOS_RTL_ASSERT(0 == mp.TotalAllocatedSize());
+
+	return GPOS_OK;
+}
+
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CMemoryPoolBasicTest::EresTestType
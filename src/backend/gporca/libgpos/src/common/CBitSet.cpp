@@ -17,6 +17,7 @@
 #include "gpos/base.h"
 #include "gpos/common/CAutoRef.h"
 #include "gpos/common/CBitSetIter.h"
+#include "gpos/common/clibwrapper.h"
 
 #ifdef GPOS_DEBUG
 #include "gpos/error/CAutoTrace.h"
@@ -131,6 +132,11 @@ void
 CBitSet::RecomputeSize()
 {
 	m_size = 0;
+	for (ULONG ul = 0; ul < GPOS_BITSET_INLINE_WORDS; ul++)
+	{
+		m_size += __builtin_popcountll(m_inline[ul]);
+	}
+
 	CBitSetLink *bsl = nullptr;
 
 	for (bsl = m_bsllist.First(); bsl != nullptr; bsl = m_bsllist.Next(bsl))
@@ -162,10 +168,42 @@ CBitSet::Clear()
 		GPOS_DELETE(bsl_to_remove);
 	}
 
+	clib::Memset(m_inline, 0, sizeof(m_inline));
+
 	RecomputeSize();
 }
 
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CBitSet::GetNextInlineBit
+//
+//	@doc:
+//		Find next inline bit starting at given position
+//
+//---------------------------------------------------------------------------
+BOOL
+CBitSet::GetNextInlineBit(ULONG start_pos, ULONG &next_pos) const
+{
+	const ULONG words = InlineWords();
+	ULONG offset = start_pos % 64;
+	for (ULONG idx = start_pos / 64; idx < words; idx++)
+	{
+		ULLONG ull = m_inline[idx] >> offset;
+		if (0 != ull)
+		{
+			next_pos = idx * 64 + offset + __builtin_ctzll(ull);
+			return true;
+		}
+
+		// the initial offset applies only to the first word
+		offset = 0;
+	}
+
+	return false;
+}
+
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CBitSet::GetOffset
@@ -191,9 +229,13 @@ CBitSet::ComputeOffset(ULONG ul) const
 //
 //---------------------------------------------------------------------------
 CBitSet::CBitSet(CMemoryPool *mp, ULONG vector_size)
-	: m_mp(mp), m_vector_size(vector_size), m_size(0)
+	: m_mp(mp),
+	  m_vector_size(vector_size),
+	  m_size(0),
+	  m_inline_bits(vector_size <= GPOS_BITSET_INLINE_BITS ? vector_size : 0)
 {
 	m_bsllist.Init(GPOS_OFFSET(CBitSetLink, m_link));
+	clib::Memset(m_inline, 0, sizeof(m_inline));
 }
 
 
@@ -206,9 +248,13 @@ CBitSet::CBitSet(CMemoryPool *mp, ULONG vector_size)
 //
 //---------------------------------------------------------------------------
 CBitSet::CBitSet(CMemoryPool *mp, const CBitSet &bs)
-	: m_mp(mp), m_vector_size(bs.m_vector_size), m_size(0)
+	: m_mp(mp),
+	  m_vector_size(bs.m_vector_size),
+	  m_size(0),
+	  m_inline_bits(bs.m_inline_bits)
 {
 	m_bsllist.Init(GPOS_OFFSET(CBitSetLink, m_link));
+	clib::Memset(m_inline, 0, sizeof(m_inline));
 	Union(&bs);
 }
 
@@ -238,6 +284,11 @@ CBitSet::~CBitSet()
 BOOL
 CBitSet::Get(ULONG pos) const
 {
+	if (IsInline(pos))
+	{
+		return 0 != (m_inline[pos / 64] & (((ULLONG) 1) << (pos % 64)));
+	}
+
 	ULONG offset = ComputeOffset(pos);
 
 	CBitSetLink *bsl = FindLinkByOffset(offset);
@@ -261,6 +312,19 @@ CBitSet::Get(ULONG pos) const
 BOOL
 CBitSet::ExchangeSet(ULONG pos)
 {
+	if (IsInline(pos))
+	{
+		const ULLONG mask = ((ULLONG) 1) << (pos % 64);
+		BOOL bit = (0 != (m_inline[pos / 64] & mask));
+		if (!bit)
+		{
+			m_inline[pos / 64] |= mask;
+			m_size++;
+		}
+
+		return bit;
+	}
+
 	ULONG offset = ComputeOffset(pos);
 
 	CBitSetLink *bsl = FindLinkByOffset(offset);
@@ -304,6 +368,19 @@ CBitSet::ExchangeSet(ULONG pos)
 BOOL
 CBitSet::ExchangeClear(ULONG pos)
 {
+	if (IsInline(pos))
+	{
+		const ULLONG mask = ((ULLONG) 1) << (pos % 64);
+		BOOL bit = (0 != (m_inline[pos / 64] & mask));
+		if (bit)
+		{
+			m_inline[pos / 64] &= ~mask;
+			m_size--;
+		}
+
+		return bit;
+	}
+
 	ULONG offset = ComputeOffset(pos);
 
 	CBitSetLink *bsl = FindLinkByOffset(offset);
@@ -347,6 +424,19 @@ CBitSet::ExchangeClear(ULONG pos)
 void
 CBitSet::Union(const CBitSet *pbsOther)
 {
+	GPOS_ASSERT(m_inline_bits == pbsOther->m_inline_bits);
+
+	for (ULONG ul = 0; ul < GPOS_BITSET_INLINE_WORDS; ul++)
+	{
+		m_inline[ul] |= pbsOther->m_inline[ul];
+	}
+
+	if (pbsOther->m_bsllist.IsEmpty())
+	{
+		RecomputeSize();
+		return;
+	}
+
 	CBitSetLink *bsl = nullptr;
 	CBitSetLink *bsl_other = nullptr;
 
@@ -425,6 +515,13 @@ CBitSet::Intersection(const CBitSet *pbsOther)
 		return;
 	}
 
+	GPOS_ASSERT(m_inline_bits == pbsOther->m_inline_bits);
+
+	for (ULONG ul = 0; ul < GPOS_BITSET_INLINE_WORDS; ul++)
+	{
+		m_inline[ul] &= pbsOther->m_inline[ul];
+	}
+
 	CBitSetLink *bsl_other = nullptr;
 	CBitSetLink *bsl = m_bsllist.First();
 
@@ -457,22 +554,32 @@ CBitSet::Intersection(const CBitSet *pbsOther)
 //		CBitSet::Difference
 //
 //	@doc:
-//		Substract other set from this by iterating through other set and
-//		explicit removal of elements;
+//		Substract other set from this; inline bits are removed word by
+//		word, elements in other's links by explicit removal;
 //
 //---------------------------------------------------------------------------
 void
 CBitSet::Difference(const CBitSet *pbs)
 {
-	if (IsDisjoint(pbs))
+	GPOS_ASSERT(m_inline_bits == pbs->m_inline_bits);
+
+	for (ULONG ul = 0; ul < GPOS_BITSET_INLINE_WORDS; ul++)
 	{
-		return;
+		m_inline[ul] &= ~pbs->m_inline[ul];
 	}
+	RecomputeSize();
 
-	CBitSetIter bsiter(*pbs);
-	while (bsiter.Advance())
+	// explicitly remove elements held in other's links
+	CBitSetLink *bsl_other = nullptr;
+	for (bsl_other = pbs->m_bsllist.First(); bsl_other != nullptr;
+		 bsl_other = pbs->m_bsllist.Next(bsl_other))
 	{
-		(void) ExchangeClear(bsiter.Bit());
+		ULONG pos = 0;
+		while (bsl_other->GetVec()->GetNextSetBit(pos, pos))
+		{
+			(void) ExchangeClear(bsl_other->GetOffset() + pos);
+			pos++;
+		}
 	}
 }
 
@@ -494,6 +601,19 @@ CBitSet::ContainsAll(const CBitSet *bs) const
 		return false;
 	}
 
+	GPOS_ASSERT(m_inline_bits == bs->m_inline_bits);
+
+	ULLONG missing = 0;
+	for (ULONG ul = 0; ul < GPOS_BITSET_INLINE_WORDS; ul++)
+	{
+		missing |= bs->m_inline[ul] & ~m_inline[ul];
+	}
+
+	if (0 != missing)
+	{
+		return false;
+	}
+
 	CBitSetLink *bsl = nullptr;
 	CBitSetLink *bsl_other = nullptr;
 
@@ -537,6 +657,13 @@ CBitSet::Equals(const CBitSet *bs) const
 		return false;
 	}
 
+	GPOS_ASSERT(m_inline_bits == bs->m_inline_bits);
+
+	if (0 != clib::Memcmp(m_inline, bs->m_inline, sizeof(m_inline)))
+	{
+		return false;
+	}
+
 	CBitSetLink *bsl = m_bsllist.First();
 	CBitSetLink *bsl_other = bs->m_bsllist.First();
 
@@ -570,6 +697,19 @@ CBitSet::Equals(const CBitSet *bs) const
 BOOL
 CBitSet::IsDisjoint(const CBitSet *bs) const
 {
+	GPOS_ASSERT(m_inline_bits == bs->m_inline_bits);
+
+	ULLONG common = 0;
+	for (ULONG ul = 0; ul < GPOS_BITSET_INLINE_WORDS; ul++)
+	{
+		common |= m_inline[ul] & bs->m_inline[ul];
+	}
+
+	if (0 != common)
+	{
+		return false;
+	}
+
 	CBitSetLink *bsl = nullptr;
 	CBitSetLink *bsl_other = nullptr;
 
@@ -603,6 +743,20 @@ CBitSet::HashValue() const
 {
 	ULONG ulHash = 0;
 
+	// hash inline bits the same way as a link holding them
+	ULLONG any = 0;
+	for (ULONG ul = 0; ul < GPOS_BITSET_INLINE_WORDS; ul++)
+	{
+		any |= m_inline[ul];
+	}
+
+	if (0 != any)
+	{
+		ulHash = gpos::CombineHashes(
+			ulHash, gpos::HashByteArray((BYTE *) m_inline,
+										GPOS_SIZEOF(ULLONG) * InlineWords()));
+	}
+
 	CBitSetLink *bsl = m_bsllist.First();
 	while (nullptr != bsl)
 	{
@@ -26,7 +26,11 @@ using namespace gpos;
 //
 //---------------------------------------------------------------------------
 CBitSetIter::CBitSetIter(const CBitSet &bs)
-	: m_bs(bs), m_cursor((ULONG) -1), m_bsl(nullptr), m_active(true)
+	: m_bs(bs),
+	  m_cursor((ULONG) -1),
+	  m_bsl(nullptr),
+	  m_in_inline(true),
+	  m_active(true)
 {
 }
 
@@ -44,8 +48,16 @@ CBitSetIter::Advance()
 {
 	GPOS_ASSERT(m_active && "called advance on exhausted iterator");
 
-	if (nullptr == m_bsl)
+	if (m_in_inline)
 	{
+		// inline bits come first since links only hold larger ids
+		if (m_bs.GetNextInlineBit(m_cursor + 1, m_cursor))
+		{
+			return true;
+		}
+
+		m_in_inline = false;
+		m_cursor = (ULONG) -1;
 		m_bsl = m_bs.m_bsllist.First();
 	}
 
@@ -77,7 +89,15 @@ CBitSetIter::Advance()
 ULONG
 CBitSetIter::Bit() const
 {
-	GPOS_ASSERT(m_active && nullptr != m_bsl && "iterator uninitialized");
+	GPOS_ASSERT(m_active && "iterator uninitialized");
+
+	if (m_in_inline)
+	{
+		GPOS_ASSERT(m_bs.Get(m_cursor));
+		return m_cursor;
+	}
+
+	GPOS_ASSERT(nullptr != m_bsl && "iterator uninitialized");
 	GPOS_ASSERT(m_bsl->GetVec()->Get(m_cursor));
 
 	return m_bsl->GetOffset() + m_cursor;
@@ -0,0 +1,343 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2022 VMware, Inc. or its affiliates.
+//
+//	@filename:
+//		CMemoryPoolArena.cpp
+//
+//	@doc:
+//		Implementation of slab-based memory pool
+//
+//---------------------------------------------------------------------------
+
+#include "gpos/memory/CMemoryPoolArena.h"
+
+#include "gpos/assert.h"
+#include "gpos/common/clibwrapper.h"
+#include "gpos/types.h"
+#include "gpos/utils.h"
+
+using namespace gpos;
+
+#define GPOS_MEM_ARENA_HEADER_SIZE \
+	GPOS_MEM_ALIGNED_STRUCT_SIZE(SArenaAllocHeader)
+
+#define GPOS_MEM_ARENA_SLAB_HEADER_SIZE GPOS_MEM_ALIGNED_STRUCT_SIZE(SArenaSlab)
+
+// ctor
+CMemoryPoolArena::CMemoryPoolArena() : CMemoryPool()
+{
+	for (ULONG ul = 0; ul < GPOS_MEM_ARENA_NUM_CLASSES; ul++)
+	{
+		m_free_lists[ul] = nullptr;
+	}
+}
+
+// dtor
+CMemoryPoolArena::~CMemoryPoolArena()
+{
+	GPOS_ASSERT(nullptr == m_slabs);
+	GPOS_ASSERT(nullptr == m_large_slabs);
+}
+
+// map requested size to the smallest size class that can hold it
+ULONG
+CMemoryPoolArena::SizeClass(ULONG bytes)
+{
+	GPOS_ASSERT(bytes <= GPOS_MEM_ARENA_CHUNK_LIMIT);
+
+	ULONG size_class = 0;
+	while ((ULONG)(GPOS_MEM_ARCH << size_class) < bytes)
+	{
+		size_class++;
+	}
+
+	return size_class;
+}
+
+// size of a chunk of given size class, including header
+ULONG
+CMemoryPoolArena::ChunkSize(ULONG size_class)
+{
+	GPOS_ASSERT(size_class < GPOS_MEM_ARENA_NUM_CLASSES);
+
+	return GPOS_MEM_ARENA_HEADER_SIZE + (GPOS_MEM_ARCH << size_class);
+}
+
+// add slab to the head of given list
+void
+CMemoryPoolArena::LinkSlab(SArenaSlab **list, SArenaSlab *slab)
+{
+	slab->m_prev = nullptr;
+	slab->m_next = *list;
+	if (nullptr != *list)
+	{
+		(*list)->m_prev = slab;
+	}
+	*list = slab;
+}
+
+// remove slab from given list
+void
+CMemoryPoolArena::UnlinkSlab(SArenaSlab **list, SArenaSlab *slab)
+{
+	if (nullptr != slab->m_prev)
+	{
+		slab->m_prev->m_next = slab->m_next;
+	}
+	else
+	{
+		GPOS_ASSERT(*list == slab);
+		*list = slab->m_next;
+	}
+
+	if (nullptr != slab->m_next)
+	{
+		slab->m_next->m_prev = slab->m_prev;
+	}
+}
+
+// obtain memory for a slab; by default slabs come from malloc
+void *
+CMemoryPoolArena::AllocSlab(ULONG bytes)
+{
+	void *ptr = clib::Malloc(bytes);
+	GPOS_OOM_CHECK(ptr);
+
+	return ptr;
+}
+
+// return slab memory to malloc
+void
+CMemoryPoolArena::FreeSlab(void *slab)
+{
+	clib::Free(slab);
+}
+
+// obtain a new slab that can hold at least min_bytes and make it current
+void
+CMemoryPoolArena::NewSlab(ULONG min_bytes)
+{
+	// hand out the tail of the current slab to the free lists,
+	// largest class first, so it is not wasted
+	for (ULONG size_class = GPOS_MEM_ARENA_NUM_CLASSES; 0 < size_class;
+		 size_class--)
+	{
+		const ULONG chunk_size = ChunkSize(size_class - 1);
+		while (m_cur + chunk_size <= m_end)
+		{
+			SArenaAllocHeader *header =
+				reinterpret_cast<SArenaAllocHeader *>(m_cur);
+			header->m_mp = this;
+			header->m_size_class = size_class - 1;
+			header->m_user_size = 0;
+			m_cur += chunk_size;
+
+			FreeChunk(header);
+		}
+	}
+
+	ULONG slab_size = m_next_slab_size;
+	while (slab_size < GPOS_MEM_ARENA_SLAB_HEADER_SIZE + min_bytes)
+	{
+		slab_size *= 2;
+	}
+
+	if (m_next_slab_size < GPOS_MEM_ARENA_MAX_SLAB_SIZE)
+	{
+		m_next_slab_size *= 2;
+	}
+
+	SArenaSlab *slab = static_cast<SArenaSlab *>(AllocSlab(slab_size));
+	slab->m_size = slab_size;
+	LinkSlab(&m_slabs, slab);
+	m_total_allocated_size += slab_size;
+	if (m_total_allocated_size > m_peak_allocated_size)
+	{
+		m_peak_allocated_size = m_total_allocated_size;
+	}
+
+	m_cur = reinterpret_cast<BYTE *>(slab) + GPOS_MEM_ARENA_SLAB_HEADER_SIZE;
+	m_end = reinterpret_cast<BYTE *>(slab) + slab_size;
+}
+
+// allocate a chunk of the given size class, reusing freed chunks first
+CMemoryPoolArena::SArenaAllocHeader *
+CMemoryPoolArena::AllocChunk(ULONG size_class)
+{
+	SFreeChunk *free_chunk = m_free_lists[size_class];
+	if (nullptr != free_chunk)
+	{
+		m_free_lists[size_class] = free_chunk->m_next;
+
+		return reinterpret_cast<SArenaAllocHeader *>(
+			reinterpret_cast<BYTE *>(free_chunk) - GPOS_MEM_ARENA_HEADER_SIZE);
+	}
+
+	const ULONG chunk_size = ChunkSize(size_class);
+	if (m_cur + chunk_size > m_end)
+	{
+		NewSlab(chunk_size);
+	}
+
+	SArenaAllocHeader *header = reinterpret_cast<SArenaAllocHeader *>(m_cur);
+	m_cur += chunk_size;
+
+	header->m_mp = this;
+	header->m_size_class = size_class;
+
+	return header;
+}
+
+// allocate a dedicated slab for a request too large for any size class
+CMemoryPoolArena::SArenaAllocHeader *
+CMemoryPoolArena::AllocLarge(ULONG bytes)
+{
+	const ULONG slab_size = GPOS_MEM_ARENA_SLAB_HEADER_SIZE +
+							GPOS_MEM_ARENA_HEADER_SIZE +
+							GPOS_MEM_ALIGNED_SIZE(bytes);
+
+	SArenaSlab *slab = static_cast<SArenaSlab *>(AllocSlab(slab_size));
+	slab->m_size = slab_size;
+	LinkSlab(&m_large_slabs, slab);
+	m_total_allocated_size += slab_size;
+	if (m_total_allocated_size > m_peak_allocated_size)
+	{
+		m_peak_allocated_size = m_total_allocated_size;
+	}
+
+	SArenaAllocHeader *header = reinterpret_cast<SArenaAllocHeader *>(
+		reinterpret_cast<BYTE *>(slab) + GPOS_MEM_ARENA_SLAB_HEADER_SIZE);
+	header->m_mp = this;
+	header->m_size_class = GPOS_MEM_ARENA_NUM_CLASSES;
+
+	return header;
+}
+
+// return a chunk to the pool
+void
+CMemoryPoolArena::FreeChunk(SArenaAllocHeader *header)
+{
+	GPOS_ASSERT(this == header->m_mp);
+
+	if (GPOS_MEM_ARENA_NUM_CLASSES == header->m_size_class)
+	{
+		// dedicated slab, give it back right away
+		SArenaSlab *slab = reinterpret_cast<SArenaSlab *>(
+			reinterpret_cast<BYTE *>(header) - GPOS_MEM_ARENA_SLAB_HEADER_SIZE);
+		UnlinkSlab(&m_large_slabs, slab);
+		m_total_allocated_size -= slab->m_size;
+		FreeSlab(slab);
+
+		return;
+	}
+
+	SFreeChunk *free_chunk = reinterpret_cast<SFreeChunk *>(
+		reinterpret_cast<BYTE *>(header) + GPOS_MEM_ARENA_HEADER_SIZE);
+	free_chunk->m_next = m_free_lists[header->m_size_class];
+	m_free_lists[header->m_size_class] = free_chunk;
+}
+
+// release all slabs in the given list
+void
+CMemoryPoolArena::FreeSlabList(SArenaSlab *list)
+{
+	while (nullptr != list)
+	{
+		SArenaSlab *next = list->m_next;
+		FreeSlab(list);
+		list = next;
+	}
+}
+
+// release all slabs
+void
+CMemoryPoolArena::ReleaseSlabs()
+{
+	FreeSlabList(m_slabs);
+	FreeSlabList(m_large_slabs);
+	ResetSlabs();
+}
+
+// forget all slabs; used when the underlying allocator frees them in bulk
+void
+CMemoryPoolArena::ResetSlabs()
+{
+	m_slabs = nullptr;
+	m_large_slabs = nullptr;
+	m_cur = nullptr;
+	m_end = nullptr;
+	m_next_slab_size = GPOS_MEM_ARENA_INIT_SLAB_SIZE;
+	m_total_allocated_size = 0;
+
+	for (ULONG ul = 0; ul < GPOS_MEM_ARENA_NUM_CLASSES; ul++)
+	{
+		m_free_lists[ul] = nullptr;
+	}
+}
+
+void *
+CMemoryPoolArena::NewImpl(const ULONG bytes, const CHAR *, const ULONG,
+						  CMemoryPool::EAllocationType)
+{
+	GPOS_ASSERT(bytes <= GPOS_MEM_ALLOC_MAX);
+
+	SArenaAllocHeader *header = nullptr;
+	if (bytes <= GPOS_MEM_ARENA_CHUNK_LIMIT)
+	{
+		header = AllocChunk(SizeClass(bytes));
+	}
+	else
+	{
+		header = AllocLarge(bytes);
+	}
+
+	header->m_user_size = bytes;
+
+	void *ptr_result =
+		reinterpret_cast<BYTE *>(header) + GPOS_MEM_ARENA_HEADER_SIZE;
+
+#ifdef GPOS_DEBUG
+	clib::Memset(ptr_result, GPOS_MEM_INIT_PATTERN_CHAR, bytes);
+#endif	// GPOS_DEBUG
+
+	return ptr_result;
+}
+
+// free memory allocation
+void
+CMemoryPoolArena::DeleteImpl(void *ptr, CMemoryPool::EAllocationType)
+{
+	SArenaAllocHeader *header = reinterpret_cast<SArenaAllocHeader *>(
+		static_cast<BYTE *>(ptr) - GPOS_MEM_ARENA_HEADER_SIZE);
+
+	GPOS_ASSERT(nullptr != header->m_mp);
+
+#ifdef GPOS_DEBUG
+	// mark user memory as unused in debug mode
+	clib::Memset(ptr, GPOS_MEM_FREED_PATTERN_CHAR, header->m_user_size);
+#endif	// GPOS_DEBUG
+
+	header->m_mp->FreeChunk(header);
+}
+
+// get user requested size of allocation
+ULONG
+CMemoryPoolArena::UserSizeOfAlloc(const void *ptr)
+{
+	const SArenaAllocHeader *header =
+		reinterpret_cast<const SArenaAllocHeader *>(
+			static_cast<const BYTE *>(ptr) - GPOS_MEM_ARENA_HEADER_SIZE);
+
+	return header->m_user_size;
+}
+
+// Prepare the memory pool to be deleted; all objects still allocated in
+// the pool are released together with their slabs
+void
+CMemoryPoolArena::TearDown()
+{
+	ReleaseSlabs();
+}
+
+// EOF
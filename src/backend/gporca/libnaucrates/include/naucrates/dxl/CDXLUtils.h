@@ -69,6 +69,15 @@ private:
 		CMemoryPool *, const CWStringBase *dxl_string,
 		const CHAR *xsd_file_path);
 
+	// same as above but for a binary DXL document of the given length
+	static CParseHandlerDXL *GetParseHandlerForBinaryDXL(CMemoryPool *,
+														 const BYTE *buffer,
+														 ULONG length);
+
+	// read the given file if it holds a binary DXL document; return NULL
+	// if it holds a text document
+	static BYTE *ReadBinaryDXLFile(CMemoryPool *mp, const CHAR *filename,
+								   ULONG *length);
 
 
 public:
@@ -130,6 +139,10 @@ public:
 		CMemoryPool *, const CWStringBase *dxl_string,
 		const CHAR *xsd_file_path);
 
+	static IMDCacheObject *ParseDXLToIMDIdCacheObj(CMemoryPool *,
+												   const CHAR *dxl_string,
+												   const CHAR *xsd_file_path);
+
 	// parse statistics object from the statistics document
 	static CDXLStatsDerivedRelationArray *ParseDXLToStatsDerivedRelArray(
 		CMemoryPool *, const CHAR *dxl_string, const CHAR *xsd_file_path);
@@ -216,6 +229,15 @@ public:
 		CMemoryPool *, const IMDCacheObject *,
 		BOOL serialize_document_header_footer, BOOL indentation);
 
+	// serialize a metadata object into a binary DXL document
+	static BYTE *SerializeMDObjToBinary(CMemoryPool *mp,
+										const IMDCacheObject *imd_cache_obj,
+										ULONG *length);
+
+	// convert a DXL document to the binary DXL encoding
+	static BYTE *ConvertDXLToBinary(CMemoryPool *mp, const CHAR *dxl_string,
+									ULONG *length);
+
 	// serialize a scalar expression into DXL
 	static CWStringDynamic *SerializeScalarExpr(
 		CMemoryPool *mp, const CDXLNode *node,
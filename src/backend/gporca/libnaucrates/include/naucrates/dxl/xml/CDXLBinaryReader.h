@@ -0,0 +1,250 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2022 VMware, Inc. or its affiliates.
+//
+//	@filename:
+//		CDXLBinaryReader.h
+//
+//	@doc:
+//		Class for reading binary DXL documents.
+//---------------------------------------------------------------------------
+
+#ifndef GPDXL_CDXLBinaryReader_H
+#define GPDXL_CDXLBinaryReader_H
+
+#include <xercesc/sax2/Attributes.hpp>
+#include <xercesc/sax2/ContentHandler.hpp>
+#include <xercesc/sax2/SAX2XMLReader.hpp>
+#include <xercesc/util/XercesDefs.hpp>
+
+#include "gpos/base.h"
+
+#include "naucrates/dxl/xml/CDXLBinaryWriter.h"
+
+namespace gpdxl
+{
+using namespace gpos;
+
+XERCES_CPP_NAMESPACE_USE
+
+//---------------------------------------------------------------------------
+//	@class:
+//		CDXLBinaryReader
+//
+//	@doc:
+//		Reads a document written by CDXLBinaryWriter and replays it as the
+//		SAX events an XML parser would have produced for its text form.
+//		The events are delivered to the content handler currently installed
+//		in the given Xerces reader, so that the existing DXL parse handlers,
+//		which install each other in the reader as they go, are used
+//		unchanged.
+//
+//---------------------------------------------------------------------------
+class CDXLBinaryReader
+{
+private:
+	//---------------------------------------------------------------------------
+	//	@class:
+	//		CAttributes
+	//
+	//	@doc:
+	//		Attributes of the element being started, as seen by the content
+	//		handler. Attributes of DXL elements are unqualified and untyped.
+	//
+	//---------------------------------------------------------------------------
+	class CAttributes : public Attributes
+	{
+	private:
+		// number of attributes
+		XMLSize_t m_length;
+
+		// qualified and local names and values of attributes
+		const XMLCh **m_qnames;
+		const XMLCh **m_local_names;
+		const XMLCh **m_values;
+
+		// find attribute with given qualified name
+		BOOL FindIndex(const XMLCh *qname, XMLSize_t &index) const;
+
+		// find attribute with given local name and namespace uri
+		BOOL FindIndex(const XMLCh *uri, const XMLCh *local_name,
+					   XMLSize_t &index) const;
+
+	public:
+		CAttributes(const CAttributes &) = delete;
+
+		// ctor
+		CAttributes()
+			: m_length(0),
+			  m_qnames(nullptr),
+			  m_local_names(nullptr),
+			  m_values(nullptr)
+		{
+		}
+
+		// dtor
+		~CAttributes() override = default;
+
+		// set attributes of the element being started
+		void
+		Set(XMLSize_t length, const XMLCh **qnames, const XMLCh **local_names,
+			const XMLCh **values)
+		{
+			m_length = length;
+			m_qnames = qnames;
+			m_local_names = local_names;
+			m_values = values;
+		}
+
+		XMLSize_t getLength() const override;
+		const XMLCh *getURI(const XMLSize_t index) const override;
+		const XMLCh *getLocalName(const XMLSize_t index) const override;
+		const XMLCh *getQName(const XMLSize_t index) const override;
+		const XMLCh *getType(const XMLSize_t index) const override;
+		const XMLCh *getValue(const XMLSize_t index) const override;
+		bool getIndex(const XMLCh *const uri, const XMLCh *const localPart,
+					  XMLSize_t &index) const override;
+		int getIndex(const XMLCh *const uri,
+					 const XMLCh *const localPart) const override;
+		bool getIndex(const XMLCh *const qName,
+					  XMLSize_t &index) const override;
+		int getIndex(const XMLCh *const qName) const override;
+		const XMLCh *getType(const XMLCh *const uri,
+							 const XMLCh *const localPart) const override;
+		const XMLCh *getType(const XMLCh *const qName) const override;
+		const XMLCh *getValue(const XMLCh *const uri,
+							  const XMLCh *const localPart) const override;
+		const XMLCh *getValue(const XMLCh *const qName) const override;
+	};
+
+	// interned name
+	struct SName
+	{
+		// qualified name
+		XMLCh *m_qname;
+
+		// length of the qualified name
+		ULONG m_length;
+
+		// offset of the local name in the qualified name
+		ULONG m_local_offset;
+	};
+
+	// namespace binding; number of the prefix and uri names and the
+	// nesting level of the element declaring it
+	struct SNamespace
+	{
+		ULONG m_prefix_id;
+		ULONG m_uri_id;
+		ULONG m_level;
+	};
+
+	// open element
+	struct SElement
+	{
+		// number of the element name
+		ULONG m_name_id;
+
+		// namespace uri of the element
+		const XMLCh *m_uri;
+	};
+
+	// memory pool
+	CMemoryPool *m_mp;
+
+	// current position in and end of the document body
+	const BYTE *m_pos;
+	const BYTE *m_end;
+
+	// interned names, numbered from one
+	SName *m_names;
+	ULONG m_num_names;
+	ULONG m_names_capacity;
+
+	// namespace bindings in scope, innermost last
+	SNamespace *m_namespaces;
+	ULONG m_num_namespaces;
+	ULONG m_namespaces_capacity;
+
+	// open elements, innermost last
+	SElement *m_elements;
+	ULONG m_num_elements;
+	ULONG m_elements_capacity;
+
+	// number of the name of the element whose start has been read but not
+	// reported yet, as its attributes and namespaces may follow; zero if
+	// there is none
+	ULONG m_pending_name_id;
+
+	// attributes of the pending element: numbers of their names and
+	// offsets of their values in the value buffer
+	ULONG *m_attr_name_ids;
+	ULONG *m_attr_value_offsets;
+	ULONG m_num_attrs;
+	ULONG m_attrs_capacity;
+
+	// attribute names and values passed to the content handler
+	const XMLCh **m_attr_qnames;
+	const XMLCh **m_attr_local_names;
+	const XMLCh **m_attr_values;
+
+	// NUL-terminated attribute values of the pending element
+	XMLCh *m_values;
+	ULONG m_values_size;
+	ULONG m_values_capacity;
+
+	// attributes of the pending element, as seen by the content handler
+	CAttributes m_attributes;
+
+	// raise an exception for a malformed document
+	static void RaiseError(const CHAR *message);
+
+	// read a byte
+	BYTE ReadByte();
+
+	// read a variable-length encoded integer
+	ULONG ReadVarint();
+
+	// read a string into the given buffer, which must have room for the
+	// number of code units read plus a terminating NUL
+	void ReadString(XMLCh *dest, ULONG length);
+
+	// read a name reference, interning new names; return its number
+	ULONG ReadName();
+
+	// namespace uri bound to the prefix of the given qualified name
+	const XMLCh *ResolveURI(const SName &name) const;
+
+	// report the start of the pending element to the content handler
+	void StartPendingElement(ContentHandler *handler);
+
+	// grow an array of the given element type
+	template <class T>
+	T *Grow(T *array, ULONG size, ULONG capacity);
+
+public:
+	CDXLBinaryReader(const CDXLBinaryReader &) = delete;
+
+	// ctor; the buffer must contain a complete document of the given length
+	CDXLBinaryReader(CMemoryPool *mp, const BYTE *buffer, ULONG length);
+
+	// dtor
+	~CDXLBinaryReader();
+
+	// replay the document to the content handlers installed in the reader
+	void Parse(SAX2XMLReader *sax_2_xml_reader);
+
+	// does the buffer start with the magic bytes of a binary DXL document;
+	// the buffer must be NUL-terminated or at least as long as the magic
+	static BOOL IsBinaryDXL(const BYTE *buffer);
+
+	// length, including the header, of the binary DXL document in the
+	// buffer; the buffer must contain at least the header
+	static ULONG DocumentLength(const BYTE *buffer);
+};
+
+}  // namespace gpdxl
+
+#endif	//!GPDXL_CDXLBinaryReader_H
+
+// EOF
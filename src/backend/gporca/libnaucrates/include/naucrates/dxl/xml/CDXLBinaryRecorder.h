@@ -0,0 +1,84 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2022 VMware, Inc. or its affiliates.
+//
+//	@filename:
+//		CDXLBinaryRecorder.h
+//
+//	@doc:
+//		SAX handler converting DXL documents to the binary encoding.
+//---------------------------------------------------------------------------
+
+#ifndef GPDXL_CDXLBinaryRecorder_H
+#define GPDXL_CDXLBinaryRecorder_H
+
+#include <xercesc/sax2/DefaultHandler.hpp>
+#include <xercesc/util/XercesDefs.hpp>
+
+#include "gpos/base.h"
+
+#include "naucrates/dxl/xml/CDXLBinaryWriter.h"
+
+namespace gpdxl
+{
+using namespace gpos;
+
+XERCES_CPP_NAMESPACE_USE
+
+//---------------------------------------------------------------------------
+//	@class:
+//		CDXLBinaryRecorder
+//
+//	@doc:
+//		Content handler that writes the events of a parsed DXL document to
+//		a binary DXL writer, declaring namespaces as elements use them.
+//
+//---------------------------------------------------------------------------
+class CDXLBinaryRecorder : public DefaultHandler
+{
+private:
+	// memory pool
+	CMemoryPool *m_mp;
+
+	// writer of the binary document
+	CDXLBinaryWriter *m_writer;
+
+	// scratch buffers for converting names and values to wide characters
+	WCHAR *m_name;
+	ULONG m_name_capacity;
+	WCHAR *m_value;
+	ULONG m_value_capacity;
+
+	// convert a UTF-16 string into the given scratch buffer; return the
+	// number of characters converted
+	ULONG Convert(const XMLCh *xmlstr, WCHAR **buffer, ULONG *capacity);
+
+public:
+	CDXLBinaryRecorder(const CDXLBinaryRecorder &) = delete;
+
+	// ctor
+	CDXLBinaryRecorder(CMemoryPool *mp, CDXLBinaryWriter *writer);
+
+	// dtor
+	~CDXLBinaryRecorder() override;
+
+	// process the start of an element
+	void startElement(const XMLCh *const element_uri,
+					  const XMLCh *const element_local_name,
+					  const XMLCh *const element_qname,
+					  const Attributes &attr) override;
+
+	// process the end of an element
+	void endElement(const XMLCh *const element_uri,
+					const XMLCh *const element_local_name,
+					const XMLCh *const element_qname) override;
+
+	// process the end of the document
+	void endDocument() override;
+};
+
+}  // namespace gpdxl
+
+#endif	//!GPDXL_CDXLBinaryRecorder_H
+
+// EOF
@@ -0,0 +1,201 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2022 VMware, Inc. or its affiliates.
+//
+//	@filename:
+//		CDXLBinaryWriter.h
+//
+//	@doc:
+//		Class for creating binary DXL documents.
+//---------------------------------------------------------------------------
+
+#ifndef GPDXL_CDXLBinaryWriter_H
+#define GPDXL_CDXLBinaryWriter_H
+
+#include "gpos/base.h"
+#include "gpos/common/COpenHashMap.h"
+#include "gpos/string/CWStringConst.h"
+
+// magic bytes at the beginning of a binary DXL document
+#define GPDXL_BINARY_MAGIC "\x89" "DXB"
+#define GPDXL_BINARY_MAGIC_LENGTH 4
+
+// version of the binary encoding written by CDXLBinaryWriter
+#define GPDXL_BINARY_VERSION 1
+
+// length of the document header: magic, version, reserved, body length
+#define GPDXL_BINARY_HEADER_LENGTH 12
+
+namespace gpdxl
+{
+using namespace gpos;
+
+// records of a binary DXL document
+enum EDXLBinaryOp
+{
+	EdxlbinopEndDocument = 0,	// end of the document
+	EdxlbinopStartElement,		// qualified name
+	EdxlbinopAttribute,			// qualified name, value
+	EdxlbinopNamespace,			// prefix, uri; scoped to the current element
+	EdxlbinopEndElement,		// end of the current element
+
+	EdxlbinopSentinel
+};
+
+//---------------------------------------------------------------------------
+//	@class:
+//		CDXLBinaryWriter
+//
+//	@doc:
+//		Encodes the structure of a DXL document, i.e. its elements, their
+//		attributes and namespace declarations, in a compact binary form
+//		that can be read back without an XML parser.
+//
+//		A document starts with a fixed-size header holding magic bytes, the
+//		version of the encoding and the length of the body. The body is a
+//		sequence of records, each starting with an EDXLBinaryOp byte.
+//		Integers are variable-length encoded, 7 bits per byte, least
+//		significant group first. Strings are encoded as the number of their
+//		UTF-16 code units followed by the little-endian code units.
+//		Element, attribute and namespace names are interned: a name is
+//		written out the first time it is used and referred to by its
+//		number afterwards, with 0 introducing a new name.
+//
+//		Character data is not encoded, as no DXL element carries any.
+//
+//---------------------------------------------------------------------------
+class CDXLBinaryWriter
+{
+private:
+	// hash function for interned names
+	static ULONG HashName(const CWStringConst *name);
+
+	// equality function for interned names
+	static BOOL EqualNames(const CWStringConst *left,
+						   const CWStringConst *right);
+
+	// map of interned names to their numbers
+	typedef COpenHashMap<CWStringConst, ULONG, HashName, EqualNames,
+						 CleanupDelete<CWStringConst>, CleanupDelete<ULONG> >
+		NameToIdMap;
+
+	// namespace binding; numbers of the prefix and uri names and the
+	// nesting level of the element declaring it
+	struct SNamespace
+	{
+		ULONG m_prefix_id;
+		ULONG m_uri_id;
+		ULONG m_level;
+	};
+
+	// memory pool
+	CMemoryPool *m_mp;
+
+	// encoded document, including space for the header
+	BYTE *m_buffer;
+
+	// number of used and allocated bytes of the buffer
+	ULONG m_size;
+	ULONG m_capacity;
+
+	// interned names
+	NameToIdMap *m_names;
+
+	// namespace bindings in scope, innermost last
+	SNamespace *m_namespaces;
+
+	// number of used and allocated namespace bindings
+	ULONG m_num_namespaces;
+	ULONG m_namespaces_capacity;
+
+	// level of nesting, i.e. number of open elements
+	ULONG m_level;
+
+	// has the end of the document been written
+	BOOL m_finished;
+
+	// scratch buffer for building qualified names
+	WCHAR *m_qname;
+
+	// number of allocated characters of the scratch buffer
+	ULONG m_qname_capacity;
+
+	// make room for given number of bytes
+	void Reserve(ULONG length);
+
+	// append a byte
+	void
+	AppendByte(BYTE value)
+	{
+		Reserve(1);
+		m_buffer[m_size++] = value;
+	}
+
+	// append a variable-length encoded integer
+	void AppendVarint(ULONG value);
+
+	// append a string
+	void AppendString(const WCHAR *str, ULONG length);
+
+	// append a reference to given name, interning it on first use
+	ULONG AppendName(const WCHAR *name);
+
+	// number of given name if it has been interned, zero otherwise
+	ULONG LookupName(const WCHAR *name) const;
+
+	// add a binding of the namespace prefix to the uri
+	void AddNamespace(ULONG prefix_id, ULONG uri_id);
+
+public:
+	CDXLBinaryWriter(const CDXLBinaryWriter &) = delete;
+
+	// ctor
+	explicit CDXLBinaryWriter(CMemoryPool *mp);
+
+	// dtor
+	~CDXLBinaryWriter();
+
+	// start an element with the given, optionally prefixed, name
+	void StartElement(const CWStringBase *prefix, const CWStringBase *name);
+
+	// start an element with the given qualified name
+	void StartElement(const WCHAR *qname);
+
+	// add an attribute to the current element; "xmlns" attributes
+	// declare namespaces
+	void AddAttribute(const WCHAR *qname, const WCHAR *value, ULONG length);
+
+	// bind the namespace prefix to the uri for the current element
+	void DeclareNamespace(const WCHAR *prefix, const WCHAR *uri);
+
+	// is the namespace prefix bound to the uri in the current scope
+	BOOL IsNamespaceDeclared(const WCHAR *prefix, const WCHAR *uri) const;
+
+	// end the current element
+	void EndElement();
+
+	// end the document and fill in its header
+	void EndDocument();
+
+	// encoded document
+	const BYTE *
+	GetBuffer() const
+	{
+		GPOS_ASSERT(m_finished);
+		return m_buffer;
+	}
+
+	// length of the encoded document
+	ULONG
+	Length() const
+	{
+		GPOS_ASSERT(m_finished);
+		return m_size;
+	}
+};
+
+}  // namespace gpdxl
+
+#endif	//!GPDXL_CDXLBinaryWriter_H
+
+// EOF
@@ -16,8 +16,11 @@
 #include "gpos/common/CDouble.h"
 #include "gpos/common/CStack.h"
 #include "gpos/io/COstream.h"
+#include "gpos/io/COstreamString.h"
 #include "gpos/string/CWStringConst.h"
+#include "gpos/string/CWStringDynamic.h"
 
+#include "naucrates/dxl/xml/CDXLBinaryWriter.h"
 #include "naucrates/dxl/xml/dxltokens.h"
 
 namespace gpdxl
@@ -29,7 +32,9 @@ using namespace gpos;
 //		CXMLSerializer
 //
 //	@doc:
-//		Class for creating XML documents.
+//		Class for creating XML documents. The documents are written out
+//		either as text or, when a binary writer is given, in the binary
+//		DXL encoding.
 //
 //---------------------------------------------------------------------------
 class CXMLSerializer
@@ -41,7 +46,17 @@ private:
 	// memory pool
 	CMemoryPool *m_mp;
 
-	// output stream for writing out the xml document
+	// writer of binary documents; NULL when writing text
+	CDXLBinaryWriter *m_binary_writer;
+
+	// formatted attribute values of binary documents
+	CWStringDynamic *m_binary_values;
+
+	// stream formatting attribute values of binary documents
+	COstreamString *m_binary_values_os;
+
+	// output stream for writing out the xml document; formats attribute
+	// values when writing binary documents
 	IOstream &m_os;
 
 	// should XML document be indented
@@ -65,12 +80,19 @@ private:
 	// escape the given string and write it to the given stream
 	static void WriteEscaped(IOstream &os, const CWStringBase *str);
 
+	// format the value and add it as an attribute of a binary document
+	template <class T>
+	void AddBinaryAttribute(const CWStringBase *pstrAttr, T value);
+
 public:
 	CXMLSerializer(const CXMLSerializer &) = delete;
 
 	// ctor/dtor
 	CXMLSerializer(CMemoryPool *mp, IOstream &os, BOOL indentation = true)
 		: m_mp(mp),
+		  m_binary_writer(nullptr),
+		  m_binary_values(nullptr),
+		  m_binary_values_os(nullptr),
 		  m_os(os),
 		  m_indentation(indentation),
 		  m_strstackElems(nullptr),
@@ -81,6 +103,23 @@ public:
 		m_strstackElems = GPOS_NEW(m_mp) StrStack(m_mp);
 	}
 
+	// ctor for writing binary documents
+	CXMLSerializer(CMemoryPool *mp, CDXLBinaryWriter *binary_writer)
+		: m_mp(mp),
+		  m_binary_writer(binary_writer),
+		  m_binary_values(GPOS_NEW(mp) CWStringDynamic(mp)),
+		  m_binary_values_os(GPOS_NEW(mp) COstreamString(m_binary_values)),
+		  m_os(*m_binary_values_os),
+		  m_indentation(false),
+		  m_strstackElems(nullptr),
+		  m_fOpenTag(false),
+		  m_ulLevel(0),
+		  m_iteration_since_last_abortcheck(0)
+	{
+		GPOS_ASSERT(nullptr != binary_writer);
+		m_strstackElems = GPOS_NEW(m_mp) StrStack(m_mp);
+	}
+
 	~CXMLSerializer();
 
 	// get underlying memory pool
@@ -40,6 +40,7 @@ enum ExMinor
 	ExmiDXLUnrecognizedCompOperator,
 	ExmiDXLValidationError,
 	ExmiDXLXercesParseError,
+	ExmiDXLBinaryParseError,
 	ExmiDXLIncorrectNumberOfChildren,
 	ExmiPlStmt2DXLConversion,
 	ExmiDXL2PlStmtConversion,
@@ -40,6 +40,45 @@ private:
 	// datum corresponding to the point
 	IDatum *m_datum;
 
+	// the statistics mapping of the datum, read through virtual calls, is
+	// cached on first use so that comparing and subtracting points during
+	// statistics derivation does not need to go back to the datum
+
+	// has the mapping been cached
+	mutable BOOL m_is_mapping_cached;
+
+	// is the datum null
+	mutable BOOL m_is_null;
+
+	// can the datum be mapped to LINT or double, respectively
+	mutable BOOL m_is_mappable_to_lint;
+	mutable BOOL m_is_mappable_to_double;
+
+	// is the type of the datum time related
+	mutable BOOL m_is_time_related;
+
+	// LINT and double mapping of the datum, if it can be mapped
+	mutable LINT m_lint_mapping;
+	mutable CDouble m_double_mapping;
+
+	// cache the statistics mapping of the datum
+	void CacheMapping() const;
+
+	// are the two points comparable for statistics, as in
+	// IDatum::StatsAreComparable
+	BOOL StatsAreComparable(const CPoint *point) const;
+
+	// are the two points compared by their LINT mapping; otherwise they
+	// are compared by their double mapping
+	BOOL
+	IsLINTComparison(const CPoint *point) const
+	{
+		return m_is_mappable_to_lint && point->m_is_mappable_to_lint;
+	}
+
+	// less than, for comparable points, as in IDatum::StatsAreLessThan
+	BOOL StatsAreLessThan(const CPoint *point) const;
+
 public:
 	CPoint &operator=(CPoint &) = delete;
 
@@ -39,6 +39,9 @@
 #include "naucrates/dxl/parser/CParseHandlerFactory.h"
 #include "naucrates/dxl/parser/CParseHandlerManager.h"
 #include "naucrates/dxl/parser/CParseHandlerPlan.h"
+#include "naucrates/dxl/xml/CDXLBinaryReader.h"
+#include "naucrates/dxl/xml/CDXLBinaryRecorder.h"
+#include "naucrates/dxl/xml/CDXLBinaryWriter.h"
 #include "naucrates/dxl/xml/CDXLMemoryManager.h"
 #include "naucrates/dxl/xml/CXMLSerializer.h"
 #include "naucrates/md/CDXLStatsDerivedRelation.h"
@@ -62,6 +65,7 @@ XERCES_CPP_NAMESPACE_USE
 //		Start the parsing of the given DXL string and return the top-level parser.
 //		If a non-empty XSD schema location is provided, the DXL is validated against
 //		that schema, and an exception is thrown if the DXL does not conform.
+//		Binary DXL documents are also accepted; they are never validated.
 //
 //---------------------------------------------------------------------------
 CParseHandlerDXL *
@@ -70,6 +74,13 @@ CDXLUtils::GetParseHandlerForDXLString(CMemoryPool *mp, const CHAR *dxl_string,
 {
 	GPOS_ASSERT(nullptr != mp);
 
+	if (CDXLBinaryReader::IsBinaryDXL((const BYTE *) dxl_string))
+	{
+		return GetParseHandlerForBinaryDXL(
+			mp, (const BYTE *) dxl_string,
+			CDXLBinaryReader::DocumentLength((const BYTE *) dxl_string));
+	}
+
 	// setup own memory manager
 	CDXLMemoryManager *memory_manager = GPOS_NEW(mp) CDXLMemoryManager(mp);
 	SAX2XMLReader *sax_2_xml_reader =
@@ -148,6 +159,7 @@ CDXLUtils::GetParseHandlerForDXLString(CMemoryPool *mp, const CHAR *dxl_string,
 //		Start the parsing of the given DXL string and return the top-level parser.
 //		If a non-empty XSD schema location is provided, the DXL is validated against
 //		that schema, and an exception is thrown if the DXL does not conform.
+//		Binary DXL files are also accepted; they are never validated.
 //
 //---------------------------------------------------------------------------
 CParseHandlerDXL *
@@ -156,6 +168,15 @@ CDXLUtils::GetParseHandlerForDXLFile(CMemoryPool *mp, const CHAR *dxl_filename,
 {
 	GPOS_ASSERT(nullptr != mp);
 
+	ULONG binary_length = 0;
+	CAutoRg<BYTE> binary_dxl(
+		ReadBinaryDXLFile(mp, dxl_filename, &binary_length));
+	if (nullptr != binary_dxl.Rgt())
+	{
+		return GetParseHandlerForBinaryDXL(mp, binary_dxl.Rgt(),
+										   binary_length);
+	}
+
 	// setup own memory manager
 	CDXLMemoryManager mm(mp);
 	SAX2XMLReader *sax_2_xml_reader = nullptr;
@@ -232,6 +253,106 @@ CDXLUtils::GetParseHandlerForDXLFile(CMemoryPool *mp, const CHAR *dxl_filename,
 }
 
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLUtils::GetParseHandlerForBinaryDXL
+//
+//	@doc:
+//		Parse the given binary DXL document and return the top-level parser.
+//		The document is replayed to the same parse handlers that process
+//		text documents.
+//
+//---------------------------------------------------------------------------
+CParseHandlerDXL *
+CDXLUtils::GetParseHandlerForBinaryDXL(CMemoryPool *mp, const BYTE *buffer,
+									   ULONG length)
+{
+	GPOS_ASSERT(nullptr != mp);
+	GPOS_ASSERT(nullptr != buffer);
+
+	// the parse handlers install each other as content handlers of a
+	// Xerces reader, which is never asked to parse anything itself
+	CDXLMemoryManager mm(mp);
+	SAX2XMLReader *sax_2_xml_reader = XMLReaderFactory::createXMLReader(&mm);
+
+	CParseHandlerManager parse_handler_mgr(&mm, sax_2_xml_reader);
+	CAutoP<CParseHandlerDXL> parse_handler_dxl(
+		CParseHandlerFactory::GetParseHandlerDXL(mp, &parse_handler_mgr));
+	parse_handler_mgr.ActivateParseHandler(parse_handler_dxl.Value());
+
+	GPOS_TRY
+	{
+		CDXLBinaryReader binary_reader(mp, buffer, length);
+		binary_reader.Parse(sax_2_xml_reader);
+	}
+	GPOS_CATCH_EX(ex)
+	{
+		delete sax_2_xml_reader;
+		GPOS_RETHROW(ex);
+	}
+	GPOS_CATCH_END;
+
+	GPOS_CHECK_ABORT;
+
+	// cleanup
+	delete sax_2_xml_reader;
+
+	return parse_handler_dxl.Reset();
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLUtils::ReadBinaryDXLFile
+//
+//	@doc:
+//		Read the given file into a buffer allocated in the given memory pool
+//		if it holds a binary DXL document. Return NULL, without reading the
+//		rest of the file, if it holds a text document.
+//
+//---------------------------------------------------------------------------
+BYTE *
+CDXLUtils::ReadBinaryDXLFile(CMemoryPool *mp, const CHAR *filename,
+							 ULONG *length)
+{
+	GPOS_ASSERT(nullptr != length);
+
+	CFileReader fr;
+	fr.Open(filename);
+
+	const ULONG_PTR file_size = (ULONG_PTR) fr.FileSize();
+
+	// NUL-terminated, so that the magic bytes of short files can be checked
+	BYTE magic[GPDXL_BINARY_MAGIC_LENGTH + 1] = {0};
+	const ULONG_PTR magic_length = (GPDXL_BINARY_MAGIC_LENGTH < file_size)
+									   ? GPDXL_BINARY_MAGIC_LENGTH
+									   : file_size;
+	if (magic_length != fr.ReadBytesToBuffer(magic, magic_length) ||
+		!CDXLBinaryReader::IsBinaryDXL(magic))
+	{
+		fr.Close();
+		return nullptr;
+	}
+
+	if (gpos::ulong_max < file_size)
+	{
+		fr.Close();
+		GPOS_RAISE(gpdxl::ExmaDXL, gpdxl::ExmiDXLBinaryParseError,
+				   "document too large");
+	}
+
+	CAutoRg<BYTE> read_buffer(GPOS_NEW_ARRAY(mp, BYTE, file_size));
+	clib::Memcpy(read_buffer.Rgt(), magic, magic_length);
+
+	const ULONG_PTR read_bytes = fr.ReadBytesToBuffer(
+		read_buffer.Rgt() + magic_length, file_size - magic_length);
+	fr.Close();
+
+	GPOS_ASSERT(read_bytes == file_size - magic_length);
+	*length = (ULONG)(magic_length + read_bytes);
+
+	return read_buffer.RgtReset();
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CDXLUtils::GetParseHandlerForDXLString
@@ -774,6 +895,41 @@ CDXLUtils::ParseDXLToIMDIdCacheObj(CMemoryPool *mp,
 	return imd_cached_obj;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLUtils::ParseDXLToIMDIdCacheObj
+//
+//	@doc:
+//		Parse a single metadata object given its DXL representation as a
+//		multi-byte character string
+//
+//---------------------------------------------------------------------------
+IMDCacheObject *
+CDXLUtils::ParseDXLToIMDIdCacheObj(CMemoryPool *mp, const CHAR *dxl_string,
+								   const CHAR *xsd_file_path)
+{
+	GPOS_ASSERT(nullptr != mp);
+
+	// create and install a parse handler for the DXL document
+	CAutoP<CParseHandlerDXL> parse_handler_dxl_array(
+		GetParseHandlerForDXLString(mp, dxl_string, xsd_file_path));
+
+	// collect metadata objects from dxl parse handler
+	IMDCacheObjectArray *imd_obj_array =
+		parse_handler_dxl_array->GetMdIdCachedObjArray();
+
+	if (0 == imd_obj_array->Size())
+	{
+		// no metadata objects found
+		return nullptr;
+	}
+
+	IMDCacheObject *imd_cached_obj = (*imd_obj_array)[0];
+	imd_cached_obj->AddRef();
+
+	return imd_cached_obj;
+}
+
 
 //---------------------------------------------------------------------------
 //	@function:
@@ -1313,6 +1469,113 @@ CDXLUtils::SerializeMDObj(CMemoryPool *mp, const IMDCacheObject *imd_cache_obj,
 	return string_var.Reset();
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLUtils::SerializeMDObjToBinary
+//
+//	@doc:
+//		Serialize an MD object into a binary DXL document, allocated in the
+//		given memory pool
+//
+//---------------------------------------------------------------------------
+BYTE *
+CDXLUtils::SerializeMDObjToBinary(CMemoryPool *mp,
+								  const IMDCacheObject *imd_cache_obj,
+								  ULONG *length)
+{
+	GPOS_ASSERT(nullptr != mp);
+	GPOS_ASSERT(nullptr != imd_cache_obj);
+	GPOS_ASSERT(nullptr != length);
+
+	CDXLBinaryWriter binary_writer(mp);
+
+	{
+		CXMLSerializer xml_serializer(mp, &binary_writer);
+
+		SerializeHeader(mp, &xml_serializer);
+		xml_serializer.OpenElement(
+			CDXLTokens::GetDXLTokenStr(EdxltokenNamespacePrefix),
+			CDXLTokens::GetDXLTokenStr(EdxltokenMetadata));
+		GPOS_CHECK_ABORT;
+
+		imd_cache_obj->Serialize(&xml_serializer);
+		GPOS_CHECK_ABORT;
+
+		xml_serializer.CloseElement(
+			CDXLTokens::GetDXLTokenStr(EdxltokenNamespacePrefix),
+			CDXLTokens::GetDXLTokenStr(EdxltokenMetadata));
+		SerializeFooter(&xml_serializer);
+	}
+
+	binary_writer.EndDocument();
+
+	*length = binary_writer.Length();
+	BYTE *binary_dxl = GPOS_NEW_ARRAY(mp, BYTE, *length);
+	clib::Memcpy(binary_dxl, binary_writer.GetBuffer(), *length);
+
+	return binary_dxl;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLUtils::ConvertDXLToBinary
+//
+//	@doc:
+//		Parse a DXL document and encode it as a binary DXL document,
+//		allocated in the given memory pool
+//
+//---------------------------------------------------------------------------
+BYTE *
+CDXLUtils::ConvertDXLToBinary(CMemoryPool *mp, const CHAR *dxl_string,
+							  ULONG *length)
+{
+	GPOS_ASSERT(nullptr != mp);
+	GPOS_ASSERT(nullptr != dxl_string);
+	GPOS_ASSERT(nullptr != length);
+
+	CDXLMemoryManager mm(mp);
+	SAX2XMLReader *sax_2_xml_reader = XMLReaderFactory::createXMLReader(&mm);
+
+	CDXLBinaryWriter binary_writer(mp);
+	CDXLBinaryRecorder binary_recorder(mp, &binary_writer);
+	sax_2_xml_reader->setContentHandler(&binary_recorder);
+
+	MemBufInputSource *input_src_memory_buffer = new (&mm)
+		MemBufInputSource((const XMLByte *) dxl_string, strlen(dxl_string),
+						  "dxl test", false, &mm);
+
+	try
+	{
+		sax_2_xml_reader->parse(*input_src_memory_buffer);
+	}
+	catch (const XMLException &)
+	{
+		delete sax_2_xml_reader;
+		delete input_src_memory_buffer;
+		GPOS_RAISE(gpdxl::ExmaDXL, gpdxl::ExmiDXLXercesParseError);
+		return nullptr;
+	}
+	catch (const SAXException &)
+	{
+		delete sax_2_xml_reader;
+		delete input_src_memory_buffer;
+		GPOS_RAISE(gpdxl::ExmaDXL, gpdxl::ExmiDXLXercesParseError);
+		return nullptr;
+	}
+
+	GPOS_CHECK_ABORT;
+
+	// cleanup
+	delete sax_2_xml_reader;
+	delete input_src_memory_buffer;
+
+	*length = binary_writer.Length();
+	BYTE *binary_dxl = GPOS_NEW_ARRAY(mp, BYTE, *length);
+	clib::Memcpy(binary_dxl, binary_writer.GetBuffer(), *length);
+
+	return binary_dxl;
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CDXLUtils::SerializeScalarExpr
@@ -14,6 +14,7 @@
 #include "gpos/base.h"
 
 #include "gpopt/mdcache/CMDAccessor.h"
+#include "naucrates/md/CMDTypeGenericGPDB.h"
 #include "naucrates/statistics/CStatistics.h"
 
 using namespace gpnaucrates;
@@ -29,11 +30,115 @@ FORCE_GENERATE_DBGSTR(CPoint);
 //		Ctor
 //
 //---------------------------------------------------------------------------
-CPoint::CPoint(IDatum *datum) : m_datum(datum)
+CPoint::CPoint(IDatum *datum)
+	: m_datum(datum),
+	  m_is_mapping_cached(false),
+	  m_is_null(false),
+	  m_is_mappable_to_lint(false),
+	  m_is_mappable_to_double(false),
+	  m_is_time_related(false),
+	  m_lint_mapping(0),
+	  m_double_mapping(0.0)
 {
 	GPOS_ASSERT(nullptr != m_datum);
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CPoint::CacheMapping
+//
+//	@doc:
+//		Cache the statistics mapping of the datum. This is not done in the
+//		ctor, as mapping generic datums requires an optimization context,
+//		which is not available everywhere points are created.
+//
+//---------------------------------------------------------------------------
+void
+CPoint::CacheMapping() const
+{
+	if (m_is_mapping_cached)
+	{
+		return;
+	}
+
+	m_is_null = m_datum->IsNull();
+	m_is_mappable_to_lint = m_datum->IsDatumMappableToLINT();
+	m_is_mappable_to_double = m_datum->IsDatumMappableToDouble();
+	m_is_time_related = CMDTypeGenericGPDB::IsTimeRelatedType(m_datum->MDId());
+
+	if (!m_is_null && m_is_mappable_to_lint)
+	{
+		m_lint_mapping = m_datum->GetLINTMapping();
+	}
+
+	if (!m_is_null && m_is_mappable_to_double)
+	{
+		m_double_mapping = m_datum->GetDoubleMapping();
+	}
+
+	m_is_mapping_cached = true;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CPoint::StatsAreComparable
+//
+//	@doc:
+//		Check if the given pair of points are stats comparable
+//
+//---------------------------------------------------------------------------
+BOOL
+CPoint::StatsAreComparable(const CPoint *point) const
+{
+	GPOS_ASSERT(nullptr != point);
+
+	CacheMapping();
+	point->CacheMapping();
+
+	// the statistics of different time related types can't be compared
+	if (m_is_time_related && point->m_is_time_related &&
+		!m_datum->MDId()->Equals(point->m_datum->MDId()))
+	{
+		return false;
+	}
+
+	return IsLINTComparison(point) ||
+		   (m_is_mappable_to_double && point->m_is_mappable_to_double);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CPoint::StatsAreLessThan
+//
+//	@doc:
+//		Less-than based on the cached mapping of comparable points
+//
+//---------------------------------------------------------------------------
+BOOL
+CPoint::StatsAreLessThan(const CPoint *point) const
+{
+	GPOS_ASSERT(StatsAreComparable(point));
+
+	if (m_is_null)
+	{
+		// nulls are less than everything else except nulls
+		return !point->m_is_null;
+	}
+
+	if (point->m_is_null)
+	{
+		return false;
+	}
+
+	if (IsLINTComparison(point))
+	{
+		return m_lint_mapping < point->m_lint_mapping;
+	}
+
+	CDouble diff = point->m_double_mapping - m_double_mapping;
+	return diff > CStatistics::Epsilon;
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CPoint::Equals
@@ -46,7 +151,30 @@ BOOL
 CPoint::Equals(const CPoint *point) const
 {
 	GPOS_ASSERT(nullptr != point);
-	return m_datum->StatsAreEqual(point->m_datum);
+
+	CacheMapping();
+	point->CacheMapping();
+
+	// datums without a common mapping are compared by the datum itself
+	if (!IsLINTComparison(point) &&
+		!(m_is_mappable_to_double && point->m_is_mappable_to_double))
+	{
+		return m_datum->StatsAreEqual(point->m_datum);
+	}
+
+	if (m_is_null || point->m_is_null)
+	{
+		// nulls are equal from stats point of view
+		return m_is_null && point->m_is_null;
+	}
+
+	if (IsLINTComparison(point))
+	{
+		return m_lint_mapping == point->m_lint_mapping;
+	}
+
+	CDouble diff = m_double_mapping - point->m_double_mapping;
+	return diff.Absolute() <= CStatistics::Epsilon;
 }
 
 //---------------------------------------------------------------------------
@@ -75,8 +203,7 @@ BOOL
 CPoint::IsLessThan(const CPoint *point) const
 {
 	GPOS_ASSERT(nullptr != point);
-	return m_datum->StatsAreComparable(point->m_datum) &&
-		   m_datum->StatsAreLessThan(point->m_datum);
+	return StatsAreComparable(point) && StatsAreLessThan(point);
 }
 
 //---------------------------------------------------------------------------
@@ -104,8 +231,8 @@ CPoint::IsLessThanOrEqual(const CPoint *point) const
 BOOL
 CPoint::IsGreaterThan(const CPoint *point) const
 {
-	return m_datum->StatsAreComparable(point->m_datum) &&
-		   m_datum->StatsAreGreaterThan(point->m_datum);
+	GPOS_ASSERT(nullptr != point);
+	return StatsAreComparable(point) && point->StatsAreLessThan(this);
 }
 
 //---------------------------------------------------------------------------
@@ -139,11 +266,25 @@ CPoint::Width(const CPoint *point, BOOL include_lower, BOOL include_upper) const
 	CDouble width = CDouble(1.0);
 	CDouble adjust = CDouble(0.0);
 	GPOS_ASSERT(nullptr != point);
-	if (m_datum->StatsAreComparable(point->m_datum))
+	if (StatsAreComparable(point))
 	{
-		// default case [this, point) or (this, point]
-		width = CDouble(m_datum->GetStatsDistanceFrom(point->m_datum));
-		if (m_datum->IsDatumMappableToLINT())
+		// default case [this, point) or (this, point]; as in
+		// IDatum::GetStatsDistanceFrom, a null point is at distance one
+		// from another null point and at distance zero from anything else
+		if (m_is_null || point->m_is_null)
+		{
+			width = CDouble(m_is_null && point->m_is_null ? 1.0 : 0.0);
+		}
+		else if (IsLINTComparison(point))
+		{
+			width = CDouble(m_lint_mapping - point->m_lint_mapping);
+		}
+		else
+		{
+			width = m_double_mapping - point->m_double_mapping;
+		}
+
+		if (m_is_mappable_to_lint)
 		{
 			adjust = CDouble(1.0);
 		}
@@ -152,7 +293,7 @@ CPoint::Width(const CPoint *point, BOOL include_lower, BOOL include_upper) const
 			// for the case of doubles, the distance could be any point along
 			// between the int values, so make a small adjust by a factor of
 			// 10 * Epsilon (as anything smaller than Epsilon is treated as 0)
-			GPOS_ASSERT(m_datum->IsDatumMappableToDouble());
+			GPOS_ASSERT(m_is_mappable_to_double);
 			adjust = CStatistics::Epsilon * 10;
 		}
 	}
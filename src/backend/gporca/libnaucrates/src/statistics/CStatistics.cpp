@@ -12,6 +12,7 @@
 #include "naucrates/statistics/CStatistics.h"
 
 #include "gpos/common/CBitSet.h"
+#include "gpos/common/COpenHashMapIter.h"
 #include "gpos/error/CAutoTrace.h"
 #include "gpos/memory/CAutoMemoryPool.h"
 
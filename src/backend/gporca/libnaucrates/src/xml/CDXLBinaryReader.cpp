@@ -0,0 +1,708 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2022 VMware, Inc. or its affiliates.
+//
+//	@filename:
+//		CDXLBinaryReader.cpp
+//
+//	@doc:
+//		Implementation of the class for reading binary DXL documents.
+//---------------------------------------------------------------------------
+
+#include "naucrates/dxl/xml/CDXLBinaryReader.h"
+
+#include <xercesc/util/XMLString.hpp>
+#include <xercesc/util/XMLUniDefs.hpp>
+
+#include "naucrates/exception.h"
+
+using namespace gpdxl;
+
+// initial sizes of the arrays of the reader
+#define GPDXL_BINARY_INITIAL_NAMES 256
+#define GPDXL_BINARY_INITIAL_NAMESPACES 4
+#define GPDXL_BINARY_INITIAL_ELEMENTS 64
+#define GPDXL_BINARY_INITIAL_ATTRS 16
+#define GPDXL_BINARY_INITIAL_VALUES 1024
+
+// number of records read between checks for aborts
+#define GPDXL_BINARY_CFA_FREQUENCY 1024
+
+// empty string, used as namespace uri of attributes
+static const XMLCh xmlch_empty[] = {0};
+
+// type of all attributes, "CDATA"
+static const XMLCh xmlch_cdata[] = {'C', 'D', 'A', 'T', 'A', 0};
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::CDXLBinaryReader
+//
+//	@doc:
+//		Ctor; validates the document header
+//
+//---------------------------------------------------------------------------
+CDXLBinaryReader::CDXLBinaryReader(CMemoryPool *mp, const BYTE *buffer,
+								   ULONG length)
+	: m_mp(mp),
+	  m_pos(nullptr),
+	  m_end(nullptr),
+	  m_names(nullptr),
+	  m_num_names(0),
+	  m_names_capacity(GPDXL_BINARY_INITIAL_NAMES),
+	  m_namespaces(nullptr),
+	  m_num_namespaces(0),
+	  m_namespaces_capacity(GPDXL_BINARY_INITIAL_NAMESPACES),
+	  m_elements(nullptr),
+	  m_num_elements(0),
+	  m_elements_capacity(GPDXL_BINARY_INITIAL_ELEMENTS),
+	  m_pending_name_id(0),
+	  m_attr_name_ids(nullptr),
+	  m_attr_value_offsets(nullptr),
+	  m_num_attrs(0),
+	  m_attrs_capacity(GPDXL_BINARY_INITIAL_ATTRS),
+	  m_attr_qnames(nullptr),
+	  m_attr_local_names(nullptr),
+	  m_attr_values(nullptr),
+	  m_values(nullptr),
+	  m_values_size(0),
+	  m_values_capacity(GPDXL_BINARY_INITIAL_VALUES)
+{
+	GPOS_ASSERT(nullptr != buffer);
+
+	if (GPDXL_BINARY_HEADER_LENGTH > length || !IsBinaryDXL(buffer))
+	{
+		RaiseError("invalid header");
+	}
+
+	const ULONG version = (ULONG) buffer[4] | ((ULONG) buffer[5] << 8);
+	if (GPDXL_BINARY_VERSION != version)
+	{
+		RaiseError("unsupported version");
+	}
+
+	if (DocumentLength(buffer) != length)
+	{
+		RaiseError("unexpected document length");
+	}
+
+	m_pos = buffer + GPDXL_BINARY_HEADER_LENGTH;
+	m_end = buffer + length;
+
+	m_names = GPOS_NEW_ARRAY(m_mp, SName, m_names_capacity);
+	m_namespaces = GPOS_NEW_ARRAY(m_mp, SNamespace, m_namespaces_capacity);
+	m_elements = GPOS_NEW_ARRAY(m_mp, SElement, m_elements_capacity);
+	m_attr_name_ids = GPOS_NEW_ARRAY(m_mp, ULONG, m_attrs_capacity);
+	m_attr_value_offsets = GPOS_NEW_ARRAY(m_mp, ULONG, m_attrs_capacity);
+	m_attr_qnames = GPOS_NEW_ARRAY(m_mp, const XMLCh *, m_attrs_capacity);
+	m_attr_local_names =
+		GPOS_NEW_ARRAY(m_mp, const XMLCh *, m_attrs_capacity);
+	m_attr_values = GPOS_NEW_ARRAY(m_mp, const XMLCh *, m_attrs_capacity);
+	m_values = GPOS_NEW_ARRAY(m_mp, XMLCh, m_values_capacity);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::~CDXLBinaryReader
+//
+//	@doc:
+//		Dtor
+//
+//---------------------------------------------------------------------------
+CDXLBinaryReader::~CDXLBinaryReader()
+{
+	for (ULONG ul = 0; ul < m_num_names; ul++)
+	{
+		GPOS_DELETE_ARRAY(m_names[ul].m_qname);
+	}
+
+	GPOS_DELETE_ARRAY(m_names);
+	GPOS_DELETE_ARRAY(m_namespaces);
+	GPOS_DELETE_ARRAY(m_elements);
+	GPOS_DELETE_ARRAY(m_attr_name_ids);
+	GPOS_DELETE_ARRAY(m_attr_value_offsets);
+	GPOS_DELETE_ARRAY(m_attr_qnames);
+	GPOS_DELETE_ARRAY(m_attr_local_names);
+	GPOS_DELETE_ARRAY(m_attr_values);
+	GPOS_DELETE_ARRAY(m_values);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::IsBinaryDXL
+//
+//	@doc:
+//		Does the buffer start with the magic bytes of a binary DXL document.
+//		Bytes are compared one at a time, so that a NUL-terminated text
+//		document shorter than the magic is never read past its end.
+//
+//---------------------------------------------------------------------------
+BOOL
+CDXLBinaryReader::IsBinaryDXL(const BYTE *buffer)
+{
+	GPOS_ASSERT(nullptr != buffer);
+
+	const BYTE *magic = (const BYTE *) GPDXL_BINARY_MAGIC;
+	for (ULONG ul = 0; ul < GPDXL_BINARY_MAGIC_LENGTH; ul++)
+	{
+		if (magic[ul] != buffer[ul])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::DocumentLength
+//
+//	@doc:
+//		Length of the binary DXL document in the buffer, as recorded in
+//		its header
+//
+//---------------------------------------------------------------------------
+ULONG
+CDXLBinaryReader::DocumentLength(const BYTE *buffer)
+{
+	GPOS_ASSERT(IsBinaryDXL(buffer));
+
+	const ULONG body_length = (ULONG) buffer[8] | ((ULONG) buffer[9] << 8) |
+							  ((ULONG) buffer[10] << 16) |
+							  ((ULONG) buffer[11] << 24);
+
+	return GPDXL_BINARY_HEADER_LENGTH + body_length;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::RaiseError
+//
+//	@doc:
+//		Raise an exception for a malformed document
+//
+//---------------------------------------------------------------------------
+void
+CDXLBinaryReader::RaiseError(const CHAR *message)
+{
+	GPOS_RAISE(gpdxl::ExmaDXL, gpdxl::ExmiDXLBinaryParseError, message);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::Grow
+//
+//	@doc:
+//		Return a copy of the first elements of the array with twice its
+//		capacity, and free the original
+//
+//---------------------------------------------------------------------------
+template <class T>
+T *
+CDXLBinaryReader::Grow(T *array, ULONG size, ULONG capacity)
+{
+	T *new_array = GPOS_NEW_ARRAY(m_mp, T, 2 * capacity);
+	clib::Memcpy(new_array, array, size * sizeof(T));
+	GPOS_DELETE_ARRAY(array);
+
+	return new_array;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::ReadByte
+//
+//	@doc:
+//		Read a byte
+//
+//---------------------------------------------------------------------------
+BYTE
+CDXLBinaryReader::ReadByte()
+{
+	if (m_pos == m_end)
+	{
+		RaiseError("unexpected end of document");
+	}
+
+	return *m_pos++;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::ReadVarint
+//
+//	@doc:
+//		Read an integer encoded with 7 bits per byte
+//
+//---------------------------------------------------------------------------
+ULONG
+CDXLBinaryReader::ReadVarint()
+{
+	ULONG value = 0;
+	for (ULONG shift = 0; shift < 32; shift += 7)
+	{
+		BYTE byte = ReadByte();
+		value |= (ULONG)(byte & 0x7F) << shift;
+		if (0 == (byte & 0x80))
+		{
+			return value;
+		}
+	}
+
+	RaiseError("integer out of range");
+	return 0;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::ReadString
+//
+//	@doc:
+//		Read the given number of little-endian UTF-16 code units into the
+//		buffer and terminate it
+//
+//---------------------------------------------------------------------------
+void
+CDXLBinaryReader::ReadString(XMLCh *dest, ULONG length)
+{
+	if ((ULONG_PTR)(m_end - m_pos) / 2 < length)
+	{
+		RaiseError("unexpected end of document");
+	}
+
+	for (ULONG ul = 0; ul < length; ul++)
+	{
+		dest[ul] = (XMLCh)(m_pos[0] | (m_pos[1] << 8));
+		m_pos += 2;
+	}
+	dest[length] = 0;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::ReadName
+//
+//	@doc:
+//		Read a reference to a name; a zero introduces a new name, which gets
+//		the next number
+//
+//---------------------------------------------------------------------------
+ULONG
+CDXLBinaryReader::ReadName()
+{
+	const ULONG id = ReadVarint();
+	if (0 != id)
+	{
+		if (id > m_num_names)
+		{
+			RaiseError("undefined name");
+		}
+
+		return id;
+	}
+
+	const ULONG length = ReadVarint();
+	if ((ULONG_PTR)(m_end - m_pos) / 2 < length)
+	{
+		RaiseError("unexpected end of document");
+	}
+
+	if (m_num_names == m_names_capacity)
+	{
+		m_names = Grow(m_names, m_num_names, m_names_capacity);
+		m_names_capacity *= 2;
+	}
+
+	SName &name = m_names[m_num_names];
+	name.m_qname = GPOS_NEW_ARRAY(m_mp, XMLCh, length + 1);
+	name.m_length = length;
+	name.m_local_offset = 0;
+	m_num_names++;
+
+	ReadString(name.m_qname, length);
+	for (ULONG ul = 0; ul < length; ul++)
+	{
+		if (chColon == name.m_qname[ul])
+		{
+			name.m_local_offset = ul + 1;
+			break;
+		}
+	}
+
+	return m_num_names;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::ResolveURI
+//
+//	@doc:
+//		Namespace uri bound to the prefix of the given element name in the
+//		current scope; the empty string if the prefix is not bound
+//
+//---------------------------------------------------------------------------
+const XMLCh *
+CDXLBinaryReader::ResolveURI(const SName &name) const
+{
+	// length of the prefix, without the colon
+	const ULONG prefix_length =
+		(0 == name.m_local_offset) ? 0 : name.m_local_offset - 1;
+
+	for (ULONG ul = m_num_namespaces; ul > 0; ul--)
+	{
+		const SNamespace &binding = m_namespaces[ul - 1];
+		const SName &prefix = m_names[binding.m_prefix_id - 1];
+		if (prefix.m_length == prefix_length &&
+			0 == clib::Memcmp(prefix.m_qname, name.m_qname,
+							  prefix_length * sizeof(XMLCh)))
+		{
+			return m_names[binding.m_uri_id - 1].m_qname;
+		}
+	}
+
+	return xmlch_empty;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::StartPendingElement
+//
+//	@doc:
+//		Report the start of the pending element, now that all its attributes
+//		and namespace declarations have been read
+//
+//---------------------------------------------------------------------------
+void
+CDXLBinaryReader::StartPendingElement(ContentHandler *handler)
+{
+	GPOS_ASSERT(0 != m_pending_name_id);
+
+	for (ULONG ul = 0; ul < m_num_attrs; ul++)
+	{
+		const SName &attr_name = m_names[m_attr_name_ids[ul] - 1];
+		m_attr_qnames[ul] = attr_name.m_qname;
+		m_attr_local_names[ul] = attr_name.m_qname + attr_name.m_local_offset;
+		m_attr_values[ul] = m_values + m_attr_value_offsets[ul];
+	}
+	m_attributes.Set(m_num_attrs, m_attr_qnames, m_attr_local_names,
+					 m_attr_values);
+
+	const SName &name = m_names[m_pending_name_id - 1];
+	const XMLCh *uri = ResolveURI(name);
+
+	if (m_num_elements == m_elements_capacity)
+	{
+		m_elements = Grow(m_elements, m_num_elements, m_elements_capacity);
+		m_elements_capacity *= 2;
+	}
+	m_elements[m_num_elements].m_name_id = m_pending_name_id;
+	m_elements[m_num_elements].m_uri = uri;
+	m_num_elements++;
+
+	m_pending_name_id = 0;
+
+	handler->startElement(uri, name.m_qname + name.m_local_offset,
+						  name.m_qname, m_attributes);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::Parse
+//
+//	@doc:
+//		Replay the document as SAX events. The content handler is looked up
+//		for every event, as the DXL parse handlers replace each other in the
+//		reader while processing the events.
+//
+//---------------------------------------------------------------------------
+void
+CDXLBinaryReader::Parse(SAX2XMLReader *sax_2_xml_reader)
+{
+	GPOS_ASSERT(nullptr != sax_2_xml_reader);
+
+	sax_2_xml_reader->getContentHandler()->startDocument();
+
+	ULONG iteration_since_last_abortcheck = 0;
+	while (true)
+	{
+		if (GPDXL_BINARY_CFA_FREQUENCY < ++iteration_since_last_abortcheck)
+		{
+			GPOS_CHECK_ABORT;
+			iteration_since_last_abortcheck = 0;
+		}
+
+		const BYTE op = ReadByte();
+		if (0 != m_pending_name_id && EdxlbinopAttribute != op &&
+			EdxlbinopNamespace != op)
+		{
+			StartPendingElement(sax_2_xml_reader->getContentHandler());
+		}
+
+		switch (op)
+		{
+			case EdxlbinopStartElement:
+			{
+				m_pending_name_id = ReadName();
+				m_num_attrs = 0;
+				m_values_size = 0;
+				break;
+			}
+
+			case EdxlbinopAttribute:
+			{
+				if (0 == m_pending_name_id)
+				{
+					RaiseError("attribute outside of element start");
+				}
+
+				const ULONG name_id = ReadName();
+				const ULONG length = ReadVarint();
+				if ((ULONG_PTR)(m_end - m_pos) / 2 < length)
+				{
+					RaiseError("unexpected end of document");
+				}
+
+				if (m_num_attrs == m_attrs_capacity)
+				{
+					m_attr_name_ids =
+						Grow(m_attr_name_ids, m_num_attrs, m_attrs_capacity);
+					m_attr_value_offsets = Grow(m_attr_value_offsets,
+												m_num_attrs, m_attrs_capacity);
+					m_attr_qnames = Grow(m_attr_qnames, 0, m_attrs_capacity);
+					m_attr_local_names =
+						Grow(m_attr_local_names, 0, m_attrs_capacity);
+					m_attr_values = Grow(m_attr_values, 0, m_attrs_capacity);
+					m_attrs_capacity *= 2;
+				}
+
+				while (m_values_capacity < m_values_size + length + 1)
+				{
+					m_values =
+						Grow(m_values, m_values_size, m_values_capacity);
+					m_values_capacity *= 2;
+				}
+
+				m_attr_name_ids[m_num_attrs] = name_id;
+				m_attr_value_offsets[m_num_attrs] = m_values_size;
+				m_num_attrs++;
+
+				ReadString(m_values + m_values_size, length);
+				m_values_size += length + 1;
+				break;
+			}
+
+			case EdxlbinopNamespace:
+			{
+				if (0 == m_pending_name_id)
+				{
+					RaiseError("namespace outside of element start");
+				}
+
+				if (m_num_namespaces == m_namespaces_capacity)
+				{
+					m_namespaces = Grow(m_namespaces, m_num_namespaces,
+										m_namespaces_capacity);
+					m_namespaces_capacity *= 2;
+				}
+
+				SNamespace &binding = m_namespaces[m_num_namespaces];
+				binding.m_prefix_id = ReadName();
+				binding.m_uri_id = ReadName();
+				binding.m_level = m_num_elements + 1;
+				m_num_namespaces++;
+				break;
+			}
+
+			case EdxlbinopEndElement:
+			{
+				if (0 == m_num_elements)
+				{
+					RaiseError("unbalanced element end");
+				}
+
+				const SElement &element = m_elements[m_num_elements - 1];
+				const SName &name = m_names[element.m_name_id - 1];
+				sax_2_xml_reader->getContentHandler()->endElement(
+					element.m_uri, name.m_qname + name.m_local_offset,
+					name.m_qname);
+
+				while (0 < m_num_namespaces &&
+					   m_num_elements ==
+						   m_namespaces[m_num_namespaces - 1].m_level)
+				{
+					m_num_namespaces--;
+				}
+				m_num_elements--;
+				break;
+			}
+
+			case EdxlbinopEndDocument:
+			{
+				if (0 != m_num_elements || m_pos != m_end)
+				{
+					RaiseError("unexpected end of document");
+				}
+
+				sax_2_xml_reader->getContentHandler()->endDocument();
+				return;
+			}
+
+			default:
+				RaiseError("unrecognized record");
+		}
+	}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::CAttributes::FindIndex
+//
+//	@doc:
+//		Find the attribute with the given qualified name
+//
+//---------------------------------------------------------------------------
+BOOL
+CDXLBinaryReader::CAttributes::FindIndex(const XMLCh *qname,
+										 XMLSize_t &index) const
+{
+	for (XMLSize_t ul = 0; ul < m_length; ul++)
+	{
+		if (XMLString::equals(qname, m_qnames[ul]))
+		{
+			index = ul;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryReader::CAttributes::FindIndex
+//
+//	@doc:
+//		Find the attribute with the given local name and namespace uri
+//
+//---------------------------------------------------------------------------
+BOOL
+CDXLBinaryReader::CAttributes::FindIndex(const XMLCh *uri,
+										 const XMLCh *local_name,
+										 XMLSize_t &index) const
+{
+	// attributes are not in any namespace
+	if (nullptr != uri && 0 != XMLString::stringLen(uri))
+	{
+		return false;
+	}
+
+	for (XMLSize_t ul = 0; ul < m_length; ul++)
+	{
+		if (XMLString::equals(local_name, m_local_names[ul]))
+		{
+			index = ul;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+XMLSize_t
+CDXLBinaryReader::CAttributes::getLength() const
+{
+	return m_length;
+}
+
+const XMLCh *
+CDXLBinaryReader::CAttributes::getURI(const XMLSize_t index) const
+{
+	return (index < m_length) ? xmlch_empty : nullptr;
+}
+
+const XMLCh *
+CDXLBinaryReader::CAttributes::getLocalName(const XMLSize_t index) const
+{
+	return (index < m_length) ? m_local_names[index] : nullptr;
+}
+
+const XMLCh *
+CDXLBinaryReader::CAttributes::getQName(const XMLSize_t index) const
+{
+	return (index < m_length) ? m_qnames[index] : nullptr;
+}
+
+const XMLCh *
+CDXLBinaryReader::CAttributes::getType(const XMLSize_t index) const
+{
+	return (index < m_length) ? xmlch_cdata : nullptr;
+}
+
+const XMLCh *
+CDXLBinaryReader::CAttributes::getValue(const XMLSize_t index) const
+{
+	return (index < m_length) ? m_values[index] : nullptr;
+}
+
+bool
+CDXLBinaryReader::CAttributes::getIndex(const XMLCh *const uri,
+										const XMLCh *const localPart,
+										XMLSize_t &index) const
+{
+	return FindIndex(uri, localPart, index);
+}
+
+int
+CDXLBinaryReader::CAttributes::getIndex(const XMLCh *const uri,
+										const XMLCh *const localPart) const
+{
+	XMLSize_t index = 0;
+	return FindIndex(uri, localPart, index) ? (int) index : -1;
+}
+
+bool
+CDXLBinaryReader::CAttributes::getIndex(const XMLCh *const qName,
+										XMLSize_t &index) const
+{
+	return FindIndex(qName, index);
+}
+
+int
+CDXLBinaryReader::CAttributes::getIndex(const XMLCh *const qName) const
+{
+	XMLSize_t index = 0;
+	return FindIndex(qName, index) ? (int) index : -1;
+}
+
+const XMLCh *
+CDXLBinaryReader::CAttributes::getType(const XMLCh *const uri,
+									   const XMLCh *const localPart) const
+{
+	XMLSize_t index = 0;
+	return FindIndex(uri, localPart, index) ? xmlch_cdata : nullptr;
+}
+
+const XMLCh *
+CDXLBinaryReader::CAttributes::getType(const XMLCh *const qName) const
+{
+	XMLSize_t index = 0;
+	return FindIndex(qName, index) ? xmlch_cdata : nullptr;
+}
+
+const XMLCh *
+CDXLBinaryReader::CAttributes::getValue(const XMLCh *const uri,
+										const XMLCh *const localPart) const
+{
+	XMLSize_t index = 0;
+	return FindIndex(uri, localPart, index) ? m_values[index] : nullptr;
+}
+
+const XMLCh *
+CDXLBinaryReader::CAttributes::getValue(const XMLCh *const qName) const
+{
+	XMLSize_t index = 0;
+	return FindIndex(qName, index) ? m_values[index] : nullptr;
+}
+
+// EOF
@@ -0,0 +1,177 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2022 VMware, Inc. or its affiliates.
+//
+//	@filename:
+//		CDXLBinaryRecorder.cpp
+//
+//	@doc:
+//		Implementation of the SAX handler converting DXL documents to the
+//		binary encoding.
+//---------------------------------------------------------------------------
+
+#include "naucrates/dxl/xml/CDXLBinaryRecorder.h"
+
+#include <xercesc/sax2/Attributes.hpp>
+#include <xercesc/util/XMLString.hpp>
+
+using namespace gpdxl;
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryRecorder::CDXLBinaryRecorder
+//
+//	@doc:
+//		Ctor
+//
+//---------------------------------------------------------------------------
+CDXLBinaryRecorder::CDXLBinaryRecorder(CMemoryPool *mp,
+									   CDXLBinaryWriter *writer)
+	: m_mp(mp),
+	  m_writer(writer),
+	  m_name(nullptr),
+	  m_name_capacity(0),
+	  m_value(nullptr),
+	  m_value_capacity(0)
+{
+	GPOS_ASSERT(nullptr != writer);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryRecorder::~CDXLBinaryRecorder
+//
+//	@doc:
+//		Dtor
+//
+//---------------------------------------------------------------------------
+CDXLBinaryRecorder::~CDXLBinaryRecorder()
+{
+	GPOS_DELETE_ARRAY(m_name);
+	GPOS_DELETE_ARRAY(m_value);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryRecorder::Convert
+//
+//	@doc:
+//		Convert a UTF-16 string to a NUL-terminated wide character string in
+//		the given buffer, growing it as needed
+//
+//---------------------------------------------------------------------------
+ULONG
+CDXLBinaryRecorder::Convert(const XMLCh *xmlstr, WCHAR **buffer,
+							ULONG *capacity)
+{
+	const ULONG length = (ULONG) XMLString::stringLen(xmlstr);
+	if (*capacity <= length)
+	{
+		GPOS_DELETE_ARRAY(*buffer);
+		*capacity = 2 * (length + 1);
+		*buffer = GPOS_NEW_ARRAY(m_mp, WCHAR, *capacity);
+	}
+
+	WCHAR *dest = *buffer;
+	ULONG num_chars = 0;
+	for (ULONG ul = 0; ul < length; ul++)
+	{
+		ULONG code_point = (ULONG) xmlstr[ul];
+		if (GPOS_SIZEOF(WCHAR) > 2 && 0xD800 <= code_point &&
+			0xDBFF >= code_point && ul + 1 < length &&
+			0xDC00 <= (ULONG) xmlstr[ul + 1] &&
+			0xDFFF >= (ULONG) xmlstr[ul + 1])
+		{
+			// combine surrogate pair
+			code_point = 0x10000 + ((code_point - 0xD800) << 10) +
+						 ((ULONG) xmlstr[ul + 1] - 0xDC00);
+			ul++;
+		}
+		dest[num_chars++] = (WCHAR) code_point;
+	}
+	dest[num_chars] = GPOS_WSZ_LIT('\0');
+
+	return num_chars;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryRecorder::startElement
+//
+//	@doc:
+//		Write the start of an element and its attributes. The namespace of
+//		a prefixed element is declared on the first element using it.
+//
+//---------------------------------------------------------------------------
+void
+CDXLBinaryRecorder::startElement(const XMLCh *const element_uri,
+								 const XMLCh *const,  // element_local_name,
+								 const XMLCh *const element_qname,
+								 const Attributes &attrs)
+{
+	const ULONG length = Convert(element_qname, &m_name, &m_name_capacity);
+	m_writer->StartElement(m_name);
+
+	if (nullptr != element_uri && 0 < XMLString::stringLen(element_uri))
+	{
+		// the prefix is the part of the qualified name before the colon
+		const WCHAR *prefix = GPOS_WSZ_LIT("");
+		for (ULONG ul = 0; ul < length; ul++)
+		{
+			if (GPOS_WSZ_LIT(':') == m_name[ul])
+			{
+				m_name[ul] = GPOS_WSZ_LIT('\0');
+				prefix = m_name;
+				break;
+			}
+		}
+
+		(void) Convert(element_uri, &m_value, &m_value_capacity);
+		if (!m_writer->IsNamespaceDeclared(prefix, m_value))
+		{
+			m_writer->DeclareNamespace(prefix, m_value);
+		}
+	}
+
+	const XMLSize_t num_attrs = attrs.getLength();
+	for (XMLSize_t ul = 0; ul < num_attrs; ul++)
+	{
+		(void) Convert(attrs.getQName(ul), &m_name, &m_name_capacity);
+		const ULONG value_length =
+			Convert(attrs.getValue(ul), &m_value, &m_value_capacity);
+		m_writer->AddAttribute(m_name, m_value, value_length);
+	}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryRecorder::endElement
+//
+//	@doc:
+//		Write the end of an element
+//
+//---------------------------------------------------------------------------
+void
+CDXLBinaryRecorder::endElement(const XMLCh *const,	// element_uri,
+							   const XMLCh *const,	// element_local_name,
+							   const XMLCh *const	// element_qname
+)
+{
+	m_writer->EndElement();
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryRecorder::endDocument
+//
+//	@doc:
+//		Write the end of the document
+//
+//---------------------------------------------------------------------------
+void
+CDXLBinaryRecorder::endDocument()
+{
+	m_writer->EndDocument();
+}
+
+// EOF
@@ -0,0 +1,488 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2022 VMware, Inc. or its affiliates.
+//
+//	@filename:
+//		CDXLBinaryWriter.cpp
+//
+//	@doc:
+//		Implementation of the class for creating binary DXL documents.
+//---------------------------------------------------------------------------
+
+#include "naucrates/dxl/xml/CDXLBinaryWriter.h"
+
+#include "gpos/utils.h"
+
+#include "naucrates/dxl/xml/dxltokens.h"
+
+using namespace gpdxl;
+
+// initial size of the document buffer
+#define GPDXL_BINARY_INITIAL_CAPACITY 1024
+
+// initial number of namespace bindings
+#define GPDXL_BINARY_INITIAL_NAMESPACES 4
+
+// smallest and largest code points needing a UTF-16 surrogate pair
+#define GPDXL_UTF16_SUPPLEMENTARY_MIN 0x10000
+#define GPDXL_UTF16_SUPPLEMENTARY_MAX 0x10FFFF
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryWriter::CDXLBinaryWriter
+//
+//	@doc:
+//		Ctor; reserves space for the document header
+//
+//---------------------------------------------------------------------------
+CDXLBinaryWriter::CDXLBinaryWriter(CMemoryPool *mp)
+	: m_mp(mp),
+	  m_buffer(nullptr),
+	  m_size(GPDXL_BINARY_HEADER_LENGTH),
+	  m_capacity(GPDXL_BINARY_INITIAL_CAPACITY),
+	  m_names(nullptr),
+	  m_namespaces(nullptr),
+	  m_num_namespaces(0),
+	  m_namespaces_capacity(GPDXL_BINARY_INITIAL_NAMESPACES),
+	  m_level(0),
+	  m_finished(false),
+	  m_qname(nullptr),
+	  m_qname_capacity(0)
+{
+	m_buffer = GPOS_NEW_ARRAY(m_mp, BYTE, m_capacity);
+	m_names = GPOS_NEW(m_mp) NameToIdMap(m_mp);
+	m_namespaces = GPOS_NEW_ARRAY(m_mp, SNamespace, m_namespaces_capacity);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryWriter::~CDXLBinaryWriter
+//
+//	@doc:
+//		Dtor
+//
+//---------------------------------------------------------------------------
+CDXLBinaryWriter::~CDXLBinaryWriter()
+{
+	GPOS_DELETE_ARRAY(m_buffer);
+	m_names->Release();
+	GPOS_DELETE_ARRAY(m_namespaces);
+	GPOS_DELETE_ARRAY(m_qname);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryWriter::HashName
+//
+//	@doc:
+//		Hash function for interned names
+//
+//---------------------------------------------------------------------------
+ULONG
+CDXLBinaryWriter::HashName(const CWStringConst *name)
+{
+	return gpos::HashByteArray((const BYTE *) name->GetBuffer(),
+							   name->Length() * GPOS_SIZEOF(WCHAR));
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryWriter::EqualNames
+//
+//	@doc:
+//		Equality function for interned names
+//
+//---------------------------------------------------------------------------
+BOOL
+CDXLBinaryWriter::EqualNames(const CWStringConst *left,
+							 const CWStringConst *right)
+{
+	return left->Equals(right);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryWriter::Reserve
+//
+//	@doc:
+//		Grow the document buffer so that it can hold the given number of
+//		additional bytes
+//
+//---------------------------------------------------------------------------
+void
+CDXLBinaryWriter::Reserve(ULONG length)
+{
+	GPOS_ASSERT(!m_finished);
+
+	if (m_size + length <= m_capacity)
+	{
+		return;
+	}
+
+	ULONG capacity = 2 * m_capacity;
+	while (capacity < m_size + length)
+	{
+		capacity *= 2;
+	}
+
+	BYTE *buffer = GPOS_NEW_ARRAY(m_mp, BYTE, capacity);
+	clib::Memcpy(buffer, m_buffer, m_size);
+	GPOS_DELETE_ARRAY(m_buffer);
+	m_buffer = buffer;
+	m_capacity = capacity;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryWriter::AppendVarint
+//
+//	@doc:
+//		Append an integer using 7 bits per byte; the high bit of each byte
+//		denotes whether more bytes follow
+//
+//---------------------------------------------------------------------------
+void
+CDXLBinaryWriter::AppendVarint(ULONG value)
+{
+	Reserve(5);
+	while (0x80 <= value)
+	{
+		m_buffer[m_size++] = (BYTE)(value | 0x80);
+		value >>= 7;
+	}
+	m_buffer[m_size++] = (BYTE) value;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryWriter::AppendString
+//
+//	@doc:
+//		Append a string as its number of UTF-16 code units followed by the
+//		code units in little-endian byte order
+//
+//---------------------------------------------------------------------------
+void
+CDXLBinaryWriter::AppendString(const WCHAR *str, ULONG length)
+{
+	ULONG num_units = length;
+	for (ULONG ul = 0; ul < length; ul++)
+	{
+		if (GPDXL_UTF16_SUPPLEMENTARY_MIN <= (ULONG) str[ul])
+		{
+			num_units++;
+		}
+	}
+
+	AppendVarint(num_units);
+	Reserve(2 * num_units);
+
+	for (ULONG ul = 0; ul < length; ul++)
+	{
+		ULONG code_point = (ULONG) str[ul];
+		if (GPDXL_UTF16_SUPPLEMENTARY_MAX < code_point)
+		{
+			// not representable in UTF-16
+			code_point = 0xFFFD;
+		}
+
+		if (GPDXL_UTF16_SUPPLEMENTARY_MIN <= code_point)
+		{
+			code_point -= GPDXL_UTF16_SUPPLEMENTARY_MIN;
+			ULONG high = 0xD800 + (code_point >> 10);
+			ULONG low = 0xDC00 + (code_point & 0x3FF);
+			m_buffer[m_size++] = (BYTE) high;
+			m_buffer[m_size++] = (BYTE)(high >> 8);
+			m_buffer[m_size++] = (BYTE) low;
+			m_buffer[m_size++] = (BYTE)(low >> 8);
+		}
+		else
+		{
+			m_buffer[m_size++] = (BYTE) code_point;
+			m_buffer[m_size++] = (BYTE)(code_point >> 8);
+		}
+	}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryWriter::LookupName
+//
+//	@doc:
+//		Return the number of the given name, or zero if it has not been
+//		interned yet
+//
+//---------------------------------------------------------------------------
+ULONG
+CDXLBinaryWriter::LookupName(const WCHAR *name) const
+{
+	const CWStringConst name_str(name);
+	const ULONG *id = m_names->Find(&name_str);
+	if (nullptr == id)
+	{
+		return 0;
+	}
+
+	return *id;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryWriter::AppendName
+//
+//	@doc:
+//		Append a reference to the given name. Names are numbered from one in
+//		the order they are first used; a new name is written out in full,
+//		preceded by a zero.
+//
+//---------------------------------------------------------------------------
+ULONG
+CDXLBinaryWriter::AppendName(const WCHAR *name)
+{
+	ULONG id = LookupName(name);
+	if (0 != id)
+	{
+		AppendVarint(id);
+		return id;
+	}
+
+	CWStringConst *name_str = GPOS_NEW(m_mp) CWStringConst(m_mp, name);
+	id = m_names->Size() + 1;
+	(void) m_names->Insert(name_str, GPOS_NEW(m_mp) ULONG(id));
+
+	AppendVarint(0);
+	AppendString(name_str->GetBuffer(), name_str->Length());
+
+	return id;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryWriter::AddNamespace
+//
+//	@doc:
+//		Bind the namespace prefix to the uri until the end of the current
+//		element
+//
+//---------------------------------------------------------------------------
+void
+CDXLBinaryWriter::AddNamespace(ULONG prefix_id, ULONG uri_id)
+{
+	if (m_num_namespaces == m_namespaces_capacity)
+	{
+		SNamespace *namespaces =
+			GPOS_NEW_ARRAY(m_mp, SNamespace, 2 * m_namespaces_capacity);
+		clib::Memcpy(namespaces, m_namespaces,
+					 m_num_namespaces * sizeof(SNamespace));
+		GPOS_DELETE_ARRAY(m_namespaces);
+		m_namespaces = namespaces;
+		m_namespaces_capacity *= 2;
+	}
+
+	SNamespace &binding = m_namespaces[m_num_namespaces++];
+	binding.m_prefix_id = prefix_id;
+	binding.m_uri_id = uri_id;
+	binding.m_level = m_level;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryWriter::StartElement
+//
+//	@doc:
+//		Start an element with the given name, qualified by the given
+//		namespace prefix unless that is NULL
+//
+//---------------------------------------------------------------------------
+void
+CDXLBinaryWriter::StartElement(const CWStringBase *prefix,
+							   const CWStringBase *name)
+{
+	GPOS_ASSERT(nullptr != name);
+
+	if (nullptr == prefix)
+	{
+		StartElement(name->GetBuffer());
+		return;
+	}
+
+	const ULONG prefix_length = prefix->Length();
+	const ULONG length = prefix_length + 1 + name->Length();
+	if (m_qname_capacity <= length)
+	{
+		GPOS_DELETE_ARRAY(m_qname);
+		m_qname_capacity = 2 * (length + 1);
+		m_qname = GPOS_NEW_ARRAY(m_mp, WCHAR, m_qname_capacity);
+	}
+
+	clib::Memcpy(m_qname, prefix->GetBuffer(), prefix_length * sizeof(WCHAR));
+	m_qname[prefix_length] = GPOS_WSZ_LIT(':');
+	clib::Memcpy(m_qname + prefix_length + 1, name->GetBuffer(),
+				 (name->Length() + 1) * sizeof(WCHAR));
+
+	StartElement(m_qname);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryWriter::StartElement
+//
+//	@doc:
+//		Start an element with the given qualified name
+//
+//---------------------------------------------------------------------------
+void
+CDXLBinaryWriter::StartElement(const WCHAR *qname)
+{
+	GPOS_ASSERT(nullptr != qname);
+
+	AppendByte(EdxlbinopStartElement);
+	(void) AppendName(qname);
+	m_level++;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryWriter::AddAttribute
+//
+//	@doc:
+//		Add an attribute to the current element. Attributes named "xmlns"
+//		or "xmlns:prefix" are written out as namespace declarations.
+//
+//---------------------------------------------------------------------------
+void
+CDXLBinaryWriter::AddAttribute(const WCHAR *qname, const WCHAR *value,
+							   ULONG length)
+{
+	GPOS_ASSERT(nullptr != qname);
+	GPOS_ASSERT(nullptr != value);
+	GPOS_ASSERT(0 < m_level);
+
+	const CWStringConst *xmlns =
+		CDXLTokens::GetDXLTokenStr(EdxltokenNamespaceAttr);
+	const ULONG xmlns_length = xmlns->Length();
+	if (0 == clib::Wcsncmp(qname, xmlns->GetBuffer(), xmlns_length) &&
+		(GPOS_WSZ_LIT('\0') == qname[xmlns_length] ||
+		 GPOS_WSZ_LIT(':') == qname[xmlns_length]))
+	{
+		const WCHAR *prefix = qname + xmlns_length;
+		if (GPOS_WSZ_LIT(':') == *prefix)
+		{
+			prefix++;
+		}
+
+		GPOS_ASSERT(GPOS_WSZ_LIT('\0') == value[length]);
+		DeclareNamespace(prefix, value);
+		return;
+	}
+
+	AppendByte(EdxlbinopAttribute);
+	(void) AppendName(qname);
+	AppendString(value, length);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryWriter::DeclareNamespace
+//
+//	@doc:
+//		Bind the namespace prefix to the uri for the current element and its
+//		descendants; the empty prefix denotes the default namespace
+//
+//---------------------------------------------------------------------------
+void
+CDXLBinaryWriter::DeclareNamespace(const WCHAR *prefix, const WCHAR *uri)
+{
+	GPOS_ASSERT(nullptr != prefix);
+	GPOS_ASSERT(nullptr != uri);
+	GPOS_ASSERT(0 < m_level);
+
+	AppendByte(EdxlbinopNamespace);
+	ULONG prefix_id = AppendName(prefix);
+	ULONG uri_id = AppendName(uri);
+	AddNamespace(prefix_id, uri_id);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryWriter::IsNamespaceDeclared
+//
+//	@doc:
+//		Is the namespace prefix bound to the uri in the current scope
+//
+//---------------------------------------------------------------------------
+BOOL
+CDXLBinaryWriter::IsNamespaceDeclared(const WCHAR *prefix,
+									  const WCHAR *uri) const
+{
+	const ULONG prefix_id = LookupName(prefix);
+	if (0 == prefix_id)
+	{
+		return false;
+	}
+
+	// innermost binding of the prefix wins
+	for (ULONG ul = m_num_namespaces; ul > 0; ul--)
+	{
+		const SNamespace &binding = m_namespaces[ul - 1];
+		if (binding.m_prefix_id == prefix_id)
+		{
+			return binding.m_uri_id == LookupName(uri);
+		}
+	}
+
+	return false;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryWriter::EndElement
+//
+//	@doc:
+//		End the current element, dropping the namespaces it declared
+//
+//---------------------------------------------------------------------------
+void
+CDXLBinaryWriter::EndElement()
+{
+	GPOS_ASSERT(0 < m_level);
+
+	while (0 < m_num_namespaces &&
+		   m_level == m_namespaces[m_num_namespaces - 1].m_level)
+	{
+		m_num_namespaces--;
+	}
+
+	AppendByte(EdxlbinopEndElement);
+	m_level--;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLBinaryWriter::EndDocument
+//
+//	@doc:
+//		Terminate the document and fill in its header
+//
+//---------------------------------------------------------------------------
+void
+CDXLBinaryWriter::EndDocument()
+{
+	GPOS_ASSERT(0 == m_level);
+
+	AppendByte(EdxlbinopEndDocument);
+	m_finished = true;
+
+	const ULONG body_length = m_size - GPDXL_BINARY_HEADER_LENGTH;
+	clib::Memcpy(m_buffer, GPDXL_BINARY_MAGIC, GPDXL_BINARY_MAGIC_LENGTH);
+	m_buffer[4] = (BYTE) GPDXL_BINARY_VERSION;
+	m_buffer[5] = (BYTE)(GPDXL_BINARY_VERSION >> 8);
+	m_buffer[6] = 0;
+	m_buffer[7] = 0;
+	m_buffer[8] = (BYTE) body_length;
+	m_buffer[9] = (BYTE)(body_length >> 8);
+	m_buffer[10] = (BYTE)(body_length >> 16);
+	m_buffer[11] = (BYTE)(body_length >> 24);
+}
+
+// EOF
@@ -20,6 +20,10 @@ using namespace gpdxl;
 
 #define GPDXL_SERIALIZE_CFA_FREQUENCY 30
 
+// number of characters of formatted attribute values after which the buffer
+// holding them is emptied
+#define GPDXL_SERIALIZE_BINARY_VALUES_LIMIT 4096
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CXMLSerializer::~CXMLSerializer
@@ -31,6 +35,8 @@ using namespace gpdxl;
 CXMLSerializer::~CXMLSerializer()
 {
 	GPOS_DELETE(m_strstackElems);
+	GPOS_DELETE(m_binary_values_os);
+	GPOS_DELETE(m_binary_values);
 }
 
 //---------------------------------------------------------------------------
@@ -45,6 +51,13 @@ void
 CXMLSerializer::StartDocument()
 {
 	GPOS_ASSERT(m_strstackElems->IsEmpty());
+
+	if (nullptr != m_binary_writer)
+	{
+		// binary documents have no XML declaration
+		return;
+	}
+
 	m_os << CDXLTokens::GetDXLTokenStr(EdxltokenXMLDocHeader)->GetBuffer();
 	if (m_indentation)
 	{
@@ -77,6 +90,14 @@ CXMLSerializer::OpenElement(const CWStringBase *pstrNamespace,
 	// put element on the stack
 	m_strstackElems->Push(elem_str);
 
+	if (nullptr != m_binary_writer)
+	{
+		m_binary_writer->StartElement(pstrNamespace, elem_str);
+		m_fOpenTag = true;
+		m_ulLevel++;
+		return;
+	}
+
 	// write the closing bracket for the previous element if necessary and add indentation
 	if (m_fOpenTag)
 	{
@@ -131,6 +152,14 @@ CXMLSerializer::CloseElement(const CWStringBase *pstrNamespace,
 
 	GPOS_ASSERT(strOpenElem->Equals(elem_str));
 
+	if (nullptr != m_binary_writer)
+	{
+		m_binary_writer->EndElement();
+		m_fOpenTag = false;
+		GPOS_CHECK_ABORT;
+		return;
+	}
+
 	if (m_fOpenTag)
 	{
 		// singleton element with no children - close the element with "/>"
@@ -185,6 +214,14 @@ CXMLSerializer::AddAttribute(const CWStringBase *pstrAttr,
 	GPOS_ASSERT(nullptr != str_value);
 
 	GPOS_ASSERT(m_fOpenTag);
+	if (nullptr != m_binary_writer)
+	{
+		m_binary_writer->AddAttribute(pstrAttr->GetBuffer(),
+									  str_value->GetBuffer(),
+									  str_value->Length());
+		return;
+	}
+
 	m_os << CDXLTokens::GetDXLTokenStr(EdxltokenSpace)->GetBuffer()
 		 << pstrAttr->GetBuffer()
 		 << CDXLTokens::GetDXLTokenStr(EdxltokenEq)->GetBuffer()	  // =
@@ -208,6 +245,12 @@ CXMLSerializer::AddAttribute(const CWStringBase *pstrAttr, const CHAR *szValue)
 	GPOS_ASSERT(nullptr != szValue);
 
 	GPOS_ASSERT(m_fOpenTag);
+	if (nullptr != m_binary_writer)
+	{
+		AddBinaryAttribute(pstrAttr, szValue);
+		return;
+	}
+
 	m_os << CDXLTokens::GetDXLTokenStr(EdxltokenSpace)->GetBuffer()
 		 << pstrAttr->GetBuffer()
 		 << CDXLTokens::GetDXLTokenStr(EdxltokenEq)->GetBuffer()	 // =
@@ -231,6 +274,12 @@ CXMLSerializer::AddAttribute(const CWStringBase *pstrAttr, ULONG ulValue)
 	GPOS_ASSERT(nullptr != pstrAttr);
 
 	GPOS_ASSERT(m_fOpenTag);
+	if (nullptr != m_binary_writer)
+	{
+		AddBinaryAttribute(pstrAttr, ulValue);
+		return;
+	}
+
 	m_os << CDXLTokens::GetDXLTokenStr(EdxltokenSpace)->GetBuffer()
 		 << pstrAttr->GetBuffer()
 		 << CDXLTokens::GetDXLTokenStr(EdxltokenEq)->GetBuffer()	 // =
@@ -254,6 +303,12 @@ CXMLSerializer::AddAttribute(const CWStringBase *pstrAttr, ULLONG ullValue)
 	GPOS_ASSERT(nullptr != pstrAttr);
 
 	GPOS_ASSERT(m_fOpenTag);
+	if (nullptr != m_binary_writer)
+	{
+		AddBinaryAttribute(pstrAttr, ullValue);
+		return;
+	}
+
 	m_os << CDXLTokens::GetDXLTokenStr(EdxltokenSpace)->GetBuffer()
 		 << pstrAttr->GetBuffer()
 		 << CDXLTokens::GetDXLTokenStr(EdxltokenEq)->GetBuffer()	 // =
@@ -277,6 +332,12 @@ CXMLSerializer::AddAttribute(const CWStringBase *pstrAttr, INT iValue)
 	GPOS_ASSERT(nullptr != pstrAttr);
 
 	GPOS_ASSERT(m_fOpenTag);
+	if (nullptr != m_binary_writer)
+	{
+		AddBinaryAttribute(pstrAttr, iValue);
+		return;
+	}
+
 	m_os << CDXLTokens::GetDXLTokenStr(EdxltokenSpace)->GetBuffer()
 		 << pstrAttr->GetBuffer()
 		 << CDXLTokens::GetDXLTokenStr(EdxltokenEq)->GetBuffer()	 // =
@@ -300,6 +361,12 @@ CXMLSerializer::AddAttribute(const CWStringBase *pstrAttr, LINT value)
 	GPOS_ASSERT(nullptr != pstrAttr);
 
 	GPOS_ASSERT(m_fOpenTag);
+	if (nullptr != m_binary_writer)
+	{
+		AddBinaryAttribute(pstrAttr, value);
+		return;
+	}
+
 	m_os << CDXLTokens::GetDXLTokenStr(EdxltokenSpace)->GetBuffer()
 		 << pstrAttr->GetBuffer()
 		 << CDXLTokens::GetDXLTokenStr(EdxltokenEq)->GetBuffer()	 // =
@@ -323,6 +390,12 @@ CXMLSerializer::AddAttribute(const CWStringBase *pstrAttr, CDouble value)
 	GPOS_ASSERT(nullptr != pstrAttr);
 
 	GPOS_ASSERT(m_fOpenTag);
+	if (nullptr != m_binary_writer)
+	{
+		AddBinaryAttribute(pstrAttr, value);
+		return;
+	}
+
 	m_os << CDXLTokens::GetDXLTokenStr(EdxltokenSpace)->GetBuffer()
 		 << pstrAttr->GetBuffer()
 		 << CDXLTokens::GetDXLTokenStr(EdxltokenEq)->GetBuffer()	 // =
@@ -357,6 +430,35 @@ CXMLSerializer::AddAttribute(const CWStringBase *pstrAttr, BOOL fValue)
 	AddAttribute(pstrAttr, str_value);
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CXMLSerializer::AddBinaryAttribute
+//
+//	@doc:
+//		Format the value the same way as in text documents, and add it as an
+//		attribute of a binary document. Values are appended to a buffer that
+//		is only emptied once it grows large, to avoid an allocation for
+//		every attribute.
+//
+//---------------------------------------------------------------------------
+template <class T>
+void
+CXMLSerializer::AddBinaryAttribute(const CWStringBase *pstrAttr, T value)
+{
+	GPOS_ASSERT(nullptr != m_binary_writer);
+
+	if (GPDXL_SERIALIZE_BINARY_VALUES_LIMIT < m_binary_values->Length())
+	{
+		m_binary_values->Reset();
+	}
+
+	const ULONG start = m_binary_values->Length();
+	m_os << value;
+	m_binary_writer->AddAttribute(pstrAttr->GetBuffer(),
+								  m_binary_values->GetBuffer() + start,
+								  m_binary_values->Length() - start);
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CXMLSerializer::Indent
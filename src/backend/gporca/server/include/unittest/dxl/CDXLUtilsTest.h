@@ -15,9 +15,12 @@
 
 #include "gpos/base.h"
 
+#include "naucrates/md/IMDCacheObject.h"
+
 namespace gpdxl
 {
 using namespace gpos;
+using namespace gpmd;
 
 //---------------------------------------------------------------------------
 //	@class:
@@ -30,12 +33,21 @@ using namespace gpos;
 
 class CDXLUtilsTest
 {
+private:
+	// do the two arrays hold the same metadata objects
+	static BOOL FEqualMDObjArrays(CMemoryPool *mp,
+								  const IMDCacheObjectArray *pdrgpmdobjFst,
+								  const IMDCacheObjectArray *pdrgpmdobjSnd);
+
 public:
 	// unittests
 	static GPOS_RESULT EresUnittest();
 	static GPOS_RESULT EresUnittest_SerializeQuery();
 	static GPOS_RESULT EresUnittest_SerializePlan();
 	static GPOS_RESULT EresUnittest_Encoding();
+	static GPOS_RESULT EresUnittest_BinaryMetadata();
+	static GPOS_RESULT EresUnittest_BinaryMinidump();
+	static GPOS_RESULT EresUnittest_BinaryMalformed();
 
 };	// class CDXLUtilsTest
 }  // namespace gpdxl
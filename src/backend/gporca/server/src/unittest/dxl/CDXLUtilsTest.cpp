@@ -15,7 +15,10 @@
 
 #include "gpos/base.h"
 #include "gpos/common/CAutoP.h"
+#include "gpos/common/CAutoRef.h"
+#include "gpos/common/CAutoRg.h"
 #include "gpos/common/CRandom.h"
+#include "gpos/common/CWallClock.h"
 #include "gpos/error/CAutoTrace.h"
 #include "gpos/io/COstreamString.h"
 #include "gpos/memory/CAutoMemoryPool.h"
@@ -23,8 +26,11 @@
 
 #include "naucrates/base/CQueryToDXLResult.h"
 #include "naucrates/dxl/CDXLUtils.h"
+#include "naucrates/dxl/parser/CParseHandlerDXL.h"
+#include "naucrates/dxl/xml/CDXLBinaryReader.h"
 #include "naucrates/dxl/xml/CDXLMemoryManager.h"
 #include "naucrates/dxl/xml/CXMLSerializer.h"
+#include "naucrates/exception.h"
 
 XERCES_CPP_NAMESPACE_USE
 
@@ -34,6 +40,14 @@ using namespace gpdxl;
 static const char *szQueryFile =
 	"../data/dxl/expressiontests/TableScanQuery.xml";
 static const char *szPlanFile = "../data/dxl/expressiontests/TableScanPlan.xml";
+static const char *szMDFile = "../data/dxl/metadata/md.xml";
+
+// minidumps used for comparing the load time of text and binary DXL
+static const char *rgszMinidumpFiles[] = {
+	"../data/dxl/minidump/CTE-1.mdp",
+	"../data/dxl/minidump/TPCH-Q5.mdp",
+	"../data/dxl/minidump/Tpcds-10TB-Q37-NoIndexJoin.mdp",
+};
 
 //---------------------------------------------------------------------------
 //	@function:
@@ -50,6 +64,11 @@ CDXLUtilsTest::EresUnittest()
 		GPOS_UNITTEST_FUNC(CDXLUtilsTest::EresUnittest_SerializeQuery),
 		GPOS_UNITTEST_FUNC(CDXLUtilsTest::EresUnittest_SerializePlan),
 		GPOS_UNITTEST_FUNC(CDXLUtilsTest::EresUnittest_Encoding),
+		GPOS_UNITTEST_FUNC(CDXLUtilsTest::EresUnittest_BinaryMetadata),
+		GPOS_UNITTEST_FUNC(CDXLUtilsTest::EresUnittest_BinaryMinidump),
+		GPOS_UNITTEST_FUNC_THROW(CDXLUtilsTest::EresUnittest_BinaryMalformed,
+								 gpdxl::ExmaDXL,
+								 gpdxl::ExmiDXLBinaryParseError),
 	};
 
 	return CUnittest::EresExecute(rgut, GPOS_ARRAY_SIZE(rgut));
@@ -231,4 +250,214 @@ CDXLUtilsTest::EresUnittest_Encoding()
 	return GPOS_OK;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLUtilsTest::FEqualMDObjArrays
+//
+//	@doc:
+//		Do the two arrays hold the same metadata objects
+//
+//---------------------------------------------------------------------------
+BOOL
+CDXLUtilsTest::FEqualMDObjArrays(CMemoryPool *mp,
+								 const IMDCacheObjectArray *pdrgpmdobjFst,
+								 const IMDCacheObjectArray *pdrgpmdobjSnd)
+{
+	if (pdrgpmdobjFst->Size() != pdrgpmdobjSnd->Size())
+	{
+		return false;
+	}
+
+	for (ULONG ul = 0; ul < pdrgpmdobjFst->Size(); ul++)
+	{
+		CAutoP<CWStringDynamic> a_pstrFst(CDXLUtils::SerializeMDObj(
+			mp, (*pdrgpmdobjFst)[ul], false /*serialize_document_header_footer*/,
+			false /*indentation*/));
+		CAutoP<CWStringDynamic> a_pstrSnd(CDXLUtils::SerializeMDObj(
+			mp, (*pdrgpmdobjSnd)[ul], false /*serialize_document_header_footer*/,
+			false /*indentation*/));
+
+		if (!a_pstrFst->Equals(a_pstrSnd.Value()))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLUtilsTest::EresUnittest_BinaryMetadata
+//
+//	@doc:
+//		Test that metadata read from binary DXL matches the text DXL it was
+//		converted from, and that metadata objects serialized to binary DXL
+//		are read back unchanged
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+CDXLUtilsTest::EresUnittest_BinaryMetadata()
+{
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	CAutoRg<CHAR> a_szDXL(CDXLUtils::Read(mp, szMDFile));
+
+	ULONG ulBinaryLength = 0;
+	CAutoRg<BYTE> a_pbBinary(
+		CDXLUtils::ConvertDXLToBinary(mp, a_szDXL.Rgt(), &ulBinaryLength));
+
+	GPOS_RTL_ASSERT(CDXLBinaryReader::IsBinaryDXL(a_pbBinary.Rgt()));
+	GPOS_RTL_ASSERT(ulBinaryLength ==
+					CDXLBinaryReader::DocumentLength(a_pbBinary.Rgt()));
+
+	CAutoRef<IMDCacheObjectArray> a_pdrgpmdobjText(
+		CDXLUtils::ParseDXLToIMDObjectArray(mp, a_szDXL.Rgt(),
+											nullptr /*xsd_file_path*/));
+	CAutoRef<IMDCacheObjectArray> a_pdrgpmdobjBinary(
+		CDXLUtils::ParseDXLToIMDObjectArray(mp, (CHAR *) a_pbBinary.Rgt(),
+											nullptr /*xsd_file_path*/));
+
+	if (!FEqualMDObjArrays(mp, a_pdrgpmdobjText.Value(),
+						   a_pdrgpmdobjBinary.Value()))
+	{
+		return GPOS_FAILED;
+	}
+
+	// round-trip each object through its binary serialization
+	for (ULONG ul = 0; ul < a_pdrgpmdobjText->Size(); ul++)
+	{
+		IMDCacheObject *pmdobj = (*a_pdrgpmdobjText)[ul];
+
+		ULONG ulLength = 0;
+		CAutoRg<BYTE> a_pbObj(
+			CDXLUtils::SerializeMDObjToBinary(mp, pmdobj, &ulLength));
+		IMDCacheObject *pmdobjRead = CDXLUtils::ParseDXLToIMDIdCacheObj(
+			mp, (CHAR *) a_pbObj.Rgt(), nullptr /*xsd_file_path*/);
+
+		CAutoP<CWStringDynamic> a_pstrExpected(CDXLUtils::SerializeMDObj(
+			mp, pmdobj, false /*serialize_document_header_footer*/,
+			false /*indentation*/));
+		CAutoP<CWStringDynamic> a_pstrActual(CDXLUtils::SerializeMDObj(
+			mp, pmdobjRead, false /*serialize_document_header_footer*/,
+			false /*indentation*/));
+		pmdobjRead->Release();
+
+		if (!a_pstrExpected->Equals(a_pstrActual.Value()))
+		{
+			CAutoTrace at(mp);
+			at.Os() << "Expected: " << a_pstrExpected->GetBuffer()
+					<< std::endl;
+			at.Os() << "Actual: " << a_pstrActual->GetBuffer() << std::endl;
+
+			return GPOS_FAILED;
+		}
+	}
+
+	return GPOS_OK;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLUtilsTest::EresUnittest_BinaryMinidump
+//
+//	@doc:
+//		Compare loading minidumps in text and binary DXL, both for the
+//		loaded contents and the time it takes
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+CDXLUtilsTest::EresUnittest_BinaryMinidump()
+{
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	for (ULONG ul = 0; ul < GPOS_ARRAY_SIZE(rgszMinidumpFiles); ul++)
+	{
+		CAutoRg<CHAR> a_szDXL(CDXLUtils::Read(mp, rgszMinidumpFiles[ul]));
+
+		ULONG ulBinaryLength = 0;
+		CAutoRg<BYTE> a_pbBinary(
+			CDXLUtils::ConvertDXLToBinary(mp, a_szDXL.Rgt(), &ulBinaryLength));
+
+		CWallClock clock;
+		CAutoP<CParseHandlerDXL> a_pphText(
+			CDXLUtils::GetParseHandlerForDXLString(mp, a_szDXL.Rgt(),
+												   nullptr /*xsd_file_path*/));
+		const ULONG ulTextUS = clock.ElapsedUS();
+
+		clock.Restart();
+		CAutoP<CParseHandlerDXL> a_pphBinary(
+			CDXLUtils::GetParseHandlerForDXLString(
+				mp, (CHAR *) a_pbBinary.Rgt(), nullptr /*xsd_file_path*/));
+		const ULONG ulBinaryUS = clock.ElapsedUS();
+
+		if (!FEqualMDObjArrays(mp, a_pphText->GetMdIdCachedObjArray(),
+							   a_pphBinary->GetMdIdCachedObjArray()))
+		{
+			return GPOS_FAILED;
+		}
+
+		CWStringDynamic strText(mp);
+		COstreamString ossText(&strText);
+		CDXLUtils::SerializeQuery(
+			mp, ossText, a_pphText->GetQueryDXLRoot(),
+			a_pphText->GetOutputColumnsDXLArray(),
+			a_pphText->GetCTEProducerDXLArray(),
+			false /*serialize_document_header_footer*/, false /*indentation*/);
+
+		CWStringDynamic strBinary(mp);
+		COstreamString ossBinary(&strBinary);
+		CDXLUtils::SerializeQuery(
+			mp, ossBinary, a_pphBinary->GetQueryDXLRoot(),
+			a_pphBinary->GetOutputColumnsDXLArray(),
+			a_pphBinary->GetCTEProducerDXLArray(),
+			false /*serialize_document_header_footer*/, false /*indentation*/);
+
+		if (!strText.Equals(&strBinary))
+		{
+			return GPOS_FAILED;
+		}
+
+		CAutoTrace at(mp);
+		at.Os() << rgszMinidumpFiles[ul] << ": text "
+				<< clib::Strlen(a_szDXL.Rgt()) << " bytes, " << ulTextUS
+				<< " us; binary " << ulBinaryLength << " bytes, " << ulBinaryUS
+				<< " us" << std::endl;
+	}
+
+	return GPOS_OK;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLUtilsTest::EresUnittest_BinaryMalformed
+//
+//	@doc:
+//		Test that a binary DXL document of an unknown version is rejected
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+CDXLUtilsTest::EresUnittest_BinaryMalformed()
+{
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	CAutoRg<CHAR> a_szDXL(CDXLUtils::Read(mp, szMDFile));
+
+	ULONG ulBinaryLength = 0;
+	CAutoRg<BYTE> a_pbBinary(
+		CDXLUtils::ConvertDXLToBinary(mp, a_szDXL.Rgt(), &ulBinaryLength));
+
+	// the version follows the magic bytes
+	a_pbBinary[GPDXL_BINARY_MAGIC_LENGTH] = GPDXL_BINARY_VERSION + 1;
+
+	CAutoRef<IMDCacheObjectArray> a_pdrgpmdobj(
+		CDXLUtils::ParseDXLToIMDObjectArray(mp, (CHAR *) a_pbBinary.Rgt(),
+											nullptr /*xsd_file_path*/));
+
+	return GPOS_FAILED;
+}
+
 // EOF
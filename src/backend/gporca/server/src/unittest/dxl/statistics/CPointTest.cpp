@@ -20,9 +20,12 @@
 #include "gpos/io/COstreamString.h"
 #include "gpos/string/CWStringDynamic.h"
 
+#include "naucrates/md/CMDIdGPDB.h"
 #include "naucrates/statistics/CPoint.h"
+#include "naucrates/statistics/CStatistics.h"
 
 #include "unittest/base.h"
+#include "unittest/dxl/statistics/CCardinalityTestUtils.h"
 #include "unittest/gpopt/CTestUtils.h"
 
 using namespace gpopt;
@@ -35,6 +38,7 @@ CPointTest::EresUnittest()
 	CUnittest rgutSharedOptCtxt[] = {
 		GPOS_UNITTEST_FUNC(CPointTest::EresUnittest_CPointInt4),
 		GPOS_UNITTEST_FUNC(CPointTest::EresUnittest_CPointBool),
+		GPOS_UNITTEST_FUNC(CPointTest::EresUnittest_CPointMapping),
 	};
 
 	CAutoMemoryPool amp;
@@ -108,4 +112,62 @@ CPointTest::EresUnittest_CPointBool()
 	return GPOS_OK;
 }
 
+// comparisons of points must match the comparisons of their datums
+GPOS_RESULT
+CPointTest::EresUnittest_CPointMapping()
+{
+	// create memory pool
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	CPointArray *pdrgppoint = GPOS_NEW(mp) CPointArray(mp);
+	pdrgppoint->Append(CTestUtils::PpointInt4(mp, -3));
+	pdrgppoint->Append(CTestUtils::PpointInt4(mp, 0));
+	pdrgppoint->Append(CTestUtils::PpointInt4(mp, 7));
+	pdrgppoint->Append(CTestUtils::PpointInt4NullVal(mp));
+	pdrgppoint->Append(CTestUtils::PpointInt8(mp, 7));
+	pdrgppoint->Append(
+		CCardinalityTestUtils::PpointDouble(mp, GPDB_FLOAT8, CDouble(-1.5)));
+	pdrgppoint->Append(
+		CCardinalityTestUtils::PpointDouble(mp, GPDB_FLOAT8, CDouble(7.0)));
+	pdrgppoint->Append(CCardinalityTestUtils::PpointDouble(
+		mp, GPDB_FLOAT8, CDouble(7.0) + CStatistics::Epsilon / 2));
+
+	const ULONG size = pdrgppoint->Size();
+	for (ULONG ul1 = 0; ul1 < size; ul1++)
+	{
+		for (ULONG ul2 = 0; ul2 < size; ul2++)
+		{
+			CPoint *point1 = (*pdrgppoint)[ul1];
+			CPoint *point2 = (*pdrgppoint)[ul2];
+			IDatum *datum1 = point1->GetDatum();
+			IDatum *datum2 = point2->GetDatum();
+
+			if (!datum1->StatsAreComparable(datum2))
+			{
+				GPOS_RTL_ASSERT(!point1->IsLessThan(point2));
+				GPOS_RTL_ASSERT(!point1->IsGreaterThan(point2));
+				continue;
+			}
+
+			GPOS_RTL_ASSERT(datum1->StatsAreEqual(datum2) ==
+							point1->Equals(point2));
+			GPOS_RTL_ASSERT(datum1->StatsAreLessThan(datum2) ==
+							point1->IsLessThan(point2));
+			GPOS_RTL_ASSERT(datum1->StatsAreGreaterThan(datum2) ==
+							point1->IsGreaterThan(point2));
+
+			if (point1->IsGreaterThanOrEqual(point2))
+			{
+				GPOS_RTL_ASSERT(datum1->GetStatsDistanceFrom(datum2) ==
+								point1->Distance(point2));
+			}
+		}
+	}
+
+	pdrgppoint->Release();
+
+	return GPOS_OK;
+}
+
 // EOF
@@ -0,0 +1,525 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2022 VMware, Inc. or its affiliates.
+//
+//	@filename:
+//		bench.cpp
+//
+//	@doc:
+//		Benchmark of the optimizer over minidumps, such as the ones in
+//		data/dxl/minidump.
+//
+//		Usage: gporca_bench [-n runs] [-j] [-b baseline] [-r percent] file...
+//
+//		Each minidump is optimized the given number of times. For each one
+//		the mean and minimum optimization time, the peak size of the memory
+//		pool used by the optimization, the number of memo groups and group
+//		expressions and the number of optimization jobs executed are printed
+//		as CSV, or as JSON with -j.
+//
+//		With -b, the results are compared to a baseline saved from an
+//		earlier CSV run, and minidumps whose mean optimization time or peak
+//		memory grew by more than the given percentage, 10 by default, are
+//		reported as regressions; the exit code is then non-zero.
+//---------------------------------------------------------------------------
+
+#include "gpos/_api.h"
+#include "gpos/common/CAutoP.h"
+#include "gpos/common/CAutoRef.h"
+#include "gpos/common/CAutoRg.h"
+#include "gpos/common/CMainArgs.h"
+#include "gpos/common/CWallClock.h"
+#include "gpos/memory/CAutoMemoryPool.h"
+#include "gpos/types.h"
+
+#include "gpopt/cost/ICostModel.h"
+#include "gpopt/init.h"
+#include "gpopt/mdcache/CMDCache.h"
+#include "gpopt/minidump/CDXLMinidump.h"
+#include "gpopt/minidump/CMinidumperUtils.h"
+#include "gpopt/optimizer/COptimizerConfig.h"
+#include "naucrates/dxl/CDXLUtils.h"
+#include "naucrates/init.h"
+
+// minimum number of segments to optimize for, as in the minidump tests
+#define GPOPT_BENCH_SEGMENTS 2
+
+// default percentage by which a measure may exceed its baseline
+#define GPOPT_BENCH_TOLERANCE 10
+
+using namespace gpos;
+using namespace gpdxl;
+using namespace gpopt;
+
+// command line arguments
+struct SBenchArgs
+{
+	INT m_argc;
+	const CHAR **m_argv;
+};
+
+// measures of a minidump
+struct SBenchResult
+{
+	// mean and minimum optimization time
+	ULLONG m_mean_us;
+	ULLONG m_min_us;
+
+	// peak size of the memory pool of an optimization
+	ULLONG m_peak_bytes;
+
+	// search space explored by an optimization
+	ULLONG m_groups;
+	ULLONG m_group_exprs;
+	ULLONG m_jobs;
+};
+
+// measures of a minidump in the baseline
+struct SBaselineEntry
+{
+	const CHAR *m_file;
+	ULLONG m_mean_us;
+	ULLONG m_peak_bytes;
+};
+
+// exit code of the tool; PvExec overwrites it on success
+static INT exit_code = 1;
+
+//---------------------------------------------------------------------------
+//	@function:
+//		UlSegments
+//
+//	@doc:
+//		Number of segments to optimize for
+//
+//---------------------------------------------------------------------------
+static ULONG
+UlSegments(COptimizerConfig *optimizer_config)
+{
+	ULONG ulSegments = GPOPT_BENCH_SEGMENTS;
+	ULONG ulHosts = optimizer_config->GetCostModel()->UlHosts();
+	if (ulSegments < ulHosts)
+	{
+		ulSegments = ulHosts;
+	}
+
+	return ulSegments;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		FBenchMinidump
+//
+//	@doc:
+//		Optimize the minidump in the given file the given number of times;
+//		return false if it cannot be optimized
+//
+//---------------------------------------------------------------------------
+static BOOL
+FBenchMinidump(CMemoryPool *mp, const CHAR *file_name, ULONG ulRuns,
+			   SBenchResult *pres)
+{
+	BOOL fSuccess = true;
+
+	GPOS_TRY
+	{
+		CAutoP<CDXLMinidump> a_pdxlmd(
+			CMinidumperUtils::PdxlmdLoad(mp, file_name));
+
+		COptimizerConfig *optimizer_config = a_pdxlmd->GetOptimizerConfig();
+		if (nullptr == optimizer_config)
+		{
+			optimizer_config = COptimizerConfig::PoconfDefault(mp);
+		}
+		else
+		{
+			optimizer_config->AddRef();
+		}
+		CAutoRef<COptimizerConfig> a_poconf(optimizer_config);
+
+		const ULONG ulSegments = UlSegments(optimizer_config);
+
+		ULLONG ullTotalUS = 0;
+		pres->m_min_us = gpos::ullong_max;
+		pres->m_peak_bytes = 0;
+		for (ULONG ul = 0; ul < ulRuns; ul++)
+		{
+			GPOS_CHECK_ABORT;
+
+			// optimize in a pool of its own to measure its peak size
+			CAutoMemoryPool amp;
+			CMemoryPool *pmpRun = amp.Pmp();
+
+			CWallClock clock;
+			CDXLNode *pdxlnPlan = CMinidumperUtils::PdxlnExecuteMinidump(
+				pmpRun, a_pdxlmd.Value(), file_name, ulSegments,
+				1 /*ulSessionId*/, 1 /*ulCmdId*/, optimizer_config,
+				nullptr /*pceeval*/);
+			const ULLONG ullElapsedUS = clock.ElapsedUS();
+			pdxlnPlan->Release();
+
+			ullTotalUS += ullElapsedUS;
+			if (ullElapsedUS < pres->m_min_us)
+			{
+				pres->m_min_us = ullElapsedUS;
+			}
+			if (pres->m_peak_bytes < pmpRun->PeakAllocatedSize())
+			{
+				pres->m_peak_bytes = pmpRun->PeakAllocatedSize();
+			}
+		}
+		pres->m_mean_us = ullTotalUS / ulRuns;
+
+		COptimizationStats *pos = optimizer_config->GetOptimizationStats();
+		pres->m_groups = pos->UlpGroups();
+		pres->m_group_exprs = pos->UlGroupExprs();
+		pres->m_jobs = pos->UlpJobs();
+	}
+	GPOS_CATCH_EX(ex)
+	{
+		oswcerr << "skipping " << file_name << ": exception " << ex.Major()
+				<< "." << ex.Minor() << std::endl;
+		fSuccess = false;
+		GPOS_RESET_EX;
+	}
+	GPOS_CATCH_END;
+
+	return fSuccess;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		UlParseBaseline
+//
+//	@doc:
+//		Parse a baseline saved from a CSV run in place; return the number of
+//		entries found
+//
+//---------------------------------------------------------------------------
+static ULONG
+UlParseBaseline(CMemoryPool *mp, CHAR *szBaseline,
+				SBaselineEntry **ppbaseline)
+{
+	// one entry per line at most
+	ULONG ulLines = 1;
+	for (CHAR *sz = szBaseline; '\0' != *sz; sz++)
+	{
+		if ('\n' == *sz)
+		{
+			ulLines++;
+		}
+	}
+	SBaselineEntry *pbaseline = GPOS_NEW_ARRAY(mp, SBaselineEntry, ulLines);
+
+	ULONG ulEntries = 0;
+	CHAR *szLine = szBaseline;
+	while ('\0' != *szLine)
+	{
+		// split line into comma-separated fields
+		const ULONG ulMaxFields = 8;
+		CHAR *rgszFields[ulMaxFields];
+		ULONG ulFields = 0;
+		CHAR *sz = szLine;
+		rgszFields[ulFields++] = sz;
+		for (; '\0' != *sz && '\n' != *sz; sz++)
+		{
+			if (',' == *sz)
+			{
+				*sz = '\0';
+				if (ulFields < ulMaxFields)
+				{
+					rgszFields[ulFields++] = sz + 1;
+				}
+			}
+		}
+		CHAR *szNext = ('\0' == *sz) ? sz : sz + 1;
+		*sz = '\0';
+
+		// skip the header and malformed lines; the fields are file, runs,
+		// mean time and minimum time, peak bytes, ...
+		CHAR *szEnd = nullptr;
+		if (5 <= ulFields)
+		{
+			pbaseline[ulEntries].m_file = rgszFields[0];
+			pbaseline[ulEntries].m_mean_us =
+				(ULLONG) clib::Strtoll(rgszFields[2], &szEnd, 10 /*base*/);
+			if ('\0' == *szEnd && szEnd != rgszFields[2])
+			{
+				pbaseline[ulEntries].m_peak_bytes = (ULLONG) clib::Strtoll(
+					rgszFields[4], nullptr, 10 /*base*/);
+				ulEntries++;
+			}
+		}
+
+		szLine = szNext;
+	}
+
+	*ppbaseline = pbaseline;
+
+	return ulEntries;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		PbaselineFind
+//
+//	@doc:
+//		Baseline entry of the given minidump, if any
+//
+//---------------------------------------------------------------------------
+static const SBaselineEntry *
+PbaselineFind(const SBaselineEntry *pbaseline, ULONG ulEntries,
+			  const CHAR *file_name)
+{
+	for (ULONG ul = 0; ul < ulEntries; ul++)
+	{
+		if (0 == clib::Strcmp(pbaseline[ul].m_file, file_name))
+		{
+			return &pbaseline[ul];
+		}
+	}
+
+	return nullptr;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		FExceeds
+//
+//	@doc:
+//		Does the measure exceed its baseline by more than the given
+//		percentage
+//
+//---------------------------------------------------------------------------
+static BOOL
+FExceeds(ULLONG ullValue, ULLONG ullBaseline, ULONG ulTolerance)
+{
+	return ullValue * 100 > ullBaseline * (100 + ulTolerance);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		PrintResult
+//
+//	@doc:
+//		Print the measures of a minidump, and its baseline if there is one
+//
+//---------------------------------------------------------------------------
+static void
+PrintResult(const CHAR *file_name, ULONG ulRuns, const SBenchResult &res,
+			BOOL fJSON, BOOL fFirst, const SBaselineEntry *pbaseline,
+			BOOL fRegressed)
+{
+	if (fJSON)
+	{
+		oswcout << (fFirst ? "" : ",") << std::endl
+				<< "  {\"file\": \"" << file_name << "\", \"runs\": " << ulRuns
+				<< ", \"mean_us\": " << res.m_mean_us
+				<< ", \"min_us\": " << res.m_min_us
+				<< ", \"peak_bytes\": " << res.m_peak_bytes
+				<< ", \"groups\": " << res.m_groups
+				<< ", \"group_exprs\": " << res.m_group_exprs
+				<< ", \"jobs\": " << res.m_jobs;
+		if (nullptr != pbaseline)
+		{
+			oswcout << ", \"base_mean_us\": " << pbaseline->m_mean_us
+					<< ", \"base_peak_bytes\": " << pbaseline->m_peak_bytes
+					<< ", \"regressed\": " << (fRegressed ? "true" : "false");
+		}
+		oswcout << "}";
+
+		return;
+	}
+
+	oswcout << file_name << "," << ulRuns << "," << res.m_mean_us << ","
+			<< res.m_min_us << "," << res.m_peak_bytes << "," << res.m_groups
+			<< "," << res.m_group_exprs << "," << res.m_jobs;
+	if (nullptr != pbaseline)
+	{
+		oswcout << "," << pbaseline->m_mean_us << ","
+				<< pbaseline->m_peak_bytes << "," << (fRegressed ? 1 : 0);
+	}
+	oswcout << std::endl;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		PvExec
+//
+//	@doc:
+//		Function driving execution
+//
+//---------------------------------------------------------------------------
+static void *
+PvExec(void *pv)
+{
+	SBenchArgs *args = (SBenchArgs *) pv;
+	CMainArgs ma(args->m_argc, args->m_argv, "n:jb:r:");
+
+	ULONG ulRuns = 1;
+	BOOL fJSON = false;
+	const CHAR *szBaselineFile = nullptr;
+	ULONG ulTolerance = GPOPT_BENCH_TOLERANCE;
+
+	CHAR ch = '\0';
+	while (ma.Getopt(&ch))
+	{
+		switch (ch)
+		{
+			case 'n':
+				ulRuns = (ULONG) clib::Strtol(optarg, nullptr, 10 /*base*/);
+				break;
+
+			case 'j':
+				fJSON = true;
+				break;
+
+			case 'b':
+				szBaselineFile = optarg;
+				break;
+
+			case 'r':
+				ulTolerance = (ULONG) clib::Strtol(optarg, nullptr, 10 /*base*/);
+				break;
+
+			default:
+				return nullptr;
+		}
+	}
+
+	if (0 == ulRuns || optind >= args->m_argc)
+	{
+		GPOS_TRACE(GPOS_WSZ_LIT("Usage: gporca_bench [-n runs] [-j] "
+								"[-b baseline] [-r percent] file..."));
+		return nullptr;
+	}
+
+	InitDXL();
+	CMDCache::Init();
+
+	{
+		CAutoMemoryPool amp;
+		CMemoryPool *mp = amp.Pmp();
+
+		CAutoRg<CHAR> a_szBaseline;
+		CAutoRg<SBaselineEntry> a_pbaseline;
+		ULONG ulBaselineEntries = 0;
+		if (nullptr != szBaselineFile)
+		{
+			SBaselineEntry *pbaseline = nullptr;
+			a_szBaseline = CDXLUtils::Read(mp, szBaselineFile);
+			ulBaselineEntries =
+				UlParseBaseline(mp, a_szBaseline.Rgt(), &pbaseline);
+			a_pbaseline = pbaseline;
+		}
+
+		if (fJSON)
+		{
+			oswcout << "[";
+		}
+		else
+		{
+			oswcout << "file,runs,mean_us,min_us,peak_bytes,groups,group_exprs,"
+					   "jobs";
+			if (nullptr != szBaselineFile)
+			{
+				oswcout << ",base_mean_us,base_peak_bytes,regressed";
+			}
+			oswcout << std::endl;
+		}
+
+		ULONG ulOptimized = 0;
+		ULONG ulSkipped = 0;
+		ULONG ulRegressed = 0;
+		for (INT i = optind; i < args->m_argc; i++)
+		{
+			GPOS_CHECK_ABORT;
+
+			const CHAR *file_name = args->m_argv[i];
+
+			SBenchResult res;
+			if (!FBenchMinidump(mp, file_name, ulRuns, &res))
+			{
+				ulSkipped++;
+				continue;
+			}
+
+			const SBaselineEntry *pbaseline = PbaselineFind(
+				a_pbaseline.Rgt(), ulBaselineEntries, file_name);
+			BOOL fRegressed =
+				nullptr != pbaseline &&
+				(FExceeds(res.m_mean_us, pbaseline->m_mean_us, ulTolerance) ||
+				 FExceeds(res.m_peak_bytes, pbaseline->m_peak_bytes,
+						  ulTolerance));
+			if (fRegressed)
+			{
+				ulRegressed++;
+			}
+
+			PrintResult(file_name, ulRuns, res, fJSON, 0 == ulOptimized,
+						pbaseline, fRegressed);
+			ulOptimized++;
+		}
+
+		if (fJSON)
+		{
+			oswcout << std::endl << "]" << std::endl;
+		}
+
+		oswcerr << ulOptimized << " minidumps optimized, " << ulSkipped
+				<< " skipped";
+		if (nullptr != szBaselineFile)
+		{
+			oswcerr << ", " << ulRegressed << " regressed by more than "
+					<< ulTolerance << "%";
+		}
+		oswcerr << std::endl;
+
+		if (0 == ulRegressed)
+		{
+			exit_code = 0;
+		}
+	}
+
+	CMDCache::Shutdown();
+
+	return nullptr;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		main
+//
+//	@doc:
+//		Entry point for the optimizer benchmark
+//
+//---------------------------------------------------------------------------
+INT
+main(INT iArgs, const CHAR **rgszArgs)
+{
+	// Use default allocator
+	struct gpos_init_params gpos_params = {nullptr};
+
+	gpos_init(&gpos_params);
+	gpdxl_init();
+	gpopt_init();
+
+	SBenchArgs args = {iArgs, rgszArgs};
+
+	gpos_exec_params params;
+	params.func = PvExec;
+	params.arg = &args;
+	params.stack_start = &params;
+	params.error_buffer = nullptr;
+	params.error_buffer_size = -1;
+	params.abort_requested = nullptr;
+
+	if (gpos_exec(&params))
+	{
+		return 1;
+	}
+
+	return exit_code;
+}
+
+// EOF
@@ -0,0 +1,268 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2022 VMware, Inc. or its affiliates.
+//
+//	@filename:
+//		dxlconvert.cpp
+//
+//	@doc:
+//		Converts DXL documents, such as the minidumps in data/dxl/minidump,
+//		to the binary DXL encoding and compares the time it takes to load
+//		either form.
+//
+//		Usage: gporca_dxlconvert [-t] [-n runs] [-o dir] file...
+//
+//		Each file is written in binary form to the given directory under
+//		its own name, or next to itself with a ".dxb" suffix if no
+//		directory is given. Files that are binary already are skipped.
+//		With -t, both forms of each file are loaded the given number of
+//		times and the average load times are printed.
+//---------------------------------------------------------------------------
+
+#include "gpos/_api.h"
+#include "gpos/common/CAutoP.h"
+#include "gpos/common/CAutoRg.h"
+#include "gpos/common/CMainArgs.h"
+#include "gpos/common/CWallClock.h"
+#include "gpos/io/CFileWriter.h"
+#include "gpos/memory/CAutoMemoryPool.h"
+#include "gpos/string/CStringStatic.h"
+#include "gpos/types.h"
+
+#include "gpopt/init.h"
+#include "naucrates/dxl/CDXLUtils.h"
+#include "naucrates/dxl/parser/CParseHandlerDXL.h"
+#include "naucrates/dxl/xml/CDXLBinaryReader.h"
+#include "naucrates/init.h"
+
+using namespace gpos;
+using namespace gpdxl;
+
+// command line arguments
+struct SConvertArgs
+{
+	INT m_argc;
+	const CHAR **m_argv;
+};
+
+// exit code of the tool; PvExec overwrites it on success
+static INT exit_code = 1;
+
+//---------------------------------------------------------------------------
+//	@function:
+//		UlLoadUS
+//
+//	@doc:
+//		Average time, in microseconds, to load the given DXL file
+//
+//---------------------------------------------------------------------------
+static ULONG
+UlLoadUS(CMemoryPool *mp, const CHAR *file_name, ULONG ulRuns)
+{
+	ULLONG ullTotalUS = 0;
+	for (ULONG ul = 0; ul < ulRuns; ul++)
+	{
+		CWallClock clock;
+		CAutoP<CParseHandlerDXL> a_pph(CDXLUtils::GetParseHandlerForDXLFile(
+			mp, file_name, nullptr /*xsd_file_path*/));
+		ullTotalUS += clock.ElapsedUS();
+	}
+
+	return (ULONG)(ullTotalUS / ulRuns);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		ConvertFile
+//
+//	@doc:
+//		Write the binary form of the given DXL file to the given path;
+//		return false if the file is binary already
+//
+//---------------------------------------------------------------------------
+static BOOL
+ConvertFile(CMemoryPool *mp, const CHAR *file_name, const CHAR *out_file_name,
+			ULONG *pulTextLength, ULONG *pulBinaryLength)
+{
+	CAutoRg<CHAR> a_szDXL(CDXLUtils::Read(mp, file_name));
+	if (CDXLBinaryReader::IsBinaryDXL((const BYTE *) a_szDXL.Rgt()))
+	{
+		return false;
+	}
+
+	ULONG ulLength = 0;
+	CAutoRg<BYTE> a_pbBinary(
+		CDXLUtils::ConvertDXLToBinary(mp, a_szDXL.Rgt(), &ulLength));
+
+	CFileWriter fw;
+	fw.Open(out_file_name, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+	fw.Write(a_pbBinary.Rgt(), ulLength);
+	fw.Close();
+
+	*pulTextLength = clib::Strlen(a_szDXL.Rgt());
+	*pulBinaryLength = ulLength;
+
+	return true;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		PvExec
+//
+//	@doc:
+//		Function driving execution
+//
+//---------------------------------------------------------------------------
+static void *
+PvExec(void *pv)
+{
+	SConvertArgs *args = (SConvertArgs *) pv;
+	CMainArgs ma(args->m_argc, args->m_argv, "tn:o:");
+
+	BOOL fTime = false;
+	ULONG ulRuns = 1;
+	const CHAR *szOutDir = nullptr;
+
+	CHAR ch = '\0';
+	while (ma.Getopt(&ch))
+	{
+		switch (ch)
+		{
+			case 't':
+				fTime = true;
+				break;
+
+			case 'n':
+				ulRuns = (ULONG) clib::Strtol(optarg, nullptr, 10 /*base*/);
+				break;
+
+			case 'o':
+				szOutDir = optarg;
+				break;
+
+			default:
+				return nullptr;
+		}
+	}
+
+	if (0 == ulRuns || optind >= args->m_argc)
+	{
+		GPOS_TRACE(GPOS_WSZ_LIT(
+			"Usage: gporca_dxlconvert [-t] [-n runs] [-o dir] file..."));
+		return nullptr;
+	}
+
+	InitDXL();
+
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	if (fTime)
+	{
+		oswcout << "file,text_bytes,binary_bytes,text_us,binary_us"
+				<< std::endl;
+	}
+
+	ULLONG ullTextBytes = 0;
+	ULLONG ullBinaryBytes = 0;
+	ULLONG ullTextUS = 0;
+	ULLONG ullBinaryUS = 0;
+
+	for (INT i = optind; i < args->m_argc; i++)
+	{
+		GPOS_CHECK_ABORT;
+
+		const CHAR *file_name = args->m_argv[i];
+
+		CHAR szBuffer[GPOS_FILE_NAME_BUF_SIZE];
+		CStringStatic strOutFile(szBuffer, GPOS_ARRAY_SIZE(szBuffer));
+		if (nullptr != szOutDir)
+		{
+			const CHAR *szBaseName = file_name;
+			for (const CHAR *sz = file_name; '\0' != *sz; sz++)
+			{
+				if ('/' == *sz)
+				{
+					szBaseName = sz + 1;
+				}
+			}
+			strOutFile.AppendFormat("%s/%s", szOutDir, szBaseName);
+		}
+		else
+		{
+			strOutFile.AppendFormat("%s.dxb", file_name);
+		}
+
+		ULONG ulTextLength = 0;
+		ULONG ulBinaryLength = 0;
+		if (!ConvertFile(mp, file_name, strOutFile.Buffer(), &ulTextLength,
+						 &ulBinaryLength))
+		{
+			oswcerr << "skipping binary file " << file_name << std::endl;
+			continue;
+		}
+
+		if (fTime)
+		{
+			const ULONG ulText = UlLoadUS(mp, file_name, ulRuns);
+			const ULONG ulBinary = UlLoadUS(mp, strOutFile.Buffer(), ulRuns);
+
+			oswcout << file_name << "," << ulTextLength << ","
+					<< ulBinaryLength << "," << ulText << "," << ulBinary
+					<< std::endl;
+
+			ullTextBytes += ulTextLength;
+			ullBinaryBytes += ulBinaryLength;
+			ullTextUS += ulText;
+			ullBinaryUS += ulBinary;
+		}
+	}
+
+	if (fTime)
+	{
+		oswcout << "total," << ullTextBytes << "," << ullBinaryBytes << ","
+				<< ullTextUS << "," << ullBinaryUS << std::endl;
+	}
+
+	exit_code = 0;
+
+	return nullptr;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		main
+//
+//	@doc:
+//		Entry point for the DXL conversion tool
+//
+//---------------------------------------------------------------------------
+INT
+main(INT iArgs, const CHAR **rgszArgs)
+{
+	// Use default allocator
+	struct gpos_init_params gpos_params = {nullptr};
+
+	gpos_init(&gpos_params);
+	gpdxl_init();
+	gpopt_init();
+
+	SConvertArgs args = {iArgs, rgszArgs};
+
+	gpos_exec_params params;
+	params.func = PvExec;
+	params.arg = &args;
+	params.stack_start = &params;
+	params.error_buffer = nullptr;
+	params.error_buffer_size = -1;
+	params.abort_requested = nullptr;
+
+	if (gpos_exec(&params))
+	{
+		return 1;
+	}
+
+	return exit_code;
+}
+
+// EOF
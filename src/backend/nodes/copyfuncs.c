@@ -148,6 +148,7 @@ _copyPlannedStmt(const PlannedStmt *from)
 	COPY_NODE_FIELD(copyIntoClause);
 	COPY_NODE_FIELD(refreshClause);
 	COPY_SCALAR_FIELD(metricsQueryType);
+	COPY_SCALAR_FIELD(slicePruned);
 
 	return newnode;
 }
@@ -1095,6 +1096,7 @@ _copyHashJoin(const HashJoin *from)
 	 */
 	COPY_NODE_FIELD(hashclauses);
 	COPY_NODE_FIELD(hashqualclauses);
+	COPY_SCALAR_FIELD(runtimeFilter);
 
 	return newnode;
 }
@@ -391,6 +391,7 @@ _outPlannedStmt(StringInfo str, const PlannedStmt *node)
 	WRITE_NODE_FIELD(copyIntoClause);
 	WRITE_NODE_FIELD(refreshClause);
 	WRITE_INT_FIELD(metricsQueryType);
+	WRITE_BOOL_FIELD(slicePruned);
 }
 
 
@@ -976,6 +977,7 @@ _outHashJoin(StringInfo str, const HashJoin *node)
 
 	WRITE_NODE_FIELD(hashclauses);
 	WRITE_NODE_FIELD(hashqualclauses);
+	WRITE_BOOL_FIELD(runtimeFilter);
 }
 
 static void
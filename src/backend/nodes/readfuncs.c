@@ -2462,6 +2462,7 @@ _readPlannedStmt(void)
 	READ_NODE_FIELD(copyIntoClause);
 	READ_NODE_FIELD(refreshClause);
 	READ_INT_FIELD(metricsQueryType);
+	READ_BOOL_FIELD(slicePruned);
 
 	READ_DONE();
 }
@@ -3106,6 +3107,7 @@ _readHashJoin(void)
 
 	READ_NODE_FIELD(hashclauses);
 	READ_NODE_FIELD(hashqualclauses);
+	READ_BOOL_FIELD(runtimeFilter);
 
 	READ_DONE();
 }
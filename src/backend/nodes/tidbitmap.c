@@ -2184,12 +2184,19 @@ restart:
 				return res;
 			}
 
-			/* union/intersect existing output and new matches */
-			for (wordnum = 0; wordnum < WORDS_PER_PAGE; wordnum++)
+			/*
+			 * union/intersect existing output and new matches. Keep the
+			 * test of the operation out of the loops, so that they can be
+			 * vectorized.
+			 */
+			if (n->type == BMS_OR)
 			{
-				if (n->type == BMS_OR)
+				for (wordnum = 0; wordnum < WORDS_PER_PAGE; wordnum++)
 					e->words[wordnum] |= tmp->words[wordnum];
-				else
+			}
+			else
+			{
+				for (wordnum = 0; wordnum < WORDS_PER_PAGE; wordnum++)
 					e->words[wordnum] &= tmp->words[wordnum];
 			}
 			e->recheck |= tmp->recheck;
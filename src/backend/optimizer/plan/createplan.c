@@ -5590,6 +5590,18 @@ create_hashjoin_plan(PlannerInfo *root,
 		join_plan->join.plan.qual != NIL)
 		join_plan->join.prefetch_qual = true;
 
+	/*
+	 * CDB: Unless unmatched outer rows are needed in the result, the
+	 * executor may build a Bloom filter from the inner side and use it to
+	 * discard outer rows early.
+	 */
+	if (gp_enable_runtime_filter &&
+		!best_path->jpath.path.parallel_aware &&
+		(best_path->jpath.jointype == JOIN_INNER ||
+		 best_path->jpath.jointype == JOIN_SEMI ||
+		 best_path->jpath.jointype == JOIN_RIGHT))
+		join_plan->runtimeFilter = true;
+
 	copy_generic_path_info(&join_plan->join.plan, &best_path->jpath.path);
 
 	return join_plan;
@@ -3984,6 +3984,9 @@ pgstat_get_wait_ipc(WaitEventIPC w)
 		case WAIT_EVENT_DTX_RECOVERY:
 			event_name = "DtxRecovery";
 			break;
+		case WAIT_EVENT_AO_COMPACTION_WORKER:
+			event_name = "AppendOnlyCompactionWorker";
+			break;
 			/* no default case, so that compiler will warn */
 	}
 
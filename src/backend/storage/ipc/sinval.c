@@ -21,6 +21,7 @@
 #include "storage/proc.h"
 #include "storage/sinvaladt.h"
 #include "utils/inval.h"
+#include "utils/shared_mdcache.h"
 
 #include "cdb/cdbtm.h"          /* DtxContext */
 #include "tcop/idle_resource_cleaner.h"
@@ -56,6 +57,9 @@ void
 SendSharedInvalidMessages(const SharedInvalidationMessage *msgs, int n)
 {
 	SIInsertDataEntries(msgs, n);
+
+	/* entries of the shared metadata cache may describe the old state */
+	SharedMDCacheInvalidate(msgs, n);
 }
 
 /*
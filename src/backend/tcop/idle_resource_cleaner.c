@@ -22,6 +22,10 @@
 #include "utils/timeout.h"
 
 int			IdleSessionGangTimeout = 18000;
+int			IdleSessionGangReleaseRounds = 1;
+
+/* count of the idle gang timeouts in the current client wait */
+static int	idle_gang_timeout_rounds = 0;
 
 static volatile sig_atomic_t clientWaitTimeoutInterruptEnabled = 0;
 
@@ -39,6 +43,8 @@ static volatile sig_atomic_t idle_gang_timeout_occurred;
 void
 StartIdleResourceCleanupTimers()
 {
+	idle_gang_timeout_rounds = 0;
+
 	if (IdleSessionGangTimeout <= 0 || !cdbcomponent_qesExist())
 		return;
 
@@ -62,8 +68,9 @@ EnableClientWaitTimeoutInterrupt(void)
 
 	/*
 	 * NOTE: This is simpler than the corresponding notify and catchup
-	 * interrupt code, because we don't expect the idle timeouts to fire again
-	 * during the same client wait.
+	 * interrupt code.  The idle timeout can fire again during the same client
+	 * wait when the QEs are released in several rounds, but then the interrupt
+	 * is still enabled, so the handler processes it directly.
 	 */
 }
 
@@ -93,6 +100,11 @@ DisableClientWaitTimeoutInterrupt(void)
  * anything. This entails extra work, so we don't want to do this if we don't
  * think the session has gone idle.
  *
+ * To make it cheaper for a user who comes back soon, the idle QEs can be
+ * released in gp_vmem_idle_resource_release_rounds rounds, one per
+ * gp_vmem_idle_resource_timeout, instead of all at once.  The QEs the next
+ * query would reuse, including the writer, are released last.
+ *
  * PS: Is there anything we can free up on the master (QD) side? I can't
  * think of anything.
  */
@@ -101,9 +113,20 @@ IdleGangTimeoutHandler(void)
 {
 	if (clientWaitTimeoutInterruptEnabled)
 	{
+		int			remainingRounds;
+
 		idle_gang_timeout_occurred = 0;
 
-		DisconnectAndDestroyUnusedQEs();
+		idle_gang_timeout_rounds++;
+		remainingRounds = Max(IdleSessionGangReleaseRounds -
+							  idle_gang_timeout_rounds, 0);
+
+		ShrinkUnusedQEs(remainingRounds);
+
+		/* schedule the next round */
+		if (remainingRounds > 0 && IdleSessionGangTimeout > 0 &&
+			cdbcomponent_qesExist())
+			enable_timeout_after(GANG_TIMEOUT, IdleSessionGangTimeout);
 	}
 	else
 		idle_gang_timeout_occurred = 1;
@@ -1,63 +1,151 @@
-#include "../idle_resource_cleaner.c"
-
 #include <stdarg.h>
 #include <stddef.h>
 #include <setjmp.h>
 
 #include "cmockery.h"
 
-int
-returns1000_stub(void)
+#include "../idle_resource_cleaner.c"
+
+#define IDLE_GANG_TIMEOUT 10000
+
+static void
+setup(void **state)
 {
-	return 1000;
+	IdleSessionGangTimeout = IDLE_GANG_TIMEOUT;
+	IdleSessionGangReleaseRounds = 1;
+	idle_gang_timeout_rounds = 0;
+	idle_gang_timeout_occurred = 0;
+	clientWaitTimeoutInterruptEnabled = 1;
+}
+
+static void
+teardown(void **state)
+{
+	clientWaitTimeoutInterruptEnabled = 0;
 }
 
 #define test_with_setup_and_teardown(test_func) \
 	unit_test_setup_teardown(test_func, setup, teardown)
 
-void
-test__StartIdleResourceCleanupTimersWhenIdleGangTimeoutIs0AndNoSessionTimeoutHook(
-																				  void **state)
+static void
+expect_timer(void)
+{
+	expect_value(enable_timeout_after, id, GANG_TIMEOUT);
+	expect_value(enable_timeout_after, delay_ms, IDLE_GANG_TIMEOUT);
+	will_be_called(enable_timeout_after);
+}
+
+static void
+expect_shrink(int remainingRounds)
+{
+	expect_value(ShrinkUnusedQEs, remainingRounds, remainingRounds);
+	will_be_called(ShrinkUnusedQEs);
+}
+
+static void
+test__StartIdleResourceCleanupTimers_NoTimerWhenTimeoutIs0(void **state)
 {
 	IdleSessionGangTimeout = 0;
-	get_idle_session_timeout_hook = NULL;
 
 	/*
-	 * cmockery implicitly asserts that cdbcomponent_segdbsExist and enable_sig_alarm are
-	 * not called
+	 * cmockery implicitly asserts that cdbcomponent_qesExist and
+	 * enable_timeout_after are not called
 	 */
-
 	StartIdleResourceCleanupTimers();
 }
 
-void
-test__StartIdleResourceCleanupTimersWhenNoGangsExistAndNoSessionTimeoutHook(
-																			void **state)
+static void
+test__StartIdleResourceCleanupTimers_NoTimerWhenNoQEsExist(void **state)
 {
-	IdleSessionGangTimeout = 10000;
+	will_return(cdbcomponent_qesExist, false);
+	/* cmockery implicitly asserts that enable_timeout_after is not called */
 
-	will_return(cdbcomponent_segdbsExist, false);
-	/* cmockery implicitly asserts that enable_sig_alarm is not called */
+	StartIdleResourceCleanupTimers();
+}
+
+static void
+test__StartIdleResourceCleanupTimers_EnablesTimerWhenQEsExist(void **state)
+{
+	will_return(cdbcomponent_qesExist, true);
+	expect_timer();
 
 	StartIdleResourceCleanupTimers();
 }
 
-void
-test__StartIdleResourceCleanupTimersWhenGangsExistAndNoSessionTimeoutHook(
-																		  void **state)
+static void
+test__IdleGangTimeoutHandler_ReleasesAllQEsInOneRound(void **state)
 {
-	IdleSessionGangTimeout = 10000;
+	/* all the idle QEs go at once, and the timer is not re-armed */
+	expect_shrink(0);
 
-	NextTimeoutAction = -1;
+	IdleGangTimeoutHandler();
+}
+
+static void
+test__IdleGangTimeoutHandler_ReleasesQEsOverSeveralRounds(void **state)
+{
+	IdleSessionGangReleaseRounds = 3;
+
+	expect_shrink(2);
+	will_return(cdbcomponent_qesExist, true);
+	expect_timer();
+	IdleGangTimeoutHandler();
+
+	expect_shrink(1);
+	will_return(cdbcomponent_qesExist, true);
+	expect_timer();
+	IdleGangTimeoutHandler();
 
-	will_return(cdbcomponent_segdbsExist, true);
-	expect_value(enable_sig_alarm, delayms, 10000);
-	expect_value(enable_sig_alarm, is_statement_timeout, false);
-	will_return(enable_sig_alarm, true);
+	/* the last round releases the rest, and does not re-arm the timer */
+	expect_shrink(0);
+	IdleGangTimeoutHandler();
+}
+
+static void
+test__IdleGangTimeoutHandler_StopsWhenNoQEsAreLeft(void **state)
+{
+	IdleSessionGangReleaseRounds = 3;
 
+	expect_shrink(2);
+	will_return(cdbcomponent_qesExist, false);
+	/* cmockery implicitly asserts that enable_timeout_after is not called */
+
+	IdleGangTimeoutHandler();
+}
+
+static void
+test__StartIdleResourceCleanupTimers_RestartsTheRounds(void **state)
+{
+	IdleSessionGangReleaseRounds = 2;
+
+	expect_shrink(1);
+	will_return(cdbcomponent_qesExist, true);
+	expect_timer();
+	IdleGangTimeoutHandler();
+
+	/* the session ran a query, the next idle period starts from round one */
+	will_return(cdbcomponent_qesExist, true);
+	expect_timer();
 	StartIdleResourceCleanupTimers();
 
-	assert_int_equal(NextTimeoutAction, GANG_TIMEOUT);
+	expect_shrink(1);
+	will_return(cdbcomponent_qesExist, true);
+	expect_timer();
+	IdleGangTimeoutHandler();
+}
+
+static void
+test__IdleGangTimeoutHandler_DefersTheRoundWhenInterruptIsDisabled(void **state)
+{
+	assert_true(DisableClientWaitTimeoutInterrupt());
+
+	/* cmockery implicitly asserts that ShrinkUnusedQEs is not called */
+	IdleGangTimeoutHandler();
+	assert_int_equal(idle_gang_timeout_occurred, 1);
+
+	expect_shrink(0);
+	EnableClientWaitTimeoutInterrupt();
+	assert_int_equal(idle_gang_timeout_occurred, 0);
 }
 
 int
@@ -66,19 +154,15 @@ main(int argc, char *argv[])
 	cmockery_parse_arguments(argc, argv);
 
 	const		UnitTest tests[] = {
-		unit_test(test__StartIdleResourceCleanupTimersWhenIdleGangTimeoutIs0AndNoSessionTimeoutHook),
-		unit_test(test__StartIdleResourceCleanupTimersWhenNoGangsExistAndNoSessionTimeoutHook),
-		unit_test(test__StartIdleResourceCleanupTimersWhenGangsExistAndNoSessionTimeoutHook),
-		unit_test(test__StartIdleResourceCleanupTimersWhenGangsExistAndSessionTimeoutEnabled),
-		unit_test(test__StartIdleResourceCleanupTimersWhenGangTimeoutIsDisabledAndSessionTimeoutEnabled),
-		test_with_setup_and_teardown(test__DoIdleResourceCleanup_HandlesGangTimeoutWhenSessionTimeoutIsLater),
-		test_with_setup_and_teardown(test__DoIdleResourceCleanup_HandlesSessionTimeoutWhenGangTimeoutIsLater),
-		test_with_setup_and_teardown(test__DoIdleResourceCleanup_HandlesSessionTimeoutWithSimultaneousGangTimeout),
-		test_with_setup_and_teardown(test__DoIdleResourceCleanup_HandlesSessionTimeoutWithSimultaneousGangTimeoutButNullActionHook),
-		test_with_setup_and_teardown(test__DoIdleResourceCleanup_HandlesIdleSessionTimeoutAfterGangTimeout),
-		test_with_setup_and_teardown(test__DoIdleResourceCleanup_HandlesIdleSessionTimeoutAfterGangTimeoutWithNullActionHook),
-		test_with_setup_and_teardown(test__DoIdleResourceCleanup_HandlesGangTimeoutWhenSessionTimeoutDisabled),
+		test_with_setup_and_teardown(test__StartIdleResourceCleanupTimers_NoTimerWhenTimeoutIs0),
+		test_with_setup_and_teardown(test__StartIdleResourceCleanupTimers_NoTimerWhenNoQEsExist),
+		test_with_setup_and_teardown(test__StartIdleResourceCleanupTimers_EnablesTimerWhenQEsExist),
+		test_with_setup_and_teardown(test__IdleGangTimeoutHandler_ReleasesAllQEsInOneRound),
+		test_with_setup_and_teardown(test__IdleGangTimeoutHandler_ReleasesQEsOverSeveralRounds),
+		test_with_setup_and_teardown(test__IdleGangTimeoutHandler_StopsWhenNoQEsAreLeft),
+		test_with_setup_and_teardown(test__StartIdleResourceCleanupTimers_RestartsTheRounds),
+		test_with_setup_and_teardown(test__IdleGangTimeoutHandler_DefersTheRoundWhenInterruptIsDisabled),
 	};
 
-	run_tests(tests);
+	return run_tests(tests);
 }
@@ -922,6 +922,19 @@ xactGetCommittedInvalidationMessages(SharedInvalidationMessage **msgs,
 	return numSharedInvalidMessagesArray;
 }
 
+/*
+ * xactHasInvalidationMessages --- has the current transaction registered
+ * any invalidation messages?
+ *
+ * That is the case once it has changed the catalogs, outside of aborted
+ * subtransactions, so it may see catalog state that others cannot see yet.
+ */
+bool
+xactHasInvalidationMessages(void)
+{
+	return transInvalInfo != NULL;
+}
+
 /*
  * ProcessCommittedInvalidationMessages is executed by xact_redo_commit() or
  * standby_redo() to process invalidation messages. Currently that happens
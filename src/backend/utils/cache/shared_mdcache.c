@@ -0,0 +1,723 @@
+/*-------------------------------------------------------------------------
+ *
+ * shared_mdcache.c
+ *	  Shared-memory tier of the GPORCA metadata cache.
+ *
+ * GPORCA keeps the metadata objects it translates from the catalogs in a
+ * backend-local cache, which every new session has to fill again. This
+ * module provides a second tier, shared by all backends of the instance,
+ * holding the objects serialized as DXL and keyed by the string form of
+ * their metadata id. It is consulted by the relcache metadata provider
+ * before translating an object from the catalogs.
+ *
+ * The serialized objects live in a DSA area, created by the first backend
+ * that needs it. They are indexed by a fixed-size array of slots in the
+ * main shared memory segment. A key can only live in a small window of
+ * slots following its home slot, so that a lookup never has to look
+ * further. Like CCache, the cache evicts entries following the gclock
+ * policy: every access resets the counter of an entry, and a clock hand
+ * sweeping over the slots decrements the counters, evicting the entries
+ * whose counter has dropped to zero.
+ *
+ * Every entry records the catalog object it was translated from: the
+ * relation for relations, indexes, constraints, triggers and statistics,
+ * or the syscache entry of a type, function, aggregate, operator or cast.
+ * When shared invalidation messages are sent, only the entries named by
+ * them are evicted. Catcache messages of the catalogs that describe
+ * relations are ignored, as changing a relation always sends a relcache
+ * message for it too, and so are those of catalogs GPORCA does not
+ * translate. Messages for the operator classes and families, which types
+ * and comparisons are derived from, evict every entry that is not a
+ * relation.
+ *
+ * A backend reads a generation counter, bumped by every batch of messages
+ * that evicts entries, before processing pending invalidation messages.
+ * It only inserts an object if the generation has not changed by the time
+ * it is done translating it, so that an entry evicted by a concurrent
+ * commit cannot be added back from the catalog state before that commit.
+ *
+ * Copyright (c) 2022-Present VMware, Inc. or its affiliates.
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/utils/cache/shared_mdcache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "miscadmin.h"
+#include "port/atomics.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "utils/dsa.h"
+#include "utils/faultinjector.h"
+#include "utils/guc.h"
+#include "utils/hashutils.h"
+#include "utils/inval.h"
+#include "utils/memutils.h"
+#include "utils/shared_mdcache.h"
+#include "utils/syscache.h"
+
+/* number of slots, starting at its home slot, an entry can be placed in */
+#define SHARED_MDCACHE_WINDOW			16
+
+/* expected size of a serialized object, used to size the slot array */
+#define SHARED_MDCACHE_BYTES_PER_SLOT	1024
+
+/* initial gclock counter of an entry; same as CCACHE_GCLOCK_INIT_COUNTER */
+#define SHARED_MDCACHE_GCLOCK_INIT		3
+
+/* fraction of the cache freed by each eviction, as in CCache */
+#define SHARED_MDCACHE_EVICTION_FACTOR	0.1
+
+/* size of the first segment of a DSA area */
+#define SHARED_MDCACHE_MIN_AREA_SIZE	((Size) 1024 * 1024)
+
+typedef struct SharedMDCacheSlot
+{
+	uint32		hash;			/* hash value of key */
+	pg_atomic_uint32 usage;		/* gclock counter */
+	bool		evicted;		/* invalidated, but its object not freed yet */
+	Oid			dbid;			/* database the entry belongs to */
+	SharedMDCacheObjType objtype;	/* kind of object the entry describes */
+	Oid			relid;			/* its relation, for relation entries */
+	uint32		hashvalue;		/* its syscache hash value, or 0 for all */
+	dsa_pointer data;			/* serialized object, invalid if slot unused */
+	Size		len;			/* length of serialized object */
+	char		key[SHARED_MDCACHE_KEY_LEN];
+} SharedMDCacheSlot;
+
+typedef struct SharedMDCacheControl
+{
+	/* protects everything but generation and the usage counters */
+	LWLock		lock;
+
+	/* bumped for every batch of invalidation messages that evicts entries */
+	pg_atomic_uint64 generation;
+
+	/* DSA area holding the serialized objects, once created */
+	dsa_handle	area_handle;
+
+	/* total length of the serialized objects */
+	Size		used;
+
+	/* next slot the gclock hand will visit */
+	uint32		clock_hand;
+
+	/* number of slots; a power of two */
+	uint32		nslots;
+
+	SharedMDCacheSlot slots[FLEXIBLE_ARRAY_MEMBER];
+} SharedMDCacheControl;
+
+static SharedMDCacheControl *SharedMDCache = NULL;
+
+/* this backend's mapping of the DSA area */
+static dsa_area *SharedMDCacheArea = NULL;
+
+static uint32 shared_mdcache_nslots(void);
+static Size shared_mdcache_budget(void);
+static void shared_mdcache_attach(void);
+static SharedMDCacheSlot *shared_mdcache_find(const char *key, uint32 hash);
+static void shared_mdcache_free_slot(SharedMDCacheSlot *slot);
+static SharedMDCacheSlot *shared_mdcache_victim(uint32 hash);
+static void shared_mdcache_evict(Size needed);
+static int	shared_mdcache_object_cache(SharedMDCacheObjType objtype);
+static bool shared_mdcache_msg_relevant(const SharedInvalidationMessage *msg);
+static bool shared_mdcache_msg_evicts(const SharedInvalidationMessage *msg,
+									  const SharedMDCacheSlot *slot);
+
+/*
+ * Number of slots for the configured cache size.
+ */
+static uint32
+shared_mdcache_nslots(void)
+{
+	Size		nslots = 64;
+	Size		wanted;
+
+	wanted = (Size) optimizer_shared_mdcache_size * 1024 /
+		SHARED_MDCACHE_BYTES_PER_SLOT;
+	while (nslots < wanted && nslots < PG_UINT32_MAX / 2 + 1)
+		nslots *= 2;
+
+	return (uint32) nslots;
+}
+
+/*
+ * Total length of serialized objects the cache may hold.
+ */
+static Size
+shared_mdcache_budget(void)
+{
+	return (Size) optimizer_shared_mdcache_size * 1024;
+}
+
+/*
+ * Report shared-memory space needed by SharedMDCacheShmemInit.
+ */
+Size
+SharedMDCacheShmemSize(void)
+{
+	if (optimizer_shared_mdcache_size <= 0)
+		return 0;
+
+	return add_size(offsetof(SharedMDCacheControl, slots),
+					mul_size(shared_mdcache_nslots(),
+							 sizeof(SharedMDCacheSlot)));
+}
+
+/*
+ * Allocate and initialize the slot array, if the cache is enabled.
+ */
+void
+SharedMDCacheShmemInit(void)
+{
+	bool		found;
+	uint32		i;
+
+	if (optimizer_shared_mdcache_size <= 0)
+		return;
+
+	SharedMDCache = (SharedMDCacheControl *)
+		ShmemInitStruct("Shared MDCache", SharedMDCacheShmemSize(), &found);
+
+	if (!IsUnderPostmaster)
+	{
+		Assert(!found);
+
+		LWLockInitialize(&SharedMDCache->lock, LWTRANCHE_SHARED_MDCACHE);
+		pg_atomic_init_u64(&SharedMDCache->generation, 0);
+		SharedMDCache->area_handle = DSM_HANDLE_INVALID;
+		SharedMDCache->used = 0;
+		SharedMDCache->clock_hand = 0;
+		SharedMDCache->nslots = shared_mdcache_nslots();
+
+		for (i = 0; i < SharedMDCache->nslots; i++)
+		{
+			SharedMDCacheSlot *slot = &SharedMDCache->slots[i];
+
+			pg_atomic_init_u32(&slot->usage, 0);
+			slot->evicted = false;
+			slot->data = InvalidDsaPointer;
+			slot->len = 0;
+		}
+	}
+	else
+		Assert(found);
+}
+
+/*
+ * Can the current transaction use the shared cache?
+ *
+ * A transaction that has changed the catalogs sees changes that are not
+ * committed yet, so it must neither use the shared objects nor share the
+ * ones it translates. Other writes do not matter.
+ */
+bool
+SharedMDCacheEnabled(void)
+{
+	return SharedMDCache != NULL && !xactHasInvalidationMessages();
+}
+
+/*
+ * Return the current generation, and bring this backend's caches up to
+ * date with it.
+ *
+ * The generation is read before processing pending invalidation messages:
+ * any commit that happens later bumps it again, which prevents inserting
+ * objects translated from a catalog state older than the commit.
+ */
+uint64
+SharedMDCacheGetGeneration(void)
+{
+	uint64		generation;
+
+	Assert(SharedMDCache != NULL);
+
+	generation = pg_atomic_read_u64(&SharedMDCache->generation);
+	pg_read_barrier();
+
+	AcceptInvalidationMessages();
+
+	return generation;
+}
+
+/*
+ * Map the DSA area, creating it if this is the first backend to use it.
+ */
+static void
+shared_mdcache_attach(void)
+{
+	MemoryContext oldcontext;
+
+	if (SharedMDCacheArea != NULL)
+		return;
+
+	oldcontext = MemoryContextSwitchTo(TopMemoryContext);
+	LWLockAcquire(&SharedMDCache->lock, LW_EXCLUSIVE);
+
+	if (SharedMDCache->area_handle == DSM_HANDLE_INVALID)
+	{
+		SharedMDCacheArea = dsa_create(LWTRANCHE_SHARED_MDCACHE);
+		dsa_pin(SharedMDCacheArea);
+
+		/* leave room for the allocator's own overhead and fragmentation */
+		dsa_set_size_limit(SharedMDCacheArea,
+						   Max(shared_mdcache_budget() / 2 * 3,
+							   SHARED_MDCACHE_MIN_AREA_SIZE));
+		SharedMDCache->area_handle = dsa_get_handle(SharedMDCacheArea);
+	}
+	else
+		SharedMDCacheArea = dsa_attach(SharedMDCache->area_handle);
+
+	dsa_pin_mapping(SharedMDCacheArea);
+
+	LWLockRelease(&SharedMDCache->lock);
+	MemoryContextSwitchTo(oldcontext);
+}
+
+/*
+ * Find the slot holding the given key in the current database. Caller must
+ * hold the lock.
+ */
+static SharedMDCacheSlot *
+shared_mdcache_find(const char *key, uint32 hash)
+{
+	uint32		mask = SharedMDCache->nslots - 1;
+	int			i;
+
+	for (i = 0; i < SHARED_MDCACHE_WINDOW; i++)
+	{
+		SharedMDCacheSlot *slot = &SharedMDCache->slots[(hash + i) & mask];
+
+		if (DsaPointerIsValid(slot->data) &&
+			!slot->evicted &&
+			slot->hash == hash &&
+			slot->dbid == MyDatabaseId &&
+			strcmp(slot->key, key) == 0)
+			return slot;
+	}
+
+	return NULL;
+}
+
+/*
+ * Release the object held by a slot. Caller must hold the lock exclusively.
+ */
+static void
+shared_mdcache_free_slot(SharedMDCacheSlot *slot)
+{
+	Assert(DsaPointerIsValid(slot->data));
+
+	dsa_free(SharedMDCacheArea, slot->data);
+	SharedMDCache->used -= slot->len;
+	slot->data = InvalidDsaPointer;
+	slot->len = 0;
+}
+
+/*
+ * Pick the slot a new entry with the given hash value goes to, evicting
+ * the entry it holds if necessary. Caller must hold the lock exclusively.
+ *
+ * Unused slots and slots of invalidated entries are taken first. Otherwise
+ * the gclock policy is applied to the slots of the window; as counters
+ * never exceed SHARED_MDCACHE_GCLOCK_INIT, this always finds a victim.
+ */
+static SharedMDCacheSlot *
+shared_mdcache_victim(uint32 hash)
+{
+	uint32		mask = SharedMDCache->nslots - 1;
+	int			i;
+
+	for (i = 0; i < SHARED_MDCACHE_WINDOW; i++)
+	{
+		SharedMDCacheSlot *slot = &SharedMDCache->slots[(hash + i) & mask];
+
+		if (!DsaPointerIsValid(slot->data))
+			return slot;
+
+		if (slot->evicted)
+		{
+			shared_mdcache_free_slot(slot);
+			return slot;
+		}
+	}
+
+	for (;;)
+	{
+		for (i = 0; i < SHARED_MDCACHE_WINDOW; i++)
+		{
+			SharedMDCacheSlot *slot =
+				&SharedMDCache->slots[(hash + i) & mask];
+
+			if (pg_atomic_read_u32(&slot->usage) == 0)
+			{
+				shared_mdcache_free_slot(slot);
+				return slot;
+			}
+
+			pg_atomic_fetch_sub_u32(&slot->usage, 1);
+		}
+	}
+}
+
+/*
+ * Evict entries until an object of the given length fits, leaving some
+ * headroom so that the next insertions do not have to evict right away.
+ * Caller must hold the lock exclusively.
+ */
+static void
+shared_mdcache_evict(Size needed)
+{
+	Size		budget = shared_mdcache_budget();
+	Size		target;
+	uint64		steps;
+	uint64		max_steps;
+
+	if (SharedMDCache->used + needed <= budget)
+		return;
+
+	target = (Size) (budget * (1.0 - SHARED_MDCACHE_EVICTION_FACTOR));
+	max_steps = (uint64) SharedMDCache->nslots *
+		(SHARED_MDCACHE_GCLOCK_INIT + 1);
+
+	for (steps = 0;
+		 steps < max_steps && SharedMDCache->used > 0 &&
+		 SharedMDCache->used + needed > target;
+		 steps++)
+	{
+		SharedMDCacheSlot *slot;
+
+		slot = &SharedMDCache->slots[SharedMDCache->clock_hand];
+		SharedMDCache->clock_hand =
+			(SharedMDCache->clock_hand + 1) & (SharedMDCache->nslots - 1);
+
+		if (!DsaPointerIsValid(slot->data))
+			continue;
+
+		if (slot->evicted || pg_atomic_read_u32(&slot->usage) == 0)
+			shared_mdcache_free_slot(slot);
+		else
+			pg_atomic_fetch_sub_u32(&slot->usage, 1);
+	}
+}
+
+/*
+ * Look up the object cached under the given key in the current database.
+ *
+ * Returns a palloc'd copy of the serialized object, and sets *len to its
+ * length, or returns NULL if there is no entry for the key. The caller
+ * must have processed pending invalidation messages, by calling
+ * SharedMDCacheGetGeneration.
+ */
+char *
+SharedMDCacheLookup(const char *key, Size *len)
+{
+	SharedMDCacheSlot *slot;
+	uint32		hash;
+	char	   *result = NULL;
+
+	Assert(SharedMDCache != NULL);
+
+	if (strlen(key) >= SHARED_MDCACHE_KEY_LEN)
+		return NULL;
+
+	shared_mdcache_attach();
+
+	hash = DatumGetUInt32(hash_any((const unsigned char *) key,
+								   strlen(key)));
+
+	LWLockAcquire(&SharedMDCache->lock, LW_SHARED);
+
+	slot = shared_mdcache_find(key, hash);
+	if (slot != NULL)
+	{
+		result = palloc(slot->len + 1);
+		memcpy(result, dsa_get_address(SharedMDCacheArea, slot->data),
+			   slot->len);
+		result[slot->len] = '\0';
+		*len = slot->len;
+
+		pg_atomic_write_u32(&slot->usage, SHARED_MDCACHE_GCLOCK_INIT);
+	}
+
+	LWLockRelease(&SharedMDCache->lock);
+
+#ifdef FAULT_INJECTOR
+	/* the key stands in for the table name, so a test can pick the object */
+	if (result != NULL)
+		FaultInjector_InjectFaultIfSet("shared_mdcache_hit", DDLNotSpecified,
+									   "", key);
+#endif
+
+	return result;
+}
+
+/*
+ * Cache a serialized object under the given key in the current database.
+ *
+ * The object is evicted by invalidation messages for the catalog object
+ * given by objtype, and relid or objid: relid is the relation the object
+ * describes, for relation entries, and objid the type, function, aggregate
+ * or operator. Cast and comparison entries are evicted by changes to any
+ * cast or operator.
+ *
+ * The generation must be the one returned by SharedMDCacheGetGeneration
+ * before the object was translated; nothing is cached if it has changed
+ * since. Failing to find room for the object is not an error either.
+ */
+void
+SharedMDCacheInsert(const char *key, uint64 generation, const char *data,
+					Size len, SharedMDCacheObjType objtype, Oid relid,
+					Oid objid)
+{
+	SharedMDCacheSlot *slot;
+	dsa_pointer dp;
+	uint32		hash;
+	uint32		hashvalue = 0;
+	int			cacheid = shared_mdcache_object_cache(objtype);
+
+	Assert(SharedMDCache != NULL);
+
+	if (strlen(key) >= SHARED_MDCACHE_KEY_LEN ||
+		len > shared_mdcache_budget() / 2 ||
+		generation != pg_atomic_read_u64(&SharedMDCache->generation))
+		return;
+
+	Assert(objtype == SHARED_MDCACHE_RELATION ? OidIsValid(relid) :
+		   !OidIsValid(relid));
+
+	shared_mdcache_attach();
+
+	hash = DatumGetUInt32(hash_any((const unsigned char *) key,
+								   strlen(key)));
+
+	/* the hash value of the object in the catcache messages about it */
+	if (cacheid >= 0 && OidIsValid(objid))
+		hashvalue = GetSysCacheHashValue1(cacheid, ObjectIdGetDatum(objid));
+
+	LWLockAcquire(&SharedMDCache->lock, LW_EXCLUSIVE);
+
+	if (generation != pg_atomic_read_u64(&SharedMDCache->generation))
+	{
+		LWLockRelease(&SharedMDCache->lock);
+		return;
+	}
+
+	/* replace any entry for the same key */
+	slot = shared_mdcache_find(key, hash);
+	if (slot != NULL)
+		shared_mdcache_free_slot(slot);
+
+	shared_mdcache_evict(len);
+
+	dp = dsa_allocate_extended(SharedMDCacheArea, len, DSA_ALLOC_NO_OOM);
+	if (!DsaPointerIsValid(dp))
+	{
+		/* the area is fragmented; free some more and retry once */
+		shared_mdcache_evict(shared_mdcache_budget() / 2);
+		dp = dsa_allocate_extended(SharedMDCacheArea, len, DSA_ALLOC_NO_OOM);
+		if (!DsaPointerIsValid(dp))
+		{
+			LWLockRelease(&SharedMDCache->lock);
+			return;
+		}
+	}
+	memcpy(dsa_get_address(SharedMDCacheArea, dp), data, len);
+
+	slot = shared_mdcache_victim(hash);
+	slot->hash = hash;
+	slot->evicted = false;
+	slot->dbid = MyDatabaseId;
+	slot->objtype = objtype;
+	slot->relid = relid;
+	slot->hashvalue = hashvalue;
+	slot->data = dp;
+	slot->len = len;
+	strlcpy(slot->key, key, SHARED_MDCACHE_KEY_LEN);
+	pg_atomic_write_u32(&slot->usage, SHARED_MDCACHE_GCLOCK_INIT);
+	SharedMDCache->used += len;
+
+	LWLockRelease(&SharedMDCache->lock);
+}
+
+/*
+ * The syscache whose catcache messages name objects of the given kind, or
+ * -1 for relations, which are named by relcache messages.
+ */
+static int
+shared_mdcache_object_cache(SharedMDCacheObjType objtype)
+{
+	switch (objtype)
+	{
+		case SHARED_MDCACHE_RELATION:
+			return -1;
+		case SHARED_MDCACHE_TYPE:
+			return TYPEOID;
+		case SHARED_MDCACHE_FUNCTION:
+			return PROCOID;
+		case SHARED_MDCACHE_AGGREGATE:
+			return AGGFNOID;
+		case SHARED_MDCACHE_OPERATOR:
+		case SHARED_MDCACHE_COMPARISON:
+			return OPEROID;
+		case SHARED_MDCACHE_CAST:
+			return CASTSOURCETARGET;
+	}
+
+	elog(ERROR, "unrecognized shared metadata cache object type: %d",
+		 (int) objtype);
+	return -1;					/* keep compiler quiet */
+}
+
+/*
+ * Is the catcache with the given id one that types, operators or
+ * comparisons are derived from, without being named in its messages?
+ */
+static bool
+shared_mdcache_derived_cache(int cacheid)
+{
+	switch (cacheid)
+	{
+		case AMNAME:
+		case AMOID:
+		case AMOPOPID:
+		case AMOPSTRATEGY:
+		case AMPROCNUM:
+		case CLAAMNAMENSP:
+		case CLAOID:
+		case ENUMOID:
+		case ENUMTYPOIDNAME:
+		case OPFAMILYAMNAMENSP:
+		case OPFAMILYOID:
+		case RANGETYPE:
+			return true;
+		default:
+			return false;
+	}
+}
+
+/*
+ * Can the given invalidation message evict any entry?
+ */
+static bool
+shared_mdcache_msg_relevant(const SharedInvalidationMessage *msg)
+{
+	if (msg->id >= 0)
+	{
+		switch (msg->cc.id)
+		{
+			case TYPEOID:
+			case PROCOID:
+			case AGGFNOID:
+			case OPEROID:
+			case CASTSOURCETARGET:
+				return true;
+			default:
+				return shared_mdcache_derived_cache(msg->cc.id);
+		}
+	}
+
+	return msg->id == SHAREDINVALCATALOG_ID ||
+		msg->id == SHAREDINVALRELCACHE_ID;
+}
+
+/*
+ * Does the given invalidation message evict the entry held by a slot?
+ */
+static bool
+shared_mdcache_msg_evicts(const SharedInvalidationMessage *msg,
+						  const SharedMDCacheSlot *slot)
+{
+	if (msg->id >= 0)
+	{
+		int			cacheid;
+
+		if (OidIsValid(msg->cc.dbId) && msg->cc.dbId != slot->dbid)
+			return false;
+
+		if (slot->objtype == SHARED_MDCACHE_RELATION)
+			return false;
+
+		if (shared_mdcache_derived_cache(msg->cc.id))
+			return true;
+
+		/* an aggregate is also named by messages about its function */
+		cacheid = shared_mdcache_object_cache(slot->objtype);
+		if (msg->cc.id != cacheid &&
+			!(msg->cc.id == PROCOID && cacheid == AGGFNOID))
+			return false;
+
+		return slot->hashvalue == 0 || slot->hashvalue == msg->cc.hashValue;
+	}
+	else if (msg->id == SHAREDINVALCATALOG_ID)
+	{
+		return !OidIsValid(msg->cat.dbId) || msg->cat.dbId == slot->dbid;
+	}
+	else if (msg->id == SHAREDINVALRELCACHE_ID)
+	{
+		if (OidIsValid(msg->rc.dbId) && msg->rc.dbId != slot->dbid)
+			return false;
+
+		/* an invalid relid stands for all relations */
+		return slot->objtype == SHARED_MDCACHE_RELATION &&
+			(!OidIsValid(msg->rc.relId) || msg->rc.relId == slot->relid);
+	}
+
+	return false;
+}
+
+/*
+ * Evict the entries named by a batch of invalidation messages. Called
+ * whenever shared invalidation messages are sent, i.e. after the catalog
+ * changes they describe have been committed.
+ *
+ * This runs while committing, when mapping the DSA area could fail, so
+ * the entries are only marked as evicted. The next insertion that needs
+ * room frees their objects.
+ */
+void
+SharedMDCacheInvalidate(const SharedInvalidationMessage *msgs, int n)
+{
+	uint32		i;
+	int			first;
+
+	if (SharedMDCache == NULL)
+		return;
+
+	/* most messages, e.g. those about a relation's columns, are of no use */
+	for (first = 0; first < n; first++)
+	{
+		if (shared_mdcache_msg_relevant(&msgs[first]))
+			break;
+	}
+	if (first == n)
+		return;
+
+	/* keep translations that may predate these changes from being added */
+	pg_atomic_fetch_add_u64(&SharedMDCache->generation, 1);
+
+	LWLockAcquire(&SharedMDCache->lock, LW_EXCLUSIVE);
+
+	for (i = 0; i < SharedMDCache->nslots; i++)
+	{
+		SharedMDCacheSlot *slot = &SharedMDCache->slots[i];
+		int			j;
+
+		if (!DsaPointerIsValid(slot->data) || slot->evicted)
+			continue;
+
+		for (j = first; j < n; j++)
+		{
+			if (shared_mdcache_msg_evicts(&msgs[j], slot))
+			{
+				slot->evicted = true;
+				break;
+			}
+		}
+	}
+
+	LWLockRelease(&SharedMDCache->lock);
+}
@@ -295,6 +295,61 @@ datumstreamread_nthlarge(DatumStreamRead * acc)
 	}
 }
 
+/*
+ * Read up to maxRows rows after the current position of the current block
+ * into values and isnull, as datumstreamread_advance and datumstreamread_get
+ * would one at a time. Returns the number of rows read, 0 at the end of the
+ * block; batches never span blocks, so pass-by-reference values stay valid
+ * until the next block is read.
+ */
+int
+datumstreamread_get_batch(DatumStreamRead * acc, int maxRows,
+						  Datum *values, bool *isnull)
+{
+	if (acc->largeObjectState == DatumStreamLargeObjectState_None)
+		return DatumStreamBlockRead_GetBatch(&acc->blockRead, maxRows,
+											 values, isnull);
+
+	/* A large object block holds a single row. */
+	if (maxRows <= 0 ||
+		acc->largeObjectState != DatumStreamLargeObjectState_HaveAoContent)
+		return 0;
+
+	datumstreamread_advancelarge(acc);
+	datumstreamread_getlarge(acc, &values[0], &isnull[0]);
+
+	return 1;
+}
+
+/*
+ * Read up to maxRows rows of the current block as runs of equal values, see
+ * DatumStreamBlockRead_GetRuns. Returns the number of runs, and the number
+ * of rows in *nrows.
+ */
+int
+datumstreamread_get_runs(DatumStreamRead * acc, int maxRows,
+						 Datum *values, bool *isnull,
+						 int32 *runLengths, int *nrows)
+{
+	if (acc->largeObjectState == DatumStreamLargeObjectState_None)
+	{
+		int32		nitems;
+		int32		nruns;
+
+		nruns = DatumStreamBlockRead_GetRuns(&acc->blockRead, maxRows,
+											 values, isnull, runLengths,
+											 &nitems);
+		*nrows = nitems;
+		return nruns;
+	}
+
+	*nrows = datumstreamread_get_batch(acc, maxRows, values, isnull);
+	if (*nrows == 0)
+		return 0;
+
+	runLengths[0] = 1;
+	return 1;
+}
 
 int
 datumstreamwrite_put(
@@ -1286,10 +1341,15 @@ datumstreamread_block_content(DatumStreamRead * acc)
 }
 
 
-int
-datumstreamread_block(DatumStreamRead * acc,
-					  AppendOnlyBlockDirectory *blockDirectory,
-					  int colGroupNo)
+/*
+ * Read the header of the next block of the datum stream, without reading
+ * its contents; returns false at the end of the segment file.
+ *
+ * The block must then be either read with datumstreamread_block_content, or
+ * skipped with datumstreamread_skip_block.
+ */
+bool
+datumstreamread_block_header(DatumStreamRead * acc)
 {
 	bool		readOK = false;
 
@@ -1305,7 +1365,7 @@ datumstreamread_block(DatumStreamRead * acc,
 												&acc->getBlockInfo.isLarge,
 											&acc->getBlockInfo.isCompressed);
 	if (!readOK)
-		return -1;
+		return false;
 
 	if (Debug_appendonly_print_datumstream)
 		elog(LOG,
@@ -1347,6 +1407,29 @@ datumstreamread_block(DatumStreamRead * acc,
 			 acc->blockFileOffset,
 			 acc->blockRowCount);
 
+	return true;
+}
+
+/*
+ * Skip the block whose header was read with datumstreamread_block_header,
+ * without reading or decompressing its contents.
+ */
+void
+datumstreamread_skip_block(DatumStreamRead * acc)
+{
+	Assert(acc);
+
+	AppendOnlyStorageRead_SkipCurrentBlock(&acc->ao_read);
+}
+
+int
+datumstreamread_block(DatumStreamRead * acc,
+					  AppendOnlyBlockDirectory *blockDirectory,
+					  int colGroupNo)
+{
+	if (!datumstreamread_block_header(acc))
+		return -1;
+
 	datumstreamread_block_content(acc);
 
 	if (blockDirectory)
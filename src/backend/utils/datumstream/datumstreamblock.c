@@ -406,6 +406,183 @@ DatumStreamBlockRead_Finish(
 	/* Place holder. */
 }
 
+/*
+ * Number of copies of the current item that follow it, if it is an item
+ * repeated by RLE_TYPE compression.
+ */
+static inline int32
+DatumStreamBlockRead_RepeatsAhead(DatumStreamBlockRead * dsr)
+{
+	if (dsr->datumStreamVersion == DatumStreamVersion_Original ||
+		!dsr->rle_block_was_compressed ||
+		!dsr->rle_in_repeated_item)
+		return 0;
+
+	return dsr->rle_repeated_item_count;
+}
+
+/*
+ * Advance over count copies of the current repeated item. The same as
+ * calling DatumStreamBlockRead_AdvanceDense count times; the item pointers,
+ * NULL bit-map and COMPRESS bit-map stay on the repeated item.
+ */
+static inline void
+DatumStreamBlockRead_SkipRepeats(DatumStreamBlockRead * dsr, int32 count)
+{
+	Assert(dsr->rle_in_repeated_item);
+	Assert(count > 0 && count <= dsr->rle_repeated_item_count);
+
+	dsr->nth += count;
+	dsr->rle_repeated_item_count -= count;
+	dsr->rle_total_repeat_items_read += count;
+	if (dsr->rle_repeated_item_count <= 0)
+		dsr->rle_in_repeated_item = false;
+}
+
+/*
+ * Read up to maxItems items after the current position of the block into
+ * values and isnull, and position the block on the last one.
+ *
+ * This is equivalent to calling DatumStreamBlockRead_Advance and
+ * DatumStreamBlockRead_Get for each item, but the items of blocks of
+ * fixed-length pass-by-value types without NULLs, RLE_TYPE or delta
+ * compression are copied out in one tight loop, and the repeated items of
+ * RLE_TYPE compressed blocks are decoded once per run.
+ *
+ * Returns the number of items read, 0 at the end of the block.
+ */
+int32
+DatumStreamBlockRead_GetBatch(
+							  DatumStreamBlockRead * dsr,
+							  int32 maxItems,
+							  Datum *values,
+							  bool *isnull)
+{
+	int32		count;
+
+	count = Min(maxItems, DatumStreamBlockRead_Remaining(dsr));
+	if (count <= 0)
+		return 0;
+
+	if (!dsr->has_null &&
+		dsr->typeInfo.byval &&
+		dsr->typeInfo.datumlen > 0 &&
+		(dsr->datumStreamVersion == DatumStreamVersion_Original ||
+		 (!dsr->rle_block_was_compressed && !dsr->delta_block_was_compressed)))
+	{
+		int32		datumlen = dsr->typeInfo.datumlen;
+		uint8	   *p = dsr->datump;
+		int32		i;
+
+		/* The block read pre-positions datump to the first item. */
+		if (dsr->physical_datum_index >= 0)
+			p += datumlen;
+
+		Assert(p + (count - 1) * datumlen < dsr->datum_afterp);
+
+		switch (datumlen)
+		{
+			case 1:
+				for (i = 0; i < count; i++)
+					values[i] = p[i];
+				break;
+			case 2:
+				for (i = 0; i < count; i++)
+					values[i] = ((uint16 *) p)[i];
+				break;
+			case 4:
+				for (i = 0; i < count; i++)
+					values[i] = ((uint32 *) p)[i];
+				break;
+			case 8:
+				for (i = 0; i < count; i++)
+					values[i] = ((Datum *) p)[i];
+				break;
+			default:
+				elog(ERROR, "unexpected length %d of pass-by-value datum stream item",
+					 datumlen);
+		}
+		memset(isnull, false, count * sizeof(bool));
+
+		dsr->nth += count;
+		dsr->physical_datum_index += count;
+		dsr->datump = p + (count - 1) * datumlen;
+
+		return count;
+	}
+
+	for (int32 i = 0; i < count;)
+	{
+		int32		repeats;
+
+		DatumStreamBlockRead_Advance(dsr);
+		DatumStreamBlockRead_Get(dsr, &values[i], &isnull[i]);
+		i++;
+
+		repeats = Min(DatumStreamBlockRead_RepeatsAhead(dsr), count - i);
+		if (repeats > 0)
+		{
+			DatumStreamBlockRead_SkipRepeats(dsr, repeats);
+			for (int32 j = 0; j < repeats; j++)
+			{
+				values[i + j] = values[i - 1];
+				isnull[i + j] = false;
+			}
+			i += repeats;
+		}
+	}
+
+	return count;
+}
+
+/*
+ * Read up to maxItems items after the current position of the block as runs
+ * of equal items, and position the block on the last one.
+ *
+ * The nth run is the item values[n] and isnull[n], repeated runLengths[n]
+ * times. The items repeated by RLE_TYPE compression form one run, any other
+ * item is a run of its own. Only the first item of a run is decoded, so
+ * callers can evaluate quals or aggregate over the runs rather than over
+ * the items. The number of items read is returned in *itemCount.
+ *
+ * Returns the number of runs, 0 at the end of the block.
+ */
+int32
+DatumStreamBlockRead_GetRuns(
+							 DatumStreamBlockRead * dsr,
+							 int32 maxItems,
+							 Datum *values,
+							 bool *isnull,
+							 int32 *runLengths,
+							 int32 *itemCount)
+{
+	int32		count;
+	int32		nitems = 0;
+	int32		nruns = 0;
+
+	count = Min(maxItems, DatumStreamBlockRead_Remaining(dsr));
+
+	while (nitems < count)
+	{
+		int32		repeats;
+
+		DatumStreamBlockRead_Advance(dsr);
+		DatumStreamBlockRead_Get(dsr, &values[nruns], &isnull[nruns]);
+		nitems++;
+
+		repeats = Min(DatumStreamBlockRead_RepeatsAhead(dsr), count - nitems);
+		if (repeats > 0)
+		{
+			DatumStreamBlockRead_SkipRepeats(dsr, repeats);
+			nitems += repeats;
+		}
+		runLengths[nruns++] = repeats + 1;
+	}
+
+	*itemCount = nitems;
+	return nruns;
+}
+
 /*
  * Dense routines.
  */
@@ -166,13 +166,301 @@ test__DeltaCompression__Core(void **state)
 	free(dsw);
 }
 
+/*
+ * Set up a DatumStreamBlockRead over an original format block of int4 items,
+ * positioned before the first one. Every third item is NULL if withNulls.
+ */
+static DatumStreamBlockRead *
+make_int4_block_read(int32 count, bool withNulls)
+{
+	DatumStreamBlockRead *dsr = malloc(sizeof(DatumStreamBlockRead));
+	uint8	   *null_bitmap = calloc(DatumStreamBitMap_Size(count), 1);
+	int32	   *datums = malloc(count * sizeof(int32));
+	int32		ndatums = 0;
+
+	memset(dsr, 0, sizeof(DatumStreamBlockRead));
+	strncpy(dsr->eyecatcher, DatumStreamBlockRead_Eyecatcher, DatumStreamBlockRead_EyecatcherLen);
+	dsr->datumStreamVersion = DatumStreamVersion_Original;
+	dsr->typeInfo.datumlen = 4;
+	dsr->typeInfo.typid = INT4OID;
+	dsr->typeInfo.byval = true;
+
+	for (int32 i = 0; i < count; i++)
+	{
+		if (withNulls && i % 3 == 0)
+			null_bitmap[i / 8] |= 1 << (i % 8);
+		else
+			datums[ndatums++] = i * 10;
+	}
+
+	dsr->nth = -1;
+	dsr->physical_datum_index = -1;
+	dsr->logical_row_count = count;
+	dsr->physical_datum_count = ndatums;
+	dsr->physical_data_size = ndatums * sizeof(int32);
+	dsr->has_null = withNulls;
+	if (withNulls)
+		DatumStreamBitMapRead_Init(&dsr->null_bitmap, null_bitmap, count);
+	dsr->null_bitmap_beginp = null_bitmap;
+	dsr->datum_beginp = (uint8 *) datums;
+	dsr->datum_afterp = (uint8 *) (datums + ndatums);
+	dsr->datump = dsr->datum_beginp;
+
+	return dsr;
+}
+
+static void
+free_int4_block_read(DatumStreamBlockRead *dsr)
+{
+	free(dsr->null_bitmap_beginp);
+	free(dsr->datum_beginp);
+	free(dsr);
+}
+
+static void
+check_int4_batch(Datum *values, bool *isnull, int32 first, int32 count,
+				 bool withNulls)
+{
+	for (int32 i = 0; i < count; i++)
+	{
+		int32		n = first + i;
+
+		if (withNulls && n % 3 == 0)
+			assert_true(isnull[i]);
+		else
+		{
+			assert_false(isnull[i]);
+			assert_int_equal(DatumGetInt32(values[i]), n * 10);
+		}
+	}
+}
+
+/*
+ * Batches must return the same items as reading them one at a time, and
+ * the two can be mixed.
+ */
+static void
+test__DatumStreamBlockRead_GetBatch(bool withNulls)
+{
+	DatumStreamBlockRead *dsr = make_int4_block_read(100, withNulls);
+	Datum		values[100];
+	bool		isnull[100];
+	Datum		value = 0;
+	bool		null;
+
+	assert_int_equal(DatumStreamBlockRead_Remaining(dsr), 100);
+
+	assert_int_equal(DatumStreamBlockRead_GetBatch(dsr, 10, values, isnull), 10);
+	check_int4_batch(values, isnull, 0, 10, withNulls);
+	assert_int_equal(DatumStreamBlockRead_Nth(dsr), 9);
+	assert_int_equal(DatumStreamBlockRead_Remaining(dsr), 90);
+
+	assert_int_equal(DatumStreamBlockRead_Advance(dsr), 1);
+	DatumStreamBlockRead_Get(dsr, &value, &null);
+	check_int4_batch(&value, &null, 10, 1, withNulls);
+
+	assert_int_equal(DatumStreamBlockRead_GetBatch(dsr, 1000, values, isnull), 89);
+	check_int4_batch(values, isnull, 11, 89, withNulls);
+	assert_int_equal(DatumStreamBlockRead_Remaining(dsr), 0);
+
+	assert_int_equal(DatumStreamBlockRead_GetBatch(dsr, 10, values, isnull), 0);
+	assert_int_equal(DatumStreamBlockRead_Advance(dsr), 0);
+
+	free_int4_block_read(dsr);
+}
+
+static void
+test__DatumStreamBlockRead_GetBatch__NoNulls(void **state)
+{
+	test__DatumStreamBlockRead_GetBatch(false);
+}
+
+static void
+test__DatumStreamBlockRead_GetBatch__Nulls(void **state)
+{
+	test__DatumStreamBlockRead_GetBatch(true);
+}
+
+/*
+ * Set up a DatumStreamBlockRead over an RLE_TYPE compressed block of int4
+ * items, positioned before the first one. The nth run holds the value
+ * n * 10 repeated n % 4 + 1 times; every fifth run is a single NULL
+ * instead if withNulls.
+ */
+#define RLE_RUN_LENGTH(n)	((n) % 4 + 1)
+#define RLE_RUN_IS_NULL(n, withNulls)	((withNulls) && (n) % 5 == 4)
+
+static DatumStreamBlockRead *
+make_int4_rle_block_read(int32 nruns, bool withNulls)
+{
+	DatumStreamBlockRead *dsr = malloc(sizeof(DatumStreamBlockRead));
+	uint8	   *null_bitmap = calloc(DatumStreamBitMap_Size(nruns), 1);
+	uint8	   *compress_bitmap = calloc(DatumStreamBitMap_Size(nruns), 1);
+	uint8	   *repeatcounts = malloc(nruns * Int32Compress_MaxByteLen);
+	uint8	   *repeatcountp = repeatcounts;
+	int32	   *datums = malloc(nruns * sizeof(int32));
+	int32		ndatums = 0;
+	int32		count = 0;
+
+	memset(dsr, 0, sizeof(DatumStreamBlockRead));
+	strncpy(dsr->eyecatcher, DatumStreamBlockRead_Eyecatcher, DatumStreamBlockRead_EyecatcherLen);
+	dsr->datumStreamVersion = DatumStreamVersion_Dense;
+	dsr->typeInfo.datumlen = 4;
+	dsr->typeInfo.typid = INT4OID;
+	dsr->typeInfo.byval = true;
+
+	for (int32 n = 0; n < nruns; n++)
+	{
+		if (RLE_RUN_IS_NULL(n, withNulls))
+		{
+			/* NULLs are never repeated */
+			null_bitmap[n / 8] |= 1 << (n % 8);
+			count++;
+			continue;
+		}
+
+		if (RLE_RUN_LENGTH(n) > 1)
+		{
+			compress_bitmap[ndatums / 8] |= 1 << (ndatums % 8);
+			repeatcountp += DatumStreamInt32Compress_Encode(repeatcountp,
+															RLE_RUN_LENGTH(n) - 1);
+		}
+		datums[ndatums++] = n * 10;
+		count += RLE_RUN_LENGTH(n);
+	}
+
+	dsr->nth = -1;
+	dsr->physical_datum_index = -1;
+	dsr->logical_row_count = count;
+	dsr->physical_datum_count = ndatums;
+	dsr->physical_data_size = ndatums * sizeof(int32);
+	dsr->has_null = withNulls;
+	if (withNulls)
+		DatumStreamBitMapRead_Init(&dsr->null_bitmap, null_bitmap, nruns);
+	dsr->null_bitmap_beginp = null_bitmap;
+	dsr->rle_block_was_compressed = true;
+	DatumStreamBitMapRead_Init(&dsr->rle_compress_bitmap, compress_bitmap, ndatums);
+	dsr->rle_compress_beginp = compress_bitmap;
+	dsr->rle_repeatcountsp = repeatcounts;
+	dsr->delta_beginp = repeatcounts;	/* so that it gets freed */
+	dsr->datum_beginp = (uint8 *) datums;
+	dsr->datum_afterp = (uint8 *) (datums + ndatums);
+	dsr->datump = dsr->datum_beginp;
+
+	return dsr;
+}
+
+static void
+free_int4_rle_block_read(DatumStreamBlockRead *dsr)
+{
+	free(dsr->rle_compress_beginp);
+	free(dsr->delta_beginp);
+	free_int4_block_read(dsr);
+}
+
+/*
+ * The RLE_TYPE runs come back as runs, also when a read ends in the middle
+ * of one, and batches expand them to the same items as reading them one at
+ * a time.
+ */
+static void
+test__DatumStreamBlockRead_GetRuns(bool withNulls)
+{
+	int32		nruns = 50;
+	DatumStreamBlockRead *dsr = make_int4_rle_block_read(nruns, withNulls);
+	DatumStreamBlockRead *expected = make_int4_rle_block_read(nruns, withNulls);
+	int32		count = dsr->logical_row_count;
+	Datum	   *values = malloc(count * sizeof(Datum));
+	bool	   *isnull = malloc(count * sizeof(bool));
+	int32	   *runLengths = malloc(count * sizeof(int32));
+	int32		nitems;
+	int32		n;
+
+	/* The first two items, the second being the first of run 1 */
+	assert_int_equal(DatumStreamBlockRead_GetRuns(dsr, 2, values, isnull,
+												  runLengths, &nitems), 2);
+	assert_int_equal(nitems, 2);
+	assert_int_equal(runLengths[0], 1);
+	assert_int_equal(runLengths[1], 1);
+	assert_int_equal(DatumStreamBlockRead_Remaining(dsr), count - 2);
+
+	/* The rest of run 1, then runs 2 up to the end */
+	n = DatumStreamBlockRead_GetRuns(dsr, count, values, isnull,
+									 runLengths, &nitems);
+	assert_int_equal(nitems, count - 2);
+	assert_int_equal(n, nruns - 1);
+	assert_int_equal(runLengths[0], RLE_RUN_LENGTH(1) - 1);
+	assert_int_equal(DatumGetInt32(values[0]), 10);
+	for (int32 i = 1; i < n; i++)
+	{
+		int32		run = i + 1;
+
+		if (RLE_RUN_IS_NULL(run, withNulls))
+		{
+			assert_true(isnull[i]);
+			assert_int_equal(runLengths[i], 1);
+		}
+		else
+		{
+			assert_false(isnull[i]);
+			assert_int_equal(DatumGetInt32(values[i]), run * 10);
+			assert_int_equal(runLengths[i], RLE_RUN_LENGTH(run));
+		}
+	}
+	assert_int_equal(DatumStreamBlockRead_Remaining(dsr), 0);
+	free_int4_rle_block_read(dsr);
+
+	/* Batches of awkward sizes, against one item at a time */
+	dsr = make_int4_rle_block_read(nruns, withNulls);
+	for (int32 first = 0; first < count; first += nitems)
+	{
+		nitems = DatumStreamBlockRead_GetBatch(dsr, 7, values, isnull);
+		assert_int_equal(nitems, Min(7, count - first));
+
+		for (int32 i = 0; i < nitems; i++)
+		{
+			Datum		value = 0;
+			bool		null;
+
+			assert_int_equal(DatumStreamBlockRead_Advance(expected), 1);
+			DatumStreamBlockRead_Get(expected, &value, &null);
+			assert_int_equal(isnull[i], null);
+			if (!null)
+				assert_int_equal(DatumGetInt32(values[i]), DatumGetInt32(value));
+		}
+	}
+	assert_int_equal(DatumStreamBlockRead_Advance(expected), 0);
+
+	free(values);
+	free(isnull);
+	free(runLengths);
+	free_int4_rle_block_read(dsr);
+	free_int4_rle_block_read(expected);
+}
+
+static void
+test__DatumStreamBlockRead_GetRuns__NoNulls(void **state)
+{
+	test__DatumStreamBlockRead_GetRuns(false);
+}
+
+static void
+test__DatumStreamBlockRead_GetRuns__Nulls(void **state)
+{
+	test__DatumStreamBlockRead_GetRuns(true);
+}
+
 int 
 main(int argc, char* argv[]) 
 {
 	cmockery_parse_arguments(argc, argv);
 
 	const UnitTest tests[] = {
-			unit_test(test__DeltaCompression__Core)
+			unit_test(test__DeltaCompression__Core),
+			unit_test(test__DatumStreamBlockRead_GetBatch__NoNulls),
+			unit_test(test__DatumStreamBlockRead_GetBatch__Nulls),
+			unit_test(test__DatumStreamBlockRead_GetRuns__NoNulls),
+			unit_test(test__DatumStreamBlockRead_GetRuns__Nulls)
 	};
 	return run_tests(tests);
 }
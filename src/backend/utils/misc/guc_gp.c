@@ -141,6 +141,10 @@ bool		gp_appendonly_verify_block_checksums = true;
 bool		gp_appendonly_verify_write_block = false;
 bool		gp_appendonly_compaction = true;
 int			gp_appendonly_compaction_threshold = 0;
+int			gp_appendonly_compaction_workers = 0;
+bool		gp_appendonly_enable_zonemaps = true;
+int			gp_appendonly_prefetch_depth = 4;
+int			gp_appendonly_scan_batch_size = 1024;
 bool		gp_heap_require_relhasoids_match = true;
 bool		gp_local_distributed_cache_stats = false;
 bool		debug_xlog_record_read = false;
@@ -223,7 +227,7 @@ bool		gp_resource_group_cpu_ceiling_enforcement;
 
 /* Metrics collector debug GUC */
 bool		vmem_process_interrupt = false;
-bool		execute_pruned_plan = false;
+bool		execute_pruned_plan = true;
 
 /* Upgrade & maintenance GUCs */
 bool		gp_maintenance_mode;
@@ -255,6 +259,8 @@ bool		gp_enable_preunique = true;
 bool		gp_enable_agg_distinct = true;
 bool		gp_enable_dqa_pruning = true;
 bool		gp_dynamic_partition_pruning = true;
+bool		gp_enable_runtime_filter = false;
+int			gp_runtime_filter_min_inner_rows = 1000;
 bool		gp_log_dynamic_partition_pruning = false;
 bool		gp_cte_sharing = false;
 bool		gp_enable_relsize_collection = false;
@@ -272,6 +278,8 @@ int			optimizer_minidump;
 int			optimizer_cost_model;
 bool		optimizer_metadata_caching;
 int			optimizer_mdcache_size;
+int			optimizer_plan_cache_size;
+int			optimizer_shared_mdcache_size;
 bool		optimizer_use_gpdb_allocators;
 
 /* Optimizer debugging GUCs */
@@ -630,6 +638,18 @@ struct config_bool ConfigureNamesBool_gp[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"gp_enable_runtime_filter", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enable Bloom filters on the join keys of hash joins "
+						 "to filter rows in scans on the probe side."),
+			gettext_noop("The filter is built from the inner side of an inner, "
+						 "semi or right hash join, and applied by a sequential "
+						 "scan that is the direct outer child of the join.")
+		},
+		&gp_enable_runtime_filter,
+		false,
+		NULL, NULL, NULL
+	},
 	{
 		{"debug_print_prelim_plan", PGC_USERSET, LOGGING_WHAT,
 			gettext_noop("Prints the preliminary execution plan to server log."),
@@ -872,6 +892,17 @@ struct config_bool ConfigureNamesBool_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_appendonly_enable_zonemaps", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Maintain and use per-block min/max summaries of append-only table columns."),
+			gettext_noop("Sequential scans skip the blocks whose summaries show that no row can "
+						 "satisfy the scan quals. Summaries are kept in the block directory.")
+		},
+		&gp_appendonly_enable_zonemaps,
+		true,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_heap_require_relhasoids_match", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Issue an error on discovery of a mismatch between relhasoids and a tuple header."),
@@ -2983,6 +3014,37 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_appendonly_compaction_workers", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Number of append-only segment files that vacuum compacts at once, each scanned by a background worker."),
+			gettext_noop("Zero compacts the segment files one after another, without background workers.")
+		},
+		&gp_appendonly_compaction_workers,
+		0, 0, 64,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_appendonly_prefetch_depth", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Number of large reads of append-only segment files to request in advance during sequential reads."),
+			gettext_noop("Overlaps the i/o of the next reads with the processing of the current one. "
+						 "Zero disables read-ahead.")
+		},
+		&gp_appendonly_prefetch_depth,
+		4, 0, 64,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_appendonly_scan_batch_size", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Maximum number of rows read at a time from the columns of append-optimized column-oriented tables during sequential scans."),
+			gettext_noop("Zero reads the columns one row at a time.")
+		},
+		&gp_appendonly_scan_batch_size,
+		1024, 0, 16384,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_workfile_max_entries", PGC_POSTMASTER, RESOURCES,
 			gettext_noop("Sets the maximum number of entries that can be stored in the workfile directory"),
@@ -3042,6 +3104,18 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_vmem_idle_resource_release_rounds", PGC_USERSET, CLIENT_CONN_OTHER,
+			gettext_noop("Sets the number of idle timeouts over which the gangs of an idle session are released."),
+			gettext_noop("Each gp_vmem_idle_resource_timeout of idleness releases a share of the idle QEs, "
+						 "the ones to be reused next are kept longest. A value of 1 releases all of them at once."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&IdleSessionGangReleaseRounds,
+		1, 1, 1000,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"xid_stop_limit", PGC_POSTMASTER, WAL,
 			gettext_noop("Sets the number of XIDs before XID wraparound at which we will no longer allow the system to be started."),
@@ -3410,6 +3484,20 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+#ifdef ENABLE_IC_PROXY
+	{
+		{"gp_interconnect_proxy_io_threads", PGC_POSTMASTER, GP_ARRAY_TUNING,
+			gettext_noop("Sets the number of ic-proxy I/O threads."),
+			gettext_noop("The peer connections are spread over the I/O threads, "
+						 "0 handles all of them in the ic-proxy main loop."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_interconnect_proxy_io_threads,
+		0, 0, 64,
+		NULL, NULL, NULL
+	},
+#endif  /* ENABLE_IC_PROXY */
+
 	{
 		{"gp_snapshotadd_timeout", PGC_USERSET, GP_ARRAY_TUNING,
 			gettext_noop("Timeout (in seconds) on setup of new connection snapshot"),
@@ -3572,6 +3660,19 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_runtime_filter_min_inner_rows", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Sets the minimum estimated number of inner rows for "
+						 "a hash join to build a runtime filter."),
+			gettext_noop("A runtime filter takes at least 1MB of the memory "
+						 "of the join, which is not worth it for small inner "
+						 "sides.")
+		},
+		&gp_runtime_filter_min_inner_rows,
+		1000, 0, INT_MAX,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_hashagg_default_nbatches", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Default number of batches for hashagg's (re-)spilling phases."),
@@ -3594,6 +3695,17 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_motion_batch_size", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Sets the number of tuples Redistribute and Broadcast Motions send in one columnar batch."),
+			gettext_noop("Batches are encoded column by column and compressed. "
+						 "Zero sends tuples one at a time.")
+		},
+		&gp_motion_batch_size,
+		0, 0, 65536,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_reject_percent_threshold", PGC_USERSET, GP_ERROR_HANDLING,
 			gettext_noop("Reject limit in percent starts calculating after this number of rows processed"),
@@ -3891,6 +4003,29 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"optimizer_plan_cache_size", PGC_USERSET, RESOURCES_MEM,
+			gettext_noop("Sets the size of the cache of plans produced by GPORCA."),
+			gettext_noop("Plans are reused for queries that differ only in "
+						 "their constants. 0 disables the cache."),
+			GUC_UNIT_KB
+		},
+		&optimizer_plan_cache_size,
+		0, 0, INT_MAX,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"optimizer_shared_mdcache_size", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the size of the GPORCA metadata cache shared by all sessions."),
+			gettext_noop("0 disables the shared cache."),
+			GUC_UNIT_KB
+		},
+		&optimizer_shared_mdcache_size,
+		0, 0, MAX_KILOBYTES,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"memory_profiler_dataset_size", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Set the size in GB"),
@@ -251,6 +251,8 @@ typedef struct SerializedSnapshotData
 	CommandId	curcid;
 	TimestampTz whenTaken;
 	XLogRecPtr	lsn;
+	bool		haveDistribSnapshot;	/* GP: followed by the distributed
+										 * snapshot, after the XID arrays */
 } SerializedSnapshotData;
 
 Size
@@ -2152,6 +2154,9 @@ EstimateSnapshotSpace(Snapshot snap)
 		(!snap->suboverflowed || snap->takenDuringRecovery))
 		size = add_size(size,
 						mul_size(snap->subxcnt, sizeof(TransactionId)));
+	if (snap->haveDistribSnapshot)
+		size = add_size(size,
+						DistributedSnapshot_SerializeSize(&snap->distribSnapshotWithLocalMapping.ds));
 
 	return size;
 }
@@ -2178,6 +2183,7 @@ SerializeSnapshot(Snapshot snapshot, char *start_address)
 	serialized_snapshot.curcid = snapshot->curcid;
 	serialized_snapshot.whenTaken = snapshot->whenTaken;
 	serialized_snapshot.lsn = snapshot->lsn;
+	serialized_snapshot.haveDistribSnapshot = snapshot->haveDistribSnapshot;
 
 	/*
 	 * Ignore the SubXID array if it has overflowed, unless the snapshot was
@@ -2211,6 +2217,16 @@ SerializeSnapshot(Snapshot snapshot, char *start_address)
 		memcpy((TransactionId *) (start_address + subxipoff),
 			   snapshot->subxip, snapshot->subxcnt * sizeof(TransactionId));
 	}
+
+	/* GP: Copy the distributed snapshot */
+	if (serialized_snapshot.haveDistribSnapshot)
+	{
+		Size		dsoff = sizeof(SerializedSnapshotData) +
+		(snapshot->xcnt + serialized_snapshot.subxcnt) * sizeof(TransactionId);
+
+		DistributedSnapshot_Serialize(&snapshot->distribSnapshotWithLocalMapping.ds,
+									  start_address + dsoff);
+	}
 }
 
 /*
@@ -2227,16 +2243,41 @@ RestoreSnapshot(char *start_address)
 	Size		size;
 	Snapshot	snapshot;
 	TransactionId *serialized_xids;
+	DistributedSnapshot ds;
+	Size		dsoff;
+	Size		dslmoff;
 
 	memcpy(&serialized_snapshot, start_address,
 		   sizeof(SerializedSnapshotData));
 	serialized_xids = (TransactionId *)
 		(start_address + sizeof(SerializedSnapshotData));
 
+	/*
+	 * GP: Read the distributed snapshot first, to know the size of its
+	 * in-progress array.
+	 */
+	memset(&ds, 0, sizeof(ds));
+	if (serialized_snapshot.haveDistribSnapshot)
+	{
+		ds.inProgressXidArray = (DistributedTransactionId *)
+			palloc(GetMaxSnapshotXidCount() * sizeof(DistributedTransactionId));
+		DistributedSnapshot_Deserialize((char *) (serialized_xids +
+												  serialized_snapshot.xcnt +
+												  serialized_snapshot.subxcnt),
+										&ds);
+	}
+
 	/* We allocate any XID arrays needed in the same palloc block. */
 	size = sizeof(SnapshotData)
 		+ serialized_snapshot.xcnt * sizeof(TransactionId)
 		+ serialized_snapshot.subxcnt * sizeof(TransactionId);
+	dsoff = dslmoff = size;
+	if (ds.count > 0)
+	{
+		size += ds.count * sizeof(DistributedTransactionId);
+		dslmoff = size;
+		size += ds.count * sizeof(TransactionId);
+	}
 
 	/* Copy all required fields */
 	snapshot = (Snapshot) MemoryContextAlloc(TopTransactionContext, size);
@@ -2270,6 +2311,30 @@ RestoreSnapshot(char *start_address)
 			   serialized_snapshot.subxcnt * sizeof(TransactionId));
 	}
 
+	/*
+	 * GP: Set up the distributed snapshot, like CopySnapshot() does. The
+	 * cache of local XIDs starts out empty.
+	 */
+	snapshot->haveDistribSnapshot = serialized_snapshot.haveDistribSnapshot;
+	snapshot->distribSnapshotWithLocalMapping.ds = ds;
+	snapshot->distribSnapshotWithLocalMapping.ds.inProgressXidArray = NULL;
+	snapshot->distribSnapshotWithLocalMapping.minCachedLocalXid = InvalidTransactionId;
+	snapshot->distribSnapshotWithLocalMapping.maxCachedLocalXid = InvalidTransactionId;
+	snapshot->distribSnapshotWithLocalMapping.currentLocalXidsCount = 0;
+	snapshot->distribSnapshotWithLocalMapping.inProgressMappedLocalXids = NULL;
+	if (ds.count > 0)
+	{
+		snapshot->distribSnapshotWithLocalMapping.ds.inProgressXidArray =
+			(DistributedTransactionId *) ((char *) snapshot + dsoff);
+		snapshot->distribSnapshotWithLocalMapping.inProgressMappedLocalXids =
+			(TransactionId *) ((char *) snapshot + dslmoff);
+		memcpy(snapshot->distribSnapshotWithLocalMapping.ds.inProgressXidArray,
+			   ds.inProgressXidArray,
+			   ds.count * sizeof(DistributedTransactionId));
+	}
+	if (ds.inProgressXidArray != NULL)
+		pfree(ds.inProgressXidArray);
+
 	/* Set the copied flag so that the caller will set refcounts correctly. */
 	snapshot->regd_count = 0;
 	snapshot->active_count = 0;
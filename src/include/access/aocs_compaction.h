@@ -20,7 +20,7 @@ struct AOCSVPInfo;
 extern void AOCSSegmentFileTruncateToEOF(Relation aorel, int segno, struct AOCSVPInfo *vpinfo);
 extern void AOCSCompaction_DropSegmentFile(Relation aorel, int segno);
 extern void AOCSCompact(Relation aorel,
-						int compaction_segno,
+						List *compaction_segnos,
 						int *insert_segno,
 						bool isFull,
 						List *avoid_segnos);
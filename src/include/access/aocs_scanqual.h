@@ -0,0 +1,83 @@
+/*------------------------------------------------------------------------------
+ *
+ * aocs_scanqual.h
+ *   quals of scans of append-only column oriented relations that are
+ *   evaluated on batches of column values.
+ *
+ * Copyright (c) 2022-Present VMware, Inc. or its affiliates.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/include/access/aocs_scanqual.h
+ *
+ *------------------------------------------------------------------------------
+ */
+#ifndef AOCS_SCANQUAL_H
+#define AOCS_SCANQUAL_H
+
+#include "access/attnum.h"
+#include "nodes/pg_list.h"
+#include "utils/relcache.h"
+
+/*
+ * How the values of the column of a qual are compared: int4 and date
+ * columns as 32-bit integers, int8 columns as 64-bit integers and float8
+ * columns as doubles.
+ */
+typedef enum AOCSScanQualType
+{
+	AOCSSCANQUAL_INT32,
+	AOCSSCANQUAL_INT64,
+	AOCSSCANQUAL_FLOAT8
+} AOCSScanQualType;
+
+typedef enum AOCSScanQualOp
+{
+	AOCSSCANQUAL_LT,
+	AOCSSCANQUAL_LE,
+	AOCSSCANQUAL_EQ,
+	AOCSSCANQUAL_GE,
+	AOCSSCANQUAL_GT,
+	AOCSSCANQUAL_NE,
+	AOCSSCANQUAL_IN				/* equal to any of the arguments */
+} AOCSScanQualOp;
+
+/*
+ * A qual comparing a column with constants. The arguments are in intArgs or
+ * floatArgs, depending on the type; all but AOCSSCANQUAL_IN have exactly
+ * one.
+ */
+typedef struct AOCSScanQual
+{
+	AttrNumber	attno;			/* zero based */
+	AOCSScanQualType type;
+	AOCSScanQualOp op;
+
+	int			nargs;
+	int64	   *intArgs;
+	float8	   *floatArgs;
+	bool		argsHaveNaN;	/* is any of the float arguments a NaN? */
+} AOCSScanQual;
+
+/* Number of uint64 words of a selection bitmap for nrows rows */
+#define AOCSScanQual_SelectionWords(nrows)	(((nrows) + 63) / 64)
+
+extern AOCSScanQual *AOCSScanQual_Build(Relation rel, List *qual,
+										int *numScanQuals);
+extern void AOCSScanQual_InitSelection(uint64 *selection, int nrows);
+extern void AOCSScanQual_EvalColumn(AOCSScanQual *scanQuals, int numScanQuals,
+									AttrNumber attno, Datum *values,
+									bool *isnull, int nrows,
+									uint64 *selection);
+extern void AOCSScanQual_EvalRuns(AOCSScanQual *scanQuals, int numScanQuals,
+								  AttrNumber attno, Datum *values,
+								  bool *isnull, int32 *runLengths, int nruns,
+								  uint64 *selection);
+extern bool AOCSScanQual_HasColumn(AOCSScanQual *scanQuals, int numScanQuals,
+								   AttrNumber attno);
+extern int	AOCSScanQual_CountSelected(uint64 *selection, int nrows);
+extern int	AOCSScanQual_Eval(AOCSScanQual *scanQuals, int numScanQuals,
+							  Datum **values, bool **isnull, int nrows,
+							  uint64 *selection);
+
+#endif   /* AOCS_SCANQUAL_H */
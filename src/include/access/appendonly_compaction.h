@@ -23,7 +23,7 @@
 
 extern void AppendOnlyRecycleDeadSegments(Relation aorel);
 extern void AppendOnlyCompact(Relation aorel,
-							  int compaction_segno,
+							  List *compaction_segnos,
 							  int *insert_segno,
 							  bool isFull,
 							  List *avoid_segnos);
@@ -34,6 +34,30 @@ extern bool AppendOnlyCompaction_ShouldCompact(
 								   bool isFull,
 								   Snapshot appendOnlyMetaDataSnapshot);
 extern void AppendOnlyThrowAwayTuple(Relation rel, TupleTableSlot *slot);
+extern struct EState *AppendOnlyCompaction_BeginMove(Relation aorel);
+extern void AppendOnlyCompaction_EndMove(struct EState *estate);
 extern void AppendOnlyTruncateToEOF(Relation aorel);
 
+extern void AppendOnlyCompaction_BeginProgress(Relation aorel, int64 totalBytes);
+extern void AppendOnlyCompaction_ReportProgress(int64 scannedBytes,
+												int64 compactedBytes,
+												int64 deadTuples);
+extern void AppendOnlyCompaction_EndProgress(void);
+extern void AppendOnlyCompaction_DelayPoint(int64 bytesRead, int64 bytesWritten);
+
+/* in appendonly_compaction_worker.c */
+typedef struct AppendOnlyCompactionWorkers AppendOnlyCompactionWorkers;
+
+extern AppendOnlyCompactionWorkers *AppendOnlyCompactionWorkers_Launch(Relation aorel,
+																	   int nsegs,
+																	   const int *segnos,
+																	   const int64 *eofs,
+																	   const int64 *tupcounts,
+																	   Snapshot snapshot);
+extern bool AppendOnlyCompactionWorkers_GetNext(AppendOnlyCompactionWorkers *workers,
+												TupleTableSlot *slot,
+												int *segindex);
+extern List *AppendOnlyCompactionWorkers_End(AppendOnlyCompactionWorkers *workers);
+extern void AppendOnlyCompactionWorkerMain(Datum main_arg);
+
 #endif
@@ -58,8 +58,23 @@ typedef struct AppendOnlyVisimap
 	 */
 	AppendOnlyVisimapStore visimapStore;
 
+	/*
+	 * Copies of the visibility map entries read so far, so that scans and
+	 * fetches moving back and forth between entries do not look them up and
+	 * decompress them again. Created on first use; not used by visimaps
+	 * that delete tuples.
+	 */
+	HTAB	   *entryCache;
+	Size		entryCacheSize;
+	bool		entryCacheDisabled;
+
 } AppendOnlyVisimap;
 
+/*
+ * Upper limit of the memory used by the entry cache of a visimap.
+ */
+#define APPENDONLY_VISIMAP_CACHE_MAX_SIZE (1024 * 1024)
+
 /*
  * Data structure to scan an ao visibility map.
  */
@@ -110,6 +125,13 @@ bool AppendOnlyVisimap_IsVisible(
 							AppendOnlyVisimap *visiMap,
 							AOTupleId *tupleId);
 
+int AppendOnlyVisimap_GetVisibility(
+							   AppendOnlyVisimap *visiMap,
+							   int segno,
+							   int64 firstRowNum,
+							   int nrows,
+							   bool *visible);
+
 void AppendOnlyVisimap_Finish(
 						 AppendOnlyVisimap *visiMap,
 						 LOCKMODE lockmode);
@@ -38,7 +38,7 @@ typedef struct AppendOnlyVisimapData
 	int32		_len;
 
 	/*
-	 * Version number for the VisiMap format. Currently only 1 is supported.
+	 * Version number for the VisiMap format, see below.
 	 */
 	int32		version;
 
@@ -46,6 +46,28 @@ typedef struct AppendOnlyVisimapData
 	unsigned char data[1];
 } AppendOnlyVisimapData;
 
+/*
+ * Formats of the bitmap data.
+ *
+ * APPENDONLY_VISIMAP_VERSION_BITMAP: the bitmap words, compressed with
+ * bitmap_compression.c.
+ *
+ * APPENDONLY_VISIMAP_VERSION_ROARING: a roaring bitmap container of the
+ * offsets of the hidden rows. An entry covers fewer than 65536 rows, so a
+ * single container holds all of them. After a header of two little-endian
+ * uint16s, the container type and the number of elements, follows either a
+ * sorted array of the offsets or a sorted array of (first offset, length - 1)
+ * pairs of runs of offsets. It is written when it is smaller than the
+ * compressed bitmap, i.e. for entries with few hidden rows or with long runs
+ * of them.
+ */
+#define APPENDONLY_VISIMAP_VERSION_BITMAP	1
+#define APPENDONLY_VISIMAP_VERSION_ROARING	2
+
+#define APPENDONLY_VISIMAP_ROARING_ARRAY	1
+#define APPENDONLY_VISIMAP_ROARING_RUN		2
+#define APPENDONLY_VISIMAP_ROARING_HEADER_SIZE (2 * sizeof(uint16))
+
 typedef struct AppendOnlyVisimapEntry
 {
 	/*
@@ -123,6 +145,12 @@ bool AppendOnlyVisimapEntry_IsVisible(
 								 AppendOnlyVisimapEntry *visiMapEntry,
 								 AOTupleId *aoTupleId);
 
+int AppendOnlyVisimapEntry_GetVisibility(
+									 AppendOnlyVisimapEntry *visiMapEntry,
+									 int64 rowNum,
+									 int nrows,
+									 bool *visible);
+
 TM_Result AppendOnlyVisimapEntry_HideTuple(
 								 AppendOnlyVisimapEntry *visiMapEntry,
 								 AOTupleId *aoTupleId);
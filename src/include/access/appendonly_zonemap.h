@@ -0,0 +1,144 @@
+/*------------------------------------------------------------------------------
+ *
+ * appendonly_zonemap.h
+ *   per-block min/max summaries of the columns of append-only relations.
+ *
+ * A zone map summarizes the values of a column in the rows covered by a
+ * block directory entry: the smallest and largest value and the number of
+ * NULLs. The summaries are maintained by the block directory alongside its
+ * entries, for columns of fixed-length pass-by-value types that have a btree
+ * comparison function. Sequential scans of append-only row and column
+ * oriented relations use them to skip the blocks whose rows cannot satisfy
+ * the quals of the scan, without reading or decompressing them.
+ *
+ * Copyright (c) 2022-Present VMware, Inc. or its affiliates.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/include/access/appendonly_zonemap.h
+ *
+ *------------------------------------------------------------------------------
+ */
+#ifndef APPENDONLY_ZONEMAP_H
+#define APPENDONLY_ZONEMAP_H
+
+#include "access/attnum.h"
+#include "access/stratnum.h"
+#include "access/tupdesc.h"
+#include "fmgr.h"
+#include "nodes/pg_list.h"
+#include "nodes/primnodes.h"
+#include "utils/relcache.h"
+#include "utils/snapshot.h"
+
+/*
+ * Flags of a zone map summary.
+ *
+ * AOZONEMAP_VALID is set once the values of a column are being recorded in
+ * the summary. A summary without it, e.g. one of a block directory entry
+ * built by CREATE INDEX, does not tell anything about the values.
+ *
+ * AOZONEMAP_HAS_MINMAX is set if any of the values is not NULL; min and max
+ * are only meaningful then.
+ */
+#define AOZONEMAP_VALID			0x0001
+#define AOZONEMAP_HAS_MINMAX	0x0002
+
+/*
+ * Summary of the values of a column in the rows of a block directory entry.
+ */
+typedef struct AOZoneMapSummary
+{
+	int32		flags;
+	int32		nnulls;
+	Datum		min;
+	Datum		max;
+} AOZoneMapSummary;
+
+/*
+ * How the values of a column are summarized.
+ */
+typedef struct AOZoneMapColumn
+{
+	bool		tracked;		/* is the column summarized at all? */
+	FmgrInfo	cmpproc;		/* btree comparison function of its type */
+	Oid			collation;
+} AOZoneMapColumn;
+
+/*
+ * A qual of a scan that zone maps can prove false for a block: a btree
+ * comparison of a column with a constant, or IS [NOT] NULL on a column.
+ */
+typedef struct AOZoneMapKey
+{
+	AttrNumber	attno;
+	StrategyNumber strategy;	/* InvalidStrategy for a NullTest */
+	NullTestType nulltesttype;
+	FmgrInfo	cmpproc;		/* compares a column value with argument */
+	Oid			collation;
+	Datum		argument;
+
+	/* summaries of the column in the current segment file */
+	struct AOZoneMapSegmentColumn *column;
+} AOZoneMapKey;
+
+/*
+ * Summaries of a column in the current segment file, in row number order.
+ */
+typedef struct AOZoneMapSegmentColumn
+{
+	AttrNumber	attno;
+	int			numEntries;
+	int			maxEntries;
+	int64	   *firstRowNums;
+	int64	   *rowCounts;
+	AOZoneMapSummary *summaries;
+} AOZoneMapSegmentColumn;
+
+/*
+ * Zone map state of a scan.
+ */
+typedef struct AppendOnlyZoneMap
+{
+	MemoryContext memoryContext;
+
+	Relation	aoRel;
+	Snapshot	appendOnlyMetaDataSnapshot;
+	bool		isAOCol;
+
+	Relation	blkdirRel;
+	Relation	blkdirIdx;
+
+	int			numKeys;
+	AOZoneMapKey *keys;
+
+	int			numColumns;
+	AOZoneMapSegmentColumn *columns;
+
+	/* statistics for EXPLAIN ANALYZE */
+	int64		blocksSeen;
+	int64		blocksSkipped;
+} AppendOnlyZoneMap;
+
+/* maintenance, used by the block directory */
+extern bool AppendOnlyZoneMap_InitColumns(TupleDesc tupdesc,
+										  AOZoneMapColumn *columns);
+extern void AppendOnlyZoneMap_AddValue(AOZoneMapColumn *column,
+									   AOZoneMapSummary *summary,
+									   Datum value, bool isnull);
+extern void AppendOnlyZoneMap_Merge(AOZoneMapColumn *column,
+									AOZoneMapSummary *summary,
+									AOZoneMapSummary *other);
+
+/* used by scans */
+extern AppendOnlyZoneMap *AppendOnlyZoneMap_Begin(Relation aoRel,
+												  Snapshot appendOnlyMetaDataSnapshot,
+												  List *qual,
+												  bool isAOCol);
+extern void AppendOnlyZoneMap_LoadSegmentFile(AppendOnlyZoneMap *zonemap,
+											  int segno);
+extern bool AppendOnlyZoneMap_SkipRows(AppendOnlyZoneMap *zonemap,
+									   int64 firstRowNum, int64 rowCount);
+extern void AppendOnlyZoneMap_End(AppendOnlyZoneMap *zonemap);
+
+#endif   /* APPENDONLY_ZONEMAP_H */
@@ -96,6 +96,38 @@ enum AOCSScanDescIdentifier
 	AOCSBITMAPSCANDATA		/* am private */
 };
 
+/*
+ * A batch of rows of a scan, returned by aocs_getnextbatch.
+ *
+ * The values of each projected column are returned as a vector, indexed by
+ * the zero based attribute number of the column; the vectors of the columns
+ * not projected are NULL. The rows of a batch all come from the same blocks
+ * of the columns, so pass-by-reference values point straight into the block
+ * buffers of the scan and are valid until the next batch is read. Rows that
+ * are not visible to the snapshot of the scan are not returned.
+ */
+typedef struct AOCSBatch
+{
+	int			maxRows;		/* capacity of the vectors */
+	int			nrows;			/* number of rows in the batch */
+	int			natts;
+
+	Datum	  **values;			/* [natts][maxRows] */
+	bool	  **isnull;			/* [natts][maxRows] */
+	AOTupleId  *tids;			/* [maxRows] */
+
+	/* rows satisfying the scan quals, see AOCSScanQual_Eval */
+	uint64	   *selection;		/* [AOCSScanQual_SelectionWords(maxRows)] */
+
+	/* a column read as runs of equal values, see datumstreamread_get_runs */
+	Datum	   *runValues;		/* [maxRows] */
+	bool	   *runIsnull;		/* [maxRows] */
+	int32	   *runLengths;		/* [maxRows] */
+
+	/* visibility of the rows, see AppendOnlyVisimap_GetVisibility */
+	bool	   *visible;		/* [maxRows] */
+} AOCSBatch;
+
 /*
  * Used for scan of appendoptimized column oriented relations, should be used in
  * the tableam api related code and under it.
@@ -180,6 +212,28 @@ typedef struct AOCSScanDescData
 	 */
 	AppendOnlyBlockDirectory *blockDirectory;
 	AppendOnlyVisimap visibilityMap;
+
+	/*
+	 * Zone maps of the scan quals, or NULL. Once a block of a column has
+	 * been skipped in the current segment file, the columns may have to be
+	 * realigned on the same row.
+	 */
+	AppendOnlyZoneMap *zonemap;
+	bool		zonemapSkipped;
+
+	/*
+	 * If set, aocs_getnext reads the rows in batches and returns them from
+	 * here one at a time; batchNextRow is the next row to return.
+	 */
+	AOCSBatch  *batch;
+	int			batchNextRow;
+
+	/*
+	 * Quals evaluated on the column vectors of each batch. Rows that do not
+	 * satisfy them are not returned.
+	 */
+	struct AOCSScanQual *scanQuals;
+	int			numScanQuals;
 } AOCSScanDescData;
 
 typedef AOCSScanDescData *AOCSScanDesc;
@@ -300,6 +354,8 @@ extern void aocs_rescan(AOCSScanDesc scan);
 extern void aocs_endscan(AOCSScanDesc scan);
 
 extern bool aocs_getnext(AOCSScanDesc scan, ScanDirection direction, TupleTableSlot *slot);
+extern AOCSBatch *aocs_create_batch(AOCSScanDesc scan, int maxRows);
+extern bool aocs_getnextbatch(AOCSScanDesc scan, AOCSBatch *batch);
 extern AOCSInsertDesc aocs_insert_init(Relation rel, int segno);
 extern void aocs_insert_values(AOCSInsertDesc idesc, Datum *d, bool *null, AOTupleId *aoTupleId);
 static inline void aocs_insert(AOCSInsertDesc idesc, TupleTableSlot *slot)
@@ -107,6 +107,10 @@ typedef struct AppendOnlyInsertDescData
 
 	/* The block directory for the appendonly relation. */
 	AppendOnlyBlockDirectory blockDirectory;
+
+	/* Deformed values of the inserted tuple, for the zone maps. */
+	Datum			*zonemapValues;
+	bool			*zonemapIsnull;
 } AppendOnlyInsertDescData;
 
 typedef AppendOnlyInsertDescData *AppendOnlyInsertDesc;
@@ -235,6 +239,19 @@ typedef struct AppendOnlyScanDescData
 	int			rs_cindex;		/* current tuple's index in tbmres->offsets */
 	struct AppendOnlyFetchDescData *aofetch;
 
+	/* Zone maps of the scan quals, or NULL */
+	AppendOnlyZoneMap *zonemap;
+
+	/*
+	 * Visibility of the rows of the current block, looked up from the
+	 * visibility map once per block. blockVisible is indexed by the row
+	 * number offset in the block, and only set if not all the rows are
+	 * visible.
+	 */
+	bool		blockAllVisible;
+	bool	   *blockVisible;
+	int			blockVisibleSize;
+
 }	AppendOnlyScanDescData;
 
 typedef AppendOnlyScanDescData *AppendOnlyScanDesc;
@@ -369,6 +386,11 @@ extern TableScanDesc appendonly_beginscan(Relation relation,
 										  int nkeys, struct ScanKeyData *key,
 										  ParallelTableScanDesc pscan,
 										  uint32 flags);
+extern TableScanDesc appendonly_beginscan_extractcolumns(Relation rel,
+														 Snapshot snapshot,
+														 List *targetlist,
+														 List *qual,
+														 uint32 flags);
 extern void appendonly_rescan(TableScanDesc scan, ScanKey key,
 								bool set_params, bool allow_strat,
 								bool allow_sync, bool allow_pagemode);
@@ -16,6 +16,7 @@
 
 #include "access/aosegfiles.h"
 #include "access/aocssegfiles.h"
+#include "access/appendonly_zonemap.h"
 #include "access/appendonlytid.h"
 #include "access/skey.h"
 #include "catalog/indexing.h"
@@ -51,6 +52,11 @@ typedef struct MinipageEntry
 
 /*
  * Define a varlena type for a minipage.
+ *
+ * A minipage of version MINIPAGE_VERSION_ZONEMAP carries the zone map
+ * summaries of its entries after the entry array: an int32 with the number
+ * of columns summarized per entry, followed by that many AOZoneMapSummary
+ * for each entry in turn.
  */
 typedef struct Minipage
 {
@@ -63,6 +69,9 @@ typedef struct Minipage
 	MinipageEntry entry[1];
 } Minipage;
 
+#define MINIPAGE_VERSION_ORIGINAL	0
+#define MINIPAGE_VERSION_ZONEMAP	1
+
 /*
  * Define the relevant info for a minipage for each
  * column group.
@@ -72,6 +81,17 @@ typedef struct MinipagePerColumnGroup
 	Minipage *minipage;
 	uint32 numMinipageEntries;
 	ItemPointerData tupleTid;
+
+	/*
+	 * Zone map summaries of the column group, numZoneMapColumns for each of
+	 * the first maxZoneMapEntries entries, and of the values added since the
+	 * last entry was inserted. numZoneMapColumns is 0 if the column group is
+	 * not summarized.
+	 */
+	int numZoneMapColumns;
+	uint32 maxZoneMapEntries;
+	AOZoneMapSummary *summaries;
+	AOZoneMapSummary *pendingSummaries;
 } MinipagePerColumnGroup;
 
 /*
@@ -81,6 +101,13 @@ typedef struct MinipagePerColumnGroup
 #define NUM_MINIPAGE_ENTRIES (((MaxHeapTupleSize)/8 - sizeof(HeapTupleHeaderData) - 64 * 3)\
 							  / sizeof(MinipageEntry))
 
+/*
+ * A minipage with zone map summaries may be larger, but must still fit on a
+ * page since it is never toasted. Column groups that are too wide for even
+ * one entry to fit are not summarized.
+ */
+#define MAX_ZONEMAP_MINIPAGE_SIZE ((MaxHeapTupleSize)/4)
+
 /*
  * Define a structure for the append-only relation block directory.
  */
@@ -95,6 +122,12 @@ typedef struct AppendOnlyBlockDirectory
 	bool isAOCol;
 	bool *proj; /* projected columns, used only if isAOCol = TRUE */
 
+	/*
+	 * How the values of each column are summarized in the zone maps, or NULL
+	 * if no zone maps are maintained.
+	 */
+	AOZoneMapColumn *zonemapColumns;
+
 	MemoryContext memoryContext;
 	
 	int				totalSegfiles;
@@ -201,6 +234,18 @@ extern bool AppendOnlyBlockDirectory_InsertEntry(
 	int64 fileOffset,
 	int64 rowCount,
 	bool addColAction);
+extern void AppendOnlyBlockDirectory_AddZoneMapValues(
+	AppendOnlyBlockDirectory *blockDirectory,
+	int columnGroupNo,
+	Datum *values,
+	bool *isnull);
+extern int AppendOnlyBlockDirectory_MinipageZoneMapColumns(
+	Minipage *minipage);
+extern void AppendOnlyBlockDirectory_MinipageZoneMapSummary(
+	Minipage *minipage,
+	int entryNo,
+	int columnNo,
+	AOZoneMapSummary *summary);
 extern bool AppendOnlyBlockDirectory_addCol_InsertEntry(
 	AppendOnlyBlockDirectory *blockDirectory,
 	int columnGroupNo,
@@ -79,6 +79,24 @@ typedef struct BufferedRead
 	bool				haveTemporaryLimitInEffect;
 	int64				temporaryLimitFileLen;
 
+	/*
+	 * Read-ahead support for sequential reading.
+	 *
+	 * Up to prefetchDepth large reads beyond the current one are requested
+	 * from the kernel in advance, so that they are read while the caller
+	 * processes the current one.  prefetchPosition is the file position up
+	 * to which read-ahead has been requested.
+	 */
+	int32				prefetchDepth;
+	int64				prefetchPosition;
+
+	/*
+	 * Statistics, kept across files: the number of large reads done, and
+	 * how many of them had been requested in advance.
+	 */
+	int64				largeReadCount;
+	int64				prefetchedReadCount;
+
 } BufferedRead;
 
 /*
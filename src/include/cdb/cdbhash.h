@@ -30,6 +30,21 @@ typedef enum
 	REDUCE_JUMP_HASH
 } CdbHashReduce;
 
+/*
+ * Hash function kernels, for hashing a batch of values without going
+ * through the function manager.  CDBHASH_KERNEL_GENERIC calls the hash
+ * function for each value.
+ */
+typedef enum
+{
+	CDBHASH_KERNEL_GENERIC = 0,
+	CDBHASH_KERNEL_INT2,
+	CDBHASH_KERNEL_INT4,
+	CDBHASH_KERNEL_INT8,
+	CDBHASH_KERNEL_OID,
+	CDBHASH_KERNEL_TEXT
+} CdbHashKernel;
+
 /*
  * Structure that holds Greenplum Database hashing information.
  */
@@ -43,6 +58,7 @@ typedef struct CdbHash
 
 	int			natts;
 	FmgrInfo   *hashfuncs;
+	CdbHashKernel *kernels;		/* kernel to use for each attribute */
 } CdbHash;
 
 /*
@@ -66,6 +82,17 @@ extern void cdbhash(CdbHash *h, int attno, Datum datum, bool isnull);
  */
 extern unsigned int cdbhashreduce(CdbHash *h);
 
+/*
+ * Batch versions of the above, for hashing n tuples at a time.  The
+ * resulting segment numbers are the same as with the row at a time
+ * functions.
+ */
+extern void cdbhashinitbatch(CdbHash *h, uint32 *hashes, int n);
+extern void cdbhashbatch(CdbHash *h, int attno, uint32 *hashes,
+						 Datum *datums, bool *isnulls, int n);
+extern void cdbhashreducebatch(CdbHash *h, uint32 *hashes,
+							   unsigned int *segs, int n);
+
 /*
  * Return a random segment number, for a randomly distributed policy.
  */
@@ -420,6 +420,15 @@ typedef struct MotionNodeEntry
 	 */
 	htup_fifo       ready_tuples;
 
+	/*
+	 * Max number of tuples per columnar batch, or 0 if this motion node sends
+	 * tuples one at a time.  When sending batches, tuples are collected in a
+	 * builder per route; the last one is for broadcast.
+	 */
+	int             batch_size;
+	int             num_batch_builders;
+	TupleBatchBuilder **batch_builders;
+
 	/*
 	 * Variable that records the total number of senders to this motion node.
 	 * This is expected to always be (number of qExecs).
@@ -457,6 +466,10 @@ typedef struct MotionNodeEntry
 	uint64          stat_tuples_available;  /* Total tuples awaiting receive. */
 	uint64          stat_tuples_available_hwm;              /* High-water-mark of this
 		* value. */
+
+	uint64          stat_batches_recvd;     /* Tuple batches received. */
+	uint64          stat_batch_bytes_recvd; /* Bytes of batch data received. */
+	uint64          stat_batch_raw_bytes_recvd;     /* Same, decompressed. */
 }       MotionNodeEntry;
 
 
@@ -52,7 +52,7 @@ extern MotionLayerState *createMotionLayerState(int maxMotNodeID);
 
 /* Initialization of each motion node in execution plan. */
 extern void UpdateMotionLayerNode(MotionLayerState *mlStates, int16 motNodeID, bool preserveOrder,
-								  TupleDesc tupDesc);
+								  TupleDesc tupDesc, int batchSize);
 
 /* Cleanup of each motion node in execution plan (normal termination). */
 extern void EndMotionLayerNode(MotionLayerState *mlStates, int16 motNodeID, bool flushCommLayer);
@@ -129,6 +129,13 @@ extern void SendStopMessage(MotionLayerState *mlStates,
 extern void UpdateMotionExpectedReceivers(MotionLayerState *mlStates,
 										  struct SliceTable *sliceTable);
 
+/*
+ * Return the number of columnar tuple batches a motion node has received,
+ * and their size on the wire and once decompressed.
+ */
+extern void GetMotionBatchStats(MotionLayerState *mlStates, int16 motNodeID,
+								uint64 *batches, uint64 *bytes, uint64 *rawBytes);
+
 /*
  * Return a pointer to the internal "end-of-stream" message
  */
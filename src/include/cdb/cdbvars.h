@@ -288,6 +288,7 @@ typedef enum GpVars_Interconnect_Type
 extern int Gp_interconnect_type;
 
 extern char *gp_interconnect_proxy_addresses;
+extern int	gp_interconnect_proxy_io_threads;	/* count of ic-proxy I/O threads */
 
 typedef enum GpVars_Interconnect_Method
 {
@@ -597,6 +598,18 @@ extern bool trace_sort;
  */
 extern bool gp_dynamic_partition_pruning;
 
+/*
+ * Filter the rows of a scan on the outer side of a hash join with a Bloom
+ * filter of the join keys of the inner side.
+ */
+extern bool gp_enable_runtime_filter;
+
+/*
+ * Minimum estimated number of rows on the inner side of a hash join for it
+ * to build a runtime filter.
+ */
+extern int gp_runtime_filter_min_inner_rows;
+
 /* Sharing of plan fragments for common table expressions */
 extern bool gp_cte_sharing;
 /* Enable RECURSIVE clauses in common table expressions */
@@ -628,6 +641,15 @@ extern bool     gp_eager_two_phase_agg;
 /* Analyze tools */
 extern int gp_motion_slice_noop;
 
+/*
+ * gp_motion_batch_size
+ *
+ * Redistribute and Broadcast Motions collect up to this many tuples per
+ * receiver into a columnar, compressed batch before sending them.  Zero
+ * sends tuples one at a time.
+ */
+extern int gp_motion_batch_size;
+
 /* Disable setting of hint-bits while reading db pages */
 extern bool gp_disable_tuple_hints;
 
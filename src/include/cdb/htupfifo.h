@@ -23,6 +23,7 @@
 
 #include "access/htup.h"
 #include "access/memtup.h"
+#include "cdb/tupbatch.h"
 
 /* An entry in the HeapTuple FIFO.	Entries are formed into queues. */
 typedef struct htf_entry_data
@@ -30,6 +31,9 @@ typedef struct htf_entry_data
 	/* The tuple itself. */
 	MinimalTuple tup;
 
+	/* Or a batch of tuples, which are formed as they are retrieved. */
+	TupleBatchReader *batch;
+
 	/* The next entry in the FIFO. */
 	struct htf_entry_data *p_next;
 
@@ -52,6 +56,7 @@ extern htup_fifo htfifo_create(void);
 extern void htfifo_destroy(htup_fifo htf);
 
 extern void htfifo_addtuple(htup_fifo htf, MinimalTuple htup);
+extern void htfifo_addbatch(htup_fifo htf, TupleBatchReader *batch);
 extern MinimalTuple htfifo_gettuple(htup_fifo htf);
 
 #endif   /* HTUPFIFO_H */
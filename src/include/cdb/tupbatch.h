@@ -0,0 +1,52 @@
+/*-------------------------------------------------------------------------
+ * tupbatch.h
+ *	   Columnar batches of tuples for Motion.
+ *
+ * A Motion that sends batches collects the tuples for each route in a
+ * TupleBatchBuilder.  Once enough tuples are collected, the batch is
+ * encoded column by column, each column with the smallest of a plain,
+ * run-length or dictionary encoding, and the result is compressed.  The
+ * receiver keeps the encoded batch in a TupleBatchReader, and forms the
+ * tuples one at a time as they are fetched.
+ *
+ * Portions Copyright (c) 2012-Present VMware, Inc. or its affiliates.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/include/cdb/tupbatch.h
+ *-------------------------------------------------------------------------
+ */
+#ifndef TUPBATCH_H
+#define TUPBATCH_H
+
+#include "access/htup.h"
+#include "executor/tuptable.h"
+#include "lib/stringinfo.h"
+
+struct SerTupInfo;
+
+/*
+ * A batch is sent when it holds this many bytes of column data, even if it
+ * has fewer tuples than requested.
+ */
+#define TUPLE_BATCH_MAX_BYTES	(256 * 1024)
+
+typedef struct TupleBatchBuilder TupleBatchBuilder;
+typedef struct TupleBatchReader TupleBatchReader;
+
+extern TupleBatchBuilder *TupleBatchCreateBuilder(struct SerTupInfo *pSerInfo);
+extern void TupleBatchAddTuple(TupleBatchBuilder *builder, TupleTableSlot *slot);
+extern int	TupleBatchNumTuples(TupleBatchBuilder *builder);
+extern Size TupleBatchDataSize(TupleBatchBuilder *builder);
+extern void TupleBatchEncode(TupleBatchBuilder *builder, StringInfo buf,
+							 int *rawlen);
+
+extern TupleBatchReader *TupleBatchCreateReader(struct SerTupInfo *pSerInfo,
+												const char *data, int len,
+												int ntuples, int rawlen);
+extern int	TupleBatchReaderNumTuples(TupleBatchReader *reader);
+extern int	TupleBatchReaderDataSize(TupleBatchReader *reader, int *rawlen);
+extern MinimalTuple TupleBatchNext(TupleBatchReader *reader);
+extern void TupleBatchFreeReader(TupleBatchReader *reader);
+
+#endif   /* TUPBATCH_H */
@@ -17,6 +17,7 @@
 #include "access/heapam.h"
 #include "cdb/tupchunklist.h"
 #include "lib/stringinfo.h"
+#include "cdb/tupbatch.h"
 #include "cdb/tupleremap.h"
 
 
@@ -84,9 +85,14 @@ extern void SerializeRecordCacheIntoChunks(SerTupInfo *pSerInfo,
 /* Convert a tuple into chunks directly in a set of transport buffers */
 extern int SerializeTuple(TupleTableSlot *tuple, SerTupInfo *pSerInfo, struct directTransportBuffer *b, TupleChunkList tcList, int16 targetRoute);
 
+/* Convert a batch of tuples into chunks ready to send out */
+extern void SerializeTupleBatch(TupleBatchBuilder *builder, SerTupInfo *pSerInfo,
+								TupleChunkList tcList);
+
 /* Convert a sequence of chunks containing serialized tuple data into a
- * MinimalTuple.
+ * MinimalTuple, or a batch of them.
  */
-extern MinimalTuple CvtChunksToTup(TupleChunkList tclist, SerTupInfo *pSerInfo, TupleRemapper *remapper);
+extern MinimalTuple CvtChunksToTup(TupleChunkList tclist, SerTupInfo *pSerInfo, TupleRemapper *remapper,
+								   TupleBatchReader **batch);
 
 #endif   /* TUPSER_H */
@@ -33,6 +33,7 @@
 #define PROGRESS_VACUUM_PHASE_INDEX_CLEANUP		4
 #define PROGRESS_VACUUM_PHASE_TRUNCATE			5
 #define PROGRESS_VACUUM_PHASE_FINAL_CLEANUP		6
+#define PROGRESS_VACUUM_PHASE_AO_COMPACT		7	/* GPDB: append-optimized tables */
 
 /* Progress parameters for cluster */
 #define PROGRESS_CLUSTER_COMMAND				0
@@ -396,6 +396,9 @@ typedef struct HashJoinTableData
     HashJoinState * hjstate; /* reference to the enclosing HashJoinState */
     bool first_pass; /* Is this the first pass (pre-rescan) */
 
+	/* CDB: Bloom filter of the inner hash values for hjstate's runtime filter */
+	struct bloom_filter *bloom;
+
 	/* used for dense allocation of tuples (into linked chunks) */
 	HashMemoryChunk chunks;		/* one list for the whole batch */
 
@@ -36,6 +36,9 @@ public:
 	// serialize planned statement into DXL
 	static char *SerializeDXLPlan(Query *query);
 
+	// plan cache hit and miss counters
+	static void GetPlanCacheStats(uint64 *hits, uint64 *misses);
+
 	// gpopt initialize and terminate
 	static void InitGPOPT();
 
@@ -47,6 +50,7 @@ extern "C" {
 extern PlannedStmt *GPOPTOptimizedPlan(Query *query,
 									   bool *had_unexpected_failure);
 extern char *SerializeDXLPlan(Query *query);
+extern void GPOPTPlanCacheStats(uint64 *hits, uint64 *misses);
 extern void InitGPOPT();
 extern void TerminateGPOPT();
 }
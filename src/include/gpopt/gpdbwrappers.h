@@ -22,6 +22,7 @@ extern "C" {
 #include "parser/parse_coerce.h"
 #include "utils/faultinjector.h"
 #include "utils/lsyscache.h"
+#include "utils/shared_mdcache.h"
 }
 
 #include "gpos/types.h"
@@ -717,6 +718,22 @@ FaultInjectorType_e InjectFaultInOptTasks(const char *fault_name);
 // table has been changed?)
 bool MDCacheNeedsReset(void);
 
+// Can the current transaction use the metadata cache shared by all backends?
+bool IsSharedMDCacheEnabled(void);
+
+// generation of the shared metadata cache, after processing pending
+// invalidation messages
+uint64 GetSharedMDCacheGeneration(void);
+
+// look up a serialized metadata object in the shared metadata cache
+char *LookupSharedMDCache(const char *key, Size *len);
+
+// add a serialized metadata object, translated from the given catalog
+// object, to the shared metadata cache
+void InsertSharedMDCache(const char *key, uint64 generation, const char *data,
+						 Size len, SharedMDCacheObjType objtype, Oid relid,
+						 Oid objid);
+
 // returns true if a query cancel is requested in GPDB
 bool IsAbortRequested(void);
 
@@ -18,8 +18,8 @@
 #define GPDXL_CDXLTranslateContext_H
 
 #include "gpos/base.h"
-#include "gpos/common/CHashMap.h"
-#include "gpos/common/CHashMapIter.h"
+#include "gpos/common/COpenHashMap.h"
+#include "gpos/common/COpenHashMapIter.h"
 
 #include "gpopt/translate/CMappingElementColIdParamId.h"
 
@@ -32,19 +32,21 @@ namespace gpdxl
 using namespace gpos;
 
 // hash maps mapping ULONG -> TargetEntry
-typedef CHashMap<ULONG, TargetEntry, gpos::HashValue<ULONG>,
-				 gpos::Equals<ULONG>, CleanupDelete<ULONG>, CleanupNULL>
+typedef COpenHashMap<ULONG, TargetEntry, gpos::HashValue<ULONG>,
+					 gpos::Equals<ULONG>, CleanupDelete<ULONG>, CleanupNULL>
 	ULongToTargetEntryMap;
 
 // hash maps mapping ULONG -> CMappingElementColIdParamId
-typedef CHashMap<ULONG, CMappingElementColIdParamId, gpos::HashValue<ULONG>,
-				 gpos::Equals<ULONG>, CleanupDelete<ULONG>,
-				 CleanupRelease<CMappingElementColIdParamId> >
+typedef COpenHashMap<ULONG, CMappingElementColIdParamId,
+					 gpos::HashValue<ULONG>, gpos::Equals<ULONG>,
+					 CleanupDelete<ULONG>,
+					 CleanupRelease<CMappingElementColIdParamId> >
 	ULongToColParamMap;
 
-typedef CHashMapIter<ULONG, CMappingElementColIdParamId, gpos::HashValue<ULONG>,
-					 gpos::Equals<ULONG>, CleanupDelete<ULONG>,
-					 CleanupRelease<CMappingElementColIdParamId> >
+typedef COpenHashMapIter<ULONG, CMappingElementColIdParamId,
+						 gpos::HashValue<ULONG>, gpos::Equals<ULONG>,
+						 CleanupDelete<ULONG>,
+						 CleanupRelease<CMappingElementColIdParamId> >
 	ULongToColParamMapIter;
 
 
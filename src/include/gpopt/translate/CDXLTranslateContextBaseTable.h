@@ -20,7 +20,7 @@
 
 
 #include "gpos/base.h"
-#include "gpos/common/CHashMap.h"
+#include "gpos/common/COpenHashMap.h"
 
 extern "C" {
 #include "postgres.h"  // Index
@@ -45,8 +45,9 @@ using namespace gpos;
 class CDXLTranslateContextBaseTable
 {
 	// hash maps mapping ULONG -> INT
-	typedef CHashMap<ULONG, INT, gpos::HashValue<ULONG>, gpos::Equals<ULONG>,
-					 CleanupDelete<ULONG>, CleanupDelete<INT> >
+	typedef COpenHashMap<ULONG, INT, gpos::HashValue<ULONG>,
+						 gpos::Equals<ULONG>, CleanupDelete<ULONG>,
+						 CleanupDelete<INT> >
 		UlongToIntMap;
 
 
@@ -20,8 +20,8 @@
 #define GPDXL_CMappingVarColId_H
 
 
-#include "gpos/common/CHashMap.h"
-#include "gpos/common/CHashMapIter.h"
+#include "gpos/common/COpenHashMap.h"
+#include "gpos/common/COpenHashMapIter.h"
 
 #include "gpopt/translate/CGPDBAttInfo.h"
 #include "gpopt/translate/CGPDBAttOptCol.h"
@@ -80,13 +80,13 @@ private:
 	CMemoryPool *m_mp;
 
 	// hash map structure to store gpdb att -> opt col information
-	typedef CHashMap<CGPDBAttInfo, CGPDBAttOptCol, HashGPDBAttInfo,
-					 EqualGPDBAttInfo, CleanupRelease, CleanupRelease>
+	typedef COpenHashMap<CGPDBAttInfo, CGPDBAttOptCol, HashGPDBAttInfo,
+						 EqualGPDBAttInfo, CleanupRelease, CleanupRelease>
 		GPDBAttOptColHashMap;
 
 	// iterator
-	typedef CHashMapIter<CGPDBAttInfo, CGPDBAttOptCol, HashGPDBAttInfo,
-						 EqualGPDBAttInfo, CleanupRelease, CleanupRelease>
+	typedef COpenHashMapIter<CGPDBAttInfo, CGPDBAttOptCol, HashGPDBAttInfo,
+							 EqualGPDBAttInfo, CleanupRelease, CleanupRelease>
 		GPDBAttOptColHashMapIter;
 
 	// map from gpdb att to optimizer col
@@ -15,44 +15,37 @@
 #define GPDXL_CMemoryPoolPalloc_H
 
 #include "gpos/base.h"
-#include "gpos/memory/CMemoryPool.h"
+#include "gpos/memory/CMemoryPoolArena.h"
 
 namespace gpos
 {
 // Memory pool that maps to a Postgres MemoryContext.
-class CMemoryPoolPalloc : public CMemoryPool
+//
+// Objects are carved out of slabs allocated in the memory context, so the
+// error handling wrapper around palloc is entered once per slab rather than
+// once per object. Freed objects are recycled by the arena, and deleting the
+// memory context on tear down releases all slabs at once.
+class CMemoryPoolPalloc : public CMemoryPoolArena
 {
 private:
 	MemoryContext m_cxt{nullptr};
 
-	// When destroying arrays, we need to call the destructor of each element
-	// To do this, we need the size of the allocation, which we then divide by the
-	// the size of the element to get number of elements to iterate through.
-	// This struct is only used for array allocations (GPOS_NEW_ARRAY())
-	struct SArrayAllocHeader
-	{
-		ULONG m_user_size;
-	};
+protected:
+	// allocate slab in the memory context
+	void *AllocSlab(ULONG bytes) override;
+
+	// free slab allocated in the memory context
+	void FreeSlab(void *slab) override;
 
 public:
 	// ctor
 	CMemoryPoolPalloc();
 
-	// allocate memory
-	void *NewImpl(const ULONG bytes, const CHAR *file, const ULONG line,
-				  CMemoryPool::EAllocationType eat) override;
-
-	// free memory
-	static void DeleteImpl(void *ptr, CMemoryPool::EAllocationType eat);
-
 	// prepare the memory pool to be deleted
 	void TearDown() override;
 
 	// return total allocated size include management overhead
 	ULLONG TotalAllocatedSize() const override;
-
-	// get user requested size of allocation
-	static ULONG UserSizeOfAlloc(const void *ptr);
 };
 }  // namespace gpos
 
@@ -127,6 +127,18 @@ private:
 	static COptimizerConfig *CreateOptimizerConfig(CMemoryPool *mp,
 												   ICostModel *cost_model);
 
+	// check if a query reads any partitioned table
+	static BOOL HasPartitionedTables(CMDAccessor *mda,
+									 const CDXLNode *dxlnode);
+
+	// serialize the key under which the plan of a query is cached, and
+	// collect the query constants to bind into it
+	static CWStringDynamic *CreatePlanCacheKey(
+		CMemoryPool *mp, CMDAccessor *mda, COptimizerConfig *optimizer_config,
+		ULONG num_segments, CDXLNode *query_dxl,
+		const CDXLNodeArray *query_output_dxlnode_array,
+		CDXLNodeArray *cte_dxlnode_array, CDXLNodeArray *query_consts);
+
 	// optimize a query to a physical DXL
 	static void *OptimizeTask(void *ptr);
 
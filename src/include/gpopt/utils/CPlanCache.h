@@ -0,0 +1,190 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2022 VMware, Inc. or its affiliates.
+//
+//	@filename:
+//		CPlanCache.h
+//
+//	@doc:
+//		Cache of optimized plans, shared by all queries of a backend
+//
+//---------------------------------------------------------------------------
+
+#ifndef GPDXL_CPlanCache_H
+#define GPDXL_CPlanCache_H
+
+#include "gpos/base.h"
+#include "gpos/common/CRefCount.h"
+#include "gpos/memory/CCache.h"
+#include "gpos/memory/CCacheAccessor.h"
+#include "gpos/string/CWStringBase.h"
+
+#include "naucrates/dxl/operators/CDXLNode.h"
+
+namespace gpdxl
+{
+using namespace gpos;
+
+//---------------------------------------------------------------------------
+//	@class:
+//		CPlanCache
+//
+//	@doc:
+//		Maps the serialized DXL of a query, together with the optimizer
+//		configuration it was optimized under, to the serialized DXL of the
+//		plan ORCA produced for it.
+//
+//		The constants of the query are masked in the key, so that queries
+//		differing only in their constants share a plan. Each cached plan
+//		records which of its constants came from which query constant, and
+//		the constants of the query being planned are bound into it on
+//		lookup. Plans whose constants cannot be traced back to the query
+//		unambiguously, or whose shape depends on the values of constants,
+//		are not cached: directly dispatched plans, and the plans of queries
+//		on partitioned tables, whose partitions are eliminated statically.
+//
+//		Entries are not tied to individual metadata objects; the whole
+//		cache is reset whenever the metadata cache is, i.e. on any catalog
+//		change reported by gpdb::MDCacheNeedsReset().
+//
+//---------------------------------------------------------------------------
+class CPlanCache
+{
+private:
+	// cache key: serialized query and optimizer configuration
+	struct SPlanCacheKey
+	{
+		// serialized query
+		WCHAR *m_key;
+
+		// length of serialized query
+		ULONG m_length;
+
+		// hash value of serialized query
+		ULONG m_hash;
+
+		// hash function for cache lookups
+		static ULONG HashValue(SPlanCacheKey *const &key);
+
+		// equality function for cache lookups
+		static BOOL Equals(SPlanCacheKey *const &left,
+						   SPlanCacheKey *const &right);
+	};
+
+	// cached value: serialized plan and the bindings of its constants;
+	// cache entries hold a reference to it
+	class CPlanCacheVal : public CRefCount
+	{
+	public:
+		// serialized plan
+		CHAR *m_plan_dxl;
+
+		// for each constant of the plan, in the order CollectConsts()
+		// finds them, the position of the query constant it takes its
+		// value from, or gpos::ulong_max if it is kept as is
+		ULONG *m_const_bindings;
+
+		// number of constants of the plan
+		ULONG m_num_consts;
+
+		// ctor
+		CPlanCacheVal(CHAR *plan_dxl, ULONG *const_bindings,
+					  ULONG num_consts)
+			: m_plan_dxl(plan_dxl),
+			  m_const_bindings(const_bindings),
+			  m_num_consts(num_consts)
+		{
+		}
+
+		// dtor
+		~CPlanCacheVal() override
+		{
+			GPOS_DELETE_ARRAY(m_plan_dxl);
+			GPOS_DELETE_ARRAY(m_const_bindings);
+		}
+	};
+
+	typedef CCache<CPlanCacheVal *, SPlanCacheKey *> PlanCache;
+
+	typedef CCacheAccessor<CPlanCacheVal *, SPlanCacheKey *>
+		PlanCacheAccessor;
+
+	// global instance
+	static PlanCache *m_cache;
+
+	// maximum size of the cache
+	static ULLONG m_cache_quota;
+
+	// number of lookups that found, and did not find, a plan
+	static ULLONG m_hits;
+	static ULLONG m_misses;
+
+	// bind the constants of the plan to the given query constants; return
+	// NULL if the plan cannot be reused for other values of them
+	static ULongPtrArray *CreateConstBindings(
+		CMemoryPool *mp, CDXLNode *plan_dxl,
+		const CDXLNodeArray *query_consts);
+
+public:
+	// initialize global instance
+	static void Init(ULLONG cache_quota);
+
+	// destroy global instance
+	static void Shutdown();
+
+	// reset cache
+	static void Reset();
+
+	// check if global instance has been initialized
+	static BOOL
+	FInitialized()
+	{
+		return (nullptr != m_cache);
+	}
+
+	// set the maximum size of the cache
+	static void SetCacheQuota(ULLONG cache_quota);
+
+	// get the maximum size of the cache
+	static ULLONG
+	GetCacheQuota()
+	{
+		return m_cache_quota;
+	}
+
+	// collect the scalar constants of a DXL tree, depth first, as the nodes
+	// they are children of and their positions among those children
+	static void CollectConsts(CMemoryPool *mp, CDXLNode *dxlnode,
+							  CDXLNodeArray *parents,
+							  ULongPtrArray *positions);
+
+	// find plan cached for the given key, parsed in the given memory pool,
+	// with the given query constants bound into it
+	static CDXLNode *Lookup(CMemoryPool *mp, const CWStringBase *key,
+							const CDXLNodeArray *query_consts);
+
+	// cache plan for the given key, unless it cannot be reused for other
+	// values of the given query constants
+	static void Insert(CMemoryPool *mp, const CWStringBase *key,
+					   CDXLNode *plan_dxl, const CDXLNodeArray *query_consts,
+					   ULLONG plan_id, ULLONG plan_space_size);
+
+	// number of lookups that found a plan
+	static ULLONG
+	Hits()
+	{
+		return m_hits;
+	}
+
+	// number of lookups that did not find a plan
+	static ULLONG
+	Misses()
+	{
+		return m_misses;
+	}
+};
+}  // namespace gpdxl
+
+#endif	// !GPDXL_CPlanCache_H
+
+// EOF
@@ -1473,6 +1473,34 @@ typedef struct ScanState
 	TupleTableSlot *ss_ScanTupleSlot;
 } ScanState;
 
+/* ----------------
+ *	 RuntimeFilter information
+ *
+ *		CDB: A Bloom filter of the hash values of the inner rows of a hash
+ *		join, shared by the HashJoinState and the SeqScanState on its outer
+ *		side.  The scan computes the hash value of its rows from the join
+ *		keys the same way the hash join does for outer rows, and discards
+ *		rows whose hash value is not in the filter, as they cannot find a
+ *		match.  bloom is only set from the time the hash table has been
+ *		built until it is destroyed.  The scan counts the rows it discards
+ *		in nfiltered2 of its instrumentation.
+ *
+ *		bloom					filter of inner hash values, or NULL
+ *		nkeys					number of join keys
+ *		attnos					scan relation attribute of each join key
+ *		hashfunctions			outer hash function of each join key
+ *		collations				collation of each join key
+ * ----------------
+ */
+typedef struct RuntimeFilter
+{
+	struct bloom_filter *bloom;
+	int			nkeys;
+	AttrNumber *attnos;
+	FmgrInfo   *hashfunctions;
+	Oid		   *collations;
+} RuntimeFilter;
+
 /* ----------------
  *	 SeqScanState information
  * ----------------
@@ -1481,6 +1509,7 @@ typedef struct SeqScanState
 {
 	ScanState	ss;				/* its first field is NodeTag */
 	Size		pscan_len;		/* size of parallel heap scan descriptor */
+	RuntimeFilter *runtime_filter;	/* CDB: filter from a hash join, or NULL */
 } SeqScanState;
 
 /* ----------------
@@ -2118,6 +2147,7 @@ typedef struct MergeJoinState
  *		hj_MatchedOuter			true if found a join match for current outer
  *		hj_OuterNotEmpty		true if outer relation known not empty
  *		hj_nonequijoin			true to force hash table to keep nulls
+ *		hj_RuntimeFilter		CDB: filter passed to the outer scan, or NULL
  * ----------------
  */
 
@@ -2152,6 +2182,7 @@ typedef struct HashJoinState
 	bool		prefetch_joinqual;
 	bool		prefetch_qual;
 	bool		hj_nonequijoin;
+	RuntimeFilter *hj_RuntimeFilter;
 
 	/* set if the operator created workfiles */
 	bool workfiles_created;
@@ -2736,6 +2767,18 @@ typedef struct MotionState
 	struct CdbHash *cdbhash;	/* hash api object */
 	int			numHashSegments;	/* number of segments to use when calculating hash */
 
+	/*
+	 * For hash motion send: a batch of tuples from the child, whose target
+	 * segments are computed together.
+	 */
+	int			numHashBatch;	/* number of tuples in the batch */
+	TupleTableSlot **hashBatchSlots;	/* the tuples of the batch */
+	TupleTableSlot **hashBatchCopies;	/* slots to hold copies of them in */
+	Datum	   *hashBatchValues;	/* values of a hash key for each tuple */
+	bool	   *hashBatchIsnull;
+	uint32	   *hashBatchHashes;
+	unsigned int *hashBatchSegs;
+
 	/* For Motion recv */
 	int			routeIdNext;	/* for a sorted motion node, the routeId to get next (same as
 								 * the routeId last returned ) */
@@ -156,6 +156,13 @@ typedef struct PlannedStmt
  	 * GPDB: whether a query is a SPI inner query for extension usage 
  	 */
 	int8		metricsQueryType;
+
+	/*
+	 * GPDB: set by the dispatcher when the plan only contains the part of it
+	 * that the receiving slice runs. The QE must then eliminate the other
+	 * slices' nodes, as they are not there.
+	 */
+	bool		slicePruned;
 } PlannedStmt;
 
 /*
@@ -989,6 +996,11 @@ typedef struct MergeJoin
  *		a match.  This is normally identical to hashclauses (which holds the
  *		equality test), but differs in case of non-equijoin comparisons.
  *		Field hashclauses is retained for use in hash table operations.
+ *
+ * CDB:	If runtimeFilter is set, the executor builds a Bloom filter of the
+ *		hash values of the inner rows, and passes it down to a scan on the
+ *		outer side to discard rows that cannot find a match.  Only set for
+ *		join types that discard unmatched outer rows.
  * ----------------
  */
 typedef struct HashJoin
@@ -996,6 +1008,7 @@ typedef struct HashJoin
 	Join		join;
 	List	   *hashclauses;
 	List	   *hashqualclauses;
+	bool		runtimeFilter;
 } HashJoin;
 
 #define SHARE_ID_NOT_SHARED (-1)
@@ -932,7 +932,8 @@ typedef enum
 	/* GPDB additions */
 	,
 	WAIT_EVENT_DTX_RECOVERY,
-	WAIT_EVENT_INTERCONNECT
+	WAIT_EVENT_INTERCONNECT,
+	WAIT_EVENT_AO_COMPACTION_WORKER
 } WaitEventIPC;
 
 /* ----------
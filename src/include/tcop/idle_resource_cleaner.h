@@ -24,5 +24,6 @@ extern void EnableClientWaitTimeoutInterrupt(void);
 extern bool DisableClientWaitTimeoutInterrupt(void);
 
 extern int	IdleSessionGangTimeout;
+extern int	IdleSessionGangReleaseRounds;
 
 #endif /* IDLE_RESOURCE_CLEANER_H */
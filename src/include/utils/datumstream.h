@@ -242,6 +242,34 @@ datumstreamread_nth(DatumStreamRead * acc)
 	}
 }
 
+/*
+ * Number of rows in the current block after the current position.
+ */
+inline static int
+datumstreamread_remaining(DatumStreamRead * acc)
+{
+	if (acc->largeObjectState == DatumStreamLargeObjectState_None)
+		return DatumStreamBlockRead_Remaining(&acc->blockRead);
+	else
+		return (acc->largeObjectState == DatumStreamLargeObjectState_HaveAoContent) ? 1 : 0;
+}
+
+/*
+ * Is the current block RLE_TYPE compressed, so that reading it in runs pays?
+ */
+inline static bool
+datumstreamread_has_runs(DatumStreamRead * acc)
+{
+	return acc->largeObjectState == DatumStreamLargeObjectState_None &&
+		acc->blockRead.rle_block_was_compressed;
+}
+
+extern int	datumstreamread_get_batch(DatumStreamRead * ds, int maxRows,
+									  Datum *values, bool *isnull);
+extern int	datumstreamread_get_runs(DatumStreamRead * ds, int maxRows,
+									 Datum *values, bool *isnull,
+									 int32 *runLengths, int *nrows);
+
 /* ------------------------------------------------------------------------------ */
 
 extern int datumstreamwrite_put(
@@ -309,6 +337,8 @@ extern int64 datumstreamwrite_lob(DatumStreamWrite *ds,
 extern int	datumstreamread_block(DatumStreamRead * ds,
 								  AppendOnlyBlockDirectory *blockDirectory,
 								  int colGroupNo);
+extern bool datumstreamread_block_header(DatumStreamRead * ds);
+extern void datumstreamread_skip_block(DatumStreamRead * ds);
 extern void datumstreamread_find(DatumStreamRead * datumStream,
 					 int32 rowNumInBlock);
 extern void datumstreamread_rewind_block(DatumStreamRead * datumStream);
@@ -2062,6 +2062,31 @@ DatumStreamBlockRead_Nth(DatumStreamBlockRead * dsr)
 	return dsr->nth;
 }
 
+/*
+ * Number of items in the block after the current position.
+ */
+inline static int32
+DatumStreamBlockRead_Remaining(DatumStreamBlockRead * dsr)
+{
+	if (dsr->nth >= dsr->logical_row_count)
+		return 0;
+
+	return dsr->logical_row_count - dsr->nth - 1;
+}
+
+extern int32 DatumStreamBlockRead_GetBatch(
+							   DatumStreamBlockRead * dsr,
+							   int32 maxItems,
+							   Datum *values,
+							   bool *isnull);
+extern int32 DatumStreamBlockRead_GetRuns(
+							  DatumStreamBlockRead * dsr,
+							  int32 maxItems,
+							  Datum *values,
+							  bool *isnull,
+							  int32 *runLengths,
+							  int32 *itemCount);
+
 extern void DatumStreamBlockRead_GetReadyOrig(
 								  DatumStreamBlockRead * dsr,
 								  uint8 * buffer,
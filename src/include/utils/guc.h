@@ -296,6 +296,9 @@ extern bool gp_local_distributed_cache_stats;
 extern bool gp_appendonly_verify_block_checksums;
 extern bool gp_appendonly_verify_write_block;
 extern bool gp_appendonly_compaction;
+extern bool gp_appendonly_enable_zonemaps;
+extern int	gp_appendonly_prefetch_depth;
+extern int	gp_appendonly_scan_batch_size;
 
 /*
  * Threshold of the ratio of dirty data in a segment file
@@ -306,6 +309,7 @@ extern bool gp_appendonly_compaction;
  * 10% of the tuples are hidden.
  */
 extern int  gp_appendonly_compaction_threshold;
+extern int  gp_appendonly_compaction_workers;
 extern bool gp_heap_require_relhasoids_match;
 extern bool	debug_xlog_record_read;
 extern bool Debug_cancel_print;
@@ -457,6 +461,8 @@ extern int optimizer_minidump;
 extern int  optimizer_cost_model;
 extern bool optimizer_metadata_caching;
 extern int	optimizer_mdcache_size;
+extern int	optimizer_plan_cache_size;
+extern int	optimizer_shared_mdcache_size;
 
 /* Optimizer debugging GUCs */
 extern bool optimizer_print_query;
@@ -0,0 +1,45 @@
+/*-------------------------------------------------------------------------
+ *
+ * shared_mdcache.h
+ *	  Shared-memory tier of the GPORCA metadata cache.
+ *
+ * Copyright (c) 2022-Present VMware, Inc. or its affiliates.
+ *
+ * src/include/utils/shared_mdcache.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef SHARED_MDCACHE_H
+#define SHARED_MDCACHE_H
+
+#include "storage/sinval.h"
+
+/* longest key, including the terminating NUL, that can be cached */
+#define SHARED_MDCACHE_KEY_LEN	64
+
+/* kind of catalog object a cached object is translated from */
+typedef enum SharedMDCacheObjType
+{
+	SHARED_MDCACHE_RELATION,	/* relation, index, or their statistics */
+	SHARED_MDCACHE_TYPE,
+	SHARED_MDCACHE_FUNCTION,
+	SHARED_MDCACHE_AGGREGATE,
+	SHARED_MDCACHE_OPERATOR,
+	SHARED_MDCACHE_CAST,
+	SHARED_MDCACHE_COMPARISON
+} SharedMDCacheObjType;
+
+extern Size SharedMDCacheShmemSize(void);
+extern void SharedMDCacheShmemInit(void);
+
+extern bool SharedMDCacheEnabled(void);
+extern uint64 SharedMDCacheGetGeneration(void);
+extern char *SharedMDCacheLookup(const char *key, Size *len);
+extern void SharedMDCacheInsert(const char *key, uint64 generation,
+								const char *data, Size len,
+								SharedMDCacheObjType objtype, Oid relid,
+								Oid objid);
+extern void SharedMDCacheInvalidate(const SharedInvalidationMessage *msgs,
+									int n);
+
+#endif							/* SHARED_MDCACHE_H */
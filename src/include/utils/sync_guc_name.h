@@ -12,6 +12,10 @@
 		"force_parallel_mode",
 		"gin_fuzzy_search_limit",
 		"gin_pending_list_limit",
+		"gp_appendonly_compaction_workers",
+		"gp_appendonly_enable_zonemaps",
+		"gp_appendonly_prefetch_depth",
+		"gp_appendonly_scan_batch_size",
 		"gp_blockdirectory_entry_min_range",
 		"gp_blockdirectory_minipage_size",
 		"gp_debug_linger",
@@ -47,11 +51,13 @@
 		"gp_log_stack_trace_lines",
 		"gp_max_packet_size",
 		"gp_max_slices",
+		"gp_motion_batch_size",
 		"gp_motion_slice_noop",
 		"gp_resgroup_memory_policy_auto_fixed_mem",
 		"gp_resgroup_print_operator_memory_limits",
 		"gp_resqueue_memory_policy_auto_fixed_mem",
 		"gp_resqueue_print_operator_memory_limits",
+		"gp_runtime_filter_min_inner_rows",
 		"gp_select_invisible",
 		"gp_sessionstate_loglevel",
 		"gp_snapshotadd_timeout",
@@ -189,6 +189,7 @@
 		"gp_enable_preunique",
 		"gp_enable_query_metrics",
 		"gp_enable_relsize_collection",
+		"gp_enable_runtime_filter",
 		"gp_enable_slow_writer_testmode",
 		"gp_enable_sort_distinct",
 		"gp_enable_sort_limit",
@@ -207,6 +208,7 @@
 		"gp_heap_require_relhasoids_match",
 		"gp_instrument_shmem_size",
 		"gp_interconnect_cache_future_packets",
+		"gp_interconnect_proxy_io_threads",
 		"gp_is_writer",
 		"gp_local_distributed_cache_stats",
 		"gp_log_dynamic_partition_pruning",
@@ -258,6 +260,7 @@
 		"gp_statistics_use_fkeys",
 		"gp_subtrans_warn_limit",
 		"gp_use_legacy_hashops",
+		"gp_vmem_idle_resource_release_rounds",
 		"gp_vmem_limit_per_query",
 		"gp_vmem_protect_limit",
 		"gp_vmem_protect_segworker_cache_limit",
@@ -416,6 +419,7 @@
 		"optimizer_parallel_union",
 		"optimizer_penalize_broadcast_threshold",
 		"optimizer_penalize_skew",
+		"optimizer_plan_cache_size",
 		"optimizer_print_expression_properties",
 		"optimizer_print_group_properties",
 		"optimizer_print_job_scheduler",
@@ -437,6 +441,7 @@
 		"optimizer_sample_plans",
 		"optimizer_search_strategy_path",
 		"optimizer_segments",
+		"optimizer_shared_mdcache_size",
 		"optimizer_sort_factor",
 		"optimizer_trace_fallback",
 		"optimizer_use_external_constant_expression_evaluation_for_ints",
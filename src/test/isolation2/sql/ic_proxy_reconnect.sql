@@ -0,0 +1,45 @@
+-- Tests that the ic-proxy peers reconnect after the ic-proxy of a segment
+-- restarts. The ic-proxy jobs of the CI run it with
+-- gp_interconnect_proxy_io_threads = 2, so that the peer connections of
+-- the surviving proxies are closed and opened again by their I/O threads.
+-- With the other interconnect types, the queries simply run as usual.
+
+-- Make the ic-proxy of a segment exit and be restarted by the postmaster.
+CREATE OR REPLACE FUNCTION ic_proxy_restart(datadir text) RETURNS int AS $$
+    import os, signal, subprocess
+    with open(os.path.join(datadir, 'postmaster.pid')) as f:
+        postmaster_pid = f.readline().strip()
+    out = subprocess.check_output(['ps', '-o', 'pid=,args=', '--ppid', postmaster_pid])
+    restarted = 0
+    for line in out.decode().splitlines():
+        pid, args = line.strip().split(None, 1)
+        if 'ic proxy process' in args:
+            os.kill(int(pid), signal.SIGINT)
+            restarted += 1
+    return restarted
+$$ LANGUAGE plpython3u;
+
+CREATE TABLE ic_proxy_reconnect_t (a int, b int) DISTRIBUTED BY (a);
+INSERT INTO ic_proxy_reconnect_t SELECT i, i % 10 FROM generate_series(1, 10000) i;
+
+-- The peers connect, and rows are sent between all the segments.
+SELECT count(*), sum(x.a) FROM ic_proxy_reconnect_t x JOIN ic_proxy_reconnect_t y ON x.b = y.a;
+SELECT b, count(*) FROM ic_proxy_reconnect_t GROUP BY b ORDER BY b;
+
+-- The other proxies see their peer on content 0 disconnect, and connect to
+-- it again once it is back.
+-- start_ignore
+SELECT ic_proxy_restart(datadir) FROM gp_segment_configuration WHERE content = 0 AND role = 'p';
+-- end_ignore
+SELECT count(*), sum(x.a) FROM ic_proxy_reconnect_t x JOIN ic_proxy_reconnect_t y ON x.b = y.a;
+SELECT b, count(*) FROM ic_proxy_reconnect_t GROUP BY b ORDER BY b;
+
+-- The same peer reconnects again, and so does the coordinator.
+-- start_ignore
+SELECT ic_proxy_restart(datadir) FROM gp_segment_configuration WHERE content IN (-1, 0) AND role = 'p';
+-- end_ignore
+SELECT count(*), sum(x.a) FROM ic_proxy_reconnect_t x JOIN ic_proxy_reconnect_t y ON x.b = y.a;
+SELECT b, count(*) FROM ic_proxy_reconnect_t GROUP BY b ORDER BY b;
+
+DROP TABLE ic_proxy_reconnect_t;
+DROP FUNCTION ic_proxy_restart(text);
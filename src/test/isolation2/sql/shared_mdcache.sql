@@ -0,0 +1,87 @@
+-- Tests the shared-memory tier of the GPORCA metadata cache.
+!\retcode gpconfig -c optimizer_shared_mdcache_size -v 16MB --masteronly;
+!\retcode gpstop -ari;
+
+-- Lookups that find an object in the shared cache trigger the
+-- shared_mdcache_hit fault, with the key of the object as the table name.
+-- Session 9 watches the entry of a relation, checks the fault and changes
+-- the catalogs. It uses the Postgres planner, which does not use the cache.
+9: SET optimizer = off;
+9: CREATE FUNCTION shared_mdcache_watch(rel regclass) RETURNS text AS $$ SELECT gp_inject_fault('shared_mdcache_hit', 'skip', '', '', '0.' || rel::oid || '.1.0', 1, -1, 0, 1) $$ LANGUAGE sql;
+9: CREATE FUNCTION shared_mdcache_hits() RETURNS int AS $$ SELECT (regexp_match(gp_inject_fault('shared_mdcache_hit', 'status', 1), 'num times hit:''(\d+)'''))[1]::int $$ LANGUAGE sql;
+9: CREATE TABLE shared_mdcache_t (a int, b int) DISTRIBUTED BY (a);
+9: INSERT INTO shared_mdcache_t SELECT i, i FROM generate_series(1, 100) i;
+9: ANALYZE shared_mdcache_t;
+9: CREATE TABLE shared_mdcache_other (a int) DISTRIBUTED BY (a);
+
+-- The objects translated by the first session are found by the second one.
+1: SET optimizer = on;
+1: SELECT count(*) FROM shared_mdcache_t WHERE b > 50;
+9: SELECT shared_mdcache_watch('shared_mdcache_t');
+2: SET optimizer = on;
+2: SELECT count(*) FROM shared_mdcache_t WHERE b > 50;
+9: SELECT shared_mdcache_hits() > 0 AS hit;
+9: SELECT gp_inject_fault('shared_mdcache_hit', 'reset', 1);
+
+-- ALTER TABLE in another session evicts the relation.
+9: ALTER TABLE shared_mdcache_t ADD COLUMN c int DEFAULT 1;
+9: SELECT shared_mdcache_watch('shared_mdcache_t');
+3: SET optimizer = on;
+3: SELECT count(*), sum(c) FROM shared_mdcache_t WHERE b > 50;
+9: SELECT shared_mdcache_hits() AS hits;
+9: SELECT gp_inject_fault('shared_mdcache_hit', 'reset', 1);
+
+-- The objects translated after the invalidation are cached again.
+9: SELECT shared_mdcache_watch('shared_mdcache_t');
+4: SET optimizer = on;
+4: SELECT count(*), sum(c) FROM shared_mdcache_t WHERE b > 50;
+9: SELECT shared_mdcache_hits() > 0 AS hit;
+9: SELECT gp_inject_fault('shared_mdcache_hit', 'reset', 1);
+
+-- Changing another relation leaves the entry alone.
+9: ALTER TABLE shared_mdcache_other ADD COLUMN b int;
+9: ANALYZE shared_mdcache_other;
+9: SELECT shared_mdcache_watch('shared_mdcache_t');
+5: SET optimizer = on;
+5: SELECT count(*), sum(c) FROM shared_mdcache_t WHERE b > 50;
+9: SELECT shared_mdcache_hits() > 0 AS hit;
+9: SELECT gp_inject_fault('shared_mdcache_hit', 'reset', 1);
+
+-- ANALYZE in another session evicts the relation.
+9: INSERT INTO shared_mdcache_t SELECT i, i, i FROM generate_series(101, 200) i;
+9: ANALYZE shared_mdcache_t;
+9: SELECT shared_mdcache_watch('shared_mdcache_t');
+6: SET optimizer = on;
+6: SELECT count(*), sum(c) FROM shared_mdcache_t WHERE b > 50;
+9: SELECT shared_mdcache_hits() AS hits;
+9: SELECT gp_inject_fault('shared_mdcache_hit', 'reset', 1);
+
+-- A transaction that has changed the catalogs sees changes that are not
+-- committed yet, so it bypasses the shared cache.
+9: SELECT shared_mdcache_watch('shared_mdcache_t');
+7: SET optimizer = on;
+7: BEGIN;
+7: ALTER TABLE shared_mdcache_t ADD COLUMN d int DEFAULT 2;
+7: SELECT count(*), sum(d) FROM shared_mdcache_t WHERE b > 50;
+9: SELECT shared_mdcache_hits() AS hits;
+9: SELECT gp_inject_fault('shared_mdcache_hit', 'reset', 1);
+7: ROLLBACK;
+
+-- The rolled back column was not cached, and the entry is still valid.
+-- Writing to a table does not keep a transaction from using the cache.
+8: SET optimizer = off;
+8: BEGIN;
+8: INSERT INTO shared_mdcache_t VALUES (201, 201, 201);
+9: SELECT shared_mdcache_watch('shared_mdcache_t');
+8: SET optimizer = on;
+8: SELECT * FROM shared_mdcache_t WHERE a = 1;
+8: COMMIT;
+9: SELECT shared_mdcache_hits() > 0 AS hit;
+9: SELECT gp_inject_fault('shared_mdcache_hit', 'reset', 1);
+
+9: DROP TABLE shared_mdcache_t;
+9: DROP TABLE shared_mdcache_other;
+9: DROP FUNCTION shared_mdcache_watch(regclass);
+9: DROP FUNCTION shared_mdcache_hits();
+!\retcode gpconfig -r optimizer_shared_mdcache_size --masteronly;
+!\retcode gpstop -ari;
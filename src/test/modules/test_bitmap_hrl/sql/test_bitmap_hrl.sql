@@ -0,0 +1,7 @@
+CREATE EXTENSION test_bitmap_hrl;
+
+--
+-- All the logic is in the test_bitmap_hrl() function. It will throw
+-- an error if something fails.
+--
+SELECT test_bitmap_hrl();
@@ -0,0 +1,8 @@
+/* src/test/modules/test_bitmap_hrl/test_bitmap_hrl--1.0.sql */
+
+-- complain if script is sourced in psql, rather than via CREATE EXTENSION
+\echo Use "CREATE EXTENSION test_bitmap_hrl" to load this file. \quit
+
+CREATE FUNCTION test_bitmap_hrl()
+RETURNS pg_catalog.void STRICT
+AS 'MODULE_PATHNAME' LANGUAGE C;
@@ -0,0 +1,392 @@
+/*--------------------------------------------------------------------------
+ *
+ * test_bitmap_hrl.c
+ *		Test the union of HRL compressed bitmap index words.
+ *
+ * Copyright (c) 2022-Present VMware, Inc. or its affiliates.
+ *
+ * IDENTIFICATION
+ *		src/test/modules/test_bitmap_hrl/test_bitmap_hrl.c
+ *
+ * -------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/bitmap.h"
+#include "access/bitmap_private.h"
+#include "fmgr.h"
+#include "utils/memutils.h"
+#include "utils/timestamp.h"
+
+/*
+ * If you enable this, the tests will print how long the union of the test
+ * vectors takes, compared with ORing the same vectors uncompressed, and how
+ * many words the compressed vectors and the result have.  That can be used
+ * as micro-benchmark of _bitmap_union() over bitmaps of different density
+ * (you might want to increase the number of words in the tests, if you do
+ * that, to reduce noise).
+ */
+static const bool bitmap_hrl_test_stats = false;
+
+PG_MODULE_MAGIC;
+
+PG_FUNCTION_INFO_V1(test_bitmap_hrl);
+
+/*
+ * A struct to define a set of synthetic bitmap vectors.
+ *
+ * Each vector consists of clusters of non-zero words, separated by gaps of
+ * zero words. The length of the clusters and the gaps varies randomly around
+ * their average, so that on average 'density' of the words are non-zero.
+ * A cluster consists of all-ones words with probability 'ones', and of
+ * random words otherwise.
+ */
+typedef struct
+{
+	char	   *test_name;		/* short name of the test, for humans */
+	int			nvectors;		/* number of vectors to OR together */
+	uint64		nwords;			/* uncompressed length of each vector */
+	double		density;		/* fraction of non-zero words */
+	uint64		cluster;		/* average length of a cluster */
+	double		ones;			/* fraction of all-ones clusters */
+} test_spec;
+
+static const test_spec test_specs[] = {
+	{
+		"sparse", 4, 1000000, 0.001, 1, 0.0
+	},
+	{
+		"sparse clusters", 4, 1000000, 0.01, 20, 0.5
+	},
+	{
+		"medium density", 3, 200000, 0.2, 8, 0.1
+	},
+	{
+		"dense", 2, 200000, 0.9, 50, 0.1
+	},
+	{
+		"random words", 3, 100000, 1.0, 1000, 0.0
+	},
+	{
+		"all ones", 2, 100000, 1.0, 100000, 1.0
+	},
+	{
+		"many vectors", 16, 200000, 0.02, 10, 0.2
+	}
+};
+
+/*
+ * A synthetic bitmap vector, both uncompressed and HRL compressed.
+ * 'wordstarts' holds the number of uncompressed words before each
+ * compressed word.
+ */
+typedef struct
+{
+	uint64		nwords;
+	BM_HRL_WORD *words;
+
+	uint32		ncwords;
+	BM_HRL_WORD *cwords;
+	bool	   *isfill;
+	uint64	   *wordstarts;
+
+	uint32		nextcword;		/* next compressed word to load */
+} test_vector;
+
+static void test_union(const test_spec *spec);
+static void make_vector(const test_spec *spec, test_vector *vec);
+static uint64 random_uint64(uint64 max);
+static void load_page(test_vector *vec, BMBatchWords *batch);
+static uint64 union_vectors(test_vector *vecs, int nvectors,
+							BMBatchWords *inputs, BMBatchWords *result,
+							BM_HRL_WORD *out, uint64 maxout,
+							uint64 *nresultwords);
+
+/*
+ * SQL-callable entry point to perform all tests.
+ */
+Datum
+test_bitmap_hrl(PG_FUNCTION_ARGS)
+{
+	pg_srand48(0);
+
+	for (int i = 0; i < lengthof(test_specs); i++)
+		test_union(&test_specs[i]);
+
+	PG_RETURN_VOID();
+}
+
+/*
+ * Test the union of the vectors defined by 'spec'.
+ */
+static void
+test_union(const test_spec *spec)
+{
+	MemoryContext test_ctx;
+	MemoryContext old_ctx;
+	test_vector *vecs;
+	BMBatchWords *inputs;
+	BMBatchWords result;
+	BM_HRL_WORD *expected;
+	BM_HRL_WORD *out;
+	uint64		nout;
+	uint64		nresultwords;
+	uint64		ncwords = 0;
+	TimestampTz starttime;
+	TimestampTz endtime;
+
+	elog(NOTICE, "testing bitmap union with \"%s\"", spec->test_name);
+	if (bitmap_hrl_test_stats)
+		fprintf(stderr, "-----\ntesting bitmap union with \"%s\"\n", spec->test_name);
+
+	test_ctx = AllocSetContextCreate(CurrentMemoryContext,
+									 "bitmap hrl test",
+									 ALLOCSET_DEFAULT_SIZES);
+	old_ctx = MemoryContextSwitchTo(test_ctx);
+
+	vecs = palloc0(spec->nvectors * sizeof(test_vector));
+	inputs = palloc0(spec->nvectors * sizeof(BMBatchWords));
+	for (int i = 0; i < spec->nvectors; i++)
+	{
+		make_vector(spec, &vecs[i]);
+		_bitmap_init_batchwords(&inputs[i], BM_NUM_OF_HRL_WORDS_PER_PAGE,
+								test_ctx);
+		ncwords += vecs[i].ncwords;
+	}
+	_bitmap_init_batchwords(&result, BM_NUM_OF_HRL_WORDS_PER_PAGE, test_ctx);
+
+	/*
+	 * OR the uncompressed vectors together, to compare the union with.
+	 */
+	starttime = GetCurrentTimestamp();
+
+	expected = palloc(spec->nwords * sizeof(BM_HRL_WORD));
+	memcpy(expected, vecs[0].words, spec->nwords * sizeof(BM_HRL_WORD));
+	for (int i = 1; i < spec->nvectors; i++)
+	{
+		for (uint64 j = 0; j < spec->nwords; j++)
+			expected[j] |= vecs[i].words[j];
+	}
+
+	endtime = GetCurrentTimestamp();
+
+	if (bitmap_hrl_test_stats)
+		fprintf(stderr, "ORed %d uncompressed vectors of " UINT64_FORMAT " words in %d ms\n",
+				spec->nvectors, spec->nwords, (int) (endtime - starttime) / 1000);
+
+	/*
+	 * Now the union of the compressed vectors.
+	 */
+	out = palloc(spec->nwords * sizeof(BM_HRL_WORD));
+
+	starttime = GetCurrentTimestamp();
+
+	nout = union_vectors(vecs, spec->nvectors, inputs, &result,
+						 out, spec->nwords, &nresultwords);
+
+	endtime = GetCurrentTimestamp();
+
+	if (bitmap_hrl_test_stats)
+		fprintf(stderr, "union of " UINT64_FORMAT " compressed words into " UINT64_FORMAT " words in %d ms\n",
+				ncwords, nresultwords, (int) (endtime - starttime) / 1000);
+
+	if (nout != spec->nwords)
+		elog(ERROR, "union has " UINT64_FORMAT " words, expected " UINT64_FORMAT,
+			 nout, spec->nwords);
+
+	for (uint64 i = 0; i < nout; i++)
+	{
+		if (out[i] != expected[i])
+			elog(ERROR, "union word " UINT64_FORMAT " is " UINT64_FORMAT ", expected " UINT64_FORMAT,
+				 i, out[i], expected[i]);
+	}
+
+	MemoryContextSwitchTo(old_ctx);
+	MemoryContextDelete(test_ctx);
+}
+
+/*
+ * Build a random vector, and compress it.
+ */
+static void
+make_vector(const test_spec *spec, test_vector *vec)
+{
+	uint64		gap;
+	uint64		pos;
+	uint64		ndone;
+
+	vec->nwords = spec->nwords;
+	vec->words = palloc0(spec->nwords * sizeof(BM_HRL_WORD));
+
+	/* average gap between clusters that gives the requested density */
+	gap = (uint64) (spec->cluster * (1.0 - spec->density) / spec->density);
+
+	pos = random_uint64(2 * gap);
+	while (pos < spec->nwords)
+	{
+		uint64		len = 1 + random_uint64(2 * spec->cluster - 2);
+		bool		ones = random_uint64(999) < spec->ones * 1000;
+
+		for (uint64 i = 0; i < len && pos < spec->nwords; i++, pos++)
+		{
+			if (ones)
+				vec->words[pos] = LITERAL_ALL_ONE;
+			else
+			{
+				BM_HRL_WORD	word = random_uint64(PG_UINT64_MAX);
+
+				if (word == LITERAL_ALL_ZERO || word == LITERAL_ALL_ONE)
+					word = 1;
+				vec->words[pos] = word;
+			}
+		}
+		pos += random_uint64(2 * gap);
+	}
+
+	/*
+	 * Compress the vector. Runs of two or more all-zero or all-one words
+	 * become fill words.
+	 */
+	vec->cwords = palloc(spec->nwords * sizeof(BM_HRL_WORD));
+	vec->isfill = palloc(spec->nwords * sizeof(bool));
+	vec->wordstarts = palloc(spec->nwords * sizeof(uint64));
+	vec->ncwords = 0;
+	vec->nextcword = 0;
+
+	for (ndone = 0; ndone < spec->nwords;)
+	{
+		BM_HRL_WORD	word = vec->words[ndone];
+		uint64		run = 1;
+
+		if (word == LITERAL_ALL_ZERO || word == LITERAL_ALL_ONE)
+		{
+			while (ndone + run < spec->nwords && vec->words[ndone + run] == word)
+				run++;
+		}
+
+		vec->wordstarts[vec->ncwords] = ndone;
+		if (run > 1)
+		{
+			BM_HRL_WORD	fillBit = (word == LITERAL_ALL_ONE) ? 1 : 0;
+
+			vec->cwords[vec->ncwords] = BM_MAKE_FILL_WORD(fillBit, run);
+			vec->isfill[vec->ncwords] = true;
+		}
+		else
+		{
+			vec->cwords[vec->ncwords] = word;
+			vec->isfill[vec->ncwords] = false;
+		}
+		vec->ncwords++;
+		ndone += run;
+	}
+}
+
+/*
+ * Return a random integer between 0 and 'max'.
+ */
+static uint64
+random_uint64(uint64 max)
+{
+	uint64		x;
+
+	x = ((uint64) pg_lrand48() << 33) ^ ((uint64) pg_lrand48() << 2) ^
+		(uint64) pg_lrand48();
+
+	if (max == PG_UINT64_MAX)
+		return x;
+	return x % (max + 1);
+}
+
+/*
+ * Load the next page worth of compressed words of a vector into 'batch',
+ * the way read_words() does for a bitmap index page.
+ */
+static void
+load_page(test_vector *vec, BMBatchWords *batch)
+{
+	uint32		n = Min(BM_NUM_OF_HRL_WORDS_PER_PAGE,
+						vec->ncwords - vec->nextcword);
+
+	_bitmap_reset_batchwords(batch);
+
+	batch->nwordsread = vec->wordstarts[vec->nextcword];
+	for (uint32 i = 0; i < n; i++)
+	{
+		batch->cwords[i] = vec->cwords[vec->nextcword + i];
+		if (vec->isfill[vec->nextcword + i])
+			batch->hwords[i / BM_HRL_WORD_SIZE] |= WORDNO_GET_HEADER_BIT(i);
+	}
+	batch->nwords = n;
+	vec->nextcword += n;
+}
+
+/*
+ * OR the vectors together with _bitmap_union(), the way next_batch_words()
+ * does for the bitmap vectors of a bitmap index scan, and decompress the
+ * result into 'out'.
+ *
+ * Returns the number of uncompressed words in the result, and the number
+ * of compressed ones in *nresultwords.
+ */
+static uint64
+union_vectors(test_vector *vecs, int nvectors, BMBatchWords *inputs,
+			  BMBatchWords *result, BM_HRL_WORD *out, uint64 maxout,
+			  uint64 *nresultwords)
+{
+	BMBatchWords **batches;
+	uint64		nout = 0;
+
+	batches = palloc(nvectors * sizeof(BMBatchWords *));
+	*nresultwords = 0;
+
+	for (;;)
+	{
+		uint32		nbatches = 0;
+
+		/* read more words for the vectors that ran out of them */
+		for (int i = 0; i < nvectors; i++)
+		{
+			if (inputs[i].nwords == 0 && vecs[i].nextcword < vecs[i].ncwords)
+				load_page(&vecs[i], &inputs[i]);
+
+			if (inputs[i].nwords > 0)
+				batches[nbatches++] = &inputs[i];
+		}
+
+		if (nbatches == 0)
+			break;
+
+		_bitmap_reset_batchwords(result);
+		_bitmap_union(batches, nbatches, result);
+		*nresultwords += result->nwords;
+
+		for (uint32 i = 0; i < result->nwords; i++)
+		{
+			BM_HRL_WORD	word = result->cwords[i];
+
+			if (IS_FILL_WORD(result->hwords, i))
+			{
+				BM_HRL_WORD	fill = GET_FILL_BIT(word) ? LITERAL_ALL_ONE :
+											   LITERAL_ALL_ZERO;
+
+				if (nout + FILL_LENGTH(word) > maxout)
+					elog(ERROR, "union has more than " UINT64_FORMAT " words",
+						 maxout);
+				for (uint64 j = 0; j < FILL_LENGTH(word); j++)
+					out[nout++] = fill;
+			}
+			else
+			{
+				if (nout + 1 > maxout)
+					elog(ERROR, "union has more than " UINT64_FORMAT " words",
+						 maxout);
+				out[nout++] = word;
+			}
+		}
+	}
+
+	pfree(batches);
+
+	return nout;
+}
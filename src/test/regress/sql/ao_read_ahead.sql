@@ -0,0 +1,50 @@
+--
+-- Read-ahead of append-only segment files during sequential scans.
+--
+-- EXPLAIN ANALYZE reports the number of large reads that were prefetched
+-- whenever read-ahead is on.
+--
+create or replace function count_read_ahead_lines(explain_query text) returns bigint as
+$$
+declare
+  explainrow text;
+  n bigint := 0;
+begin
+  for explainrow in execute 'EXPLAIN (ANALYZE, COSTS OFF) ' || explain_query
+  loop
+    if explainrow like '%Read-ahead depth %' then
+      n := n + 1;
+    end if;
+  end loop;
+  return n;
+end;
+$$ language plpgsql;
+
+create table ao_read_ahead_row (a int, b text) with (appendonly=true) distributed by (a);
+insert into ao_read_ahead_row select i, repeat('x', 100) from generate_series(1, 10000) i;
+create table ao_read_ahead_col (a int, b text) with (appendonly=true, orientation=column) distributed by (a);
+insert into ao_read_ahead_col select i, repeat('x', 100) from generate_series(1, 10000) i;
+
+-- Reported with the default depth.
+show gp_appendonly_prefetch_depth;
+select count_read_ahead_lines('select count(*) from ao_read_ahead_row') > 0 as row_reported,
+       count_read_ahead_lines('select count(*) from ao_read_ahead_col') > 0 as col_reported;
+
+-- Reported with a non-default depth, and the results don't change.
+set gp_appendonly_prefetch_depth to 8;
+select count_read_ahead_lines('select count(*) from ao_read_ahead_row') > 0 as row_reported,
+       count_read_ahead_lines('select count(*) from ao_read_ahead_col') > 0 as col_reported;
+select count(*), sum(a), sum(length(b)) from ao_read_ahead_row;
+select count(*), sum(a), sum(length(b)) from ao_read_ahead_col;
+
+-- Nothing reported with read-ahead disabled.
+set gp_appendonly_prefetch_depth to 0;
+select count_read_ahead_lines('select count(*) from ao_read_ahead_row') as row_lines,
+       count_read_ahead_lines('select count(*) from ao_read_ahead_col') as col_lines;
+select count(*), sum(a), sum(length(b)) from ao_read_ahead_row;
+select count(*), sum(a), sum(length(b)) from ao_read_ahead_col;
+
+reset gp_appendonly_prefetch_depth;
+drop table ao_read_ahead_row;
+drop table ao_read_ahead_col;
+drop function count_read_ahead_lines(text);
@@ -0,0 +1,159 @@
+--
+-- Zone maps of append-only tables: the min, max and NULL count of each
+-- column per block directory entry, which let sequential scans skip the
+-- blocks that cannot satisfy a qual.
+--
+create or replace function zonemap_usage(explain_query text) returns text as
+$$
+declare
+  explainrow text;
+  m text[];
+  result text := 'not used';
+begin
+  for explainrow in execute 'EXPLAIN (ANALYZE, COSTS OFF) ' || explain_query
+  loop
+    m := regexp_match(explainrow, 'Zone maps skipped (\d+) of (\d+) blocks');
+    if m is not null then
+      if m[1]::bigint > 0 then
+        return 'skipped';
+      end if;
+      result := 'none skipped';
+    end if;
+  end loop;
+  return result;
+end;
+$$ language plpgsql;
+
+-- Zone maps are only used by sequential scans.
+set enable_indexscan to off;
+set enable_bitmapscan to off;
+set enable_indexonlyscan to off;
+set optimizer_enable_indexscan to off;
+set optimizer_enable_bitmapscan to off;
+set optimizer_enable_indexonlyscan to off;
+
+--
+-- Row-oriented tables
+--
+-- Zone maps live in the block directory, which is created with the table
+-- while zone maps are enabled, whether or not the table has an index.
+create table zm_row (a int, b int, c text) with (appendonly=true, blocksize=8192) distributed by (a);
+select blkdirrelid <> 0 as has_blkdir from pg_appendonly where relid = 'zm_row'::regclass;
+insert into zm_row select i, i % 7, repeat('x', 50) from generate_series(1, 50000) i;
+
+-- Range quals skip blocks and still return the right rows.
+select count(*), min(a), max(a) from zm_row where a between 1000 and 1100;
+select zonemap_usage('select count(*) from zm_row where a between 1000 and 1100');
+select count(*) from zm_row where a < 100;
+select count(*) from zm_row where a >= 49990;
+select count(*) from zm_row where b is null;
+select zonemap_usage('select count(*) from zm_row where b is null');
+
+-- The same query with zone maps disabled.
+set gp_appendonly_enable_zonemaps to off;
+select count(*), min(a), max(a) from zm_row where a between 1000 and 1100;
+select zonemap_usage('select count(*) from zm_row where a between 1000 and 1100');
+reset gp_appendonly_enable_zonemaps;
+
+-- Deleted and updated rows.
+delete from zm_row where a between 1000 and 1049;
+update zm_row set b = -1 where a between 1050 and 1059;
+select count(*), min(a), max(a) from zm_row where a between 1000 and 1100;
+select count(*), min(a), max(a) from zm_row where b = -1;
+select zonemap_usage('select count(*) from zm_row where b = -1');
+
+-- Minipages written while zone maps were disabled are in the original
+-- format, and are never skipped; rows added later are.
+create table zm_row_old (a int, b int, c text) with (appendonly=true, blocksize=8192) distributed by (a);
+create index zm_row_old_a on zm_row_old (a);
+set gp_appendonly_enable_zonemaps to off;
+insert into zm_row_old select i, i % 7, repeat('x', 50) from generate_series(1, 50000) i;
+reset gp_appendonly_enable_zonemaps;
+select count(*), min(a), max(a) from zm_row_old where a between 1000 and 1100;
+select zonemap_usage('select count(*) from zm_row_old where a between 1000 and 1100');
+insert into zm_row_old select i, i % 7, repeat('x', 50) from generate_series(50001, 60000) i;
+select count(*), min(a), max(a) from zm_row_old where a between 50001 and 50100;
+select zonemap_usage('select count(*) from zm_row_old where a between 50001 and 50100');
+
+-- A table created while zone maps were disabled has no block directory
+-- until CREATE INDEX builds one, and the entries it builds are not
+-- summarized either.
+set gp_appendonly_enable_zonemaps to off;
+create table zm_row_late (a int, b int, c text) with (appendonly=true, blocksize=8192) distributed by (a);
+insert into zm_row_late select i, i % 7, repeat('x', 50) from generate_series(1, 50000) i;
+reset gp_appendonly_enable_zonemaps;
+select blkdirrelid <> 0 as has_blkdir from pg_appendonly where relid = 'zm_row_late'::regclass;
+select zonemap_usage('select count(*) from zm_row_late where a between 1000 and 1100');
+create index zm_row_late_a on zm_row_late (a);
+select count(*), min(a), max(a) from zm_row_late where a between 1000 and 1100;
+select zonemap_usage('select count(*) from zm_row_late where a between 1000 and 1100');
+
+drop table zm_row;
+drop table zm_row_old;
+drop table zm_row_late;
+
+--
+-- Column-oriented tables
+--
+-- Zone maps live in the block directory, which is created with the table
+-- while zone maps are enabled, whether or not the table has an index.
+create table zm_col (a int, b int, c text) with (appendonly=true, orientation=column, blocksize=8192) distributed by (a);
+insert into zm_col select i, i % 7, repeat('x', 50) from generate_series(1, 50000) i;
+
+-- Range quals skip blocks and still return the right rows.
+select count(*), min(a), max(a) from zm_col where a between 1000 and 1100;
+select zonemap_usage('select count(*) from zm_col where a between 1000 and 1100');
+select count(*) from zm_col where a < 100;
+select count(*) from zm_col where a >= 49990;
+select count(*) from zm_col where b is null;
+select zonemap_usage('select count(*) from zm_col where b is null');
+
+-- The same query with zone maps disabled.
+set gp_appendonly_enable_zonemaps to off;
+select count(*), min(a), max(a) from zm_col where a between 1000 and 1100;
+select zonemap_usage('select count(*) from zm_col where a between 1000 and 1100');
+reset gp_appendonly_enable_zonemaps;
+
+-- Deleted and updated rows.
+delete from zm_col where a between 1000 and 1049;
+update zm_col set b = -1 where a between 1050 and 1059;
+select count(*), min(a), max(a) from zm_col where a between 1000 and 1100;
+select count(*), min(a), max(a) from zm_col where b = -1;
+select zonemap_usage('select count(*) from zm_col where b = -1');
+
+-- Minipages written while zone maps were disabled are in the original
+-- format, and are never skipped; rows added later are.
+create table zm_col_old (a int, b int, c text) with (appendonly=true, orientation=column, blocksize=8192) distributed by (a);
+create index zm_col_old_a on zm_col_old (a);
+set gp_appendonly_enable_zonemaps to off;
+insert into zm_col_old select i, i % 7, repeat('x', 50) from generate_series(1, 50000) i;
+reset gp_appendonly_enable_zonemaps;
+select count(*), min(a), max(a) from zm_col_old where a between 1000 and 1100;
+select zonemap_usage('select count(*) from zm_col_old where a between 1000 and 1100');
+insert into zm_col_old select i, i % 7, repeat('x', 50) from generate_series(50001, 60000) i;
+select count(*), min(a), max(a) from zm_col_old where a between 50001 and 50100;
+select zonemap_usage('select count(*) from zm_col_old where a between 50001 and 50100');
+
+-- A table created while zone maps were disabled has no block directory
+-- until CREATE INDEX builds one, and the entries it builds are not
+-- summarized either.
+set gp_appendonly_enable_zonemaps to off;
+create table zm_col_late (a int, b int, c text) with (appendonly=true, orientation=column, blocksize=8192) distributed by (a);
+insert into zm_col_late select i, i % 7, repeat('x', 50) from generate_series(1, 50000) i;
+reset gp_appendonly_enable_zonemaps;
+select zonemap_usage('select count(*) from zm_col_late where a between 1000 and 1100');
+create index zm_col_late_a on zm_col_late (a);
+select count(*), min(a), max(a) from zm_col_late where a between 1000 and 1100;
+select zonemap_usage('select count(*) from zm_col_late where a between 1000 and 1100');
+
+drop table zm_col;
+drop table zm_col_old;
+drop table zm_col_late;
+
+reset enable_indexscan;
+reset enable_bitmapscan;
+reset enable_indexonlyscan;
+reset optimizer_enable_indexscan;
+reset optimizer_enable_bitmapscan;
+reset optimizer_enable_indexonlyscan;
+drop function zonemap_usage(text);
@@ -0,0 +1,62 @@
+--
+-- Queries whose slices are each dispatched only their part of the plan.
+--
+
+CREATE TABLE pruned_plan_t1 (a int, b int) DISTRIBUTED BY (a);
+CREATE TABLE pruned_plan_t2 (a int, c int) DISTRIBUTED BY (a);
+INSERT INTO pruned_plan_t1 SELECT i, i % 100 FROM generate_series(1, 1000) i;
+INSERT INTO pruned_plan_t2 SELECT i, i % 50 FROM generate_series(1, 500) i;
+ANALYZE pruned_plan_t1;
+ANALYZE pruned_plan_t2;
+
+-- A join and an aggregate, redistributing both sides and the join result.
+SELECT t1.b % 5 AS g, count(*), sum(t2.a)
+FROM pruned_plan_t1 t1 JOIN pruned_plan_t2 t2 ON t1.b = t2.c
+GROUP BY 1 ORDER BY 1;
+
+-- The QEs eliminate the other slices' nodes even with execute_pruned_plan
+-- off, as they are not in the plan they were sent.
+SET execute_pruned_plan = off;
+SELECT t1.b % 5 AS g, count(*), sum(t2.a)
+FROM pruned_plan_t1 t1 JOIN pruned_plan_t2 t2 ON t1.b = t2.c
+GROUP BY 1 ORDER BY 1;
+RESET execute_pruned_plan;
+
+-- Correlated SubPlans, in the target list and in a qual.
+SELECT a, (SELECT count(*) FROM pruned_plan_t2 t2 WHERE t2.c = t1.b) AS n
+FROM pruned_plan_t1 t1 WHERE a <= 5 ORDER BY a;
+SELECT count(*) FROM pruned_plan_t1 t1
+WHERE t1.a < (SELECT count(*) FROM pruned_plan_t2 t2 WHERE t2.c = t1.b);
+
+-- An initplan, whose result is passed to the slices as a parameter.
+SELECT count(*) FROM pruned_plan_t1 WHERE b > (SELECT avg(c) FROM pruned_plan_t2);
+
+-- A ShareInputScan producer and consumers in different slices.
+SET gp_cte_sharing = on;
+WITH cte AS (SELECT b, count(*) AS n FROM pruned_plan_t1 GROUP BY b)
+SELECT count(*), sum(x.n + y.n) FROM cte x JOIN cte y ON x.b = y.b + 1;
+RESET gp_cte_sharing;
+
+-- A slice that runs on the entry db, scanning a catalog table.
+CREATE TABLE pruned_plan_entry (relname text) DISTRIBUTED BY (relname);
+INSERT INTO pruned_plan_entry
+  SELECT relname FROM pg_class WHERE relname IN ('pruned_plan_t1', 'pruned_plan_t2');
+SELECT relname FROM pruned_plan_entry ORDER BY 1;
+
+-- A prepared statement executed repeatedly, with a plan large enough to be
+-- compressed.
+SELECT string_agg(i::text, ', ') AS inlist FROM generate_series(1, 5000) i \gset
+PREPARE pruned_plan_q(int) AS
+SELECT t1.b % 5 AS g, count(*)
+FROM pruned_plan_t1 t1 JOIN pruned_plan_t2 t2 ON t1.b = t2.c
+WHERE t1.a IN (:inlist) AND t2.a > $1
+GROUP BY 1 ORDER BY 1;
+EXECUTE pruned_plan_q(0);
+EXECUTE pruned_plan_q(0);
+EXECUTE pruned_plan_q(0);
+EXECUTE pruned_plan_q(250);
+DEALLOCATE pruned_plan_q;
+
+DROP TABLE pruned_plan_t1;
+DROP TABLE pruned_plan_t2;
+DROP TABLE pruned_plan_entry;
@@ -0,0 +1,39 @@
+--
+-- Tests for the GPORCA plan cache (optimizer_plan_cache_size). EXPLAIN shows
+-- the cumulative hit and miss counts of the backend. The Postgres planner does
+-- not use the cache, and does not show them.
+--
+CREATE TABLE orca_plan_cache (a int, b int) DISTRIBUTED BY (a);
+INSERT INTO orca_plan_cache SELECT i, i FROM generate_series(1, 100) i;
+ANALYZE orca_plan_cache;
+
+SET optimizer_plan_cache_size = '1MB';
+
+-- The first lookup misses and caches the plan, the next ones find it.
+EXPLAIN (COSTS OFF) SELECT count(*) FROM orca_plan_cache WHERE b > 95;
+SELECT count(*) FROM orca_plan_cache WHERE b > 95;
+EXPLAIN (COSTS OFF) SELECT count(*) FROM orca_plan_cache WHERE b > 95;
+
+-- Queries that differ only in constants share the plan, with the constants
+-- of each query bound into it.
+EXPLAIN (COSTS OFF) SELECT count(*) FROM orca_plan_cache WHERE b > 50;
+SELECT count(*) FROM orca_plan_cache WHERE b > 50;
+
+-- Directly dispatched plans depend on the values of the distribution key,
+-- and are not cached.
+EXPLAIN (COSTS OFF) SELECT b FROM orca_plan_cache WHERE a = 7;
+EXPLAIN (COSTS OFF) SELECT b FROM orca_plan_cache WHERE a = 7;
+
+-- DDL drops the cached plans.
+ALTER TABLE orca_plan_cache ADD COLUMN c int;
+EXPLAIN (COSTS OFF) SELECT count(*) FROM orca_plan_cache WHERE b > 95;
+EXPLAIN (COSTS OFF) SELECT count(*) FROM orca_plan_cache WHERE b > 95;
+
+-- So does ANALYZE, which changes the statistics the plans were costed with.
+INSERT INTO orca_plan_cache SELECT i, i, i FROM generate_series(101, 200) i;
+ANALYZE orca_plan_cache;
+EXPLAIN (COSTS OFF) SELECT count(*) FROM orca_plan_cache WHERE b > 95;
+SELECT count(*) FROM orca_plan_cache WHERE b > 95;
+
+RESET optimizer_plan_cache_size;
+DROP TABLE orca_plan_cache;
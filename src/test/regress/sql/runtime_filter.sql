@@ -0,0 +1,116 @@
+--
+-- Tests for runtime filters: a hash join builds a Bloom filter over its
+-- inner join keys, and the Seq Scan on its outer side uses it to discard
+-- rows that cannot find a match.
+--
+create schema runtime_filter;
+set search_path to runtime_filter;
+
+create or replace function get_explain_analyze_output(explain_query text) returns setof text as
+$$
+declare
+  explainrow text;
+begin
+  for explainrow in execute 'EXPLAIN (ANALYZE, COSTS OFF) ' || explain_query
+  loop
+    return next explainrow;
+  end loop;
+end;
+$$ language plpgsql;
+
+-- fact.k takes the values 0..999, ten rows each, plus 100 rows with a NULL
+-- key.  Only k = 1..10 have a match in dim; dim also has a NULL key and a
+-- key with no match in fact.
+create table fact (id int, k int) distributed by (k);
+insert into fact select i, i % 1000 from generate_series(1, 10000) i;
+insert into fact select i, null from generate_series(10001, 10100) i;
+create table dim (k int, v int) distributed by (k);
+insert into dim select i, i * 10 from generate_series(1, 10) i;
+insert into dim values (null, -1), (2000, 20000);
+analyze fact;
+analyze dim;
+
+set enable_mergejoin to off;
+set enable_nestloop to off;
+
+-- dim is much smaller than the inner sides filters are built for by default.
+set gp_runtime_filter_min_inner_rows to 0;
+
+-- Run each query with the filter off first, to show the expected result.
+set gp_enable_runtime_filter to off;
+select count(*), sum(f.id) from fact f join dim d on f.k = d.k;
+select count(*), sum(f.id) from fact f where f.k in (select k from dim);
+select count(*), count(f.id), count(d.k) from fact f right join dim d on f.k = d.k;
+select count(*), count(d.v) from fact f left join dim d on f.k = d.k;
+
+set gp_enable_runtime_filter to on;
+
+-- INNER join
+select count(*), sum(f.id) from fact f join dim d on f.k = d.k;
+-- SEMI join
+select count(*), sum(f.id) from fact f where f.k in (select k from dim);
+-- RIGHT join: unmatched dim rows, including the NULL key, are kept
+select count(*), count(f.id), count(d.k) from fact f right join dim d on f.k = d.k;
+-- LEFT join: rows with a NULL or unmatched key in fact must all be kept
+select count(*), count(d.v) from fact f left join dim d on f.k = d.k;
+-- rows with a NULL key in fact still reach the join
+select count(*) from fact f left join dim d on f.k = d.k where f.k is null;
+
+-- The scan on fact reports the rows the filter removed.
+WITH query_plan (et) AS
+(
+  select get_explain_analyze_output($$
+    select count(*) from fact f join dim d on f.k = d.k;
+  $$)
+)
+SELECT
+  (SELECT COUNT(*) FROM query_plan WHERE et like '%Rows Removed by Runtime Filter: %') > 0 as rows_removed
+;
+
+-- No filter when it's disabled.
+set gp_enable_runtime_filter to off;
+WITH query_plan (et) AS
+(
+  select get_explain_analyze_output($$
+    select count(*) from fact f join dim d on f.k = d.k;
+  $$)
+)
+SELECT
+  (SELECT COUNT(*) FROM query_plan WHERE et like '%Rows Removed by Runtime Filter: %') as rows_removed_lines
+;
+set gp_enable_runtime_filter to on;
+
+-- No filter either for an inner side estimated to be smaller than
+-- gp_runtime_filter_min_inner_rows.
+reset gp_runtime_filter_min_inner_rows;
+WITH query_plan (et) AS
+(
+  select get_explain_analyze_output($$
+    select count(*) from fact f join dim d on f.k = d.k;
+  $$)
+)
+SELECT
+  (SELECT COUNT(*) FROM query_plan WHERE et like '%Rows Removed by Runtime Filter: %') as rows_removed_lines
+;
+set gp_runtime_filter_min_inner_rows to 0;
+
+-- Rescans: the hash join is on the inner side of a nested loop, so its
+-- outer Seq Scan is rescanned with the filter built on the first pass.
+create table nl_outer (x int) distributed replicated;
+insert into nl_outer values (1), (5), (10);
+analyze nl_outer;
+reset enable_nestloop;
+set enable_material to off;
+select o.x, count(*) from nl_outer o join (fact f join dim d on f.k = d.k) on f.k <= o.x group by o.x order by o.x;
+set gp_enable_runtime_filter to off;
+select o.x, count(*) from nl_outer o join (fact f join dim d on f.k = d.k) on f.k <= o.x group by o.x order by o.x;
+
+reset enable_material;
+reset enable_mergejoin;
+reset gp_enable_runtime_filter;
+reset gp_runtime_filter_min_inner_rows;
+drop table nl_outer;
+drop table fact;
+drop table dim;
+drop function get_explain_analyze_output(text);
+drop schema runtime_filter;
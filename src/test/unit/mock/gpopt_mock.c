@@ -11,6 +11,12 @@ SerializeDXLPlan(Query *pquery)
 	return NULL;
 }
 
+void
+GPOPTPlanCacheStats(uint64 *hits, uint64 *misses)
+{
+	elog(ERROR, "mock implementation of GPOPTPlanCacheStats called");
+}
+
 PlannedStmt *
 GPOPTOptimizedPlan(Query *pquery, bool pfUnexpectedFailure)
 {